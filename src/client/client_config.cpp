@@ -120,6 +120,20 @@ bool parse_args(int argc, char* argv[], ClientConfig& config, std::error_code& e
   // Server connection.
   app.add_option("-s,--server", config.tunnel.server_address, "Server address");
   app.add_option("-p,--port", config.tunnel.server_port, "Server port")->default_val(4433);
+  std::string io_backend;
+  app.add_option("--io-backend", io_backend, "I/O backend: epoll, io_uring or auto")
+      ->check(CLI::IsMember({"epoll", "io_uring", "auto"}));
+  app.add_flag("--fec", config.tunnel.enable_fec, "Forward error correction for lossy links");
+  app.add_flag("--priority-scheduling", config.tunnel.enable_priority_scheduling,
+               "Send interactive traffic ahead of bulk transfers");
+  app.add_flag("--kernel-pacing", config.tunnel.transmit.kernel_pacing,
+               "Let the fq qdisc pace datagrams (SO_TXTIME)");
+  app.add_flag("--timing-jitter", config.tunnel.enable_timing_jitter,
+               "Delay datagrams by the obfuscation profile's timing jitter");
+  app.add_flag("--worker-threads", config.tunnel.enable_worker_threads,
+               "Send and receive on separate threads (Linux, epoll backend)");
+  bool no_pmtu_discovery = false;
+  app.add_flag("--no-pmtu-discovery", no_pmtu_discovery, "Keep the configured datagram size instead of probing the path");
 
   // TUN device.
   app.add_option("--tun-name", config.tunnel.tun.device_name, "TUN device name")->default_val("veil0");
@@ -157,6 +171,13 @@ bool parse_args(int argc, char* argv[], ClientConfig& config, std::error_code& e
     }
   }
 
+  if (!io_backend.empty()) {
+    config.tunnel.event_loop.backend = *transport::parse_event_loop_backend(io_backend);
+  }
+  if (no_pmtu_discovery) {
+    config.tunnel.enable_pmtu_discovery = false;
+  }
+
   // Copy verbose flag to tunnel config.
   config.tunnel.verbose = config.verbose;
 
@@ -203,6 +224,26 @@ bool load_config_file(const std::string& path, ClientConfig& config, std::error_
         config.daemon_mode = (value == "true" || value == "1" || value == "yes");
       } else if (key == "verbose") {
         config.verbose = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "fec") {
+        config.tunnel.enable_fec = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "priority_scheduling") {
+        config.tunnel.enable_priority_scheduling = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "kernel_pacing") {
+        config.tunnel.transmit.kernel_pacing = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "timing_jitter") {
+        config.tunnel.enable_timing_jitter = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "worker_threads") {
+        config.tunnel.enable_worker_threads = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "pmtu_discovery") {
+        config.tunnel.enable_pmtu_discovery = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "io_backend") {
+        const auto backend = transport::parse_event_loop_backend(value);
+        if (!backend) {
+          LOG_ERROR("Configuration error: io_backend value '{}' must be epoll, io_uring or auto", value);
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return false;
+        }
+        config.tunnel.event_loop.backend = *backend;
       }
     } else if (section == "tun") {
       if (key == "device_name") {
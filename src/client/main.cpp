@@ -2,6 +2,7 @@
 #include <iostream>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include <spdlog/spdlog.h>
 
@@ -93,6 +94,7 @@ void print_configuration(const client::ClientConfig& config) {
   cli::print_row("TUN Device", config.tunnel.tun.device_name);
   cli::print_row("TUN IP", config.tunnel.tun.ip_address + "/" + config.tunnel.tun.netmask);
   cli::print_row("MTU", std::to_string(config.tunnel.tun.mtu));
+  cli::print_row("Path MTU Discovery", config.tunnel.enable_pmtu_discovery ? "Yes" : "No");
   cli::print_row("Verbose", config.verbose ? "Yes" : "No");
   cli::print_row("Daemon Mode", config.daemon_mode ? "Yes" : "No");
   cli::print_row("Default Route", config.set_default_route ? "Yes" : "No");
@@ -214,6 +216,8 @@ int main(int argc, char* argv[]) {
   if (!config.routes.empty()) {
     cli::print_info("Setting up custom routes...");
   }
+  std::vector<tun::Route> routes;
+  routes.reserve(config.routes.size());
   for (const auto& route_str : config.routes) {
     tun::Route route;
     // Parse CIDR notation (e.g., "192.168.1.0/24")
@@ -225,10 +229,16 @@ int main(int argc, char* argv[]) {
       route.netmask = "255.255.255.255";
     }
     route.interface = tun.tun_device()->device_name();
-
-    if (!route_manager->add_route(route, ec)) {
-      cli::print_warning("Failed to add route " + route_str + ": " + ec.message());
-      LOG_WARN("Failed to add route {}: {}", route_str, ec.message());
+    routes.push_back(std::move(route));
+  }
+  // All routes in one call: on Linux they go to the kernel in netlink batches.
+  std::vector<std::error_code> route_results;
+  route_manager->add_routes(routes, route_results);
+  for (std::size_t i = 0; i < routes.size(); ++i) {
+    const auto& route_str = config.routes[i];
+    if (route_results[i]) {
+      cli::print_warning("Failed to add route " + route_str + ": " + route_results[i].message());
+      LOG_WARN("Failed to add route {}: {}", route_str, route_results[i].message());
     } else {
       cli::print_success("Added route: " + route_str);
     }
@@ -219,6 +219,37 @@ std::array<std::uint8_t, kAeadKeyLen> derive_sequence_obfuscation_key(
   return obfuscation_key;
 }
 
+std::uint64_t derive_connection_id(const SessionKeys& keys) {
+  ensure_sodium_ready();
+
+  // One side's send key is the other side's recv key. Ordering the two keys
+  // makes the derivation symmetric so both peers agree on the ID.
+  const bool send_first =
+      std::lexicographical_compare(keys.send_key.begin(), keys.send_key.end(),
+                                   keys.recv_key.begin(), keys.recv_key.end());
+  const auto& first = send_first ? keys.send_key : keys.recv_key;
+  const auto& second = send_first ? keys.recv_key : keys.send_key;
+
+  std::array<std::uint8_t, kAeadKeyLen * 2> ikm{};
+  std::copy(first.begin(), first.end(), ikm.begin());
+  std::copy(second.begin(), second.end(), ikm.begin() + kAeadKeyLen);
+
+  constexpr const char* info_str = "veil-connection-id-v1";
+  const std::vector<std::uint8_t> info(info_str, info_str + std::strlen(info_str));
+  auto prk = hkdf_extract({}, ikm);
+  auto expanded = hkdf_expand(prk, info, 8);
+
+  // SECURITY: Clear intermediate key material
+  sodium_memzero(ikm.data(), ikm.size());
+  sodium_memzero(prk.data(), prk.size());
+
+  std::uint64_t connection_id = 0;
+  for (const auto byte : expanded) {
+    connection_id = (connection_id << 8) | byte;
+  }
+  return connection_id;
+}
+
 std::uint64_t obfuscate_sequence(std::uint64_t sequence,
                                   std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key) {
   ensure_sodium_ready();
@@ -54,6 +54,11 @@ std::array<std::uint8_t, kAeadKeyLen> derive_sequence_obfuscation_key(
     std::span<const std::uint8_t, kAeadKeyLen> send_key,
     std::span<const std::uint8_t, kNonceLen> send_nonce);
 
+// Derive the 64-bit connection ID that identifies a session on the wire.
+// Both peers compute the same value from their (mirrored) session keys, so no
+// extra signalling is needed and the ID survives changes of the client address.
+std::uint64_t derive_connection_id(const SessionKeys& keys);
+
 // Obfuscate sequence number for transmission (sender side).
 // Uses ChaCha20 stream cipher with the obfuscation key to make sequences indistinguishable from random.
 // Optimized for performance (Issue #93) - replaces 3-round Feistel network with hardware-accelerated ChaCha20.
@@ -4,8 +4,10 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cstdint>
 #include <cstring>
+#include <stdexcept>
 
 #include "common/crypto/crypto_engine.h"
 #include "common/crypto/hardware_features.h"
@@ -38,6 +40,20 @@
   #define VEIL_HAS_AES_INTRINSICS 0
 #endif
 
+// SequenceObfuscator selects AES-NI at runtime. On GCC/Clang the AES code is
+// compiled with a function-level target attribute, so the fast path is
+// available without building the whole project with -maes.
+#if (defined(__clang__) || defined(__GNUC__)) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define VEIL_AES_TARGET __attribute__((target("aes,sse2")))
+  #define VEIL_HAS_AES_DISPATCH 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #define VEIL_AES_TARGET
+  #define VEIL_HAS_AES_DISPATCH 1
+#else
+  #define VEIL_HAS_AES_DISPATCH 0
+#endif
+
 namespace veil::crypto {
 
 namespace {
@@ -214,8 +230,12 @@ std::uint64_t obfuscate_sequence_aesni(std::uint64_t sequence,
 // It will automatically use AES-NI if present
 
 bool is_aes_gcm_available() {
-  // libsodium's crypto_aead_aes256gcm_is_available checks for AES-NI
-  return crypto_aead_aes256gcm_is_available() != 0;
+  // libsodium's crypto_aead_aes256gcm_is_available checks for AES-NI. Its CPU
+  // detection runs in sodium_init(), so make sure that happened first.
+  static const bool available = [] {
+    return sodium_init() >= 0 && crypto_aead_aes256gcm_is_available() != 0;
+  }();
+  return available;
 }
 
 std::vector<std::uint8_t> aead_encrypt_aes_gcm(std::span<const std::uint8_t, kAeadKeyLen> key,
@@ -325,6 +345,117 @@ std::size_t aead_decrypt_aes_gcm_to(std::span<const std::uint8_t, kAeadKeyLen> k
   return static_cast<std::size_t>(out_len);
 }
 
+// ============================================================================
+// Sequence Permutation Round Function
+// ============================================================================
+
+constexpr std::size_t kSeqKeyBytes = 16;
+
+// Little-endian load; matches _mm_cvtsi128_si32 on the AES-NI path.
+std::uint32_t load_le32(const std::uint8_t* bytes) {
+  return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+         (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+constexpr std::array<std::uint8_t, 256> kAesSbox = {
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16};
+
+constexpr std::uint8_t gf_double(std::uint8_t x) {
+  return static_cast<std::uint8_t>((x << 1) ^ ((x >> 7) * 0x1B));
+}
+
+// Combined SubBytes + MixColumns table for row 0 (bytes 2s, s, s, 3s). The
+// tables for rows 1-3 are byte rotations of it.
+constexpr std::array<std::uint32_t, 256> kAesTe0 = [] {
+  std::array<std::uint32_t, 256> table{};
+  for (std::size_t i = 0; i < 256; ++i) {
+    const std::uint32_t s = kAesSbox[i];
+    const std::uint32_t s2 = gf_double(kAesSbox[i]);
+    table[i] = s2 | (s << 8) | (s << 16) | ((s2 ^ s) << 24);
+  }
+  return table;
+}();
+
+// One output column of SubBytes + ShiftRows + MixColumns; c1-c3 are the
+// columns ShiftRows draws rows 1-3 from.
+inline std::uint32_t aes_column_portable(std::uint32_t c0, std::uint32_t c1, std::uint32_t c2, std::uint32_t c3) {
+  return kAesTe0[c0 & 0xFF] ^ std::rotl(kAesTe0[(c1 >> 8) & 0xFF], 8) ^ std::rotl(kAesTe0[(c2 >> 16) & 0xFF], 16) ^
+         std::rotl(kAesTe0[c3 >> 24], 24);
+}
+
+// One AES encryption round (SubBytes, ShiftRows, MixColumns, AddRoundKey),
+// bit-compatible with the AESENC instruction. The state is four little-endian
+// column words.
+void aes_round_portable(std::array<std::uint32_t, 4>& cols, const std::uint8_t* round_key) {
+  const std::array<std::uint32_t, 4> in = cols;
+  cols[0] = aes_column_portable(in[0], in[1], in[2], in[3]) ^ load_le32(round_key);
+  cols[1] = aes_column_portable(in[1], in[2], in[3], in[0]) ^ load_le32(round_key + 4);
+  cols[2] = aes_column_portable(in[2], in[3], in[0], in[1]) ^ load_le32(round_key + 8);
+  cols[3] = aes_column_portable(in[3], in[0], in[1], in[2]) ^ load_le32(round_key + 12);
+}
+
+// F(half) = low 32 bits of AESENC(AESENC((half || 0^96) ^ k0, k1), k2).
+// Two rounds are enough for every output byte of the first column to depend
+// on all four input bytes.
+std::uint32_t sequence_round_portable(const std::uint8_t* keys, std::uint32_t half) {
+  std::array<std::uint32_t, 4> cols = {load_le32(keys) ^ half, load_le32(keys + 4), load_le32(keys + 8),
+                                       load_le32(keys + 12)};
+  aes_round_portable(cols, keys + kSeqKeyBytes);
+  aes_round_portable(cols, keys + 2 * kSeqKeyBytes);
+  return cols[0];
+}
+
+#if VEIL_HAS_AES_DISPATCH
+
+VEIL_AES_TARGET inline std::uint32_t sequence_round_aesni(const std::uint8_t* keys, std::uint32_t half) {
+  __m128i block = _mm_cvtsi32_si128(static_cast<int>(half));
+  block = _mm_xor_si128(block, _mm_load_si128(reinterpret_cast<const __m128i*>(keys)));
+  block = _mm_aesenc_si128(block, _mm_load_si128(reinterpret_cast<const __m128i*>(keys + kSeqKeyBytes)));
+  block = _mm_aesenc_si128(block, _mm_load_si128(reinterpret_cast<const __m128i*>(keys + 2 * kSeqKeyBytes)));
+  return static_cast<std::uint32_t>(_mm_cvtsi128_si32(block));
+}
+
+// Whole Feistel network in one target function so the rounds inline.
+VEIL_AES_TARGET std::uint64_t sequence_feistel_aesni(const std::uint8_t* keys, std::uint64_t value,
+                                                     bool inverse) {
+  constexpr std::size_t kRounds = SequenceObfuscator::kRounds;
+  constexpr std::size_t kStride = SequenceObfuscator::kKeysPerRound * kSeqKeyBytes;
+  auto left = static_cast<std::uint32_t>(value >> 32);
+  auto right = static_cast<std::uint32_t>(value & 0xFFFFFFFF);
+  if (!inverse) {
+    for (std::size_t round = 0; round < kRounds; ++round) {
+      const std::uint32_t next = left ^ sequence_round_aesni(keys + round * kStride, right);
+      left = right;
+      right = next;
+    }
+  } else {
+    for (std::size_t round = kRounds; round-- > 0;) {
+      const std::uint32_t prev = right ^ sequence_round_aesni(keys + round * kStride, left);
+      right = left;
+      left = prev;
+    }
+  }
+  return (static_cast<std::uint64_t>(left) << 32) | right;
+}
+
+#endif  // VEIL_HAS_AES_DISPATCH
+
+
 }  // namespace
 
 // ============================================================================
@@ -348,6 +479,66 @@ std::uint64_t deobfuscate_sequence_hw(std::uint64_t obfuscated_sequence,
   return obfuscate_sequence_hw(obfuscated_sequence, obfuscation_key);
 }
 
+// ============================================================================
+// SequenceObfuscator
+// ============================================================================
+
+SequenceObfuscator::SequenceObfuscator(std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key,
+                                       bool use_hardware) {
+  if (sodium_init() < 0) {
+    throw std::runtime_error("libsodium initialization failed");
+  }
+  // Expand the round keys once: ChaCha20 keystream under the obfuscation key,
+  // with a nonce reserved for this purpose.
+  constexpr std::array<std::uint8_t, crypto_stream_chacha20_NONCEBYTES> kNonce = {'S', 'E', 'Q', 'P',
+                                                                                  'R', 'P', 'v', '1'};
+  crypto_stream_chacha20(round_keys_.front().data(), round_keys_.size() * sizeof(RoundKey), kNonce.data(),
+                         obfuscation_key.data());
+#if VEIL_HAS_AES_DISPATCH
+  hardware_ = use_hardware && get_cpu_features().has_aesni;
+#else
+  (void)use_hardware;
+#endif
+}
+
+SequenceObfuscator::~SequenceObfuscator() { sodium_memzero(round_keys_.data(), sizeof(round_keys_)); }
+
+std::uint32_t SequenceObfuscator::round_function(std::size_t round, std::uint32_t half) const noexcept {
+  return sequence_round_portable(round_keys_[round * kKeysPerRound].data(), half);
+}
+
+std::uint64_t SequenceObfuscator::obfuscate(std::uint64_t sequence) const noexcept {
+#if VEIL_HAS_AES_DISPATCH
+  if (hardware_) {
+    return sequence_feistel_aesni(round_keys_.front().data(), sequence, false);
+  }
+#endif
+  auto left = static_cast<std::uint32_t>(sequence >> 32);
+  auto right = static_cast<std::uint32_t>(sequence & 0xFFFFFFFF);
+  for (std::size_t round = 0; round < kRounds; ++round) {
+    const std::uint32_t next = left ^ round_function(round, right);
+    left = right;
+    right = next;
+  }
+  return (static_cast<std::uint64_t>(left) << 32) | right;
+}
+
+std::uint64_t SequenceObfuscator::deobfuscate(std::uint64_t obfuscated_sequence) const noexcept {
+#if VEIL_HAS_AES_DISPATCH
+  if (hardware_) {
+    return sequence_feistel_aesni(round_keys_.front().data(), obfuscated_sequence, true);
+  }
+#endif
+  auto left = static_cast<std::uint32_t>(obfuscated_sequence >> 32);
+  auto right = static_cast<std::uint32_t>(obfuscated_sequence & 0xFFFFFFFF);
+  for (std::size_t round = kRounds; round-- > 0;) {
+    const std::uint32_t prev = right ^ round_function(round, left);
+    right = left;
+    left = prev;
+  }
+  return (static_cast<std::uint64_t>(left) << 32) | right;
+}
+
 std::vector<std::uint8_t> aead_encrypt_hw(std::span<const std::uint8_t, kAeadKeyLen> key,
                                            std::span<const std::uint8_t, kNonceLen> nonce,
                                            std::span<const std::uint8_t> aad,
@@ -462,4 +653,133 @@ std::optional<std::vector<std::uint8_t>> aead_decrypt_with_algorithm(
   }
 }
 
+std::uint8_t local_aead_suites() noexcept {
+  std::uint8_t suites = aead_suite_bit(AeadAlgorithm::kChaCha20Poly1305);
+  if (is_aes_gcm_available()) {
+    suites |= aead_suite_bit(AeadAlgorithm::kAesGcm);
+  }
+  return suites;
+}
+
+AeadAlgorithm negotiate_aead(std::uint8_t initiator_suites, std::uint8_t responder_suites) noexcept {
+  const auto common = static_cast<std::uint8_t>(initiator_suites & responder_suites);
+  if ((common & aead_suite_bit(AeadAlgorithm::kAesGcm)) != 0) {
+    return AeadAlgorithm::kAesGcm;
+  }
+  return AeadAlgorithm::kChaCha20Poly1305;
+}
+
+// ============================================================================
+// AeadCipher
+// ============================================================================
+
+struct AeadCipher::State {
+  std::array<std::uint8_t, kAeadKeyLen> key{};
+  // Only initialized for AES-256-GCM. libsodium requires 16-byte alignment.
+  alignas(16) crypto_aead_aes256gcm_state aes_state;
+};
+
+AeadCipher::AeadCipher(AeadAlgorithm algorithm, std::span<const std::uint8_t, kAeadKeyLen> key)
+    : algorithm_(algorithm == AeadAlgorithm::kAuto ? get_recommended_aead_algorithm() : algorithm),
+      state_(std::make_unique<State>()) {
+  if (algorithm_ != AeadAlgorithm::kChaCha20Poly1305 && algorithm_ != AeadAlgorithm::kAesGcm) {
+    throw std::invalid_argument("unknown AEAD algorithm");
+  }
+  std::copy(key.begin(), key.end(), state_->key.begin());
+  if (algorithm_ == AeadAlgorithm::kAesGcm) {
+    if (!is_aes_gcm_available()) {
+      throw std::invalid_argument("AES-256-GCM requires hardware AES support");
+    }
+    crypto_aead_aes256gcm_beforenm(&state_->aes_state, state_->key.data());
+  }
+}
+
+AeadCipher::~AeadCipher() {
+  if (state_) {
+    sodium_memzero(state_.get(), sizeof(State));
+  }
+}
+
+AeadCipher::AeadCipher(AeadCipher&&) noexcept = default;
+
+AeadCipher& AeadCipher::operator=(AeadCipher&& other) noexcept {
+  if (this != &other) {
+    if (state_) {
+      sodium_memzero(state_.get(), sizeof(State));
+    }
+    algorithm_ = other.algorithm_;
+    state_ = std::move(other.state_);
+  }
+  return *this;
+}
+
+std::vector<std::uint8_t> AeadCipher::encrypt(std::span<const std::uint8_t, kNonceLen> nonce,
+                                              std::span<const std::uint8_t> aad,
+                                              std::span<const std::uint8_t> plaintext) const {
+  if (algorithm_ != AeadAlgorithm::kAesGcm) {
+    return aead_encrypt(state_->key, nonce, aad, plaintext);
+  }
+  std::vector<std::uint8_t> ciphertext(aead_ciphertext_size(plaintext.size()));
+  ciphertext.resize(encrypt_to(nonce, aad, plaintext, ciphertext));
+  return ciphertext;
+}
+
+std::optional<std::vector<std::uint8_t>> AeadCipher::decrypt(std::span<const std::uint8_t, kNonceLen> nonce,
+                                                             std::span<const std::uint8_t> aad,
+                                                             std::span<const std::uint8_t> ciphertext) const {
+  if (algorithm_ != AeadAlgorithm::kAesGcm) {
+    return aead_decrypt(state_->key, nonce, aad, ciphertext);
+  }
+  if (ciphertext.size() < kAeadTagLen) {
+    return std::nullopt;
+  }
+  std::vector<std::uint8_t> plaintext(aead_plaintext_size(ciphertext.size()));
+  unsigned long long out_len = 0;
+  if (crypto_aead_aes256gcm_decrypt_afternm(plaintext.data(), &out_len, nullptr, ciphertext.data(),
+                                            ciphertext.size(), aad.data(), aad.size(), nonce.data(),
+                                            &state_->aes_state) != 0) {
+    return std::nullopt;
+  }
+  plaintext.resize(static_cast<std::size_t>(out_len));
+  return plaintext;
+}
+
+std::size_t AeadCipher::encrypt_to(std::span<const std::uint8_t, kNonceLen> nonce,
+                                   std::span<const std::uint8_t> aad,
+                                   std::span<const std::uint8_t> plaintext,
+                                   std::span<std::uint8_t> output) const {
+  if (algorithm_ != AeadAlgorithm::kAesGcm) {
+    return aead_encrypt_to(state_->key, nonce, aad, plaintext, output);
+  }
+  if (output.size() < aead_ciphertext_size(plaintext.size())) {
+    return 0;
+  }
+  unsigned long long out_len = 0;
+  if (crypto_aead_aes256gcm_encrypt_afternm(output.data(), &out_len, plaintext.data(), plaintext.size(),
+                                            aad.data(), aad.size(), nullptr, nonce.data(),
+                                            &state_->aes_state) != 0) {
+    return 0;
+  }
+  return static_cast<std::size_t>(out_len);
+}
+
+std::size_t AeadCipher::decrypt_to(std::span<const std::uint8_t, kNonceLen> nonce,
+                                   std::span<const std::uint8_t> aad,
+                                   std::span<const std::uint8_t> ciphertext,
+                                   std::span<std::uint8_t> output) const {
+  if (algorithm_ != AeadAlgorithm::kAesGcm) {
+    return aead_decrypt_to(state_->key, nonce, aad, ciphertext, output);
+  }
+  if (ciphertext.size() < kAeadTagLen || output.size() < aead_plaintext_size(ciphertext.size())) {
+    return 0;
+  }
+  unsigned long long out_len = 0;
+  if (crypto_aead_aes256gcm_decrypt_afternm(output.data(), &out_len, nullptr, ciphertext.data(),
+                                            ciphertext.size(), aad.data(), aad.size(), nonce.data(),
+                                            &state_->aes_state) != 0) {
+    return 0;
+  }
+  return static_cast<std::size_t>(out_len);
+}
+
 }  // namespace veil::crypto
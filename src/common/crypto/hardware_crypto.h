@@ -3,6 +3,7 @@
 #include <array>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <optional>
 #include <span>
 #include <vector>
@@ -31,6 +32,46 @@ std::uint64_t obfuscate_sequence_hw(std::uint64_t sequence,
 std::uint64_t deobfuscate_sequence_hw(std::uint64_t obfuscated_sequence,
                                        std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key);
 
+// Keyed pseudo-random permutation of 64-bit sequence numbers, used by
+// TransportSession to hide the packet counter on the wire.
+//
+// A 4-round Feistel network over 32-bit halves. Each round function is two
+// AES rounds under round keys expanded once from the obfuscation key at
+// construction, so a packet costs eight AES rounds and no key setup.
+// The AES rounds run on AES-NI when the CPU has it (runtime dispatch) and on
+// a portable implementation otherwise. Both produce identical output, so
+// peers with different CPUs interoperate.
+class SequenceObfuscator {
+ public:
+  // use_hardware = false forces the portable path (tests, benchmarks).
+  explicit SequenceObfuscator(std::span<const std::uint8_t, kAeadKeyLen> obfuscation_key,
+                              bool use_hardware = true);
+
+  /// SECURITY: Destructor clears the round keys.
+  ~SequenceObfuscator();
+
+  SequenceObfuscator(const SequenceObfuscator&) = default;
+  SequenceObfuscator& operator=(const SequenceObfuscator&) = default;
+
+  std::uint64_t obfuscate(std::uint64_t sequence) const noexcept;
+  std::uint64_t deobfuscate(std::uint64_t obfuscated_sequence) const noexcept;
+
+  // True if the AES-NI path is in use.
+  bool uses_hardware() const noexcept { return hardware_; }
+
+  static constexpr std::size_t kRounds = 4;
+  // Per Feistel round: whitening key plus one key per AES round.
+  static constexpr std::size_t kKeysPerRound = 3;
+
+ private:
+  using RoundKey = std::array<std::uint8_t, 16>;
+
+  std::uint32_t round_function(std::size_t round, std::uint32_t half) const noexcept;
+
+  alignas(16) std::array<RoundKey, kRounds * kKeysPerRound> round_keys_{};
+  bool hardware_{false};
+};
+
 // ============================================================================
 // AES-GCM AEAD (Alternative to ChaCha20-Poly1305)
 // ============================================================================
@@ -111,4 +152,69 @@ std::optional<std::vector<std::uint8_t>> aead_decrypt_with_algorithm(
     std::span<const std::uint8_t> ciphertext,
     AeadAlgorithm algorithm);
 
+// ============================================================================
+// Suite Negotiation
+// ============================================================================
+
+// Bit for an algorithm in a suite mask exchanged during the handshake.
+inline constexpr std::uint8_t aead_suite_bit(AeadAlgorithm algo) noexcept {
+  return static_cast<std::uint8_t>(1U << static_cast<unsigned>(algo));
+}
+
+// Suites this host runs at full speed: ChaCha20-Poly1305 always, AES-256-GCM
+// only with hardware AES and carry-less multiply.
+std::uint8_t local_aead_suites() noexcept;
+
+// Pick the session's algorithm from both peers' suite masks. AES-256-GCM is
+// chosen only when both sides offer it (both have hardware AES); otherwise
+// ChaCha20-Poly1305, which is fast in software everywhere.
+AeadAlgorithm negotiate_aead(std::uint8_t initiator_suites, std::uint8_t responder_suites) noexcept;
+
+// ============================================================================
+// Keyed AEAD Cipher
+// ============================================================================
+
+// AEAD cipher bound to one key, for one direction of a session.
+// The AES-256-GCM key schedule is expanded once at construction
+// (crypto_aead_aes256gcm_beforenm) instead of on every packet.
+//
+// Thread Safety:
+//   Const methods may be called concurrently; the state is read-only after
+//   construction.
+class AeadCipher {
+ public:
+  // Throws std::invalid_argument if AES-256-GCM is requested on a CPU
+  // without hardware AES. kAuto selects get_recommended_aead_algorithm().
+  AeadCipher(AeadAlgorithm algorithm, std::span<const std::uint8_t, kAeadKeyLen> key);
+
+  /// SECURITY: Destructor clears the key and expanded key schedule.
+  ~AeadCipher();
+
+  AeadCipher(const AeadCipher&) = delete;
+  AeadCipher& operator=(const AeadCipher&) = delete;
+  AeadCipher(AeadCipher&&) noexcept;
+  AeadCipher& operator=(AeadCipher&&) noexcept;
+
+  AeadAlgorithm algorithm() const noexcept { return algorithm_; }
+
+  std::vector<std::uint8_t> encrypt(std::span<const std::uint8_t, kNonceLen> nonce,
+                                    std::span<const std::uint8_t> aad,
+                                    std::span<const std::uint8_t> plaintext) const;
+  std::optional<std::vector<std::uint8_t>> decrypt(std::span<const std::uint8_t, kNonceLen> nonce,
+                                                   std::span<const std::uint8_t> aad,
+                                                   std::span<const std::uint8_t> ciphertext) const;
+
+  // Output buffer variants; same contract as aead_encrypt_to()/aead_decrypt_to().
+  std::size_t encrypt_to(std::span<const std::uint8_t, kNonceLen> nonce, std::span<const std::uint8_t> aad,
+                         std::span<const std::uint8_t> plaintext, std::span<std::uint8_t> output) const;
+  std::size_t decrypt_to(std::span<const std::uint8_t, kNonceLen> nonce, std::span<const std::uint8_t> aad,
+                         std::span<const std::uint8_t> ciphertext, std::span<std::uint8_t> output) const;
+
+ private:
+  struct State;
+
+  AeadAlgorithm algorithm_;
+  std::unique_ptr<State> state_;
+};
+
 }  // namespace veil::crypto
@@ -107,6 +107,7 @@ CpuFeatures detect_x86_features() {
   features.has_sse2 = (edx1 & (1U << 26)) != 0;
 
   // ECX flags
+  features.has_ssse3 = (ecx1 & (1U << 9)) != 0;
   features.has_sse41 = (ecx1 & (1U << 19)) != 0;
   features.has_sse42 = (ecx1 & (1U << 20)) != 0;
   features.has_aesni = (ecx1 & (1U << 25)) != 0;
@@ -179,6 +180,7 @@ std::string build_features_string(const CpuFeatures& features) {
 #if defined(__x86_64__) || defined(__i386__) || defined(_M_IX86) || defined(_M_X64)
   result += "x86";
   if (features.has_sse2) result += " SSE2";
+  if (features.has_ssse3) result += " SSSE3";
   if (features.has_sse41) result += " SSE4.1";
   if (features.has_sse42) result += " SSE4.2";
   if (features.has_avx) result += " AVX";
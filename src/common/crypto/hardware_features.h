@@ -9,6 +9,7 @@ namespace veil::crypto {
 struct CpuFeatures {
   // x86/x64 SIMD features
   bool has_sse2 = false;      // SSE2 (required for most SIMD)
+  bool has_ssse3 = false;     // SSSE3 (byte shuffles, PSHUFB)
   bool has_sse41 = false;     // SSE4.1 (additional SIMD instructions)
   bool has_sse42 = false;     // SSE4.2 (CRC32, string instructions)
   bool has_avx = false;       // AVX (256-bit SIMD)
@@ -0,0 +1,107 @@
+#include "common/handshake/anti_replay_filter.h"
+
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include "common/crypto/random.h"
+
+namespace veil::handshake {
+
+namespace {
+
+// Bits per expected item; with 8 hash functions this gives ~1.5e-4 false positives.
+constexpr std::size_t kBitsPerItem = 20;
+constexpr std::size_t kMinShardBits = 1024;
+
+// splitmix64 finalizer.
+std::uint64_t mix64(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+bool test_bit(const std::vector<std::uint64_t>& bits, std::uint64_t index) {
+  return ((bits[index >> 6] >> (index & 63)) & 1U) != 0;
+}
+
+}  // namespace
+
+AntiReplayFilter::AntiReplayFilter(std::chrono::milliseconds window, std::size_t expected_items)
+    : window_(window),
+      window_ms_(static_cast<std::uint64_t>(std::max<std::int64_t>(window.count(), 1))),
+      bit_mask_(0),
+      hash_key_(crypto::random_uint64()),
+      shards_(std::make_unique<Shard[]>(kShards)) {
+  if (window.count() <= 0) {
+    throw std::invalid_argument("anti-replay window must be > 0");
+  }
+
+  const std::size_t per_shard_items = std::max<std::size_t>(expected_items / kShards, 1);
+  const std::size_t bits = std::bit_ceil(std::max(per_shard_items * kBitsPerItem, kMinShardBits));
+  bit_mask_ = bits - 1;
+  for (std::size_t i = 0; i < kShards; ++i) {
+    shards_[i].current.assign(bits / 64, 0);
+    shards_[i].previous.assign(bits / 64, 0);
+  }
+}
+
+void AntiReplayFilter::rotate_locked(Shard& shard, std::uint64_t bucket) const {
+  if (bucket <= shard.bucket) {
+    return;  // Same bucket, or the clock stepped back: keep what we have.
+  }
+  if (bucket == shard.bucket + 1) {
+    std::swap(shard.previous, shard.current);
+  } else {
+    std::fill(shard.previous.begin(), shard.previous.end(), 0);
+  }
+  std::fill(shard.current.begin(), shard.current.end(), 0);
+  shard.bucket = bucket;
+}
+
+bool AntiReplayFilter::check_and_insert(std::span<const std::uint8_t> item, std::uint64_t now_ms) {
+  // Two keyed 64-bit hashes; the k probe positions use double hashing.
+  std::uint64_t h1 = mix64(hash_key_);
+  std::uint64_t h2 = mix64(~hash_key_);
+  for (std::size_t offset = 0; offset < item.size(); offset += 8) {
+    std::uint64_t word = 0;
+    const std::size_t n = std::min<std::size_t>(8, item.size() - offset);
+    for (std::size_t i = 0; i < n; ++i) {
+      word |= static_cast<std::uint64_t>(item[offset + i]) << (8 * i);
+    }
+    h1 = mix64(h1 ^ word);
+    h2 = mix64(h2 + word);
+  }
+  h2 |= 1;  // Odd stride visits distinct positions in a power-of-two table.
+
+  auto& shard = shards_[h1 % kShards];
+  std::lock_guard lock(shard.mutex);
+  rotate_locked(shard, now_ms / window_ms_);
+
+  bool in_current = true;
+  bool in_previous = true;
+  for (unsigned i = 0; i < kHashFunctions; ++i) {
+    const std::uint64_t index = ((h1 >> 4) + i * h2) & bit_mask_;
+    in_current = in_current && test_bit(shard.current, index);
+    in_previous = in_previous && test_bit(shard.previous, index);
+    shard.current[index >> 6] |= 1ULL << (index & 63);
+  }
+  return in_current || in_previous;
+}
+
+void AntiReplayFilter::rotate(std::uint64_t now_ms) {
+  const std::uint64_t bucket = now_ms / window_ms_;
+  for (std::size_t i = 0; i < kShards; ++i) {
+    std::lock_guard lock(shards_[i].mutex);
+    rotate_locked(shards_[i], bucket);
+  }
+}
+
+std::size_t AntiReplayFilter::memory_bytes() const {
+  return kShards * 2 * ((bit_mask_ + 1) / 8);
+}
+
+}  // namespace veil::handshake
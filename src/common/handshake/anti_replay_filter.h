@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace veil::handshake {
+
+/// Time-bucketed anti-replay filter for 0-RTT nonces.
+///
+/// Each shard keeps a pair of Bloom filters: `current` for the active time
+/// bucket and `previous` for the one before. When the bucket advances, the
+/// pair rotates and the oldest filter is cleared in one step, so there is no
+/// per-entry expiry bookkeeping and memory is fixed at construction.
+///
+/// Guarantees:
+/// - An inserted item is reported as a replay for at least `window` (and at
+///   most two windows) after insertion.
+/// - False positives are possible (tuned to roughly 1e-4 at the expected
+///   load). A false positive only makes a client fall back to a full 1-RTT
+///   handshake. False negatives within the window are not.
+///
+/// Thread Safety:
+///   All public methods are thread-safe. Items are spread over independent
+///   shards, each with its own mutex, so concurrent workers rarely contend.
+class AntiReplayFilter {
+ public:
+  /// @param window Minimum time an item is remembered.
+  /// @param expected_items Expected number of insertions per window (sizing hint).
+  explicit AntiReplayFilter(std::chrono::milliseconds window,
+                            std::size_t expected_items = static_cast<std::size_t>(1) << 16);
+
+  AntiReplayFilter(const AntiReplayFilter&) = delete;
+  AntiReplayFilter& operator=(const AntiReplayFilter&) = delete;
+
+  /// Check whether an item was seen within the window and record it.
+  /// @param item Bytes identifying the request (e.g. the anti-replay nonce).
+  /// @param now_ms Current time in milliseconds.
+  /// @return true if the item was (probably) seen before, false if new.
+  bool check_and_insert(std::span<const std::uint8_t> item, std::uint64_t now_ms);
+
+  /// Rotate shards whose time bucket has passed. Rotation also happens lazily
+  /// on access; this only releases stale state eagerly.
+  void rotate(std::uint64_t now_ms);
+
+  /// Time window covered by the filter.
+  std::chrono::milliseconds window() const { return window_; }
+
+  /// Total filter memory in bytes.
+  std::size_t memory_bytes() const;
+
+ private:
+  static constexpr std::size_t kShards = 16;
+  static constexpr unsigned kHashFunctions = 8;
+
+  struct Shard {
+    std::mutex mutex;
+    std::uint64_t bucket{0};
+    std::vector<std::uint64_t> current;
+    std::vector<std::uint64_t> previous;
+  };
+
+  void rotate_locked(Shard& shard, std::uint64_t bucket) const;
+
+  std::chrono::milliseconds window_;
+  std::uint64_t window_ms_;
+  std::uint64_t bit_mask_;
+  std::uint64_t hash_key_;
+  std::unique_ptr<Shard[]> shards_;
+};
+
+}  // namespace veil::handshake
@@ -15,7 +15,8 @@
 namespace {
 // Internal magic bytes used inside encrypted payload (not visible to DPI)
 constexpr std::array<std::uint8_t, 2> kMagic{'H', 'S'};
-constexpr std::uint8_t kVersion = 1;
+// Version 2 added the AEAD suite fields to INIT and RESPONSE.
+constexpr std::uint8_t kVersion = 2;
 
 // AEAD tag size for ChaCha20-Poly1305
 constexpr std::size_t kAeadTagLen = crypto_aead_chacha20poly1305_ietf_ABYTES;  // 16 bytes
@@ -121,9 +122,10 @@ std::uint64_t read_u64(std::span<const std::uint8_t> data, std::size_t offset) {
 std::vector<std::uint8_t> build_hmac_payload(std::uint8_t type, std::uint64_t init_ts,
                                              std::uint64_t resp_ts, std::uint64_t session_id,
                                              std::span<const std::uint8_t, 32> init_pub,
-                                             std::span<const std::uint8_t, 32> resp_pub) {
+                                             std::span<const std::uint8_t, 32> resp_pub,
+                                             std::uint8_t aead_suite) {
   std::vector<std::uint8_t> payload;
-  payload.reserve(1 + 1 + 8 + 8 + 8 + init_pub.size() + resp_pub.size());
+  payload.reserve(1 + 1 + 8 + 8 + 8 + init_pub.size() + resp_pub.size() + 1);
   payload.insert(payload.end(), kMagic.begin(), kMagic.end());
   payload.push_back(kVersion);
   payload.push_back(type);
@@ -132,18 +134,21 @@ std::vector<std::uint8_t> build_hmac_payload(std::uint8_t type, std::uint64_t in
   write_u64(payload, session_id);
   payload.insert(payload.end(), init_pub.begin(), init_pub.end());
   payload.insert(payload.end(), resp_pub.begin(), resp_pub.end());
+  payload.push_back(aead_suite);
   return payload;
 }
 
 std::vector<std::uint8_t> build_init_hmac_payload(std::uint64_t ts,
-                                                  std::span<const std::uint8_t, 32> pub) {
+                                                  std::span<const std::uint8_t, 32> pub,
+                                                  std::uint8_t aead_suites) {
   std::vector<std::uint8_t> payload;
-  payload.reserve(1 + 1 + 8 + pub.size());
+  payload.reserve(1 + 1 + 8 + pub.size() + 1);
   payload.insert(payload.end(), kMagic.begin(), kMagic.end());
   payload.push_back(kVersion);
   payload.push_back(static_cast<std::uint8_t>(veil::handshake::MessageType::kInit));
   write_u64(payload, ts);
   payload.insert(payload.end(), pub.begin(), pub.end());
+  payload.push_back(aead_suites);
   return payload;
 }
 
@@ -157,6 +162,40 @@ std::vector<std::uint8_t> derive_info(std::span<const std::uint8_t, 32> init_pub
   return info;
 }
 
+// Derive fresh traffic keys for a 0-RTT resumed session (Issue #86).
+// The ticket's cached keys must not be reused as-is: a new TransportSession
+// restarts its packet counter at zero, which would repeat (key, nonce) pairs
+// from the original session. Both sides instead mix the cached keys with the
+// fresh, HMAC-authenticated values of this 0-RTT INIT. `initiator` tells which
+// direction the cached keys are given in (client view vs. server view).
+veil::crypto::SessionKeys derive_resumption_keys(const veil::crypto::SessionKeys& cached,
+                                                 bool initiator, std::uint64_t init_ts,
+                                                 std::span<const std::uint8_t, 32> init_pub,
+                                                 std::span<const std::uint8_t> anti_replay_nonce) {
+  const auto& c2s_key = initiator ? cached.send_key : cached.recv_key;
+  const auto& s2c_key = initiator ? cached.recv_key : cached.send_key;
+  const auto& c2s_nonce = initiator ? cached.send_nonce : cached.recv_nonce;
+  const auto& s2c_nonce = initiator ? cached.recv_nonce : cached.send_nonce;
+
+  std::vector<std::uint8_t> ikm;
+  ikm.reserve(2 * c2s_key.size() + 2 * c2s_nonce.size());
+  ikm.insert(ikm.end(), c2s_key.begin(), c2s_key.end());
+  ikm.insert(ikm.end(), s2c_key.begin(), s2c_key.end());
+  ikm.insert(ikm.end(), c2s_nonce.begin(), c2s_nonce.end());
+  ikm.insert(ikm.end(), s2c_nonce.begin(), s2c_nonce.end());
+  auto resumption_secret = veil::crypto::hkdf_extract(anti_replay_nonce, ikm);
+  sodium_memzero(ikm.data(), ikm.size());
+
+  std::vector<std::uint8_t> info;
+  const std::array<std::uint8_t, 8> label{'V', 'E', 'I', 'L', '0', 'R', 'T', '1'};
+  info.insert(info.end(), label.begin(), label.end());
+  write_u64(info, init_ts);
+
+  auto keys = veil::crypto::derive_session_keys(resumption_secret, init_pub, info, initiator);
+  sodium_memzero(resumption_secret.data(), resumption_secret.size());
+  return keys;
+}
+
 bool timestamp_valid(std::uint64_t remote_ts, std::chrono::milliseconds skew,
                      const std::function<std::chrono::system_clock::time_point()>& now_fn) {
   const auto now_ms = to_millis(now_fn());
@@ -206,7 +245,8 @@ std::vector<std::uint8_t> HandshakeInitiator::create_init() {
   init_timestamp_ms_ = to_millis(now_fn_());
   init_sent_ = true;
 
-  auto hmac_payload = build_init_hmac_payload(init_timestamp_ms_, ephemeral_.public_key);
+  const auto offered = static_cast<std::uint8_t>(aead_suites_ | features_);
+  auto hmac_payload = build_init_hmac_payload(init_timestamp_ms_, ephemeral_.public_key, offered);
   const auto mac = crypto::hmac_sha256(psk_, hmac_payload);
 
   // Generate random padding for DPI resistance
@@ -215,12 +255,13 @@ std::vector<std::uint8_t> HandshakeInitiator::create_init() {
 
   // Build plaintext handshake packet (internal format with magic bytes + padding)
   std::vector<std::uint8_t> plaintext;
-  plaintext.reserve(kMagic.size() + 1 + 1 + 8 + ephemeral_.public_key.size() + mac.size() + 2 + padding_size);
+  plaintext.reserve(kMagic.size() + 1 + 1 + 8 + ephemeral_.public_key.size() + 1 + mac.size() + 2 + padding_size);
   plaintext.insert(plaintext.end(), kMagic.begin(), kMagic.end());
   plaintext.push_back(kVersion);
   plaintext.push_back(static_cast<std::uint8_t>(MessageType::kInit));
   write_u64(plaintext, init_timestamp_ms_);
   plaintext.insert(plaintext.end(), ephemeral_.public_key.begin(), ephemeral_.public_key.end());
+  plaintext.push_back(offered);  // AEAD suites offered (bit per crypto::AeadAlgorithm) | features
   plaintext.insert(plaintext.end(), mac.begin(), mac.end());
 
   // Append padding length (2 bytes, big-endian)
@@ -262,7 +303,7 @@ std::optional<HandshakeSession> HandshakeInitiator::consume_response(
   const auto& plaintext = *decrypted;
 
   // Minimum size: header + fields + padding_length (2 bytes)
-  const std::size_t min_size = kMagic.size() + 1 + 1 + 8 + 8 + 8 + 32 + 32 + 2;
+  const std::size_t min_size = kMagic.size() + 1 + 1 + 8 + 8 + 8 + 32 + 1 + 32 + 2;
   if (plaintext.size() < min_size) {
     return std::nullopt;
   }
@@ -292,13 +333,24 @@ std::optional<HandshakeSession> HandshakeInitiator::consume_response(
     return std::nullopt;
   }
 
-  const auto hmac_offset = 28 + responder_pub.size();
+  // The responder's choice and accepted features must be ones we offered.
+  const auto suite_offset = 28 + responder_pub.size();
+  const std::uint8_t suite_byte = plaintext[suite_offset];
+  const auto aead_suite = static_cast<std::uint8_t>(suite_byte & kAeadSuiteMask);
+  const auto accepted_features = static_cast<std::uint8_t>(suite_byte & ~kAeadSuiteMask);
+  if (aead_suite > static_cast<std::uint8_t>(crypto::AeadAlgorithm::kAesGcm) ||
+      (aead_suites_ & crypto::aead_suite_bit(static_cast<crypto::AeadAlgorithm>(aead_suite))) == 0 ||
+      (accepted_features & ~features_) != 0) {
+    return std::nullopt;
+  }
+
+  const auto hmac_offset = suite_offset + 1;
   std::array<std::uint8_t, crypto::kHmacSha256Len> provided_mac{};
   std::copy_n(plaintext.begin() + static_cast<std::ptrdiff_t>(hmac_offset), crypto::kHmacSha256Len, provided_mac.begin());
 
   const auto hmac_payload =
       build_hmac_payload(static_cast<std::uint8_t>(MessageType::kResponse), init_ts, resp_ts,
-                         session_id, init_pub, responder_pub);
+                         session_id, init_pub, responder_pub, suite_byte);
   const auto expected_mac = crypto::hmac_sha256(psk_, hmac_payload);
   if (!std::equal(expected_mac.begin(), expected_mac.end(), provided_mac.begin())) {
     return std::nullopt;
@@ -339,6 +391,10 @@ std::optional<HandshakeSession> HandshakeInitiator::consume_response(
       .initiator_ephemeral = init_pub,
       .responder_ephemeral = responder_pub,
       .client_id = client_id_,  // Issue #87: Include client_id in session
+      .aead = static_cast<crypto::AeadAlgorithm>(aead_suite),
+      .compact_frames = (accepted_features & kFeatureCompactFrames) != 0,
+      .fec = (accepted_features & kFeatureFec) != 0,
+      .ack_delay = (accepted_features & kFeatureAckDelay) != 0,
   };
   return session;
 }
@@ -384,7 +440,7 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
 
   // Minimum size: header + fields + HMAC + padding_length (2 bytes)
   constexpr std::size_t min_init_size =
-      kMagic.size() + 1 + 1 + 8 + crypto::kX25519PublicKeySize + crypto::kHmacSha256Len + 2;
+      kMagic.size() + 1 + 1 + 8 + crypto::kX25519PublicKeySize + 1 + crypto::kHmacSha256Len + 2;
   if (plaintext.size() < min_init_size) {
     sodium_memzero(handshake_key.data(), handshake_key.size());
     return std::nullopt;
@@ -418,12 +474,13 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
     return std::nullopt;  // Replay detected - silently ignore
   }
 
-  // Extract HMAC (32 bytes after the ephemeral public key)
-  const auto mac_offset = 12 + init_pub.size();
+  // AEAD suites offered by the initiator, then the HMAC.
+  const std::uint8_t offered_suites = plaintext[12 + init_pub.size()];
+  const auto mac_offset = 12 + init_pub.size() + 1;
   std::array<std::uint8_t, crypto::kHmacSha256Len> provided_mac{};
   std::copy_n(plaintext.begin() + static_cast<std::ptrdiff_t>(mac_offset), crypto::kHmacSha256Len, provided_mac.begin());
 
-  const auto hmac_payload = build_init_hmac_payload(init_ts, init_pub);
+  const auto hmac_payload = build_init_hmac_payload(init_ts, init_pub, offered_suites);
   const auto expected_mac = crypto::hmac_sha256(psk_, hmac_payload);
   if (!std::equal(expected_mac.begin(), expected_mac.end(), provided_mac.begin())) {
     sodium_memzero(handshake_key.data(), handshake_key.size());
@@ -466,9 +523,12 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
   const auto session_id = veil::crypto::random_uint64();
   const auto resp_ts = to_millis(now_fn_());
 
+  const auto aead = crypto::negotiate_aead(offered_suites & kAeadSuiteMask, aead_suites_);
+  const auto features = static_cast<std::uint8_t>(offered_suites & features_);
+  const auto suite_byte = static_cast<std::uint8_t>(static_cast<std::uint8_t>(aead) | features);
   auto hmac_payload_resp = build_hmac_payload(static_cast<std::uint8_t>(MessageType::kResponse),
                                               init_ts, resp_ts, session_id, init_pub,
-                                              responder_keys.public_key);
+                                              responder_keys.public_key, suite_byte);
   const auto mac = crypto::hmac_sha256(psk_, hmac_payload_resp);
 
   // Generate random padding for DPI resistance
@@ -477,7 +537,7 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
 
   // Build plaintext response
   std::vector<std::uint8_t> response_plaintext;
-  response_plaintext.reserve(kMagic.size() + 1 + 1 + 8 + 8 + 8 + responder_keys.public_key.size() + mac.size() + 2 + padding_size);
+  response_plaintext.reserve(kMagic.size() + 1 + 1 + 8 + 8 + 8 + responder_keys.public_key.size() + 1 + mac.size() + 2 + padding_size);
   response_plaintext.insert(response_plaintext.end(), kMagic.begin(), kMagic.end());
   response_plaintext.push_back(kVersion);
   response_plaintext.push_back(static_cast<std::uint8_t>(MessageType::kResponse));
@@ -486,6 +546,7 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
   write_u64(response_plaintext, session_id);
   response_plaintext.insert(response_plaintext.end(), responder_keys.public_key.begin(),
                             responder_keys.public_key.end());
+  response_plaintext.push_back(suite_byte);
   response_plaintext.insert(response_plaintext.end(), mac.begin(), mac.end());
 
   // Append padding length (2 bytes, big-endian)
@@ -507,6 +568,10 @@ std::optional<HandshakeResponder::Result> HandshakeResponder::handle_init(
       .initiator_ephemeral = init_pub,
       .responder_ephemeral = responder_keys.public_key,
       .client_id = {},  // No client_id for single-PSK responder
+      .aead = aead,
+      .compact_frames = (features & kFeatureCompactFrames) != 0,
+      .fec = (features & kFeatureFec) != 0,
+      .ack_delay = (features & kFeatureAckDelay) != 0,
   };
 
   return Result{.response = std::move(encrypted_response), .session = session};
@@ -587,7 +652,7 @@ MultiClientHandshakeResponder::process_decrypted_init(
     const std::string& client_id) {
   // Minimum size: header + fields + HMAC + padding_length (2 bytes)
   constexpr std::size_t min_init_size =
-      kMagic.size() + 1 + 1 + 8 + crypto::kX25519PublicKeySize + crypto::kHmacSha256Len + 2;
+      kMagic.size() + 1 + 1 + 8 + crypto::kX25519PublicKeySize + 1 + crypto::kHmacSha256Len + 2;
   if (plaintext.size() < min_init_size) {
     return std::nullopt;
   }
@@ -614,13 +679,14 @@ MultiClientHandshakeResponder::process_decrypted_init(
     return std::nullopt;  // Replay detected
   }
 
-  // Extract HMAC (32 bytes after the ephemeral public key)
-  const auto mac_offset = 12 + init_pub.size();
+  // AEAD suites offered by the initiator, then the HMAC.
+  const std::uint8_t offered_suites = plaintext[12 + init_pub.size()];
+  const auto mac_offset = 12 + init_pub.size() + 1;
   std::array<std::uint8_t, crypto::kHmacSha256Len> provided_mac{};
   std::copy_n(plaintext.begin() + static_cast<std::ptrdiff_t>(mac_offset), crypto::kHmacSha256Len,
               provided_mac.begin());
 
-  const auto hmac_payload = build_init_hmac_payload(init_ts, init_pub);
+  const auto hmac_payload = build_init_hmac_payload(init_ts, init_pub, offered_suites);
   const auto expected_mac = crypto::hmac_sha256(psk, hmac_payload);
   if (!std::equal(expected_mac.begin(), expected_mac.end(), provided_mac.begin())) {
     return std::nullopt;
@@ -659,9 +725,12 @@ MultiClientHandshakeResponder::process_decrypted_init(
   const auto session_id = veil::crypto::random_uint64();
   const auto resp_ts = to_millis(now_fn_());
 
+  const auto aead = crypto::negotiate_aead(offered_suites & kAeadSuiteMask, aead_suites_);
+  const auto features = static_cast<std::uint8_t>(offered_suites & features_);
+  const auto suite_byte = static_cast<std::uint8_t>(static_cast<std::uint8_t>(aead) | features);
   auto hmac_payload_resp = build_hmac_payload(static_cast<std::uint8_t>(MessageType::kResponse),
                                               init_ts, resp_ts, session_id, init_pub,
-                                              responder_keys.public_key);
+                                              responder_keys.public_key, suite_byte);
   const auto mac = crypto::hmac_sha256(psk, hmac_payload_resp);
 
   // Generate random padding for DPI resistance
@@ -671,7 +740,7 @@ MultiClientHandshakeResponder::process_decrypted_init(
   // Build plaintext response
   std::vector<std::uint8_t> response_plaintext;
   response_plaintext.reserve(kMagic.size() + 1 + 1 + 8 + 8 + 8 +
-                             responder_keys.public_key.size() + mac.size() + 2 + padding_size);
+                             responder_keys.public_key.size() + 1 + mac.size() + 2 + padding_size);
   response_plaintext.insert(response_plaintext.end(), kMagic.begin(), kMagic.end());
   response_plaintext.push_back(kVersion);
   response_plaintext.push_back(static_cast<std::uint8_t>(MessageType::kResponse));
@@ -680,6 +749,7 @@ MultiClientHandshakeResponder::process_decrypted_init(
   write_u64(response_plaintext, session_id);
   response_plaintext.insert(response_plaintext.end(), responder_keys.public_key.begin(),
                             responder_keys.public_key.end());
+  response_plaintext.push_back(suite_byte);
   response_plaintext.insert(response_plaintext.end(), mac.begin(), mac.end());
 
   // Append padding length (2 bytes, big-endian)
@@ -698,6 +768,10 @@ MultiClientHandshakeResponder::process_decrypted_init(
       .initiator_ephemeral = init_pub,
       .responder_ephemeral = responder_keys.public_key,
       .client_id = client_id,  // Issue #87: Include authenticated client_id
+      .aead = aead,
+      .compact_frames = (features & kFeatureCompactFrames) != 0,
+      .fec = (features & kFeatureFec) != 0,
+      .ack_delay = (features & kFeatureAckDelay) != 0,
   };
 
   return Result{.response = std::move(encrypted_response), .session = session};
@@ -730,6 +804,8 @@ ZeroRttInitiator::~ZeroRttInitiator() {
   sodium_memzero(anti_replay_nonce_.data(), anti_replay_nonce_.size());
   sodium_memzero(ticket_.cached_keys.send_key.data(), ticket_.cached_keys.send_key.size());
   sodium_memzero(ticket_.cached_keys.recv_key.data(), ticket_.cached_keys.recv_key.size());
+  sodium_memzero(resumed_keys_.send_key.data(), resumed_keys_.send_key.size());
+  sodium_memzero(resumed_keys_.recv_key.data(), resumed_keys_.recv_key.size());
 }
 
 std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
@@ -741,6 +817,10 @@ std::vector<std::uint8_t> ZeroRttInitiator::create_zero_rtt_init() {
   auto nonce_bytes = crypto::random_bytes(kAntiReplayNonceSize);
   std::copy_n(nonce_bytes.begin(), kAntiReplayNonceSize, anti_replay_nonce_.begin());
 
+  // Keys for early data and for the resumed session
+  resumed_keys_ = derive_resumption_keys(ticket_.cached_keys, true, init_timestamp_ms_,
+                                         ephemeral_.public_key, anti_replay_nonce_);
+
   // Build HMAC payload for 0-RTT INIT
   // Includes: magic, version, type, timestamp, ephemeral_pub, anti_replay_nonce
   // Note: ticket_data is not included — it is separately authenticated via AEAD (server-only key)
@@ -893,12 +973,11 @@ std::optional<HandshakeSession> ZeroRttInitiator::consume_zero_rtt_response(
     return std::nullopt;
   }
 
-  // 0-RTT accepted: use cached session keys from the ticket
-  // The ephemeral keys are not used for key derivation in 0-RTT
-  // (that's the trade-off for reduced latency)
+  // 0-RTT accepted: use the keys derived from the ticket's cached keys
+  // No DH is performed in 0-RTT (that's the trade-off for reduced latency)
   HandshakeSession session{
       .session_id = session_id,
-      .keys = ticket_.cached_keys,
+      .keys = resumed_keys_,
       .initiator_ephemeral = ephemeral_.public_key,
       .responder_ephemeral = {},  // No responder ephemeral in 0-RTT
       .client_id = ticket_.client_id,
@@ -1120,15 +1199,18 @@ std::optional<ZeroRttResponder::Result> ZeroRttResponder::handle_zero_rtt_init(
   // Ticket valid: accept 0-RTT
   const auto session_id = veil::crypto::random_uint64();
 
-  // Reconstruct session keys from ticket payload
-  // Note: The ticket stores keys from server's perspective (sent as responder),
-  // so we use them directly
-  crypto::SessionKeys session_keys{
+  // Reconstruct cached keys from ticket payload and derive the resumed session keys
+  // Note: The ticket stores keys from server's perspective (sent as responder)
+  crypto::SessionKeys cached_keys{
       .send_key = ticket_payload->send_key,
       .recv_key = ticket_payload->recv_key,
       .send_nonce = ticket_payload->send_nonce,
       .recv_nonce = ticket_payload->recv_nonce,
   };
+  const auto session_keys =
+      derive_resumption_keys(cached_keys, false, init_ts, init_pub, anti_replay_nonce);
+  sodium_memzero(cached_keys.send_key.data(), cached_keys.send_key.size());
+  sodium_memzero(cached_keys.recv_key.data(), cached_keys.recv_key.size());
 
   // Build accept HMAC payload
   std::vector<std::uint8_t> accept_hmac;
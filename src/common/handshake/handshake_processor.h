@@ -12,6 +12,7 @@
 
 #include "common/auth/client_registry.h"
 #include "common/crypto/crypto_engine.h"
+#include "common/crypto/hardware_crypto.h"
 #include "common/handshake/handshake_replay_cache.h"
 #include "common/handshake/session_ticket.h"
 #include "common/utils/rate_limiter.h"
@@ -30,12 +31,39 @@ enum class MessageType : std::uint8_t {
   kZeroRttReject = 5,   // Server rejects 0-RTT, fallback to 1-RTT (Issue #86)
 };
 
+/// The AEAD suite byte in INIT and RESPONSE carries suites in its low nibble
+/// and optional feature flags in its high nibble. The responder echoes the
+/// offered features it also supports; peers that predate a feature leave its
+/// bit clear, so both sides fall back to the old behaviour.
+inline constexpr std::uint8_t kAeadSuiteMask = 0x0F;
+/// Compact mux frame encoding (mux::FrameFormat::kCompact).
+inline constexpr std::uint8_t kFeatureCompactFrames = 0x10;
+/// Forward error correction repair frames (mux::RepairFrame).
+inline constexpr std::uint8_t kFeatureFec = 0x20;
+/// Compact ACK frames carry the receiver's ACK delay (mux::AckFrame::ack_delay).
+inline constexpr std::uint8_t kFeatureAckDelay = 0x40;
+
+inline void set_feature_bit(std::uint8_t& features, std::uint8_t bit, bool enabled) {
+  features = static_cast<std::uint8_t>(enabled ? (features | bit) : (features & ~bit));
+}
+
 struct HandshakeSession {
   std::uint64_t session_id;
   crypto::SessionKeys keys;
   std::array<std::uint8_t, crypto::kX25519PublicKeySize> initiator_ephemeral;
   std::array<std::uint8_t, crypto::kX25519PublicKeySize> responder_ephemeral;
   std::string client_id;  // Optional: identifies which client was authenticated (Issue #87)
+  // AEAD suite negotiated for the data channel. 0-RTT resumed sessions keep
+  // ChaCha20-Poly1305, since early data is sent before any negotiation.
+  crypto::AeadAlgorithm aead{crypto::AeadAlgorithm::kChaCha20Poly1305};
+  // Both peers use the compact mux frame encoding. False for 0-RTT sessions.
+  bool compact_frames{false};
+  // Both peers send FEC repair frames for their data packets (see
+  // transport/mux/fec.h). False for 0-RTT sessions.
+  bool fec{false};
+  // Both peers report their ACK delay in compact ACK frames. False for 0-RTT
+  // sessions.
+  bool ack_delay{false};
 };
 
 class HandshakeInitiator {
@@ -75,9 +103,26 @@ class HandshakeInitiator {
   /// Get the client_id associated with this initiator (may be empty).
   const std::string& client_id() const { return client_id_; }
 
+  /// AEAD suites offered in INIT (crypto::aead_suite_bit mask). Defaults to
+  /// crypto::local_aead_suites(); ChaCha20-Poly1305 is always included.
+  void set_aead_suites(std::uint8_t suites) {
+    aead_suites_ = static_cast<std::uint8_t>(suites | crypto::aead_suite_bit(crypto::AeadAlgorithm::kChaCha20Poly1305));
+  }
+
+  /// Offer the compact mux frame encoding (enabled by default).
+  void set_compact_frames(bool enabled) { set_feature_bit(features_, kFeatureCompactFrames, enabled); }
+
+  /// Offer forward error correction for lossy links (disabled by default).
+  void set_fec(bool enabled) { set_feature_bit(features_, kFeatureFec, enabled); }
+
+  /// Offer ACK delay reporting (enabled by default).
+  void set_ack_delay(bool enabled) { set_feature_bit(features_, kFeatureAckDelay, enabled); }
+
  private:
   std::vector<std::uint8_t> psk_;
   std::string client_id_;  // Issue #87: Optional client identifier
+  std::uint8_t aead_suites_{crypto::local_aead_suites()};
+  std::uint8_t features_{kFeatureCompactFrames | kFeatureAckDelay};
   std::chrono::milliseconds skew_tolerance_;
   std::function<Clock::time_point()> now_fn_;
 
@@ -111,8 +156,24 @@ class HandshakeResponder {
 
   std::optional<Result> handle_init(std::span<const std::uint8_t> init_bytes);
 
+  /// AEAD suites this responder accepts (see HandshakeInitiator::set_aead_suites).
+  void set_aead_suites(std::uint8_t suites) {
+    aead_suites_ = static_cast<std::uint8_t>(suites | crypto::aead_suite_bit(crypto::AeadAlgorithm::kChaCha20Poly1305));
+  }
+
+  /// Accept the compact mux frame encoding (enabled by default).
+  void set_compact_frames(bool enabled) { set_feature_bit(features_, kFeatureCompactFrames, enabled); }
+
+  /// Accept forward error correction when the initiator offers it (enabled by default).
+  void set_fec(bool enabled) { set_feature_bit(features_, kFeatureFec, enabled); }
+
+  /// Accept ACK delay reporting (enabled by default).
+  void set_ack_delay(bool enabled) { set_feature_bit(features_, kFeatureAckDelay, enabled); }
+
  private:
   std::vector<std::uint8_t> psk_;
+  std::uint8_t aead_suites_{crypto::local_aead_suites()};
+  std::uint8_t features_{kFeatureCompactFrames | kFeatureFec | kFeatureAckDelay};
   std::chrono::milliseconds skew_tolerance_;
   utils::TokenBucket rate_limiter_;
   HandshakeReplayCache replay_cache_;
@@ -181,6 +242,20 @@ class MultiClientHandshakeResponder {
   /// Get the client registry.
   std::shared_ptr<auth::ClientRegistry> registry() const { return registry_; }
 
+  /// AEAD suites this responder accepts (see HandshakeInitiator::set_aead_suites).
+  void set_aead_suites(std::uint8_t suites) {
+    aead_suites_ = static_cast<std::uint8_t>(suites | crypto::aead_suite_bit(crypto::AeadAlgorithm::kChaCha20Poly1305));
+  }
+
+  /// Accept the compact mux frame encoding (enabled by default).
+  void set_compact_frames(bool enabled) { set_feature_bit(features_, kFeatureCompactFrames, enabled); }
+
+  /// Accept forward error correction when the initiator offers it (enabled by default).
+  void set_fec(bool enabled) { set_feature_bit(features_, kFeatureFec, enabled); }
+
+  /// Accept ACK delay reporting (enabled by default).
+  void set_ack_delay(bool enabled) { set_feature_bit(features_, kFeatureAckDelay, enabled); }
+
  private:
   /// Internal helper to process a decrypted INIT message.
   std::optional<Result> process_decrypted_init(
@@ -190,6 +265,8 @@ class MultiClientHandshakeResponder {
       const std::string& client_id);
 
   std::shared_ptr<auth::ClientRegistry> registry_;
+  std::uint8_t aead_suites_{crypto::local_aead_suites()};
+  std::uint8_t features_{kFeatureCompactFrames | kFeatureFec | kFeatureAckDelay};
   std::chrono::milliseconds skew_tolerance_;
   utils::TokenBucket rate_limiter_;
   HandshakeReplayCache replay_cache_;
@@ -256,6 +333,12 @@ class ZeroRttInitiator {
   /// Check if 0-RTT was rejected (need to fallback to 1-RTT).
   bool was_rejected() const { return rejected_; }
 
+  /// Keys for early data sent in the same flight as the 0-RTT INIT.
+  /// Valid after create_zero_rtt_init(); the session returned on acceptance uses the same keys.
+  /// They are derived from the ticket's cached keys and the fresh INIT values, so a resumed
+  /// session never reuses the original session's (key, nonce) pairs.
+  const crypto::SessionKeys& early_keys() const { return resumed_keys_; }
+
  private:
   std::vector<std::uint8_t> psk_;
   SessionTicket ticket_;
@@ -263,6 +346,7 @@ class ZeroRttInitiator {
 
   crypto::KeyPair ephemeral_;
   std::array<std::uint8_t, kAntiReplayNonceSize> anti_replay_nonce_{};
+  crypto::SessionKeys resumed_keys_{};
   std::uint64_t init_timestamp_ms_{0};
   bool init_sent_{false};
   bool rejected_{false};
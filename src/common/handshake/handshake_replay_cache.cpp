@@ -1,76 +1,187 @@
 #include "common/handshake/handshake_replay_cache.h"
 
 #include <algorithm>
-#include <mutex>
+#include <bit>
+#include <stdexcept>
+
+#include "common/crypto/random.h"
 
 namespace veil::handshake {
 
+namespace {
+
+// Entry layout (one 64-bit word, 0 = empty slot):
+//   bit 63      : occupied
+//   bits 39..62 : timestamp bucket (24 bits, compared with wraparound)
+//   bits 0..38  : fingerprint of (timestamp, ephemeral key)
+constexpr std::uint64_t kOccupied = 1ULL << 63;
+constexpr unsigned kBucketShift = 39;
+constexpr std::uint64_t kBucketMask = (1ULL << 24) - 1;
+constexpr std::uint64_t kFingerprintMask = (1ULL << kBucketShift) - 1;
+
+// Buckets per time window. Expiry is exact to within one bucket.
+constexpr std::uint64_t kBucketsPerWindow = 64;
+
+constexpr std::size_t kMaxShards = 16;
+constexpr std::size_t kMinShardCapacity = 256;
+
+// splitmix64 finalizer.
+std::uint64_t mix64(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+std::uint64_t make_entry(std::uint64_t bucket, std::uint64_t hash) {
+  return kOccupied | ((bucket & kBucketMask) << kBucketShift) | (hash & kFingerprintMask);
+}
+
+std::uint64_t entry_bucket(std::uint64_t entry) { return (entry >> kBucketShift) & kBucketMask; }
+
+// Signed distance a - b between two 24-bit buckets.
+std::int64_t bucket_distance(std::uint64_t a, std::uint64_t b) {
+  const auto diff = static_cast<std::int64_t>((a - b) & kBucketMask);
+  return diff >= static_cast<std::int64_t>(1ULL << 23) ? diff - static_cast<std::int64_t>(1ULL << 24) : diff;
+}
+
+bool is_expired(std::uint64_t entry, std::uint64_t cutoff_bucket) {
+  return bucket_distance(entry_bucket(entry), cutoff_bucket) < 0;
+}
+
+}  // namespace
+
 HandshakeReplayCache::HandshakeReplayCache(std::size_t capacity,
                                            std::chrono::milliseconds time_window)
-    : capacity_(capacity), time_window_(time_window) {
+    : capacity_(capacity), time_window_(time_window), hash_key_(crypto::random_uint64()) {
   if (capacity_ == 0) {
     throw std::invalid_argument("replay cache capacity must be > 0");
   }
-}
 
-bool HandshakeReplayCache::mark_and_check(
-    std::uint64_t timestamp_ms,
-    const std::array<std::uint8_t, crypto::kX25519PublicKeySize>& ephemeral_key) {
-  std::lock_guard<std::mutex> lock(mutex_);
+  const auto window_ms = static_cast<std::uint64_t>(std::max<std::int64_t>(time_window_.count(), 1));
+  bucket_width_ms_ = std::max<std::uint64_t>(window_ms / kBucketsPerWindow, 1);
 
-  // Cleanup expired entries periodically (every ~100 insertions on average)
-  // This is a simple heuristic to avoid cleanup overhead on every call
-  static thread_local std::size_t call_count = 0;
-  if (++call_count % 100 == 0) {
-    cleanup_expired_locked(timestamp_ms);
+  // Only split into shards when each shard still has a useful number of slots,
+  // so small caches keep exact oldest-first eviction.
+  std::size_t shard_count = 1;
+  while (shard_count < kMaxShards && capacity_ / (shard_count * 2) >= kMinShardCapacity) {
+    shard_count *= 2;
   }
-
-  CacheKey key{.timestamp_ms = timestamp_ms, .ephemeral_key = ephemeral_key};
-
-  // Check if this key already exists (replay detected)
-  auto it = cache_map_.find(key);
-  if (it != cache_map_.end()) {
-    // Move to back of LRU list (most recently used)
-    lru_list_.splice(lru_list_.end(), lru_list_, it->second);
-    return true;  // Replay detected
+  shard_mask_ = shard_count - 1;
+  shards_ = std::make_unique<Shard[]>(shard_count);
+
+  // Size each shard for a load factor of at most 50% at full capacity.
+  for (std::size_t i = 0; i < shard_count; ++i) {
+    auto& shard = shards_[i];
+    shard.capacity = capacity_ / shard_count + (i < capacity_ % shard_count ? 1 : 0);
+    const std::size_t groups = std::bit_ceil(std::max<std::size_t>((shard.capacity * 2 + kWays - 1) / kWays, 1));
+    shard.first_group = group_count_;
+    shard.group_mask = groups - 1;
+    group_count_ += groups;
   }
+  groups_ = std::make_unique<Group[]>(group_count_);
+}
 
-  // New key - add to cache
-  // If at capacity, evict LRU entry
-  if (cache_map_.size() >= capacity_) {
-    evict_lru();
+std::uint64_t HandshakeReplayCache::fingerprint(
+    std::uint64_t timestamp_ms,
+    const std::array<std::uint8_t, crypto::kX25519PublicKeySize>& key) const {
+  std::uint64_t hash = mix64(hash_key_ ^ timestamp_ms);
+  for (std::size_t offset = 0; offset < key.size(); offset += 8) {
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < 8; ++i) {
+      word |= static_cast<std::uint64_t>(key[offset + i]) << (8 * i);
+    }
+    hash = mix64(hash ^ word);
   }
+  return hash;
+}
 
-  // Add to back of LRU list (most recently used)
-  lru_list_.push_back(key);
-  auto list_it = std::prev(lru_list_.end());
-  cache_map_[key] = list_it;
+std::uint64_t HandshakeReplayCache::bucket_of(std::uint64_t timestamp_ms) const {
+  return (timestamp_ms / bucket_width_ms_) & kBucketMask;
+}
 
-  return false;  // Not a replay
+std::uint64_t HandshakeReplayCache::cutoff_bucket(std::uint64_t current_time_ms) const {
+  const auto window_ms = static_cast<std::uint64_t>(time_window_.count());
+  return bucket_of(current_time_ms > window_ms ? current_time_ms - window_ms : 0);
 }
 
-std::size_t HandshakeReplayCache::cleanup_expired(std::uint64_t current_time_ms) {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return cleanup_expired_locked(current_time_ms);
+bool HandshakeReplayCache::mark_and_check(
+    std::uint64_t timestamp_ms,
+    const std::array<std::uint8_t, crypto::kX25519PublicKeySize>& ephemeral_key) {
+  const std::uint64_t hash = fingerprint(timestamp_ms, ephemeral_key);
+  const std::uint64_t entry = make_entry(bucket_of(timestamp_ms), hash);
+  const std::uint64_t cutoff = cutoff_bucket(timestamp_ms);
+
+  const std::uint64_t placement = mix64(hash);
+  auto& shard = shards_[placement & shard_mask_];
+  auto& group = groups_[shard.first_group + ((placement >> 4) & shard.group_mask)];
+
+  while (true) {
+    std::array<std::uint64_t, kWays> seen{};
+    std::size_t empty = kWays;
+    std::size_t expired = kWays;
+    std::size_t oldest = kWays;
+    for (std::size_t i = 0; i < kWays; ++i) {
+      seen[i] = group.slots[i].load();
+      if (seen[i] == entry) {
+        return true;  // Replay detected
+      }
+      if (seen[i] == 0) {
+        empty = std::min(empty, i);
+      } else if (is_expired(seen[i], cutoff)) {
+        expired = std::min(expired, i);
+      } else if (oldest == kWays ||
+                 bucket_distance(entry_bucket(seen[i]), entry_bucket(seen[oldest])) < 0) {
+        oldest = i;
+      }
+    }
+
+    // Prefer reusing dead entries; only grow the shard while it is under capacity.
+    std::size_t victim = expired;
+    if (victim == kWays) {
+      const bool shard_full = shard.count.load() >= shard.capacity;
+      victim = (empty != kWays && (!shard_full || oldest == kWays)) ? empty : oldest;
+    }
+
+    std::uint64_t expected = seen[victim];
+    if (!group.slots[victim].compare_exchange_strong(expected, entry)) {
+      continue;  // Lost a race for this slot; rescan the group.
+    }
+    if (seen[victim] == 0) {
+      shard.count.fetch_add(1);
+    }
+
+    // Another thread may have inserted the same entry into a different slot
+    // concurrently. Report a replay; the copy in the lower slot is kept.
+    for (std::size_t i = 0; i < kWays; ++i) {
+      if (i != victim && group.slots[i].load() == entry) {
+        std::uint64_t ours = entry;
+        if (i < victim && group.slots[victim].compare_exchange_strong(ours, 0)) {
+          shard.count.fetch_sub(1);
+        }
+        return true;
+      }
+    }
+    return false;  // Not a replay
+  }
 }
 
-std::size_t HandshakeReplayCache::cleanup_expired_locked(std::uint64_t current_time_ms) {
-  // Assumes mutex is already held by caller
+std::size_t HandshakeReplayCache::cleanup_expired(std::uint64_t current_time_ms) {
+  const std::uint64_t cutoff = cutoff_bucket(current_time_ms);
   std::size_t removed = 0;
-  const std::uint64_t cutoff_ms =
-      current_time_ms > static_cast<std::uint64_t>(time_window_.count())  // NOLINT(modernize-use-integer-sign-comparison)
-          ? current_time_ms - static_cast<std::uint64_t>(time_window_.count())
-          : 0;
-
-  // Remove entries with timestamps older than cutoff
-  auto it = lru_list_.begin();
-  while (it != lru_list_.end()) {
-    if (it->timestamp_ms < cutoff_ms) {
-      cache_map_.erase(*it);
-      it = lru_list_.erase(it);
-      ++removed;
-    } else {
-      ++it;
+
+  for (std::size_t s = 0; s <= shard_mask_; ++s) {
+    auto& shard = shards_[s];
+    for (std::size_t g = 0; g <= shard.group_mask; ++g) {
+      for (auto& slot : groups_[shard.first_group + g].slots) {
+        std::uint64_t value = slot.load();
+        if (value != 0 && is_expired(value, cutoff) && slot.compare_exchange_strong(value, 0)) {
+          shard.count.fetch_sub(1);
+          ++removed;
+        }
+      }
     }
   }
 
@@ -78,26 +189,22 @@ std::size_t HandshakeReplayCache::cleanup_expired_locked(std::uint64_t current_t
 }
 
 std::size_t HandshakeReplayCache::size() const {
-  std::lock_guard<std::mutex> lock(mutex_);
-  return cache_map_.size();
+  std::size_t total = 0;
+  for (std::size_t s = 0; s <= shard_mask_; ++s) {
+    total += shards_[s].count.load();
+  }
+  return total;
 }
 
 void HandshakeReplayCache::clear() {
-  std::lock_guard<std::mutex> lock(mutex_);
-  lru_list_.clear();
-  cache_map_.clear();
-}
-
-void HandshakeReplayCache::evict_lru() {
-  // Assumes mutex is already held by caller
-  if (lru_list_.empty()) {
-    return;
+  for (std::size_t g = 0; g < group_count_; ++g) {
+    for (auto& slot : groups_[g].slots) {
+      slot.store(0);
+    }
+  }
+  for (std::size_t s = 0; s <= shard_mask_; ++s) {
+    shards_[s].count.store(0);
   }
-
-  // Remove least recently used (front of list)
-  const CacheKey& lru_key = lru_list_.front();
-  cache_map_.erase(lru_key);
-  lru_list_.pop_front();
 }
 
 }  // namespace veil::handshake
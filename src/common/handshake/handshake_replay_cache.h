@@ -1,19 +1,18 @@
 #pragma once
 
 #include <array>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
-#include <list>
-#include <mutex>
-#include <optional>
-#include <unordered_map>
+#include <memory>
 
 #include "common/crypto/crypto_engine.h"
 
 namespace veil::handshake {
 
 /**
- * LRU Replay Cache for handshake INIT messages.
+ * Replay cache for handshake INIT messages.
  *
  * Prevents replay attacks by tracking recently seen (timestamp, ephemeral_public_key) pairs.
  * When an INIT packet arrives:
@@ -22,56 +21,32 @@ namespace veil::handshake {
  * 3. If duplicate, silently drop (anti-probing requirement)
  *
  * Implementation details:
- * - Fixed capacity with LRU eviction policy
- * - O(1) lookup, insert, and eviction operations
- * - Automatic cleanup of expired entries
+ * - Fixed-capacity open-addressing table allocated once at construction;
+ *   no allocation per entry.
+ * - Each entry is a single 64-bit word packing a timestamp bucket and a keyed
+ *   hash of (timestamp, ephemeral_key). The hash key is random per instance,
+ *   so remote peers cannot aim collisions at a particular slot.
+ * - Entries live in 8-way, cache-line sized groups. A key maps to one group;
+ *   lookup and insert touch only that cache line.
+ * - Time-bucket expiry: entries whose bucket is older than the time window
+ *   are dead and get overwritten in place. When a group (or the shard) is
+ *   full, the entry with the oldest bucket is evicted.
+ * - Groups are split into shards with independent, cache-line padded entry
+ *   counters, so concurrent inserts do not contend on a shared counter.
  *
  * Thread Safety:
- *   This class IS thread-safe. All public methods are protected by an internal
- *   mutex, allowing safe concurrent access from multiple threads. This is
- *   necessary because handshake processing may occur on different threads
- *   than the main event loop.
+ *   This class IS thread-safe and lock-free. Slots are claimed with a
+ *   compare-and-swap, so mark_and_check() can be called concurrently from any
+ *   number of threads. If the same INIT is inserted by two threads at once,
+ *   at least one of them reports a replay (both may, in which case the
+ *   client simply retries the handshake).
  *
- *   Note: This is one of the few classes in VEIL that provides internal
- *   synchronization. Most other components rely on single-threaded access
- *   patterns enforced by the event loop.
+ *   clear() is not atomic with respect to concurrent inserts.
  *
  * @see docs/thread_model.md for the VEIL threading model documentation.
  */
 class HandshakeReplayCache {
  public:
-  /**
-   * Entry identifier combining timestamp and ephemeral public key.
-   * This uniquely identifies each handshake INIT message.
-   */
-  struct CacheKey {
-    std::uint64_t timestamp_ms;
-    std::array<std::uint8_t, crypto::kX25519PublicKeySize> ephemeral_key;
-
-    bool operator==(const CacheKey& other) const {
-      return timestamp_ms == other.timestamp_ms && ephemeral_key == other.ephemeral_key;
-    }
-  };
-
-  /**
-   * Hash function for CacheKey to use in unordered_map.
-   */
-  struct CacheKeyHash {
-    std::size_t operator()(const CacheKey& key) const noexcept {
-      // Combine timestamp hash with first 8 bytes of ephemeral key
-      std::size_t hash = std::hash<std::uint64_t>{}(key.timestamp_ms);
-
-      // Mix in ephemeral key bytes (use first 8 bytes for efficiency)
-      std::uint64_t key_prefix = 0;
-      for (std::size_t i = 0; i < 8 && i < key.ephemeral_key.size(); ++i) {
-        key_prefix = (key_prefix << 8) | key.ephemeral_key[i];
-      }
-      hash ^= std::hash<std::uint64_t>{}(key_prefix) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
-
-      return hash;
-    }
-  };
-
   /**
    * Construct replay cache with specified capacity and time window.
    *
@@ -96,7 +71,8 @@ class HandshakeReplayCache {
 
   /**
    * Remove entries older than the time window.
-   * Called automatically during mark_and_check, but can be called manually for cleanup.
+   * Expired entries are also reused in place by mark_and_check, so calling this
+   * is only needed to reclaim them eagerly (e.g. before reading size()).
    *
    * @param current_time_ms Current time in milliseconds
    * @return Number of entries removed
@@ -119,21 +95,33 @@ class HandshakeReplayCache {
   void clear();
 
  private:
-  using LruList = std::list<CacheKey>;
-  using LruIterator = LruList::iterator;
-  using CacheMap = std::unordered_map<CacheKey, LruIterator, CacheKeyHash>;
+  static constexpr std::size_t kWays = 8;
 
-  void evict_lru();
-  void touch(const CacheKey& key);
-  std::size_t cleanup_expired_locked(std::uint64_t current_time_ms);
+  struct alignas(64) Group {
+    std::array<std::atomic<std::uint64_t>, kWays> slots{};
+  };
+
+  struct alignas(64) Shard {
+    std::atomic<std::size_t> count{0};
+    std::size_t capacity{0};
+    std::size_t first_group{0};
+    std::size_t group_mask{0};
+  };
+
+  std::uint64_t fingerprint(std::uint64_t timestamp_ms,
+                            const std::array<std::uint8_t, crypto::kX25519PublicKeySize>& key) const;
+  std::uint64_t bucket_of(std::uint64_t timestamp_ms) const;
+  std::uint64_t cutoff_bucket(std::uint64_t current_time_ms) const;
 
   const std::size_t capacity_;
   const std::chrono::milliseconds time_window_;
+  std::uint64_t bucket_width_ms_{1};
+  std::uint64_t hash_key_{0};
 
-  LruList lru_list_;           // Most recently used at back, least recently used at front
-  CacheMap cache_map_;         // Maps CacheKey -> position in LRU list
-
-  mutable std::mutex mutex_;   // Protects all internal state
+  std::size_t shard_mask_{0};
+  std::unique_ptr<Shard[]> shards_;
+  std::size_t group_count_{0};
+  std::unique_ptr<Group[]> groups_;
 };
 
 }  // namespace veil::handshake
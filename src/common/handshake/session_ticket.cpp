@@ -3,11 +3,15 @@
 #include <sodium.h>
 
 #include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdint>
 #include <cstring>
+#include <fstream>
 #include <optional>
 #include <span>
+#include <stdexcept>
+#include <string_view>
 #include <vector>
 
 #include "common/crypto/random.h"
@@ -37,6 +41,12 @@ std::uint64_t read_u64_be(const std::uint8_t* data) {
   return value;
 }
 
+// Ticket epoch prefix (big-endian), also bound to the ciphertext as AAD.
+constexpr std::size_t kTicketEpochSize = 4;
+
+// Domain separation label for per-epoch ticket key derivation.
+constexpr std::string_view kEpochKeyLabel = "veil-ticket-epoch";
+
 // Serialize TicketPayload into bytes for encryption.
 // Format: issued_at_ms(8) | client_id_hash(8) | send_key(32) | recv_key(32) | send_nonce(12) | recv_nonce(12)
 // Total: 104 bytes
@@ -104,16 +114,106 @@ namespace veil::handshake {
 
 SessionTicketManager::SessionTicketManager(std::chrono::milliseconds ticket_lifetime,
                                            std::function<Clock::time_point()> now_fn)
-    : ticket_lifetime_(ticket_lifetime), now_fn_(std::move(now_fn)) {
-  // Generate a random ticket encryption key
+    : SessionTicketManager(SessionTicketConfig{.ticket_lifetime = ticket_lifetime,
+                                               .key_rotation_interval = ticket_lifetime},
+                           std::move(now_fn)) {}
+
+SessionTicketManager::SessionTicketManager(SessionTicketConfig config,
+                                           std::function<Clock::time_point()> now_fn)
+    : config_(config),
+      now_fn_(std::move(now_fn)),
+      nonce_filter_(config_.anti_replay_window, config_.anti_replay_capacity) {
+  if (config_.key_rotation_interval.count() <= 0) {
+    throw std::invalid_argument("key_rotation_interval must be > 0");
+  }
+  // Generate a random master key; load_key_file() replaces it with a shared one.
   auto key_bytes = crypto::random_bytes(kTicketKeySize);
-  std::copy_n(key_bytes.begin(), kTicketKeySize, ticket_key_.begin());
+  std::copy_n(key_bytes.begin(), kTicketKeySize, master_key_.begin());
   sodium_memzero(key_bytes.data(), key_bytes.size());
 }
 
 SessionTicketManager::~SessionTicketManager() {
-  // SECURITY: Clear ticket encryption key
-  sodium_memzero(ticket_key_.data(), ticket_key_.size());
+  // SECURITY: Clear master and derived ticket keys
+  sodium_memzero(master_key_.data(), master_key_.size());
+  for (auto& epoch_key : epoch_keys_) {
+    sodium_memzero(epoch_key.key.data(), epoch_key.key.size());
+  }
+}
+
+void SessionTicketManager::set_master_key(std::span<const std::uint8_t, kTicketKeySize> master_key) {
+  std::unique_lock lock(key_mutex_);
+  std::copy(master_key.begin(), master_key.end(), master_key_.begin());
+  for (auto& epoch_key : epoch_keys_) {
+    sodium_memzero(epoch_key.key.data(), epoch_key.key.size());
+    epoch_key.valid = false;
+  }
+}
+
+bool SessionTicketManager::load_key_file(const std::string& path, std::error_code& ec) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    ec = std::error_code(errno, std::generic_category());
+    return false;
+  }
+  // Read one byte more than needed to reject files of the wrong size.
+  std::array<std::uint8_t, kTicketKeySize + 1> buffer{};
+  file.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+  const bool exact_size = file.gcount() == static_cast<std::streamsize>(kTicketKeySize);
+  if (exact_size) {
+    set_master_key(std::span<const std::uint8_t, kTicketKeySize>(buffer.data(), kTicketKeySize));
+  }
+  sodium_memzero(buffer.data(), buffer.size());
+  if (!exact_size) {
+    ec = std::make_error_code(std::errc::io_error);
+    return false;
+  }
+  return true;
+}
+
+std::uint32_t SessionTicketManager::epoch_at(std::uint64_t now_ms) const {
+  return static_cast<std::uint32_t>(now_ms / static_cast<std::uint64_t>(config_.key_rotation_interval.count()));
+}
+
+std::uint32_t SessionTicketManager::current_epoch() const { return epoch_at(to_millis(now_fn_())); }
+
+std::array<std::uint8_t, kTicketKeySize> SessionTicketManager::derive_epoch_key(std::uint32_t epoch) const {
+  // Caller holds key_mutex_.
+  std::vector<std::uint8_t> info(kEpochKeyLabel.begin(), kEpochKeyLabel.end());
+  for (int shift = 24; shift >= 0; shift -= 8) {
+    info.push_back(static_cast<std::uint8_t>((epoch >> shift) & 0xFF));
+  }
+  auto mac = crypto::hmac_sha256(master_key_, info);
+  std::array<std::uint8_t, kTicketKeySize> key{};
+  std::copy_n(mac.begin(), key.size(), key.begin());
+  sodium_memzero(mac.data(), mac.size());
+  return key;
+}
+
+std::optional<std::array<std::uint8_t, kTicketKeySize>> SessionTicketManager::key_for_epoch(
+    std::uint32_t epoch, std::uint64_t now_ms) {
+  // Accept the previous and next epoch too: tickets issued just before a
+  // rollover, and workers whose clocks are slightly ahead.
+  const auto distance = static_cast<std::int32_t>(epoch - epoch_at(now_ms));
+  if (distance < -1 || distance > 1) {
+    return std::nullopt;
+  }
+
+  auto& slot = epoch_keys_[epoch % epoch_keys_.size()];
+  {
+    std::shared_lock lock(key_mutex_);
+    if (slot.valid && slot.epoch == epoch) {
+      return slot.key;
+    }
+  }
+
+  std::unique_lock lock(key_mutex_);
+  if (!slot.valid || slot.epoch != epoch) {
+    sodium_memzero(slot.key.data(), slot.key.size());
+    slot.key = derive_epoch_key(epoch);
+    slot.epoch = epoch;
+    slot.valid = true;
+  }
+  return slot.key;
 }
 
 SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys,
@@ -136,27 +236,35 @@ SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys
   sodium_memzero(payload.send_key.data(), payload.send_key.size());
   sodium_memzero(payload.recv_key.data(), payload.recv_key.size());
 
-  // Encrypt the payload with the ticket key
-  // Format: [12-byte nonce][encrypted payload + 16-byte AEAD tag]
+  // Encrypt the payload with the current epoch's ticket key
+  // Format: [4-byte epoch][12-byte nonce][encrypted payload + 16-byte AEAD tag]
   auto nonce_bytes = crypto::random_bytes(crypto::kNonceLen);
   std::array<std::uint8_t, crypto::kNonceLen> nonce{};
   std::copy_n(nonce_bytes.begin(), nonce.size(), nonce.begin());
 
-  auto ciphertext = crypto::aead_encrypt(ticket_key_, nonce, {}, plaintext);
+  const std::uint32_t epoch = epoch_at(now_ms);
+  std::array<std::uint8_t, kTicketEpochSize> epoch_bytes{};
+  for (std::size_t i = 0; i < kTicketEpochSize; ++i) {
+    epoch_bytes[i] = static_cast<std::uint8_t>((epoch >> (8 * (kTicketEpochSize - 1 - i))) & 0xFF);
+  }
+  auto ticket_key = key_for_epoch(epoch, now_ms);
+  auto ciphertext = crypto::aead_encrypt(*ticket_key, nonce, epoch_bytes, plaintext);
 
-  // SECURITY: Clear plaintext after encryption
+  // SECURITY: Clear plaintext and key copy after encryption
   sodium_memzero(plaintext.data(), plaintext.size());
+  sodium_memzero(ticket_key->data(), ticket_key->size());
 
-  // Build ticket data: nonce + ciphertext
+  // Build ticket data: epoch + nonce + ciphertext
   std::vector<std::uint8_t> ticket_data;
-  ticket_data.reserve(nonce.size() + ciphertext.size());
+  ticket_data.reserve(epoch_bytes.size() + nonce.size() + ciphertext.size());
+  ticket_data.insert(ticket_data.end(), epoch_bytes.begin(), epoch_bytes.end());
   ticket_data.insert(ticket_data.end(), nonce.begin(), nonce.end());
   ticket_data.insert(ticket_data.end(), ciphertext.begin(), ciphertext.end());
 
   SessionTicket ticket{
       .ticket_data = std::move(ticket_data),
       .issued_at_ms = now_ms,
-      .lifetime_ms = static_cast<std::uint64_t>(ticket_lifetime_.count()),
+      .lifetime_ms = static_cast<std::uint64_t>(config_.ticket_lifetime.count()),
       .cached_keys = keys,
       .client_id = client_id,
   };
@@ -166,21 +274,34 @@ SessionTicket SessionTicketManager::issue_ticket(const crypto::SessionKeys& keys
 
 std::optional<TicketPayload> SessionTicketManager::validate_ticket(
     std::span<const std::uint8_t> ticket_data) {
-  // Minimum size: nonce(12) + payload(104) + tag(16)
-  constexpr std::size_t min_ticket_size = crypto::kNonceLen + kTicketPayloadSize + kAeadTagLen;
-  if (ticket_data.size() != min_ticket_size) {
+  // Exact size: epoch(4) + nonce(12) + payload(104) + tag(16)
+  constexpr std::size_t ticket_size = kTicketEpochSize + crypto::kNonceLen + kTicketPayloadSize + kAeadTagLen;
+  if (ticket_data.size() != ticket_size) {
     return std::nullopt;
   }
 
+  // Extract epoch and look up its key
+  const auto epoch_bytes = ticket_data.first(kTicketEpochSize);
+  std::uint32_t epoch = 0;
+  for (const auto byte : epoch_bytes) {
+    epoch = (epoch << 8) | byte;
+  }
+  const auto now_ms = to_millis(now_fn_());
+  auto ticket_key = key_for_epoch(epoch, now_ms);
+  if (!ticket_key.has_value()) {
+    return std::nullopt;  // Ticket key has been rotated out
+  }
+
   // Extract nonce
   std::array<std::uint8_t, crypto::kNonceLen> nonce{};
-  std::copy_n(ticket_data.begin(), nonce.size(), nonce.begin());
+  std::copy_n(ticket_data.begin() + kTicketEpochSize, nonce.size(), nonce.begin());
 
   // Extract ciphertext
-  auto ciphertext = ticket_data.subspan(crypto::kNonceLen);
+  auto ciphertext = ticket_data.subspan(kTicketEpochSize + crypto::kNonceLen);
 
   // Decrypt
-  auto plaintext = crypto::aead_decrypt(ticket_key_, nonce, {}, ciphertext);
+  auto plaintext = crypto::aead_decrypt(*ticket_key, nonce, epoch_bytes, ciphertext);
+  sodium_memzero(ticket_key->data(), ticket_key->size());
   if (!plaintext.has_value()) {
     return std::nullopt;
   }
@@ -195,8 +316,7 @@ std::optional<TicketPayload> SessionTicketManager::validate_ticket(
   }
 
   // Check ticket expiry
-  const auto now_ms = to_millis(now_fn_());
-  if (now_ms > payload->issued_at_ms + static_cast<std::uint64_t>(ticket_lifetime_.count())) {
+  if (now_ms > payload->issued_at_ms + static_cast<std::uint64_t>(config_.ticket_lifetime.count())) {
     // SECURITY: Clear expired payload keys
     sodium_memzero(payload->send_key.data(), payload->send_key.size());
     sodium_memzero(payload->recv_key.data(), payload->recv_key.size());
@@ -208,46 +328,12 @@ std::optional<TicketPayload> SessionTicketManager::validate_ticket(
 
 bool SessionTicketManager::check_and_mark_nonce(
     std::span<const std::uint8_t, kAntiReplayNonceSize> nonce) {
-  // FNV-1a hash the nonce for compact storage.
-  // Trade-off: with ~4096 active nonces, collision probability is ~2^-49 (negligible).
-  // A hash collision would cause a false positive (legitimate request falsely rejected as replay),
-  // which is acceptable for this use case — the client simply falls back to a 1-RTT handshake.
-  std::uint64_t nonce_hash = 14695981039346656037ULL;
-  for (std::size_t i = 0; i < kAntiReplayNonceSize; ++i) {
-    nonce_hash ^= static_cast<std::uint64_t>(nonce[i]);
-    nonce_hash *= 1099511628211ULL;
-  }
-
-  const auto now_ms = to_millis(now_fn_());
-  const auto expiry_ms = now_ms + static_cast<std::uint64_t>(ticket_lifetime_.count());
-
-  std::lock_guard lock(nonce_mutex_);
-
-  auto it = used_nonces_.find(nonce_hash);
-  if (it != used_nonces_.end()) {
-    return true;  // Replay detected
-  }
-
-  // Limit nonce cache size
-  if (used_nonces_.size() >= kMaxTotalTickets) {
-    cleanup_expired_nonces();
-  }
-
-  used_nonces_[nonce_hash] = expiry_ms;
-  return false;
+  // A Bloom filter false positive rejects a legitimate request as a replay,
+  // which is acceptable here — the client simply falls back to a 1-RTT handshake.
+  return nonce_filter_.check_and_insert(nonce, to_millis(now_fn_()));
 }
 
-void SessionTicketManager::cleanup_expired_nonces() {
-  // Note: caller must hold nonce_mutex_ (or this is called from check_and_mark_nonce which holds it)
-  const auto now_ms = to_millis(now_fn_());
-  for (auto it = used_nonces_.begin(); it != used_nonces_.end();) {
-    if (it->second <= now_ms) {
-      it = used_nonces_.erase(it);
-    } else {
-      ++it;
-    }
-  }
-}
+void SessionTicketManager::cleanup_expired_nonces() { nonce_filter_.rotate(to_millis(now_fn_())); }
 
 std::uint64_t SessionTicketManager::fnv1a_hash(const std::string& str) {
   // FNV-1a 64-bit hash
@@ -259,6 +345,29 @@ std::uint64_t SessionTicketManager::fnv1a_hash(const std::string& str) {
   return hash;
 }
 
+// =============================================================================
+// Ticket Message Encoding
+// =============================================================================
+
+std::vector<std::uint8_t> encode_ticket_message(const SessionTicket& ticket) {
+  std::vector<std::uint8_t> message(8 + ticket.ticket_data.size());
+  write_u64_be(message.data(), ticket.lifetime_ms);
+  std::copy(ticket.ticket_data.begin(), ticket.ticket_data.end(), message.begin() + 8);
+  return message;
+}
+
+std::optional<SessionTicket> decode_ticket_message(std::span<const std::uint8_t> message,
+                                                   std::uint64_t received_at_ms) {
+  if (message.size() <= 8 || message.size() - 8 > kMaxTicketDataSize) {
+    return std::nullopt;
+  }
+  SessionTicket ticket;
+  ticket.lifetime_ms = read_u64_be(message.data());
+  ticket.issued_at_ms = received_at_ms;
+  ticket.ticket_data.assign(message.begin() + 8, message.end());
+  return ticket;
+}
+
 // =============================================================================
 // SessionTicketStore Implementation
 // =============================================================================
@@ -6,11 +6,15 @@
 #include <functional>
 #include <mutex>
 #include <optional>
+#include <shared_mutex>
+#include <span>
 #include <string>
+#include <system_error>
 #include <unordered_map>
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/handshake/anti_replay_filter.h"
 
 namespace veil::handshake {
 
@@ -31,6 +35,28 @@ inline constexpr std::size_t kAntiReplayNonceSize = 16;
 /// Size of the ticket encryption key (server-only secret).
 inline constexpr std::size_t kTicketKeySize = 32;
 
+/// How long a 0-RTT anti-replay nonce is remembered by default.
+/// Must cover the handshake timestamp skew tolerance: older INITs are already
+/// rejected by the timestamp check.
+inline constexpr auto kDefaultAntiReplayWindow = std::chrono::minutes(2);
+
+/// Configuration for SessionTicketManager.
+struct SessionTicketConfig {
+  /// How long tickets remain valid.
+  std::chrono::milliseconds ticket_lifetime{
+      std::chrono::duration_cast<std::chrono::milliseconds>(kDefaultTicketLifetime)};
+  /// Ticket keys are derived per epoch of this length from the master key.
+  /// Tickets from the previous, current and next epoch are accepted, so this
+  /// should not be shorter than ticket_lifetime.
+  std::chrono::milliseconds key_rotation_interval{
+      std::chrono::duration_cast<std::chrono::milliseconds>(kDefaultTicketLifetime)};
+  /// Minimum time an anti-replay nonce is remembered.
+  std::chrono::milliseconds anti_replay_window{
+      std::chrono::duration_cast<std::chrono::milliseconds>(kDefaultAntiReplayWindow)};
+  /// Expected 0-RTT attempts per anti-replay window (sizes the filter).
+  std::size_t anti_replay_capacity{static_cast<std::size_t>(1) << 16};
+};
+
 /// Session ticket issued by the server after a successful handshake.
 /// The client caches this and presents it on reconnection for 0-RTT.
 ///
@@ -62,6 +88,20 @@ struct SessionTicket {
   }
 };
 
+/// Maximum ticket_data size accepted in a ticket message.
+inline constexpr std::size_t kMaxTicketDataSize = 1024;
+
+/// Encode a ticket for delivery to the client (payload of a kSessionTicket control frame).
+/// Format: lifetime_ms(8) | ticket_data(var). Cached keys never leave the server.
+std::vector<std::uint8_t> encode_ticket_message(const SessionTicket& ticket);
+
+/// Decode a ticket message received from the server.
+/// The returned ticket has ticket_data, lifetime_ms and issued_at_ms set; the caller
+/// fills in cached_keys (and client_id) from its own side of the session.
+/// @return nullopt if the message is malformed.
+std::optional<SessionTicket> decode_ticket_message(std::span<const std::uint8_t> message,
+                                                   std::uint64_t received_at_ms);
+
 /// Internal ticket payload stored on the server side.
 /// This is what gets encrypted into the opaque ticket_data.
 struct TicketPayload {
@@ -75,6 +115,18 @@ struct TicketPayload {
 
 /// Server-side ticket manager that issues and validates session tickets.
 ///
+/// Ticket keys: a 32-byte master key (random, or loaded from a key file
+/// shared by all server workers) derives one ticket key per rotation epoch.
+/// Each ticket carries its epoch, so any worker holding the same master key
+/// can validate it, including after a restart, and keys roll over without
+/// coordination between processes.
+///
+/// Ticket format: epoch(4) | nonce(12) | AEAD(payload) with epoch as AAD.
+///
+/// Anti-replay: 0-RTT nonces go into a sharded, time-bucketed Bloom filter
+/// pair (AntiReplayFilter). This state is per process; the INIT timestamp
+/// check bounds how long a cross-worker replay could be attempted.
+///
 /// Thread safety: All public methods are thread-safe (internally synchronized).
 ///
 /// Usage:
@@ -94,14 +146,18 @@ class SessionTicketManager {
  public:
   using Clock = std::chrono::system_clock;
 
-  /// Create a ticket manager with a random encryption key.
-  /// @param ticket_lifetime How long tickets remain valid.
+  /// Create a ticket manager with a random master key.
+  /// @param ticket_lifetime How long tickets remain valid (also used as the key rotation interval).
   /// @param now_fn Clock function for timestamp generation.
   explicit SessionTicketManager(
       std::chrono::milliseconds ticket_lifetime =
           std::chrono::duration_cast<std::chrono::milliseconds>(kDefaultTicketLifetime),
       std::function<Clock::time_point()> now_fn = Clock::now);
 
+  /// Create a ticket manager with a random master key and explicit configuration.
+  explicit SessionTicketManager(SessionTicketConfig config,
+                                std::function<Clock::time_point()> now_fn = Clock::now);
+
   /// SECURITY: Destructor clears ticket encryption key.
   ~SessionTicketManager();
 
@@ -129,23 +185,50 @@ class SessionTicketManager {
   /// @return true if the nonce was already used (replay detected).
   bool check_and_mark_nonce(std::span<const std::uint8_t, kAntiReplayNonceSize> nonce);
 
-  /// Remove expired nonces from the anti-replay cache.
+  /// Release anti-replay state for time buckets that have passed.
   void cleanup_expired_nonces();
 
+  /// Replace the master key (e.g. with one shared by all server workers).
+  /// Tickets issued under the previous master key stop validating.
+  void set_master_key(std::span<const std::uint8_t, kTicketKeySize> master_key);
+
+  /// Load the master key from a file containing exactly 32 raw bytes
+  /// (generate with: head -c 32 /dev/urandom > ticket.key).
+  /// @return true on success; on failure ec is set and the current key is kept.
+  bool load_key_file(const std::string& path, std::error_code& ec);
+
+  /// Epoch whose key is used for newly issued tickets.
+  std::uint32_t current_epoch() const;
+
   /// Get the current ticket lifetime.
-  std::chrono::milliseconds ticket_lifetime() const { return ticket_lifetime_; }
+  std::chrono::milliseconds ticket_lifetime() const { return config_.ticket_lifetime; }
 
  private:
+  struct EpochKey {
+    std::uint32_t epoch{0};
+    bool valid{false};
+    std::array<std::uint8_t, kTicketKeySize> key{};
+  };
+
   /// Compute FNV-1a hash of a string for fast lookup.
   static std::uint64_t fnv1a_hash(const std::string& str);
 
-  std::array<std::uint8_t, kTicketKeySize> ticket_key_{};
-  std::chrono::milliseconds ticket_lifetime_;
+  std::uint32_t epoch_at(std::uint64_t now_ms) const;
+  /// Key for an epoch within one of the current epoch, or nullopt.
+  std::optional<std::array<std::uint8_t, kTicketKeySize>> key_for_epoch(std::uint32_t epoch,
+                                                                        std::uint64_t now_ms);
+  std::array<std::uint8_t, kTicketKeySize> derive_epoch_key(std::uint32_t epoch) const;
+
+  SessionTicketConfig config_;
   std::function<Clock::time_point()> now_fn_;
 
-  /// Anti-replay nonce tracking: nonce -> expiry timestamp (ms).
-  mutable std::mutex nonce_mutex_;
-  std::unordered_map<std::uint64_t, std::uint64_t> used_nonces_;
+  /// Master key and cached per-epoch keys (previous, current, next).
+  mutable std::shared_mutex key_mutex_;
+  std::array<std::uint8_t, kTicketKeySize> master_key_{};
+  std::array<EpochKey, 3> epoch_keys_{};
+
+  /// Anti-replay nonce tracking.
+  AntiReplayFilter nonce_filter_;
 };
 
 /// Client-side ticket store for caching session tickets.
@@ -111,6 +111,13 @@ void ReplayWindow::unmark(std::uint64_t sequence) {
   clear_bit(index);
 }
 
+void ReplayWindow::restore(std::uint64_t highest) {
+  highest_ = highest;
+  initialized_ = true;
+  std::fill(bits_.begin(), bits_.end(), ~std::uint64_t(0));
+  mask_tail();
+}
+
 void ReplayWindow::mask_tail() {
   const auto remainder = window_size_ % kBitsPerWord;
   if (remainder == 0) {
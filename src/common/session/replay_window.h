@@ -14,6 +14,11 @@ class ReplayWindow {
   // Issue #78: Unmark sequence to allow retransmission after decryption failure
   void unmark(std::uint64_t sequence);
 
+  // Treat every sequence up to and including highest as already seen. Used
+  // when a session is rebuilt from a hibernated state that kept only the
+  // window's head.
+  void restore(std::uint64_t highest);
+
   // Getter for diagnostic logging (Issue #72)
   [[nodiscard]] std::uint64_t highest() const { return highest_; }
   [[nodiscard]] bool initialized() const { return initialized_; }
@@ -4,18 +4,30 @@
 #include <chrono>
 #include <cmath>
 #include <cstdint>
+#include <limits>
+#include <random>
 
 #include "common/crypto/random.h"
 
 namespace veil::session {
 
+namespace {
+// Draws straight from the CSPRNG. Rotations are rare, so this costs less
+// than keeping a 2.5 KB std::mt19937_64 state in every session.
+struct CryptoRandomEngine {
+  using result_type = std::uint64_t;
+  static constexpr result_type min() { return std::numeric_limits<result_type>::min(); }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+  result_type operator()() const { return crypto::random_uint64(); }
+};
+}  // namespace
+
 SessionRotator::SessionRotator(std::chrono::seconds interval, std::uint64_t max_packets)
     : base_interval_(interval),
       max_packets_(max_packets),
       session_id_(crypto::random_uint64()),
       last_rotation_(std::chrono::steady_clock::now()),
-      current_interval_(),
-      rng_(crypto::random_uint64()) {
+      current_interval_() {
   current_interval_ = compute_jittered_interval();
 }
 
@@ -49,13 +61,14 @@ std::chrono::milliseconds SessionRotator::compute_jittered_interval() {
 
   // Exponential distribution with lambda = 1/jitter_range gives a mean of jitter_range.
   // We use it to bias towards shorter jitter values with occasional longer ones.
+  CryptoRandomEngine rng;
   std::exponential_distribution<double> exp_dist(1.0 / jitter_range);
-  double jitter = exp_dist(rng_);
+  double jitter = exp_dist(rng);
 
   // Clamp jitter to [-jitter_range, 2*jitter_range] relative to base.
   // Use uniform to decide sign (subtract vs add).
   std::uniform_real_distribution<double> sign_dist(0.0, 1.0);
-  const bool subtract = sign_dist(rng_) < 0.33;
+  const bool subtract = sign_dist(rng) < 0.33;
 
   double result_ms;
   if (subtract) {
@@ -2,7 +2,6 @@
 
 #include <chrono>
 #include <cstdint>
-#include <random>
 
 namespace veil::session {
 
@@ -24,7 +23,6 @@ class SessionRotator {
   std::uint64_t session_id_;
   std::chrono::steady_clock::time_point last_rotation_;
   std::chrono::milliseconds current_interval_;
-  std::mt19937_64 rng_;
 };
 
 }  // namespace veil::session
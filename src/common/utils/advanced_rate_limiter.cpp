@@ -41,6 +41,14 @@ bool BurstTokenBucket::try_consume(std::uint64_t tokens) {
   return false;
 }
 
+bool BurstTokenBucket::can_consume(std::uint64_t tokens) {
+  refill();
+  if (is_penalized()) {
+    return false;
+  }
+  return tokens_ >= static_cast<double>(tokens);
+}
+
 bool BurstTokenBucket::is_penalized() const {
   return in_penalty_ && now_fn_() < penalty_end_;
 }
@@ -109,6 +117,10 @@ bool ClientRateLimiter::allow_packet(std::uint64_t size_bytes, TrafficPriority p
   return true;
 }
 
+bool ClientRateLimiter::would_allow(std::uint64_t size_bytes) {
+  return !is_blocked() && bandwidth_bucket_.can_consume(size_bytes) && packet_bucket_.can_consume(1);
+}
+
 bool ClientRateLimiter::record_reconnect() {
   auto now = now_fn_();
   stats_.reconnects++;
@@ -186,6 +198,10 @@ bool AdvancedRateLimiter::allow_packet(const ClientId& client_id, std::uint64_t
   return client.allow_packet(size_bytes, priority);
 }
 
+bool AdvancedRateLimiter::would_allow(const ClientId& client_id, std::uint64_t size_bytes) {
+  return get_or_create_client(client_id).would_allow(size_bytes);
+}
+
 bool AdvancedRateLimiter::record_reconnect(const ClientId& client_id) {
   auto& client = get_or_create_client(client_id);
   return client.record_reconnect();
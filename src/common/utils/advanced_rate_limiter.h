@@ -62,6 +62,10 @@ class BurstTokenBucket {
   // Try to consume tokens. Returns true if allowed.
   bool try_consume(std::uint64_t tokens);
 
+  // Check whether tokens are available without consuming them or starting a
+  // penalty period.
+  bool can_consume(std::uint64_t tokens);
+
   // Check if currently in penalty period.
   bool is_penalized() const;
 
@@ -99,6 +103,11 @@ class ClientRateLimiter {
   // Returns true if allowed, false if should be dropped/delayed.
   bool allow_packet(std::uint64_t size_bytes, TrafficPriority priority = TrafficPriority::kNormal);
 
+  // Check if a packet of given size fits the budgets now, without consuming
+  // them or recording a violation. For schedulers that hold traffic back
+  // rather than drop it; they call allow_packet() once the packet is sent.
+  bool would_allow(std::uint64_t size_bytes);
+
   // Record a reconnection attempt.
   // Returns true if allowed, false if abuse detected.
   bool record_reconnect();
@@ -142,6 +151,9 @@ class AdvancedRateLimiter {
   bool allow_packet(const ClientId& client_id, std::uint64_t size_bytes,
                     TrafficPriority priority = TrafficPriority::kNormal);
 
+  // Shaping check for a client (see ClientRateLimiter::would_allow()).
+  bool would_allow(const ClientId& client_id, std::uint64_t size_bytes);
+
   // Record a reconnection for a client.
   bool record_reconnect(const ClientId& client_id);
 
@@ -0,0 +1,363 @@
+#include "server/allowed_ips.h"
+
+#include <arpa/inet.h>
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+
+namespace veil::server {
+
+namespace {
+
+constexpr std::size_t kIpv4HeaderSize = 20;
+constexpr std::size_t kIpv6HeaderSize = 40;
+
+constexpr std::uint8_t max_length(IpFamily family) { return family == IpFamily::kV4 ? 32 : 128; }
+constexpr std::size_t address_size(IpFamily family) { return family == IpFamily::kV4 ? 4 : 16; }
+
+// Clear the bits after the first `length` bits of an address.
+void clear_host_bits(IpPrefix& prefix) {
+  const auto size = address_size(prefix.family);
+  for (std::size_t i = 0; i < prefix.address.size(); ++i) {
+    const std::size_t first_bit = i * 8;
+    if (i >= size || first_bit >= prefix.length) {
+      prefix.address[i] = 0;
+    } else if (first_bit + 8 > prefix.length) {
+      const auto keep = static_cast<unsigned>(prefix.length - first_bit);
+      prefix.address[i] = static_cast<std::uint8_t>(prefix.address[i] & (0xFFU << (8 - keep)));
+    }
+  }
+}
+
+}  // namespace
+
+std::optional<IpPrefix> IpPrefix::parse(std::string_view text) {
+  const auto slash = text.find('/');
+  const std::string address(text.substr(0, slash));
+
+  IpPrefix prefix;
+  if (inet_pton(AF_INET, address.c_str(), prefix.address.data()) == 1) {
+    prefix.family = IpFamily::kV4;
+  } else if (inet_pton(AF_INET6, address.c_str(), prefix.address.data()) == 1) {
+    prefix.family = IpFamily::kV6;
+  } else {
+    return std::nullopt;
+  }
+
+  prefix.length = max_length(prefix.family);
+  if (slash != std::string_view::npos) {
+    const auto length_text = text.substr(slash + 1);
+    unsigned length = 0;
+    const auto [end, error] = std::from_chars(length_text.data(), length_text.data() + length_text.size(), length);
+    if (error != std::errc{} || end != length_text.data() + length_text.size() || length_text.empty() ||
+        length > max_length(prefix.family)) {
+      return std::nullopt;
+    }
+    prefix.length = static_cast<std::uint8_t>(length);
+  }
+  clear_host_bits(prefix);
+  return prefix;
+}
+
+std::optional<IpPrefix> IpPrefix::host(std::span<const std::uint8_t> address) {
+  IpPrefix prefix;
+  if (address.size() == 4) {
+    prefix.family = IpFamily::kV4;
+  } else if (address.size() == 16) {
+    prefix.family = IpFamily::kV6;
+  } else {
+    return std::nullopt;
+  }
+  std::copy(address.begin(), address.end(), prefix.address.begin());
+  prefix.length = max_length(prefix.family);
+  return prefix;
+}
+
+std::string IpPrefix::to_string() const {
+  char buffer[INET6_ADDRSTRLEN] = {};
+  inet_ntop(family == IpFamily::kV4 ? AF_INET : AF_INET6, address.data(), buffer, sizeof(buffer));
+  return std::string(buffer) + "/" + std::to_string(length);
+}
+
+std::optional<PacketAddresses> packet_addresses(std::span<const std::uint8_t> packet) {
+  if (packet.empty()) {
+    return std::nullopt;
+  }
+  const auto version = packet[0] >> 4;
+  if (version == 4 && packet.size() >= kIpv4HeaderSize) {
+    return PacketAddresses{IpFamily::kV4, packet.subspan(12, 4), packet.subspan(16, 4)};
+  }
+  if (version == 6 && packet.size() >= kIpv6HeaderSize) {
+    return PacketAddresses{IpFamily::kV6, packet.subspan(8, 16), packet.subspan(24, 16)};
+  }
+  return std::nullopt;
+}
+
+// ============================================================================
+// AllowedIps
+// ============================================================================
+
+AllowedIps::Key AllowedIps::to_key(IpFamily family, std::span<const std::uint8_t> address) {
+  Key key;
+  for (std::size_t i = 0; i < address_size(family); ++i) {
+    auto& half = i < 8 ? key.hi : key.lo;
+    half |= static_cast<std::uint64_t>(address[i]) << (56 - 8 * (i % 8));
+  }
+  return key;
+}
+
+bool AllowedIps::matches(const Key& address, const Key& prefix, std::uint8_t length) {
+  // Count the leading bits the two share rather than masking: no branches
+  // on the prefix length.
+  const auto hi = address.hi ^ prefix.hi;
+  const auto common = hi != 0 ? std::countl_zero(hi) : 64 + std::countl_zero(address.lo ^ prefix.lo);
+  return common >= length;
+}
+
+unsigned AllowedIps::bit_at(const Key& key, std::uint8_t index) {
+  return index < 64 ? static_cast<unsigned>((key.hi >> (63 - index)) & 1U)
+                    : static_cast<unsigned>((key.lo >> (127 - index)) & 1U);
+}
+
+std::uint8_t AllowedIps::common_length(const Key& a, const Key& b, std::uint8_t max_length) {
+  const auto hi = a.hi ^ b.hi;
+  const auto common = hi != 0 ? std::countl_zero(hi) : 64 + std::countl_zero(a.lo ^ b.lo);
+  return static_cast<std::uint8_t>(std::min(common, static_cast<int>(max_length)));
+}
+
+std::uint32_t AllowedIps::new_node(const Key& key, std::uint8_t length, std::uint64_t session_id) {
+  Node node;
+  node.key = key;
+  node.length = length;
+  node.session_id = session_id;
+  if (!free_.empty()) {
+    const auto index = free_.back();
+    free_.pop_back();
+    nodes_[index] = node;
+    return index;
+  }
+  nodes_.push_back(node);
+  return static_cast<std::uint32_t>(nodes_.size() - 1);
+}
+
+void AllowedIps::relink(IpFamily family, std::uint32_t from, std::uint32_t to) {
+  const auto parent = nodes_[from].parent;
+  if (to != kNone) {
+    nodes_[to].parent = parent;
+  }
+  if (parent == kNone) {
+    root(family) = to;
+    return;
+  }
+  auto& slots = nodes_[parent].child;
+  slots[slots[0] == from ? 0 : 1] = to;
+}
+
+void AllowedIps::insert(const IpPrefix& prefix, std::uint64_t session_id) {
+  if (session_id == 0) {
+    throw std::invalid_argument("session ID 0 is reserved");
+  }
+  if (prefix.length > max_length(prefix.family)) {
+    throw std::invalid_argument("prefix length exceeds the address size");
+  }
+  IpPrefix normalized = prefix;
+  clear_host_bits(normalized);
+  const auto family = normalized.family;
+  const auto key = to_key(family, normalized.address);
+  const auto length = normalized.length;
+
+  const auto added = [&](std::uint32_t index) {
+    nodes_[index].session_id = session_id;
+    by_session_[session_id].push_back(normalized);
+    ++size_;
+  };
+
+  std::uint32_t current = root(family);
+  if (current == kNone) {
+    root(family) = new_node(key, length, 0);
+    added(root(family));
+    return;
+  }
+  while (true) {
+    const auto node_length = nodes_[current].length;
+    const auto common = common_length(key, nodes_[current].key, std::min(length, node_length));
+    if (common == node_length && common == length) {
+      const auto owner = nodes_[current].session_id;
+      if (owner == session_id) {
+        return;
+      }
+      if (owner != 0) {
+        forget(owner, normalized);
+        --size_;
+      }
+      added(current);
+      return;
+    }
+    if (common == node_length) {
+      // The node's prefix contains the new one: go down, or attach a leaf.
+      const auto bit = bit_at(key, node_length);
+      const auto next = nodes_[current].child[bit];
+      if (next == kNone) {
+        const auto leaf = new_node(key, length, 0);
+        nodes_[leaf].parent = current;
+        nodes_[current].child[bit] = leaf;
+        added(leaf);
+        return;
+      }
+      current = next;
+      continue;
+    }
+    // The new prefix leaves the node's path within its prefix: put a node
+    // above it, either the new prefix itself or a branch where they part.
+    std::uint32_t above = kNone;
+    if (common == length) {
+      above = new_node(key, length, 0);
+      added(above);
+    } else {
+      Key branch_key = key;
+      if (common < 64) {
+        branch_key.hi = common == 0 ? 0 : key.hi & (~std::uint64_t{0} << (64 - common));
+        branch_key.lo = 0;
+      } else {
+        branch_key.lo = common == 64 ? 0 : key.lo & (~std::uint64_t{0} << (128 - common));
+      }
+      above = new_node(branch_key, common, 0);
+      const auto leaf = new_node(key, length, 0);
+      nodes_[leaf].parent = above;
+      nodes_[above].child[bit_at(key, common)] = leaf;
+      added(leaf);
+    }
+    relink(family, current, above);
+    nodes_[above].child[bit_at(nodes_[current].key, common)] = current;
+    nodes_[current].parent = above;
+    return;
+  }
+}
+
+std::uint32_t AllowedIps::find_exact(IpFamily family, const Key& key, std::uint8_t length) const {
+  auto current = family == IpFamily::kV4 ? root_v4_ : root_v6_;
+  while (current != kNone) {
+    const auto& node = nodes_[current];
+    if (node.length > length || !matches(key, node.key, node.length)) {
+      return kNone;
+    }
+    if (node.length == length) {
+      return current;
+    }
+    current = node.child[bit_at(key, node.length)];
+  }
+  return kNone;
+}
+
+void AllowedIps::prune(IpFamily family, std::uint32_t index) {
+  while (index != kNone) {
+    const auto& node = nodes_[index];
+    const bool left = node.child[0] != kNone;
+    const bool right = node.child[1] != kNone;
+    if (node.session_id != 0 || (left && right)) {
+      return;
+    }
+    const auto parent = node.parent;
+    const auto child = left ? node.child[0] : node.child[1];
+    relink(family, index, child);
+    nodes_[index] = Node{};
+    free_.push_back(index);
+    if (child != kNone) {
+      return;  // The parent still has as many children as before.
+    }
+    index = parent;
+  }
+}
+
+bool AllowedIps::remove(const IpPrefix& prefix) {
+  if (prefix.length > max_length(prefix.family)) {
+    return false;
+  }
+  IpPrefix normalized = prefix;
+  clear_host_bits(normalized);
+  const auto index = find_exact(normalized.family, to_key(normalized.family, normalized.address), normalized.length);
+  if (index == kNone || nodes_[index].session_id == 0) {
+    return false;
+  }
+  forget(nodes_[index].session_id, normalized);
+  nodes_[index].session_id = 0;
+  --size_;
+  prune(normalized.family, index);
+  return true;
+}
+
+void AllowedIps::remove_session(std::uint64_t session_id) {
+  auto it = by_session_.find(session_id);
+  if (it == by_session_.end()) {
+    return;
+  }
+  const auto prefixes = std::move(it->second);
+  by_session_.erase(it);
+  for (const auto& prefix : prefixes) {
+    const auto index = find_exact(prefix.family, to_key(prefix.family, prefix.address), prefix.length);
+    if (index != kNone && nodes_[index].session_id == session_id) {
+      nodes_[index].session_id = 0;
+      --size_;
+      prune(prefix.family, index);
+    }
+  }
+}
+
+void AllowedIps::forget(std::uint64_t session_id, const IpPrefix& prefix) {
+  auto it = by_session_.find(session_id);
+  if (it == by_session_.end()) {
+    return;
+  }
+  auto& prefixes = it->second;
+  prefixes.erase(std::remove(prefixes.begin(), prefixes.end(), prefix), prefixes.end());
+  if (prefixes.empty()) {
+    by_session_.erase(it);
+  }
+}
+
+std::optional<std::uint64_t> AllowedIps::lookup(IpFamily family, std::span<const std::uint8_t> address) const {
+  if (address.size() != address_size(family)) {
+    return std::nullopt;
+  }
+  const auto key = to_key(family, address);
+  const auto full_length = max_length(family);
+  std::uint64_t best = 0;
+  auto current = family == IpFamily::kV4 ? root_v4_ : root_v6_;
+  while (current != kNone) {
+    const auto& node = nodes_[current];
+    if (!matches(key, node.key, node.length)) {
+      break;
+    }
+    if (node.session_id != 0) {
+      best = node.session_id;
+    }
+    if (node.length == full_length) {
+      break;
+    }
+    current = node.child[bit_at(key, node.length)];
+  }
+  if (best == 0) {
+    return std::nullopt;
+  }
+  return best;
+}
+
+std::optional<std::uint64_t> AllowedIps::route(std::span<const std::uint8_t> packet) const {
+  const auto addresses = packet_addresses(packet);
+  if (!addresses) {
+    return std::nullopt;
+  }
+  return lookup(addresses->family, addresses->destination);
+}
+
+std::vector<IpPrefix> AllowedIps::prefixes_of(std::uint64_t session_id) const {
+  auto it = by_session_.find(session_id);
+  if (it == by_session_.end()) {
+    return {};
+  }
+  return it->second;
+}
+
+}  // namespace veil::server
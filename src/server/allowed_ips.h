@@ -0,0 +1,130 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace veil::server {
+
+enum class IpFamily : std::uint8_t { kV4, kV6 };
+
+// An IPv4 or IPv6 prefix such as 192.168.10.0/24 or fd00:10::/64. Host bits
+// are always zero.
+struct IpPrefix {
+  IpFamily family{IpFamily::kV4};
+  // Network byte order; IPv4 uses the first 4 bytes.
+  std::array<std::uint8_t, 16> address{};
+  std::uint8_t length{0};
+
+  // Parse "address" (a host route) or "address/length". Host bits are
+  // cleared. Returns nullopt if the text is not a valid prefix.
+  static std::optional<IpPrefix> parse(std::string_view text);
+
+  // Host route (/32 or /128) for a single address of 4 or 16 bytes.
+  static std::optional<IpPrefix> host(std::span<const std::uint8_t> address);
+
+  std::string to_string() const;
+
+  bool operator==(const IpPrefix& other) const = default;
+};
+
+// Source and destination addresses of an IPv4 or IPv6 packet.
+struct PacketAddresses {
+  IpFamily family{IpFamily::kV4};
+  std::span<const std::uint8_t> source;
+  std::span<const std::uint8_t> destination;
+};
+
+// Addresses of an IP packet; nullopt if it is neither IPv4 nor IPv6, or too
+// short for its header.
+std::optional<PacketAddresses> packet_addresses(std::span<const std::uint8_t> packet);
+
+/**
+ * Allowed-IPs routing table: maps IPv4 and IPv6 prefixes to the sessions
+ * behind them (a client's tunnel address, or the LAN of a site-to-site
+ * client). Packets from the TUN device go to the session with the longest
+ * matching prefix for their destination; packets from a session are only
+ * accepted if their source routes back to that session.
+ *
+ * One path-compressed binary trie per family. Each node holds a prefix and
+ * the bit after it selects the child, so a lookup visits at most one node
+ * per prefix bit and usually far fewer. Nodes live in a vector and link by
+ * index; lookups do not allocate.
+ *
+ * Session ID 0 is reserved (no route).
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session table.
+ */
+class AllowedIps {
+ public:
+  // Route a prefix to a session, replacing any previous owner of exactly
+  // that prefix. Throws std::invalid_argument for session ID 0.
+  void insert(const IpPrefix& prefix, std::uint64_t session_id);
+
+  // Remove one prefix. Returns false if it was not in the table.
+  bool remove(const IpPrefix& prefix);
+
+  // Remove every prefix routed to a session.
+  void remove_session(std::uint64_t session_id);
+
+  // Session owning the longest prefix that contains the address (4 bytes for
+  // IPv4, 16 for IPv6); nullopt if none.
+  std::optional<std::uint64_t> lookup(IpFamily family, std::span<const std::uint8_t> address) const;
+
+  // Session for a packet's destination address.
+  std::optional<std::uint64_t> route(std::span<const std::uint8_t> packet) const;
+
+  // Prefixes routed to a session.
+  std::vector<IpPrefix> prefixes_of(std::uint64_t session_id) const;
+
+  // Number of prefixes in the table.
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr std::uint32_t kNone = UINT32_MAX;
+
+  // Addresses as two big-endian 64-bit halves; IPv4 uses the top 32 bits.
+  struct Key {
+    std::uint64_t hi{0};
+    std::uint64_t lo{0};
+  };
+
+  struct Node {
+    Key key;
+    std::uint8_t length{0};
+    std::array<std::uint32_t, 2> child{kNone, kNone};
+    std::uint32_t parent{kNone};
+    std::uint64_t session_id{0};  // 0 for branch nodes without a route.
+  };
+
+  static Key to_key(IpFamily family, std::span<const std::uint8_t> address);
+  static bool matches(const Key& address, const Key& prefix, std::uint8_t length);
+  static unsigned bit_at(const Key& key, std::uint8_t index);
+  static std::uint8_t common_length(const Key& a, const Key& b, std::uint8_t max_length);
+
+  std::uint32_t& root(IpFamily family) { return family == IpFamily::kV4 ? root_v4_ : root_v6_; }
+  std::uint32_t new_node(const Key& key, std::uint8_t length, std::uint64_t session_id);
+  // Point whatever linked to `from` (parent's child slot or the root) at `to`.
+  void relink(IpFamily family, std::uint32_t from, std::uint32_t to);
+  // Drop route-less nodes that no longer separate two subtrees.
+  void prune(IpFamily family, std::uint32_t index);
+  std::uint32_t find_exact(IpFamily family, const Key& key, std::uint8_t length) const;
+  void forget(std::uint64_t session_id, const IpPrefix& prefix);
+
+  std::vector<Node> nodes_;
+  std::vector<std::uint32_t> free_;
+  std::uint32_t root_v4_{kNone};
+  std::uint32_t root_v6_{kNone};
+  std::size_t size_{0};
+  std::unordered_map<std::uint64_t, std::vector<IpPrefix>> by_session_;
+};
+
+}  // namespace veil::server
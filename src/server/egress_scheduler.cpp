@@ -0,0 +1,134 @@
+#include "server/egress_scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace veil::server {
+
+EgressScheduler::EgressScheduler(EgressSchedulerConfig config, std::function<TimePoint()> now_fn)
+    : config_(std::move(config)) {
+  if (config_.quantum == 0) {
+    throw std::invalid_argument("quantum must be positive");
+  }
+  if (config_.client_limits) {
+    rate_limiter_.emplace(*config_.client_limits, std::move(now_fn));
+  }
+}
+
+void EgressScheduler::activate(std::uint64_t session_id) {
+  if (active_ids_.insert(session_id).second) {
+    active_.push_back(Flow{.session_id = session_id,
+                           .deficit = 0,
+                           .mid_turn = false,
+                           .client_id = rate_limiter_ ? std::to_string(session_id) : std::string{}});
+  }
+}
+
+std::int64_t EgressScheduler::quantum_for(utils::TrafficPriority priority) const {
+  const auto quantum = static_cast<std::int64_t>(config_.quantum);
+  switch (priority) {
+    case utils::TrafficPriority::kLow:
+      return std::max<std::int64_t>(quantum / 2, 1);
+    case utils::TrafficPriority::kNormal:
+      return quantum;
+    case utils::TrafficPriority::kHigh:
+      return quantum * 2;
+    case utils::TrafficPriority::kCritical:
+      return quantum * 4;
+  }
+  return quantum;
+}
+
+std::size_t EgressScheduler::service(SessionTable& table, const SendFn& send) {
+  const std::size_t limit =
+      config_.max_bytes_per_service == 0 ? std::numeric_limits<std::size_t>::max() : config_.max_bytes_per_service;
+  std::size_t sent_total = 0;
+  budget_exhausted_ = false;
+
+  // Each pass gives every backlogged session one turn; stop once a whole
+  // pass sends nothing (everyone left is blocked).
+  bool progress = true;
+  while (progress && !active_.empty()) {
+    progress = false;
+    ++stats_.rounds;
+    for (auto turns = active_.size(); turns > 0 && !active_.empty(); --turns) {
+      Flow flow = std::move(active_.front());
+      active_.pop_front();
+
+      auto* session = table.find_by_id(flow.session_id);
+      if (session == nullptr || !session->transport || !session->egress || session->egress->empty()) {
+        active_ids_.erase(flow.session_id);
+        continue;
+      }
+      if (!flow.mid_turn) {
+        flow.deficit += quantum_for(session->priority);
+      }
+      flow.mid_turn = false;
+
+      const auto datagram_size = session->egress->config().max_datagram_size;
+      std::size_t sent = 0;
+      bool blocked = false;
+      while (flow.deficit > 0 && !session->egress->empty()) {
+        if (sent_total >= limit) {
+          break;
+        }
+        if (rate_limiter_ && !rate_limiter_->would_allow(flow.client_id, datagram_size)) {
+          ++stats_.rate_limited;
+          blocked = true;
+          break;
+        }
+        // One datagram at a time, so the deficit and the rate limit are
+        // checked between datagrams.
+        const auto datagrams = session->egress->drain(*session->transport, 1);
+        if (datagrams.empty()) {
+          blocked = true;  // Congestion window or pacing.
+          break;
+        }
+        for (const auto& datagram : datagrams) {
+          send(*session, datagram);
+          if (rate_limiter_) {
+            rate_limiter_->allow_packet(flow.client_id, datagram.size(), session->priority);
+          }
+          flow.deficit -= static_cast<std::int64_t>(datagram.size());
+          sent += datagram.size();
+          ++stats_.datagrams;
+        }
+      }
+      sent_total += sent;
+      stats_.bytes += sent;
+      progress = progress || sent > 0;
+
+      if (session->egress->empty()) {
+        active_ids_.erase(flow.session_id);
+        continue;
+      }
+      if (sent_total >= limit && flow.deficit > 0 && !blocked) {
+        // Out of budget during this turn: resume it first next time.
+        flow.mid_turn = true;
+        active_.push_front(std::move(flow));
+        budget_exhausted_ = true;
+        return sent_total;
+      }
+      if (blocked && flow.deficit > 0) {
+        flow.deficit = 0;  // No credit is banked while a session cannot send.
+      }
+      active_.push_back(std::move(flow));
+      if (sent_total >= limit) {
+        budget_exhausted_ = true;
+        return sent_total;
+      }
+    }
+  }
+  return sent_total;
+}
+
+void EgressScheduler::cleanup(std::chrono::seconds max_idle) {
+  if (rate_limiter_) {
+    rate_limiter_->cleanup_inactive(max_idle);
+  }
+}
+
+}  // namespace veil::server
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "common/utils/advanced_rate_limiter.h"
+#include "server/session_table.h"
+
+namespace veil::server {
+
+// Configuration for the server's egress scheduler.
+struct EgressSchedulerConfig {
+  // Bytes a backlogged TrafficPriority::kNormal session may send per round.
+  // kLow sessions get half as much, kHigh twice and kCritical four times.
+  std::size_t quantum{static_cast<std::size_t>(4) * 1400};
+  // Bytes one service() call may send before returning to the event loop
+  // (0 = no limit). The next call resumes where this one stopped.
+  std::size_t max_bytes_per_service{static_cast<std::size_t>(256) * 1024};
+  // Per-client bandwidth and packet rate limits. Clients over their limit
+  // are skipped (their traffic waits) rather than dropped.
+  std::optional<utils::RateLimiterConfig> client_limits;
+};
+
+// Statistics for egress scheduling.
+struct EgressSchedulerStats {
+  std::uint64_t rounds{0};        // Passes over the backlogged sessions
+  std::uint64_t datagrams{0};     // Datagrams sent
+  std::uint64_t bytes{0};         // Bytes sent
+  std::uint64_t rate_limited{0};  // Turns cut short by a client's rate limit
+};
+
+/**
+ * Deficit round-robin over the per-session egress queues
+ * (ClientSession::egress). Without it, whichever session's packets come off
+ * the TUN device are sealed and sent at once, so one client with a large
+ * download takes the uplink and the encryption CPU from everyone else.
+ *
+ * Sessions with queued packets take turns. Each turn a session earns its
+ * quantum (scaled by ClientSession::priority) and sends datagrams until the
+ * credit is spent, its queue is empty, or its congestion window, pacing or
+ * rate limit stops it. Light sessions therefore wait at most one quantum per
+ * heavy session, and a blocked session does not bank credit for later.
+ *
+ * The caller activate()s a session whenever it queues a packet for it, and
+ * calls service() at the end of a TUN burst, after ACKs (which reopen
+ * congestion windows) and from the maintenance timer.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session table.
+ */
+class EgressScheduler {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+  // Transmit one sealed datagram to the session's client.
+  using SendFn = std::function<void(ClientSession&, const std::vector<std::uint8_t>&)>;
+
+  // Throws std::invalid_argument if quantum is zero.
+  explicit EgressScheduler(EgressSchedulerConfig config = {}, std::function<TimePoint()> now_fn = Clock::now);
+
+  // Note that a session has queued packets. Cheap to call for every packet.
+  void activate(std::uint64_t session_id);
+
+  // Send from backlogged sessions in DRR order. Returns the bytes sent.
+  std::size_t service(SessionTable& table, const SendFn& send);
+
+  // True while some session still has queued packets.
+  bool has_backlog() const { return !active_.empty(); }
+
+  // True if the last service() call stopped at max_bytes_per_service rather
+  // than because every backlogged session was blocked.
+  bool budget_exhausted() const { return budget_exhausted_; }
+
+  // Per-client limit overrides (set_client_config() with the session ID in
+  // decimal) and statistics; nullptr without client_limits.
+  utils::AdvancedRateLimiter* rate_limiter() { return rate_limiter_ ? &*rate_limiter_ : nullptr; }
+
+  // Forget rate limiter state of clients idle for max_idle.
+  void cleanup(std::chrono::seconds max_idle);
+
+  const EgressSchedulerConfig& config() const { return config_; }
+  const EgressSchedulerStats& stats() const { return stats_; }
+
+ private:
+  struct Flow {
+    std::uint64_t session_id{0};
+    std::int64_t deficit{0};
+    // The previous service() call ended during this flow's turn.
+    bool mid_turn{false};
+    std::string client_id;
+  };
+
+  std::int64_t quantum_for(utils::TrafficPriority priority) const;
+
+  EgressSchedulerConfig config_;
+  std::optional<utils::AdvancedRateLimiter> rate_limiter_;
+  std::deque<Flow> active_;
+  std::unordered_set<std::uint64_t> active_ids_;
+  bool budget_exhausted_{false};
+  EgressSchedulerStats stats_;
+};
+
+}  // namespace veil::server
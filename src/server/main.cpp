@@ -1,8 +1,10 @@
 #include <arpa/inet.h>
 
+#include <algorithm>
 #include <array>
 #include <cstdlib>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <chrono>
 #include <iomanip>
@@ -14,11 +16,14 @@
 #include "common/logging/logger.h"
 #include "common/signal/signal_handler.h"
 #include "common/utils/rate_limiter.h"
+#include "server/egress_scheduler.h"
+#include "server/session_deadlines.h"
 #include "server/server_config.h"
 #include "server/session_table.h"
-#include "transport/mux/ack_scheduler.h"
+#include "transport/event_loop/event_loop.h"
 #include "transport/mux/frame.h"
 #include "transport/mux/mux_codec.h"
+#include "transport/session/priority_scheduler.h"
 #include "transport/session/transport_session.h"
 #include "transport/udp_socket/udp_socket.h"
 #include "tun/routing.h"
@@ -156,8 +161,8 @@ void log_ack_send_error([[maybe_unused]] const std::error_code& ec) {
   LOG_DEBUG("Failed to send ACK to client: {}", ec.message());
 }
 
-void log_ack_sent([[maybe_unused]] std::uint64_t ack, [[maybe_unused]] std::uint32_t bitmap) {
-  LOG_DEBUG("Sent ACK to client: ack={}, bitmap={:#010x}", ack, bitmap);
+void log_ack_sent([[maybe_unused]] std::size_t size) {
+  LOG_DEBUG("Sent ACK to client: {} bytes", size);
 }
 
 void log_new_client(const std::string& host, std::uint16_t port, std::uint64_t session_id) {
@@ -207,17 +212,185 @@ void log_packet_received([[maybe_unused]] std::size_t size,
   g_stats.total_bytes_received += size;
 }
 
+void log_resumed_client(const std::string& host, std::uint16_t port, std::uint64_t session_id) {
+  LOG_INFO("Client resumed with 0-RTT from {}:{}, session {}", host, port, session_id);
+}
+
+void log_zero_rtt_rejected([[maybe_unused]] const std::string& host,
+                           [[maybe_unused]] std::uint16_t port) {
+  LOG_DEBUG("Rejected 0-RTT resumption from {}:{}, client will fall back to full handshake",
+            host, port);
+}
+
+// Issue #86: Issue a session ticket for a newly established session so the
+// client can resume with 0-RTT after a reconnect. Sent as an encrypted control
+// frame right after the handshake response; losing it only costs the client
+// one full handshake on its next reconnect.
+void send_session_ticket(handshake::SessionTicketManager& ticket_manager,
+                         transport::TransportSession& transport,
+                         const crypto::SessionKeys& server_keys, transport::UdpSocket& udp_socket,
+                         const transport::UdpEndpoint& remote) {
+  const auto ticket = ticket_manager.issue_ticket(server_keys);
+  auto frame = mux::make_control_frame(static_cast<std::uint8_t>(mux::ControlType::kSessionTicket),
+                                       handshake::encode_ticket_message(ticket));
+  const auto packet = transport.encrypt_frame(frame);
+  std::error_code ec;
+  if (!udp_socket.send(packet, remote, ec)) {
+    LOG_WARN("Failed to send session ticket to {}:{}: {}", remote.host, remote.port, ec.message());
+  }
+}
+
+// Connection migration: an authenticated packet from a new address moves the
+// session there, so NAT rebinding costs no handshake. Only the packet with the
+// highest sequence so far may do this; a replayed or reordered packet sent from
+// elsewhere cannot redirect the session. The handler enforces the per-session
+// migration limit and cooldown.
+void migrate_if_rebound(server::SessionTable& session_table,
+                        tunnel::SessionMigrationHandler& migration_handler,
+                        const server::ClientSession& session, const transport::UdpEndpoint& remote) {
+  if (session.endpoint.host == remote.host && session.endpoint.port == remote.port) {
+    return;
+  }
+  if (!migration_handler.config().enabled || !session.transport->last_packet_advanced()) {
+    return;
+  }
+  if (!migration_handler.can_migrate(session.session_id)) {
+    LOG_DEBUG("Session {} migration to {}:{} refused (limit or cooldown)", session.session_id,
+              remote.host, remote.port);
+    return;
+  }
+  const std::string old_endpoint = session.endpoint.host + ":" + std::to_string(session.endpoint.port);
+  if (session_table.update_endpoint(session.session_id, remote)) {
+    migration_handler.record_migration(session.session_id, old_endpoint,
+                                       remote.host + ":" + std::to_string(remote.port));
+  }
+}
+
+// Apply the configured coalescing, and egress queueing with traffic shaping,
+// to a new session; the datagram budget is the transport MTU.
+void configure_coalescer(server::SessionTable& session_table, std::uint64_t session_id,
+                         const tunnel::TunnelConfig& tunnel_config, bool traffic_shaping) {
+  auto* session = session_table.find_by_id(session_id);
+  if (session == nullptr) {
+    return;
+  }
+  auto coalescing = tunnel_config.coalescing;
+  coalescing.max_datagram_size = tunnel_config.transport.mtu;
+  session->coalescer = transport::PacketCoalescer(coalescing);
+  if (!traffic_shaping) {
+    return;
+  }
+  auto scheduling = tunnel_config.priority_scheduler;
+  scheduling.max_datagram_size = tunnel_config.transport.mtu;
+  session->egress.emplace(scheduling);
+}
+
+// Send one sealed datagram to a client.
+void send_to_client(server::ClientSession& session, transport::UdpSocket& udp_socket,
+                    const std::vector<std::uint8_t>& pkt) {
+  std::error_code ec;
+  if (!udp_socket.send(pkt, session.endpoint, ec)) {
+    LOG_ERROR("Failed to send to client: {}", ec.message());
+    return;
+  }
+  session.packets_sent++;
+  session.bytes_sent += pkt.size();
+  g_stats.total_packets_sent++;
+  g_stats.total_bytes_sent += pkt.size();
+}
+
+// Send a session's queued TUN packets; a pending ACK rides in front of them.
+void flush_coalesced(server::ClientSession& session, transport::UdpSocket& udp_socket) {
+  for (const auto& pkt : session.coalescer.flush(*session.transport)) {
+    send_to_client(session, udp_socket, pkt);
+  }
+}
+
+// Send a standalone ACK if the session has one due (see
+// TransportSession::take_ack_packet()).
+void send_pending_ack(server::ClientSession& session, transport::UdpSocket& udp_socket, bool end_of_burst) {
+  auto ack_packet = session.transport->take_ack_packet(end_of_burst);
+  if (!ack_packet) {
+    return;
+  }
+  std::error_code ec;
+  if (!udp_socket.send(*ack_packet, session.endpoint, ec)) {
+    log_ack_send_error(ec);
+  } else {
+    log_ack_sent(ack_packet->size());
+  }
+}
+
+// Earliest moment a session needs the maintenance timer: its transport's
+// retransmit, delayed-ACK or FEC deadline, a coalescing flush, the pacing
+// delay of queued egress, the moment it may hibernate, or its idle timeout.
+std::chrono::steady_clock::time_point next_session_deadline(const server::ClientSession& session,
+                                                            std::chrono::seconds session_timeout,
+                                                            std::chrono::seconds hibernate_after) {
+  const auto now = std::chrono::steady_clock::now();
+  auto deadline = session.last_activity + session_timeout;
+  if (!session.transport) {
+    return deadline;
+  }
+  if (hibernate_after.count() > 0 && session.last_activity + hibernate_after > now) {
+    // Once past, the session hibernates after the maintenance pass that
+    // leaves it with nothing pending.
+    deadline = std::min(deadline, session.last_activity + hibernate_after);
+  }
+  if (auto timer_due = session.transport->next_timer_deadline()) {
+    deadline = std::min(deadline, *timer_due);
+  }
+  if (auto flush_due = session.coalescer.time_until_flush()) {
+    deadline = std::min(deadline, now + *flush_due);
+  }
+  if (session.egress && !session.egress->empty()) {
+    // Queued behind the congestion window: ACKs reopen it, pacing needs a timer.
+    const auto pacing = session.transport->time_until_next_send();
+    deadline = std::min(deadline, now + (pacing ? std::chrono::steady_clock::duration(*pacing)
+                                                : std::chrono::milliseconds(10)));
+  }
+  return deadline;
+}
+
+// How long the maintenance timer may sleep: until the earliest session
+// deadline, and 100ms at most so shutdown requests are noticed. An egress
+// scheduler that ran out of budget continues on the next loop iteration.
+std::chrono::milliseconds next_maintenance_delay(server::SessionDeadlines& session_deadlines,
+                                                 const server::EgressScheduler& egress_scheduler) {
+  auto delay = std::chrono::milliseconds(100);
+  if (egress_scheduler.has_backlog() && egress_scheduler.budget_exhausted()) {
+    return std::chrono::milliseconds(0);
+  }
+  if (auto next = session_deadlines.next_deadline()) {
+    const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(*next - std::chrono::steady_clock::now());
+    delay = std::min(delay, std::max(remaining, std::chrono::milliseconds(0)));
+  }
+  return delay;
+}
+
 void print_configuration(const server::ServerConfig& config) {
   cli::print_section("Server Configuration");
   cli::print_row("Listen Address", config.listen_address + ":" + std::to_string(config.listen_port));
   cli::print_row("Max Clients", std::to_string(config.max_clients));
   cli::print_row("Session Timeout", std::to_string(config.session_timeout.count()) + "s");
+  cli::print_row("Hibernate After",
+                 config.hibernate_after.count() > 0 ? std::to_string(config.hibernate_after.count()) + "s" : "Off");
+  if (!config.client_routes.empty()) {
+    cli::print_row("Client Routes", std::to_string(config.client_routes.size()) + " client(s)");
+  }
   cli::print_row("TUN Device", config.tunnel.tun.device_name);
   cli::print_row("TUN IP", config.tunnel.tun.ip_address);
   cli::print_row("IP Pool", config.ip_pool_start + " - " + config.ip_pool_end);
   cli::print_row("NAT Enabled", config.nat.enable_forwarding ? "Yes" : "No");
+  cli::print_row("0-RTT Resumption", config.tunnel.enable_zero_rtt ? "Yes" : "No");
+  cli::print_row("Connection Migration", config.migration.enabled ? "Yes" : "No");
+  cli::print_row("Traffic Shaping", config.traffic_shaping ? "Yes" : "No");
+  cli::print_row("I/O Backend", std::string(transport::event_loop_backend_name(config.tunnel.event_loop.backend)));
   if (config.nat.enable_forwarding) {
     cli::print_row("External Interface", config.nat.external_interface);
+    cli::print_row("NAT Backend", config.nat.backend == tun::NatBackend::kNftables   ? "nftables"
+                                  : config.nat.backend == tun::NatBackend::kIptables ? "iptables"
+                                                                                     : "auto");
   }
   cli::print_row("Verbose", config.verbose ? "Yes" : "No");
   cli::print_row("Daemon Mode", config.daemon_mode ? "Yes" : "No");
@@ -265,6 +438,7 @@ int main(int argc, char* argv[]) {
     std::cerr << "  --tun-ip <ip>            TUN device IP (default: 10.8.0.1)" << '\n';
     std::cerr << "  --nat                    Enable NAT forwarding" << '\n';
     std::cerr << "  --nat-interface <iface>  External NAT interface" << '\n';
+    std::cerr << "  --io-backend <name>      epoll, io_uring or auto (default: epoll)" << '\n';
     std::cerr << '\n';
     return EXIT_FAILURE;
   }
@@ -405,11 +579,56 @@ int main(int argc, char* argv[]) {
   // Create session table
   server::SessionTable session_table(config.max_clients, config.session_timeout,
                                       config.ip_pool_start, config.ip_pool_end);
+  session_table.set_hibernate_after(config.hibernate_after);
+  session_table.set_client_routes(config.client_routes);
+  tunnel::SessionMigrationHandler migration_handler(config.migration);
+
+  // Traffic shaping: TUN traffic is queued per client and sent by the egress
+  // scheduler, so no client can take the uplink from the others.
+  transport::TrafficClassifier traffic_classifier(config.tunnel.traffic_classifier);
+  server::EgressScheduler egress_scheduler(config.egress);
+
+  // Each session's next deadline (retransmit, delayed ACK, flush, pacing,
+  // idle timeout). Sessions whose deadlines may have moved are collected in
+  // touched and rescheduled once per loop iteration, so idle sessions cost
+  // nothing until their idle deadline.
+  server::SessionDeadlines session_deadlines;
+  std::vector<std::uint64_t> touched;
+  const auto touch = [&touched](std::uint64_t session_id) {
+    if (touched.empty() || touched.back() != session_id) {
+      touched.push_back(session_id);
+    }
+  };
+
+  const server::EgressScheduler::SendFn egress_send = [&udp_socket, &touch](server::ClientSession& session,
+                                                                            const std::vector<std::uint8_t>& pkt) {
+    send_to_client(session, udp_socket, pkt);
+    touch(session.session_id);
+  };
 
   // Create handshake responder
   utils::TokenBucket rate_limiter(100.0, std::chrono::milliseconds(10));  // 100 tokens, 10ms refill
   handshake::HandshakeResponder responder(psk, config.tunnel.handshake_skew_tolerance, rate_limiter);
 
+  // Issue #86: Session tickets and 0-RTT resumption
+  std::shared_ptr<handshake::SessionTicketManager> ticket_manager;
+  std::unique_ptr<handshake::ZeroRttResponder> zero_rtt_responder;
+  if (config.tunnel.enable_zero_rtt) {
+    ticket_manager = std::make_shared<handshake::SessionTicketManager>();
+    if (!config.ticket_key_file.empty()) {
+      if (!ticket_manager->load_key_file(config.ticket_key_file, ec)) {
+        std::string error_msg = format_key_error("Session ticket key", config.ticket_key_file, ec);
+        cli::print_error(error_msg);
+        LOG_ERROR("{}", error_msg);
+        return EXIT_FAILURE;
+      }
+      cli::print_success("Session ticket key loaded");
+    }
+    zero_rtt_responder = std::make_unique<handshake::ZeroRttResponder>(
+        psk, ticket_manager, config.tunnel.handshake_skew_tolerance,
+        utils::TokenBucket(100.0, std::chrono::milliseconds(10)));
+  }
+
   // Setup signal handlers
   auto& sig_handler = signal::SignalHandler::instance();
   sig_handler.setup_defaults();
@@ -448,211 +667,306 @@ int main(int argc, char* argv[]) {
 
   LOG_INFO("Server running, accepting connections...");
 
-  // Main server loop
+  // Main server loop. One wait (epoll or io_uring) covers the UDP socket, the
+  // TUN device and the maintenance timer, so the server sleeps until there is
+  // work and picks up a packet as soon as it arrives.
+  transport::EventLoop event_loop(config.tunnel.event_loop);
+  if (event_loop.backend() == transport::EventLoopBackend::kIoUring) {
+    // Batch TUN writes into the ring along with the UDP sends.
+    tun_device.set_write_hook(
+        [&](std::span<const std::uint8_t> frame) { return event_loop.write_fd(tun_device.fd(), frame); });
+  }
+  LOG_INFO("Using {} I/O backend", transport::event_loop_backend_name(event_loop.backend()));
   std::array<std::uint8_t, kMaxPacketSize> buffer{};
 
-  while (running.load() && !sig_handler.should_terminate()) {
-    // Poll UDP socket
-    udp_socket.poll(
-        [&](const transport::UdpPacket& pkt) {
-          // Early rejection of obviously malformed packets (DoS prevention).
-          // This filters out undersized packets before any crypto processing.
-          if (pkt.data.size() < kMinPacketSize || pkt.data.size() > kMaxPacketSize) {
-            LOG_DEBUG("Dropping packet with invalid size {} from {}:{}",
-                      pkt.data.size(), pkt.remote.host, pkt.remote.port);
-            return;
-          }
+  // The maintenance timer is armed for the earliest session deadline and
+  // moved forward when a touched session gets an earlier one.
+  std::function<void(utils::TimerId)> maintenance;
+  utils::TimerId maintenance_timer = utils::kInvalidTimerId;
+  auto maintenance_at = std::chrono::steady_clock::time_point::max();
+  const auto arm_maintenance = [&]() {
+    const auto delay = next_maintenance_delay(session_deadlines, egress_scheduler);
+    const auto at = std::chrono::steady_clock::now() + delay;
+    if (maintenance_timer != utils::kInvalidTimerId) {
+      if (at >= maintenance_at) {
+        return;
+      }
+      event_loop.cancel_timer(maintenance_timer);
+    }
+    maintenance_at = at;
+    maintenance_timer = event_loop.schedule_timer(delay, maintenance);
+  };
+  const auto reschedule_touched = [&]() {
+    std::sort(touched.begin(), touched.end());
+    touched.erase(std::unique(touched.begin(), touched.end()), touched.end());
+    for (const auto session_id : touched) {
+      auto* session = session_table.find_by_id(session_id);
+      if (session == nullptr) {
+        if (auto expiry = session_table.hibernated_expiry(session_id)) {
+          session_deadlines.schedule(session_id, *expiry);
+        } else {
+          session_deadlines.cancel(session_id);
+        }
+        continue;
+      }
+      session_deadlines.schedule(session_id,
+                                 next_session_deadline(*session, config.session_timeout, config.hibernate_after));
+    }
+    touched.clear();
+  };
+
+  // Receive from clients. Sessions that received data are remembered so that
+  // ACKs no outgoing packet carried are sent once per receive burst.
+  std::vector<std::uint64_t> ack_pending;
+  const bool udp_registered = event_loop.add_socket(
+      &udp_socket, 0, {},
+      [&](transport::SessionId, std::span<const std::uint8_t> data,
+          const transport::UdpEndpoint& remote) {
+        // Early rejection of obviously malformed packets (DoS prevention).
+        // This filters out undersized packets before any crypto processing.
+        if (data.size() < kMinPacketSize || data.size() > kMaxPacketSize) {
+          LOG_DEBUG("Dropping packet with invalid size {} from {}:{}",
+                    data.size(), remote.host, remote.port);
+          return;
+        }
 
-          log_packet_received(pkt.data.size(), pkt.remote.host, pkt.remote.port);
+        log_packet_received(data.size(), remote.host, remote.port);
+
+        // Check if this is from an existing session. Sessions are keyed by the
+        // connection ID in the packet, not by the sender's address, so a client
+        // whose address changed is still recognized.
+        const auto connection_id = transport::TransportSession::peek_connection_id(data);
+        auto* session = connection_id ? session_table.find_by_connection_id(*connection_id) : nullptr;
+        bool resumed = false;
+        if (session == nullptr && connection_id) {
+          // A hibernated session comes back without a handshake, but only
+          // for a packet that authenticates against its keys.
+          session = session_table.resume_by_packet(data, config.tunnel.transport);
+          if (session != nullptr) {
+            configure_coalescer(session_table, session->session_id, config.tunnel, config.traffic_shaping);
+            resumed = true;
+          }
+        }
 
-          // Check if this is from an existing session
-          auto* session = session_table.find_by_endpoint(pkt.remote);
+        if (session != nullptr) {
+          // Process data from existing session
+          session->packets_received++;
+          session->bytes_received += data.size();
+
+          if (session->transport) {
+            // Use WARN level temporarily for Issue #72 debugging
+            log_processing_packet(session->session_id, remote.host,
+                                  remote.port, data.size());
+            auto frames = session->transport->decrypt_packet(data);
+            if (frames) {
+              // Only authentic packets keep a session alive.
+              session_table.update_activity(session->session_id);
+              touch(session->session_id);
+              migrate_if_rebound(session_table, migration_handler, *session, remote);
+
+              // Use helper functions for Issue #72 debugging (avoid bugprone-lambda-function-name)
+              log_decrypted_frames(frames->size(), session->session_id);
+              for (const auto& frame : *frames) {
+                log_frame_info(static_cast<int>(frame.kind),
+                               frame.kind == mux::FrameKind::kData);
+                if (frame.kind == mux::FrameKind::kData) {
+                  // Only packets whose source routes back to this client reach
+                  // the TUN device; a client sending from its own configured
+                  // tunnel IP takes it over if it is free (Issue #74).
+                  if (!session_table.accept_source(session->session_id, frame.data.payload)) {
+                    LOG_DEBUG("Dropping packet with unroutable source address from session {}",
+                              session->session_id);
+                    continue;
+                  }
 
-          if (session != nullptr) {
-            // Process data from existing session
-            session_table.update_activity(session->session_id);
-            session->packets_received++;
-            session->bytes_received += pkt.data.size();
-
-            if (session->transport) {
-              // Use WARN level temporarily for Issue #72 debugging
-              log_processing_packet(session->session_id, pkt.remote.host,
-                                    pkt.remote.port, pkt.data.size());
-              auto frames = session->transport->decrypt_packet(pkt.data);
-              if (frames) {
-                // Use helper functions for Issue #72 debugging (avoid bugprone-lambda-function-name)
-                log_decrypted_frames(frames->size(), session->session_id);
-                for (const auto& frame : *frames) {
-                  log_frame_info(static_cast<int>(frame.kind),
-                                 frame.kind == mux::FrameKind::kData);
-                  if (frame.kind == mux::FrameKind::kData) {
-                    // Issue #74 fix: Extract source IP from the IP packet header and update
-                    // session's tunnel_ip. This is necessary because the client may use its
-                    // own configured tunnel IP (e.g., 10.8.0.2) instead of the server-assigned
-                    // IP (e.g., 10.8.0.254). Without this fix, return packets from the internet
-                    // cannot be routed back to the correct client because the destination IP
-                    // in return packets matches the client's source IP, not the server-assigned IP.
-                    const auto& payload = frame.data.payload;
-                    // Check for valid IPv4 packet: minimum 20 bytes header AND IPv4 version (first nibble == 4)
-                    if (payload.size() >= 20 && ((payload[0] >> 4) == 4)) {
-                      // Extract source IP from IPv4 header (bytes 12-15)
-                      std::uint32_t src_ip = (static_cast<std::uint32_t>(payload[12]) << 24) |
-                                             (static_cast<std::uint32_t>(payload[13]) << 16) |
-                                             (static_cast<std::uint32_t>(payload[14]) << 8) |
-                                             static_cast<std::uint32_t>(payload[15]);
-                      // Only update if source IP is non-zero (valid)
-                      if (src_ip != 0) {
-                        struct in_addr src_addr {};
-                        src_addr.s_addr = htonl(src_ip);
-                        char src_ip_str[INET_ADDRSTRLEN];
-                        inet_ntop(AF_INET, &src_addr, src_ip_str, sizeof(src_ip_str));
-
-                        // Update session's tunnel IP if it differs from the packet's source IP
-                        // This ensures return packets can be routed back to this client
-                        session_table.update_tunnel_ip(session->session_id, src_ip_str);
-                      }
-                    }
-
-                    // Write to TUN device
-                    log_tun_write_attempt(frame.data.payload.size(), session->session_id);
-                    if (!tun_device.write(frame.data.payload, ec)) {
-                      log_tun_write_error(ec);
-                    } else {
-                      log_tun_write_success(frame.data.payload.size());
-                    }
-
-                    // Issue #95: ACK coalescing - use AckScheduler to batch ACKs
-                    // Instead of sending ACK immediately on every data packet, the scheduler
-                    // delays ACKs (up to 20ms) or batches them (every 2 packets), reducing overhead.
-                    bool should_send_ack = session->ack_scheduler.on_packet_received(
-                        frame.data.stream_id, frame.data.sequence, frame.data.fin);
-
-                    if (should_send_ack) {
-                      // Scheduler determined immediate ACK is needed (e.g., out-of-order or every N packets)
-                      auto ack_frame_opt = session->ack_scheduler.get_pending_ack(frame.data.stream_id);
-                      if (ack_frame_opt) {
-                        // IMPORTANT: Use encrypt_frame() instead of encrypt_data() to preserve the ACK frame kind.
-                        // encrypt_data() wraps data in a DATA frame, which would cause the receiver to
-                        // incorrectly interpret the ACK as data and try to write it to TUN.
-                        auto ack_mux_frame = mux::make_ack_frame(
-                            ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-                        auto ack_packet = session->transport->encrypt_frame(ack_mux_frame);
-                        if (!udp_socket.send(ack_packet, pkt.remote, ec)) {
-                          log_ack_send_error(ec);
-                        } else {
-                          log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-                        }
-                        session->ack_scheduler.ack_sent(frame.data.stream_id);
-                      }
-                    }
-                  } else if (frame.kind == mux::FrameKind::kAck) {
-                    log_ack_processing();
-                    session->transport->process_ack(frame.ack);
+                  // Write to TUN device
+                  log_tun_write_attempt(frame.data.payload.size(), session->session_id);
+                  if (!tun_device.write(frame.data.payload, ec)) {
+                    log_tun_write_error(ec);
+                  } else {
+                    log_tun_write_success(frame.data.payload.size());
                   }
+                } else if (frame.kind == mux::FrameKind::kAck) {
+                  log_ack_processing();
+                  session->transport->process_ack(frame.ack);
                 }
-              } else {
-                // Log decryption failure for diagnostics
-                log_decryption_failure(session->session_id, pkt.remote.host,
-                                       pkt.remote.port, pkt.data.size());
+              }
+
+              // Issue #95: ACK coalescing. Received data is acknowledged by the
+              // next packet to this client, or once per receive burst; only a
+              // long burst forces an ACK here.
+              send_pending_ack(*session, udp_socket, false);
+              if (session->transport->time_until_ack() &&
+                  (ack_pending.empty() || ack_pending.back() != session->session_id)) {
+                ack_pending.push_back(session->session_id);
+              }
+            } else {
+              // Log decryption failure for diagnostics
+              log_decryption_failure(session->session_id, remote.host,
+                                     remote.port, data.size());
+              if (resumed) {
+                session_table.hibernate(session->session_id);
+                touch(session->session_id);
+              }
+            }
+          }
+        } else {
+          // Log when packet doesn't match any existing session
+          LOG_DEBUG("No session found for endpoint {}:{}, treating as potential handshake",
+                    remote.host, remote.port);
+          // New connection - handle handshake
+          auto hs_result = responder.handle_init(data);
+          if (hs_result) {
+            if (!udp_socket.send(hs_result->response, remote, ec)) {
+              log_handshake_send_error(ec);
+            } else {
+              // Create transport session
+              auto transport = std::make_unique<transport::TransportSession>(
+                  hs_result->session, config.tunnel.transport);
+              if (ticket_manager) {
+                send_session_ticket(*ticket_manager, *transport, hs_result->session.keys,
+                                    udp_socket, remote);
+              }
+
+              // Create client session
+              auto session_id = session_table.create_session(remote, std::move(transport));
+              if (session_id) {
+                configure_coalescer(session_table, *session_id, config.tunnel, config.traffic_shaping);
+                touch(*session_id);
+                log_new_client(remote.host, remote.port, *session_id);
               }
             }
-          } else {
-            // Log when packet doesn't match any existing session
-            LOG_DEBUG("No session found for endpoint {}:{}, treating as potential handshake",
-                      pkt.remote.host, pkt.remote.port);
-            // New connection - handle handshake
-            auto hs_result = responder.handle_init(pkt.data);
-            if (hs_result) {
-              if (!udp_socket.send(hs_result->response, pkt.remote, ec)) {
+          } else if (zero_rtt_responder) {
+            // Issue #86: Not a full INIT - try 0-RTT resumption with a session ticket.
+            // Packets following the INIT (early data) decrypt once the session exists.
+            auto zero_rtt_result = zero_rtt_responder->handle_zero_rtt_init(data);
+            if (zero_rtt_result) {
+              if (!udp_socket.send(zero_rtt_result->response, remote, ec)) {
                 log_handshake_send_error(ec);
+              } else if (!zero_rtt_result->accepted) {
+                log_zero_rtt_rejected(remote.host, remote.port);
               } else {
-                // Create transport session
                 auto transport = std::make_unique<transport::TransportSession>(
-                    hs_result->session, config.tunnel.transport);
+                    zero_rtt_result->session, config.tunnel.transport);
+                send_session_ticket(*ticket_manager, *transport, zero_rtt_result->session.keys,
+                                    udp_socket, remote);
 
-                // Create client session
-                auto session_id = session_table.create_session(pkt.remote, std::move(transport));
+                auto session_id = session_table.create_session(remote, std::move(transport));
                 if (session_id) {
-                  log_new_client(pkt.remote.host, pkt.remote.port, *session_id);
+                  configure_coalescer(session_table, *session_id, config.tunnel, config.traffic_shaping);
+                  touch(*session_id);
+                  log_new_client(remote.host, remote.port, *session_id);
+                  log_resumed_client(remote.host, remote.port, *session_id);
                 }
               }
             }
           }
-        },
-        10, ec);
-
-    // Read from TUN and route to appropriate client
-    auto tun_read = tun_device.read_into(buffer, ec);
-    if (tun_read > 0) {
-      // Parse IP header to find destination
-      if (tun_read >= 20) {
-        // Check if this is an IPv4 packet (version nibble == 4)
-        std::uint8_t version = (buffer[0] >> 4);
-        if (version != 4) {
-          LOG_DEBUG("TUN read: {} bytes, non-IPv4 packet (version={}), skipping", tun_read, version);
+        }
+      });
+
+  // Read from TUN and route to appropriate client. The descriptor is
+  // non-blocking; read everything queued so one wakeup handles a burst.
+  // Packets are queued per client and sealed into shared datagrams when the
+  // burst ends (or a client's queue fills a datagram).
+  std::vector<std::uint64_t> coalesce_pending;
+  const bool tun_registered = event_loop.add_fd(tun_device.fd(), [&]() {
+    while (true) {
+      auto tun_read = tun_device.read_into(buffer, ec);
+      if (tun_read <= 0) {
+        break;
+      }
+      // Route by destination address (IPv4 or IPv6): the client holding it
+      // as its tunnel IP, or the one with the longest client route for it.
+      const std::span<const std::uint8_t> packet(buffer.data(), static_cast<std::size_t>(tun_read));
+      // Traffic for a hibernated client wakes it.
+      auto* session = session_table.find_by_route(packet);
+      if (session == nullptr) {
+        session = session_table.resume_by_route(packet, config.tunnel.transport);
+        if (session != nullptr) {
+          configure_coalescer(session_table, session->session_id, config.tunnel, config.traffic_shaping);
+        }
+      }
+      if (session == nullptr || !session->transport) {
+        // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
+        LOG_DEBUG("TUN read: {} bytes, no session for destination, packet dropped", tun_read);
+        continue;
+      }
+      LOG_DEBUG("Routing {} bytes to session {} ({}:{})",
+                tun_read, session->session_id, session->endpoint.host, session->endpoint.port);
+      touch(session->session_id);
+      if (session->egress) {
+        if (session->egress->enqueue(packet, traffic_classifier.classify(packet))) {
+          egress_scheduler.activate(session->session_id);
         } else {
-          // Extract source IP from IPv4 header (bytes 12-15)
-          std::uint32_t src_ip = (static_cast<std::uint32_t>(buffer[12]) << 24) |
-                                 (static_cast<std::uint32_t>(buffer[13]) << 16) |
-                                 (static_cast<std::uint32_t>(buffer[14]) << 8) |
-                                 static_cast<std::uint32_t>(buffer[15]);
-          // Extract destination IP from IPv4 header (bytes 16-19)
-          std::uint32_t dst_ip = (static_cast<std::uint32_t>(buffer[16]) << 24) |
-                                 (static_cast<std::uint32_t>(buffer[17]) << 16) |
-                                 (static_cast<std::uint32_t>(buffer[18]) << 8) |
-                                 static_cast<std::uint32_t>(buffer[19]);
-
-          // Convert to string
-          char src_ip_str[INET_ADDRSTRLEN];
-          char dst_ip_str[INET_ADDRSTRLEN];
-          struct in_addr src_addr {};
-          struct in_addr dst_addr {};
-          src_addr.s_addr = htonl(src_ip);
-          dst_addr.s_addr = htonl(dst_ip);
-          inet_ntop(AF_INET, &src_addr, src_ip_str, sizeof(src_ip_str));
-          inet_ntop(AF_INET, &dst_addr, dst_ip_str, sizeof(dst_ip_str));
-
-          // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-          LOG_DEBUG("TUN read: {} bytes, {} -> {}", tun_read, src_ip_str, dst_ip_str);
-
-          // Find session by tunnel IP
-          auto* session = session_table.find_by_tunnel_ip(dst_ip_str);
-          if (session != nullptr && session->transport) {
-            LOG_DEBUG("Routing {} bytes to session {} ({}:{})",
-                      tun_read, session->session_id, session->endpoint.host, session->endpoint.port);
-            // Encrypt and send
-            auto packets = session->transport->encrypt_data(
-                std::span<const std::uint8_t>(buffer.data(), static_cast<std::size_t>(tun_read)));
-            for (const auto& pkt : packets) {
-              if (!udp_socket.send(pkt, session->endpoint, ec)) {
-                LOG_ERROR("Failed to send to client: {}", ec.message());
-              } else {
-                session->packets_sent++;
-                session->bytes_sent += pkt.size();
-                g_stats.total_packets_sent++;
-                g_stats.total_bytes_sent += pkt.size();
-              }
-            }
-          } else {
-            LOG_DEBUG("No session found for tunnel IP {}, packet dropped", dst_ip_str);
-          }
+          LOG_DEBUG("Egress queue of session {} full, packet dropped", session->session_id);
         }
+        continue;
+      }
+      if (session->coalescer.empty()) {
+        coalesce_pending.push_back(session->session_id);
+      }
+      if (session->coalescer.add(packet)) {
+        flush_coalesced(*session, udp_socket);
       }
     }
+    // End of the burst: send what is due; the rest waits for maintenance.
+    if (egress_scheduler.has_backlog()) {
+      egress_scheduler.service(session_table, egress_send);
+    }
+    for (const auto session_id : coalesce_pending) {
+      auto* session = session_table.find_by_id(session_id);
+      if (session == nullptr || !session->transport) {
+        continue;
+      }
+      auto wait = session->coalescer.time_until_flush();
+      if (wait && wait->count() == 0) {
+        flush_coalesced(*session, udp_socket);
+      }
+    }
+    coalesce_pending.clear();
+  });
+
+  event_loop.set_iteration_handler([&]() {
+    // ACKs received this iteration may have reopened congestion windows, and
+    // the data sent now carries this iteration's pending ACKs.
+    if (egress_scheduler.has_backlog()) {
+      egress_scheduler.service(session_table, egress_send);
+    }
+    for (const auto session_id : ack_pending) {
+      auto* session = session_table.find_by_id(session_id);
+      if (session != nullptr && session->transport) {
+        send_pending_ack(*session, udp_socket, true);
+      }
+    }
+    ack_pending.clear();
+    reschedule_touched();
+    arm_maintenance();
+  });
 
-    // Periodic session cleanup
+  if (!udp_registered || !tun_registered) {
+    cli::print_error("Failed to set up event loop");
+    LOG_ERROR("Failed to register UDP socket or TUN device with the event loop");
+    return EXIT_FAILURE;
+  }
+
+  // Periodic maintenance: cleanup, stats, and the sessions with a deadline
+  // due (idle timeout, coalescing flush, retransmits, delayed ACKs). Runs from
+  // a timer armed for the earliest deadline.
+  maintenance = [&](utils::TimerId) {
+    maintenance_timer = utils::kInvalidTimerId;
+    maintenance_at = std::chrono::steady_clock::time_point::max();
+    if (!running.load() || sig_handler.should_terminate()) {
+      event_loop.stop();
+      return;
+    }
+
+    // Periodic cleanup of state that is not tied to one session
     auto now = std::chrono::steady_clock::now();
     if (now - last_cleanup >= config.cleanup_interval) {
-      auto expired = session_table.cleanup_expired();
-      if (expired > 0) {
-        if (g_stats.connections_active >= expired) {
-          g_stats.connections_active -= expired;
-        } else {
-          g_stats.connections_active = 0;
-        }
-        cli::print_info("Cleaned up " + std::to_string(expired) + " expired session(s)");
-        LOG_INFO("Cleaned up {} expired sessions", expired);
+      if (ticket_manager) {
+        ticket_manager->cleanup_expired_nonces();
       }
+      egress_scheduler.cleanup(config.session_timeout);
       last_cleanup = now;
     }
 
@@ -662,41 +976,59 @@ int main(int argc, char* argv[]) {
       last_stats = now;
     }
 
-    // Process retransmits for all sessions (use for_each_session to avoid use-after-free)
-    session_table.for_each_session([&](server::ClientSession* session) {
-      if (session->transport) {
-        auto retransmits = session->transport->get_retransmit_packets();
-        for (const auto& pkt : retransmits) {
-          if (!udp_socket.send(pkt, session->endpoint, ec)) {
-            log_retransmit_error(ec);
-          }
-        }
+    // Send what pacing held back.
+    if (egress_scheduler.has_backlog()) {
+      egress_scheduler.service(session_table, egress_send);
+    }
+
+    // Sessions with a deadline due. An idle deadline is checked against the
+    // latest activity, so activity does not have to reschedule it. Sessions
+    // idle long enough with nothing left to send hibernate.
+    std::size_t expired = 0;
+    for (const auto session_id : session_deadlines.take_due(now)) {
+      if (session_table.expire_if_idle(session_id)) {
+        ++expired;
+        continue;
       }
-    });
-
-    // Issue #95: Check for delayed ACKs (ACK coalescing).
-    // The scheduler uses a timer to batch ACKs, reducing overhead.
-    // Check each session's ACK scheduler for pending delayed ACKs.
-    session_table.for_each_session([&](server::ClientSession* session) {
-      if (session->transport) {
-        auto stream_id_opt = session->ack_scheduler.check_ack_timer();
-        if (stream_id_opt) {
-          auto ack_frame_opt = session->ack_scheduler.get_pending_ack(*stream_id_opt);
-          if (ack_frame_opt) {
-            auto ack_mux_frame = mux::make_ack_frame(
-                ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-            auto ack_packet = session->transport->encrypt_frame(ack_mux_frame);
-            if (!udp_socket.send(ack_packet, session->endpoint, ec)) {
-              log_ack_send_error(ec);
-            } else {
-              log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-            }
-            session->ack_scheduler.ack_sent(*stream_id_opt);
-          }
+      auto* session = session_table.find_by_id(session_id);
+      if (session == nullptr) {
+        continue;
+      }
+      touch(session_id);
+      if (!session->transport) {
+        continue;
+      }
+      auto wait = session->coalescer.time_until_flush();
+      if (wait && wait->count() == 0) {
+        flush_coalesced(*session, udp_socket);
+      }
+      auto retransmits = session->transport->get_retransmit_packets();
+      for (const auto& pkt : retransmits) {
+        if (!udp_socket.send(pkt, session->endpoint, ec)) {
+          log_retransmit_error(ec);
         }
       }
-    });
-  }
+      // Issue #95: Delayed ACKs (ACK coalescing). Outgoing data usually
+      // carries them; a standalone ACK goes out when the session's timer expires.
+      send_pending_ack(*session, udp_socket, false);
+      session_table.hibernate_if_idle(session_id);
+    }
+    if (expired > 0) {
+      if (g_stats.connections_active >= expired) {
+        g_stats.connections_active -= expired;
+      } else {
+        g_stats.connections_active = 0;
+      }
+      cli::print_info("Cleaned up " + std::to_string(expired) + " expired session(s)");
+      LOG_INFO("Cleaned up {} expired sessions", expired);
+    }
+
+    reschedule_touched();
+    arm_maintenance();
+  };
+  arm_maintenance();
+  event_loop.run();
+  tun_device.set_write_hook({});
 
   // Cleanup
   std::cout << '\n';
@@ -60,6 +60,30 @@ bool safe_parse_int(const std::string& value, T& out, const std::string& field_n
   }
 }
 
+// Helper to safely parse a non-negative decimal number
+bool safe_parse_double(const std::string& value, double& out, const std::string& field_name,
+                       std::error_code& ec) {
+  try {
+    std::size_t consumed = 0;
+    const double parsed = std::stod(value, &consumed);
+    if (consumed != value.size() || !(parsed >= 0.0)) {
+      LOG_ERROR("Configuration error: {} value '{}' is not a valid non-negative number", field_name, value);
+      ec = std::make_error_code(std::errc::invalid_argument);
+      return false;
+    }
+    out = parsed;
+    return true;
+  } catch (const std::invalid_argument&) {
+    LOG_ERROR("Configuration error: {} value '{}' is not a valid number", field_name, value);
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  } catch (const std::out_of_range&) {
+    LOG_ERROR("Configuration error: {} value '{}' is out of range", field_name, value);
+    ec = std::make_error_code(std::errc::result_out_of_range);
+    return false;
+  }
+}
+
 // Helper to validate IPv4 address format
 bool is_valid_ipv4(const std::string& ip) {
   struct in_addr addr;
@@ -156,6 +180,9 @@ bool parse_args(int argc, char* argv[], ServerConfig& config, std::error_code& e
   // Network.
   app.add_option("-l,--listen", config.listen_address, "Listen address")->default_val("0.0.0.0");
   app.add_option("-p,--port", config.listen_port, "Listen port")->default_val(4433);
+  std::string io_backend;
+  app.add_option("--io-backend", io_backend, "I/O backend: epoll, io_uring or auto")
+      ->check(CLI::IsMember({"epoll", "io_uring", "auto"}));
 
   // TUN device.
   app.add_option("--tun-name", config.tunnel.tun.device_name, "TUN device name")->default_val("veil0");
@@ -168,6 +195,14 @@ bool parse_args(int argc, char* argv[], ServerConfig& config, std::error_code& e
   // Crypto.
   app.add_option("-k,--key", config.tunnel.key_file, "Pre-shared key file");
   app.add_option("--obfuscation-seed", config.tunnel.obfuscation_seed_file, "Obfuscation seed file");
+  app.add_option("--ticket-key", config.ticket_key_file,
+                 "Session ticket key file (32 bytes, shared across server instances)");
+  bool disable_zero_rtt = false;
+  app.add_flag("--no-zero-rtt", disable_zero_rtt, "Disable 0-RTT session resumption");
+
+  // Traffic shaping.
+  app.add_flag("--traffic-shaping", config.traffic_shaping,
+               "Share egress fairly between clients (deficit round-robin)");
 
   // NAT.
   app.add_option("--external-interface", config.nat.external_interface, "External interface for NAT")
@@ -180,6 +215,9 @@ bool parse_args(int argc, char* argv[], ServerConfig& config, std::error_code& e
   int session_timeout_seconds = 300;
   app.add_option("--session-timeout", session_timeout_seconds, "Session timeout in seconds")
       ->default_val(300);
+  int hibernate_after_seconds = -1;
+  app.add_option("--hibernate-after", hibernate_after_seconds,
+                 "Hibernate sessions idle for this many seconds (0 = never)");
 
   // IP pool.
   app.add_option("--ip-pool-start", config.ip_pool_start, "IP pool start")->default_val("10.8.0.2");
@@ -207,6 +245,15 @@ bool parse_args(int argc, char* argv[], ServerConfig& config, std::error_code& e
 
   // Convert session timeout.
   config.session_timeout = std::chrono::seconds(session_timeout_seconds);
+  if (hibernate_after_seconds >= 0) {
+    config.hibernate_after = std::chrono::seconds(hibernate_after_seconds);
+  }
+  if (disable_zero_rtt) {
+    config.tunnel.enable_zero_rtt = false;
+  }
+  if (!io_backend.empty()) {
+    config.tunnel.event_loop.backend = *transport::parse_event_loop_backend(io_backend);
+  }
 
   // Set up tunnel config.
   config.tunnel.local_port = config.listen_port;
@@ -255,6 +302,14 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
         config.daemon_mode = (value == "true" || value == "1" || value == "yes");
       } else if (key == "verbose") {
         config.verbose = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "io_backend") {
+        const auto backend = transport::parse_event_loop_backend(value);
+        if (!backend) {
+          LOG_ERROR("Configuration error: io_backend value '{}' must be epoll, io_uring or auto", value);
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return false;
+        }
+        config.tunnel.event_loop.backend = *backend;
       }
     } else if (section == "tun") {
       if (key == "device_name") {
@@ -273,6 +328,10 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
     } else if (section == "crypto") {
       if (key == "preshared_key_file") {
         config.tunnel.key_file = value;
+      } else if (key == "ticket_key_file") {
+        config.ticket_key_file = value;
+      } else if (key == "zero_rtt") {
+        config.tunnel.enable_zero_rtt = (value == "true" || value == "1" || value == "yes");
       }
     } else if (section == "obfuscation") {
       if (key == "profile_seed_file") {
@@ -287,6 +346,14 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
         config.nat.use_masquerade = (value == "true" || value == "1" || value == "yes");
       } else if (key == "snat_source") {
         config.nat.snat_source = value;
+      } else if (key == "backend") {
+        const auto backend = tun::parse_nat_backend(value);
+        if (!backend) {
+          LOG_ERROR("Configuration error: nat backend value '{}' must be auto, nftables or iptables", value);
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return false;
+        }
+        config.nat.backend = *backend;
       }
     } else if (section == "sessions") {
       if (key == "max_clients") {
@@ -301,6 +368,12 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
           return false;
         }
         config.session_timeout = std::chrono::seconds(timeout);
+      } else if (key == "hibernate_after") {
+        int seconds;
+        if (!safe_parse_int(value, seconds, "hibernate_after", ec)) {
+          return false;
+        }
+        config.hibernate_after = std::chrono::seconds(seconds);
       } else if (key == "cleanup_interval") {
         int interval;
         if (!safe_parse_int(value, interval, "cleanup_interval", ec)) {
@@ -308,12 +381,81 @@ bool load_config_file(const std::string& path, ServerConfig& config, std::error_
         }
         config.cleanup_interval = std::chrono::seconds(interval);
       }
+    } else if (section == "migration") {
+      if (key == "enable_session_migration") {
+        config.migration.enabled = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "max_migrations_per_session") {
+        std::uint32_t max_migrations;
+        if (!safe_parse_int(value, max_migrations, "max_migrations_per_session", ec)) {
+          return false;
+        }
+        config.migration.max_migrations_per_session = max_migrations;
+      } else if (key == "migration_cooldown_sec") {
+        int cooldown;
+        if (!safe_parse_int(value, cooldown, "migration_cooldown_sec", ec)) {
+          return false;
+        }
+        config.migration.migration_cooldown = std::chrono::seconds(cooldown);
+      }
+    } else if (section == "rate_limiting") {
+      // Per-client limits, enforced by the egress scheduler when traffic
+      // shaping is enabled.
+      auto client_limits = [&config]() -> utils::RateLimiterConfig& {
+        if (!config.egress.client_limits) {
+          config.egress.client_limits.emplace();
+        }
+        return *config.egress.client_limits;
+      };
+      if (key == "enable_traffic_shaping") {
+        config.traffic_shaping = (value == "true" || value == "1" || value == "yes");
+      } else if (key == "per_client_bandwidth_mbps") {
+        std::uint64_t mbps;
+        if (!safe_parse_int(value, mbps, "per_client_bandwidth_mbps", ec)) {
+          return false;
+        }
+        client_limits().bandwidth_bytes_per_sec = mbps * 1000 * 1000 / 8;
+      } else if (key == "per_client_pps") {
+        std::uint64_t pps;
+        if (!safe_parse_int(value, pps, "per_client_pps", ec)) {
+          return false;
+        }
+        client_limits().packets_per_sec = pps;
+      } else if (key == "burst_allowance_factor") {
+        double factor;
+        if (!safe_parse_double(value, factor, "burst_allowance_factor", ec)) {
+          return false;
+        }
+        client_limits().burst_allowance_factor = factor;
+      }
     } else if (section == "ip_pool") {
       if (key == "start") {
         config.ip_pool_start = value;
       } else if (key == "end") {
         config.ip_pool_end = value;
       }
+    } else if (section == "routes") {
+      // Subnets behind a client.
+      // Format: client_tunnel_ip = prefix[, prefix...]
+      // Example: 10.8.0.10 = 192.168.50.0/24, fd00:50::/64
+      if (!is_valid_ipv4(key)) {
+        LOG_ERROR("Configuration error: Invalid client tunnel IP '{}' in [routes]", key);
+        ec = std::make_error_code(std::errc::invalid_argument);
+        return false;
+      }
+      auto& routes = config.client_routes[key];
+      std::stringstream list(value);
+      std::string item;
+      while (std::getline(list, item, ',')) {
+        item.erase(0, item.find_first_not_of(" \t"));
+        item.erase(item.find_last_not_of(" \t") + 1);
+        auto prefix = IpPrefix::parse(item);
+        if (!prefix) {
+          LOG_ERROR("Configuration error: Invalid route '{}' for client {}", item, key);
+          ec = std::make_error_code(std::errc::invalid_argument);
+          return false;
+        }
+        routes.push_back(*prefix);
+      }
     } else if (section == "daemon") {
       if (key == "pid_file") {
         config.pid_file = value;
@@ -491,6 +633,43 @@ bool validate_config(const ServerConfig& config, std::string& error) {
     return false;
   }
 
+  // Client routes: the client must be able to hold that tunnel IP, and each
+  // subnet can only be behind one client.
+  std::vector<IpPrefix> routed;
+  for (const auto& [client_ip, prefixes] : config.client_routes) {
+    const auto client = ipv4_to_uint(client_ip);
+    if (client < pool_start || client > pool_end) {
+      error = "Client tunnel IP " + client_ip + " in [routes] is outside the IP pool";
+      return false;
+    }
+    for (const auto& prefix : prefixes) {
+      if (std::find(routed.begin(), routed.end(), prefix) != routed.end()) {
+        error = "Route " + prefix.to_string() + " is assigned to more than one client";
+        return false;
+      }
+      routed.push_back(prefix);
+    }
+  }
+
+  if (config.hibernate_after.count() < 0 ||
+      (config.hibernate_after.count() > 0 && config.hibernate_after >= config.session_timeout)) {
+    error = "hibernate_after must be 0 (off) or shorter than session_timeout";
+    return false;
+  }
+
+  // A client's bucket must hold at least one full datagram, or the egress
+  // scheduler could never send to it.
+  if (config.traffic_shaping && config.egress.client_limits) {
+    const auto& limits = *config.egress.client_limits;
+    const double burst_bytes = static_cast<double>(limits.bandwidth_bytes_per_sec) * limits.burst_allowance_factor;
+    const double burst_packets = static_cast<double>(limits.packets_per_sec) * limits.burst_allowance_factor;
+    if (burst_bytes < static_cast<double>(config.tunnel.transport.mtu) || burst_packets < 1.0) {
+      error = "Per-client rate limits are too low to send a single datagram "
+              "(check per_client_bandwidth_mbps, per_client_pps and burst_allowance_factor)";
+      return false;
+    }
+  }
+
   // Validate NAT external interface is not empty if NAT is enabled
   if (config.nat.enable_forwarding && config.nat.external_interface.empty()) {
     error = "NAT external interface is required when NAT is enabled. "
@@ -3,8 +3,12 @@
 #include <cstdint>
 #include <string>
 #include <system_error>
+#include <unordered_map>
 #include <vector>
 
+#include "server/allowed_ips.h"
+#include "server/egress_scheduler.h"
+#include "tunnel/session_migration.h"
 #include "tunnel/tunnel.h"
 #include "tun/routing.h"
 
@@ -35,6 +39,20 @@ struct ServerConfig {
   std::size_t max_clients{256};
   std::chrono::seconds session_timeout{300};
   std::chrono::seconds cleanup_interval{60};
+  // Idle sessions with nothing in flight hibernate after this long (0 = never):
+  // they keep only their keys, counters, endpoint and tunnel IP, and resume
+  // on their next packet without a handshake until session_timeout.
+  std::chrono::seconds hibernate_after{0};
+
+  // Connection migration: sessions follow clients whose address changes
+  // (NAT rebinding, network switch) without a new handshake.
+  tunnel::SessionMigrationConfig migration;
+
+  // Egress traffic shaping: TUN traffic for clients is queued per session and
+  // sent in deficit round-robin order, within the per-client limits
+  // (egress.client_limits) and the sessions' congestion windows.
+  bool traffic_shaping{false};
+  EgressSchedulerConfig egress;
 
   // Network.
   std::string listen_address{"0.0.0.0"};
@@ -44,6 +62,12 @@ struct ServerConfig {
   std::string ip_pool_start{"10.8.0.2"};
   std::string ip_pool_end{"10.8.0.254"};
 
+  // Subnets behind clients (site-to-site), keyed by the client's tunnel IP:
+  // traffic for them is routed to that client, which may also send from
+  // them. The server's kernel routes for these subnets must point at the
+  // TUN device.
+  std::unordered_map<std::string, std::vector<IpPrefix>> client_routes;
+
   // Daemon settings.
   std::string pid_file{"/var/run/veil-server.pid"};
   std::string log_file;
@@ -54,6 +78,11 @@ struct ServerConfig {
   // Each client can have a unique PSK for individual revocation and audit.
   std::vector<ClientPskEntry> client_psks;
 
+  // Session ticket master key file (Issue #86): 32 raw bytes shared by all
+  // server instances so 0-RTT tickets survive restarts and work across workers.
+  // Empty = random per-process key.
+  std::string ticket_key_file;
+
   // Fallback PSK for backward compatibility with legacy clients.
   // If set, clients without a specific PSK entry will use this key.
   std::vector<std::uint8_t> fallback_psk;
@@ -0,0 +1,78 @@
+#include "server/session_deadlines.h"
+
+#include <utility>
+
+namespace veil::server {
+
+namespace {
+// Rebuild the heap once it holds this many more entries than twice the live
+// deadlines, so moving deadlines costs amortized O(log n).
+constexpr std::size_t kCompactSlack = 64;
+}  // namespace
+
+void SessionDeadlines::schedule(std::uint64_t session_id, TimePoint deadline) {
+  auto [it, inserted] = deadlines_.try_emplace(session_id, deadline);
+  if (!inserted) {
+    if (it->second == deadline) {
+      return;
+    }
+    it->second = deadline;
+  }
+  heap_.push(Entry{deadline, session_id});
+  if (heap_.size() > 2 * deadlines_.size() + kCompactSlack) {
+    compact();
+  }
+}
+
+void SessionDeadlines::cancel(std::uint64_t session_id) { deadlines_.erase(session_id); }
+
+std::vector<std::uint64_t> SessionDeadlines::take_due(TimePoint now) {
+  std::vector<std::uint64_t> due;
+  while (!heap_.empty() && heap_.top().deadline <= now) {
+    const Entry entry = heap_.top();
+    heap_.pop();
+    if (is_live(entry)) {
+      deadlines_.erase(entry.session_id);
+      due.push_back(entry.session_id);
+    }
+  }
+  return due;
+}
+
+std::optional<SessionDeadlines::TimePoint> SessionDeadlines::next_deadline() {
+  skip_stale();
+  if (heap_.empty()) {
+    return std::nullopt;
+  }
+  return heap_.top().deadline;
+}
+
+std::optional<SessionDeadlines::TimePoint> SessionDeadlines::deadline_of(std::uint64_t session_id) const {
+  auto it = deadlines_.find(session_id);
+  if (it == deadlines_.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+bool SessionDeadlines::is_live(const Entry& entry) const {
+  auto it = deadlines_.find(entry.session_id);
+  return it != deadlines_.end() && it->second == entry.deadline;
+}
+
+void SessionDeadlines::skip_stale() {
+  while (!heap_.empty() && !is_live(heap_.top())) {
+    heap_.pop();
+  }
+}
+
+void SessionDeadlines::compact() {
+  std::vector<Entry> entries;
+  entries.reserve(deadlines_.size());
+  for (const auto& [session_id, deadline] : deadlines_) {
+    entries.push_back(Entry{deadline, session_id});
+  }
+  heap_ = std::priority_queue<Entry, std::vector<Entry>, std::greater<>>(std::greater<>{}, std::move(entries));
+}
+
+}  // namespace veil::server
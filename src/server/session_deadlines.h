@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace veil::server {
+
+/**
+ * Next deadline of each session: retransmit timeout, delayed ACK, coalescing
+ * flush, pacing and idle timeout, whichever comes first. The server's
+ * maintenance timer takes only the sessions whose deadline has passed, so its
+ * cost depends on how many sessions have work due, not on how many sessions
+ * exist.
+ *
+ * A min-heap ordered by deadline, with a map holding each session's current
+ * deadline. Moving or cancelling a deadline leaves the old heap entry behind;
+ * it is skipped when it reaches the top (as in utils::TimerHeap), and the
+ * heap is rebuilt once stale entries outnumber live ones.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session table.
+ */
+class SessionDeadlines {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  // Set a session's next deadline, replacing any earlier registration.
+  void schedule(std::uint64_t session_id, TimePoint deadline);
+
+  // Forget a session's deadline.
+  void cancel(std::uint64_t session_id);
+
+  // Sessions whose deadline is at or before now, earliest first. They are
+  // unregistered; the caller schedules each again once it has serviced it.
+  std::vector<std::uint64_t> take_due(TimePoint now);
+
+  // Earliest registered deadline; nullopt if none.
+  std::optional<TimePoint> next_deadline();
+
+  // The deadline registered for a session, if any.
+  std::optional<TimePoint> deadline_of(std::uint64_t session_id) const;
+
+  std::size_t size() const { return deadlines_.size(); }
+  bool empty() const { return deadlines_.empty(); }
+
+ private:
+  struct Entry {
+    TimePoint deadline;
+    std::uint64_t session_id{0};
+
+    // Min-heap comparison (earlier deadline = higher priority).
+    bool operator>(const Entry& other) const { return deadline > other.deadline; }
+  };
+
+  // True if the entry is a session's current deadline.
+  bool is_live(const Entry& entry) const;
+
+  // Drop stale entries from the top of the heap.
+  void skip_stale();
+
+  // Rebuild the heap from the live deadlines.
+  void compact();
+
+  std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap_;
+  std::unordered_map<std::uint64_t, TimePoint> deadlines_;
+};
+
+}  // namespace veil::server
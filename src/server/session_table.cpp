@@ -13,6 +13,20 @@
 
 namespace veil::server {
 
+namespace {
+
+// Session an address (IPv4 or IPv6 text) routes to.
+std::optional<std::uint64_t> lookup_address(const AllowedIps& routes, const std::string& ip) {
+  const auto address = IpPrefix::parse(ip);
+  if (!address) {
+    return std::nullopt;
+  }
+  const std::size_t size = address->family == IpFamily::kV4 ? 4 : 16;
+  return routes.lookup(address->family, std::span<const std::uint8_t>(address->address.data(), size));
+}
+
+}  // namespace
+
 SessionTable::SessionTable(std::size_t max_clients, std::chrono::seconds session_timeout,
                            const std::string& ip_pool_start, const std::string& ip_pool_end,
                            std::function<TimePoint()> now_fn)
@@ -59,13 +73,58 @@ void SessionTable::release_ip(const std::string& ip) {
   }
 }
 
+void SessionTable::assign_routes(std::uint64_t session_id, const std::string& tunnel_ip) {
+  routes_.remove_session(session_id);
+  if (auto host = IpPrefix::parse(tunnel_ip)) {
+    routes_.insert(*host, session_id);
+  }
+  auto it = client_routes_.find(tunnel_ip);
+  if (it != client_routes_.end()) {
+    for (const auto& prefix : it->second) {
+      routes_.insert(prefix, session_id);
+    }
+  }
+}
+
+void SessionTable::move_tunnel_ip(ClientSession& session, const std::string& new_ip) {
+  // Take the new address out of the pool so it is not handed to another
+  // client, and return the old one.
+  const auto claimed = std::find(available_ips_.begin(), available_ips_.end(), ip_to_uint(new_ip));
+  if (claimed != available_ips_.end()) {
+    available_ips_.erase(claimed);
+  }
+  release_ip(session.tunnel_ip);
+
+  LOG_INFO("Updated tunnel IP for session {} from {} to {} (client uses own IP)", session.session_id,
+           session.tunnel_ip, new_ip);
+  session.tunnel_ip = new_ip;
+  assign_routes(session.session_id, new_ip);
+}
+
 std::uint64_t SessionTable::generate_session_id() { return next_session_id_++; }
 
+void SessionTable::erase_connection_index(const ClientSession& session) {
+  auto it = connection_index_.find(session.connection_id);
+  if (it != connection_index_.end() && it->second == session.session_id) {
+    connection_index_.erase(it);
+  }
+}
+
 std::optional<std::uint64_t> SessionTable::create_session(
     const transport::UdpEndpoint& endpoint, std::unique_ptr<transport::TransportSession> transport) {
   std::lock_guard<std::mutex> lock(mutex_);
 
-  if (sessions_.size() >= max_clients_) {
+  if (sessions_.size() + hibernated_.size() >= max_clients_ && !hibernated_.empty()) {
+    // Make room by dropping the hibernated session idle the longest.
+    auto oldest = std::min_element(hibernated_.begin(), hibernated_.end(), [](const auto& a, const auto& b) {
+      return a.second.last_activity < b.second.last_activity;
+    });
+    LOG_INFO("Session table full, dropping hibernated session {}", oldest->first);
+    erase_hibernated(oldest);
+    stats_.hibernated_sessions = hibernated_.size();
+  }
+
+  if (sessions_.size() + hibernated_.size() >= max_clients_) {
     stats_.sessions_rejected_full++;
     LOG_WARN("Session table full, rejecting client {}:{}", endpoint.host, endpoint.port);
     return std::nullopt;
@@ -82,6 +141,7 @@ std::optional<std::uint64_t> SessionTable::create_session(
   // Create session.
   auto session = std::make_unique<ClientSession>();
   session->session_id = generate_session_id();
+  session->connection_id = transport ? transport->connection_id() : 0;
   session->endpoint = endpoint;
   session->tunnel_ip = *ip;
   session->transport = std::move(transport);
@@ -91,7 +151,12 @@ std::optional<std::uint64_t> SessionTable::create_session(
   // Update indices.
   std::string endpoint_key = endpoint.host + ":" + std::to_string(endpoint.port);
   endpoint_index_[endpoint_key] = session->session_id;
-  ip_index_[*ip] = session->session_id;
+  assign_routes(session->session_id, *ip);
+  if (session->connection_id != 0) {
+    // A client that re-handshakes gets new keys and therefore a new connection ID;
+    // an existing entry can only be a stale session and is simply replaced.
+    connection_index_[session->connection_id] = session->session_id;
+  }
 
   std::uint64_t id = session->session_id;
   sessions_[id] = std::move(session);
@@ -112,6 +177,18 @@ ClientSession* SessionTable::find_by_id(std::uint64_t session_id) {
   return nullptr;
 }
 
+ClientSession* SessionTable::find_by_connection_id(std::uint64_t connection_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = connection_index_.find(connection_id);
+  if (it != connection_index_.end()) {
+    auto session_it = sessions_.find(it->second);
+    if (session_it != sessions_.end()) {
+      return session_it->second.get();
+    }
+  }
+  return nullptr;
+}
+
 ClientSession* SessionTable::find_by_endpoint(const transport::UdpEndpoint& endpoint) {
   std::lock_guard<std::mutex> lock(mutex_);
   std::string key = endpoint.host + ":" + std::to_string(endpoint.port);
@@ -127,9 +204,8 @@ ClientSession* SessionTable::find_by_endpoint(const transport::UdpEndpoint& endp
 
 ClientSession* SessionTable::find_by_tunnel_ip(const std::string& ip) {
   std::lock_guard<std::mutex> lock(mutex_);
-  auto it = ip_index_.find(ip);
-  if (it != ip_index_.end()) {
-    auto session_it = sessions_.find(it->second);
+  if (auto session_id = lookup_address(routes_, ip)) {
+    auto session_it = sessions_.find(*session_id);
     if (session_it != sessions_.end()) {
       return session_it->second.get();
     }
@@ -137,6 +213,57 @@ ClientSession* SessionTable::find_by_tunnel_ip(const std::string& ip) {
   return nullptr;
 }
 
+ClientSession* SessionTable::find_by_route(std::span<const std::uint8_t> packet) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (auto session_id = routes_.route(packet)) {
+    auto session_it = sessions_.find(*session_id);
+    if (session_it != sessions_.end()) {
+      return session_it->second.get();
+    }
+  }
+  return nullptr;
+}
+
+void SessionTable::set_client_routes(std::unordered_map<std::string, std::vector<IpPrefix>> routes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  client_routes_ = std::move(routes);
+  for (const auto& [id, session] : sessions_) {
+    assign_routes(id, session->tunnel_ip);
+  }
+  for (const auto& [id, hibernated] : hibernated_) {
+    assign_routes(id, uint_to_ip(hibernated.tunnel_ip));
+  }
+}
+
+bool SessionTable::accept_source(std::uint64_t session_id, std::span<const std::uint8_t> packet) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(session_id);
+  const auto addresses = packet_addresses(packet);
+  if (it == sessions_.end() || !addresses) {
+    return false;
+  }
+  if (auto owner = routes_.lookup(addresses->family, addresses->source)) {
+    return *owner == session_id;
+  }
+  if (addresses->family != IpFamily::kV4) {
+    return false;
+  }
+  // Issue #74: the client may use its own configured tunnel IP (e.g.
+  // 10.8.0.2) instead of the assigned one (e.g. 10.8.0.254); return traffic
+  // is addressed to the IP it sends from. Only a free pool address can be
+  // taken over, so a client cannot claim another client's address or
+  // anything outside the tunnel network.
+  const auto& source = addresses->source;
+  const std::uint32_t source_ip = (static_cast<std::uint32_t>(source[0]) << 24) |
+                                  (static_cast<std::uint32_t>(source[1]) << 16) |
+                                  (static_cast<std::uint32_t>(source[2]) << 8) | static_cast<std::uint32_t>(source[3]);
+  if (std::find(available_ips_.begin(), available_ips_.end(), source_ip) == available_ips_.end()) {
+    return false;
+  }
+  move_tunnel_ip(*it->second, uint_to_ip(source_ip));
+  return true;
+}
+
 void SessionTable::update_activity(std::uint64_t session_id) {
   std::lock_guard<std::mutex> lock(mutex_);
   auto it = sessions_.find(session_id);
@@ -152,23 +279,35 @@ bool SessionTable::update_tunnel_ip(std::uint64_t session_id, const std::string&
     return false;
   }
 
-  const std::string& old_ip = it->second->tunnel_ip;
-
   // Skip if IP hasn't changed
-  if (old_ip == new_ip) {
-    return true;
+  if (it->second->tunnel_ip != new_ip) {
+    move_tunnel_ip(*it->second, new_ip);
   }
+  return true;
+}
 
-  // Update the IP index: remove old mapping, add new one
-  ip_index_.erase(old_ip);
-  ip_index_[new_ip] = session_id;
+bool SessionTable::update_endpoint(std::uint64_t session_id, const transport::UdpEndpoint& endpoint) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end()) {
+    return false;
+  }
 
-  // Update the session's tunnel IP
-  it->second->tunnel_ip = new_ip;
+  auto& session = *it->second;
+  if (session.endpoint.host == endpoint.host && session.endpoint.port == endpoint.port) {
+    return true;
+  }
 
-  LOG_INFO("Updated tunnel IP for session {} from {} to {} (client uses own IP)",
-           session_id, old_ip, new_ip);
+  const std::string old_key = session.endpoint.host + ":" + std::to_string(session.endpoint.port);
+  auto old_it = endpoint_index_.find(old_key);
+  if (old_it != endpoint_index_.end() && old_it->second == session_id) {
+    endpoint_index_.erase(old_it);
+  }
+  endpoint_index_[endpoint.host + ":" + std::to_string(endpoint.port)] = session_id;
 
+  LOG_INFO("Session {} migrated from {} to {}:{}", session_id, old_key, endpoint.host, endpoint.port);
+  session.endpoint = endpoint;
+  stats_.sessions_migrated++;
   return true;
 }
 
@@ -176,14 +315,22 @@ bool SessionTable::remove_session(std::uint64_t session_id) {
   std::lock_guard<std::mutex> lock(mutex_);
   auto it = sessions_.find(session_id);
   if (it == sessions_.end()) {
-    return false;
+    auto hibernated_it = hibernated_.find(session_id);
+    if (hibernated_it == hibernated_.end()) {
+      return false;
+    }
+    LOG_INFO("Removed hibernated session {}", session_id);
+    erase_hibernated(hibernated_it);
+    stats_.hibernated_sessions = hibernated_.size();
+    return true;
   }
 
   // Remove from indices.
   std::string endpoint_key =
       it->second->endpoint.host + ":" + std::to_string(it->second->endpoint.port);
   endpoint_index_.erase(endpoint_key);
-  ip_index_.erase(it->second->tunnel_ip);
+  routes_.remove_session(it->first);
+  erase_connection_index(*it->second);
 
   // Release IP.
   release_ip(it->second->tunnel_ip);
@@ -212,20 +359,198 @@ std::size_t SessionTable::cleanup_expired() {
   for (std::uint64_t id : expired) {
     auto it = sessions_.find(id);
     if (it != sessions_.end()) {
-      std::string endpoint_key =
-          it->second->endpoint.host + ":" + std::to_string(it->second->endpoint.port);
-      endpoint_index_.erase(endpoint_key);
-      ip_index_.erase(it->second->tunnel_ip);
-      release_ip(it->second->tunnel_ip);
-
-      LOG_INFO("Session {} timed out", id);
-      sessions_.erase(it);
+      erase_timed_out(it);
+    }
+  }
+
+  std::size_t removed = expired.size();
+  for (auto it = hibernated_.begin(); it != hibernated_.end();) {
+    auto age = std::chrono::duration_cast<std::chrono::seconds>(now - it->second.last_activity);
+    if (age >= session_timeout_) {
+      LOG_INFO("Hibernated session {} timed out", it->first);
+      erase_hibernated(it++);
       stats_.sessions_timed_out++;
+      ++removed;
+    } else {
+      ++it;
     }
   }
 
   stats_.active_sessions = sessions_.size();
-  return expired.size();
+  stats_.hibernated_sessions = hibernated_.size();
+  return removed;
+}
+
+bool SessionTable::expire_if_idle(std::uint64_t session_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end()) {
+    auto hibernated_it = hibernated_.find(session_id);
+    if (hibernated_it == hibernated_.end() || now_fn_() - hibernated_it->second.last_activity < session_timeout_) {
+      return false;
+    }
+    LOG_INFO("Hibernated session {} timed out", session_id);
+    erase_hibernated(hibernated_it);
+    stats_.sessions_timed_out++;
+    stats_.hibernated_sessions = hibernated_.size();
+    return true;
+  }
+  auto age = std::chrono::duration_cast<std::chrono::seconds>(now_fn_() - it->second->last_activity);
+  if (age < session_timeout_) {
+    return false;
+  }
+  erase_timed_out(it);
+  stats_.active_sessions = sessions_.size();
+  return true;
+}
+
+void SessionTable::erase_timed_out(SessionMap::iterator it) {
+  std::string endpoint_key = it->second->endpoint.host + ":" + std::to_string(it->second->endpoint.port);
+  endpoint_index_.erase(endpoint_key);
+  routes_.remove_session(it->first);
+  erase_connection_index(*it->second);
+  release_ip(it->second->tunnel_ip);
+
+  LOG_INFO("Session {} timed out", it->first);
+  sessions_.erase(it);
+  stats_.sessions_timed_out++;
+}
+
+bool SessionTable::hibernate_if_idle(std::uint64_t session_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (hibernate_after_.count() == 0) {
+    return false;
+  }
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end()) {
+    return false;
+  }
+  const auto& session = *it->second;
+  if (now_fn_() - session.last_activity < hibernate_after_ || !session.transport ||
+      session.transport->next_timer_deadline() || !session.coalescer.empty() ||
+      (session.egress && !session.egress->empty())) {
+    return false;
+  }
+  hibernate_locked(it);
+  return true;
+}
+
+bool SessionTable::hibernate(std::uint64_t session_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end() || !it->second->transport) {
+    return false;
+  }
+  hibernate_locked(it);
+  return true;
+}
+
+void SessionTable::hibernate_locked(SessionMap::iterator it) {
+  auto& session = *it->second;
+  HibernatedSession hibernated;
+  hibernated.transport = session.transport->hibernate();
+  hibernated.endpoint = session.endpoint;
+  hibernated.tunnel_ip = ip_to_uint(session.tunnel_ip);
+  hibernated.connected_at = session.connected_at;
+  hibernated.last_activity = session.last_activity;
+
+  const std::string endpoint_key = session.endpoint.host + ":" + std::to_string(session.endpoint.port);
+  auto endpoint_it = endpoint_index_.find(endpoint_key);
+  if (endpoint_it != endpoint_index_.end() && endpoint_it->second == session.session_id) {
+    endpoint_index_.erase(endpoint_it);
+  }
+
+  LOG_DEBUG("Session {} hibernated", it->first);
+  hibernated_.emplace(it->first, std::move(hibernated));
+  sessions_.erase(it);
+  stats_.sessions_hibernated++;
+  stats_.active_sessions = sessions_.size();
+  stats_.hibernated_sessions = hibernated_.size();
+}
+
+ClientSession* SessionTable::resume_by_packet(std::span<const std::uint8_t> packet,
+                                              const transport::TransportSessionConfig& config) {
+  const auto connection_id = transport::TransportSession::peek_connection_id(packet);
+  if (!connection_id) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = connection_index_.find(*connection_id);
+  if (it == connection_index_.end()) {
+    return nullptr;
+  }
+  auto hibernated_it = hibernated_.find(it->second);
+  if (hibernated_it == hibernated_.end() ||
+      !transport::TransportSession::authenticate(hibernated_it->second.transport, packet)) {
+    return nullptr;
+  }
+  return resume_locked(it->second, config);
+}
+
+ClientSession* SessionTable::resume_by_tunnel_ip(const std::string& ip,
+                                                 const transport::TransportSessionConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto session_id = lookup_address(routes_, ip);
+  return session_id ? resume_locked(*session_id, config) : nullptr;
+}
+
+ClientSession* SessionTable::resume_by_route(std::span<const std::uint8_t> packet,
+                                             const transport::TransportSessionConfig& config) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto session_id = routes_.route(packet);
+  return session_id ? resume_locked(*session_id, config) : nullptr;
+}
+
+ClientSession* SessionTable::resume_locked(std::uint64_t session_id, const transport::TransportSessionConfig& config) {
+  auto it = hibernated_.find(session_id);
+  if (it == hibernated_.end()) {
+    return nullptr;
+  }
+  auto& hibernated = it->second;
+
+  auto session = std::make_unique<ClientSession>();
+  session->session_id = session_id;
+  session->transport = std::make_unique<transport::TransportSession>(hibernated.transport, config, now_fn_);
+  session->connection_id = session->transport->connection_id();
+  session->endpoint = hibernated.endpoint;
+  session->tunnel_ip = uint_to_ip(hibernated.tunnel_ip);
+  session->connected_at = hibernated.connected_at;
+  session->last_activity = hibernated.last_activity;
+  endpoint_index_[session->endpoint.host + ":" + std::to_string(session->endpoint.port)] = session_id;
+
+  hibernated.transport.wipe();
+  hibernated_.erase(it);
+  auto* result = session.get();
+  sessions_[session_id] = std::move(session);
+
+  LOG_DEBUG("Session {} resumed from hibernation", session_id);
+  stats_.sessions_resumed++;
+  stats_.active_sessions = sessions_.size();
+  stats_.hibernated_sessions = hibernated_.size();
+  return result;
+}
+
+std::optional<SessionTable::TimePoint> SessionTable::hibernated_expiry(std::uint64_t session_id) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = hibernated_.find(session_id);
+  if (it == hibernated_.end()) {
+    return std::nullopt;
+  }
+  return it->second.last_activity + session_timeout_;
+}
+
+void SessionTable::erase_hibernated(HibernatedMap::iterator it) {
+  const auto session_id = it->first;
+  auto& hibernated = it->second;
+  const std::string tunnel_ip = uint_to_ip(hibernated.tunnel_ip);
+  routes_.remove_session(session_id);
+  auto connection_it = connection_index_.find(crypto::derive_connection_id(hibernated.transport.keys));
+  if (connection_it != connection_index_.end() && connection_it->second == session_id) {
+    connection_index_.erase(connection_it);
+  }
+  release_ip(tunnel_ip);
+  hibernated.transport.wipe();
+  hibernated_.erase(it);
 }
 
 std::vector<SessionSnapshot> SessionTable::get_all_sessions() {
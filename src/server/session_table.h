@@ -5,12 +5,16 @@
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "common/handshake/handshake_processor.h"
-#include "transport/mux/ack_scheduler.h"
+#include "common/utils/advanced_rate_limiter.h"
+#include "server/allowed_ips.h"
+#include "transport/session/packet_coalescer.h"
+#include "transport/session/priority_scheduler.h"
 #include "transport/session/transport_session.h"
 #include "transport/udp_socket/udp_socket.h"
 
@@ -21,6 +25,9 @@ struct ClientSession {
   // Unique session identifier.
   std::uint64_t session_id{0};
 
+  // Connection ID carried in every packet; the primary lookup key.
+  std::uint64_t connection_id{0};
+
   // Client endpoint.
   transport::UdpEndpoint endpoint;
 
@@ -30,8 +37,15 @@ struct ClientSession {
   // Transport session.
   std::unique_ptr<transport::TransportSession> transport;
 
-  // ACK scheduler for ACK coalescing (Issue #95).
-  mux::AckScheduler ack_scheduler;
+  // Queued TUN packets bound for this client, sealed into shared datagrams.
+  transport::PacketCoalescer coalescer;
+
+  // With traffic shaping: queued TUN packets bound for this client, sent by
+  // the EgressScheduler in turn with other clients. Not set up otherwise.
+  std::optional<transport::PriorityScheduler> egress;
+
+  // This client's share of the server's egress relative to other clients.
+  utils::TrafficPriority priority{utils::TrafficPriority::kNormal};
 
   // Timestamps.
   std::chrono::steady_clock::time_point connected_at;
@@ -44,12 +58,26 @@ struct ClientSession {
   std::uint64_t packets_sent{0};
 };
 
+// An idle session squeezed down to what it needs to come back on its next
+// packet without a handshake (see SessionTable::hibernate_if_idle()).
+struct HibernatedSession {
+  transport::HibernatedTransport transport;
+  transport::UdpEndpoint endpoint;
+  std::uint32_t tunnel_ip{0};
+  std::chrono::steady_clock::time_point connected_at;
+  std::chrono::steady_clock::time_point last_activity;
+};
+
 // Session table statistics.
 struct SessionTableStats {
   std::size_t active_sessions{0};
+  std::size_t hibernated_sessions{0};
   std::size_t total_sessions_created{0};
   std::size_t sessions_timed_out{0};
   std::size_t sessions_rejected_full{0};
+  std::size_t sessions_migrated{0};
+  std::size_t sessions_hibernated{0};
+  std::size_t sessions_resumed{0};
 };
 
 // Snapshot of session information for safe iteration.
@@ -84,12 +112,35 @@ class SessionTable {
   // Find session by session ID.
   ClientSession* find_by_id(std::uint64_t session_id);
 
+  // Find session by the connection ID of a received packet.
+  ClientSession* find_by_connection_id(std::uint64_t connection_id);
+
   // Find session by client endpoint.
   ClientSession* find_by_endpoint(const transport::UdpEndpoint& endpoint);
 
-  // Find session by tunnel IP.
+  // Move a session to a new client endpoint (NAT rebinding / network change).
+  // Updates the endpoint index in place; the transport session is untouched.
+  // Returns false if the session does not exist.
+  bool update_endpoint(std::uint64_t session_id, const transport::UdpEndpoint& endpoint);
+
+  // Find the session an address routes to: the one holding it as its tunnel
+  // IP, or the one with the longest client route containing it.
   ClientSession* find_by_tunnel_ip(const std::string& ip);
 
+  // Find the session a packet from the TUN device goes to, by its IPv4 or
+  // IPv6 destination address.
+  ClientSession* find_by_route(std::span<const std::uint8_t> packet);
+
+  // Subnets behind clients, keyed by tunnel IP. A session gets the routes
+  // of its tunnel IP on top of the tunnel IP itself.
+  void set_client_routes(std::unordered_map<std::string, std::vector<IpPrefix>> routes);
+
+  // Check the source address of a packet received from a session: it must
+  // route back to that session. A client using its own configured tunnel IP
+  // instead of the assigned one (Issue #74) takes it over if it is a free
+  // address of the pool. Returns false for spoofed or unroutable packets.
+  bool accept_source(std::uint64_t session_id, std::span<const std::uint8_t> packet);
+
   // Update last activity timestamp.
   void update_activity(std::uint64_t session_id);
 
@@ -105,6 +156,45 @@ class SessionTable {
   // Returns number of sessions removed.
   std::size_t cleanup_expired();
 
+  // Remove one session if it has timed out. Returns true if it was removed.
+  // Lets callers that track each session's idle deadline expire sessions
+  // without scanning the table.
+  bool expire_if_idle(std::uint64_t session_id);
+
+  // Hibernation (off while hibernate_after is zero). A session idle for
+  // hibernate_after with nothing in flight gives up its transport and keeps
+  // only a HibernatedSession: its session ID, connection ID and tunnel IP
+  // stay reserved, and it still expires after session_timeout. Hibernated
+  // sessions count towards max_clients; when the table is full, the one idle
+  // longest makes room for a new client.
+  void set_hibernate_after(std::chrono::seconds idle) { hibernate_after_ = idle; }
+  std::chrono::seconds hibernate_after() const { return hibernate_after_; }
+
+  // Hibernate one session if hibernation is on, it has been idle for
+  // hibernate_after and its transport, coalescer and egress queue have
+  // nothing pending. Returns true if it was hibernated.
+  bool hibernate_if_idle(std::uint64_t session_id);
+
+  // Hibernate a session now, whatever its idle time. Used to put back a
+  // session resumed for a packet that did not decrypt.
+  bool hibernate(std::uint64_t session_id);
+
+  // Rebuild the hibernated session a received packet (by its connection ID)
+  // or traffic from the TUN device (by tunnel IP or route) is for, and make
+  // it active again under its old session ID. Returns nullptr if there is
+  // none. A received packet must authenticate against the hibernated keys
+  // first (TransportSession::authenticate()), so forged packets neither
+  // rebuild a session nor keep it alive. The caller applies its per-session
+  // setup (coalescing, egress) as for a new session.
+  ClientSession* resume_by_packet(std::span<const std::uint8_t> packet,
+                                  const transport::TransportSessionConfig& config);
+  ClientSession* resume_by_tunnel_ip(const std::string& ip, const transport::TransportSessionConfig& config);
+  ClientSession* resume_by_route(std::span<const std::uint8_t> packet,
+                                 const transport::TransportSessionConfig& config);
+
+  // When a hibernated session expires; nullopt if it is not hibernated.
+  std::optional<TimePoint> hibernated_expiry(std::uint64_t session_id) const;
+
   // Get all active sessions (returns snapshots to avoid use-after-free).
   // NOTE: The returned snapshots are copies of the session data at the time of the call.
   // They are safe to use even if the original sessions are removed.
@@ -124,22 +214,54 @@ class SessionTable {
   // Get statistics.
   const SessionTableStats& stats() const { return stats_; }
 
-  // Get current session count.
+  // Get current session count (active sessions only).
   std::size_t session_count() const { return sessions_.size(); }
 
+  // Number of hibernated sessions.
+  std::size_t hibernated_count() const { return hibernated_.size(); }
+
   // Check if table is full.
-  bool is_full() const { return sessions_.size() >= max_clients_; }
+  bool is_full() const { return sessions_.size() + hibernated_.size() >= max_clients_; }
+
+  std::chrono::seconds session_timeout() const { return session_timeout_; }
 
  private:
+  using SessionMap = std::unordered_map<std::uint64_t, std::unique_ptr<ClientSession>>;
+
+  using HibernatedMap = std::unordered_map<std::uint64_t, HibernatedSession>;
+
+  // Remove a timed-out session and its index entries (mutex held).
+  void erase_timed_out(SessionMap::iterator it);
+
+  // Move an active session into hibernated_ (mutex held).
+  void hibernate_locked(SessionMap::iterator it);
+
+  // Make a hibernated session active again (mutex held).
+  ClientSession* resume_locked(std::uint64_t session_id, const transport::TransportSessionConfig& config);
+
+  // Remove a hibernated session, its index entries and its key material
+  // (mutex held).
+  void erase_hibernated(HibernatedMap::iterator it);
+
   // Allocate an IP from the pool.
   std::optional<std::string> allocate_ip();
 
   // Release an IP back to the pool.
   void release_ip(const std::string& ip);
 
+  // Route a session's tunnel IP and its client routes to it, replacing its
+  // previous routes (mutex held).
+  void assign_routes(std::uint64_t session_id, const std::string& tunnel_ip);
+
+  // Give a session a new tunnel IP (mutex held).
+  void move_tunnel_ip(ClientSession& session, const std::string& new_ip);
+
   // Generate unique session ID.
   std::uint64_t generate_session_id();
 
+  // Drop a session's connection ID mapping if it still points at that session.
+  void erase_connection_index(const ClientSession& session);
+
   // Parse IP address to uint32.
   static std::uint32_t ip_to_uint(const std::string& ip);
 
@@ -155,13 +277,24 @@ class SessionTable {
   std::uint32_t ip_pool_end_;
 
   // Sessions indexed by ID.
-  std::unordered_map<std::uint64_t, std::unique_ptr<ClientSession>> sessions_;
+  SessionMap sessions_;
+
+  // Hibernated sessions indexed by ID. Their connection ID and routes stay
+  // in the indices below; the endpoint index holds active sessions only.
+  HibernatedMap hibernated_;
+  std::chrono::seconds hibernate_after_{0};
+
+  // Connection ID to session ID mapping.
+  std::unordered_map<std::uint64_t, std::uint64_t> connection_index_;
 
   // Endpoint to session ID mapping.
   std::unordered_map<std::string, std::uint64_t> endpoint_index_;
 
-  // Tunnel IP to session ID mapping.
-  std::unordered_map<std::string, std::uint64_t> ip_index_;
+  // Tunnel IPs and client routes to session ID (longest prefix match).
+  AllowedIps routes_;
+
+  // Client routes by tunnel IP.
+  std::unordered_map<std::string, std::vector<IpPrefix>> client_routes_;
 
   // Available IPs in the pool.
   std::vector<std::uint32_t> available_ips_;
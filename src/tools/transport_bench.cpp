@@ -6,6 +6,30 @@
 // Usage:
 //   veil-transport-bench --mode=server --port=12345
 //   veil-transport-bench --mode=client --host=127.0.0.1 --port=12345 --duration=10
+//   veil-transport-bench --mode=sim --duration=60 --rtt=80 --loss=1 --bandwidth=20
+//   veil-transport-bench --mode=loop --backend=io_uring --duration=5
+//   veil-transport-bench --mode=crypto
+//   veil-transport-bench --mode=frames
+//   veil-transport-bench --mode=routes
+//
+// The sim mode runs both endpoints in-process over a simulated link on a
+// virtual clock (see transport/sim/network_simulator.h), so results are
+// reproducible for a given --seed and long scenarios finish quickly.
+//
+// The loop mode measures the event loop itself: a sender thread floods a
+// socket on loopback, and the loop echoes every datagram to a sink socket.
+// It reports packets per second and packets per second per core of loop
+// thread CPU time, so the epoll and io_uring backends can be compared.
+//
+// The crypto mode times per-packet crypto primitives in ns/op, e.g. the
+// sequence number permutation against the older ChaCha20-based obfuscation.
+//
+// The frames mode compares the legacy and compact mux frame encodings: wire
+// bytes per packet and goodput (payload over IP datagram size) for a range of
+// small payloads such as VoIP, game and TCP ACK traffic.
+//
+// The routes mode times the server's allowed-IPs table (longest-prefix
+// match) with 100k IPv4 and IPv6 routes, in ns per lookup.
 //
 // Output:
 //   Throughput (Mbps), RTT (ms), Retransmit rate (%), Data sent/received (MB)
@@ -13,22 +37,32 @@
 
 #include <CLI/CLI.hpp>
 
+#include <algorithm>
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdint>
 #include <cstring>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <random>
+#include <span>
 #include <thread>
 #include <vector>
 
+#include "common/crypto/crypto_engine.h"
+#include "common/crypto/hardware_crypto.h"
 #include "common/crypto/random.h"
 #include "common/handshake/handshake_processor.h"
 #include "common/logging/logger.h"
 #include "common/utils/rate_limiter.h"
+#include "server/allowed_ips.h"
 #include "transport/event_loop/event_loop.h"
 #include "transport/session/transport_session.h"
+#include "transport/sim/network_simulator.h"
 #include "transport/udp_socket/udp_socket.h"
 
 namespace {
@@ -50,6 +84,19 @@ struct BenchConfig {
   std::size_t message_size{1000};
   int num_streams{1};
   bool verbose{false};
+  // Simulated link parameters (sim mode).
+  double sim_bandwidth_mbps{100.0};
+  double sim_rtt_ms{20.0};
+  double sim_jitter_ms{0.0};
+  double sim_loss_percent{0.0};
+  double sim_reorder_percent{0.0};
+  double sim_rate_mbps{0.0};
+  std::uint64_t sim_seed{1};
+  bool sim_fec{false};
+  double sim_interactive_kbps{0.0};
+  bool sim_priority{false};
+  // Event loop backend (loop mode).
+  std::string backend{"epoll"};
 };
 
 // Benchmark results.
@@ -142,17 +189,9 @@ int run_server(const BenchConfig& config) {
               results.bytes_received += pkt.data.size();
               ++results.packets_received;
 
-              // Generate ACK periodically.
-              for (const auto& frame : *frames) {
-                if (frame.kind == mux::FrameKind::kData) {
-                  auto ack = session->generate_ack(frame.data.stream_id);
-                  auto ack_frame = mux::make_ack_frame(ack.stream_id, ack.ack, ack.bitmap);
-                  auto ack_packets = session->encrypt_data(
-                      mux::MuxCodec::encode(ack_frame), 0, false);
-                  for (const auto& ack_pkt : ack_packets) {
-                    socket.send(ack_pkt, client_endpoint, ec);
-                  }
-                }
+              // Acknowledge as the tunnel does; the sink sends no data to carry ACKs.
+              if (auto ack = session->take_ack_packet(true)) {
+                socket.send(*ack, client_endpoint, ec);
               }
             }
           }
@@ -327,6 +366,301 @@ int run_client(const BenchConfig& config) {
   return 0;
 }
 
+void print_direction(const char* name, const transport::sim::DirectionReport& report) {
+  auto ms = [](std::chrono::microseconds us) { return static_cast<double>(us.count()) / 1000.0; };
+  std::cout << name << '\n';
+  std::cout << "  Messages:         " << report.messages_delivered << " / " << report.messages_sent
+            << " delivered\n";
+  std::cout << "  Goodput:          " << (report.goodput_bps / 1000000.0) << " Mbps\n";
+  std::cout << "  Data packets:     " << report.data_packets_sent << '\n';
+  std::cout << "  Retransmits:      " << report.retransmits << " (" << (report.retransmit_ratio * 100.0)
+            << " %)\n";
+  std::cout << "  ACKs:             " << report.acks_sent << " (+" << report.acks_piggybacked << " piggybacked)\n";
+  if (report.fec_repairs_sent > 0) {
+    std::cout << "  FEC repairs:      " << report.fec_repairs_sent << " (" << report.fec_recovered
+              << " packets recovered)\n";
+  }
+  std::cout << "  Link drops:       " << report.link.dropped_loss << " loss, " << report.link.dropped_queue
+            << " queue\n";
+  std::cout << "  Latency p50/p90/p99/max: " << ms(report.latency_p50) << " / " << ms(report.latency_p90)
+            << " / " << ms(report.latency_p99) << " / " << ms(report.latency_max) << " ms\n";
+  if (report.interactive_messages_sent > 0) {
+    std::cout << "  Interactive:      " << report.interactive_messages_delivered << " / "
+              << report.interactive_messages_sent << " delivered, p50/p99/max "
+              << ms(report.interactive_latency_p50) << " / " << ms(report.interactive_latency_p99) << " / "
+              << ms(report.interactive_latency_max) << " ms\n";
+  }
+}
+
+// Run both endpoints over a simulated link.
+int run_sim(const BenchConfig& config) {
+  transport::sim::SimulationConfig sim;
+  transport::sim::LinkConfig link;
+  link.bandwidth_bps = static_cast<std::uint64_t>(config.sim_bandwidth_mbps * 1000000.0);
+  link.delay = std::chrono::microseconds(static_cast<std::int64_t>(config.sim_rtt_ms * 500.0));
+  link.jitter = std::chrono::microseconds(static_cast<std::int64_t>(config.sim_jitter_ms * 1000.0));
+  link.loss_rate = config.sim_loss_percent / 100.0;
+  link.reorder_rate = config.sim_reorder_percent / 100.0;
+  sim.client_to_server_link = link;
+  sim.server_to_client_link = link;
+  sim.client_traffic.message_size = config.message_size;
+  sim.client_traffic.offered_rate_bps = static_cast<std::uint64_t>(config.sim_rate_mbps * 1000000.0);
+  sim.duration = std::chrono::seconds(config.duration_sec);
+  sim.seed = config.sim_seed;
+  sim.fec = config.sim_fec;
+  if (config.sim_interactive_kbps > 0.0) {
+    sim.client_interactive_traffic.message_size = 200;
+    sim.client_interactive_traffic.offered_rate_bps =
+        static_cast<std::uint64_t>(config.sim_interactive_kbps * 1000.0);
+  }
+  sim.priority_scheduling = config.sim_priority;
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  transport::sim::NetworkSimulation simulation(sim);
+  const auto report = simulation.run();
+  const auto wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start);
+
+  std::cout << "\n=== VEIL Transport Simulation Results ===\n";
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Simulated time:   " << (static_cast<double>(report.simulated_time.count()) / 1000000.0)
+            << " sec (" << wall_ms.count() << " ms wall)\n";
+  print_direction("Client -> server", report.client_to_server);
+  std::cout << "========================================\n";
+  return 0;
+}
+
+double thread_cpu_seconds() {
+  timespec ts{};
+  ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+// Measure event loop packet rate and CPU cost for one backend.
+int run_loop(const BenchConfig& config) {
+  transport::UdpSocket receiver;
+  transport::UdpSocket sender;
+  transport::UdpSocket sink;
+  std::error_code ec;
+  if (!receiver.open(0, false, ec) || !sender.open(0, false, ec) || !sink.open(0, false, ec)) {
+    std::cerr << "Failed to open sockets: " << ec.message() << '\n';
+    return 1;
+  }
+  const transport::UdpEndpoint receiver_ep{"127.0.0.1", receiver.local_port()};
+  const transport::UdpEndpoint sink_ep{"127.0.0.1", sink.local_port()};
+
+  transport::EventLoopConfig loop_config;
+  loop_config.backend = *transport::parse_event_loop_backend(config.backend);
+  transport::EventLoop loop(loop_config);
+
+  std::uint64_t received = 0;
+  std::uint64_t echo_failures = 0;
+  loop.add_socket(&receiver, 1, sink_ep,
+                  [&](transport::SessionId, std::span<const std::uint8_t> data, const transport::UdpEndpoint&) {
+                    ++received;
+                    if (!loop.send_packet(receiver.fd(), data, sink_ep)) {
+                      ++echo_failures;
+                    }
+                  });
+
+  // Warm up for a quarter second, then measure.
+  std::uint64_t start_received = 0;
+  double start_cpu = 0.0;
+  double cpu_seconds = 0.0;
+  std::chrono::steady_clock::time_point start_time;
+  std::chrono::steady_clock::time_point end_time;
+  loop.schedule_timer(250ms, [&](utils::TimerId) {
+    start_received = received;
+    start_cpu = thread_cpu_seconds();
+    start_time = std::chrono::steady_clock::now();
+    loop.schedule_timer(std::chrono::seconds(config.duration_sec), [&](utils::TimerId) {
+      cpu_seconds = thread_cpu_seconds() - start_cpu;
+      end_time = std::chrono::steady_clock::now();
+      loop.stop();
+    });
+  });
+
+  std::atomic<bool> sending{true};
+  std::thread flood([&]() {
+    std::vector<transport::UdpPacket> batch(32, transport::UdpPacket{
+                                                    std::vector<std::uint8_t>(config.message_size, 0xAB),
+                                                    receiver_ep});
+    std::error_code send_ec;
+    while (sending.load(std::memory_order_relaxed) && g_running.load()) {
+      sender.send_batch(batch, send_ec);
+    }
+  });
+
+  loop.run();
+  sending.store(false);
+  flood.join();
+
+  const double seconds = std::chrono::duration<double>(end_time - start_time).count();
+  const auto measured = received - start_received;
+  const double pps = seconds > 0.0 ? static_cast<double>(measured) / seconds : 0.0;
+
+  std::cout << "\n=== VEIL Event Loop Benchmark ===\n";
+  std::cout << std::fixed << std::setprecision(2);
+  std::cout << "Backend:          " << transport::event_loop_backend_name(loop.backend()) << '\n';
+  std::cout << "Message size:     " << config.message_size << " bytes\n";
+  std::cout << "Duration:         " << seconds << " sec\n";
+  std::cout << "Packets received: " << measured << '\n';
+  std::cout << "Echo failures:    " << echo_failures << '\n';
+  std::cout << "Packets/sec:      " << pps << '\n';
+  std::cout << "Loop CPU:         " << cpu_seconds << " sec (" << (seconds > 0.0 ? cpu_seconds / seconds * 100.0 : 0.0)
+            << " %)\n";
+  std::cout << "Packets/sec/core: " << (cpu_seconds > 0.0 ? static_cast<double>(measured) / cpu_seconds : 0.0)
+            << '\n';
+  std::cout << "================================\n";
+  return 0;
+}
+
+volatile std::uint64_t g_bench_sink = 0;
+
+// Time one per-packet primitive; returns nanoseconds per call.
+template <typename Fn>
+double time_ns_per_op(std::uint64_t iterations, Fn&& fn) {
+  std::uint64_t sink = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (std::uint64_t i = 0; i < iterations; ++i) {
+    sink += fn(i);
+  }
+  const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+  // Keep the result observable so the loop is not optimized away.
+  g_bench_sink = sink;
+  return elapsed.count() / static_cast<double>(iterations);
+}
+
+// Measure per-packet crypto primitives.
+int run_crypto(const BenchConfig& /*config*/) {
+  constexpr std::uint64_t kIterations = 2'000'000;
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  const auto random_key = crypto::random_bytes(key.size());
+  std::copy(random_key.begin(), random_key.end(), key.begin());
+
+  const crypto::SequenceObfuscator hardware(key, true);
+  const crypto::SequenceObfuscator portable(key, false);
+
+  std::cout << "\n=== VEIL Crypto Benchmark (ns/op) ===\n";
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "Sequence obfuscation, ChaCha20 Feistel: "
+            << time_ns_per_op(kIterations, [&](std::uint64_t i) { return crypto::obfuscate_sequence(i, key); })
+            << '\n';
+  std::cout << "Sequence permutation, portable:         "
+            << time_ns_per_op(kIterations, [&](std::uint64_t i) { return portable.obfuscate(i); }) << '\n';
+  if (hardware.uses_hardware()) {
+    std::cout << "Sequence permutation, AES-NI:           "
+              << time_ns_per_op(kIterations, [&](std::uint64_t i) { return hardware.obfuscate(i); }) << '\n';
+    std::cout << "Sequence permutation, AES-NI inverse:   "
+              << time_ns_per_op(kIterations, [&](std::uint64_t i) { return hardware.deobfuscate(i); }) << '\n';
+  } else {
+    std::cout << "Sequence permutation, AES-NI:           n/a (no AES-NI)\n";
+  }
+  std::cout << "=====================================\n";
+  return 0;
+}
+
+// Client-side session from a handshake with or without compact frames.
+std::optional<transport::TransportSession> make_bench_session(bool compact) {
+  auto now_fn = []() { return std::chrono::system_clock::now(); };
+  auto steady_fn = []() { return std::chrono::steady_clock::now(); };
+  utils::TokenBucket bucket(1000.0, 100ms, steady_fn);
+  handshake::HandshakeInitiator initiator(get_bench_psk(), 200ms, now_fn);
+  handshake::HandshakeResponder responder(get_bench_psk(), 200ms, std::move(bucket), now_fn);
+  initiator.set_compact_frames(compact);
+  auto resp = responder.handle_init(initiator.create_init());
+  if (!resp) {
+    return std::nullopt;
+  }
+  auto session = initiator.consume_response(resp->response);
+  if (!session) {
+    return std::nullopt;
+  }
+  std::optional<transport::TransportSession> result;
+  result.emplace(*session, transport::TransportSessionConfig{}, steady_fn);
+  return result;
+}
+
+// Compare per-packet overhead of the legacy and compact frame encodings.
+int run_frames(const BenchConfig& /*config*/) {
+  constexpr std::size_t kIpUdpHeaderSize = 20 + 8;
+  constexpr int kPackets = 1000;
+  constexpr std::array<std::size_t, 6> kPayloadSizes{40, 64, 100, 160, 512, 1200};
+  auto legacy = make_bench_session(false);
+  auto compact = make_bench_session(true);
+  if (!legacy || !compact) {
+    std::cerr << "Handshake failed\n";
+    return 1;
+  }
+
+  std::cout << "\n=== VEIL Frame Overhead (IPv4, per packet) ===\n";
+  std::cout << "payload  legacy  compact  goodput legacy  goodput compact  gain\n";
+  std::cout << std::fixed << std::setprecision(1);
+  for (const std::size_t payload_size : kPayloadSizes) {
+    const std::vector<std::uint8_t> payload(payload_size, 0x5A);
+    std::size_t legacy_bytes = 0;
+    std::size_t compact_bytes = 0;
+    for (int i = 0; i < kPackets; ++i) {
+      legacy_bytes += legacy->encrypt_data(payload, 0, false)[0].size() + kIpUdpHeaderSize;
+      compact_bytes += compact->encrypt_data(payload, 0, false)[0].size() + kIpUdpHeaderSize;
+    }
+    const double legacy_goodput =
+        100.0 * static_cast<double>(payload_size * kPackets) / static_cast<double>(legacy_bytes);
+    const double compact_goodput =
+        100.0 * static_cast<double>(payload_size * kPackets) / static_cast<double>(compact_bytes);
+    std::cout << std::setw(7) << payload_size << std::setw(8)
+              << static_cast<double>(legacy_bytes) / kPackets << std::setw(9)
+              << static_cast<double>(compact_bytes) / kPackets << std::setw(15) << legacy_goodput << '%'
+              << std::setw(16) << compact_goodput << '%' << std::setw(6)
+              << 100.0 * (compact_goodput / legacy_goodput - 1.0) << "%\n";
+  }
+  std::cout << "==============================================\n";
+  return 0;
+}
+
+// Time longest-prefix-match lookups in a server routing table of 100k routes.
+int run_routes(const BenchConfig& /*config*/) {
+  constexpr std::size_t kRoutes = 100'000;
+  constexpr std::size_t kProbes = 1 << 16;
+  constexpr std::uint64_t kIterations = 5'000'000;
+  std::mt19937_64 rng(1);
+
+  // Routes of random lengths under 10.0.0.0/8 and fd00::/8, so the tries
+  // have deep shared paths; probes are addresses inside them.
+  server::AllowedIps table;
+  std::vector<std::array<std::uint8_t, 4>> v4_probes;
+  std::vector<std::array<std::uint8_t, 16>> v6_probes;
+  for (std::size_t i = 0; i < kRoutes; ++i) {
+    const bool v6 = i % 2 == 1;
+    std::array<std::uint8_t, 16> address{};
+    address[0] = v6 ? 0xFD : 10;
+    for (std::size_t byte = 1; byte < (v6 ? 16U : 4U); ++byte) {
+      address[byte] = static_cast<std::uint8_t>(rng());
+    }
+    auto route = *server::IpPrefix::host(std::span<const std::uint8_t>(address.data(), v6 ? 16 : 4));
+    route.length = static_cast<std::uint8_t>(v6 ? 32 + rng() % 97 : 16 + rng() % 17);
+    table.insert(route, 1 + i % 10'000);
+    if (v6 && v6_probes.size() < kProbes) {
+      v6_probes.push_back(address);
+    } else if (!v6 && v4_probes.size() < kProbes) {
+      std::array<std::uint8_t, 4> v4{};
+      std::copy_n(address.begin(), 4, v4.begin());
+      v4_probes.push_back(v4);
+    }
+  }
+
+  std::cout << "\n=== VEIL Route Lookup Benchmark (ns/op) ===\n";
+  std::cout << "Routes: " << table.size() << '\n';
+  std::cout << std::fixed << std::setprecision(1);
+  std::cout << "IPv4 longest prefix match: " << time_ns_per_op(kIterations, [&](std::uint64_t i) {
+    return table.lookup(server::IpFamily::kV4, v4_probes[i % v4_probes.size()]).value_or(0);
+  }) << '\n';
+  std::cout << "IPv6 longest prefix match: " << time_ns_per_op(kIterations, [&](std::uint64_t i) {
+    return table.lookup(server::IpFamily::kV6, v6_probes[i % v6_probes.size()]).value_or(0);
+  }) << '\n';
+  std::cout << "==========================================\n";
+  return 0;
+}
+
 }  // namespace
 
 int main(int argc, char** argv) {
@@ -335,14 +669,27 @@ int main(int argc, char** argv) {
 
     BenchConfig config;
 
-    app.add_option("--mode,-m", config.mode, "Mode: server or client")
-        ->check(CLI::IsMember({"server", "client"}));
+    app.add_option("--mode,-m", config.mode, "Mode: server, client, sim, loop, crypto, frames or routes")
+        ->check(CLI::IsMember({"server", "client", "sim", "loop", "crypto", "frames", "routes"}));
     app.add_option("--host,-H", config.host, "Server host (client mode)");
     app.add_option("--port,-p", config.port, "Port number");
     app.add_option("--duration,-d", config.duration_sec, "Test duration in seconds (client mode)");
     app.add_option("--size,-s", config.message_size, "Message size in bytes");
     app.add_option("--streams,-n", config.num_streams, "Number of streams");
     app.add_flag("--verbose,-v", config.verbose, "Verbose output");
+    app.add_option("--bandwidth", config.sim_bandwidth_mbps, "Simulated link bandwidth in Mbps (sim mode)");
+    app.add_option("--rtt", config.sim_rtt_ms, "Simulated round-trip time in ms (sim mode)");
+    app.add_option("--jitter", config.sim_jitter_ms, "Simulated per-packet jitter in ms (sim mode)");
+    app.add_option("--loss", config.sim_loss_percent, "Simulated loss in percent (sim mode)");
+    app.add_option("--reorder", config.sim_reorder_percent, "Simulated reordering in percent (sim mode)");
+    app.add_option("--rate", config.sim_rate_mbps, "Offered load in Mbps, 0 = saturate (sim mode)");
+    app.add_option("--seed", config.sim_seed, "Random seed (sim mode)");
+    app.add_flag("--fec", config.sim_fec, "Forward error correction (sim mode)");
+    app.add_option("--interactive-kbps", config.sim_interactive_kbps,
+                   "Extra stream of 200-byte interactive messages in kbps (sim mode)");
+    app.add_flag("--priority", config.sim_priority, "Send interactive messages first (sim mode)");
+    app.add_option("--backend", config.backend, "Event loop backend (loop mode)")
+        ->check(CLI::IsMember({"epoll", "io_uring", "auto"}));
 
     CLI11_PARSE(app, argc, argv);
 
@@ -357,6 +704,21 @@ int main(int argc, char** argv) {
     if (config.mode == "server") {
       return run_server(config);
     }
+    if (config.mode == "sim") {
+      return run_sim(config);
+    }
+    if (config.mode == "loop") {
+      return run_loop(config);
+    }
+    if (config.mode == "crypto") {
+      return run_crypto(config);
+    }
+    if (config.mode == "frames") {
+      return run_frames(config);
+    }
+    if (config.mode == "routes") {
+      return run_routes(config);
+    }
     return run_client(config);
   } catch (const std::exception& e) {
     std::cerr << "Error: " << e.what() << '\n';
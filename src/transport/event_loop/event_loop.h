@@ -2,12 +2,15 @@
 
 #include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <span>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/utils/thread_checker.h"
@@ -18,6 +21,9 @@ namespace veil::transport {
 
 // Forward declarations.
 class TransportSession;
+#ifndef _WIN32
+class IoUringBackend;
+#endif
 
 // Session identifier type.
 using SessionId = std::uint64_t;
@@ -26,13 +32,52 @@ using SessionId = std::uint64_t;
 using PacketHandler = std::function<void(SessionId, std::span<const std::uint8_t>, const UdpEndpoint&)>;
 using TimerHandler = std::function<void(SessionId)>;
 using ErrorHandler = std::function<void(SessionId, std::error_code)>;
+// Called when a raw descriptor registered with add_fd() becomes readable.
+// The handler must read until the descriptor would block.
+using ReadableHandler = std::function<void()>;
+
+// I/O multiplexing backend.
+enum class EventLoopBackend {
+  kEpoll,    // Readiness (epoll on Linux, select on Windows).
+  kIoUring,  // Completion-based io_uring (Linux 6.0+); falls back to kEpoll.
+  kAuto,     // io_uring when the kernel supports it, otherwise kEpoll.
+};
+
+// Parse "epoll", "io_uring" or "auto".
+inline std::optional<EventLoopBackend> parse_event_loop_backend(std::string_view name) {
+  if (name == "epoll") return EventLoopBackend::kEpoll;
+  if (name == "io_uring") return EventLoopBackend::kIoUring;
+  if (name == "auto") return EventLoopBackend::kAuto;
+  return std::nullopt;
+}
+
+inline std::string_view event_loop_backend_name(EventLoopBackend backend) {
+  switch (backend) {
+    case EventLoopBackend::kEpoll:
+      return "epoll";
+    case EventLoopBackend::kIoUring:
+      return "io_uring";
+    case EventLoopBackend::kAuto:
+      return "auto";
+  }
+  return "unknown";
+}
 
 // Configuration for the event loop.
 struct EventLoopConfig {
-  // Poll timeout in milliseconds per iteration.
+  // Requested backend. The one actually in use is EventLoop::backend().
+  EventLoopBackend backend{EventLoopBackend::kEpoll};
+  // io_uring sizing (ignored by the epoll backend): submission queue entries,
+  // and the number and size of receive buffers registered with the kernel.
+  unsigned io_uring_entries{256};
+  std::size_t io_uring_recv_buffers{512};
+  std::size_t io_uring_recv_buffer_size{2048};
+  // Upper bound on one wait, in milliseconds. The loop also wakes for I/O,
+  // for the next timer and for stop(), so this only bounds how often an
+  // otherwise idle loop spins.
   // On Linux: used for epoll_wait timeout.
   // On Windows: used for select timeout.
-  int epoll_timeout_ms{10};
+  int epoll_timeout_ms{1000};
   // Maximum events to process per poll iteration.
   // On Linux: max events from epoll_wait.
   // On Windows: not used directly (select processes all ready sockets).
@@ -75,18 +120,27 @@ struct SocketInfo {
  *
  * Platform Support:
  *   - Linux: Uses epoll for efficient I/O multiplexing.
+ *   - Linux, io_uring backend: multishot receive into kernel-selected buffers
+ *     and batched send/write submission (see IoUringBackend). Chosen with
+ *     EventLoopConfig::backend; falls back to epoll when unavailable.
  *   - Windows: Uses select for I/O multiplexing.
  *
+ * Besides UDP sockets, arbitrary readable descriptors (e.g. a TUN device) can
+ * be registered with add_fd(), so a single wait covers every input and the
+ * next timer deadline.
+ *
  * Thread Safety:
  *   This class is designed for single-threaded operation. All methods except
  *   stop() and is_running() must be called from the thread that calls run().
  *   The stop() method is safe to call from any thread (uses atomic flag).
  *
  *   - add_socket(), remove_socket(): Must be called from event loop thread
+ *   - add_fd(), remove_fd(): Must be called from event loop thread
  *   - send_packet(): Must be called from event loop thread
  *   - schedule_timer(), cancel_timer(): Must be called from event loop thread
  *   - run(): Blocking; establishes the "event loop thread"
- *   - stop(): Thread-safe (can be called from any thread, e.g., signal handler)
+ *   - stop(): Thread-safe (can be called from any thread, e.g., signal handler);
+ *     wakes a blocked run() immediately
  *   - is_running(): Thread-safe (atomic read)
  *
  * @see docs/thread_model.md for the VEIL threading model documentation.
@@ -115,9 +169,26 @@ class EventLoop {
   // Remove a socket from the event loop.
   bool remove_socket(int fd);
 
+  // Register a non-blocking descriptor for readability (level-triggered).
+  // On Windows only sockets can be registered.
+  bool add_fd(int fd, ReadableHandler on_readable);
+
+  // Remove a descriptor registered with add_fd().
+  bool remove_fd(int fd);
+
+  // Called once per loop iteration, after the ready I/O has been dispatched
+  // and before timers run, so callers can act on a whole receive burst at
+  // once (e.g. send one ACK for it).
+  void set_iteration_handler(std::function<void()> handler) { iteration_handler_ = std::move(handler); }
+
   // Queue packet for sending (handles EAGAIN/EWOULDBLOCK).
   bool send_packet(int fd, std::span<const std::uint8_t> data, const UdpEndpoint& remote);
 
+  // Write to a non-blocking descriptor (e.g. a TUN device). With io_uring the
+  // data is copied and the write is submitted with the next wait; otherwise it
+  // is written immediately. Returns false if the write failed or was dropped.
+  bool write_fd(int fd, std::span<const std::uint8_t> data);
+
   // Schedule a one-shot timer.
   utils::TimerId schedule_timer(std::chrono::steady_clock::duration after, utils::TimerCallback callback);
 
@@ -139,10 +210,18 @@ class EventLoop {
   // Get the number of registered sockets.
   std::size_t socket_count() const { return sockets_.size(); }
 
+  // Backend in use (kEpoll or kIoUring; never kAuto). The Windows select()
+  // loop reports kEpoll.
+  EventLoopBackend backend() const;
+
  private:
   void handle_read(int fd);
   void handle_write(int fd);
   void handle_timers();
+  int wait_timeout_ms();
+#ifndef _WIN32
+  void run_io_uring();
+#endif
   void setup_session_timers(SocketInfo& info);
   void cleanup_session_timers(SocketInfo& info);
 
@@ -155,6 +234,14 @@ class EventLoop {
   std::atomic<bool> running_{false};
   utils::TimerHeap timer_heap_;
   std::unordered_map<int, SocketInfo> sockets_;
+  std::unordered_map<int, ReadableHandler> fd_handlers_;
+  std::function<void()> iteration_handler_;
+  // Linux: eventfd registered in the epoll set so stop() can interrupt a wait.
+  int wake_fd_{-1};
+#ifndef _WIN32
+  // Set when the io_uring backend is active.
+  std::unique_ptr<IoUringBackend> io_uring_;
+#endif
 
   // Thread safety: verifies single-threaded access in debug builds.
   // Bound to the thread that calls run().
@@ -5,18 +5,23 @@
 
 #include "transport/event_loop/event_loop.h"
 
+#include <arpa/inet.h>
 #include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <system_error>
 #include <utility>
 #include <vector>
 
 #include "common/logging/logger.h"
+#include "transport/event_loop/io_uring_backend.h"
 
 namespace veil::transport {
 
@@ -25,11 +30,49 @@ EventLoop::EventLoop(EventLoopConfig config, std::function<TimePoint()> now_fn)
   epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
   if (epoll_fd_ < 0) {
     LOG_ERROR("Failed to create epoll fd: {}", std::error_code(errno, std::generic_category()).message());
+    return;
+  }
+
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
+    LOG_WARN("Failed to create wake eventfd, stop() latency bounded by poll timeout: {}",
+             std::error_code(errno, std::generic_category()).message());
+    return;
+  }
+  epoll_event ev{};
+  ev.events = EPOLLIN;
+  ev.data.fd = wake_fd_;
+  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) != 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
+
+  if (config_.backend != EventLoopBackend::kEpoll) {
+    IoUringConfig uring_config;
+    uring_config.entries = config_.io_uring_entries;
+    uring_config.recv_buffer_count = config_.io_uring_recv_buffers;
+    uring_config.recv_buffer_size = config_.io_uring_recv_buffer_size;
+    std::error_code ec;
+    io_uring_ = IoUringBackend::create(uring_config, ec);
+    if (!io_uring_) {
+      if (config_.backend == EventLoopBackend::kIoUring) {
+        LOG_WARN("io_uring unavailable ({}), falling back to epoll", ec.message());
+      } else {
+        LOG_DEBUG("io_uring unavailable ({}), using epoll", ec.message());
+      }
+    } else if (wake_fd_ >= 0) {
+      io_uring_->watch_readable(wake_fd_);
+    }
   }
 }
 
 EventLoop::~EventLoop() {
   stop();
+  io_uring_.reset();
+  if (wake_fd_ >= 0) {
+    ::close(wake_fd_);
+    wake_fd_ = -1;
+  }
   if (epoll_fd_ >= 0) {
     ::close(epoll_fd_);
     epoll_fd_ = -1;
@@ -57,14 +100,25 @@ bool EventLoop::add_socket(UdpSocket* socket, SessionId session_id, const UdpEnd
     return false;
   }
 
-  // Add to epoll (level-triggered for reads, edge-triggered for writes).
-  epoll_event ev{};
-  ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
-  ev.data.fd = fd;
-  if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
-    LOG_ERROR("epoll_ctl ADD failed for fd={}: {}", fd,
-              std::error_code(errno, std::generic_category()).message());
-    return false;
+  if (io_uring_) {
+    // Completion-based: a multishot receive delivers datagrams, and sends are
+    // queued in the ring through the socket's send hook.
+    if (!io_uring_->watch_datagrams(fd)) {
+      return false;
+    }
+    socket->set_send_hook([this, fd](std::span<const std::uint8_t> data, const sockaddr_in& to) {
+      return io_uring_->queue_send(fd, data, to);
+    });
+  } else {
+    // Add to epoll (edge-triggered; reads drain the socket).
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      LOG_ERROR("epoll_ctl ADD failed for fd={}: {}", fd,
+                std::error_code(errno, std::generic_category()).message());
+      return false;
+    }
   }
 
   // Create socket info.
@@ -100,8 +154,10 @@ bool EventLoop::remove_socket(int fd) {
   // Cleanup timers.
   cleanup_session_timers(it->second);
 
-  // Remove from epoll.
-  if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) != 0) {
+  if (io_uring_) {
+    io_uring_->unwatch(fd);
+    it->second.socket->set_send_hook({});
+  } else if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) != 0) {
     LOG_WARN("epoll_ctl DEL failed for fd={}: {}", fd,
              std::error_code(errno, std::generic_category()).message());
   }
@@ -111,6 +167,55 @@ bool EventLoop::remove_socket(int fd) {
   return true;
 }
 
+bool EventLoop::add_fd(int fd, ReadableHandler on_readable) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (fd < 0 || epoll_fd_ < 0 || !on_readable) {
+    return false;
+  }
+  if (fd_handlers_.find(fd) != fd_handlers_.end() || sockets_.find(fd) != sockets_.end()) {
+    LOG_WARN("fd={} already registered", fd);
+    return false;
+  }
+
+  if (io_uring_) {
+    if (!io_uring_->watch_readable(fd)) {
+      return false;
+    }
+  } else {
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+      LOG_ERROR("epoll_ctl ADD failed for fd={}: {}", fd,
+                std::error_code(errno, std::generic_category()).message());
+      return false;
+    }
+  }
+
+  fd_handlers_[fd] = std::move(on_readable);
+  LOG_DEBUG("Added fd={}", fd);
+  return true;
+}
+
+bool EventLoop::remove_fd(int fd) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  auto it = fd_handlers_.find(fd);
+  if (it == fd_handlers_.end()) {
+    return false;
+  }
+  if (io_uring_) {
+    io_uring_->unwatch(fd);
+  } else if (epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr) != 0) {
+    LOG_WARN("epoll_ctl DEL failed for fd={}: {}", fd,
+             std::error_code(errno, std::generic_category()).message());
+  }
+  fd_handlers_.erase(it);
+  LOG_DEBUG("Removed fd={}", fd);
+  return true;
+}
+
 bool EventLoop::send_packet(int fd, std::span<const std::uint8_t> data, const UdpEndpoint& remote) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
@@ -145,6 +250,20 @@ bool EventLoop::send_packet(int fd, std::span<const std::uint8_t> data, const Ud
   return true;
 }
 
+bool EventLoop::write_fd(int fd, std::span<const std::uint8_t> data) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  if (io_uring_ && io_uring_->queue_write(fd, data)) {
+    return true;
+  }
+  const auto written = ::write(fd, data.data(), data.size());
+  return written >= 0 && static_cast<std::size_t>(written) == data.size();
+}
+
+EventLoopBackend EventLoop::backend() const {
+  return io_uring_ ? EventLoopBackend::kIoUring : EventLoopBackend::kEpoll;
+}
+
 utils::TimerId EventLoop::schedule_timer(std::chrono::steady_clock::duration after,
                                          utils::TimerCallback callback) {
   VEIL_DCHECK_THREAD(thread_checker_);
@@ -184,21 +303,16 @@ void EventLoop::run() {
   VEIL_THREAD_REBIND(thread_checker_);
 
   running_.store(true);
+  if (io_uring_) {
+    run_io_uring();
+    return;
+  }
   LOG_INFO("Event loop started");
 
   std::vector<epoll_event> events(static_cast<std::size_t>(config_.max_events));
 
   while (running_.load()) {
-    // Calculate timeout based on next timer.
-    int timeout_ms = config_.epoll_timeout_ms;
-    auto next_timer = timer_heap_.time_until_next();
-    if (next_timer) {
-      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(*next_timer).count();
-      if (ms < 0) ms = 0;
-      timeout_ms = std::min(timeout_ms, static_cast<int>(ms));
-    }
-
-    const int n = epoll_wait(epoll_fd_, events.data(), config_.max_events, timeout_ms);
+    const int n = epoll_wait(epoll_fd_, events.data(), config_.max_events, wait_timeout_ms());
     if (n < 0) {
       if (errno == EINTR) {
         continue;
@@ -212,6 +326,18 @@ void EventLoop::run() {
       const auto& ev = events[static_cast<std::size_t>(i)];
       const int fd = ev.data.fd;
 
+      if (fd == wake_fd_) {
+        std::uint64_t value = 0;
+        [[maybe_unused]] const auto drained = ::read(wake_fd_, &value, sizeof(value));
+        continue;
+      }
+      if (auto handler = fd_handlers_.find(fd); handler != fd_handlers_.end()) {
+        // Copy: the handler may remove itself.
+        auto on_readable = handler->second;
+        on_readable();
+        continue;
+      }
+
       if ((ev.events & EPOLLIN) != 0U) {
         handle_read(fd);
       }
@@ -226,6 +352,9 @@ void EventLoop::run() {
         }
       }
     }
+    if (iteration_handler_) {
+      iteration_handler_();
+    }
 
     // Process expired timers.
     handle_timers();
@@ -234,35 +363,107 @@ void EventLoop::run() {
   LOG_INFO("Event loop stopped");
 }
 
-void EventLoop::stop() { running_.store(false); }
+void EventLoop::run_io_uring() {
+  LOG_INFO("Event loop started (io_uring)");
 
-void EventLoop::handle_read(int fd) {
-  auto it = sockets_.find(fd);
-  if (it == sockets_.end()) {
-    return;
+  IoUringBackend::Handlers handlers;
+  handlers.on_datagram = [this](int fd, std::span<const std::uint8_t> data, const sockaddr_in& from) {
+    auto it = sockets_.find(fd);
+    if (it == sockets_.end()) {
+      return;
+    }
+    std::array<char, INET_ADDRSTRLEN> host{};
+    UdpEndpoint remote;
+    remote.host = ::inet_ntop(AF_INET, &from.sin_addr, host.data(), host.size()) != nullptr ? host.data() : "";
+    remote.port = ntohs(from.sin_port);
+
+    auto& info = it->second;
+    info.last_activity = now_fn_();
+    if (info.on_packet) {
+      info.on_packet(info.session_id, data, remote);
+    }
+  };
+  handlers.on_readable = [this](int fd) {
+    if (fd == wake_fd_) {
+      std::uint64_t value = 0;
+      [[maybe_unused]] const auto drained = ::read(wake_fd_, &value, sizeof(value));
+      return;
+    }
+    if (auto handler = fd_handlers_.find(fd); handler != fd_handlers_.end()) {
+      // Copy: the handler may remove itself.
+      auto on_readable = handler->second;
+      on_readable();
+    }
+  };
+  handlers.on_send_error = [this](int fd, std::error_code ec) {
+    auto it = sockets_.find(fd);
+    if (it != sockets_.end() && it->second.on_error) {
+      it->second.on_error(it->second.session_id, ec);
+    } else {
+      LOG_DEBUG("Write failed for fd={}: {}", fd, ec.message());
+    }
+  };
+
+  while (running_.load()) {
+    std::error_code ec;
+    if (!io_uring_->run_once(wait_timeout_ms(), handlers, ec)) {
+      LOG_ERROR("io_uring wait failed: {}", ec.message());
+      break;
+    }
+    if (iteration_handler_) {
+      iteration_handler_();
+    }
+    handle_timers();
   }
 
-  auto& info = it->second;
+  LOG_INFO("Event loop stopped");
+}
 
-  // Read packets in a loop (edge-triggered, must drain).
-  while (true) {
-    std::error_code ec;
-    bool got_packet = false;
+void EventLoop::stop() {
+  running_.store(false);
+  if (wake_fd_ >= 0) {
+    const std::uint64_t one = 1;
+    [[maybe_unused]] const auto written = ::write(wake_fd_, &one, sizeof(one));
+  }
+}
 
-    info.socket->poll(
-        [&](const UdpPacket& pkt) {
-          got_packet = true;
-          info.last_activity = now_fn_();
+int EventLoop::wait_timeout_ms() {
+  int timeout_ms = config_.epoll_timeout_ms;
+  if (auto next_timer = timer_heap_.time_until_next()) {
+    // Round up so a timer due in under a millisecond does not turn into a
+    // run of zero-timeout waits.
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(*next_timer).count();
+    ms = std::clamp<decltype(ms)>(ms, 0, std::numeric_limits<int>::max());
+    timeout_ms = std::min(timeout_ms, static_cast<int>(ms));
+  }
+  return timeout_ms;
+}
 
-          if (info.on_packet) {
-            info.on_packet(info.session_id, pkt.data, pkt.remote);
-          }
-        },
-        0, ec);
+void EventLoop::handle_read(int fd) {
+  auto it = sockets_.find(fd);
+  if (it == sockets_.end()) {
+    return;
+  }
 
-    if (!got_packet) {
-      break;
-    }
+  // Edge-triggered: drain until the socket would block. The handler may
+  // remove the socket, so look it up again for every datagram.
+  UdpSocket* socket = it->second.socket;
+  std::error_code ec;
+  socket->drain(
+      [&](const UdpPacket& pkt) {
+        auto current = sockets_.find(fd);
+        if (current == sockets_.end() || current->second.socket != socket) {
+          return;
+        }
+        auto& info = current->second;
+        info.last_activity = now_fn_();
+        if (info.on_packet) {
+          info.on_packet(info.session_id, pkt.data, pkt.remote);
+        }
+      },
+      std::numeric_limits<std::size_t>::max(), ec);
+  if (ec) {
+    LOG_DEBUG("Receive failed for fd={}: {}", fd, ec.message());
   }
 }
 
@@ -11,6 +11,7 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <limits>
 #include <span>
 #include <system_error>
 #include <utility>
@@ -104,6 +105,33 @@ bool EventLoop::remove_socket(int fd) {
   return true;
 }
 
+bool EventLoop::add_fd(int fd, ReadableHandler on_readable) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  // select() only accepts sockets on Windows.
+  if (fd < 0 || !on_readable) {
+    return false;
+  }
+  if (fd_handlers_.find(fd) != fd_handlers_.end() || sockets_.find(fd) != sockets_.end()) {
+    LOG_WARN("fd={} already registered", fd);
+    return false;
+  }
+  fd_handlers_[fd] = std::move(on_readable);
+  return true;
+}
+
+bool EventLoop::remove_fd(int fd) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+  return fd_handlers_.erase(fd) > 0;
+}
+
+bool EventLoop::write_fd(int /*fd*/, std::span<const std::uint8_t> /*data*/) {
+  // Wintun has no descriptor to write to; callers use the adapter directly.
+  return false;
+}
+
+EventLoopBackend EventLoop::backend() const { return EventLoopBackend::kEpoll; }
+
 bool EventLoop::send_packet(int fd, std::span<const std::uint8_t> data, const UdpEndpoint& remote) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
@@ -175,14 +203,7 @@ void EventLoop::run() {
   LOG_INFO("Event loop started (Windows select)");
 
   while (running_.load()) {
-    // Calculate timeout based on next timer.
-    int timeout_ms = config_.epoll_timeout_ms;
-    auto next_timer = timer_heap_.time_until_next();
-    if (next_timer) {
-      auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(*next_timer).count();
-      if (ms < 0) ms = 0;
-      timeout_ms = std::min(timeout_ms, static_cast<int>(ms));
-    }
+    const int timeout_ms = wait_timeout_ms();
 
     // Build fd_sets for select.
     fd_set read_fds;
@@ -205,9 +226,12 @@ void EventLoop::run() {
         max_fd = fd;
       }
     }
+    for (const auto& [fd, handler] : fd_handlers_) {
+      FD_SET(static_cast<SOCKET>(fd), &read_fds);
+    }
 
     // If no sockets registered, just process timers and sleep.
-    if (sockets_.empty()) {
+    if (sockets_.empty() && fd_handlers_.empty()) {
       handle_timers();
       if (timeout_ms > 0) {
         Sleep(static_cast<DWORD>(std::min(timeout_ms, 10)));
@@ -233,6 +257,20 @@ void EventLoop::run() {
 
     // Process I/O events.
     if (n > 0) {
+      std::vector<int> ready_fds;
+      for (const auto& [fd, handler] : fd_handlers_) {
+        if (FD_ISSET(static_cast<SOCKET>(fd), &read_fds)) {
+          ready_fds.push_back(fd);
+        }
+      }
+      for (int fd : ready_fds) {
+        auto handler = fd_handlers_.find(fd);
+        if (handler != fd_handlers_.end()) {
+          auto on_readable = handler->second;
+          on_readable();
+        }
+      }
+
       // Collect file descriptors to process (avoid iterator invalidation).
       std::vector<int> fds_to_process;
       fds_to_process.reserve(sockets_.size());
@@ -270,6 +308,9 @@ void EventLoop::run() {
         }
       }
     }
+    if (iteration_handler_) {
+      iteration_handler_();
+    }
 
     // Process expired timers.
     handle_timers();
@@ -280,33 +321,41 @@ void EventLoop::run() {
 
 void EventLoop::stop() { running_.store(false); }
 
+int EventLoop::wait_timeout_ms() {
+  int timeout_ms = config_.epoll_timeout_ms;
+  if (auto next_timer = timer_heap_.time_until_next()) {
+    auto ms = std::chrono::ceil<std::chrono::milliseconds>(*next_timer).count();
+    ms = std::clamp<decltype(ms)>(ms, 0, std::numeric_limits<int>::max());
+    timeout_ms = std::min(timeout_ms, static_cast<int>(ms));
+  }
+  return timeout_ms;
+}
+
 void EventLoop::handle_read(int fd) {
   auto it = sockets_.find(fd);
   if (it == sockets_.end()) {
     return;
   }
 
-  auto& info = it->second;
-
-  // Read packets until no more available.
-  while (true) {
-    std::error_code ec;
-    bool got_packet = false;
-
-    info.socket->poll(
-        [&](const UdpPacket& pkt) {
-          got_packet = true;
-          info.last_activity = now_fn_();
-
-          if (info.on_packet) {
-            info.on_packet(info.session_id, pkt.data, pkt.remote);
-          }
-        },
-        0, ec);
-
-    if (!got_packet) {
-      break;
-    }
+  // Read packets until the socket would block. The handler may remove the
+  // socket, so look it up again for every datagram.
+  UdpSocket* socket = it->second.socket;
+  std::error_code ec;
+  socket->drain(
+      [&](const UdpPacket& pkt) {
+        auto current = sockets_.find(fd);
+        if (current == sockets_.end() || current->second.socket != socket) {
+          return;
+        }
+        auto& info = current->second;
+        info.last_activity = now_fn_();
+        if (info.on_packet) {
+          info.on_packet(info.session_id, pkt.data, pkt.remote);
+        }
+      },
+      std::numeric_limits<std::size_t>::max(), ec);
+  if (ec) {
+    LOG_DEBUG("Receive failed for fd={}: {}", fd, ec.message());
   }
 }
 
@@ -0,0 +1,494 @@
+// io_uring driver for the Linux event loop.
+// This file is only compiled on Linux/Unix platforms
+
+#ifndef _WIN32
+
+#include "transport/event_loop/io_uring_backend.h"
+
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+#include "common/logging/logger.h"
+
+namespace veil::transport {
+
+namespace {
+
+// Buffer group ID used for the receive buffer ring.
+constexpr std::uint16_t kRecvBufferGroup = 0;
+
+// user_data layout: op (8 bits) | generation or send slot (24 bits) | fd (32 bits).
+constexpr std::uint64_t kTagMask = (1ULL << 24) - 1;
+
+std::uint64_t make_user_data(std::uint8_t op, std::uint64_t tag, int fd) {
+  return (static_cast<std::uint64_t>(op) << 56) | ((tag & kTagMask) << 32) |
+         static_cast<std::uint32_t>(fd);
+}
+
+int sys_io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int sys_io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                       const void* arg, std::size_t arg_size) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, arg_size));
+}
+
+int sys_io_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+std::error_code errno_code() { return std::error_code(errno, std::generic_category()); }
+
+template <typename T>
+T load_acquire(T* ptr) {
+  return std::atomic_ref<T>(*ptr).load(std::memory_order_acquire);
+}
+
+template <typename T>
+void store_release(T* ptr, T value) {
+  std::atomic_ref<T>(*ptr).store(value, std::memory_order_release);
+}
+
+// Multishot recvmsg has no feature bit. IORING_SETUP_SINGLE_ISSUER arrived in
+// the same release (6.0), so a ring created with it proves support.
+bool kernel_has_multishot_recv() {
+  io_uring_params params{};
+  params.flags = IORING_SETUP_SINGLE_ISSUER;
+  const int fd = sys_io_uring_setup(2, &params);
+  if (fd < 0) {
+    return false;
+  }
+  ::close(fd);
+  return true;
+}
+
+}  // namespace
+
+std::unique_ptr<IoUringBackend> IoUringBackend::create(const IoUringConfig& config, std::error_code& ec) {
+  std::unique_ptr<IoUringBackend> backend(new IoUringBackend());
+  if (!backend->setup(config, ec)) {
+    return nullptr;
+  }
+  return backend;
+}
+
+bool IoUringBackend::setup(const IoUringConfig& config, std::error_code& ec) {
+  const std::size_t buffer_count = config.recv_buffer_count;
+  if (buffer_count == 0 || buffer_count > 32768 || (buffer_count & (buffer_count - 1)) != 0 ||
+      config.recv_buffer_size < sizeof(io_uring_recvmsg_out) + sizeof(sockaddr_in) + 1) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+
+  io_uring_params params{};
+  params.flags = IORING_SETUP_CQSIZE | IORING_SETUP_CLAMP;
+  params.cq_entries = config.entries * 4;
+  ring_fd_ = sys_io_uring_setup(config.entries, &params);
+  if (ring_fd_ < 0) {
+    ec = errno_code();
+    return false;
+  }
+
+  constexpr unsigned kRequiredFeatures = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_EXT_ARG;
+  if ((params.features & kRequiredFeatures) != kRequiredFeatures || !kernel_has_multishot_recv()) {
+    ec = std::make_error_code(std::errc::function_not_supported);
+    return false;
+  }
+
+  // Map the SQ and CQ rings (one mapping with IORING_FEAT_SINGLE_MMAP) and the SQE array.
+  sq_ring_size_ = std::max<std::size_t>(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                                        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                    IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    ec = errno_code();
+    return false;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                      IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    ec = errno_code();
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  auto* base = static_cast<std::uint8_t*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(base + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(base + params.sq_off.tail);
+  sq_mask_ = *reinterpret_cast<unsigned*>(base + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  auto* sq_array = reinterpret_cast<unsigned*>(base + params.sq_off.array);
+  for (unsigned i = 0; i < sq_entries_; ++i) {
+    sq_array[i] = i;  // SQE i always sits in slot i.
+  }
+  sq_local_tail_ = *sq_tail_;
+  sq_submitted_ = sq_local_tail_;
+
+  cq_head_ = reinterpret_cast<unsigned*>(base + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(base + params.cq_off.tail);
+  cq_mask_ = *reinterpret_cast<unsigned*>(base + params.cq_off.ring_mask);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(base + params.cq_off.cqes);
+
+  // Register the receive buffer ring.
+  buf_ring_size_ = buffer_count * sizeof(io_uring_buf);
+  void* ring = ::mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (ring == MAP_FAILED) {
+    ec = errno_code();
+    return false;
+  }
+  buf_ring_ = static_cast<io_uring_buf_ring*>(ring);
+  io_uring_buf_reg reg{};
+  reg.ring_addr = reinterpret_cast<std::uint64_t>(buf_ring_);
+  reg.ring_entries = static_cast<std::uint32_t>(buffer_count);
+  reg.bgid = kRecvBufferGroup;
+  if (sys_io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+    ec = errno_code();
+    return false;
+  }
+  buf_ring_mask_ = static_cast<std::uint16_t>(buffer_count - 1);
+  recv_buffer_size_ = config.recv_buffer_size;
+  recv_slab_.resize(buffer_count * recv_buffer_size_);
+  for (std::size_t i = 0; i < buffer_count; ++i) {
+    recycle_buffer(static_cast<std::uint16_t>(i));
+  }
+
+  // Every multishot recvmsg shares this template: room for an IPv4 source
+  // address, no control data.
+  recv_msg_.msg_namelen = sizeof(sockaddr_in);
+
+  max_inflight_sends_ = config.max_inflight_sends;
+  send_pool_ = utils::PacketPool(std::min<std::size_t>(max_inflight_sends_, 64), recv_buffer_size_);
+
+  LOG_DEBUG("io_uring backend ready: {} SQ entries, {} CQ entries, {} x {} byte receive buffers",
+            params.sq_entries, params.cq_entries, buffer_count, recv_buffer_size_);
+  return true;
+}
+
+IoUringBackend::~IoUringBackend() {
+  if (ring_fd_ >= 0) {
+    ::close(ring_fd_);  // Cancels every outstanding request.
+  }
+  if (buf_ring_ != nullptr) {
+    ::munmap(buf_ring_, buf_ring_size_);
+  }
+  if (sqes_ != nullptr) {
+    ::munmap(sqes_, sqes_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    ::munmap(sq_ring_, sq_ring_size_);
+  }
+}
+
+unsigned IoUringBackend::pending_submissions() const { return sq_local_tail_ - sq_submitted_; }
+
+int IoUringBackend::enter(unsigned to_submit, unsigned min_complete, unsigned flags, int timeout_ms) {
+  store_release(sq_tail_, sq_local_tail_);
+
+  io_uring_getevents_arg arg{};
+  timespec ts{};
+  const void* arg_ptr = nullptr;
+  std::size_t arg_size = 0;
+  if ((flags & IORING_ENTER_GETEVENTS) != 0 && timeout_ms >= 0) {
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = static_cast<long>(timeout_ms % 1000) * 1000000L;
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = reinterpret_cast<std::uint64_t>(&ts);
+    arg_ptr = &arg;
+    arg_size = sizeof(arg);
+    flags |= IORING_ENTER_EXT_ARG;
+  }
+
+  ++stats_.enters;
+  const int ret = sys_io_uring_enter(ring_fd_, to_submit, min_complete, flags, arg_ptr, arg_size);
+  if (ret > 0) {
+    sq_submitted_ += static_cast<unsigned>(ret);
+  }
+  return ret;
+}
+
+io_uring_sqe* IoUringBackend::next_sqe() {
+  if (sq_local_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+    // Full: hand what we have to the kernel to make room.
+    if (enter(pending_submissions(), 0, 0, -1) < 0 || sq_local_tail_ - load_acquire(sq_head_) >= sq_entries_) {
+      return nullptr;
+    }
+  }
+  io_uring_sqe* sqe = &sqes_[sq_local_tail_ & sq_mask_];
+  std::memset(sqe, 0, sizeof(*sqe));
+  ++sq_local_tail_;
+  return sqe;
+}
+
+void IoUringBackend::recycle_buffer(std::uint16_t buffer_id) {
+  // Index the entries directly: in C++ the header's flexible-array member
+  // (bufs) is not at offset 0 as it is in C.
+  io_uring_buf& buf = reinterpret_cast<io_uring_buf*>(buf_ring_)[buf_ring_tail_ & buf_ring_mask_];
+  buf.addr = reinterpret_cast<std::uint64_t>(recv_slab_.data() + static_cast<std::size_t>(buffer_id) * recv_buffer_size_);
+  buf.len = static_cast<std::uint32_t>(recv_buffer_size_);
+  buf.bid = buffer_id;
+  ++buf_ring_tail_;
+  store_release(&buf_ring_->tail, buf_ring_tail_);
+}
+
+void IoUringBackend::arm(int fd, const Watch& watch) {
+  io_uring_sqe* sqe = next_sqe();
+  if (sqe == nullptr) {
+    LOG_ERROR("io_uring submission queue full, cannot watch fd={}", fd);
+    return;
+  }
+  sqe->fd = fd;
+  sqe->user_data = make_user_data(static_cast<std::uint8_t>(watch.op), watch.generation, fd);
+  if (watch.op == Op::kRecv) {
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->addr = reinterpret_cast<std::uint64_t>(&recv_msg_);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kRecvBufferGroup;
+  } else {
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+  }
+}
+
+bool IoUringBackend::watch_datagrams(int fd) {
+  if (fd < 0 || watches_.count(fd) != 0) {
+    return false;
+  }
+  const Watch watch{Op::kRecv, next_generation_++ & static_cast<std::uint32_t>(kTagMask)};
+  watches_[fd] = watch;
+  arm(fd, watch);
+  return true;
+}
+
+bool IoUringBackend::watch_readable(int fd) {
+  if (fd < 0 || watches_.count(fd) != 0) {
+    return false;
+  }
+  const Watch watch{Op::kPoll, next_generation_++ & static_cast<std::uint32_t>(kTagMask)};
+  watches_[fd] = watch;
+  arm(fd, watch);
+  return true;
+}
+
+void IoUringBackend::unwatch(int fd) {
+  auto it = watches_.find(fd);
+  if (it == watches_.end()) {
+    return;
+  }
+  const std::uint64_t target = make_user_data(static_cast<std::uint8_t>(it->second.op), it->second.generation, fd);
+  watches_.erase(it);
+
+  if (io_uring_sqe* sqe = next_sqe()) {
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = make_user_data(static_cast<std::uint8_t>(Op::kCancel), 0, fd);
+  }
+  // Submit now: the request holds a reference to the file until cancelled.
+  enter(pending_submissions(), 0, 0, -1);
+}
+
+std::size_t IoUringBackend::acquire_slot() {
+  if (!free_slots_.empty()) {
+    const std::size_t index = free_slots_.back();
+    free_slots_.pop_back();
+    return index;
+  }
+  if (slots_.size() >= max_inflight_sends_ || slots_.size() > kTagMask) {
+    return slots_.size() + 1;  // No slot.
+  }
+  slots_.push_back(std::make_unique<SendSlot>());
+  return slots_.size() - 1;
+}
+
+bool IoUringBackend::queue_send(int fd, std::span<const std::uint8_t> data, const sockaddr_in& to) {
+  const std::size_t index = acquire_slot();
+  if (index >= slots_.size()) {
+    return false;
+  }
+  io_uring_sqe* sqe = next_sqe();
+  if (sqe == nullptr) {
+    free_slots_.push_back(index);
+    return false;
+  }
+
+  SendSlot& slot = *slots_[index];
+  slot.data = send_pool_.acquire();
+  slot.data.assign(data.begin(), data.end());
+  slot.to = to;
+  slot.iov.iov_base = slot.data.data();
+  slot.iov.iov_len = slot.data.size();
+  slot.msg = msghdr{};
+  slot.msg.msg_name = &slot.to;
+  slot.msg.msg_namelen = sizeof(slot.to);
+  slot.msg.msg_iov = &slot.iov;
+  slot.msg.msg_iovlen = 1;
+
+  sqe->opcode = IORING_OP_SENDMSG;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(&slot.msg);
+  sqe->len = 1;
+  sqe->user_data = make_user_data(static_cast<std::uint8_t>(Op::kSend), index, fd);
+  return true;
+}
+
+bool IoUringBackend::queue_write(int fd, std::span<const std::uint8_t> data) {
+  const std::size_t index = acquire_slot();
+  if (index >= slots_.size()) {
+    return false;
+  }
+  io_uring_sqe* sqe = next_sqe();
+  if (sqe == nullptr) {
+    free_slots_.push_back(index);
+    return false;
+  }
+
+  SendSlot& slot = *slots_[index];
+  slot.data = send_pool_.acquire();
+  slot.data.assign(data.begin(), data.end());
+
+  sqe->opcode = IORING_OP_WRITE;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<std::uint64_t>(slot.data.data());
+  sqe->len = static_cast<std::uint32_t>(slot.data.size());
+  sqe->off = ~0ULL;  // Current file position; TUN devices ignore it.
+  sqe->user_data = make_user_data(static_cast<std::uint8_t>(Op::kWrite), index, fd);
+  return true;
+}
+
+bool IoUringBackend::run_once(int timeout_ms, const Handlers& handlers, std::error_code& ec) {
+  // Only block if nothing is waiting to be reaped.
+  const bool have_completions = load_acquire(cq_tail_) != *cq_head_;
+  const unsigned wait_for = (have_completions || timeout_ms == 0) ? 0 : 1;
+  const unsigned flags = wait_for > 0 ? IORING_ENTER_GETEVENTS : 0;
+  if (wait_for > 0 || pending_submissions() > 0) {
+    if (enter(pending_submissions(), wait_for, flags, timeout_ms) < 0 && errno != ETIME && errno != EINTR &&
+        errno != EBUSY && errno != EAGAIN) {
+      ec = errno_code();
+      return false;
+    }
+  }
+
+  unsigned head = *cq_head_;
+  const unsigned tail = load_acquire(cq_tail_);
+  while (head != tail) {
+    // Copy: handlers may queue work that enters the kernel.
+    const io_uring_cqe cqe = cqes_[head & cq_mask_];
+    ++head;
+    store_release(cq_head_, head);
+    ++stats_.completions;
+    dispatch(cqe, handlers);
+  }
+  return true;
+}
+
+void IoUringBackend::dispatch(const io_uring_cqe& cqe, const Handlers& handlers) {
+  const auto op = static_cast<Op>(cqe.user_data >> 56);
+  const std::uint32_t tag = static_cast<std::uint32_t>((cqe.user_data >> 32) & kTagMask);
+  const int fd = static_cast<int>(static_cast<std::uint32_t>(cqe.user_data));
+  const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+
+  const auto is_live = [&]() {
+    auto it = watches_.find(fd);
+    return it != watches_.end() && it->second.op == op && it->second.generation == tag;
+  };
+
+  switch (op) {
+    case Op::kRecv: {
+      const bool has_buffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+      const auto buffer_id = static_cast<std::uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+      if (cqe.res > 0 && has_buffer && is_live()) {
+        const std::uint8_t* buffer = recv_slab_.data() + static_cast<std::size_t>(buffer_id) * recv_buffer_size_;
+        io_uring_recvmsg_out out{};
+        std::memcpy(&out, buffer, sizeof(out));
+        const std::size_t header = sizeof(out) + recv_msg_.msg_namelen + recv_msg_.msg_controllen;
+        if ((out.flags & MSG_TRUNC) != 0 || header + out.payloadlen > static_cast<std::size_t>(cqe.res)) {
+          ++stats_.truncated;
+        } else {
+          sockaddr_in from{};
+          std::memcpy(&from, buffer + sizeof(out), std::min<std::size_t>(sizeof(from), out.namelen));
+          ++stats_.datagrams;
+          if (handlers.on_datagram) {
+            handlers.on_datagram(fd, std::span<const std::uint8_t>(buffer + header, out.payloadlen), from);
+          }
+        }
+      }
+      if (has_buffer) {
+        recycle_buffer(buffer_id);
+      }
+      if (!more && is_live()) {
+        if (cqe.res == -ENOBUFS) {
+          ++stats_.buffer_exhaustions;
+        } else if (cqe.res < 0) {
+          LOG_ERROR("io_uring receive on fd={} failed: {}", fd,
+                    std::error_code(-cqe.res, std::generic_category()).message());
+          watches_.erase(fd);
+          return;
+        }
+        ++stats_.rearms;
+        arm(fd, watches_[fd]);
+      }
+      return;
+    }
+
+    case Op::kPoll: {
+      if (!is_live()) {
+        return;
+      }
+      if (cqe.res < 0) {
+        LOG_ERROR("io_uring poll on fd={} failed: {}", fd,
+                  std::error_code(-cqe.res, std::generic_category()).message());
+        watches_.erase(fd);
+        return;
+      }
+      if (handlers.on_readable) {
+        handlers.on_readable(fd);
+      }
+      if (!more && is_live()) {
+        ++stats_.rearms;
+        arm(fd, watches_[fd]);
+      }
+      return;
+    }
+
+    case Op::kSend:
+    case Op::kWrite: {
+      if (tag < slots_.size()) {
+        send_pool_.release(std::move(slots_[tag]->data));
+        slots_[tag]->data = {};
+        free_slots_.push_back(tag);
+      }
+      if (cqe.res < 0) {
+        ++stats_.send_errors;
+        if (handlers.on_send_error) {
+          handlers.on_send_error(fd, std::error_code(-cqe.res, std::generic_category()));
+        }
+      } else {
+        ++stats_.sends_completed;
+      }
+      return;
+    }
+
+    case Op::kCancel:
+      return;
+  }
+}
+
+}  // namespace veil::transport
+
+#endif  // !_WIN32
@@ -0,0 +1,186 @@
+#pragma once
+
+// io_uring driver for the Linux event loop. Only compiled on Linux.
+
+#ifndef _WIN32
+
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include "common/utils/packet_pool.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_buf_ring;
+
+namespace veil::transport {
+
+struct IoUringConfig {
+  // Submission queue entries (rounded up to a power of two by the kernel).
+  // The completion queue is four times larger.
+  unsigned entries{256};
+  // Receive buffers handed to the kernel for multishot receive (power of two,
+  // at most 32768) and the size of each. A datagram larger than the buffer is
+  // dropped as truncated.
+  std::size_t recv_buffer_count{512};
+  std::size_t recv_buffer_size{2048};
+  // Sends queued in the ring at once; beyond this, callers fall back to a
+  // synchronous send.
+  std::size_t max_inflight_sends{1024};
+};
+
+/**
+ * Minimal io_uring driver used by EventLoop's io_uring backend.
+ *
+ * - UDP sockets are read with one multishot recvmsg each. The kernel picks
+ *   buffers from a ring of pre-registered receive buffers, so a burst of
+ *   datagrams completes without a syscall per packet.
+ * - Other descriptors (TUN, eventfd) are watched with multishot poll; their
+ *   handlers read until the descriptor would block.
+ * - Sends and writes are queued as SQEs and submitted together with the next
+ *   wait, so a batch of packets produced by one wakeup costs one
+ *   io_uring_enter. Payloads are copied into buffers from a PacketPool and
+ *   returned to it on completion.
+ * - Waits take a timeout (derived from the TimerHeap by the caller) via
+ *   IORING_ENTER_EXT_ARG; no timeout SQEs are used.
+ *
+ * Requires Linux 6.0 or newer (multishot recvmsg and provided buffer rings).
+ * create() returns nullptr on older kernels or when io_uring is disabled
+ * (e.g. by seccomp), and the caller falls back to epoll.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Owned and driven by a single EventLoop thread.
+ */
+class IoUringBackend {
+ public:
+  struct Handlers {
+    // A datagram arrived on a socket registered with watch_datagrams().
+    std::function<void(int fd, std::span<const std::uint8_t> data, const sockaddr_in& from)> on_datagram;
+    // A descriptor registered with watch_readable() is readable.
+    std::function<void(int fd)> on_readable;
+    // A queued send or write failed.
+    std::function<void(int fd, std::error_code ec)> on_send_error;
+  };
+
+  struct Stats {
+    std::uint64_t enters{0};              // io_uring_enter calls
+    std::uint64_t completions{0};         // CQEs reaped
+    std::uint64_t datagrams{0};           // datagrams delivered
+    std::uint64_t sends_completed{0};     // sends/writes completed successfully
+    std::uint64_t send_errors{0};         // sends/writes that failed
+    std::uint64_t truncated{0};           // datagrams dropped as larger than a buffer
+    std::uint64_t rearms{0};              // multishot requests re-armed
+    std::uint64_t buffer_exhaustions{0};  // receive stalled for lack of buffers
+  };
+
+  // Set up a ring. Returns nullptr and sets ec if io_uring is unavailable or
+  // the kernel lacks a required feature.
+  static std::unique_ptr<IoUringBackend> create(const IoUringConfig& config, std::error_code& ec);
+
+  ~IoUringBackend();
+
+  IoUringBackend(const IoUringBackend&) = delete;
+  IoUringBackend& operator=(const IoUringBackend&) = delete;
+  IoUringBackend(IoUringBackend&&) = delete;
+  IoUringBackend& operator=(IoUringBackend&&) = delete;
+
+  // Start delivering datagrams from a UDP socket.
+  bool watch_datagrams(int fd);
+  // Start reporting readability of a descriptor.
+  bool watch_readable(int fd);
+  // Stop watching a descriptor. Must be called before the descriptor is closed.
+  void unwatch(int fd);
+
+  // Queue a datagram / a write. The data is copied. Returns false if the ring
+  // or the send budget is full; the caller should then send synchronously.
+  bool queue_send(int fd, std::span<const std::uint8_t> data, const sockaddr_in& to);
+  bool queue_write(int fd, std::span<const std::uint8_t> data);
+
+  // Submit queued requests, wait up to timeout_ms for at least one completion,
+  // and dispatch every available completion. Returns false on a ring error.
+  bool run_once(int timeout_ms, const Handlers& handlers, std::error_code& ec);
+
+  const Stats& stats() const { return stats_; }
+
+ private:
+  enum class Op : std::uint8_t { kRecv = 1, kPoll = 2, kSend = 3, kWrite = 4, kCancel = 5 };
+
+  struct Watch {
+    Op op{Op::kPoll};
+    std::uint32_t generation{0};
+  };
+
+  struct SendSlot {
+    std::vector<std::uint8_t> data;
+    sockaddr_in to{};
+    iovec iov{};
+    msghdr msg{};
+  };
+
+  IoUringBackend() = default;
+
+  bool setup(const IoUringConfig& config, std::error_code& ec);
+  io_uring_sqe* next_sqe();
+  int enter(unsigned to_submit, unsigned min_complete, unsigned flags, int timeout_ms);
+  unsigned pending_submissions() const;
+  void arm(int fd, const Watch& watch);
+  void recycle_buffer(std::uint16_t buffer_id);
+  std::size_t acquire_slot();
+  void dispatch(const io_uring_cqe& cqe, const Handlers& handlers);
+
+  int ring_fd_{-1};
+
+  // Submission queue.
+  void* sq_ring_{nullptr};
+  std::size_t sq_ring_size_{0};
+  unsigned* sq_head_{nullptr};
+  unsigned* sq_tail_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned sq_entries_{0};
+  unsigned sq_local_tail_{0};
+  unsigned sq_submitted_{0};
+  io_uring_sqe* sqes_{nullptr};
+  std::size_t sqes_size_{0};
+
+  // Completion queue (shares the SQ mapping).
+  unsigned* cq_head_{nullptr};
+  unsigned* cq_tail_{nullptr};
+  unsigned cq_mask_{0};
+  io_uring_cqe* cqes_{nullptr};
+
+  // Provided receive buffers.
+  io_uring_buf_ring* buf_ring_{nullptr};
+  std::size_t buf_ring_size_{0};
+  std::uint16_t buf_ring_tail_{0};
+  std::uint16_t buf_ring_mask_{0};
+  std::vector<std::uint8_t> recv_slab_;
+  std::size_t recv_buffer_size_{0};
+  msghdr recv_msg_{};
+
+  // Watched descriptors; the generation tags completions so that those of a
+  // watch that was removed (and possibly replaced) are ignored.
+  std::unordered_map<int, Watch> watches_;
+  std::uint32_t next_generation_{1};
+
+  // In-flight sends and writes.
+  std::vector<std::unique_ptr<SendSlot>> slots_;
+  std::vector<std::size_t> free_slots_;
+  std::size_t max_inflight_sends_{0};
+  utils::PacketPool send_pool_;
+
+  Stats stats_;
+};
+
+}  // namespace veil::transport
+
+#endif  // !_WIN32
@@ -1,11 +1,57 @@
 #include "transport/mux/ack_scheduler.h"
 
 #include <algorithm>
+#include <utility>
 
 namespace veil::mux {
 
+namespace {
+
+// Largest packet threshold a peer may request: the span of an ACK bitmap.
+constexpr std::uint16_t kMaxPacketThreshold = 32;
+
+}  // namespace
+
+std::vector<std::uint8_t> encode_ack_frequency(const AckFrequency& frequency) {
+  const auto delay_us = static_cast<std::uint32_t>(
+      std::clamp<std::chrono::microseconds::rep>(frequency.max_ack_delay.count(), 0, 0xFFFFFFFF));
+  return {static_cast<std::uint8_t>(frequency.packet_threshold >> 8),
+          static_cast<std::uint8_t>(frequency.packet_threshold & 0xFF),
+          static_cast<std::uint8_t>(delay_us >> 24),
+          static_cast<std::uint8_t>((delay_us >> 16) & 0xFF),
+          static_cast<std::uint8_t>((delay_us >> 8) & 0xFF),
+          static_cast<std::uint8_t>(delay_us & 0xFF)};
+}
+
+std::optional<AckFrequency> decode_ack_frequency(std::span<const std::uint8_t> payload) {
+  if (payload.size() != kAckFrequencySize) {
+    return std::nullopt;
+  }
+  AckFrequency frequency;
+  frequency.packet_threshold = static_cast<std::uint16_t>((payload[0] << 8) | payload[1]);
+  const std::uint32_t delay_us = (static_cast<std::uint32_t>(payload[2]) << 24) |
+                                 (static_cast<std::uint32_t>(payload[3]) << 16) |
+                                 (static_cast<std::uint32_t>(payload[4]) << 8) | payload[5];
+  frequency.max_ack_delay = std::chrono::microseconds(delay_us);
+  return frequency;
+}
+
+AckFrequency choose_ack_frequency(const AckFrequencyConfig& config, std::size_t cwnd, std::size_t mss,
+                                  std::chrono::microseconds srtt, CongestionState state) {
+  AckFrequency frequency;
+  std::size_t threshold = config.min_packet_threshold;
+  if (state == CongestionState::kCongestionAvoidance && mss > 0) {
+    threshold = cwnd / mss / std::max<std::uint32_t>(config.acks_per_window, 1);
+  }
+  frequency.packet_threshold = static_cast<std::uint16_t>(std::clamp<std::size_t>(
+      threshold, config.min_packet_threshold, std::max(config.min_packet_threshold, config.max_packet_threshold)));
+  frequency.max_ack_delay = std::clamp<std::chrono::microseconds>(
+      srtt / 4, config.min_ack_delay, std::max(config.min_ack_delay, config.max_ack_delay));
+  return frequency;
+}
+
 AckScheduler::AckScheduler(AckSchedulerConfig config, std::function<TimePoint()> now_fn)
-    : config_(config), now_fn_(std::move(now_fn)) {}
+    : config_(config), configured_max_pending_acks_(config.max_pending_acks), now_fn_(std::move(now_fn)) {}
 
 bool AckScheduler::on_packet_received(std::uint64_t stream_id, std::uint64_t sequence, bool fin) {
   // Find or create stream state.
@@ -23,6 +69,8 @@ bool AckScheduler::on_packet_received(std::uint64_t stream_id, std::uint64_t seq
   if (sequence > state.highest_received + 1 && state.highest_received > 0) {
     state.gap_detected = true;
     ++stats_.gaps_detected;
+  } else if (sequence < state.highest_received) {
+    state.reordered = true;
   }
 
   // Update state.
@@ -108,6 +156,7 @@ void AckScheduler::ack_sent(std::uint64_t stream_id) {
   state.packets_since_ack = 0;
   state.needs_ack = false;
   state.gap_detected = false;
+  state.reordered = false;
   state.received_bitmap = 0;
 }
 
@@ -145,6 +194,14 @@ void AckScheduler::reset_stream(std::uint64_t stream_id) {
   }
 }
 
+void AckScheduler::set_ack_frequency(const AckFrequency& frequency) {
+  const auto threshold = std::clamp<std::uint32_t>(frequency.packet_threshold, 1, kMaxPacketThreshold);
+  config_.ack_every_n_packets = threshold;
+  config_.max_pending_acks = std::max(threshold, configured_max_pending_acks_);
+  config_.max_ack_delay = std::max(std::chrono::duration_cast<std::chrono::milliseconds>(frequency.max_ack_delay),
+                                   std::chrono::milliseconds(1));
+}
+
 void AckScheduler::update_bitmap(StreamAckState& state, std::uint64_t sequence) {
   // Bitmap tracks which packets in the last 32 before highest_received have been received.
   if (state.highest_received == 0) {
@@ -176,8 +233,8 @@ bool AckScheduler::should_send_immediate_ack(const StreamAckState& state, bool f
     return true;
   }
 
-  // Immediate ACK for out-of-order (gap detected).
-  if (state.gap_detected && config_.immediate_ack_on_gap) {
+  // Immediate ACK for out-of-order (gap detected, or a gap being filled).
+  if ((state.gap_detected || state.reordered) && config_.immediate_ack_on_gap) {
     return true;
   }
 
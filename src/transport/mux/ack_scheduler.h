@@ -4,8 +4,10 @@
 #include <cstdint>
 #include <functional>
 #include <optional>
+#include <span>
 #include <vector>
 
+#include "transport/mux/congestion_controller.h"
 #include "transport/mux/frame.h"
 
 namespace veil::mux {
@@ -32,6 +34,51 @@ struct AckSchedulerConfig {
   bool immediate_ack_on_fin{true};
 };
 
+// ACK frequency a sender asks of its peer, carried in a
+// ControlType::kAckFrequency frame (cf. the QUIC ACK_FREQUENCY extension).
+// The receiver applies it with AckScheduler::set_ack_frequency().
+struct AckFrequency {
+  // Received packets after which an ACK is sent without waiting for the timer.
+  std::uint16_t packet_threshold{2};
+  // Longest the receiver may hold back an ACK.
+  std::chrono::microseconds max_ack_delay{20'000};
+
+  bool operator==(const AckFrequency&) const = default;
+};
+
+// Wire format: packet threshold (u16) and max ACK delay in microseconds
+// (u32), big-endian.
+inline constexpr std::size_t kAckFrequencySize = 6;
+std::vector<std::uint8_t> encode_ack_frequency(const AckFrequency& frequency);
+std::optional<AckFrequency> decode_ack_frequency(std::span<const std::uint8_t> payload);
+
+// How a sender picks the ACK frequency it requests.
+struct AckFrequencyConfig {
+  // Send requests at all. Peers that do not know the frame ignore it.
+  bool enabled{true};
+  // ACKs wanted per congestion window, i.e. per round trip in bulk transfer.
+  std::uint32_t acks_per_window{8};
+  // Bounds on the packet threshold. The upper bound stays well inside the
+  // 32-packet window of an ACK bitmap, so one lost ACK does not push
+  // received packets out of the next one.
+  std::uint16_t min_packet_threshold{2};
+  std::uint16_t max_packet_threshold{16};
+  // Bounds on the requested ACK delay, which is a quarter of the SRTT.
+  std::chrono::milliseconds min_ack_delay{1};
+  std::chrono::milliseconds max_ack_delay{25};
+  // Repeat an unchanged request this often while data flows, so a peer
+  // that lost its state (e.g. a resumed session) picks it up again.
+  std::chrono::milliseconds refresh_interval{1000};
+};
+
+// ACK frequency for the current congestion state: in congestion avoidance
+// a threshold of cwnd / acks_per_window packets, otherwise the minimum
+// threshold (slow start grows the window per ACK, and fast recovery needs
+// loss reported promptly); and a delay of SRTT / 4. Both are clamped to the
+// configured bounds.
+AckFrequency choose_ack_frequency(const AckFrequencyConfig& config, std::size_t cwnd, std::size_t mss,
+                                  std::chrono::microseconds srtt, CongestionState state);
+
 // Statistics for ACK scheduling.
 struct AckSchedulerStats {
   std::uint64_t acks_sent{0};
@@ -75,6 +122,15 @@ class AckScheduler {
   // Reset state for a stream.
   void reset_stream(std::uint64_t stream_id);
 
+  // Apply an ACK frequency requested by the peer: ACK after
+  // packet_threshold packets (clamped to 1..32, the ACK bitmap window) and
+  // within max_ack_delay (at least 1 ms). max_pending_acks follows the
+  // threshold but never drops below its configured value.
+  void set_ack_frequency(const AckFrequency& frequency);
+
+  // Current configuration, including any applied ACK frequency.
+  const AckSchedulerConfig& config() const { return config_; }
+
  private:
   struct StreamAckState {
     std::uint64_t highest_received{0};
@@ -83,12 +139,14 @@ class AckScheduler {
     TimePoint first_unacked_time;
     bool needs_ack{false};
     bool gap_detected{false};
+    bool reordered{false};
   };
 
   void update_bitmap(StreamAckState& state, std::uint64_t sequence);
   bool should_send_immediate_ack(const StreamAckState& state, bool fin) const;
 
   AckSchedulerConfig config_;
+  std::uint32_t configured_max_pending_acks_;
   std::function<TimePoint()> now_fn_;
   std::vector<std::pair<std::uint64_t, StreamAckState>> streams_;
   AckSchedulerStats stats_;
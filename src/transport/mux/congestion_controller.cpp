@@ -207,7 +207,7 @@ std::optional<std::chrono::microseconds> CongestionController::time_until_next_s
   return std::chrono::duration_cast<std::chrono::microseconds>(interval - elapsed);
 }
 
-void CongestionController::update_pacing_rate(std::chrono::milliseconds rtt) {
+void CongestionController::update_pacing_rate(std::chrono::microseconds rtt) {
   srtt_ = rtt;
 
   if (rtt.count() <= 0) {
@@ -218,14 +218,14 @@ void CongestionController::update_pacing_rate(std::chrono::milliseconds rtt) {
 
   // Pacing rate = cwnd / RTT * pacing_gain.
   // This spreads cwnd bytes over one RTT, with some overhead.
-  const std::size_t base_rate = (cwnd_ * 1000) / static_cast<std::size_t>(rtt.count());
+  const std::size_t base_rate = (cwnd_ * 1'000'000) / static_cast<std::size_t>(rtt.count());
   pacing_rate_ = static_cast<std::size_t>(static_cast<double>(base_rate) * config_.pacing_gain);
 
-  LOG_DEBUG("Pacing rate updated: {} bytes/sec (cwnd={}, rtt={}ms, gain={})",
+  LOG_DEBUG("Pacing rate updated: {} bytes/sec (cwnd={}, rtt={}us, gain={})",
             pacing_rate_, cwnd_, rtt.count(), config_.pacing_gain);
 }
 
-void CongestionController::set_srtt(std::chrono::milliseconds srtt) {
+void CongestionController::set_srtt(std::chrono::microseconds srtt) {
   update_pacing_rate(srtt);
 }
 
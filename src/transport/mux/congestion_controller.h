@@ -139,8 +139,9 @@ class CongestionController {
   // Returns nullopt if a packet can be sent immediately.
   std::optional<std::chrono::microseconds> time_until_next_send() const;
 
-  // Update pacing rate based on current RTT.
-  void update_pacing_rate(std::chrono::milliseconds rtt);
+  // Update pacing rate based on current RTT. Microsecond resolution keeps the
+  // rate accurate on sub-millisecond paths.
+  void update_pacing_rate(std::chrono::microseconds rtt);
 
   // ========== State Queries ==========
 
@@ -165,7 +166,7 @@ class CongestionController {
   // ========== RTT Integration ==========
 
   // Set the current smoothed RTT (used for pacing calculations).
-  void set_srtt(std::chrono::milliseconds srtt);
+  void set_srtt(std::chrono::microseconds srtt);
 
  private:
   // Internal state transitions.
@@ -191,7 +192,7 @@ class CongestionController {
   std::size_t pacing_rate_{0};
   TimePoint last_send_time_;
   std::size_t pacing_burst_remaining_{0};
-  std::chrono::milliseconds srtt_{100};
+  std::chrono::microseconds srtt_{100'000};
 
   // Statistics.
   CongestionStats stats_;
@@ -0,0 +1,501 @@
+#include "transport/mux/fec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "common/crypto/hardware_features.h"
+
+// gf256_mul_add() selects AVX2 or SSSE3 at runtime. On GCC/Clang the kernels
+// are compiled with function-level target attributes, so the fast paths are
+// available without building the whole project with -mavx2.
+#if (defined(__clang__) || defined(__GNUC__)) && (defined(__x86_64__) || defined(__i386__))
+  #include <immintrin.h>
+  #define VEIL_AVX2_TARGET __attribute__((target("avx2")))
+  #define VEIL_SSSE3_TARGET __attribute__((target("ssse3")))
+  #define VEIL_HAS_GF_DISPATCH 1
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <immintrin.h>
+  #define VEIL_AVX2_TARGET
+  #define VEIL_SSSE3_TARGET
+  #define VEIL_HAS_GF_DISPATCH 1
+#else
+  #define VEIL_HAS_GF_DISPATCH 0
+#endif
+
+namespace veil::mux {
+
+namespace {
+
+struct GfTables {
+  std::array<std::uint8_t, 512> exp{};
+  std::array<std::uint8_t, 256> log{};
+};
+
+constexpr GfTables make_gf_tables() {
+  GfTables tables;
+  unsigned value = 1;
+  for (std::size_t i = 0; i < 255; ++i) {
+    tables.exp[i] = static_cast<std::uint8_t>(value);
+    tables.log[value] = static_cast<std::uint8_t>(i);
+    value <<= 1;
+    if ((value & 0x100U) != 0) {
+      value ^= 0x11dU;
+    }
+  }
+  // Doubled so exp[log a + log b] needs no reduction.
+  for (std::size_t i = 255; i < tables.exp.size(); ++i) {
+    tables.exp[i] = tables.exp[i - 255];
+  }
+  return tables;
+}
+
+constexpr GfTables kGf = make_gf_tables();
+
+// Products of c with every low nibble and every high nibble: c * x is
+// lo[x & 15] ^ hi[x >> 4].
+struct NibbleTables {
+  alignas(16) std::array<std::uint8_t, 16> lo{};
+  alignas(16) std::array<std::uint8_t, 16> hi{};
+};
+
+NibbleTables make_nibble_tables(std::uint8_t c) {
+  NibbleTables tables;
+  for (std::uint8_t x = 0; x < 16; ++x) {
+    tables.lo[x] = gf256_mul(c, x);
+    tables.hi[x] = gf256_mul(c, static_cast<std::uint8_t>(x << 4));
+  }
+  return tables;
+}
+
+void mul_add_tail(std::uint8_t* dst, const std::uint8_t* src, std::size_t n, const NibbleTables& tables) {
+  for (std::size_t i = 0; i < n; ++i) {
+    dst[i] ^= static_cast<std::uint8_t>(tables.lo[src[i] & 0x0FU] ^ tables.hi[src[i] >> 4]);
+  }
+}
+
+#if VEIL_HAS_GF_DISPATCH
+
+// Both kernels return the number of bytes processed; the caller finishes the tail.
+VEIL_AVX2_TARGET std::size_t mul_add_avx2(std::uint8_t* dst, const std::uint8_t* src, std::size_t n,
+                                          const NibbleTables& tables) {
+  const __m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.lo.data())));
+  const __m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(tables.hi.data())));
+  const __m256i mask = _mm256_set1_epi8(0x0F);
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    const __m256i s = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+    const __m256i l = _mm256_and_si256(s, mask);
+    const __m256i h = _mm256_and_si256(_mm256_srli_epi64(s, 4), mask);
+    const __m256i product = _mm256_xor_si256(_mm256_shuffle_epi8(lo, l), _mm256_shuffle_epi8(hi, h));
+    const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(d, product));
+  }
+  return i;
+}
+
+VEIL_SSSE3_TARGET std::size_t mul_add_ssse3(std::uint8_t* dst, const std::uint8_t* src, std::size_t n,
+                                            const NibbleTables& tables) {
+  const __m128i lo = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.lo.data()));
+  const __m128i hi = _mm_load_si128(reinterpret_cast<const __m128i*>(tables.hi.data()));
+  const __m128i mask = _mm_set1_epi8(0x0F);
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i l = _mm_and_si128(s, mask);
+    const __m128i h = _mm_and_si128(_mm_srli_epi64(s, 4), mask);
+    const __m128i product = _mm_xor_si128(_mm_shuffle_epi8(lo, l), _mm_shuffle_epi8(hi, h));
+    const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, product));
+  }
+  return i;
+}
+
+#endif  // VEIL_HAS_GF_DISPATCH
+
+enum class GfKernel : std::uint8_t { kPortable, kSsse3, kAvx2 };
+
+GfKernel select_kernel() noexcept {
+#if VEIL_HAS_GF_DISPATCH
+  const auto& features = crypto::get_cpu_features();
+  if (features.has_avx2) {
+    return GfKernel::kAvx2;
+  }
+  if (features.has_ssse3) {
+    return GfKernel::kSsse3;
+  }
+#endif
+  return GfKernel::kPortable;
+}
+
+const GfKernel kKernel = select_kernel();
+
+// Coefficient of source bit i in repair row j: a Cauchy matrix 1 / (x_j + y_i)
+// with x_j = j and y_i = kFecMaxRepairs + i, each column scaled by y_i so that
+// row 0 is all ones. Scaling columns keeps every square submatrix invertible.
+using CoefficientTable = std::array<std::array<std::uint8_t, kFecMaxSources>, kFecMaxRepairs>;
+
+CoefficientTable make_coefficients() {
+  CoefficientTable table{};
+  for (std::size_t j = 0; j < kFecMaxRepairs; ++j) {
+    for (std::size_t i = 0; i < kFecMaxSources; ++i) {
+      const auto y = static_cast<std::uint8_t>(kFecMaxRepairs + i);
+      table[j][i] = gf256_mul(y, gf256_inv(static_cast<std::uint8_t>(j ^ y)));
+    }
+  }
+  return table;
+}
+
+const CoefficientTable kCoefficients = make_coefficients();
+
+// Add c * symbol(plaintext) to a repair symbol, where the source symbol is the
+// 2-byte length followed by the plaintext. The repair symbol must be long enough.
+void add_source(std::vector<std::uint8_t>& symbol, std::span<const std::uint8_t> plaintext, std::uint8_t c) {
+  const std::array<std::uint8_t, 2> length{static_cast<std::uint8_t>(plaintext.size() >> 8),
+                                           static_cast<std::uint8_t>(plaintext.size() & 0xFF)};
+  std::span<std::uint8_t> out(symbol);
+  gf256_mul_add(out.first(2), length, c);
+  gf256_mul_add(out.subspan(2, plaintext.size()), plaintext, c);
+}
+
+// Invert a square matrix in place (Gauss-Jordan). Returns false if singular.
+bool invert(std::vector<std::vector<std::uint8_t>>& m) {
+  const std::size_t n = m.size();
+  std::vector<std::vector<std::uint8_t>> inv(n, std::vector<std::uint8_t>(n, 0));
+  for (std::size_t i = 0; i < n; ++i) {
+    inv[i][i] = 1;
+  }
+  for (std::size_t col = 0; col < n; ++col) {
+    std::size_t pivot = col;
+    while (pivot < n && m[pivot][col] == 0) {
+      ++pivot;
+    }
+    if (pivot == n) {
+      return false;
+    }
+    std::swap(m[pivot], m[col]);
+    std::swap(inv[pivot], inv[col]);
+    const std::uint8_t scale = gf256_inv(m[col][col]);
+    for (std::size_t k = 0; k < n; ++k) {
+      m[col][k] = gf256_mul(m[col][k], scale);
+      inv[col][k] = gf256_mul(inv[col][k], scale);
+    }
+    for (std::size_t row = 0; row < n; ++row) {
+      const std::uint8_t factor = m[row][col];
+      if (row == col || factor == 0) {
+        continue;
+      }
+      for (std::size_t k = 0; k < n; ++k) {
+        m[row][k] ^= gf256_mul(factor, m[col][k]);
+        inv[row][k] ^= gf256_mul(factor, inv[col][k]);
+      }
+    }
+  }
+  m = std::move(inv);
+  return true;
+}
+
+bool valid_shape(FecShape shape) {
+  return shape.source_count > 0 && shape.source_count <= kFecMaxSources && shape.repair_count > 0 &&
+         shape.repair_count <= kFecMaxRepairs;
+}
+
+}  // namespace
+
+// ============================================================================
+// GF(2^8) Arithmetic
+// ============================================================================
+
+std::uint8_t gf256_mul(std::uint8_t a, std::uint8_t b) noexcept {
+  if (a == 0 || b == 0) {
+    return 0;
+  }
+  return kGf.exp[static_cast<std::size_t>(kGf.log[a]) + kGf.log[b]];
+}
+
+std::uint8_t gf256_inv(std::uint8_t a) noexcept {
+  if (a == 0) {
+    return 0;
+  }
+  return kGf.exp[255U - kGf.log[a]];
+}
+
+void gf256_mul_add_portable(std::span<std::uint8_t> dst, std::span<const std::uint8_t> src,
+                            std::uint8_t c) noexcept {
+  if (c == 0) {
+    return;
+  }
+  const auto tables = make_nibble_tables(c);
+  mul_add_tail(dst.data(), src.data(), dst.size(), tables);
+}
+
+void gf256_mul_add(std::span<std::uint8_t> dst, std::span<const std::uint8_t> src, std::uint8_t c) noexcept {
+  if (c == 0) {
+    return;
+  }
+  const std::size_t n = dst.size();
+  if (c == 1) {
+    for (std::size_t i = 0; i < n; ++i) {
+      dst[i] ^= src[i];
+    }
+    return;
+  }
+  const auto tables = make_nibble_tables(c);
+  std::size_t done = 0;
+#if VEIL_HAS_GF_DISPATCH
+  if (kKernel == GfKernel::kAvx2) {
+    done = mul_add_avx2(dst.data(), src.data(), n, tables);
+  } else if (kKernel == GfKernel::kSsse3) {
+    done = mul_add_ssse3(dst.data(), src.data(), n, tables);
+  }
+#endif
+  mul_add_tail(dst.data() + done, src.data() + done, n - done, tables);
+}
+
+const char* gf256_kernel_name() noexcept {
+  switch (kKernel) {
+    case GfKernel::kAvx2:
+      return "AVX2";
+    case GfKernel::kSsse3:
+      return "SSSE3";
+    case GfKernel::kPortable:
+      break;
+  }
+  return "portable";
+}
+
+// ============================================================================
+// FecEncoder
+// ============================================================================
+
+void FecEncoder::set_shape(FecShape shape) {
+  if (!valid_shape(shape)) {
+    throw std::invalid_argument("FEC shape out of range");
+  }
+  shape_ = shape;
+}
+
+bool FecEncoder::accepts(std::uint64_t sequence) const {
+  return sources_ == 0 || (sequence >= first_sequence_ && sequence - first_sequence_ < kFecMaxSources);
+}
+
+bool FecEncoder::add(std::uint64_t sequence, std::span<const std::uint8_t> plaintext) {
+  if (sources_ == 0) {
+    group_shape_ = shape_;
+    first_sequence_ = sequence;
+    source_mask_ = 0;
+    repairs_.resize(group_shape_.repair_count);
+    for (auto& symbol : repairs_) {
+      symbol.clear();
+    }
+  }
+  const auto position = static_cast<std::size_t>(sequence - first_sequence_);
+  source_mask_ |= std::uint64_t{1} << position;
+  ++sources_;
+
+  const std::size_t symbol_size = plaintext.size() + 2;
+  for (std::size_t j = 0; j < repairs_.size(); ++j) {
+    if (repairs_[j].size() < symbol_size) {
+      repairs_[j].resize(symbol_size, 0);
+    }
+    add_source(repairs_[j], plaintext, kCoefficients[j][position]);
+  }
+  return sources_ >= group_shape_.source_count;
+}
+
+std::vector<MuxFrame> FecEncoder::finish() {
+  if (sources_ == 0) {
+    return {};
+  }
+  std::vector<MuxFrame> frames;
+  frames.reserve(repairs_.size());
+  for (std::size_t j = 0; j < repairs_.size(); ++j) {
+    frames.push_back(make_repair_frame(first_sequence_, source_mask_, group_shape_.repair_count,
+                                       static_cast<std::uint8_t>(j), std::move(repairs_[j])));
+    repairs_[j] = {};
+  }
+  sources_ = 0;
+  return frames;
+}
+
+// ============================================================================
+// FecDecoder
+// ============================================================================
+
+FecDecoder::FecDecoder(std::size_t history) : history_size_(history) {
+  if (history < kFecMaxSources) {
+    throw std::invalid_argument("FEC history must cover a group");
+  }
+}
+
+void FecDecoder::on_packet(std::uint64_t sequence, std::span<const std::uint8_t> plaintext) {
+  if (history_.empty()) {
+    history_.resize(history_size_);
+  }
+  auto& slot = history_[sequence % history_.size()];
+  slot.sequence = sequence;
+  slot.used = true;
+  slot.plaintext.assign(plaintext.begin(), plaintext.end());
+}
+
+const FecDecoder::Slot* FecDecoder::find(std::uint64_t sequence) const {
+  if (history_.empty()) {
+    return nullptr;
+  }
+  const auto& slot = history_[sequence % history_.size()];
+  return slot.used && slot.sequence == sequence ? &slot : nullptr;
+}
+
+std::vector<RecoveredPacket> FecDecoder::on_repair(const RepairFrame& repair) {
+  if ((repair.source_mask & 1U) == 0 || repair.repair_count == 0 || repair.repair_count > kFecMaxRepairs ||
+      repair.index >= repair.repair_count || repair.symbol.size() < 2) {
+    return {};
+  }
+
+  auto it = std::find_if(groups_.begin(), groups_.end(), [&](const Group& group) {
+    return group.first_sequence == repair.first_sequence && group.source_mask == repair.source_mask;
+  });
+  if (it == groups_.end()) {
+    Group fresh;
+    fresh.first_sequence = repair.first_sequence;
+    fresh.source_mask = repair.source_mask;
+    if (groups_.size() < kMaxGroups) {
+      groups_.push_back(std::move(fresh));
+      it = groups_.end() - 1;
+    } else {
+      groups_[next_group_] = std::move(fresh);
+      it = groups_.begin() + static_cast<std::ptrdiff_t>(next_group_);
+      next_group_ = (next_group_ + 1) % kMaxGroups;
+    }
+  }
+
+  Group& group = *it;
+  if (group.done || std::find(group.indices.begin(), group.indices.end(), repair.index) != group.indices.end()) {
+    return {};
+  }
+  if (!group.symbols.empty() && group.symbols.front().size() != repair.symbol.size()) {
+    return {};
+  }
+  group.indices.push_back(repair.index);
+  group.symbols.push_back(repair.symbol);
+  return rebuild(group);
+}
+
+std::vector<RecoveredPacket> FecDecoder::rebuild(Group& group) {
+  std::vector<std::size_t> missing;
+  for (std::size_t bit = 0; bit < kFecMaxSources; ++bit) {
+    if ((group.source_mask >> bit & 1U) != 0 && find(group.first_sequence + bit) == nullptr) {
+      missing.push_back(bit);
+    }
+  }
+  if (missing.empty()) {
+    group.done = true;
+    return {};
+  }
+  if (missing.size() > group.symbols.size()) {
+    return {};
+  }
+
+  // Take the known sources out of the first |missing| repair symbols, leaving
+  // A * missing_symbols = residual with A[a][b] = C[index_a][missing_b].
+  const std::size_t count = missing.size();
+  const std::size_t symbol_size = group.symbols.front().size();
+  std::vector<std::vector<std::uint8_t>> residual(group.symbols.begin(),
+                                                  group.symbols.begin() + static_cast<std::ptrdiff_t>(count));
+  for (std::size_t bit = 0; bit < kFecMaxSources; ++bit) {
+    if ((group.source_mask >> bit & 1U) == 0) {
+      continue;
+    }
+    const Slot* slot = find(group.first_sequence + bit);
+    if (slot == nullptr) {
+      continue;
+    }
+    if (slot->plaintext.size() + 2 > symbol_size) {
+      group.done = true;  // Inconsistent with the repair symbols.
+      return {};
+    }
+    for (std::size_t a = 0; a < count; ++a) {
+      add_source(residual[a], slot->plaintext, kCoefficients[group.indices[a]][bit]);
+    }
+  }
+
+  std::vector<std::vector<std::uint8_t>> matrix(count, std::vector<std::uint8_t>(count));
+  for (std::size_t a = 0; a < count; ++a) {
+    for (std::size_t b = 0; b < count; ++b) {
+      matrix[a][b] = kCoefficients[group.indices[a]][missing[b]];
+    }
+  }
+  group.done = true;
+  if (!invert(matrix)) {
+    return {};
+  }
+
+  std::vector<RecoveredPacket> recovered;
+  std::vector<std::uint8_t> symbol(symbol_size);
+  for (std::size_t b = 0; b < count; ++b) {
+    std::fill(symbol.begin(), symbol.end(), 0);
+    for (std::size_t a = 0; a < count; ++a) {
+      gf256_mul_add(symbol, residual[a], matrix[b][a]);
+    }
+    const std::size_t length = (static_cast<std::size_t>(symbol[0]) << 8) | symbol[1];
+    if (length + 2 > symbol_size) {
+      continue;
+    }
+    recovered.push_back(RecoveredPacket{
+        .sequence = group.first_sequence + missing[b],
+        .plaintext = std::vector<std::uint8_t>(symbol.begin() + 2,
+                                               symbol.begin() + 2 + static_cast<std::ptrdiff_t>(length))});
+  }
+  return recovered;
+}
+
+// ============================================================================
+// FecAdapter
+// ============================================================================
+
+FecAdapter::FecAdapter(FecConfig config) : config_(config) {
+  if (config_.adaptive) {
+    shape_ = kLadder[level_];
+    return;
+  }
+  shape_ = FecShape{config_.source_count, config_.repair_count};
+  if (!valid_shape(shape_)) {
+    throw std::invalid_argument("FEC shape out of range");
+  }
+}
+
+FecShape FecAdapter::update(std::uint64_t packets_sent, std::uint64_t packets_retransmitted) {
+  if (!config_.adaptive || packets_sent < last_sent_ + config_.adapt_interval) {
+    return shape_;
+  }
+  const auto sent = static_cast<double>(packets_sent - last_sent_);
+  const auto retransmitted = static_cast<double>(packets_retransmitted - last_retransmitted_);
+  last_sent_ = packets_sent;
+  last_retransmitted_ = packets_retransmitted;
+
+  const double loss = retransmitted / sent;
+  if (loss > config_.target_loss) {
+    quiet_intervals_ = 0;
+    if (level_ + 1 < kLadder.size()) {
+      ++level_;
+    }
+  } else if (loss < config_.target_loss / 4) {
+    // Repairs hide the loss they cover, so only step down after a sustained
+    // quiet period rather than oscillating between neighbouring shapes.
+    if (++quiet_intervals_ >= kQuietIntervals && level_ > 0) {
+      --level_;
+      quiet_intervals_ = 0;
+    }
+  } else {
+    quiet_intervals_ = 0;
+  }
+  shape_ = kLadder[level_];
+  return shape_;
+}
+
+}  // namespace veil::mux
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "transport/mux/frame.h"
+#include "transport/mux/mux_codec.h"
+
+namespace veil::mux {
+
+// ============================================================================
+// GF(2^8) Arithmetic
+// ============================================================================
+
+// Field GF(2^8) with polynomial x^8 + x^4 + x^3 + x^2 + 1 (0x11d).
+std::uint8_t gf256_mul(std::uint8_t a, std::uint8_t b) noexcept;
+
+// Multiplicative inverse. gf256_inv(0) returns 0.
+std::uint8_t gf256_inv(std::uint8_t a) noexcept;
+
+// dst[i] ^= c * src[i] for every i < dst.size(); src must be at least as long.
+// This is the inner loop of FEC encoding and decoding. With AVX2 (32 bytes per
+// step) or SSSE3 (16 bytes), selected at runtime, each byte is multiplied by
+// two PSHUFB lookups into 16-entry tables of c times its low and high nibble.
+void gf256_mul_add(std::span<std::uint8_t> dst, std::span<const std::uint8_t> src, std::uint8_t c) noexcept;
+
+// Portable implementation of gf256_mul_add() (tests, benchmarks).
+void gf256_mul_add_portable(std::span<std::uint8_t> dst, std::span<const std::uint8_t> src,
+                            std::uint8_t c) noexcept;
+
+// Kernel gf256_mul_add() uses on this CPU: "AVX2", "SSSE3" or "portable".
+const char* gf256_kernel_name() noexcept;
+
+// ============================================================================
+// Forward Error Correction
+// ============================================================================
+
+// Group limits: the repair frame's source mask has 64 bits.
+inline constexpr std::size_t kFecMaxSources = 64;
+inline constexpr std::size_t kFecMaxRepairs = 8;
+
+// Bytes a repair packet needs beyond the largest plaintext it protects: the
+// repair frame header and the length prefix of each symbol.
+inline constexpr std::size_t kFecRepairOverhead = MuxCodec::kRepairHeaderSize + 2;
+
+// Source packets per group and repair frames sent for each group.
+struct FecShape {
+  std::uint8_t source_count{0};
+  std::uint8_t repair_count{0};
+};
+
+// Configuration for forward error correction. FEC itself is negotiated in
+// the handshake (HandshakeSession::fec); this only tunes it.
+struct FecConfig {
+  // Pick the shape from observed loss (see FecAdapter); otherwise always use
+  // source_count and repair_count.
+  bool adaptive{true};
+  std::uint8_t source_count{8};
+  std::uint8_t repair_count{1};
+  // A group that has not filled up is closed after this long, so the last
+  // packets of a burst are protected as well.
+  std::chrono::milliseconds max_group_delay{5};
+  // Adaptive: share of data packets that may still need a retransmission.
+  double target_loss{0.002};
+  // Adaptive: data packets sent between adjustments.
+  std::uint32_t adapt_interval{256};
+};
+
+// A source packet rebuilt from repair frames.
+struct RecoveredPacket {
+  std::uint64_t sequence{0};
+  std::vector<std::uint8_t> plaintext;
+};
+
+/**
+ * Sender side of a systematic Reed-Solomon erasure code over the plaintext of
+ * data packets. Data packets go out unchanged; after each group the sender
+ * adds repair frames, from which the receiver rebuilds up to repair_count lost
+ * packets of the group without waiting for a retransmission.
+ *
+ * The symbol of a source packet is its plaintext length (2 bytes big-endian)
+ * followed by the plaintext, zero-padded to the longest symbol in the group.
+ * Repair symbol j is the sum over sources i of C[j][i] * symbol_i, where C is
+ * a Cauchy matrix (every square submatrix is invertible, so any repair_count
+ * losses can be rebuilt) scaled so that row 0 is all ones: with one repair
+ * frame per group the code is plain XOR parity. Column i belongs to the
+ * packet at bit i of the source mask.
+ *
+ * Repair symbols are accumulated as packets are added, so the encoder keeps
+ * no copies of the sources.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session.
+ */
+class FecEncoder {
+ public:
+  // Shape for the next group; the open group keeps its own.
+  // Throws std::invalid_argument if a count is zero or above the limits.
+  void set_shape(FecShape shape);
+  FecShape shape() const { return shape_; }
+
+  // True if the packet with this sequence can join the open group (always
+  // true when no group is open). Otherwise finish() the group first.
+  bool accepts(std::uint64_t sequence) const;
+
+  // Add the plaintext of a data packet. Returns true once the group is full
+  // and finish() should be called.
+  bool add(std::uint64_t sequence, std::span<const std::uint8_t> plaintext);
+
+  // Repair frames for the packets added since the last finish().
+  std::vector<MuxFrame> finish();
+
+  // Abandon the open group.
+  void clear() { sources_ = 0; }
+
+  bool empty() const { return sources_ == 0; }
+  std::size_t sources() const { return sources_; }
+
+ private:
+  FecShape shape_{8, 1};
+  FecShape group_shape_{};
+  std::uint64_t first_sequence_{0};
+  std::uint64_t source_mask_{0};
+  std::size_t sources_{0};
+  std::vector<std::vector<std::uint8_t>> repairs_;
+};
+
+/**
+ * Receiver side of FecEncoder. Keeps the plaintext of recent data packets
+ * and rebuilds the missing members of a group once it holds as many repair
+ * frames as the group has missing packets.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session.
+ */
+class FecDecoder {
+ public:
+  // history: received packets remembered as possible sources. Must cover the
+  // span of a group (kFecMaxSources); throws std::invalid_argument otherwise.
+  // The history is allocated on the first packet, so sessions that never
+  // receive under FEC do not pay for it.
+  explicit FecDecoder(std::size_t history = 256);
+
+  // Remember the plaintext of a received data packet.
+  void on_packet(std::uint64_t sequence, std::span<const std::uint8_t> plaintext);
+
+  // Take a repair frame. Returns the packets it completes, if any. Malformed
+  // frames and groups that cannot be rebuilt yet return nothing.
+  std::vector<RecoveredPacket> on_repair(const RepairFrame& repair);
+
+ private:
+  struct Slot {
+    std::uint64_t sequence{0};
+    bool used{false};
+    std::vector<std::uint8_t> plaintext;
+  };
+  struct Group {
+    std::uint64_t first_sequence{0};
+    std::uint64_t source_mask{0};
+    bool done{false};
+    std::vector<std::uint8_t> indices;
+    std::vector<std::vector<std::uint8_t>> symbols;
+  };
+
+  // Groups with repair frames but not yet rebuilt (or known complete).
+  static constexpr std::size_t kMaxGroups = 16;
+
+  const Slot* find(std::uint64_t sequence) const;
+  std::vector<RecoveredPacket> rebuild(Group& group);
+
+  std::size_t history_size_;
+  std::vector<Slot> history_;
+  std::vector<Group> groups_;
+  std::size_t next_group_{0};
+};
+
+/**
+ * Chooses the group shape from the loss the sender still sees: the share of
+ * data packets it had to retransmit (RetransmitStats). Repairs keep rebuilt
+ * packets out of that figure, so it is the loss FEC failed to cover. The
+ * adapter steps to a stronger shape while it exceeds target_loss and back to
+ * a cheaper one once it stays well below; the weakest step sends no repairs.
+ */
+class FecAdapter {
+ public:
+  // Shapes from cheapest to strongest, by repair overhead.
+  static constexpr std::array<FecShape, 6> kLadder{{{16, 0}, {16, 1}, {8, 1}, {8, 2}, {4, 2}, {4, 3}}};
+
+  // Throws std::invalid_argument if the fixed shape is out of range.
+  explicit FecAdapter(FecConfig config = {});
+
+  // Feed cumulative RetransmitStats counters. Returns the shape for the next group.
+  FecShape update(std::uint64_t packets_sent, std::uint64_t packets_retransmitted);
+
+  FecShape shape() const { return shape_; }
+  std::size_t level() const { return level_; }
+
+ private:
+  // Clean intervals required before stepping down.
+  static constexpr std::uint32_t kQuietIntervals = 4;
+
+  FecConfig config_;
+  std::size_t level_{1};
+  FecShape shape_;
+  std::uint64_t last_sent_{0};
+  std::uint64_t last_retransmitted_{0};
+  std::uint32_t quiet_intervals_{0};
+};
+
+}  // namespace veil::mux
@@ -10,8 +10,9 @@
 namespace veil::mux {
 
 FragmentReassembly::FragmentReassembly(std::size_t max_bytes,
-                                       std::chrono::milliseconds fragment_timeout)
-    : max_bytes_(max_bytes), fragment_timeout_(fragment_timeout) {}
+                                       std::chrono::milliseconds fragment_timeout,
+                                       FragmentPlacement placement)
+    : max_bytes_(max_bytes), fragment_timeout_(fragment_timeout), placement_(placement) {}
 
 bool FragmentReassembly::push(std::uint64_t message_id, Fragment fragment, TimePoint now) {
   auto& entry = state_[message_id];
@@ -52,7 +53,7 @@ std::optional<std::vector<std::uint8_t>> FragmentReassembly::try_reassemble(
       return std::nullopt;
     }
     assembled += frag.data.size();
-    expected_offset += frag.data.size();
+    expected_offset += placement_ == FragmentPlacement::kIndex ? 1 : frag.data.size();
   }
 
   std::vector<std::uint8_t> output;
@@ -9,11 +9,17 @@
 namespace veil::mux {
 
 struct Fragment {
+  // Byte offset in the message, or the fragment's index with
+  // FragmentPlacement::kIndex.
   std::uint16_t offset{0};
   std::vector<std::uint8_t> data;
   bool last{false};
 };
 
+// How Fragment::offset places a fragment. kIndex lets the sender choose the
+// fragment size (e.g. to follow the path MTU) without telling the receiver.
+enum class FragmentPlacement { kByteOffset, kIndex };
+
 class FragmentReassembly {
  public:
   using Clock = std::chrono::steady_clock;
@@ -21,7 +27,8 @@ class FragmentReassembly {
 
   explicit FragmentReassembly(std::size_t max_bytes = 1 << 20,
                               std::chrono::milliseconds fragment_timeout =
-                                  std::chrono::milliseconds(5000));
+                                  std::chrono::milliseconds(5000),
+                              FragmentPlacement placement = FragmentPlacement::kByteOffset);
 
   bool push(std::uint64_t message_id, Fragment fragment,
             TimePoint now = Clock::now());
@@ -53,6 +60,7 @@ class FragmentReassembly {
 
   std::size_t max_bytes_;
   std::chrono::milliseconds fragment_timeout_;
+  FragmentPlacement placement_;
   std::map<std::uint64_t, State> state_;
 };
 
@@ -18,6 +18,16 @@ struct AckFrame {
   std::uint64_t stream_id{0};
   std::uint64_t ack{0};
   std::uint32_t bitmap{0};
+  // How long the receiver held the ACK after packet `ack` arrived, so the
+  // sender can take it out of its RTT sample. Only the compact encoding
+  // carries it; zero otherwise.
+  std::chrono::microseconds ack_delay{0};
+};
+
+// Control frame types carried in ControlFrame::type.
+enum class ControlType : std::uint8_t {
+  kSessionTicket = 1,  // Server -> client: session ticket for 0-RTT resumption (Issue #86).
+  kAckFrequency = 2,   // Either way: ACK frequency the sender wants (see mux::AckFrequency).
 };
 
 struct ControlFrame {
@@ -32,7 +42,18 @@ struct HeartbeatFrame {
   std::vector<std::uint8_t> payload;  // Optional fake telemetry data.
 };
 
-enum class FrameKind : std::uint8_t { kData = 1, kAck = 2, kControl = 3, kHeartbeat = 4 };
+// Forward error correction repair symbol for a group of data packets (see
+// transport/mux/fec.h). Bit i of source_mask marks packet first_sequence + i
+// as a member of the group.
+struct RepairFrame {
+  std::uint64_t first_sequence{0};
+  std::uint64_t source_mask{0};
+  std::uint8_t repair_count{0};  // Repair symbols sent for the group.
+  std::uint8_t index{0};         // Which of them this is.
+  std::vector<std::uint8_t> symbol;
+};
+
+enum class FrameKind : std::uint8_t { kData = 1, kAck = 2, kControl = 3, kHeartbeat = 4, kRepair = 5 };
 
 struct MuxFrame {
   FrameKind kind{};
@@ -40,6 +61,7 @@ struct MuxFrame {
   AckFrame ack;
   ControlFrame control;
   HeartbeatFrame heartbeat;
+  RepairFrame repair;
 };
 
 // PERFORMANCE (Issue #97): Zero-copy frame structures using span views.
@@ -64,6 +86,14 @@ struct HeartbeatFrameView {
   std::span<const std::uint8_t> payload;  // View into source buffer (no copy)
 };
 
+struct RepairFrameView {
+  std::uint64_t first_sequence{0};
+  std::uint64_t source_mask{0};
+  std::uint8_t repair_count{0};
+  std::uint8_t index{0};
+  std::span<const std::uint8_t> symbol;  // View into source buffer (no copy)
+};
+
 // Zero-copy frame that holds views into the source buffer.
 // IMPORTANT: The source buffer must outlive this frame view.
 struct MuxFrameView {
@@ -72,6 +102,7 @@ struct MuxFrameView {
   AckFrame ack;  // ACK frames have no payload, so no view needed
   ControlFrameView control;
   HeartbeatFrameView heartbeat;
+  RepairFrameView repair;
 };
 
 }  // namespace veil::mux
@@ -83,6 +83,15 @@ std::vector<std::uint8_t> MuxCodec::encode(const MuxFrame& frame) {
       out.insert(out.end(), frame.heartbeat.payload.begin(), frame.heartbeat.payload.end());
       break;
     }
+    case FrameKind::kRepair: {
+      write_u64(out, frame.repair.first_sequence);
+      write_u64(out, frame.repair.source_mask);
+      out.push_back(frame.repair.repair_count);
+      out.push_back(frame.repair.index);
+      write_u16(out, static_cast<std::uint16_t>(frame.repair.symbol.size()));
+      out.insert(out.end(), frame.repair.symbol.begin(), frame.repair.symbol.end());
+      break;
+    }
   }
 
   return out;
@@ -147,6 +156,21 @@ std::optional<MuxFrame> MuxCodec::decode(std::span<const std::uint8_t> data) {
       frame.heartbeat.payload.assign(data.begin() + kHeartbeatHeaderSize, data.end());
       break;
     }
+    case FrameKind::kRepair: {
+      if (data.size() < kRepairHeaderSize) {
+        return std::nullopt;
+      }
+      frame.repair.first_sequence = read_u64(data, 1);
+      frame.repair.source_mask = read_u64(data, 9);
+      frame.repair.repair_count = data[17];
+      frame.repair.index = data[18];
+      std::uint16_t symbol_len = read_u16(data, 19);
+      if (data.size() != kRepairHeaderSize + symbol_len) {
+        return std::nullopt;
+      }
+      frame.repair.symbol.assign(data.begin() + kRepairHeaderSize, data.end());
+      break;
+    }
     default:
       return std::nullopt;
   }
@@ -164,6 +188,8 @@ std::size_t MuxCodec::encoded_size(const MuxFrame& frame) {
       return kControlHeaderSize + frame.control.payload.size();
     case FrameKind::kHeartbeat:
       return kHeartbeatHeaderSize + frame.heartbeat.payload.size();
+    case FrameKind::kRepair:
+      return kRepairHeaderSize + frame.repair.symbol.size();
   }
   return 0;
 }
@@ -179,12 +205,14 @@ MuxFrame make_data_frame(std::uint64_t stream_id, std::uint64_t sequence, bool f
   return frame;
 }
 
-MuxFrame make_ack_frame(std::uint64_t stream_id, std::uint64_t ack, std::uint32_t bitmap) {
+MuxFrame make_ack_frame(std::uint64_t stream_id, std::uint64_t ack, std::uint32_t bitmap,
+                        std::chrono::microseconds ack_delay) {
   MuxFrame frame{};
   frame.kind = FrameKind::kAck;
   frame.ack.stream_id = stream_id;
   frame.ack.ack = ack;
   frame.ack.bitmap = bitmap;
+  frame.ack.ack_delay = ack_delay;
   return frame;
 }
 
@@ -206,6 +234,18 @@ MuxFrame make_heartbeat_frame(std::uint64_t timestamp, std::uint64_t sequence,
   return frame;
 }
 
+MuxFrame make_repair_frame(std::uint64_t first_sequence, std::uint64_t source_mask, std::uint8_t repair_count,
+                           std::uint8_t index, std::vector<std::uint8_t> symbol) {
+  MuxFrame frame{};
+  frame.kind = FrameKind::kRepair;
+  frame.repair.first_sequence = first_sequence;
+  frame.repair.source_mask = source_mask;
+  frame.repair.repair_count = repair_count;
+  frame.repair.index = index;
+  frame.repair.symbol = std::move(symbol);
+  return frame;
+}
+
 // PERFORMANCE (Issue #97): Zero-copy encode/decode implementations.
 
 namespace {
@@ -282,6 +322,19 @@ std::size_t MuxCodec::encode_to(const MuxFrame& frame, std::span<std::uint8_t> o
       pos += frame.heartbeat.payload.size();
       break;
     }
+    case FrameKind::kRepair: {
+      write_u64_at(output, pos, frame.repair.first_sequence);
+      pos += 8;
+      write_u64_at(output, pos, frame.repair.source_mask);
+      pos += 8;
+      output[pos++] = frame.repair.repair_count;
+      output[pos++] = frame.repair.index;
+      write_u16_at(output, pos, static_cast<std::uint16_t>(frame.repair.symbol.size()));
+      pos += 2;
+      std::copy(frame.repair.symbol.begin(), frame.repair.symbol.end(), output.begin() + static_cast<std::ptrdiff_t>(pos));
+      pos += frame.repair.symbol.size();
+      break;
+    }
   }
 
   return pos;
@@ -349,6 +402,22 @@ std::optional<MuxFrameView> MuxCodec::decode_view(std::span<const std::uint8_t>
       frame.heartbeat.payload = data.subspan(kHeartbeatHeaderSize, payload_len);
       break;
     }
+    case FrameKind::kRepair: {
+      if (data.size() < kRepairHeaderSize) {
+        return std::nullopt;
+      }
+      frame.repair.first_sequence = read_u64(data, 1);
+      frame.repair.source_mask = read_u64(data, 9);
+      frame.repair.repair_count = data[17];
+      frame.repair.index = data[18];
+      std::uint16_t symbol_len = read_u16(data, 19);
+      if (data.size() != kRepairHeaderSize + symbol_len) {
+        return std::nullopt;
+      }
+      // Zero-copy: create a span view into the source buffer
+      frame.repair.symbol = data.subspan(kRepairHeaderSize, symbol_len);
+      break;
+    }
     default:
       return std::nullopt;
   }
@@ -366,6 +435,8 @@ std::size_t MuxCodec::encoded_size_view(const MuxFrameView& frame) {
       return kControlHeaderSize + frame.control.payload.size();
     case FrameKind::kHeartbeat:
       return kHeartbeatHeaderSize + frame.heartbeat.payload.size();
+    case FrameKind::kRepair:
+      return kRepairHeaderSize + frame.repair.symbol.size();
   }
   return 0;
 }
@@ -420,9 +491,401 @@ std::size_t MuxCodec::encode_view_to(const MuxFrameView& frame, std::span<std::u
       pos += frame.heartbeat.payload.size();
       break;
     }
+    case FrameKind::kRepair: {
+      write_u64_at(output, pos, frame.repair.first_sequence);
+      pos += 8;
+      write_u64_at(output, pos, frame.repair.source_mask);
+      pos += 8;
+      output[pos++] = frame.repair.repair_count;
+      output[pos++] = frame.repair.index;
+      write_u16_at(output, pos, static_cast<std::uint16_t>(frame.repair.symbol.size()));
+      pos += 2;
+      std::copy(frame.repair.symbol.begin(), frame.repair.symbol.end(), output.begin() + static_cast<std::ptrdiff_t>(pos));
+      pos += frame.repair.symbol.size();
+      break;
+    }
   }
 
   return pos;
 }
 
+// Compact frame format.
+
+namespace {
+
+constexpr std::uint8_t kCompactDataType = 0x80;
+constexpr std::uint8_t kCompactAckType = 0xC0;
+constexpr std::uint8_t kCompactTypeMask = 0xC0;
+
+// DATA flags.
+constexpr std::uint8_t kCompactFin = 0x01;
+constexpr std::uint8_t kCompactDataStream = 0x02;
+constexpr std::uint8_t kCompactFragment = 0x04;
+constexpr unsigned kCompactNumberShift = 3;
+constexpr std::uint8_t kCompactNumberMask = 0x18;
+constexpr std::uint8_t kCompactLength = 0x20;
+
+// ACK flags.
+constexpr std::uint8_t kCompactAckStream = 0x01;
+constexpr std::uint8_t kCompactAckBitmap = 0x02;
+constexpr std::uint8_t kCompactAckDelay = 0x04;
+
+constexpr std::uint64_t kFragmentThreshold = 0xFFFFFFFFULL;
+// Upper bound on a decoded ACK delay (one hour), so it fits any duration arithmetic.
+constexpr std::uint64_t kMaxAckDelayUs = 3'600'000'000ULL;
+
+std::size_t varint_size(std::uint64_t value) {
+  std::size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+std::size_t write_varint_at(std::span<std::uint8_t> out, std::size_t offset, std::uint64_t value) {
+  std::size_t pos = offset;
+  while (value >= 0x80) {
+    out[pos++] = static_cast<std::uint8_t>((value & 0x7F) | 0x80);
+    value >>= 7;
+  }
+  out[pos++] = static_cast<std::uint8_t>(value);
+  return pos - offset;
+}
+
+// Returns false on truncated or overlong input.
+bool read_varint(std::span<const std::uint8_t> data, std::size_t& offset, std::uint64_t& value) {
+  value = 0;
+  for (unsigned shift = 0; shift < 64; shift += 7) {
+    if (offset >= data.size()) {
+      return false;
+    }
+    const std::uint8_t byte = data[offset++];
+    value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Value with the given low bytes that is closest to `reference`.
+std::uint64_t expand_truncated(std::uint64_t truncated, std::size_t length, std::uint64_t reference) {
+  if (length >= 8) {
+    return truncated;
+  }
+  const std::uint64_t window = 1ULL << (8 * length);
+  const std::uint64_t half = window / 2;
+  const std::uint64_t candidate = (reference & ~(window - 1)) | truncated;
+  if (candidate + half <= reference && candidate <= UINT64_MAX - window) {
+    return candidate + window;
+  }
+  if (candidate > reference + half && candidate >= window) {
+    return candidate - window;
+  }
+  return candidate;
+}
+
+// Smallest length code (0-3 for 1, 2, 4, 8 bytes) from which the receiver
+// recovers `number` given the packet sequence.
+unsigned number_length_code(std::uint64_t number, std::uint64_t packet_sequence) {
+  for (unsigned code = 0; code < 3; ++code) {
+    const std::size_t length = std::size_t{1} << code;
+    const std::uint64_t mask = (1ULL << (8 * length)) - 1;
+    if (expand_truncated(number & mask, length, packet_sequence) == number) {
+      return code;
+    }
+  }
+  return 3;
+}
+
+struct CompactDataLayout {
+  std::uint8_t type{0};
+  std::uint64_t number{0};
+  std::size_t number_length{0};
+  std::uint64_t fragment_index{0};
+  std::size_t header_size{0};
+};
+
+CompactDataLayout compact_data_layout(std::uint64_t stream_id, std::uint64_t sequence, bool fin,
+                                      std::size_t payload_size, std::uint64_t packet_sequence, bool last) {
+  CompactDataLayout layout;
+  layout.type = kCompactDataType;
+  std::size_t size = 1;
+  if (fin) {
+    layout.type |= kCompactFin;
+  }
+  if (stream_id != 0) {
+    layout.type |= kCompactDataStream;
+    size += varint_size(stream_id);
+  }
+  if (sequence > kFragmentThreshold) {
+    layout.type |= kCompactFragment;
+    layout.number = sequence >> 32;
+    layout.fragment_index = sequence & kFragmentThreshold;
+    size += varint_size(layout.fragment_index);
+  } else {
+    layout.number = sequence;
+  }
+  const unsigned code = number_length_code(layout.number, packet_sequence);
+  layout.type |= static_cast<std::uint8_t>(code << kCompactNumberShift);
+  layout.number_length = std::size_t{1} << code;
+  size += layout.number_length;
+  if (!last) {
+    layout.type |= kCompactLength;
+    size += varint_size(payload_size);
+  }
+  layout.header_size = size;
+  return layout;
+}
+
+std::size_t compact_ack_size(const AckFrame& ack) {
+  std::size_t size = 1 + varint_size(ack.ack);
+  if (ack.stream_id != 0) {
+    size += varint_size(ack.stream_id);
+  }
+  if (ack.bitmap != 0) {
+    size += 4;
+  }
+  if (ack.ack_delay.count() > 0) {
+    size += varint_size(static_cast<std::uint64_t>(ack.ack_delay.count()));
+  }
+  return size;
+}
+
+// Size of a legacy-format frame at the start of `data`, or 0 if truncated or
+// unknown. Used to find frame boundaries in a compact packet.
+std::size_t legacy_frame_size(std::span<const std::uint8_t> data) {
+  switch (static_cast<FrameKind>(data[0])) {
+    case FrameKind::kData:
+      return data.size() < MuxCodec::kDataHeaderSize ? 0 : MuxCodec::kDataHeaderSize + read_u16(data, 18);
+    case FrameKind::kAck:
+      return MuxCodec::kAckSize;
+    case FrameKind::kControl:
+      return data.size() < MuxCodec::kControlHeaderSize ? 0 : MuxCodec::kControlHeaderSize + read_u16(data, 2);
+    case FrameKind::kHeartbeat:
+      return data.size() < MuxCodec::kHeartbeatHeaderSize ? 0
+                                                           : MuxCodec::kHeartbeatHeaderSize + read_u16(data, 17);
+    case FrameKind::kRepair:
+      return data.size() < MuxCodec::kRepairHeaderSize ? 0 : MuxCodec::kRepairHeaderSize + read_u16(data, 19);
+  }
+  return 0;
+}
+
+}  // namespace
+
+std::size_t MuxCodec::compact_encoded_size(const MuxFrame& frame, std::uint64_t packet_sequence, bool last) {
+  switch (frame.kind) {
+    case FrameKind::kData:
+      return compact_data_layout(frame.data.stream_id, frame.data.sequence, frame.data.fin,
+                                 frame.data.payload.size(), packet_sequence, last)
+                 .header_size +
+             frame.data.payload.size();
+    case FrameKind::kAck:
+      return compact_ack_size(frame.ack);
+    case FrameKind::kControl:
+    case FrameKind::kHeartbeat:
+    case FrameKind::kRepair:
+      return encoded_size(frame);
+  }
+  return 0;
+}
+
+std::size_t MuxCodec::encode_compact_to(const MuxFrame& frame, std::uint64_t packet_sequence, bool last,
+                                        std::span<std::uint8_t> output) {
+  switch (frame.kind) {
+    case FrameKind::kData: {
+      const auto& data = frame.data;
+      const auto layout = compact_data_layout(data.stream_id, data.sequence, data.fin, data.payload.size(),
+                                              packet_sequence, last);
+      if (output.size() < layout.header_size + data.payload.size()) {
+        return 0;  // Buffer too small
+      }
+      std::size_t pos = 0;
+      output[pos++] = layout.type;
+      if ((layout.type & kCompactDataStream) != 0) {
+        pos += write_varint_at(output, pos, data.stream_id);
+      }
+      for (std::size_t i = layout.number_length; i > 0; --i) {
+        output[pos++] = static_cast<std::uint8_t>((layout.number >> (8 * (i - 1))) & 0xFF);
+      }
+      if ((layout.type & kCompactFragment) != 0) {
+        pos += write_varint_at(output, pos, layout.fragment_index);
+      }
+      if ((layout.type & kCompactLength) != 0) {
+        pos += write_varint_at(output, pos, data.payload.size());
+      }
+      std::copy(data.payload.begin(), data.payload.end(), output.begin() + static_cast<std::ptrdiff_t>(pos));
+      return pos + data.payload.size();
+    }
+    case FrameKind::kAck: {
+      const auto& ack = frame.ack;
+      if (output.size() < compact_ack_size(ack)) {
+        return 0;  // Buffer too small
+      }
+      std::size_t pos = 0;
+      std::uint8_t type = kCompactAckType;
+      if (ack.stream_id != 0) {
+        type |= kCompactAckStream;
+      }
+      if (ack.bitmap != 0) {
+        type |= kCompactAckBitmap;
+      }
+      if (ack.ack_delay.count() > 0) {
+        type |= kCompactAckDelay;
+      }
+      output[pos++] = type;
+      if (ack.stream_id != 0) {
+        pos += write_varint_at(output, pos, ack.stream_id);
+      }
+      pos += write_varint_at(output, pos, ack.ack);
+      if (ack.bitmap != 0) {
+        write_u32_at(output, pos, ack.bitmap);
+        pos += 4;
+      }
+      if (ack.ack_delay.count() > 0) {
+        pos += write_varint_at(output, pos, static_cast<std::uint64_t>(ack.ack_delay.count()));
+      }
+      return pos;
+    }
+    case FrameKind::kControl:
+    case FrameKind::kHeartbeat:
+    case FrameKind::kRepair:
+      return encode_to(frame, output);
+  }
+  return 0;
+}
+
+std::vector<std::uint8_t> MuxCodec::encode_compact(const MuxFrame& frame, std::uint64_t packet_sequence,
+                                                   bool last) {
+  std::vector<std::uint8_t> out(compact_encoded_size(frame, packet_sequence, last));
+  const std::size_t written = encode_compact_to(frame, packet_sequence, last, out);
+  out.resize(written);
+  return out;
+}
+
+std::optional<MuxFrameView> MuxCodec::decode_compact_view(std::span<const std::uint8_t> data,
+                                                          std::uint64_t packet_sequence, std::size_t& consumed) {
+  if (data.empty()) {
+    return std::nullopt;
+  }
+
+  const std::uint8_t type = data[0];
+  if ((type & 0x80) == 0) {
+    const std::size_t size = legacy_frame_size(data);
+    if (size == 0 || size > data.size()) {
+      return std::nullopt;
+    }
+    auto frame = decode_view(data.first(size));
+    if (frame) {
+      consumed = size;
+    }
+    return frame;
+  }
+
+  MuxFrameView frame{};
+  std::size_t pos = 1;
+  if ((type & kCompactTypeMask) == kCompactAckType) {
+    frame.kind = FrameKind::kAck;
+    if ((type & kCompactAckStream) != 0 && !read_varint(data, pos, frame.ack.stream_id)) {
+      return std::nullopt;
+    }
+    if (!read_varint(data, pos, frame.ack.ack)) {
+      return std::nullopt;
+    }
+    if ((type & kCompactAckBitmap) != 0) {
+      if (data.size() < pos + 4) {
+        return std::nullopt;
+      }
+      frame.ack.bitmap = read_u32(data, pos);
+      pos += 4;
+    }
+    if ((type & kCompactAckDelay) != 0) {
+      std::uint64_t delay_us = 0;
+      if (!read_varint(data, pos, delay_us) || delay_us > kMaxAckDelayUs) {
+        return std::nullopt;
+      }
+      frame.ack.ack_delay = std::chrono::microseconds(static_cast<std::chrono::microseconds::rep>(delay_us));
+    }
+    consumed = pos;
+    return frame;
+  }
+
+  // DATA. The ACK check above covers 0xC0-0xFF, so bit 6 is clear here.
+  frame.kind = FrameKind::kData;
+  frame.data.fin = (type & kCompactFin) != 0;
+  if ((type & kCompactDataStream) != 0 && !read_varint(data, pos, frame.data.stream_id)) {
+    return std::nullopt;
+  }
+  const std::size_t number_length = std::size_t{1} << ((type & kCompactNumberMask) >> kCompactNumberShift);
+  if (data.size() < pos + number_length) {
+    return std::nullopt;
+  }
+  std::uint64_t truncated = 0;
+  for (std::size_t i = 0; i < number_length; ++i) {
+    truncated = (truncated << 8) | data[pos++];
+  }
+  const std::uint64_t number = expand_truncated(truncated, number_length, packet_sequence);
+  if ((type & kCompactFragment) != 0) {
+    std::uint64_t fragment_index = 0;
+    if (!read_varint(data, pos, fragment_index) || fragment_index > kFragmentThreshold || number == 0 ||
+        number > kFragmentThreshold) {
+      return std::nullopt;
+    }
+    frame.data.sequence = (number << 32) | fragment_index;
+  } else {
+    frame.data.sequence = number;
+  }
+  std::uint64_t payload_len = data.size() - pos;
+  if ((type & kCompactLength) != 0) {
+    if (!read_varint(data, pos, payload_len) || payload_len > data.size() - pos) {
+      return std::nullopt;
+    }
+  }
+  if (payload_len > kMaxPayloadSize) {
+    return std::nullopt;
+  }
+  frame.data.payload = data.subspan(pos, static_cast<std::size_t>(payload_len));
+  consumed = pos + static_cast<std::size_t>(payload_len);
+  return frame;
+}
+
+std::optional<MuxFrame> MuxCodec::decode_compact(std::span<const std::uint8_t> data, std::uint64_t packet_sequence,
+                                                 std::size_t& consumed) {
+  auto view = decode_compact_view(data, packet_sequence, consumed);
+  if (!view) {
+    return std::nullopt;
+  }
+  MuxFrame frame{};
+  frame.kind = view->kind;
+  switch (view->kind) {
+    case FrameKind::kData:
+      frame.data.stream_id = view->data.stream_id;
+      frame.data.sequence = view->data.sequence;
+      frame.data.fin = view->data.fin;
+      frame.data.payload.assign(view->data.payload.begin(), view->data.payload.end());
+      break;
+    case FrameKind::kAck:
+      frame.ack = view->ack;
+      break;
+    case FrameKind::kControl:
+      frame.control.type = view->control.type;
+      frame.control.payload.assign(view->control.payload.begin(), view->control.payload.end());
+      break;
+    case FrameKind::kHeartbeat:
+      frame.heartbeat.timestamp = view->heartbeat.timestamp;
+      frame.heartbeat.sequence = view->heartbeat.sequence;
+      frame.heartbeat.payload.assign(view->heartbeat.payload.begin(), view->heartbeat.payload.end());
+      break;
+    case FrameKind::kRepair:
+      frame.repair.first_sequence = view->repair.first_sequence;
+      frame.repair.source_mask = view->repair.source_mask;
+      frame.repair.repair_count = view->repair.repair_count;
+      frame.repair.index = view->repair.index;
+      frame.repair.symbol.assign(view->repair.symbol.begin(), view->repair.symbol.end());
+      break;
+  }
+  return frame;
+}
+
 }  // namespace veil::mux
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <optional>
 #include <span>
@@ -9,6 +10,10 @@
 
 namespace veil::mux {
 
+// Frame encodings. kLegacy is the fixed-width format below; kCompact is
+// negotiated in the handshake and only used when both peers support it.
+enum class FrameFormat : std::uint8_t { kLegacy = 0, kCompact = 1 };
+
 // Serializes and parses MuxFrame structures for wire transmission.
 // Wire format:
 //   [kind: 1 byte]
@@ -31,6 +36,13 @@ namespace veil::mux {
 //     [sequence: 8 bytes big-endian]
 //     [payload_len: 2 bytes big-endian]
 //     [payload: payload_len bytes]
+//   For kRepair:
+//     [first_sequence: 8 bytes big-endian]
+//     [source_mask: 8 bytes big-endian]
+//     [repair_count: 1 byte]
+//     [index: 1 byte]
+//     [symbol_len: 2 bytes big-endian]
+//     [symbol: symbol_len bytes]
 
 class MuxCodec {
  public:
@@ -60,23 +72,77 @@ class MuxCodec {
   // Encode a frame view into a pre-allocated buffer.
   static std::size_t encode_view_to(const MuxFrameView& frame, std::span<std::uint8_t> output);
 
+  // Compact format (FrameFormat::kCompact). A first byte below 0x80 is a
+  // frame in the legacy encoding above (used for CONTROL, HEARTBEAT and REPAIR).
+  //   DATA:
+  //     [type: 1 byte] 0x80 | flags
+  //       bit 0 = FIN, bit 1 = stream ID present (otherwise stream 0),
+  //       bit 2 = fragment, bits 3-4 = message number length (1, 2, 4, 8 bytes),
+  //       bit 5 = payload length present (otherwise the payload runs to the
+  //       end of the packet)
+  //     [stream_id: varint, if present]
+  //     [message number: 1-8 bytes big-endian, truncated]
+  //     [fragment index: varint, if fragment]
+  //     [payload_len: varint, if present]
+  //     [payload]
+  //   ACK:
+  //     [type: 1 byte] 0xC0 | flags
+  //       bit 0 = stream ID present, bit 1 = bitmap present (otherwise 0),
+  //       bit 2 = ACK delay present (otherwise 0; only sent to peers that
+  //       negotiated handshake::kFeatureAckDelay)
+  //     [stream_id: varint, if present]
+  //     [ack: varint]
+  //     [bitmap: 4 bytes big-endian, if present]
+  //     [ack_delay: varint microseconds, if present]
+  // Varints are LEB128. The message number is the DATA sequence, or for a
+  // fragment (sequence > 32 bits) the message ID in its upper half. Only its
+  // low bytes are sent; the receiver picks the value closest to the packet
+  // sequence number from the packet header, and the sender uses enough bytes
+  // to make that unambiguous. A frame that is last in its packet omits the
+  // payload length.
+
+  // Size of the compact encoding of a frame sent in packet `packet_sequence`.
+  static std::size_t compact_encoded_size(const MuxFrame& frame, std::uint64_t packet_sequence, bool last);
+
+  // Encode in the compact format. Returns the number of bytes written, or 0
+  // if the buffer is too small.
+  static std::size_t encode_compact_to(const MuxFrame& frame, std::uint64_t packet_sequence, bool last,
+                                       std::span<std::uint8_t> output);
+  static std::vector<std::uint8_t> encode_compact(const MuxFrame& frame, std::uint64_t packet_sequence,
+                                                  bool last);
+
+  // Decode one compact-format frame from the start of `data`. On success,
+  // `consumed` is the number of bytes the frame occupied.
+  static std::optional<MuxFrameView> decode_compact_view(std::span<const std::uint8_t> data,
+                                                         std::uint64_t packet_sequence, std::size_t& consumed);
+  static std::optional<MuxFrame> decode_compact(std::span<const std::uint8_t> data, std::uint64_t packet_sequence,
+                                                std::size_t& consumed);
+
   // Minimum sizes for each frame type header (excluding payload).
   static constexpr std::size_t kDataHeaderSize = 1 + 8 + 8 + 1 + 2;    // 20 bytes
   static constexpr std::size_t kAckSize = 1 + 8 + 8 + 4;               // 21 bytes
   static constexpr std::size_t kControlHeaderSize = 1 + 1 + 2;         // 4 bytes
   static constexpr std::size_t kHeartbeatHeaderSize = 1 + 8 + 8 + 2;   // 19 bytes
+  static constexpr std::size_t kRepairHeaderSize = 1 + 8 + 8 + 1 + 1 + 2;  // 21 bytes
   static constexpr std::size_t kMaxPayloadSize = 65535;
+  // Largest compact DATA header: type, 10-byte stream ID varint, 8-byte
+  // message number, 5-byte fragment index varint, 3-byte length varint.
+  static constexpr std::size_t kCompactDataMaxHeaderSize = 1 + 10 + 8 + 5 + 3;
 };
 
 // Helper to create common frame types.
 MuxFrame make_data_frame(std::uint64_t stream_id, std::uint64_t sequence, bool fin,
                          std::vector<std::uint8_t> payload);
 
-MuxFrame make_ack_frame(std::uint64_t stream_id, std::uint64_t ack, std::uint32_t bitmap);
+MuxFrame make_ack_frame(std::uint64_t stream_id, std::uint64_t ack, std::uint32_t bitmap,
+                        std::chrono::microseconds ack_delay = {});
 
 MuxFrame make_control_frame(std::uint8_t type, std::vector<std::uint8_t> payload);
 
 MuxFrame make_heartbeat_frame(std::uint64_t timestamp, std::uint64_t sequence,
                                std::vector<std::uint8_t> payload = {});
 
+MuxFrame make_repair_frame(std::uint64_t first_sequence, std::uint64_t source_mask, std::uint8_t repair_count,
+                           std::uint8_t index, std::vector<std::uint8_t> symbol);
+
 }  // namespace veil::mux
@@ -85,7 +85,7 @@ bool RetransmitBuffer::insert_with_priority(std::uint64_t sequence, std::vector<
   return true;
 }
 
-bool RetransmitBuffer::acknowledge(std::uint64_t sequence) {
+bool RetransmitBuffer::acknowledge(std::uint64_t sequence, std::chrono::microseconds ack_delay) {
   auto it = pending_.find(sequence);
   if (it == pending_.end()) {
     return false;
@@ -95,8 +95,8 @@ bool RetransmitBuffer::acknowledge(std::uint64_t sequence) {
   // Only update RTT if this wasn't retransmitted (Karn's algorithm).
   if (pkt.retry_count == 0) {
     const auto now = now_fn_();
-    const auto rtt_sample = std::chrono::duration_cast<std::chrono::milliseconds>(now - pkt.first_sent);
-    update_rtt(rtt_sample);
+    const auto rtt_sample = std::chrono::duration_cast<std::chrono::microseconds>(now - pkt.first_sent);
+    update_rtt(rtt_sample, ack_delay);
   }
 
   buffered_bytes_ -= pkt.data.size();
@@ -105,6 +105,17 @@ bool RetransmitBuffer::acknowledge(std::uint64_t sequence) {
   return true;
 }
 
+bool RetransmitBuffer::acknowledge_without_sample(std::uint64_t sequence) {
+  auto it = pending_.find(sequence);
+  if (it == pending_.end()) {
+    return false;
+  }
+  buffered_bytes_ -= it->second.data.size();
+  ++stats_.packets_acked;
+  pending_.erase(it);
+  return true;
+}
+
 void RetransmitBuffer::acknowledge_cumulative(std::uint64_t sequence) {
   // Issue #96: With unordered_map, we need to iterate all entries and check sequence.
   // This is still efficient because cumulative ACKs typically acknowledge many packets
@@ -130,15 +141,8 @@ void RetransmitBuffer::acknowledge_cumulative(std::uint64_t sequence) {
   // Iterate and erase entries with sequence <= ack sequence.
   for (auto it = pending_.begin(); it != pending_.end();) {
     if (it->first <= sequence) {
-      const auto& pkt = it->second;
       LOG_DEBUG("  Acknowledging packet seq={}", it->first);
-      if (pkt.retry_count == 0) {
-        const auto now = now_fn_();
-        const auto rtt_sample =
-            std::chrono::duration_cast<std::chrono::milliseconds>(now - pkt.first_sent);
-        update_rtt(rtt_sample);
-      }
-      buffered_bytes_ -= pkt.data.size();
+      buffered_bytes_ -= it->second.data.size();
       ++stats_.packets_acked;
       ++acked_count;
       it = pending_.erase(it);
@@ -160,6 +164,16 @@ std::vector<const PendingPacket*> RetransmitBuffer::get_packets_to_retransmit()
   return result;
 }
 
+std::optional<RetransmitBuffer::TimePoint> RetransmitBuffer::next_retry_time() const {
+  std::optional<TimePoint> earliest;
+  for (const auto& [seq, pkt] : pending_) {
+    if (!earliest || pkt.next_retry < *earliest) {
+      earliest = pkt.next_retry;
+    }
+  }
+  return earliest;
+}
+
 bool RetransmitBuffer::mark_retransmitted(std::uint64_t sequence) {
   auto it = pending_.find(sequence);
   if (it == pending_.end()) {
@@ -173,15 +187,15 @@ bool RetransmitBuffer::mark_retransmitted(std::uint64_t sequence) {
   }
 
   // Calculate backoff: RTO * backoff_factor^retry_count
-  const auto rto_ms = static_cast<double>(current_rto_.count());
-  const auto backoff = static_cast<std::int64_t>(
-      rto_ms * std::pow(config_.backoff_factor, static_cast<double>(pkt.retry_count)));
+  const auto rto_us = static_cast<double>(current_rto_.count());
+  const auto backoff = std::chrono::microseconds(static_cast<std::int64_t>(
+      rto_us * std::pow(config_.backoff_factor, static_cast<double>(pkt.retry_count))));
   const auto capped_backoff =
-      std::min<std::int64_t>(backoff, config_.max_rto.count());
+      std::min<std::chrono::microseconds>(backoff, config_.max_rto);
 
   const auto now = now_fn_();
   pkt.last_sent = now;
-  pkt.next_retry = now + std::chrono::milliseconds(capped_backoff);
+  pkt.next_retry = now + capped_backoff;
 
   stats_.bytes_retransmitted += pkt.data.size();
   ++stats_.packets_retransmitted;
@@ -198,37 +212,61 @@ void RetransmitBuffer::drop_packet(std::uint64_t sequence) {
   pending_.erase(it);
 }
 
-void RetransmitBuffer::update_rtt(std::chrono::milliseconds sample) {
+void RetransmitBuffer::set_peer_max_ack_delay(std::chrono::microseconds delay) {
+  peer_max_ack_delay_ = std::max(delay, std::chrono::microseconds{0});
+  if (rtt_initialized_) {
+    current_rto_ = calculate_rto();
+  }
+}
+
+void RetransmitBuffer::update_rtt(std::chrono::microseconds sample, std::chrono::microseconds ack_delay) {
+  const auto now = now_fn_();
+  latest_rtt_ = sample;
+  // Windowed minimum: a new minimum, or the old one has aged out.
+  if (!rtt_initialized_ || sample <= min_rtt_ || now - min_rtt_stamp_ > config_.min_rtt_window) {
+    min_rtt_ = sample;
+    min_rtt_stamp_ = now;
+  }
+
   if (!rtt_initialized_) {
     // First sample: initialize directly (RFC 6298 section 2.2)
     estimated_rtt_ = sample;
     rtt_variance_ = sample / 2;
     rtt_initialized_ = true;
   } else {
+    // Take the time the peer held the ACK back out of the sample, but never
+    // below min_rtt: a sample cannot be shorter than the path (RFC 9002,
+    // section 5.3). The reported delay is trusted up to the peer's maximum.
+    if (peer_max_ack_delay_.count() > 0) {
+      ack_delay = std::min(ack_delay, peer_max_ack_delay_);
+    }
+    const auto adjusted =
+        ack_delay.count() > 0 && sample >= min_rtt_ + ack_delay ? sample - ack_delay : sample;
+
     // Subsequent samples: EWMA update (RFC 6298 section 2.3)
     // RTTVAR <- (1 - beta) * RTTVAR + beta * |SRTT - R'|
     // SRTT <- (1 - alpha) * SRTT + alpha * R'
-    const auto diff = static_cast<double>(std::abs(estimated_rtt_.count() - sample.count()));
+    const auto diff = static_cast<double>(std::abs(estimated_rtt_.count() - adjusted.count()));
     const auto var_count = static_cast<double>(rtt_variance_.count());
     const auto est_count = static_cast<double>(estimated_rtt_.count());
-    const auto samp_count = static_cast<double>(sample.count());
-    rtt_variance_ = std::chrono::milliseconds(
+    const auto samp_count = static_cast<double>(adjusted.count());
+    rtt_variance_ = std::chrono::microseconds(
         static_cast<std::int64_t>((1.0 - config_.rtt_beta) * var_count +
                                    config_.rtt_beta * diff));
-    estimated_rtt_ = std::chrono::milliseconds(
+    estimated_rtt_ = std::chrono::microseconds(
         static_cast<std::int64_t>((1.0 - config_.rtt_alpha) * est_count +
                                    config_.rtt_alpha * samp_count));
   }
   current_rto_ = calculate_rto();
 }
 
-std::chrono::milliseconds RetransmitBuffer::calculate_rto() const {
-  // RTO = SRTT + max(G, K * RTTVAR) where G is clock granularity, K = 4
-  // We ignore G (assume fine-grained clock) and use K = 4.
-  const auto rto = estimated_rtt_ + 4 * rtt_variance_;
-  const auto clamped =
-      std::clamp(rto.count(), config_.min_rto.count(), config_.max_rto.count());
-  return std::chrono::milliseconds(clamped);
+std::chrono::microseconds RetransmitBuffer::calculate_rto() const {
+  // RTO = SRTT + max(G, K * RTTVAR) + max_ack_delay, where G is the timer
+  // granularity and K = 4. The peer may hold the ACK back for up to
+  // max_ack_delay, which the smoothed RTT no longer includes.
+  constexpr std::chrono::microseconds kGranularity{1000};
+  const auto rto = estimated_rtt_ + std::max(kGranularity, 4 * rtt_variance_) + peer_max_ack_delay_;
+  return std::clamp<std::chrono::microseconds>(rto, config_.min_rto, config_.max_rto);
 }
 
 bool RetransmitBuffer::make_room(std::size_t bytes_needed) {
@@ -34,6 +34,8 @@ struct RetransmitConfig {
   double rtt_alpha{0.125};
   // RTT variance factor (beta for EWMA).
   double rtt_beta{0.25};
+  // Window of the minimum RTT filter (see min_rtt()).
+  std::chrono::seconds min_rtt_window{10};
 
   // ========== Hardening options (Stage 4) ==========
 
@@ -116,16 +118,27 @@ class RetransmitBuffer {
                             PacketPriority priority);
 
   // Acknowledge a packet. Updates RTT estimate and removes from buffer.
+  // ack_delay is how long the receiver held the ACK back after the packet
+  // arrived; it is taken out of the RTT sample (RFC 9002, section 5.3).
   // Returns true if the sequence was found and acknowledged.
-  bool acknowledge(std::uint64_t sequence);
+  bool acknowledge(std::uint64_t sequence, std::chrono::microseconds ack_delay = {});
+
+  // Acknowledge a packet without taking an RTT sample from it, e.g. an older
+  // packet reported in the same ACK as a newer one: it waited at the
+  // receiver for longer than the ACK delay says.
+  bool acknowledge_without_sample(std::uint64_t sequence);
 
   // Acknowledge all packets up to and including sequence (cumulative ACK).
+  // Takes no RTT samples, for the same reason.
   void acknowledge_cumulative(std::uint64_t sequence);
 
   // Get packets that need retransmission now.
   // Returns references to packets whose next_retry has passed.
   std::vector<const PendingPacket*> get_packets_to_retransmit();
 
+  // Earliest next_retry of the buffered packets; nullopt if the buffer is empty.
+  std::optional<TimePoint> next_retry_time() const;
+
   // Mark a packet as retransmitted (updates retry count and next_retry time).
   // Returns false if max retries exceeded (packet should be dropped).
   bool mark_retransmitted(std::uint64_t sequence);
@@ -133,11 +146,28 @@ class RetransmitBuffer {
   // Remove a packet that has exceeded max retries.
   void drop_packet(std::uint64_t sequence);
 
-  // Get current RTT estimate.
-  std::chrono::milliseconds estimated_rtt() const { return estimated_rtt_; }
+  // Get current RTT estimate (smoothed, ACK delay compensated).
+  std::chrono::microseconds estimated_rtt() const { return estimated_rtt_; }
+
+  // RTT variation (RTTVAR).
+  std::chrono::microseconds rtt_variance() const { return rtt_variance_; }
+
+  // Smallest RTT sample seen within min_rtt_window, before ACK delay
+  // compensation: the path's propagation delay as far as it is known.
+  std::chrono::microseconds min_rtt() const { return min_rtt_; }
+
+  // Most recent RTT sample.
+  std::chrono::microseconds latest_rtt() const { return latest_rtt_; }
+
+  // Whether estimated_rtt() comes from a sample rather than initial_rtt.
+  bool has_rtt_sample() const { return rtt_initialized_; }
 
   // Get current RTO (retransmit timeout).
-  std::chrono::milliseconds current_rto() const { return current_rto_; }
+  std::chrono::microseconds current_rto() const { return current_rto_; }
+
+  // Longest the peer may delay an ACK. Added to the RTO, and caps the ACK
+  // delay the peer reports. Zero (the default) until set.
+  void set_peer_max_ack_delay(std::chrono::microseconds delay);
 
   // Get current buffer utilization.
   std::size_t buffered_bytes() const { return buffered_bytes_; }
@@ -168,8 +198,8 @@ class RetransmitBuffer {
   }
 
  private:
-  void update_rtt(std::chrono::milliseconds sample);
-  std::chrono::milliseconds calculate_rto() const;
+  void update_rtt(std::chrono::microseconds sample, std::chrono::microseconds ack_delay);
+  std::chrono::microseconds calculate_rto() const;
 
   // Internal: try to make room for new data.
   bool make_room(std::size_t bytes_needed);
@@ -187,10 +217,14 @@ class RetransmitBuffer {
   std::unordered_map<std::uint64_t, PendingPacket> pending_;
   std::size_t buffered_bytes_{0};
 
-  // RTT estimation (RFC 6298 style)
-  std::chrono::milliseconds estimated_rtt_;
-  std::chrono::milliseconds rtt_variance_{0};
-  std::chrono::milliseconds current_rto_;
+  // RTT estimation (RFC 6298 style, with RFC 9002 ACK delay handling)
+  std::chrono::microseconds estimated_rtt_;
+  std::chrono::microseconds rtt_variance_{0};
+  std::chrono::microseconds current_rto_;
+  std::chrono::microseconds latest_rtt_{0};
+  std::chrono::microseconds min_rtt_{0};
+  TimePoint min_rtt_stamp_{};
+  std::chrono::microseconds peer_max_ack_delay_{0};
   bool rtt_initialized_{false};
 
   // Rate limiting state.
@@ -0,0 +1,71 @@
+#include "transport/session/packet_coalescer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace veil::transport {
+
+PacketCoalescer::PacketCoalescer(PacketCoalescerConfig config, std::function<TimePoint()> now_fn)
+    : config_(config), now_fn_(std::move(now_fn)) {
+  if (config_.max_payloads == 0) {
+    throw std::invalid_argument("max_payloads must be positive");
+  }
+  if (config_.max_delay.count() < 0) {
+    throw std::invalid_argument("max_delay must not be negative");
+  }
+}
+
+bool PacketCoalescer::add(std::span<const std::uint8_t> payload, std::uint64_t stream_id) {
+  if (queued_ == 0) {
+    oldest_ = now_fn_();
+    queued_bytes_ = kPacketOverhead;
+  }
+  if (queued_ == entries_.size()) {
+    entries_.emplace_back();
+  }
+  auto& entry = entries_[queued_++];
+  entry.stream_id = stream_id;
+  entry.data.assign(payload.begin(), payload.end());
+  queued_bytes_ += payload.size() + kFrameOverheadEstimate;
+  ++stats_.payloads;
+
+  return queued_bytes_ >= config_.max_datagram_size || queued_ >= config_.max_payloads;
+}
+
+std::vector<std::vector<std::uint8_t>> PacketCoalescer::flush(TransportSession& session) {
+  if (queued_ == 0) {
+    return {};
+  }
+
+  std::vector<CoalescedPayload> payloads;
+  payloads.reserve(queued_);
+  for (std::size_t i = 0; i < queued_; ++i) {
+    payloads.push_back(CoalescedPayload{.stream_id = entries_[i].stream_id, .data = entries_[i].data});
+  }
+  auto datagrams = session.encrypt_coalesced(payloads);
+
+  stats_.datagrams += datagrams.size();
+  clear();
+  return datagrams;
+}
+
+void PacketCoalescer::clear() {
+  queued_ = 0;
+  queued_bytes_ = 0;
+}
+
+std::optional<std::chrono::microseconds> PacketCoalescer::time_until_flush() const {
+  if (queued_ == 0) {
+    return std::nullopt;
+  }
+  const auto waited = std::chrono::duration_cast<std::chrono::microseconds>(now_fn_() - oldest_);
+  return std::max(config_.max_delay - waited, std::chrono::microseconds(0));
+}
+
+}  // namespace veil::transport
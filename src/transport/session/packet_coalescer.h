@@ -0,0 +1,99 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "transport/session/transport_session.h"
+
+namespace veil::transport {
+
+// Configuration for send-side coalescing.
+struct PacketCoalescerConfig {
+  // How long the oldest queued payload may wait for more to share its
+  // datagram. Zero sends at the end of the current burst (the caller flushes
+  // after draining its input), so no latency is added. The event loop waits in
+  // whole milliseconds, so non-zero delays below 1 ms are rounded up.
+  std::chrono::microseconds max_delay{0};
+  // Datagram size budget; should match TransportSessionConfig::mtu.
+  std::size_t max_datagram_size{1400};
+  // Flush once this many payloads are queued.
+  std::size_t max_payloads{64};
+};
+
+// Statistics for coalescing.
+struct PacketCoalescerStats {
+  std::uint64_t payloads{0};   // Payloads queued
+  std::uint64_t datagrams{0};  // Datagrams produced by flush()
+};
+
+/**
+ * Queues small payloads (e.g. TUN packets) so that several are sealed into
+ * one datagram by TransportSession::encrypt_coalesced(), which also appends
+ * a pending ACK. This cuts the packet rate and the AEAD calls
+ * per payload byte for interactive and ACK-heavy flows.
+ *
+ * The caller adds payloads as they arrive and calls flush() when add()
+ * returns true (a datagram's worth is queued), at the end of an input burst
+ * when max_delay is zero, or once time_until_flush() has elapsed.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session.
+ */
+class PacketCoalescer {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  // Throws std::invalid_argument if max_payloads is zero or max_delay is negative.
+  explicit PacketCoalescer(PacketCoalescerConfig config = {}, std::function<TimePoint()> now_fn = Clock::now);
+
+  // Queue a copy of a payload. Returns true if the queue should be flushed now.
+  bool add(std::span<const std::uint8_t> payload, std::uint64_t stream_id = 0);
+
+  // Seal the queued payloads into as few datagrams as fit the session's MTU.
+  // Returns the datagrams in send order.
+  std::vector<std::vector<std::uint8_t>> flush(TransportSession& session);
+
+  // Drop queued payloads (e.g. when the session is replaced).
+  void clear();
+
+  bool empty() const { return queued_ == 0; }
+  std::size_t queued() const { return queued_; }
+
+  // Time until the oldest payload has waited max_delay (zero if overdue);
+  // nullopt when the queue is empty.
+  std::optional<std::chrono::microseconds> time_until_flush() const;
+
+  // Follow a change of the session's MTU (TransportSession::set_mtu()).
+  void set_max_datagram_size(std::size_t size) { config_.max_datagram_size = size; }
+
+  const PacketCoalescerConfig& config() const { return config_; }
+  const PacketCoalescerStats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::uint64_t stream_id{0};
+    std::vector<std::uint8_t> data;
+  };
+
+  // Rough compact-format size of a queued payload: frame header plus payload.
+  static constexpr std::size_t kFrameOverheadEstimate = 4;
+  // Connection ID, sequence and AEAD tag.
+  static constexpr std::size_t kPacketOverhead = kConnectionIdSize + 8 + crypto::kAeadTagLen;
+
+  PacketCoalescerConfig config_;
+  std::function<TimePoint()> now_fn_;
+  // Entries are kept (with their capacity) across flushes; queued_ counts the live ones.
+  std::vector<Entry> entries_;
+  std::size_t queued_{0};
+  std::size_t queued_bytes_{0};
+  TimePoint oldest_;
+  PacketCoalescerStats stats_;
+};
+
+}  // namespace veil::transport
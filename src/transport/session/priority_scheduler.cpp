@@ -0,0 +1,252 @@
+#include "transport/session/priority_scheduler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace veil::transport {
+
+namespace {
+
+constexpr std::uint8_t kProtoTcp = 6;
+constexpr std::uint8_t kProtoUdp = 17;
+
+// Addressing fields of an IP packet, as far as classification needs them.
+struct IpFields {
+  std::uint8_t dscp{0};
+  std::uint8_t protocol{0};
+  std::span<const std::uint8_t> addresses;  // Source and destination, contiguous.
+  std::span<const std::uint8_t> ports;      // Source and destination port; empty if unknown.
+};
+
+std::optional<IpFields> parse_ip(std::span<const std::uint8_t> packet) {
+  if (packet.empty()) {
+    return std::nullopt;
+  }
+  IpFields fields;
+  std::size_t transport_offset = 0;
+  const auto version = packet[0] >> 4;
+  if (version == 4) {
+    if (packet.size() < 20) {
+      return std::nullopt;
+    }
+    const auto header_length = static_cast<std::size_t>(packet[0] & 0x0F) * 4;
+    if (header_length < 20 || header_length > packet.size()) {
+      return std::nullopt;
+    }
+    fields.dscp = static_cast<std::uint8_t>(packet[1] >> 2);
+    fields.protocol = packet[9];
+    fields.addresses = packet.subspan(12, 8);
+    // Only the first fragment carries the ports.
+    const bool later_fragment = ((packet[6] & 0x1F) | packet[7]) != 0;
+    transport_offset = later_fragment ? 0 : header_length;
+  } else if (version == 6) {
+    if (packet.size() < 40) {
+      return std::nullopt;
+    }
+    fields.dscp = static_cast<std::uint8_t>(((packet[0] & 0x0F) << 2) | (packet[1] >> 6));
+    fields.protocol = packet[6];  // Extension headers are not followed.
+    fields.addresses = packet.subspan(8, 32);
+    transport_offset = 40;
+  } else {
+    return std::nullopt;
+  }
+  if (transport_offset != 0 && (fields.protocol == kProtoTcp || fields.protocol == kProtoUdp) &&
+      packet.size() >= transport_offset + 4) {
+    fields.ports = packet.subspan(transport_offset, 4);
+  }
+  return fields;
+}
+
+std::optional<TrafficClass> class_from_dscp(std::uint8_t dscp) {
+  switch (dscp) {
+    case 1:  // LE (RFC 8622)
+    case 8:  // CS1
+      return TrafficClass::kBulk;
+    case 32:  // CS4
+    case 34:  // AF41
+    case 36:  // AF42
+    case 38:  // AF43
+    case 40:  // CS5
+    case 44:  // VOICE-ADMIT
+    case 46:  // EF
+    case 48:  // CS6
+    case 56:  // CS7
+      return TrafficClass::kInteractive;
+    default:
+      return std::nullopt;
+  }
+}
+
+// FNV-1a over the 5-tuple.
+std::uint64_t flow_hash(const IpFields& fields) {
+  std::uint64_t hash = 0xcbf29ce484222325ULL;
+  const auto mix = [&hash](std::uint8_t byte) {
+    hash ^= byte;
+    hash *= 0x100000001b3ULL;
+  };
+  mix(fields.protocol);
+  for (auto byte : fields.addresses) {
+    mix(byte);
+  }
+  for (auto byte : fields.ports) {
+    mix(byte);
+  }
+  return hash;
+}
+
+PacketClass make_class(TrafficClass traffic_class) {
+  return PacketClass{.traffic_class = traffic_class,
+                     .stream_id = traffic_class == TrafficClass::kInteractive ? kInteractiveStreamId
+                                                                              : kBulkStreamId};
+}
+
+std::size_t class_index(TrafficClass traffic_class) { return static_cast<std::size_t>(traffic_class); }
+
+}  // namespace
+
+// ========== TrafficClassifier ==========
+
+TrafficClassifier::TrafficClassifier(TrafficClassifierConfig config, std::function<TimePoint()> now_fn)
+    : config_(config), now_fn_(std::move(now_fn)) {
+  if (config_.flow_window.count() <= 0) {
+    throw std::invalid_argument("flow_window must be positive");
+  }
+}
+
+PacketClass TrafficClassifier::classify(std::span<const std::uint8_t> packet) {
+  const auto fields = parse_ip(packet);
+  if (!fields) {
+    return make_class(TrafficClass::kBulk);
+  }
+
+  // Track the flow's volume for every packet, so a flow's small packets and
+  // marked packets still count towards it.
+  auto& flow = flows_[flow_hash(*fields) % kFlowBuckets];
+  const auto now = now_fn_();
+  const auto windows = (now - flow.last_seen) / config_.flow_window;
+  if (windows >= 64 || flow.last_seen == TimePoint{}) {
+    flow.bytes = 0;
+    flow.last_seen = now;
+  } else if (windows > 0) {
+    flow.bytes >>= windows;
+    flow.last_seen += windows * config_.flow_window;
+  }
+  flow.bytes += packet.size();
+
+  if (config_.use_dscp) {
+    if (auto marked = class_from_dscp(fields->dscp)) {
+      return make_class(*marked);
+    }
+  }
+  if (packet.size() <= config_.small_packet_size) {
+    return make_class(TrafficClass::kInteractive);
+  }
+  return make_class(flow.bytes > config_.bulk_flow_bytes ? TrafficClass::kBulk : TrafficClass::kInteractive);
+}
+
+// ========== PriorityScheduler ==========
+
+PriorityScheduler::PriorityScheduler(PrioritySchedulerConfig config) : config_(config) {
+  if (config_.interactive_weight == 0) {
+    throw std::invalid_argument("interactive_weight must be positive");
+  }
+  if (config_.max_datagram_size == 0) {
+    throw std::invalid_argument("max_datagram_size must be positive");
+  }
+}
+
+void PriorityScheduler::set_max_datagram_size(std::size_t size) {
+  if (size == 0) {
+    throw std::invalid_argument("max_datagram_size must be positive");
+  }
+  config_.max_datagram_size = size;
+}
+
+bool PriorityScheduler::enqueue(std::span<const std::uint8_t> payload, PacketClass packet_class) {
+  const auto index = class_index(packet_class.traffic_class);
+  if (queued_bytes_[index] + payload.size() > config_.max_queue_bytes) {
+    ++stats_.dropped[index];
+    return false;
+  }
+  auto& entry = queues_[index].emplace_back();
+  entry.stream_id = packet_class.stream_id;
+  entry.data.assign(payload.begin(), payload.end());
+  queued_bytes_[index] += payload.size();
+  ++stats_.payloads[index];
+  return true;
+}
+
+TrafficClass PriorityScheduler::next_class() {
+  const bool interactive = !queues_[class_index(TrafficClass::kInteractive)].empty();
+  const bool bulk = !queues_[class_index(TrafficClass::kBulk)].empty();
+  if (interactive && (!bulk || interactive_run_ < config_.interactive_weight)) {
+    ++interactive_run_;
+    return TrafficClass::kInteractive;
+  }
+  interactive_run_ = 0;
+  return TrafficClass::kBulk;
+}
+
+std::vector<std::vector<std::uint8_t>> PriorityScheduler::drain(TransportSession& session,
+                                                                std::size_t max_bytes) {
+  std::vector<std::vector<std::uint8_t>> datagrams;
+  std::vector<CoalescedPayload> batch;
+  std::size_t sealed_bytes = 0;
+  while (!empty() && sealed_bytes < max_bytes) {
+    if (!session.can_send(session.bytes_in_flight()) || !session.check_pacing()) {
+      ++stats_.blocked;
+      break;
+    }
+
+    const auto index = class_index(next_class());
+    auto& queue = queues_[index];
+    // A datagram's worth of this class; a single oversized payload is
+    // fragmented by the session.
+    batch.clear();
+    std::size_t bytes = kPacketOverhead;
+    for (const auto& entry : queue) {
+      const auto size = entry.data.size() + kFrameOverheadEstimate;
+      if (!batch.empty() && bytes + size > config_.max_datagram_size) {
+        break;
+      }
+      batch.push_back(CoalescedPayload{.stream_id = entry.stream_id, .data = entry.data});
+      bytes += size;
+    }
+
+    auto sealed = session.encrypt_coalesced(batch);
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      queued_bytes_[index] -= queue.front().data.size();
+      queue.pop_front();
+    }
+    stats_.datagrams += sealed.size();
+    for (auto& datagram : sealed) {
+      sealed_bytes += datagram.size();
+      datagrams.push_back(std::move(datagram));
+    }
+  }
+  return datagrams;
+}
+
+void PriorityScheduler::clear() {
+  for (auto& queue : queues_) {
+    queue.clear();
+  }
+  queued_bytes_ = {};
+  interactive_run_ = 0;
+}
+
+std::size_t PriorityScheduler::queued(TrafficClass traffic_class) const {
+  return queues_[class_index(traffic_class)].size();
+}
+
+std::size_t PriorityScheduler::queued_bytes(TrafficClass traffic_class) const {
+  return queued_bytes_[class_index(traffic_class)];
+}
+
+}  // namespace veil::transport
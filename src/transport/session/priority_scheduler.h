@@ -0,0 +1,187 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "transport/session/transport_session.h"
+
+namespace veil::transport {
+
+// ============================================================================
+// Traffic Classification
+// ============================================================================
+
+// Send priority of a tunnelled packet.
+enum class TrafficClass : std::uint8_t {
+  kInteractive = 0,  // Latency-sensitive: DNS, SSH, VoIP, games, TCP ACKs.
+  kBulk = 1,         // Everything else, in particular long transfers.
+};
+
+inline constexpr std::size_t kTrafficClassCount = 2;
+
+// Mux stream carrying each class. Bulk stays on stream 0, which the compact
+// frame format encodes for free.
+inline constexpr std::uint64_t kBulkStreamId = 0;
+inline constexpr std::uint64_t kInteractiveStreamId = 1;
+
+// Configuration for TrafficClassifier.
+struct TrafficClassifierConfig {
+  // Honour DSCP markings: EF, VOICE-ADMIT, CS4-CS7 and AF4x are interactive;
+  // CS1 and LE (lower effort) are bulk.
+  bool use_dscp{true};
+  // Packets up to this size (IP header included) are interactive.
+  std::size_t small_packet_size{200};
+  // A flow whose recent volume exceeds this many bytes is bulk. The volume
+  // halves every flow_window, so it settles near twice the bytes the flow
+  // sends per window.
+  std::size_t bulk_flow_bytes{64 * 1024};
+  std::chrono::milliseconds flow_window{200};
+};
+
+// Result of classifying one packet.
+struct PacketClass {
+  TrafficClass traffic_class{TrafficClass::kBulk};
+  std::uint64_t stream_id{kBulkStreamId};
+};
+
+/**
+ * Sorts IPv4/IPv6 packets read from the TUN device into interactive and bulk
+ * traffic, in this order:
+ *   1. DSCP markings, when the application set them;
+ *   2. small packets (requests, keystrokes, voice frames, pure ACKs);
+ *   3. sparse flows: flows are hashed by their 5-tuple into buckets that
+ *      track recent volume, and only flows below bulk_flow_bytes stay
+ *      interactive. A transfer is demoted once it sustains more than about
+ *      bulk_flow_bytes / (2 * flow_window) (160 KB/s with the defaults),
+ *      while request/response and real-time flows stay below that.
+ * Packets that are not IP are bulk.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session.
+ */
+class TrafficClassifier {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  // Throws std::invalid_argument if flow_window is not positive.
+  explicit TrafficClassifier(TrafficClassifierConfig config = {},
+                             std::function<TimePoint()> now_fn = Clock::now);
+
+  PacketClass classify(std::span<const std::uint8_t> packet);
+
+  const TrafficClassifierConfig& config() const { return config_; }
+
+ private:
+  struct FlowBucket {
+    TimePoint last_seen{};
+    std::uint64_t bytes{0};
+  };
+
+  static constexpr std::size_t kFlowBuckets = 256;
+
+  TrafficClassifierConfig config_;
+  std::function<TimePoint()> now_fn_;
+  std::array<FlowBucket, kFlowBuckets> flows_{};
+};
+
+// ============================================================================
+// Priority Scheduling
+// ============================================================================
+
+// Configuration for PriorityScheduler.
+struct PrioritySchedulerConfig {
+  // Datagram size budget; should match TransportSessionConfig::mtu.
+  std::size_t max_datagram_size{1400};
+  // Bytes each class may queue while the congestion window is full; further
+  // payloads of that class are dropped, like a full TUN queue would.
+  std::size_t max_queue_bytes{512 * 1024};
+  // While both classes are backlogged, one bulk datagram is sent after every
+  // interactive_weight interactive ones, so bulk traffic is never starved.
+  std::uint32_t interactive_weight{8};
+};
+
+// Statistics for priority scheduling, indexed by TrafficClass.
+struct PrioritySchedulerStats {
+  std::array<std::uint64_t, kTrafficClassCount> payloads{};  // Payloads queued
+  std::array<std::uint64_t, kTrafficClassCount> dropped{};   // Payloads dropped (queue full)
+  std::uint64_t datagrams{0};                                // Datagrams produced by drain()
+  std::uint64_t blocked{0};  // drain() calls stopped by the congestion window or pacing
+};
+
+/**
+ * Per-class send queues in front of the session's congestion window. Without
+ * it every payload is sealed as soon as it arrives, so a bulk transfer fills
+ * the window and the bottleneck queue, and an interactive packet waits behind
+ * all of it. Here payloads wait in their class queue instead, and whenever
+ * the window and pacing allow, drain() seals the next datagram from the
+ * interactive queue first (subject to interactive_weight). Payloads of one
+ * class keep their order; several payloads of a class share a datagram, as
+ * with PacketCoalescer.
+ *
+ * The caller enqueues payloads as they arrive and calls drain() at the end of
+ * an input burst, after processing ACKs (which open the window) and when the
+ * pacing delay (TransportSession::time_until_next_send()) has passed.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the session.
+ */
+class PriorityScheduler {
+ public:
+  // Throws std::invalid_argument if interactive_weight or max_datagram_size is zero.
+  explicit PriorityScheduler(PrioritySchedulerConfig config = {});
+
+  // Queue a copy of a payload. Returns false if its class queue is full and
+  // the payload was dropped.
+  bool enqueue(std::span<const std::uint8_t> payload, PacketClass packet_class);
+
+  // Seal queued payloads while the session's congestion window and pacing
+  // allow, until max_bytes have been produced (the last datagram may go
+  // over). Returns the datagrams in send order.
+  std::vector<std::vector<std::uint8_t>> drain(TransportSession& session,
+                                               std::size_t max_bytes = std::numeric_limits<std::size_t>::max());
+
+  // Drop queued payloads (e.g. when the session is replaced).
+  void clear();
+
+  bool empty() const { return queues_[0].empty() && queues_[1].empty(); }
+  std::size_t queued(TrafficClass traffic_class) const;
+  std::size_t queued_bytes(TrafficClass traffic_class) const;
+
+  // Follow a change of the session's MTU (TransportSession::set_mtu()).
+  // Throws std::invalid_argument if size is zero.
+  void set_max_datagram_size(std::size_t size);
+
+  const PrioritySchedulerConfig& config() const { return config_; }
+  const PrioritySchedulerStats& stats() const { return stats_; }
+
+ private:
+  struct Entry {
+    std::uint64_t stream_id{0};
+    std::vector<std::uint8_t> data;
+  };
+
+  // Same estimates as PacketCoalescer: frame header per payload, and
+  // connection ID, sequence and AEAD tag per datagram.
+  static constexpr std::size_t kFrameOverheadEstimate = 4;
+  static constexpr std::size_t kPacketOverhead = kConnectionIdSize + 8 + crypto::kAeadTagLen;
+
+  // Class to serve next; the caller ensures at least one queue is non-empty.
+  TrafficClass next_class();
+
+  PrioritySchedulerConfig config_;
+  std::array<std::deque<Entry>, kTrafficClassCount> queues_;
+  std::array<std::size_t, kTrafficClassCount> queued_bytes_{};
+  // Interactive datagrams sent since the last bulk one.
+  std::uint32_t interactive_run_{0};
+  PrioritySchedulerStats stats_;
+};
+
+}  // namespace veil::transport
@@ -0,0 +1,130 @@
+#include "transport/session/transmit_queue.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "common/logging/logger.h"
+
+namespace veil::transport {
+
+namespace {
+
+// Shortest wait before retrying a full socket buffer; event loop timers have
+// millisecond resolution.
+constexpr std::chrono::microseconds kMinRetryDelay{1000};
+
+}  // namespace
+
+TransmitQueue::TransmitQueue(TransmitQueueConfig config, SendBatchFn send, std::function<TimePoint()> now_fn)
+    : config_(config), send_(std::move(send)), now_fn_(std::move(now_fn)) {
+  if (config_.max_batch == 0) {
+    throw std::invalid_argument("max_batch must be positive");
+  }
+  if (!send_) {
+    throw std::invalid_argument("send function is required");
+  }
+  if (config_.batch_window.count() < 0 || config_.kernel_horizon.count() < 0) {
+    throw std::invalid_argument("batch_window and kernel_horizon must not be negative");
+  }
+  batch_.reserve(config_.max_batch);
+}
+
+bool TransmitQueue::enqueue(std::vector<std::uint8_t> datagram, const UdpEndpoint& remote, TimePoint departure) {
+  const auto size = datagram.size();
+  if (queued_bytes_ + size > config_.max_queued_bytes) {
+    ++stats_.dropped;
+    return false;
+  }
+
+  if (departure == TimePoint{}) {
+    departure = now_fn_();
+  }
+  departure = std::max(departure, next_departure_);
+  next_departure_ = departure;
+  if (config_.pace && pacing_rate_ > 0) {
+    // The next datagram follows once this one has left at the pacing rate.
+    next_departure_ += std::chrono::nanoseconds(static_cast<std::int64_t>(size * 1'000'000'000ULL / pacing_rate_));
+  }
+
+  queue_.push_back(UdpPacket{.data = std::move(datagram), .remote = remote, .departure = departure});
+  queued_bytes_ += size;
+  ++stats_.enqueued;
+  return true;
+}
+
+std::size_t TransmitQueue::flush() {
+  const auto now = now_fn_();
+  if (now < retry_at_) {
+    return 0;
+  }
+  const auto limit = now + lead();
+  std::size_t sent = 0;
+  while (!queue_.empty() && queue_.front().departure <= limit) {
+    batch_.clear();
+    while (!queue_.empty() && batch_.size() < config_.max_batch && queue_.front().departure <= limit) {
+      queued_bytes_ -= queue_.front().data.size();
+      batch_.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+      if (!config_.kernel_pacing) {
+        // Due within the batch window: leave now.
+        batch_.back().departure = {};
+      }
+    }
+
+    ++stats_.batches;
+    std::error_code ec;
+    const auto batch_sent = std::min(send_(batch_, ec), batch_.size());
+    sent += batch_sent;
+    if (batch_sent == batch_.size()) {
+      continue;
+    }
+
+    if (ec == std::errc::operation_would_block || ec == std::errc::resource_unavailable_try_again ||
+        ec == std::errc::no_buffer_space) {
+      // The socket buffer is full: keep the rest for the next batch window.
+      requeue(batch_sent);
+      retry_at_ = now + std::max(config_.batch_window, kMinRetryDelay);
+      ++stats_.blocked;
+      break;
+    }
+    // The socket rejected this datagram; later ones may still go.
+    LOG_DEBUG("Transmit of a {}-byte datagram failed: {}", batch_[batch_sent].data.size(), ec.message());
+    ++stats_.send_errors;
+    requeue(batch_sent + 1);
+  }
+  stats_.sent += sent;
+  return sent;
+}
+
+std::optional<std::chrono::microseconds> TransmitQueue::time_until_next() const {
+  if (queue_.empty()) {
+    return std::nullopt;
+  }
+  const auto due = std::max(queue_.front().departure - lead(), retry_at_);
+  return std::max(std::chrono::ceil<std::chrono::microseconds>(due - now_fn_()), std::chrono::microseconds{0});
+}
+
+void TransmitQueue::clear() {
+  queue_.clear();
+  queued_bytes_ = 0;
+  retry_at_ = {};
+}
+
+void TransmitQueue::requeue(std::size_t from) {
+  for (auto i = batch_.size(); i > from; --i) {
+    queued_bytes_ += batch_[i - 1].data.size();
+    queue_.push_front(std::move(batch_[i - 1]));
+  }
+}
+
+std::chrono::microseconds TransmitQueue::lead() const {
+  return config_.kernel_pacing ? std::max(config_.batch_window, config_.kernel_horizon) : config_.batch_window;
+}
+
+}  // namespace veil::transport
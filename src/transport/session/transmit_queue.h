@@ -0,0 +1,128 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#include "transport/udp_socket/udp_socket.h"
+
+namespace veil::transport {
+
+// Configuration for the transmit queue.
+struct TransmitQueueConfig {
+  // Datagrams due within this window of now leave together in one batch.
+  // Event loop timers have millisecond resolution, so without kernel pacing
+  // this is also the pacing granularity.
+  std::chrono::microseconds batch_window{1000};
+  // Most datagrams handed to the socket in one send_batch() call.
+  std::size_t max_batch{64};
+  // Datagrams beyond this many queued bytes are dropped.
+  std::size_t max_queued_bytes{static_cast<std::size_t>(4) << 20};
+  // Space departures at the pacing rate (see set_pacing_rate()).
+  bool pace{true};
+  // Hand datagrams to the kernel up to kernel_horizon ahead of their
+  // departure, stamped with it (UdpSocket::enable_txtime()). The fq qdisc
+  // then releases each one on time; other qdiscs send at once. Only for a
+  // socket where enable_txtime() succeeded (see set_kernel_pacing()).
+  bool kernel_pacing{false};
+  std::chrono::microseconds kernel_horizon{2000};
+};
+
+// Statistics for the transmit queue.
+struct TransmitQueueStats {
+  std::uint64_t enqueued{0};     // Datagrams queued
+  std::uint64_t sent{0};         // Datagrams handed to the socket
+  std::uint64_t batches{0};      // send_batch() calls
+  std::uint64_t dropped{0};      // Datagrams dropped because the queue was full
+  std::uint64_t send_errors{0};  // Datagrams the socket rejected (dropped)
+  std::uint64_t blocked{0};      // Flushes cut short by a full socket buffer
+};
+
+/**
+ * Holds sealed datagrams until their departure time and sends them in
+ * batches (one sendmmsg() on Linux) instead of one system call each.
+ *
+ * Each datagram gets a departure time: the time the caller asks for (e.g.
+ * obfuscation::calculate_next_send_ts() for timing jitter, or now), but no
+ * earlier than the previous datagram's departure plus its size at the pacing
+ * rate. Departures never go backwards, so jitter delays traffic without
+ * reordering it.
+ *
+ * The caller enqueue()s datagrams, calls flush() after queuing a burst and
+ * again once time_until_next() has elapsed. When the socket buffer is full
+ * (would_block, no_buffer_space) the unsent datagrams stay queued and
+ * time_until_next() asks for a retry after one batch window; a datagram the
+ * socket rejects for any other reason is dropped.
+ *
+ * Thread Safety:
+ *   Not thread-safe. Use from the thread that owns the socket.
+ */
+class TransmitQueue {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+  // Send datagrams in order and return how many were sent, with ec set if
+  // not all (UdpSocket::send_batch()). A departure time is set on each one
+  // when kernel pacing is on.
+  using SendBatchFn = std::function<std::size_t(std::span<const UdpPacket>, std::error_code&)>;
+
+  // Throws std::invalid_argument if max_batch is zero, send is empty or a
+  // duration is negative.
+  TransmitQueue(TransmitQueueConfig config, SendBatchFn send, std::function<TimePoint()> now_fn = Clock::now);
+
+  // Queue a datagram to leave at departure or as soon after as pacing
+  // allows; a default TimePoint means now. Returns false if the queue is full.
+  bool enqueue(std::vector<std::uint8_t> datagram, const UdpEndpoint& remote, TimePoint departure = {});
+
+  // Send every datagram that is due. Returns the number handed to the socket.
+  std::size_t flush();
+
+  // Time until flush() has something to send (zero if now), or until it
+  // retries after a full socket buffer; nullopt when the queue is empty.
+  std::optional<std::chrono::microseconds> time_until_next() const;
+
+  // Pacing rate in bytes per second (0 = no pacing), e.g. from
+  // TransportSession::pacing_rate().
+  void set_pacing_rate(std::size_t bytes_per_second) { pacing_rate_ = bytes_per_second; }
+
+  // Turn kernel pacing on or off, e.g. off when enable_txtime() failed.
+  void set_kernel_pacing(bool enabled) { config_.kernel_pacing = enabled; }
+
+  // Drop queued datagrams (e.g. when the session is replaced).
+  void clear();
+
+  bool empty() const { return queue_.empty(); }
+  std::size_t size() const { return queue_.size(); }
+  std::size_t queued_bytes() const { return queued_bytes_; }
+
+  const TransmitQueueConfig& config() const { return config_; }
+  const TransmitQueueStats& stats() const { return stats_; }
+
+ private:
+  // How far ahead of its departure a datagram may be handed to the socket.
+  std::chrono::microseconds lead() const;
+
+  // Put batch_[from...] back at the front of the queue, in order.
+  void requeue(std::size_t from);
+
+  TransmitQueueConfig config_;
+  SendBatchFn send_;
+  std::function<TimePoint()> now_fn_;
+  std::deque<UdpPacket> queue_;
+  std::size_t queued_bytes_{0};
+  std::size_t pacing_rate_{0};
+  // Earliest departure of the next datagram queued.
+  TimePoint next_departure_{};
+  // No flush before this after the socket buffer filled up.
+  TimePoint retry_at_{};
+  std::vector<UdpPacket> batch_;
+  TransmitQueueStats stats_;
+};
+
+}  // namespace veil::transport
@@ -3,12 +3,15 @@
 #include <sodium.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cstdint>
+#include <iterator>
 #include <limits>
 #include <optional>
 #include <span>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
@@ -25,35 +28,139 @@ constexpr std::uint64_t kNonceOverflowWarningThreshold = std::numeric_limits<std
 
 namespace veil::transport {
 
+namespace {
+
+crypto::SequenceObfuscator make_sequence_obfuscator(std::span<const std::uint8_t, crypto::kAeadKeyLen> key,
+                                                    std::span<const std::uint8_t, crypto::kNonceLen> nonce) {
+  auto obfuscation_key = crypto::derive_sequence_obfuscation_key(key, nonce);
+  crypto::SequenceObfuscator obfuscator(obfuscation_key);
+  sodium_memzero(obfuscation_key.data(), obfuscation_key.size());
+  return obfuscator;
+}
+
+// Connection ID in wire order, as sent ahead of every packet and
+// authenticated as associated data.
+std::array<std::uint8_t, kConnectionIdSize> encode_connection_id(std::uint64_t connection_id) {
+  std::array<std::uint8_t, kConnectionIdSize> bytes{};
+  for (std::size_t i = 0; i < kConnectionIdSize; ++i) {
+    bytes[i] = static_cast<std::uint8_t>((connection_id >> (8 * (kConnectionIdSize - 1 - i))) & 0xFF);
+  }
+  return bytes;
+}
+
+// Sequence number of a packet for this connection; nullopt if the packet is
+// too short or for another connection.
+std::optional<std::uint64_t> parse_sequence(std::span<const std::uint8_t> ciphertext, std::uint64_t connection_id,
+                                            const crypto::SequenceObfuscator& obfuscator) {
+  // Minimum packet size: connection ID (8) + nonce (8 bytes for sequence) + tag (16 bytes) +
+  // header (1 byte minimum)
+  constexpr std::size_t kMinPacketSize = kConnectionIdSize + 8 + 16 + 1;
+  if (ciphertext.size() < kMinPacketSize || TransportSession::peek_connection_id(ciphertext) != connection_id) {
+    return std::nullopt;
+  }
+
+  // Extract obfuscated sequence from the 8 bytes after the connection ID.
+  std::uint64_t obfuscated_sequence = 0;
+  for (std::size_t i = 0; i < 8; ++i) {
+    obfuscated_sequence = (obfuscated_sequence << 8) | ciphertext[kConnectionIdSize + i];
+  }
+
+  // DPI RESISTANCE (Issue #21): Deobfuscate sequence number.
+  // The sender obfuscated the sequence to prevent traffic analysis. We reverse the
+  // obfuscation here to recover the real sequence for nonce derivation and replay checking.
+  return obfuscator.deobfuscate(obfuscated_sequence);
+}
+
+handshake::HandshakeSession to_handshake_session(const HibernatedTransport& state) {
+  handshake::HandshakeSession session{};
+  session.session_id = state.session_id;
+  session.keys = state.keys;
+  session.aead = state.aead;
+  session.compact_frames = state.compact_frames;
+  session.fec = state.fec;
+  session.ack_delay = state.ack_delay;
+  return session;
+}
+
+}  // namespace
+
+void HibernatedTransport::wipe() {
+  sodium_memzero(keys.send_key.data(), keys.send_key.size());
+  sodium_memzero(keys.recv_key.data(), keys.recv_key.size());
+  sodium_memzero(keys.send_nonce.data(), keys.send_nonce.size());
+  sodium_memzero(keys.recv_nonce.data(), keys.recv_nonce.size());
+}
+
 TransportSession::TransportSession(const handshake::HandshakeSession& handshake_session,
                                    TransportSessionConfig config, std::function<TimePoint()> now_fn)
     : config_(config),
       now_fn_(std::move(now_fn)),
       keys_(handshake_session.keys),
+      send_cipher_(handshake_session.aead, keys_.send_key),
+      recv_cipher_(handshake_session.aead, keys_.recv_key),
       current_session_id_(handshake_session.session_id),
-      send_seq_obfuscation_key_(crypto::derive_sequence_obfuscation_key(keys_.send_key, keys_.send_nonce)),
-      recv_seq_obfuscation_key_(crypto::derive_sequence_obfuscation_key(keys_.recv_key, keys_.recv_nonce)),
+      frame_format_(handshake_session.compact_frames ? mux::FrameFormat::kCompact : mux::FrameFormat::kLegacy),
+      send_seq_obfuscator_(make_sequence_obfuscator(keys_.send_key, keys_.send_nonce)),
+      recv_seq_obfuscator_(make_sequence_obfuscator(keys_.recv_key, keys_.recv_nonce)),
+      connection_id_(crypto::derive_connection_id(keys_)),
       replay_window_(config_.replay_window_size),
       session_rotator_(config_.session_rotation_interval, config_.session_rotation_packets),
+      ack_scheduler_(config_.ack_config, now_fn_),
       reorder_buffer_(0, config_.reorder_buffer_size),
-      fragment_reassembly_(config_.fragment_buffer_size),
+      fragment_reassembly_(config_.fragment_buffer_size, std::chrono::milliseconds(5000),
+                           mux::FragmentPlacement::kIndex),
       retransmit_buffer_(config_.retransmit_config, now_fn_),
-      congestion_controller_(config_.congestion_config, now_fn_) {
+      congestion_controller_(config_.congestion_config, now_fn_),
+      fec_(handshake_session.fec),
+      base_fragment_size_(config_.max_fragment_size),
+      datagram_budget_(config_.mtu),
+      mtu_(config_.mtu),
+      fec_adapter_(config_.fec) {
+  if (fec_) {
+    if (config_.max_fragment_size <= mux::kFecRepairOverhead || config_.mtu <= mux::kFecRepairOverhead) {
+      throw std::invalid_argument("max_fragment_size and mtu must leave room for FEC repair frames");
+    }
+    base_fragment_size_ -= mux::kFecRepairOverhead;
+    datagram_budget_ -= mux::kFecRepairOverhead;
+  }
+  fragment_size_ = base_fragment_size_;
+  unfragmented_size_ = fragment_size_;
+  ack_delay_ = handshake_session.ack_delay && frame_format_ == mux::FrameFormat::kCompact;
+  if (ack_delay_) {
+    // RTT samples no longer include the time the peer holds ACKs back, so the
+    // RTO has to: up to the peer's maximum, assumed to match ours. An ACK
+    // frequency request can raise it but not lower it. Without delay
+    // reporting the samples still carry it.
+    retransmit_buffer_.set_peer_max_ack_delay(config_.ack_config.max_ack_delay);
+  }
+
   // Enhanced diagnostic logging for session creation (Issue #69, #72)
   // Use INFO level so key fingerprints are always logged, not just in verbose mode
   // This helps diagnose key mismatch issues between client and server
-  LOG_INFO("TransportSession created: session_id={}", current_session_id_);
+  connection_id_bytes_ = encode_connection_id(connection_id_);
+
+  LOG_INFO("TransportSession created: session_id={}, connection_id={:#018x}, aead={}, frames={}, fec={}",
+           current_session_id_, connection_id_, crypto::aead_algorithm_name(send_cipher_.algorithm()),
+           frame_format_ == mux::FrameFormat::kCompact ? "compact" : "legacy",
+           fec_ ? mux::gf256_kernel_name() : "off");
   LOG_INFO("  send_key_fp={:02x}{:02x}{:02x}{:02x}, send_nonce_fp={:02x}{:02x}{:02x}{:02x}",
            keys_.send_key[0], keys_.send_key[1], keys_.send_key[2], keys_.send_key[3],
            keys_.send_nonce[0], keys_.send_nonce[1], keys_.send_nonce[2], keys_.send_nonce[3]);
   LOG_INFO("  recv_key_fp={:02x}{:02x}{:02x}{:02x}, recv_nonce_fp={:02x}{:02x}{:02x}{:02x}",
            keys_.recv_key[0], keys_.recv_key[1], keys_.recv_key[2], keys_.recv_key[3],
            keys_.recv_nonce[0], keys_.recv_nonce[1], keys_.recv_nonce[2], keys_.recv_nonce[3]);
-  LOG_INFO("  send_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}, recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}",
-           send_seq_obfuscation_key_[0], send_seq_obfuscation_key_[1],
-           send_seq_obfuscation_key_[2], send_seq_obfuscation_key_[3],
-           recv_seq_obfuscation_key_[0], recv_seq_obfuscation_key_[1],
-           recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3]);
+  LOG_INFO("  sequence obfuscation: {}", send_seq_obfuscator_.uses_hardware() ? "AES-NI" : "portable");
+}
+
+TransportSession::TransportSession(const HibernatedTransport& state, TransportSessionConfig config,
+                                   std::function<TimePoint()> now_fn)
+    : TransportSession(to_handshake_session(state), config, std::move(now_fn)) {
+  send_sequence_ = state.send_sequence;
+  recv_sequence_max_ = state.recv_sequence_max;
+  message_id_counter_ = state.message_id_counter;
+  if (state.received) {
+    replay_window_.restore(state.recv_sequence_max);
+  }
 }
 
 TransportSession::~TransportSession() {
@@ -62,42 +169,219 @@ TransportSession::~TransportSession() {
   sodium_memzero(keys_.recv_key.data(), keys_.recv_key.size());
   sodium_memzero(keys_.send_nonce.data(), keys_.send_nonce.size());
   sodium_memzero(keys_.recv_nonce.data(), keys_.recv_nonce.size());
-  sodium_memzero(send_seq_obfuscation_key_.data(), send_seq_obfuscation_key_.size());
-  sodium_memzero(recv_seq_obfuscation_key_.data(), recv_seq_obfuscation_key_.size());
   LOG_DEBUG("TransportSession destroyed, keys cleared");
 }
 
+std::optional<std::uint64_t> TransportSession::peek_connection_id(std::span<const std::uint8_t> packet) {
+  if (packet.size() < kConnectionIdSize) {
+    return std::nullopt;
+  }
+  std::uint64_t connection_id = 0;
+  for (std::size_t i = 0; i < kConnectionIdSize; ++i) {
+    connection_id = (connection_id << 8) | packet[i];
+  }
+  return connection_id;
+}
+
+bool TransportSession::authenticate(const HibernatedTransport& state, std::span<const std::uint8_t> ciphertext) {
+  const auto connection_id = crypto::derive_connection_id(state.keys);
+  const auto sequence =
+      parse_sequence(ciphertext, connection_id, make_sequence_obfuscator(state.keys.recv_key, state.keys.recv_nonce));
+  // A resumed session treats everything up to recv_sequence_max as seen.
+  if (!sequence || (state.received && *sequence <= state.recv_sequence_max)) {
+    return false;
+  }
+  const crypto::AeadCipher cipher(state.aead, state.keys.recv_key);
+  const auto nonce = crypto::derive_nonce(state.keys.recv_nonce, *sequence);
+  return cipher.decrypt(nonce, encode_connection_id(connection_id), ciphertext.subspan(kConnectionIdSize + 8))
+      .has_value();
+}
+
 std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_data(
     std::span<const std::uint8_t> plaintext, std::uint64_t stream_id, bool fin) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
+  // Fragment data if necessary.
+  return send_data_frames(fragment_data(plaintext, stream_id, fin), false);
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::encrypt_coalesced(
+    std::span<const CoalescedPayload> payloads) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  std::vector<mux::MuxFrame> frames;
+  frames.reserve(payloads.size() + 1);
+  for (const auto& payload : payloads) {
+    auto fragments = fragment_data(payload.data, payload.stream_id, true);
+    std::move(fragments.begin(), fragments.end(), std::back_inserter(frames));
+  }
+  return send_data_frames(std::move(frames), true);
+}
+
+std::optional<std::vector<std::uint8_t>> TransportSession::encrypt_probe(std::size_t size) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  constexpr std::size_t kProbeOverhead =
+      kConnectionIdSize + 8 + crypto::aead_ciphertext_size(0) + mux::MuxCodec::kHeartbeatHeaderSize;
+  if (size < kProbeOverhead || size - kProbeOverhead > std::numeric_limits<std::uint16_t>::max()) {
+    return std::nullopt;
+  }
+  const auto timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(now_fn_().time_since_epoch());
+  const auto frame = mux::make_heartbeat_frame(static_cast<std::uint64_t>(timestamp.count()), stats_.mtu_probes_sent,
+                                               std::vector<std::uint8_t>(size - kProbeOverhead, 0));
+
+  // A probe is only matched by an ACK that names its sequence exactly (see
+  // process_ack()); anything older than the ACK window is lost.
+  constexpr std::size_t kMaxPendingProbes = 16;
+  if (pending_probes_.size() >= kMaxPendingProbes) {
+    pending_probes_.erase(pending_probes_.begin());
+  }
+  pending_probes_.emplace_back(send_sequence_, size);
+  ++stats_.mtu_probes_sent;
+  return encrypt_frame(frame);
+}
+
+std::vector<std::size_t> TransportSession::take_acked_probes() {
+  VEIL_DCHECK_THREAD(thread_checker_);
+  return std::exchange(acked_probes_, {});
+}
+
+void TransportSession::set_mtu(std::size_t mtu) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  mtu_ = std::max(mtu, std::min(config_.mtu, kMinPathMtu));
+  datagram_budget_ = mtu_ - (fec_ ? mux::kFecRepairOverhead : 0);
+  if (mtu_ >= config_.mtu) {
+    fragment_size_ = base_fragment_size_;
+    unfragmented_size_ = fragment_size_ + (mtu_ - config_.mtu);
+  } else {
+    const std::size_t shrink = config_.mtu - mtu_;
+    fragment_size_ = base_fragment_size_ > shrink ? base_fragment_size_ - shrink : 1;
+    unfragmented_size_ = fragment_size_;
+  }
+}
+
+std::vector<std::vector<std::uint8_t>> TransportSession::send_data_frames(std::vector<mux::MuxFrame> frames,
+                                                                         bool pack_data) {
   std::vector<std::vector<std::uint8_t>> result;
+  if (frame_format_ == mux::FrameFormat::kLegacy) {
+    // Legacy frames carry no delimiter, so each gets its own datagram and
+    // ACKs are left to take_ack_packet().
+    // PERFORMANCE (Issue #94): Pre-allocate result vector to avoid reallocations.
+    result.reserve(frames.size());
+    for (const auto& frame : frames) {
+      result.push_back(send_frames(std::span<const mux::MuxFrame>(&frame, 1)));
+    }
+    take_fec_repairs(result);
+    return result;
+  }
 
-  // Fragment data if necessary.
-  auto frames = fragment_data(plaintext, stream_id, fin);
+  // An ACK frequency request rides with the data, so a lost one is
+  // retransmitted along with it.
+  if (!frames.empty()) {
+    if (auto request = take_ack_frequency_frame()) {
+      frames.push_back(std::move(*request));
+    }
+  }
 
-  // PERFORMANCE (Issue #94): Pre-allocate result vector to avoid reallocations.
-  result.reserve(frames.size());
+  // Piggyback a pending ACK on the last datagram instead of sending it in one
+  // of its own. It goes after the data so receivers see the payload first.
+  const bool ack_attached = !frames.empty() && ack_scheduler_.time_until_next_ack().has_value();
+  if (ack_attached) {
+    const auto ack = generate_ack(0);
+    frames.push_back(mux::make_ack_frame(ack.stream_id, ack.ack, ack.bitmap, ack.ack_delay));
+  }
 
-  for (auto& frame : frames) {
-    auto encrypted = build_encrypted_packet(frame);
+  // Greedy packing in order. Each datagram is sealed before the next one is
+  // sized, so sizes are computed against the sequence it will be sent with.
+  // Without pack_data, each data frame keeps a datagram of its own.
+  constexpr std::size_t kPacketOverhead = kConnectionIdSize + 8 + crypto::aead_ciphertext_size(0);
+  std::size_t begin = 0;
+  std::size_t datagram_size = kPacketOverhead;
+  bool has_data = false;
+  for (std::size_t i = 0; i < frames.size(); ++i) {
+    const std::size_t frame_size = mux::MuxCodec::compact_encoded_size(frames[i], send_sequence_, false);
+    const bool is_data = frames[i].kind == mux::FrameKind::kData;
+    if (i > begin && (datagram_size + frame_size > datagram_budget_ || (has_data && is_data && !pack_data))) {
+      result.push_back(send_frames(std::span<const mux::MuxFrame>(frames).subspan(begin, i - begin)));
+      begin = i;
+      datagram_size = kPacketOverhead;
+      has_data = false;
+    }
+    datagram_size += frame_size;
+    has_data = has_data || is_data;
+  }
+  if (begin < frames.size()) {
+    result.push_back(send_frames(std::span<const mux::MuxFrame>(frames).subspan(begin)));
+  }
+
+  if (ack_attached) {
+    ++stats_.acks_piggybacked;
+    on_ack_sent();
+  }
+  take_fec_repairs(result);
+  return result;
+}
 
-    // Store in retransmit buffer.
-    if (retransmit_buffer_.has_capacity(encrypted.size())) {
-      retransmit_buffer_.insert(send_sequence_ - 1, encrypted);
+std::vector<std::uint8_t> TransportSession::send_frames(std::span<const mux::MuxFrame> frames) {
+  const auto data_frames = static_cast<std::uint64_t>(std::count_if(
+      frames.begin(), frames.end(), [](const mux::MuxFrame& frame) { return frame.kind == mux::FrameKind::kData; }));
+
+  // FEC protects the plaintext of data packets. A group spans at most
+  // kFecMaxSources sequence numbers, so it is closed before a packet that
+  // would not fit; its repairs take sequence numbers, hence before encoding.
+  const bool protect = fec_ && data_frames > 0;
+  if (protect && !fec_encoder_.accepts(send_sequence_)) {
+    close_fec_group();
+  }
+  const auto plaintext = encode_frames(frames);
+  bool group_full = false;
+  if (protect) {
+    if (fec_encoder_.empty()) {
+      const auto& retransmit = retransmit_buffer_.stats();
+      const auto shape = fec_adapter_.update(retransmit.packets_sent, retransmit.packets_retransmitted);
+      if (shape.repair_count > 0) {
+        fec_encoder_.set_shape(shape);
+      }
+      fec_group_started_ = now_fn_();
+    }
+    if (fec_adapter_.shape().repair_count > 0) {
+      group_full = fec_encoder_.add(send_sequence_, plaintext);
     }
+  }
+  auto encrypted = seal_packet(plaintext);
+
+  // Store in retransmit buffer.
+  if (data_frames > 0 && retransmit_buffer_.has_capacity(encrypted.size())) {
+    retransmit_buffer_.insert(send_sequence_ - 1, encrypted);
+  }
+
+  ++stats_.packets_sent;
+  stats_.bytes_sent += encrypted.size();
+  stats_.fragments_sent += data_frames;
+  stats_.frames_coalesced += frames.size() - 1;
+  ++packets_since_rotation_;
+
+  if (group_full) {
+    close_fec_group();
+  }
+  return encrypted;
+}
 
+void TransportSession::close_fec_group() {
+  for (const auto& frame : fec_encoder_.finish()) {
+    auto encrypted = build_encrypted_packet(frame);
     ++stats_.packets_sent;
     stats_.bytes_sent += encrypted.size();
-    if (frame.kind == mux::FrameKind::kData) {
-      ++stats_.fragments_sent;
-    }
-
-    result.push_back(std::move(encrypted));
+    ++stats_.fec_repairs_sent;
     ++packets_since_rotation_;
+    fec_repair_packets_.push_back(std::move(encrypted));
   }
+}
 
-  return result;
+void TransportSession::take_fec_repairs(std::vector<std::vector<std::uint8_t>>& out) {
+  std::move(fec_repair_packets_.begin(), fec_repair_packets_.end(), std::back_inserter(out));
+  fec_repair_packets_.clear();
 }
 
 std::vector<std::uint8_t> TransportSession::encrypt_frame(const mux::MuxFrame& frame) {
@@ -120,104 +404,162 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
     std::span<const std::uint8_t> ciphertext) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
-  // Minimum packet size: nonce (8 bytes for sequence) + tag (16 bytes) + header (1 byte minimum)
-  constexpr std::size_t kMinPacketSize = 8 + 16 + 1;
-  if (ciphertext.size() < kMinPacketSize) {
-    LOG_DEBUG("Packet too small: {} bytes", ciphertext.size());
+  last_packet_advanced_ = false;
+
+  const auto sequence = read_sequence(ciphertext);
+  if (!sequence) {
     ++stats_.packets_dropped_decrypt;
     return std::nullopt;
   }
 
-  // Extract obfuscated sequence from first 8 bytes.
-  std::uint64_t obfuscated_sequence = 0;
-  for (int i = 0; i < 8; ++i) {
-    obfuscated_sequence = (obfuscated_sequence << 8) | ciphertext[static_cast<std::size_t>(i)];
+  // Replay check, before any crypto work.
+  if (!replay_window_.mark_and_check(*sequence)) {
+    LOG_DEBUG("Packet replay detected or out of window: sequence={}, highest={}",
+              *sequence, replay_window_.highest());
+    ++stats_.packets_dropped_replay;
+    return std::nullopt;
   }
+  LOG_DEBUG("Replay check passed, proceeding to decryption");
 
-  // DPI RESISTANCE (Issue #21): Deobfuscate sequence number.
-  // The sender obfuscated the sequence to prevent traffic analysis. We reverse the
-  // obfuscation here to recover the real sequence for nonce derivation and replay checking.
-  const std::uint64_t sequence = crypto::deobfuscate_sequence(obfuscated_sequence, recv_seq_obfuscation_key_);
+  auto decrypted = open_sequence(ciphertext, *sequence);
+  if (!decrypted) {
+    // Issue #78: Unmark sequence in replay window to allow legitimate retransmission
+    // If decryption fails (e.g., due to wrong session keys after session rotation),
+    // we should allow the server to retransmit this packet rather than permanently
+    // rejecting it as a replay.
+    replay_window_.unmark(*sequence);
+    LOG_DEBUG("  Unmarked sequence {} in replay window to allow retransmission", *sequence);
 
-  // Enhanced diagnostic logging for decryption debugging (Issue #69, #72)
-  // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-  LOG_DEBUG("Decrypt attempt: session_id={}, pkt_size={}, obfuscated_seq={:#018x}, deobfuscated_seq={}",
-            current_session_id_, ciphertext.size(), obfuscated_sequence, sequence);
-  LOG_DEBUG("  recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}, first_8_bytes={:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
-            recv_seq_obfuscation_key_[0], recv_seq_obfuscation_key_[1],
-            recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3],
-            ciphertext[0], ciphertext[1], ciphertext[2], ciphertext[3],
-            ciphertext[4], ciphertext[5], ciphertext[6], ciphertext[7]);
+    ++stats_.packets_dropped_decrypt;
+    return std::nullopt;
+  }
 
-  // Replay check.
-  if (!replay_window_.mark_and_check(sequence)) {
+  return deliver_packet(*sequence, ciphertext.size(), *decrypted);
+}
+
+std::optional<OpenedPacket> TransportSession::open_packet(std::span<const std::uint8_t> ciphertext) const {
+  const auto sequence = read_sequence(ciphertext);
+  if (!sequence) {
+    return std::nullopt;
+  }
+  auto decrypted = open_sequence(ciphertext, *sequence);
+  if (!decrypted) {
+    return std::nullopt;
+  }
+  return OpenedPacket{.sequence = *sequence, .size = ciphertext.size(), .plaintext = std::move(*decrypted)};
+}
+
+std::optional<std::vector<mux::MuxFrame>> TransportSession::accept_packet(OpenedPacket packet) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  last_packet_advanced_ = false;
+
+  // The packet is authentic, so a failed check is a genuine replay.
+  if (!replay_window_.mark_and_check(packet.sequence)) {
     LOG_DEBUG("Packet replay detected or out of window: sequence={}, highest={}",
-              sequence, replay_window_.highest());
+              packet.sequence, replay_window_.highest());
     ++stats_.packets_dropped_replay;
     return std::nullopt;
   }
-  LOG_DEBUG("Replay check passed, proceeding to decryption");
+  return deliver_packet(packet.sequence, packet.size, packet.plaintext);
+}
+
+std::optional<std::uint64_t> TransportSession::read_sequence(std::span<const std::uint8_t> ciphertext) const {
+  const auto sequence = parse_sequence(ciphertext, connection_id_, recv_seq_obfuscator_);
+  if (!sequence) {
+    // Packets too short or for another connection are dropped before any crypto work.
+    LOG_DEBUG("Packet too small ({} bytes) or connection ID mismatch for connection_id={:#018x}",
+              ciphertext.size(), connection_id_);
+    return std::nullopt;
+  }
+
+  // Enhanced diagnostic logging for decryption debugging (Issue #69, #72)
+  // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
+  LOG_DEBUG("Decrypt attempt: connection_id={:#018x}, pkt_size={}, deobfuscated_seq={}",
+            connection_id_, ciphertext.size() - kConnectionIdSize, *sequence);
+  return sequence;
+}
 
+std::optional<std::vector<std::uint8_t>> TransportSession::open_sequence(std::span<const std::uint8_t> ciphertext,
+                                                                         std::uint64_t sequence) const {
   // Derive nonce from sequence.
   const auto nonce = crypto::derive_nonce(keys_.recv_nonce, sequence);
 
-  // Decrypt (skip sequence prefix).
-  auto ciphertext_body = ciphertext.subspan(8);
-  auto decrypted = crypto::aead_decrypt(keys_.recv_key, nonce, {}, ciphertext_body);
+  // Decrypt (skip connection ID and sequence prefix).
+  // The connection ID is authenticated as associated data.
+  auto ciphertext_body = ciphertext.subspan(kConnectionIdSize + 8);
+  auto decrypted = recv_cipher_.decrypt(nonce, connection_id_bytes_, ciphertext_body);
   if (!decrypted) {
     // Enhanced error logging for decryption failures (Issue #69, #72)
     // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
     // Log key fingerprints (first 4 bytes) to help diagnose key mismatch issues
-    LOG_DEBUG("Decryption FAILED: session_id={}, sequence={}, ciphertext_size={}, "
+    LOG_DEBUG("Decryption FAILED: connection_id={:#018x}, sequence={}, ciphertext_size={}, "
               "recv_key_fp={:02x}{:02x}{:02x}{:02x}, recv_nonce_fp={:02x}{:02x}{:02x}{:02x}",
-              current_session_id_, sequence, ciphertext_body.size(),
+              connection_id_, sequence, ciphertext_body.size(),
               keys_.recv_key[0], keys_.recv_key[1], keys_.recv_key[2], keys_.recv_key[3],
               keys_.recv_nonce[0], keys_.recv_nonce[1], keys_.recv_nonce[2], keys_.recv_nonce[3]);
-    // Also log the obfuscation key fingerprint and packet header
-    LOG_DEBUG("  recv_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}, first_pkt_bytes={:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}",
-              recv_seq_obfuscation_key_[0], recv_seq_obfuscation_key_[1],
-              recv_seq_obfuscation_key_[2], recv_seq_obfuscation_key_[3],
-              ciphertext[0], ciphertext[1], ciphertext[2], ciphertext[3],
-              ciphertext[4], ciphertext[5], ciphertext[6], ciphertext[7]);
-
-    // Issue #78: Unmark sequence in replay window to allow legitimate retransmission
-    // If decryption fails (e.g., due to wrong session keys after session rotation),
-    // we should allow the server to retransmit this packet rather than permanently
-    // rejecting it as a replay.
-    replay_window_.unmark(sequence);
-    LOG_DEBUG("  Unmarked sequence {} in replay window to allow retransmission", sequence);
-
-    ++stats_.packets_dropped_decrypt;
     return std::nullopt;
   }
 
   // Enhanced diagnostic logging for decryption success (Issue #72)
   // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-  LOG_DEBUG("Decryption SUCCESS: session_id={}, sequence={}, decrypted_size={}",
-            current_session_id_, sequence, decrypted->size());
+  LOG_DEBUG("Decryption SUCCESS: connection_id={:#018x}, sequence={}, decrypted_size={}",
+            connection_id_, sequence, decrypted->size());
+  return decrypted;
+}
 
+std::vector<mux::MuxFrame> TransportSession::deliver_packet(std::uint64_t sequence, std::size_t size,
+                                                            std::span<const std::uint8_t> plaintext) {
   ++stats_.packets_received;
-  stats_.bytes_received += ciphertext.size();
+  stats_.bytes_received += size;
 
-  // Parse mux frames from decrypted data.
+  // Parse mux frames from decrypted data. A coalesced datagram carries several.
   std::vector<mux::MuxFrame> frames;
-  auto frame = mux::MuxCodec::decode(*decrypted);
-  if (frame) {
+  bool heartbeat = false;
+  auto decoded = decode_frames(plaintext, sequence);
+  if (decoded.empty()) {
+    // Log frame decode failure for debugging (Issue #72)
+    LOG_DEBUG("  Frame decode FAILED: decrypted_size={}, first_byte={:#04x}",
+              plaintext.size(), plaintext.empty() ? 0 : plaintext[0]);
+  }
+  const bool carries_data = process_frames(std::move(decoded), sequence, frames, heartbeat);
+  if (carries_data && fec_) {
+    fec_decoder_.on_packet(sequence, plaintext);
+  }
+  if (carries_data || heartbeat) {
+    on_data_packet(sequence);
+  }
+
+  // The replay window has already rejected duplicates, so equality only
+  // happens for the very first packet (sequence 0).
+  if (sequence >= recv_sequence_max_) {
+    recv_sequence_max_ = sequence;
+    last_packet_advanced_ = true;
+  }
+
+  return frames;
+}
+
+bool TransportSession::process_frames(std::vector<mux::MuxFrame> decoded, std::uint64_t sequence,
+                                      std::vector<mux::MuxFrame>& out, bool& heartbeat) {
+  bool carries_data = false;
+  for (auto& frame : decoded) {
     // Log frame details for debugging (Issue #72)
     LOG_DEBUG("  Frame decoded: kind={}, payload_size={}",
-              static_cast<int>(frame->kind),
-              frame->kind == mux::FrameKind::kData ? frame->data.payload.size() : 0);
+              static_cast<int>(frame.kind),
+              frame.kind == mux::FrameKind::kData ? frame.data.payload.size() : 0);
 
-    if (frame->kind == mux::FrameKind::kData) {
+    if (frame.kind == mux::FrameKind::kData) {
       ++stats_.fragments_received;
       recv_ack_bitmap_.ack(sequence);
+      carries_data = true;
 
       // Issue #74: Fragment reassembly
       // For fragmented messages, sequence is encoded as (msg_id << 32) | frag_idx.
       // For non-fragmented messages (or first fragment of msg_id=0), we detect by fin flag.
       // - If fin=true: complete message, return directly
       // - If fin=false: fragment, accumulate and try reassembly
-      const std::uint64_t frame_seq = frame->data.sequence;
+      const std::uint64_t frame_seq = frame.data.sequence;
       const std::uint64_t msg_id = frame_seq >> 32;
       const std::uint32_t frag_idx = static_cast<std::uint32_t>(frame_seq & 0xFFFFFFFF);
 
@@ -232,17 +574,15 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
       if (is_fragment) {
         // This is a fragment - push to reassembly buffer using msg_id as the key
 
-        // Calculate offset from fragment index
-        // We track cumulative size per message to compute offsets
-        // For simplicity, use frag_idx as offset (works when fragments arrive in order)
-        // TODO: For out-of-order fragments, we'd need more sophisticated tracking
+        // Placed by index rather than byte offset: the sender's fragment size
+        // follows its path MTU (see set_mtu()).
         mux::Fragment frag{
-            .offset = static_cast<std::uint16_t>(frag_idx * config_.max_fragment_size),
-            .data = std::move(frame->data.payload),
-            .last = frame->data.fin};
+            .offset = static_cast<std::uint16_t>(frag_idx),
+            .data = std::move(frame.data.payload),
+            .last = frame.data.fin};
 
-        LOG_DEBUG("  Fragment: msg_id={}, frag_idx={}, offset={}, size={}, last={}",
-                  msg_id, frag_idx, frag.offset, frag.data.size(), frag.last);
+        LOG_DEBUG("  Fragment: msg_id={}, frag_idx={}, size={}, last={}",
+                  msg_id, frag_idx, frag.data.size(), frag.last);
 
         fragment_reassembly_.push(reassembly_id, std::move(frag), now_fn_());
 
@@ -255,43 +595,77 @@ std::optional<std::vector<mux::MuxFrame>> TransportSession::decrypt_packet(
 
           mux::MuxFrame complete_frame{};
           complete_frame.kind = mux::FrameKind::kData;
-          complete_frame.data.stream_id = frame->data.stream_id;
+          complete_frame.data.stream_id = frame.data.stream_id;
           complete_frame.data.sequence = frame_seq;  // Use original sequence
           complete_frame.data.fin = true;
           complete_frame.data.payload = std::move(*reassembled);
-          frames.push_back(std::move(complete_frame));
+          out.push_back(std::move(complete_frame));
         }
         // If not yet complete, don't add to frames - wait for more fragments
       } else {
         // Complete non-fragmented message - return directly
-        LOG_DEBUG("  Complete message: sequence={}, size={}", frame_seq, frame->data.payload.size());
-        frames.push_back(std::move(*frame));
+        LOG_DEBUG("  Complete message: sequence={}, size={}", frame_seq, frame.data.payload.size());
+        out.push_back(std::move(frame));
+      }
+    } else if (frame.kind == mux::FrameKind::kRepair) {
+      // Consumed here: rebuilt packets are delivered as if they had arrived.
+      if (fec_) {
+        recover_packets(frame.repair, out);
       }
+    } else if (frame.kind == mux::FrameKind::kControl &&
+               frame.control.type == static_cast<std::uint8_t>(mux::ControlType::kAckFrequency)) {
+      // Consumed here: it tunes this session's ACK scheduler.
+      apply_ack_frequency(frame.control.payload, sequence);
+    } else if (frame.kind == mux::FrameKind::kHeartbeat) {
+      // Acknowledged so the sender learns which path MTU probes got through.
+      recv_ack_bitmap_.ack(sequence);
+      heartbeat = true;
+      out.push_back(std::move(frame));
     } else {
       // Non-data frames (ACK, control, heartbeat) - return directly
-      frames.push_back(std::move(*frame));
+      out.push_back(std::move(frame));
     }
-  } else {
-    // Log frame decode failure for debugging (Issue #72)
-    LOG_DEBUG("  Frame decode FAILED: decrypted_size={}, first_byte={:#04x}",
-              decrypted->size(), decrypted->empty() ? 0 : (*decrypted)[0]);
   }
+  return carries_data;
+}
 
-  if (sequence > recv_sequence_max_) {
-    recv_sequence_max_ = sequence;
+void TransportSession::recover_packets(const mux::RepairFrame& repair, std::vector<mux::MuxFrame>& out) {
+  ++stats_.fec_repairs_received;
+  for (auto& packet : fec_decoder_.on_repair(repair)) {
+    // The original never arrived. Marking it in the replay window also drops
+    // it if it turns up late, or its retransmission.
+    if (!replay_window_.mark_and_check(packet.sequence)) {
+      continue;
+    }
+    auto decoded = decode_frames(packet.plaintext, packet.sequence);
+    if (decoded.empty()) {
+      continue;
+    }
+    LOG_DEBUG("  FEC recovered packet: sequence={}, size={}", packet.sequence, packet.plaintext.size());
+    ++stats_.fec_packets_recovered;
+    bool heartbeat = false;
+    if (process_frames(std::move(decoded), packet.sequence, out, heartbeat)) {
+      on_data_packet(packet.sequence);
+    }
   }
-
-  return frames;
 }
 
 std::vector<std::vector<std::uint8_t>> TransportSession::get_retransmit_packets() {
   VEIL_DCHECK_THREAD(thread_checker_);
 
   std::vector<std::vector<std::uint8_t>> result;
+
+  // Close a FEC group that has waited long enough for more packets, so the
+  // tail of a burst is protected too.
+  if (fec_ && !fec_encoder_.empty() && now_fn_() - fec_group_started_ >= config_.fec.max_group_delay) {
+    close_fec_group();
+  }
+  take_fec_repairs(result);
+
   auto to_retransmit = retransmit_buffer_.get_packets_to_retransmit();
 
   // PERFORMANCE (Issue #94): Pre-allocate result vector to avoid reallocations.
-  result.reserve(to_retransmit.size());
+  result.reserve(result.size() + to_retransmit.size());
 
   // Congestion control (Issue #98): Notify controller of timeout-based retransmits.
   // This is a timeout loss event, which should trigger multiplicative decrease.
@@ -348,17 +722,38 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
     }
   }
 
-  // Cumulative ACK.
-  retransmit_buffer_.acknowledge_cumulative(ack.ack);
-
-  // Selective ACK from bitmap.
+  // The ACK names the highest packet received and, in the bitmap, which of
+  // the 32 before it arrived. Packets older than that window were covered by
+  // earlier ACKs; treat them as delivered rather than retransmitting forever.
+  // Gaps inside the window stay pending and are retransmitted. Only the
+  // highest packet gives an RTT sample: the ACK delay is measured from its
+  // arrival, and older packets waited at the peer for longer than that.
+  retransmit_buffer_.acknowledge(ack.ack, ack.ack_delay);
   for (std::uint32_t i = 0; i < 32; ++i) {
-    if (((ack.bitmap >> i) & 1U) != 0U) {
-      std::uint64_t seq = ack.ack - 1 - i;
-      if (seq > 0) {
-        retransmit_buffer_.acknowledge(seq);
-      }
+    if (((ack.bitmap >> i) & 1U) != 0U && ack.ack > i) {
+      retransmit_buffer_.acknowledge_without_sample(ack.ack - 1 - i);
+    }
+  }
+  if (ack.ack > 32) {
+    retransmit_buffer_.acknowledge_cumulative(ack.ack - 33);
+  }
+
+  // Probes count only if the ACK names them: an older one may have been lost.
+  std::erase_if(pending_probes_, [&](const std::pair<std::uint64_t, std::size_t>& probe) {
+    const auto sequence = probe.first;
+    const bool acked = sequence == ack.ack ||
+                       (sequence < ack.ack && ack.ack - sequence <= 32 &&
+                        ((ack.bitmap >> (ack.ack - sequence - 1)) & 1U) != 0U);
+    if (acked) {
+      ++stats_.mtu_probes_acked;
+      acked_probes_.push_back(probe.second);
     }
+    return acked || sequence + 32 < ack.ack;
+  });
+
+  // Everything sent has arrived, so the open FEC group needs no repairs.
+  if (fec_ && retransmit_buffer_.pending_count() == 0) {
+    fec_encoder_.clear();
   }
 
   // Update congestion controller with acknowledged bytes (Issue #98).
@@ -381,11 +776,118 @@ void TransportSession::process_ack(const mux::AckFrame& ack) {
 mux::AckFrame TransportSession::generate_ack(std::uint64_t stream_id) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
-  return mux::AckFrame{
+  mux::AckFrame ack{
       .stream_id = stream_id,
       .ack = recv_ack_bitmap_.head(),
       .bitmap = recv_ack_bitmap_.bitmap(),
   };
+  if (ack_delay_ && largest_received_at_ != TimePoint{}) {
+    ack.ack_delay = std::max(std::chrono::duration_cast<std::chrono::microseconds>(now_fn_() - largest_received_at_),
+                             std::chrono::microseconds{0});
+  }
+  return ack;
+}
+
+std::optional<std::vector<std::uint8_t>> TransportSession::take_ack_packet(bool end_of_burst) {
+  VEIL_DCHECK_THREAD(thread_checker_);
+
+  const auto wait = ack_scheduler_.time_until_next_ack();
+  if (!wait) {
+    return std::nullopt;
+  }
+  const bool due = wait->count() <= 0 || unacked_packets_ >= ack_scheduler_.config().max_pending_acks ||
+                   (end_of_burst && ack_immediate_);
+  if (!due) {
+    return std::nullopt;
+  }
+
+  const auto ack = generate_ack(0);
+  auto packet = encrypt_frame(mux::make_ack_frame(ack.stream_id, ack.ack, ack.bitmap, ack.ack_delay));
+  ++stats_.acks_sent;
+  on_ack_sent();
+  return packet;
+}
+
+void TransportSession::on_data_packet(std::uint64_t sequence) {
+  ++unacked_packets_;
+  if (sequence == recv_ack_bitmap_.head()) {
+    largest_received_at_ = now_fn_();
+  }
+  // Data frames set fin on every complete message (Issue #74), not at the end
+  // of a stream, so it is not passed on as a reason to ACK immediately.
+  if (ack_scheduler_.on_packet_received(0, sequence, false)) {
+    ack_immediate_ = true;
+  }
+}
+
+void TransportSession::on_ack_sent() {
+  ack_scheduler_.ack_sent(0);
+  ack_immediate_ = false;
+  unacked_packets_ = 0;
+}
+
+std::optional<mux::MuxFrame> TransportSession::take_ack_frequency_frame() {
+  // Until the first RTT sample the peer keeps its configured defaults.
+  if (!config_.ack_frequency.enabled || !retransmit_buffer_.has_rtt_sample()) {
+    return std::nullopt;
+  }
+  const auto srtt = retransmit_buffer_.estimated_rtt();
+  const auto wanted = mux::choose_ack_frequency(
+      config_.ack_frequency, congestion_controller_.cwnd(), config_.congestion_config.mss, srtt,
+      congestion_controller_.state());
+  const auto now = now_fn_();
+  if (ack_frequency_requested_) {
+    // Asking for more ACKs (e.g. on loss) goes out at once; fewer ACKs can
+    // wait until the previous request has had a round trip to take effect.
+    const auto since = now - ack_frequency_requested_at_;
+    const auto& last = *ack_frequency_requested_;
+    const bool more_acks = wanted.packet_threshold < last.packet_threshold || wanted.max_ack_delay < last.max_ack_delay;
+    if (wanted == last ? since < config_.ack_frequency.refresh_interval : !more_acks && since < srtt) {
+      return std::nullopt;
+    }
+  }
+  ack_frequency_requested_ = wanted;
+  ack_frequency_requested_at_ = now;
+  if (ack_delay_) {
+    // A shorter requested delay does not shorten the RTO. The peer applies the
+    // request only once it arrives, and peers that do not know the frame keep
+    // their own delay. While a queue builds up in slow start, the smaller
+    // margin would also fire spurious timeouts, each collapsing cwnd.
+    retransmit_buffer_.set_peer_max_ack_delay(
+        std::max<std::chrono::microseconds>(wanted.max_ack_delay, config_.ack_config.max_ack_delay));
+  }
+  ++stats_.ack_frequency_sent;
+  return mux::make_control_frame(static_cast<std::uint8_t>(mux::ControlType::kAckFrequency),
+                                 mux::encode_ack_frequency(wanted));
+}
+
+void TransportSession::apply_ack_frequency(std::span<const std::uint8_t> payload, std::uint64_t sequence) {
+  const auto frequency = mux::decode_ack_frequency(payload);
+  if (!frequency || (ack_frequency_packet_ && sequence <= *ack_frequency_packet_)) {
+    return;
+  }
+  LOG_DEBUG("ACK frequency from peer: threshold={}, max_delay={}us", frequency->packet_threshold,
+            frequency->max_ack_delay.count());
+  ack_frequency_packet_ = sequence;
+  ack_scheduler_.set_ack_frequency(*frequency);
+  ++stats_.ack_frequency_applied;
+}
+
+HibernatedTransport TransportSession::hibernate() const {
+  HibernatedTransport state;
+  state.keys = keys_;
+  state.session_id = current_session_id_;
+  state.send_sequence = send_sequence_;
+  // Only authenticated packets move recv_sequence_max_, so it is the head to
+  // keep; everything at or below it is treated as seen after resuming.
+  state.recv_sequence_max = recv_sequence_max_;
+  state.message_id_counter = message_id_counter_;
+  state.aead = send_cipher_.algorithm();
+  state.compact_frames = frame_format_ == mux::FrameFormat::kCompact;
+  state.fec = fec_;
+  state.ack_delay = ack_delay_;
+  state.received = replay_window_.initialized();
+  return state;
 }
 
 bool TransportSession::should_rotate_session() {
@@ -442,7 +944,33 @@ void TransportSession::rotate_session() {
             current_session_id_, send_sequence_);
 }
 
-std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::MuxFrame& frame) {
+std::vector<std::uint8_t> TransportSession::build_encrypted_packet(std::span<const mux::MuxFrame> frames) {
+  return seal_packet(encode_frames(frames));
+}
+
+std::vector<std::uint8_t> TransportSession::encode_frames(std::span<const mux::MuxFrame> frames) const {
+  // Serialize the frames. Compact frames truncate the message number against
+  // this packet's sequence, which the receiver recovers from the header; all
+  // but the last carry their length.
+  std::vector<std::uint8_t> plaintext;
+  if (frame_format_ == mux::FrameFormat::kCompact) {
+    std::size_t plaintext_size = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+      plaintext_size += mux::MuxCodec::compact_encoded_size(frames[i], send_sequence_, i + 1 == frames.size());
+    }
+    plaintext.resize(plaintext_size);
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+      offset += mux::MuxCodec::encode_compact_to(frames[i], send_sequence_, i + 1 == frames.size(),
+                                                 std::span<std::uint8_t>(plaintext).subspan(offset));
+    }
+  } else {
+    plaintext = mux::MuxCodec::encode(frames.front());
+  }
+  return plaintext;
+}
+
+std::vector<std::uint8_t> TransportSession::seal_packet(std::span<const std::uint8_t> plaintext) {
   // SECURITY: Check for sequence number overflow (extremely unlikely but provides defense in depth)
   // At 10 Gbps with 1KB packets, reaching this threshold would take millions of years,
   // but we check anyway to catch any implementation bugs that might cause unexpected growth.
@@ -454,22 +982,19 @@ std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::Mu
     // A production system might want to force session termination here.
   }
 
-  // Serialize the frame.
-  auto plaintext = mux::MuxCodec::encode(frame);
-
   // Derive nonce from current send sequence.
   // SECURITY: Each packet gets a unique nonce = base_nonce XOR send_sequence_
   // Since send_sequence_ is never reset and always increments, nonces are guaranteed unique.
   const auto nonce = crypto::derive_nonce(keys_.send_nonce, send_sequence_);
 
-  // Encrypt using ChaCha20-Poly1305 AEAD.
-  auto ciphertext = crypto::aead_encrypt(keys_.send_key, nonce, {}, plaintext);
+  // Encrypt with the negotiated AEAD.
+  auto ciphertext = send_cipher_.encrypt(nonce, connection_id_bytes_, plaintext);
 
   // DPI RESISTANCE (Issue #21): Obfuscate sequence number before transmission.
   // Previously, the sequence was sent in plaintext, creating a DPI signature (monotonically
-  // increasing values). Now we obfuscate it using ChaCha20 with a session-specific key.
-  // The receiver can deobfuscate using the same key to recover the sequence for nonce derivation.
-  const std::uint64_t obfuscated_sequence = crypto::obfuscate_sequence(send_sequence_, send_seq_obfuscation_key_);
+  // increasing values). Now we pass it through a keyed 64-bit permutation (SequenceObfuscator).
+  // The receiver inverts it with the same key to recover the sequence for nonce derivation.
+  const std::uint64_t obfuscated_sequence = send_seq_obfuscator_.obfuscate(send_sequence_);
 
   // Enhanced diagnostic logging for encryption (Issue #69)
   // Log key fingerprints (first 4 bytes) to help diagnose key mismatch between client and server
@@ -478,13 +1003,11 @@ std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::Mu
             current_session_id_, send_sequence_, obfuscated_sequence, plaintext.size(),
             keys_.send_key[0], keys_.send_key[1], keys_.send_key[2], keys_.send_key[3],
             keys_.send_nonce[0], keys_.send_nonce[1], keys_.send_nonce[2], keys_.send_nonce[3]);
-  LOG_DEBUG("  send_seq_obfuscation_key_fp={:02x}{:02x}{:02x}{:02x}",
-            send_seq_obfuscation_key_[0], send_seq_obfuscation_key_[1],
-            send_seq_obfuscation_key_[2], send_seq_obfuscation_key_[3]);
 
-  // Prepend obfuscated sequence number (8 bytes big-endian).
+  // Prepend connection ID and obfuscated sequence number (8 bytes big-endian each).
   std::vector<std::uint8_t> packet;
-  packet.reserve(8 + ciphertext.size());
+  packet.reserve(kConnectionIdSize + 8 + ciphertext.size());
+  packet.insert(packet.end(), connection_id_bytes_.begin(), connection_id_bytes_.end());
   for (int i = 7; i >= 0; --i) {
     packet.push_back(static_cast<std::uint8_t>((obfuscated_sequence >> (8 * i)) & 0xFF));
   }
@@ -497,6 +1020,28 @@ std::vector<std::uint8_t> TransportSession::build_encrypted_packet(const mux::Mu
   return packet;
 }
 
+std::vector<mux::MuxFrame> TransportSession::decode_frames(std::span<const std::uint8_t> plaintext,
+                                                          std::uint64_t packet_sequence) const {
+  std::vector<mux::MuxFrame> frames;
+  if (frame_format_ == mux::FrameFormat::kLegacy) {
+    if (auto frame = mux::MuxCodec::decode(plaintext)) {
+      frames.push_back(std::move(*frame));
+    }
+    return frames;
+  }
+  while (!plaintext.empty()) {
+    std::size_t consumed = 0;
+    auto frame = mux::MuxCodec::decode_compact(plaintext, packet_sequence, consumed);
+    if (!frame) {
+      frames.clear();
+      break;
+    }
+    frames.push_back(std::move(*frame));
+    plaintext = plaintext.subspan(consumed);
+  }
+  return frames;
+}
+
 std::vector<mux::MuxFrame> TransportSession::fragment_data(std::span<const std::uint8_t> data,
                                                             std::uint64_t stream_id, bool fin) {
   // Issue #74: The 'fin' parameter is intentionally ignored. We always set fin=true on the
@@ -509,12 +1054,12 @@ std::vector<mux::MuxFrame> TransportSession::fragment_data(std::span<const std::
 
   // PERFORMANCE (Issue #94): Pre-calculate number of fragments and reserve capacity.
   // This avoids vector reallocations during fragment generation.
-  if (data.size() > config_.max_fragment_size) {
-    const std::size_t num_fragments = (data.size() + config_.max_fragment_size - 1) / config_.max_fragment_size;
+  if (data.size() > unfragmented_size_) {
+    const std::size_t num_fragments = (data.size() + fragment_size_ - 1) / fragment_size_;
     frames.reserve(num_fragments);
   }
 
-  if (data.size() <= config_.max_fragment_size) {
+  if (data.size() <= unfragmented_size_) {
     // No fragmentation needed. Always set fin=true to indicate complete message.
     // Issue #74: Without fin=true, receiver can't distinguish complete messages from fragments.
     frames.push_back(mux::make_data_frame(
@@ -534,7 +1079,7 @@ std::vector<mux::MuxFrame> TransportSession::fragment_data(std::span<const std::
   std::uint64_t frag_seq = 0;
 
   while (offset < data.size()) {
-    const std::size_t chunk_size = std::min(config_.max_fragment_size, data.size() - offset);
+    const std::size_t chunk_size = std::min(fragment_size_, data.size() - offset);
     const bool is_last = (offset + chunk_size >= data.size());
     // Issue #74: Always set fin=true on last fragment so receiver can detect message completion.
     // This enables proper fragment reassembly regardless of caller's fin parameter.
@@ -586,6 +1131,22 @@ std::optional<std::chrono::microseconds> TransportSession::time_until_next_send(
   return congestion_controller_.time_until_next_send();
 }
 
+std::optional<TransportSession::TimePoint> TransportSession::next_timer_deadline() const {
+  auto deadline = retransmit_buffer_.next_retry_time();
+  const auto earliest = [&deadline](TimePoint candidate) {
+    if (!deadline || candidate < *deadline) {
+      deadline = candidate;
+    }
+  };
+  if (auto ack_due = ack_scheduler_.time_until_next_ack()) {
+    earliest(now_fn_() + std::max(*ack_due, std::chrono::milliseconds(0)));
+  }
+  if (fec_ && !fec_encoder_.empty()) {
+    earliest(fec_group_started_ + config_.fec.max_group_delay);
+  }
+  return deadline;
+}
+
 // ========== Zero-Copy Packet Processing API (Issue #97) ==========
 
 std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decrypt_packet_zero_copy(
@@ -593,14 +1154,23 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
     std::span<std::uint8_t> decrypt_buffer) {
   VEIL_DCHECK_THREAD(thread_checker_);
 
-  // Minimum packet size: sequence (8 bytes) + tag (16 bytes) + header (1 byte minimum)
-  constexpr std::size_t kMinPacketSize = 8 + 16 + 1;
+  last_packet_advanced_ = false;
+
+  // Minimum packet size: connection ID (8) + sequence (8 bytes) + tag (16 bytes) + header (1 byte minimum)
+  constexpr std::size_t kMinPacketSize = kConnectionIdSize + 8 + 16 + 1;
   if (ciphertext.size() < kMinPacketSize) {
     LOG_DEBUG("Zero-copy: Packet too small: {} bytes", ciphertext.size());
     ++stats_.packets_dropped_decrypt;
     return std::nullopt;
   }
 
+  if (peek_connection_id(ciphertext) != connection_id_) {
+    LOG_DEBUG("Zero-copy: Connection ID mismatch for session_id={}", current_session_id_);
+    ++stats_.packets_dropped_decrypt;
+    return std::nullopt;
+  }
+  ciphertext = ciphertext.subspan(kConnectionIdSize);
+
   // Extract obfuscated sequence from first 8 bytes.
   std::uint64_t obfuscated_sequence = 0;
   for (int i = 0; i < 8; ++i) {
@@ -608,7 +1178,7 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
   }
 
   // Deobfuscate sequence number.
-  const std::uint64_t sequence = crypto::deobfuscate_sequence(obfuscated_sequence, recv_seq_obfuscation_key_);
+  const std::uint64_t sequence = recv_seq_obfuscator_.deobfuscate(obfuscated_sequence);
 
   LOG_DEBUG("Zero-copy decrypt: session_id={}, pkt_size={}, seq={}", current_session_id_, ciphertext.size(), sequence);
 
@@ -635,8 +1205,8 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
   }
 
   // PERFORMANCE (Issue #97): Use zero-copy decryption into provided buffer.
-  const std::size_t plaintext_size = crypto::aead_decrypt_to(
-      keys_.recv_key, nonce, {}, ciphertext_body, decrypt_buffer);
+  const std::size_t plaintext_size =
+      recv_cipher_.decrypt_to(nonce, connection_id_bytes_, ciphertext_body, decrypt_buffer);
 
   if (plaintext_size == 0) {
     LOG_DEBUG("Zero-copy: Decryption failed: sequence={}", sequence);
@@ -649,11 +1219,21 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
             current_session_id_, sequence, plaintext_size);
 
   ++stats_.packets_received;
-  stats_.bytes_received += ciphertext.size();
+  stats_.bytes_received += ciphertext.size() + kConnectionIdSize;
 
   // PERFORMANCE (Issue #97): Use zero-copy frame decoding.
   // The frame view borrows data from decrypt_buffer, so caller must keep buffer alive.
-  auto frame_view = mux::MuxCodec::decode_view(decrypt_buffer.subspan(0, plaintext_size));
+  const auto plaintext = decrypt_buffer.subspan(0, plaintext_size);
+  std::optional<mux::MuxFrameView> frame_view;
+  if (frame_format_ == mux::FrameFormat::kCompact) {
+    std::size_t consumed = 0;
+    frame_view = mux::MuxCodec::decode_compact_view(plaintext, sequence, consumed);
+    if (frame_view && consumed != plaintext.size()) {
+      frame_view.reset();
+    }
+  } else {
+    frame_view = mux::MuxCodec::decode_view(plaintext);
+  }
   if (!frame_view) {
     LOG_WARN("Zero-copy: Frame decode FAILED: plaintext_size={}", plaintext_size);
     return std::nullopt;
@@ -662,10 +1242,17 @@ std::optional<std::pair<mux::MuxFrameView, std::size_t>> TransportSession::decry
   if (frame_view->kind == mux::FrameKind::kData) {
     ++stats_.fragments_received;
     recv_ack_bitmap_.ack(sequence);
+    if (fec_) {
+      fec_decoder_.on_packet(sequence, plaintext);
+    }
+    on_data_packet(sequence);
   }
 
-  if (sequence > recv_sequence_max_) {
+  // The replay window has already rejected duplicates, so equality only
+  // happens for the very first packet (sequence 0).
+  if (sequence >= recv_sequence_max_) {
     recv_sequence_max_ = sequence;
+    last_packet_advanced_ = true;
   }
 
   return std::make_pair(*frame_view, plaintext_size);
@@ -681,23 +1268,30 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   }
 
   // Calculate required sizes.
-  const std::size_t plaintext_size = mux::MuxCodec::encoded_size(frame);
+  const bool compact = frame_format_ == mux::FrameFormat::kCompact;
+  const std::size_t plaintext_size = compact ? mux::MuxCodec::compact_encoded_size(frame, send_sequence_, true)
+                                             : mux::MuxCodec::encoded_size(frame);
   const std::size_t ciphertext_size = crypto::aead_ciphertext_size(plaintext_size);
-  const std::size_t total_size = 8 + ciphertext_size;  // 8 bytes for sequence prefix
+  const std::size_t total_size = kConnectionIdSize + 8 + ciphertext_size;  // connection ID + sequence prefix
 
   if (output_buffer.size() < total_size) {
     LOG_DEBUG("Zero-copy encrypt: Output buffer too small: {} < {}", output_buffer.size(), total_size);
     return 0;
   }
 
-  // PERFORMANCE (Issue #97): Reuse scratch buffer for frame encoding.
-  if (encode_scratch_buffer_.capacity() < plaintext_size) {
-    encode_scratch_buffer_.reserve(std::max(plaintext_size, static_cast<std::size_t>(2048)));
+  // PERFORMANCE (Issue #97): Reuse scratch buffer for frame encoding. It is
+  // shared by all sessions on the thread rather than kept per session.
+  thread_local std::vector<std::uint8_t> encode_scratch_buffer;
+  if (encode_scratch_buffer.capacity() < plaintext_size) {
+    encode_scratch_buffer.reserve(std::max(plaintext_size, static_cast<std::size_t>(2048)));
   }
-  encode_scratch_buffer_.resize(plaintext_size);
+  encode_scratch_buffer.resize(plaintext_size);
 
   // Encode frame into scratch buffer.
-  const std::size_t encoded_size = mux::MuxCodec::encode_to(frame, encode_scratch_buffer_);
+  const std::size_t encoded_size = compact
+                                       ? mux::MuxCodec::encode_compact_to(frame, send_sequence_, true,
+                                                                          encode_scratch_buffer)
+                                       : mux::MuxCodec::encode_to(frame, encode_scratch_buffer);
   if (encoded_size == 0) {
     LOG_DEBUG("Zero-copy encrypt: Frame encoding failed");
     return 0;
@@ -707,19 +1301,20 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   const auto nonce = crypto::derive_nonce(keys_.send_nonce, send_sequence_);
 
   // Obfuscate sequence for DPI resistance.
-  const std::uint64_t obfuscated_sequence = crypto::obfuscate_sequence(send_sequence_, send_seq_obfuscation_key_);
+  const std::uint64_t obfuscated_sequence = send_seq_obfuscator_.obfuscate(send_sequence_);
 
-  // Write obfuscated sequence prefix (8 bytes big-endian).
+  // Write connection ID and obfuscated sequence prefix (8 bytes big-endian each).
+  std::copy(connection_id_bytes_.begin(), connection_id_bytes_.end(), output_buffer.begin());
   for (int i = 7; i >= 0; --i) {
-    output_buffer[static_cast<std::size_t>(7 - i)] =
+    output_buffer[kConnectionIdSize + static_cast<std::size_t>(7 - i)] =
         static_cast<std::uint8_t>((obfuscated_sequence >> (8 * i)) & 0xFF);
   }
 
   // PERFORMANCE (Issue #97): Use zero-copy encryption into output buffer.
-  const std::size_t encrypted_size = crypto::aead_encrypt_to(
-      keys_.send_key, nonce, {},
-      std::span<const std::uint8_t>(encode_scratch_buffer_.data(), encoded_size),
-      output_buffer.subspan(8));
+  const std::size_t encrypted_size = send_cipher_.encrypt_to(
+      nonce, connection_id_bytes_,
+      std::span<const std::uint8_t>(encode_scratch_buffer.data(), encoded_size),
+      output_buffer.subspan(kConnectionIdSize + 8));
 
   if (encrypted_size == 0) {
     LOG_DEBUG("Zero-copy encrypt: Encryption failed");
@@ -727,12 +1322,12 @@ std::size_t TransportSession::encrypt_frame_zero_copy(const mux::MuxFrame& frame
   }
 
   LOG_DEBUG("Zero-copy encrypt: session_id={}, sequence={}, plaintext_size={}, total_size={}",
-            current_session_id_, send_sequence_, plaintext_size, 8 + encrypted_size);
+            current_session_id_, send_sequence_, plaintext_size, kConnectionIdSize + 8 + encrypted_size);
 
   // Increment sequence after successful encryption.
   ++send_sequence_;
 
-  return 8 + encrypted_size;
+  return kConnectionIdSize + 8 + encrypted_size;
 }
 
 }  // namespace veil::transport
@@ -9,13 +9,16 @@
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/crypto/hardware_crypto.h"
 #include "common/handshake/handshake_processor.h"
 #include "common/session/replay_window.h"
 #include "common/session/session_rotator.h"
 #include "common/utils/packet_pool.h"
 #include "common/utils/thread_checker.h"
 #include "transport/mux/ack_bitmap.h"
+#include "transport/mux/ack_scheduler.h"
 #include "transport/mux/congestion_controller.h"
+#include "transport/mux/fec.h"
 #include "transport/mux/fragment_reassembly.h"
 #include "transport/mux/mux_codec.h"
 #include "transport/mux/reorder_buffer.h"
@@ -23,12 +26,20 @@
 
 namespace veil::transport {
 
+// Every packet starts with the session's connection ID.
+inline constexpr std::size_t kConnectionIdSize = 8;
+
+// Smallest datagram set_mtu() accepts: what every IPv6 path carries (1280)
+// minus the IPv6 and UDP headers.
+inline constexpr std::size_t kMinPathMtu = 1280 - 40 - 8;
+
 // Configuration for transport session behavior.
 struct TransportSessionConfig {
   // MTU for outgoing packets (excluding IP/UDP overhead).
   std::size_t mtu{1400};
   // Maximum fragment size (should be <= mtu - header overhead).
-  std::size_t max_fragment_size{1350};
+  // Overhead: connection ID (8) + sequence (8) + AEAD tag (16) + data frame header (20).
+  std::size_t max_fragment_size{1342};
   // Replay window size in bits.
   std::size_t replay_window_size{1024};
   // Session rotation interval.
@@ -45,6 +56,16 @@ struct TransportSessionConfig {
   mux::CongestionConfig congestion_config{};
   // Enable congestion control.
   bool enable_congestion_control{true};
+  // Delayed-ACK policy for received data (see take_ack_packet()). The peer
+  // may tune the threshold and delay at runtime with ACK frequency requests.
+  mux::AckSchedulerConfig ack_config{};
+  // ACK frequency this side requests of the peer, from its congestion
+  // window and SRTT. Requests ride on outgoing data (compact frames only).
+  mux::AckFrequencyConfig ack_frequency{};
+  // Forward error correction, used when negotiated in the handshake. Both
+  // peers then reserve mux::kFecRepairOverhead bytes of each datagram
+  // (max_fragment_size and mtu) so repair packets fit in the MTU.
+  mux::FecConfig fec{};
 };
 
 // Statistics for observability.
@@ -61,6 +82,51 @@ struct TransportStats {
   std::uint64_t messages_reassembled{0};
   std::uint64_t retransmits{0};
   std::uint64_t session_rotations{0};
+  std::uint64_t frames_coalesced{0};  // Frames that shared a datagram with an earlier frame
+  std::uint64_t acks_sent{0};         // Standalone ACK datagrams from take_ack_packet()
+  std::uint64_t acks_piggybacked{0};  // ACKs carried in a data datagram
+  std::uint64_t fec_repairs_sent{0};       // Repair datagrams (forward error correction)
+  std::uint64_t fec_repairs_received{0};   // Repair frames received
+  std::uint64_t fec_packets_recovered{0};  // Lost packets rebuilt from repair frames
+  std::uint64_t mtu_probes_sent{0};        // Path MTU probes from encrypt_probe()
+  std::uint64_t mtu_probes_acked{0};       // Probes the peer acknowledged
+  std::uint64_t ack_frequency_sent{0};     // ACK frequency requests sent to the peer
+  std::uint64_t ack_frequency_applied{0};  // Requests from the peer applied to the ACK scheduler
+};
+
+// What an idle session needs to carry on without a new handshake (see
+// TransportSession::hibernate()): keys, negotiated options, sequence
+// counters and the head of the replay window. Windows, buffers and
+// congestion state are rebuilt fresh, as after any idle period.
+struct HibernatedTransport {
+  crypto::SessionKeys keys;
+  std::uint64_t session_id{0};
+  std::uint64_t send_sequence{0};
+  std::uint64_t recv_sequence_max{0};
+  std::uint64_t message_id_counter{0};
+  crypto::AeadAlgorithm aead{crypto::AeadAlgorithm::kChaCha20Poly1305};
+  bool compact_frames{false};
+  bool fec{false};
+  bool ack_delay{false};
+  // False if no packet was ever received (the replay window is empty).
+  bool received{false};
+
+  // SECURITY: Clear the key material once the state is no longer needed.
+  void wipe();
+};
+
+// A payload to be sent by TransportSession::encrypt_coalesced().
+struct CoalescedPayload {
+  std::uint64_t stream_id{0};
+  std::span<const std::uint8_t> data;
+};
+
+// A received datagram authenticated and decrypted by
+// TransportSession::open_packet(), for TransportSession::accept_packet().
+struct OpenedPacket {
+  std::uint64_t sequence{0};
+  std::size_t size{0};  // Datagram size
+  std::vector<std::uint8_t> plaintext;
 };
 
 /**
@@ -89,6 +155,11 @@ class TransportSession {
                    TransportSessionConfig config = {},
                    std::function<TimePoint()> now_fn = Clock::now);
 
+  // Resume a hibernated session. Sequence numbers continue where they left
+  // off; packets at or below the recorded replay head are rejected.
+  explicit TransportSession(const HibernatedTransport& state, TransportSessionConfig config = {},
+                            std::function<TimePoint()> now_fn = Clock::now);
+
   /// SECURITY: Destructor clears all session key material
   ~TransportSession();
 
@@ -112,12 +183,53 @@ class TransportSession {
   // Returns a single encrypted packet.
   std::vector<std::uint8_t> encrypt_frame(const mux::MuxFrame& frame);
 
+  // Encrypt several payloads, packing as many frames into each datagram as
+  // fit in config.mtu. Payloads keep their order; large ones are fragmented
+  // as in encrypt_data(). Packing needs the compact frame format; with legacy
+  // frames every frame gets its own datagram.
+  //
+  // With compact frames, encrypt_data() and encrypt_coalesced() put a pending
+  // ACK for received data after the last data frame, so a busy peer sends
+  // no separate ACK datagrams.
+  std::vector<std::vector<std::uint8_t>> encrypt_coalesced(std::span<const CoalescedPayload> payloads);
+
+  // Path MTU probe: a heartbeat padded so the datagram is exactly `size`
+  // bytes. The peer acknowledges it like data (older peers ignore it), but it
+  // is never retransmitted; take_acked_probes() reports the sizes that got
+  // through. Returns nullopt if size is below the smallest heartbeat packet.
+  std::optional<std::vector<std::uint8_t>> encrypt_probe(std::size_t size);
+
+  // Sizes of the probes acknowledged since the last call.
+  std::vector<std::size_t> take_acked_probes();
+
+  // Datagram size allowed on the path, e.g. as found by probing. Above
+  // config.mtu, fragments keep max_fragment_size and larger messages go
+  // unfragmented; below it, fragments shrink by the difference. Coalesced
+  // frames share datagrams of the new size either way. Sizes below
+  // kMinPathMtu (or config.mtu, if smaller) are raised to it.
+  void set_mtu(std::size_t mtu);
+  std::size_t mtu() const { return mtu_; }
+
+  // Largest payload encrypt_data() sends in one datagram at the current MTU.
+  std::size_t max_unfragmented_payload() const { return unfragmented_size_; }
+
   // Decrypt and process a received packet.
   // Returns decrypted mux frames if successful.
   // Performs replay check and decryption.
   std::optional<std::vector<mux::MuxFrame>> decrypt_packet(std::span<const std::uint8_t> ciphertext);
 
-  // Get packets that need retransmission.
+  // decrypt_packet() in two steps, so the AEAD work can run outside the
+  // caller's lock when the session is shared between threads. open_packet()
+  // only reads the receive keys, which never change, and may run
+  // concurrently with any method but accept_packet() and decrypt_packet();
+  // failures are not counted in stats(). accept_packet() does the rest:
+  // replay check, statistics and frame processing.
+  std::optional<OpenedPacket> open_packet(std::span<const std::uint8_t> ciphertext) const;
+  std::optional<std::vector<mux::MuxFrame>> accept_packet(OpenedPacket packet);
+
+  // Get packets that need retransmission. With FEC, this also closes a
+  // partly filled group once fec.max_group_delay has passed and returns its
+  // repair packets, so it should be called periodically while data is in flight.
   std::vector<std::vector<std::uint8_t>> get_retransmit_packets();
 
   // Process an ACK frame (acknowledges sent packets).
@@ -126,6 +238,31 @@ class TransportSession {
   // Generate an ACK frame for received packets on a stream.
   mux::AckFrame generate_ack(std::uint64_t stream_id);
 
+  // Standalone ACK datagram for data received so far, for when no outgoing
+  // data has carried it. Returns nullopt unless an ACK is due: the delayed-ACK
+  // timer expired or max_pending_acks packets are unacknowledged (both from
+  // ack_config, as tuned by the peer's ACK frequency requests);
+  // with end_of_burst, also when the scheduler asked for an immediate ACK
+  // (gap, FIN, every N packets). Call it after each received datagram, with
+  // end_of_burst once a receive burst is drained and queued data was sent,
+  // and from the maintenance timer.
+  std::optional<std::vector<std::uint8_t>> take_ack_packet(bool end_of_burst = false);
+
+  // Time until the delayed-ACK timer fires; nullopt if no ACK is pending.
+  std::optional<std::chrono::milliseconds> time_until_ack() const { return ack_scheduler_.time_until_next_ack(); }
+
+  // Earliest time get_retransmit_packets() or take_ack_packet() has work to
+  // do: the next retransmit timeout, the delayed-ACK deadline, or the close
+  // of a partly filled FEC group. nullopt if nothing is pending. Scans the
+  // retransmit buffer, so call it once after servicing the session rather
+  // than per packet.
+  std::optional<TimePoint> next_timer_deadline() const;
+
+  // Capture the state needed to resume this session later. Only meaningful
+  // when next_timer_deadline() is nullopt (nothing in flight, no ACK due);
+  // anything still pending is lost.
+  HibernatedTransport hibernate() const;
+
   // Check if session should rotate (time or packet count threshold).
   bool should_rotate_session();
 
@@ -139,6 +276,40 @@ class TransportSession {
   // Get current session ID.
   std::uint64_t session_id() const { return current_session_id_; }
 
+  // Connection ID carried in the clear at the start of every packet.
+  // Derived from the session keys; stable for the lifetime of the session and
+  // independent of the peer's address, so it survives NAT rebinding.
+  std::uint64_t connection_id() const { return connection_id_; }
+
+  // AEAD algorithm negotiated in the handshake.
+  crypto::AeadAlgorithm aead_algorithm() const { return send_cipher_.algorithm(); }
+
+  // Mux frame encoding negotiated in the handshake.
+  mux::FrameFormat frame_format() const { return frame_format_; }
+
+  // True if forward error correction was negotiated in the handshake.
+  bool fec_enabled() const { return fec_; }
+
+  // Smoothed RTT (ACK delay compensated) and windowed minimum RTT, at
+  // microsecond resolution.
+  std::chrono::microseconds smoothed_rtt() const { return retransmit_buffer_.estimated_rtt(); }
+  std::chrono::microseconds min_rtt() const { return retransmit_buffer_.min_rtt(); }
+
+  // Read the connection ID of a received packet without decrypting it.
+  // Returns nullopt if the packet is too short.
+  static std::optional<std::uint64_t> peek_connection_id(std::span<const std::uint8_t> packet);
+
+  // Check a received packet against a hibernated session without rebuilding
+  // it: true if it is for that connection, newer than anything the session
+  // received, and decrypts with its receive key. Lets a server resume a
+  // session only for authentic traffic.
+  static bool authenticate(const HibernatedTransport& state, std::span<const std::uint8_t> ciphertext);
+
+  // True if the last successfully decrypted packet had the highest sequence
+  // seen so far. Reordered or delayed packets return false; only such packets
+  // may move a session to a new peer address.
+  bool last_packet_advanced() const { return last_packet_advanced_; }
+
   // Get current send sequence number.
   std::uint64_t send_sequence() const { return send_sequence_; }
 
@@ -178,6 +349,15 @@ class TransportSession {
   // Get time until pacing allows next send.
   std::optional<std::chrono::microseconds> time_until_next_send() const;
 
+  // Pacing rate in bytes per second; 0 without congestion control.
+  std::size_t pacing_rate() const {
+    return config_.enable_congestion_control ? congestion_controller_.pacing_rate() : 0;
+  }
+
+  // Make the calling thread the owner checked in debug builds, for callers
+  // that hand the session between threads under their own lock.
+  void bind_to_current_thread() { VEIL_THREAD_REBIND(thread_checker_); }
+
   // ========== Zero-Copy Packet Processing API ==========
   // PERFORMANCE (Issue #97): Zero-copy packet processing methods.
   // These methods use pre-allocated buffers from the packet pool to avoid allocations.
@@ -185,7 +365,9 @@ class TransportSession {
   // Decrypt packet into a pre-allocated buffer and return frame view.
   // The caller provides the decryption buffer which must outlive the returned frame view.
   // Returns the frame view and the size of plaintext written to decrypt_buffer.
-  // Returns nullopt if decryption fails.
+  // Returns nullopt if decryption fails. Datagrams carrying several frames
+  // (see encrypt_coalesced()) are rejected, and FEC repair frames are only
+  // acted on by decrypt_packet().
   std::optional<std::pair<mux::MuxFrameView, std::size_t>> decrypt_packet_zero_copy(
       std::span<const std::uint8_t> ciphertext,
       std::span<std::uint8_t> decrypt_buffer);
@@ -200,8 +382,75 @@ class TransportSession {
   utils::PacketPool& packet_pool() { return packet_pool_; }
 
  private:
-  // Build an encrypted packet from mux frame.
-  std::vector<std::uint8_t> build_encrypted_packet(const mux::MuxFrame& frame);
+  // Build an encrypted packet from mux frames. Several frames require the
+  // compact frame format.
+  std::vector<std::uint8_t> build_encrypted_packet(std::span<const mux::MuxFrame> frames);
+  std::vector<std::uint8_t> build_encrypted_packet(const mux::MuxFrame& frame) {
+    return build_encrypted_packet(std::span<const mux::MuxFrame>(&frame, 1));
+  }
+
+  // Serialize frames for the next packet (send_sequence_).
+  std::vector<std::uint8_t> encode_frames(std::span<const mux::MuxFrame> frames) const;
+
+  // Encrypt a serialized packet with the next sequence number.
+  std::vector<std::uint8_t> seal_packet(std::span<const std::uint8_t> plaintext);
+
+  // Seal the repair frames of the open FEC group into fec_repair_packets_.
+  void close_fec_group();
+
+  // Move queued repair packets to the end of out.
+  void take_fec_repairs(std::vector<std::vector<std::uint8_t>>& out);
+
+  // Encrypt frames as one datagram, tracking it for retransmission if it
+  // carries data.
+  std::vector<std::uint8_t> send_frames(std::span<const mux::MuxFrame> frames);
+
+  // Send data frames, a pending ACK after the last. With pack_data,
+  // data frames share datagrams as far as the MTU allows; otherwise each has
+  // its own. Legacy frames always get one datagram each.
+  std::vector<std::vector<std::uint8_t>> send_data_frames(std::vector<mux::MuxFrame> frames, bool pack_data);
+
+  // Feed a received data packet to the ACK scheduler.
+  void on_data_packet(std::uint64_t sequence);
+
+  // Reset ACK state after an ACK went out.
+  void on_ack_sent();
+
+  // ACK frequency request to carry with outgoing data, if the frequency
+  // wanted for the current congestion state differs from the last request
+  // (at most once per SRTT) or the last request is due a refresh.
+  std::optional<mux::MuxFrame> take_ack_frequency_frame();
+
+  // Apply an ACK frequency request from the peer carried by the packet with
+  // the given sequence, unless a later packet's request was applied already.
+  void apply_ack_frequency(std::span<const std::uint8_t> payload, std::uint64_t sequence);
+
+  // Handle the decoded frames of a packet: reassemble fragments and move
+  // complete messages and control frames to out. Returns true if the packet
+  // carried data; heartbeat is set if it carried a heartbeat, which is
+  // acknowledged like data but not FEC-protected.
+  bool process_frames(std::vector<mux::MuxFrame> decoded, std::uint64_t sequence, std::vector<mux::MuxFrame>& out,
+                      bool& heartbeat);
+
+  // Deliver the packets a repair frame lets the FEC decoder rebuild.
+  void recover_packets(const mux::RepairFrame& repair, std::vector<mux::MuxFrame>& out);
+
+  // Sequence number of a datagram for this connection; nullopt if it is too
+  // short or carries another connection ID.
+  std::optional<std::uint64_t> read_sequence(std::span<const std::uint8_t> ciphertext) const;
+
+  // Authenticate and decrypt a datagram with the given sequence number.
+  std::optional<std::vector<std::uint8_t>> open_sequence(std::span<const std::uint8_t> ciphertext,
+                                                         std::uint64_t sequence) const;
+
+  // Count and process a datagram that passed the replay check.
+  std::vector<mux::MuxFrame> deliver_packet(std::uint64_t sequence, std::size_t size,
+                                            std::span<const std::uint8_t> plaintext);
+
+  // Parse the frames of a decrypted packet in the negotiated frame format.
+  // Returns an empty vector if any frame is malformed.
+  std::vector<mux::MuxFrame> decode_frames(std::span<const std::uint8_t> plaintext,
+                                           std::uint64_t packet_sequence) const;
 
   // Fragment large data into multiple frames.
   std::vector<mux::MuxFrame> fragment_data(std::span<const std::uint8_t> data, std::uint64_t stream_id,
@@ -212,12 +461,20 @@ class TransportSession {
 
   // Crypto keys from handshake.
   crypto::SessionKeys keys_;
+  // Negotiated AEAD, keyed once per direction (precomputed AES key schedule).
+  crypto::AeadCipher send_cipher_;
+  crypto::AeadCipher recv_cipher_;
   std::uint64_t current_session_id_;
+  mux::FrameFormat frame_format_;
+
+  // DPI resistance: Sequence number permutations (Issue #21), keyed from the
+  // session keys. Round keys are expanded once here, not per packet.
+  crypto::SequenceObfuscator send_seq_obfuscator_;
+  crypto::SequenceObfuscator recv_seq_obfuscator_;
 
-  // DPI resistance: Keys for obfuscating sequence numbers (Issue #21).
-  // These are derived from session keys to prevent traffic analysis.
-  std::array<std::uint8_t, crypto::kAeadKeyLen> send_seq_obfuscation_key_;
-  std::array<std::uint8_t, crypto::kAeadKeyLen> recv_seq_obfuscation_key_;
+  // Connection ID, also bound to each packet as AEAD associated data.
+  std::uint64_t connection_id_;
+  std::array<std::uint8_t, kConnectionIdSize> connection_id_bytes_{};
 
   // Sequence counters.
   // SECURITY-CRITICAL: send_sequence_ is used for nonce derivation.
@@ -226,6 +483,7 @@ class TransportSession {
   // Resetting would cause nonce reuse, completely breaking ChaCha20-Poly1305 security.
   std::uint64_t send_sequence_{0};
   std::uint64_t recv_sequence_max_{0};
+  bool last_packet_advanced_{false};
 
   // Replay protection.
   session::ReplayWindow replay_window_;
@@ -236,6 +494,23 @@ class TransportSession {
 
   // Multiplexing state.
   mux::AckBitmap recv_ack_bitmap_;
+  // Decides when received packets are acknowledged. ACKs cover packet
+  // sequence numbers (what the peer's retransmit buffer is keyed by), so a
+  // single scheduler stream tracks all of them.
+  mux::AckScheduler ack_scheduler_;
+  bool ack_immediate_{false};
+  std::uint32_t unacked_packets_{0};
+  // ACK frequency last requested of the peer, and when.
+  std::optional<mux::AckFrequency> ack_frequency_requested_;
+  TimePoint ack_frequency_requested_at_{};
+  // Packet that carried the peer's last applied request. Packet sequences,
+  // unlike a counter in the request, survive hibernation and order requests
+  // that were retransmitted or reordered.
+  std::optional<std::uint64_t> ack_frequency_packet_;
+  // ACKs report how long they were held back (negotiated, compact frames
+  // only), measured from the arrival of the highest packet received.
+  bool ack_delay_{false};
+  TimePoint largest_received_at_{};
   mux::ReorderBuffer reorder_buffer_;
   mux::FragmentReassembly fragment_reassembly_;
   mux::RetransmitBuffer retransmit_buffer_;
@@ -250,17 +525,34 @@ class TransportSession {
   // Message ID counter for fragmentation.
   std::uint64_t message_id_counter_{0};
 
+  // Forward error correction (negotiated). Data fragments are shortened by
+  // the repair overhead so repair packets fit in the MTU.
+  bool fec_{false};
+  // Fragment size at config.mtu, and the size fragments are sent at now.
+  std::size_t base_fragment_size_;
+  std::size_t fragment_size_;
+  std::size_t datagram_budget_;
+  // Path MTU (see set_mtu()) and the largest message sent unfragmented at it.
+  std::size_t mtu_;
+  std::size_t unfragmented_size_;
+  mux::FecEncoder fec_encoder_;
+  mux::FecDecoder fec_decoder_;
+  mux::FecAdapter fec_adapter_;
+  TimePoint fec_group_started_{};
+  std::vector<std::vector<std::uint8_t>> fec_repair_packets_;
+
+  // Path MTU probes awaiting an ACK (packet sequence, datagram size), and
+  // the sizes acknowledged since take_acked_probes().
+  std::vector<std::pair<std::uint64_t, std::size_t>> pending_probes_;
+  std::vector<std::size_t> acked_probes_;
+
   // Statistics.
   TransportStats stats_;
 
   // PERFORMANCE (Issue #97): Buffer pool for zero-copy packet processing.
-  // Pre-allocates buffers to avoid heap allocations in the hot path.
-  // Uses 16 buffers with 2KB capacity each (enough for MTU + headers + crypto overhead).
-  utils::PacketPool packet_pool_{16, 2048};
-
-  // PERFORMANCE (Issue #97): Scratch buffer for frame encoding.
-  // This avoids allocation in build_encrypted_packet_zero_copy.
-  std::vector<std::uint8_t> encode_scratch_buffer_;
+  // Buffers (2KB: MTU + headers + crypto overhead) are allocated on first
+  // use and reused after that; idle sessions hold none.
+  utils::PacketPool packet_pool_{0, 2048};
 
   // Thread safety: verifies single-threaded access in debug builds.
   VEIL_THREAD_CHECKER(thread_checker_);
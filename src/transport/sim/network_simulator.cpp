@@ -0,0 +1,482 @@
+#include "transport/sim/network_simulator.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "transport/mux/mux_codec.h"
+
+namespace veil::transport::sim {
+
+namespace {
+
+constexpr std::size_t kMessageIdSize = 8;
+// Set in the message ID of messages from the interactive source.
+constexpr std::uint64_t kInteractiveMessage = 1ULL << 63;
+
+// Time needed to clock `bytes` onto a link of `bandwidth_bps`.
+std::chrono::nanoseconds serialization_time(std::size_t bytes, std::uint64_t bandwidth_bps) {
+  if (bandwidth_bps == 0) {
+    return std::chrono::nanoseconds{0};
+  }
+  const auto bits = static_cast<std::uint64_t>(bytes) * 8;
+  return std::chrono::nanoseconds{static_cast<std::int64_t>(bits * 1'000'000'000ULL / bandwidth_bps)};
+}
+
+std::chrono::microseconds percentile(const std::vector<std::chrono::microseconds>& sorted, double p) {
+  if (sorted.empty()) {
+    return std::chrono::microseconds{0};
+  }
+  // Nearest-rank percentile.
+  const auto rank = static_cast<std::size_t>(std::ceil(p * static_cast<double>(sorted.size())));
+  return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+void fill_random(std::mt19937_64& rng, std::span<std::uint8_t> out) {
+  for (auto& byte : out) {
+    byte = static_cast<std::uint8_t>(rng() & 0xFF);
+  }
+}
+
+}  // namespace
+
+// ========== SimulatedLink ==========
+
+SimulatedLink::SimulatedLink(LinkConfig config, std::uint64_t seed) : config_(config), rng_(seed) {}
+
+double SimulatedLink::next_uniform() {
+  // Use the top 53 bits so results do not depend on the standard library's
+  // distribution implementation.
+  return static_cast<double>(rng_() >> 11) * 0x1.0p-53;
+}
+
+std::size_t SimulatedLink::queued_bytes(TimePoint now) {
+  while (!queue_.empty() && queue_.front().departure <= now) {
+    queue_bytes_ -= queue_.front().size;
+    queue_.pop_front();
+  }
+  return queue_bytes_;
+}
+
+bool SimulatedLink::send(std::vector<std::uint8_t> datagram, TimePoint now) {
+  ++stats_.packets_sent;
+  const std::size_t size = datagram.size();
+
+  if (config_.queue_limit_bytes != 0 && queued_bytes(now) + size > config_.queue_limit_bytes) {
+    ++stats_.dropped_queue;
+    return false;
+  }
+
+  const auto departure = std::max(now, busy_until_) + serialization_time(size, config_.bandwidth_bps);
+  busy_until_ = departure;
+  queue_.push_back(Queued{.departure = departure, .size = size});
+  queue_bytes_ += size;
+
+  // Wire loss happens after the bottleneck, so a lost packet still consumed capacity.
+  if (config_.loss_rate > 0.0 && next_uniform() < config_.loss_rate) {
+    ++stats_.dropped_loss;
+    return false;
+  }
+
+  auto arrival = departure + config_.delay;
+  if (config_.jitter.count() > 0) {
+    const auto jitter_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(config_.jitter).count();
+    arrival += std::chrono::nanoseconds{
+        static_cast<std::int64_t>(next_uniform() * static_cast<double>(jitter_ns))};
+  }
+  if (config_.reorder_rate > 0.0 && next_uniform() < config_.reorder_rate) {
+    arrival += config_.reorder_delay;
+    ++stats_.reordered;
+  }
+
+  in_flight_.push(InFlight{.arrival = arrival, .order = next_order_++, .data = std::move(datagram)});
+  return true;
+}
+
+std::vector<std::vector<std::uint8_t>> SimulatedLink::receive(TimePoint now) {
+  std::vector<std::vector<std::uint8_t>> result;
+  while (!in_flight_.empty() && in_flight_.top().arrival <= now) {
+    // priority_queue only exposes a const top(); the element is popped right after.
+    auto& top = const_cast<InFlight&>(in_flight_.top());  // NOLINT(cppcoreguidelines-pro-type-const-cast)
+    ++stats_.packets_delivered;
+    stats_.bytes_delivered += top.data.size();
+    result.push_back(std::move(top.data));
+    in_flight_.pop();
+  }
+  return result;
+}
+
+std::optional<SimulatedLink::TimePoint> SimulatedLink::next_arrival() const {
+  if (in_flight_.empty()) {
+    return std::nullopt;
+  }
+  return in_flight_.top().arrival;
+}
+
+// ========== Session setup ==========
+
+std::pair<handshake::HandshakeSession, handshake::HandshakeSession> make_session_pair(
+    std::uint64_t seed, std::uint8_t features) {
+  std::mt19937_64 rng(seed ^ 0x5eed'5e55'10f0'0000ULL);
+
+  handshake::HandshakeSession client{};
+  client.session_id = rng();
+  fill_random(rng, client.keys.send_key);
+  fill_random(rng, client.keys.recv_key);
+  fill_random(rng, client.keys.send_nonce);
+  fill_random(rng, client.keys.recv_nonce);
+  client.compact_frames = (features & handshake::kFeatureCompactFrames) != 0;
+  client.fec = (features & handshake::kFeatureFec) != 0;
+  client.ack_delay = (features & handshake::kFeatureAckDelay) != 0;
+
+  handshake::HandshakeSession server = client;
+  server.keys.send_key = client.keys.recv_key;
+  server.keys.recv_key = client.keys.send_key;
+  server.keys.send_nonce = client.keys.recv_nonce;
+  server.keys.recv_nonce = client.keys.send_nonce;
+
+  return {client, server};
+}
+
+// ========== NetworkSimulation ==========
+
+// Application traffic source state (this endpoint as sender).
+struct NetworkSimulation::Source {
+  explicit Source(TrafficConfig traffic_config) : traffic(traffic_config) {
+    if (traffic.message_size != 0) {
+      traffic.message_size = std::max(traffic.message_size, kMessageIdSize);
+    }
+  }
+
+  bool active() const { return traffic.message_size != 0; }
+
+  TrafficConfig traffic;
+  TimePoint next_offer{};
+  std::uint64_t messages_sent{0};
+  std::uint64_t bytes_offered{0};
+  std::vector<TimePoint> offer_times;  // Indexed by message id.
+  std::vector<bool> delivered;         // Indexed by message id.
+  std::uint64_t messages_delivered{0};
+  std::uint64_t bytes_delivered{0};
+  std::vector<std::chrono::microseconds> latencies;
+};
+
+struct NetworkSimulation::Endpoint {
+  Endpoint(const handshake::HandshakeSession& handshake_session, const SimulationConfig& config,
+           TrafficConfig traffic_config, TrafficConfig interactive_config,
+           const std::function<TimePoint()>& now_fn)
+      : session(handshake_session, config.session_config, now_fn),
+        source(traffic_config),
+        interactive(interactive_config) {
+    if (interactive.active() || config.priority_scheduling) {
+      PrioritySchedulerConfig scheduler_config;
+      scheduler_config.max_datagram_size = config.session_config.mtu;
+      scheduler.emplace(scheduler_config);
+    }
+  }
+
+  TransportSession session;
+  Source source;
+  Source interactive;
+  // Send queue in front of the congestion window, if messages are scheduled.
+  std::optional<PriorityScheduler> scheduler;
+  Endpoint* peer{nullptr};
+};
+
+NetworkSimulation::NetworkSimulation(SimulationConfig config)
+    : config_(std::move(config)),
+      start_(clock_.now()),
+      client_to_server_(config_.client_to_server_link, config_.seed * 2 + 1),
+      server_to_client_(config_.server_to_client_link, config_.seed * 2 + 2) {
+  std::uint8_t features = config_.fec ? handshake::kFeatureFec : 0;
+  if (config_.compact_frames) {
+    features |= handshake::kFeatureCompactFrames | handshake::kFeatureAckDelay;
+  }
+  auto [client_handshake, server_handshake] = make_session_pair(config_.seed, features);
+  client_ = std::make_unique<Endpoint>(client_handshake, config_, config_.client_traffic,
+                                       config_.client_interactive_traffic, clock_.now_fn());
+  server_ = std::make_unique<Endpoint>(server_handshake, config_, config_.server_traffic,
+                                       TrafficConfig{.message_size = 0}, clock_.now_fn());
+  client_->peer = server_.get();
+  server_->peer = client_.get();
+  for (auto* source : {&client_->source, &client_->interactive, &server_->source, &server_->interactive}) {
+    source->next_offer = start_;
+  }
+}
+
+NetworkSimulation::~NetworkSimulation() = default;
+
+TransportSession& NetworkSimulation::client_session() { return client_->session; }
+
+TransportSession& NetworkSimulation::server_session() { return server_->session; }
+
+SimulationReport NetworkSimulation::run() {
+  const auto sources_end = start_ + config_.duration;
+  const auto hard_end = sources_end + config_.drain;
+
+  while (clock_.now() < hard_end) {
+    const bool sources_active = clock_.now() < sources_end;
+    step(sources_active);
+    ++steps_;
+    if (!sources_active && idle()) {
+      break;
+    }
+    auto next = next_event_time(sources_active);
+    if (sources_active) {
+      // Make sure the sources are re-evaluated exactly when they stop.
+      next = std::min(next, sources_end);
+    }
+    clock_.advance_to(std::min(next, hard_end));
+  }
+
+  SimulationReport report;
+  report.client_to_server = make_report(*client_, *server_, client_to_server_);
+  report.server_to_client = make_report(*server_, *client_, server_to_client_);
+  report.simulated_time = std::chrono::duration_cast<std::chrono::microseconds>(clock_.now() - start_);
+  report.steps = steps_;
+  return report;
+}
+
+void NetworkSimulation::step(bool sources_active) {
+  deliver(*client_, server_to_client_, client_to_server_);
+  deliver(*server_, client_to_server_, server_to_client_);
+  service_timers(*client_, client_to_server_);
+  service_timers(*server_, server_to_client_);
+  if (sources_active) {
+    run_source(*client_, client_to_server_);
+    run_source(*server_, server_to_client_);
+  }
+  // Scheduled messages still drain once the sources have stopped.
+  send_scheduled(*client_, client_to_server_);
+  send_scheduled(*server_, server_to_client_);
+}
+
+void NetworkSimulation::deliver(Endpoint& self, SimulatedLink& inbound, SimulatedLink& outbound) {
+  const auto now = clock_.now();
+  for (auto& datagram : inbound.receive(now)) {
+    auto frames = self.session.decrypt_packet(datagram);
+    if (!frames) {
+      continue;
+    }
+    for (auto& frame : *frames) {
+      if (frame.kind == mux::FrameKind::kAck) {
+        self.session.process_ack(frame.ack);
+        continue;
+      }
+      if (frame.kind != mux::FrameKind::kData) {
+        continue;
+      }
+
+      // Account the delivery against the sender's source.
+      const auto& payload = frame.data.payload;
+      if (payload.size() >= kMessageIdSize) {
+        std::uint64_t message_id = 0;
+        for (std::size_t i = 0; i < kMessageIdSize; ++i) {
+          message_id = (message_id << 8) | payload[i];
+        }
+        Source& sender = (message_id & kInteractiveMessage) != 0 ? self.peer->interactive : self.peer->source;
+        message_id &= ~kInteractiveMessage;
+        if (message_id < sender.delivered.size() && !sender.delivered[message_id]) {
+          sender.delivered[message_id] = true;
+          ++sender.messages_delivered;
+          sender.bytes_delivered += payload.size();
+          sender.latencies.push_back(std::chrono::duration_cast<std::chrono::microseconds>(
+              now - sender.offer_times[message_id]));
+        }
+      }
+    }
+
+    // Same ACK path as the client tunnel and the server loop.
+    if (auto ack = self.session.take_ack_packet()) {
+      outbound.send(std::move(*ack), now);
+    }
+  }
+  // End of the receive burst.
+  if (auto ack = self.session.take_ack_packet(true)) {
+    outbound.send(std::move(*ack), now);
+  }
+}
+
+void NetworkSimulation::service_timers(Endpoint& self, SimulatedLink& outbound) {
+  const auto now = clock_.now();
+  for (auto& packet : self.session.get_retransmit_packets()) {
+    outbound.send(std::move(packet), now);
+  }
+
+  if (auto ack = self.session.take_ack_packet()) {
+    outbound.send(std::move(*ack), now);
+  }
+}
+
+std::vector<std::uint8_t> NetworkSimulation::next_message(Source& source, bool interactive) {
+  const auto now = clock_.now();
+  const auto& traffic = source.traffic;
+  const bool saturating = traffic.offered_rate_bps == 0;
+
+  std::vector<std::uint8_t> payload(traffic.message_size, 0xA5);
+  const std::uint64_t message_id = source.messages_sent | (interactive ? kInteractiveMessage : 0);
+  for (std::size_t i = 0; i < kMessageIdSize; ++i) {
+    payload[i] = static_cast<std::uint8_t>(message_id >> (8 * (kMessageIdSize - 1 - i)));
+  }
+  // Rate-limited sources are timed from when the application offered the
+  // message, so congestion-window stalls show up as latency.
+  source.offer_times.push_back(saturating ? now : source.next_offer);
+  source.delivered.push_back(false);
+  ++source.messages_sent;
+  source.bytes_offered += payload.size();
+  source.next_offer += serialization_time(traffic.message_size, traffic.offered_rate_bps);
+  return payload;
+}
+
+void NetworkSimulation::run_source(Endpoint& self, SimulatedLink& outbound) {
+  if (self.scheduler) {
+    offer_scheduled(self, self.source, false);
+    offer_scheduled(self, self.interactive, true);
+    return;
+  }
+
+  const auto& traffic = self.source.traffic;
+  if (!self.source.active()) {
+    return;
+  }
+  const auto now = clock_.now();
+  const bool saturating = traffic.offered_rate_bps == 0;
+
+  for (std::size_t sent = 0; sent < config_.max_burst; ++sent) {
+    if (!saturating && self.source.next_offer > now) {
+      break;
+    }
+    if (traffic.respect_congestion_control &&
+        (!self.session.can_send(self.session.bytes_in_flight()) || !self.session.check_pacing())) {
+      break;
+    }
+    for (auto& packet : self.session.encrypt_data(next_message(self.source, false))) {
+      outbound.send(std::move(packet), now);
+    }
+  }
+}
+
+void NetworkSimulation::offer_scheduled(Endpoint& self, Source& source, bool interactive) {
+  if (!source.active()) {
+    return;
+  }
+  const auto now = clock_.now();
+  const bool saturating = source.traffic.offered_rate_bps == 0;
+  const PacketClass packet_class =
+      interactive && config_.priority_scheduling
+          ? PacketClass{.traffic_class = TrafficClass::kInteractive, .stream_id = kInteractiveStreamId}
+          : PacketClass{.traffic_class = TrafficClass::kBulk, .stream_id = kBulkStreamId};
+  // A saturating source keeps max_burst messages queued.
+  const auto backlog_limit = config_.max_burst * source.traffic.message_size;
+
+  for (std::size_t offered = 0; offered < config_.max_burst; ++offered) {
+    if (saturating ? self.scheduler->queued_bytes(packet_class.traffic_class) >= backlog_limit
+                   : source.next_offer > now) {
+      break;
+    }
+    self.scheduler->enqueue(next_message(source, interactive), packet_class);
+  }
+}
+
+void NetworkSimulation::send_scheduled(Endpoint& self, SimulatedLink& outbound) {
+  if (!self.scheduler || self.scheduler->empty()) {
+    return;
+  }
+  const auto now = clock_.now();
+  for (auto& packet : self.scheduler->drain(self.session)) {
+    outbound.send(std::move(packet), now);
+  }
+}
+
+NetworkSimulation::TimePoint NetworkSimulation::next_event_time(bool sources_active) const {
+  const auto now = clock_.now();
+  auto next = now + config_.timer_granularity;
+
+  for (const auto* link : {&client_to_server_, &server_to_client_}) {
+    if (auto arrival = link->next_arrival()) {
+      next = std::min(next, *arrival);
+    }
+  }
+
+  for (const auto* endpoint : {client_.get(), server_.get()}) {
+    if (auto ack_delay = endpoint->session.time_until_ack()) {
+      next = std::min(next, now + *ack_delay);
+    }
+    const bool queued = endpoint->scheduler && !endpoint->scheduler->empty();
+    bool offering = false;
+    for (const auto* source : {&endpoint->source, &endpoint->interactive}) {
+      if (!sources_active || !source->active()) {
+        continue;
+      }
+      offering = true;
+      if (source->traffic.offered_rate_bps != 0 && source->next_offer > now) {
+        next = std::min(next, source->next_offer);
+      }
+    }
+    if (!offering && !queued) {
+      continue;
+    }
+    if (auto pacing_delay = endpoint->session.time_until_next_send()) {
+      next = std::min(next, now + *pacing_delay);
+    }
+  }
+
+  // Always make progress, even if a source was stopped only by max_burst.
+  return std::max(next, now + std::chrono::microseconds{1});
+}
+
+bool NetworkSimulation::idle() const {
+  return client_to_server_.empty() && server_to_client_.empty() &&
+         client_->session.bytes_in_flight() == 0 && server_->session.bytes_in_flight() == 0 &&
+         !client_->session.time_until_ack() && !server_->session.time_until_ack() &&
+         (!client_->scheduler || client_->scheduler->empty()) &&
+         (!server_->scheduler || server_->scheduler->empty());
+}
+
+DirectionReport NetworkSimulation::make_report(const Endpoint& sender, const Endpoint& receiver,
+                                               const SimulatedLink& link) const {
+  DirectionReport report;
+  const auto& source = sender.source;
+  report.messages_sent = source.messages_sent;
+  report.messages_delivered = source.messages_delivered;
+  report.bytes_offered = source.bytes_offered;
+  report.bytes_delivered = source.bytes_delivered;
+  const auto active_seconds = std::chrono::duration<double>(config_.duration).count();
+  if (active_seconds > 0.0) {
+    report.goodput_bps = static_cast<double>(source.bytes_delivered) * 8.0 / active_seconds;
+  }
+  report.data_packets_sent = sender.session.stats().fragments_sent;
+  report.retransmits = sender.session.stats().retransmits;
+  if (report.data_packets_sent > 0) {
+    report.retransmit_ratio =
+        static_cast<double>(report.retransmits) / static_cast<double>(report.data_packets_sent);
+  }
+  report.acks_sent = receiver.session.stats().acks_sent;
+  report.acks_piggybacked = receiver.session.stats().acks_piggybacked;
+  report.fec_repairs_sent = sender.session.stats().fec_repairs_sent;
+  report.fec_recovered = receiver.session.stats().fec_packets_recovered;
+
+  auto sorted = source.latencies;
+  std::sort(sorted.begin(), sorted.end());
+  report.latency_p50 = percentile(sorted, 0.50);
+  report.latency_p90 = percentile(sorted, 0.90);
+  report.latency_p99 = percentile(sorted, 0.99);
+  report.latency_max = sorted.empty() ? std::chrono::microseconds{0} : sorted.back();
+
+  const auto& interactive = sender.interactive;
+  report.interactive_messages_sent = interactive.messages_sent;
+  report.interactive_messages_delivered = interactive.messages_delivered;
+  sorted = interactive.latencies;
+  std::sort(sorted.begin(), sorted.end());
+  report.interactive_latency_p50 = percentile(sorted, 0.50);
+  report.interactive_latency_p99 = percentile(sorted, 0.99);
+  report.interactive_latency_max = sorted.empty() ? std::chrono::microseconds{0} : sorted.back();
+  report.link = link.stats();
+  return report;
+}
+
+}  // namespace veil::transport::sim
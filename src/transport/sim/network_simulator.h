@@ -0,0 +1,274 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/handshake/handshake_processor.h"
+#include "transport/session/priority_scheduler.h"
+#include "transport/session/transport_session.h"
+
+namespace veil::transport::sim {
+
+// Deterministic in-process network simulator.
+//
+// Loopback-socket tests cannot reproduce loss, RTT or reordering reliably and
+// run in wall-clock time. The simulator drives two TransportSession endpoints
+// through modelled links on a virtual clock instead, so a scenario covering
+// minutes of traffic runs in milliseconds and yields identical results for
+// the same seed. Used by tests/unit/network_simulator_tests.cpp and
+// `veil-transport-bench --mode=sim`.
+
+// Manually advanced steady clock shared by the links and both sessions.
+class VirtualClock {
+ public:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  // Start well away from the epoch: several components treat a
+  // default-constructed time_point as "never".
+  explicit VirtualClock(TimePoint start = TimePoint{} + std::chrono::hours(1)) : now_(start) {}
+
+  TimePoint now() const { return now_; }
+  void advance(std::chrono::nanoseconds delta) { now_ += delta; }
+  void advance_to(TimePoint when) {
+    if (when > now_) {
+      now_ = when;
+    }
+  }
+
+  // Clock function suitable for the now_fn parameters used across the transport layer.
+  std::function<TimePoint()> now_fn() const {
+    return [this]() { return now_; };
+  }
+
+ private:
+  TimePoint now_;
+};
+
+// Properties of one direction of a simulated path.
+struct LinkConfig {
+  // Bottleneck bandwidth in bits per second (0 = unlimited).
+  std::uint64_t bandwidth_bps{100'000'000};
+  // One-way propagation delay.
+  std::chrono::microseconds delay{10'000};
+  // Extra uniformly distributed delay in [0, jitter] per packet.
+  std::chrono::microseconds jitter{0};
+  // Probability that a packet is lost on the wire.
+  double loss_rate{0.0};
+  // Probability that a packet is held back by reorder_delay.
+  double reorder_rate{0.0};
+  // Extra delay applied to reordered packets.
+  std::chrono::microseconds reorder_delay{5'000};
+  // Bottleneck queue size in bytes; packets beyond it are tail-dropped (0 = unlimited).
+  std::size_t queue_limit_bytes{256 * 1024};
+};
+
+// Per-link counters.
+struct LinkStats {
+  std::uint64_t packets_sent{0};
+  std::uint64_t packets_delivered{0};
+  std::uint64_t bytes_delivered{0};
+  std::uint64_t dropped_loss{0};
+  std::uint64_t dropped_queue{0};
+  std::uint64_t reordered{0};
+};
+
+// One direction of a simulated path: a FIFO bottleneck queue drained at the
+// configured bandwidth, followed by propagation delay, jitter, random loss and
+// reordering. All randomness comes from a seeded generator.
+class SimulatedLink {
+ public:
+  using TimePoint = VirtualClock::TimePoint;
+
+  SimulatedLink(LinkConfig config, std::uint64_t seed);
+
+  // Offer a datagram to the link at time now.
+  // Returns false if it was dropped (queue overflow or random loss).
+  bool send(std::vector<std::uint8_t> datagram, TimePoint now);
+
+  // Remove and return all datagrams that have arrived by now, in arrival order.
+  std::vector<std::vector<std::uint8_t>> receive(TimePoint now);
+
+  // Arrival time of the next datagram in flight, if any.
+  std::optional<TimePoint> next_arrival() const;
+
+  // Bytes waiting in the bottleneck queue at time now.
+  std::size_t queued_bytes(TimePoint now);
+
+  bool empty() const { return in_flight_.empty(); }
+  const LinkConfig& config() const { return config_; }
+  const LinkStats& stats() const { return stats_; }
+
+ private:
+  struct InFlight {
+    TimePoint arrival;
+    std::uint64_t order;  // Tie-breaker keeping equal arrival times FIFO.
+    std::vector<std::uint8_t> data;
+  };
+  struct LaterArrival {
+    bool operator()(const InFlight& a, const InFlight& b) const {
+      return a.arrival != b.arrival ? a.arrival > b.arrival : a.order > b.order;
+    }
+  };
+  struct Queued {
+    TimePoint departure;
+    std::size_t size;
+  };
+
+  // Uniform double in [0, 1).
+  double next_uniform();
+
+  LinkConfig config_;
+  std::mt19937_64 rng_;
+  TimePoint busy_until_{};
+  std::deque<Queued> queue_;  // Packets not yet serialized, in departure order.
+  std::size_t queue_bytes_{0};
+  std::priority_queue<InFlight, std::vector<InFlight>, LaterArrival> in_flight_;
+  std::uint64_t next_order_{0};
+  LinkStats stats_;
+};
+
+// Application traffic offered by one endpoint.
+struct TrafficConfig {
+  // Payload size of each message handed to encrypt_data (0 disables the source).
+  std::size_t message_size{1200};
+  // Offered load in bits per second (0 = saturate: send whenever allowed).
+  std::uint64_t offered_rate_bps{0};
+  // Respect the congestion window and pacing before sending.
+  bool respect_congestion_control{true};
+};
+
+struct SimulationConfig {
+  LinkConfig client_to_server_link{};
+  LinkConfig server_to_client_link{};
+  TrafficConfig client_traffic{};
+  TrafficConfig server_traffic{.message_size = 0};
+  // Latency-sensitive messages the client offers alongside client_traffic,
+  // e.g. small rate-limited messages next to a saturating transfer. When
+  // enabled, all client messages wait in a PriorityScheduler in front of the
+  // congestion window (respect_congestion_control is implied).
+  TrafficConfig client_interactive_traffic{.message_size = 0};
+  // Queue the interactive messages as TrafficClass::kInteractive. Otherwise
+  // both client sources share the bulk queue: one FIFO in front of the
+  // window, as in a tunnel without traffic classification.
+  bool priority_scheduling{false};
+  // Includes the delayed-ACK policy (ack_config) and FEC tuning (fec).
+  TransportSessionConfig session_config{};
+  // Both sessions behave as if forward error correction was negotiated.
+  bool fec{false};
+  // Both sessions behave as if compact frames were negotiated, which also
+  // enables piggybacked ACKs, ACK frequency requests and ACK delay reporting.
+  bool compact_frames{false};
+  // Period during which the traffic sources are active.
+  std::chrono::milliseconds duration{10'000};
+  // Extra time after sources stop to let retransmissions settle.
+  std::chrono::milliseconds drain{2'000};
+  // Upper bound on the clock step, i.e. how often retransmit and ACK timers are polled.
+  std::chrono::microseconds timer_granularity{1'000};
+  // Upper bound on messages a saturating source sends per step.
+  std::size_t max_burst{64};
+  std::uint64_t seed{1};
+};
+
+// Results for one direction of traffic.
+struct DirectionReport {
+  std::uint64_t messages_sent{0};
+  std::uint64_t messages_delivered{0};
+  std::uint64_t bytes_offered{0};
+  std::uint64_t bytes_delivered{0};
+  // Delivered application bytes per second of active traffic.
+  double goodput_bps{0.0};
+  std::uint64_t data_packets_sent{0};
+  std::uint64_t retransmits{0};
+  // retransmits / data_packets_sent.
+  double retransmit_ratio{0.0};
+  // Standalone ACK packets sent back by the receiver.
+  std::uint64_t acks_sent{0};
+  // ACKs the receiver carried in its own data packets.
+  std::uint64_t acks_piggybacked{0};
+  // FEC repair packets sent, and lost packets the receiver rebuilt from them.
+  std::uint64_t fec_repairs_sent{0};
+  std::uint64_t fec_recovered{0};
+  // One-way message latency from the moment the source offered the message
+  // (including time spent waiting for the congestion window) to delivery.
+  std::chrono::microseconds latency_p50{0};
+  std::chrono::microseconds latency_p90{0};
+  std::chrono::microseconds latency_p99{0};
+  std::chrono::microseconds latency_max{0};
+  // Same for the interactive source (client_interactive_traffic).
+  std::uint64_t interactive_messages_sent{0};
+  std::uint64_t interactive_messages_delivered{0};
+  std::chrono::microseconds interactive_latency_p50{0};
+  std::chrono::microseconds interactive_latency_p99{0};
+  std::chrono::microseconds interactive_latency_max{0};
+  LinkStats link{};
+};
+
+struct SimulationReport {
+  DirectionReport client_to_server{};
+  DirectionReport server_to_client{};
+  std::chrono::microseconds simulated_time{0};
+  std::uint64_t steps{0};
+};
+
+// Build a matching pair of handshake results with keys derived from seed,
+// so simulations do not depend on the handshake or on system randomness.
+// features holds the handshake::kFeature* bits both sides negotiated.
+std::pair<handshake::HandshakeSession, handshake::HandshakeSession> make_session_pair(
+    std::uint64_t seed, std::uint8_t features = 0);
+
+// Two TransportSession endpoints connected by a pair of SimulatedLinks.
+class NetworkSimulation {
+ public:
+  using TimePoint = VirtualClock::TimePoint;
+
+  explicit NetworkSimulation(SimulationConfig config);
+  ~NetworkSimulation();
+
+  NetworkSimulation(const NetworkSimulation&) = delete;
+  NetworkSimulation& operator=(const NetworkSimulation&) = delete;
+
+  // Run the configured scenario to completion.
+  SimulationReport run();
+
+  const VirtualClock& clock() const { return clock_; }
+  TransportSession& client_session();
+  TransportSession& server_session();
+
+ private:
+  struct Source;
+  struct Endpoint;
+
+  void step(bool sources_active);
+  void deliver(Endpoint& self, SimulatedLink& inbound, SimulatedLink& outbound);
+  void service_timers(Endpoint& self, SimulatedLink& outbound);
+  void run_source(Endpoint& self, SimulatedLink& outbound);
+  // Queue messages a source has due in the endpoint's scheduler.
+  void offer_scheduled(Endpoint& self, Source& source, bool interactive);
+  void send_scheduled(Endpoint& self, SimulatedLink& outbound);
+  // Build the next message of a source and record its offer time.
+  std::vector<std::uint8_t> next_message(Source& source, bool interactive);
+  TimePoint next_event_time(bool sources_active) const;
+  bool idle() const;
+  DirectionReport make_report(const Endpoint& sender, const Endpoint& receiver,
+                              const SimulatedLink& link) const;
+
+  SimulationConfig config_;
+  VirtualClock clock_;
+  TimePoint start_;
+  SimulatedLink client_to_server_;
+  SimulatedLink server_to_client_;
+  std::unique_ptr<Endpoint> client_;
+  std::unique_ptr<Endpoint> server_;
+  std::uint64_t steps_{0};
+};
+
+}  // namespace veil::transport::sim
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -7,8 +8,13 @@
 #include <span>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
+#ifndef _WIN32
+#include <netinet/in.h>
+#endif
+
 namespace veil::transport {
 
 struct UdpEndpoint {
@@ -19,6 +25,9 @@ struct UdpEndpoint {
 struct UdpPacket {
   std::vector<std::uint8_t> data;
   UdpEndpoint remote;
+  // Earliest departure, for sockets with enable_txtime(); a default
+  // TimePoint sends at once. Not set on received packets.
+  std::chrono::steady_clock::time_point departure{};
 };
 
 class UdpSocket {
@@ -37,8 +46,30 @@ class UdpSocket {
   bool open(std::uint16_t bind_port, bool reuse_port, std::error_code& ec);
   bool connect(const UdpEndpoint& remote, std::error_code& ec);
   bool send(std::span<const std::uint8_t> data, const UdpEndpoint& remote, std::error_code& ec);
-  bool send_batch(std::span<const UdpPacket> packets, std::error_code& ec);
+  // Send datagrams in order. Returns how many were sent; if not all, ec
+  // holds the error that stopped the first unsent one (e.g. would_block
+  // when the socket buffer is full).
+  std::size_t send_batch(std::span<const UdpPacket> packets, std::error_code& ec);
   bool poll(const ReceiveHandler& handler, int timeout_ms, std::error_code& ec);
+  // Receive datagrams that are already queued without waiting, until the socket
+  // would block or max_packets have been delivered. Used by readiness-driven
+  // event loops, which must drain a socket before waiting on it again.
+  // Returns the number of datagrams delivered.
+  std::size_t drain(const ReceiveHandler& handler, std::size_t max_packets, std::error_code& ec);
+  // Let send_batch() stamp datagrams with UdpPacket::departure (SO_TXTIME,
+  // Linux 4.19+), so a pacing qdisc such as fq holds each one until then.
+  // Fails with operation_not_supported where the platform lacks it.
+  bool enable_txtime(std::error_code& ec);
+  bool txtime_enabled() const { return txtime_; }
+  // Send a path MTU probe: one datagram with the Don't Fragment bit set that
+  // is neither fragmented locally nor held to the kernel's cached path MTU.
+  // Sent synchronously, bypassing any send hook. Fails with EMSGSIZE if the
+  // datagram does not fit the outgoing interface.
+  bool send_probe(std::span<const std::uint8_t> data, const UdpEndpoint& remote, std::error_code& ec);
+  // Path MTU the kernel currently assumes towards the connected peer (IP
+  // packet size, including the IP and UDP headers); nullopt if the socket is
+  // not connected or the platform does not report it.
+  std::optional<int> path_mtu(std::error_code& ec) const;
   void close();
 
 #ifdef _WIN32
@@ -50,6 +81,15 @@ class UdpSocket {
   int fd() const { return fd_; }
 #endif
 
+#ifndef _WIN32
+  // Asynchronous send path installed by an event loop backend that submits
+  // sends itself (io_uring) while the socket is registered with it. send()
+  // hands the resolved datagram to the hook, which copies it; if the hook
+  // returns false the datagram is sent synchronously instead.
+  using SendHook = std::function<bool(std::span<const std::uint8_t>, const sockaddr_in&)>;
+  void set_send_hook(SendHook hook) { send_hook_ = std::move(hook); }
+#endif
+
   // Get the actual local port the socket is bound to.
   // Returns 0 if the socket is not open or on error.
   std::uint16_t local_port() const;
@@ -70,8 +110,11 @@ class UdpSocket {
 #else
   int fd_{-1};
   int epoll_fd_{-1};  // Persistent epoll FD to avoid creating/destroying on every poll() call.
+  SendHook send_hook_;
 #endif
   UdpEndpoint connected_;
+  bool txtime_{false};
+  std::vector<std::uint8_t> recv_buffer_;  // Reused by drain(); allocated on first use.
 
   bool configure_socket(bool reuse_port, std::error_code& ec);
 #ifndef _WIN32
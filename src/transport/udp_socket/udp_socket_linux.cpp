@@ -8,6 +8,7 @@
 #include <arpa/inet.h>
 #include <cerrno>
 #include <fcntl.h>
+#include <linux/net_tstamp.h>
 #include <netdb.h>
 #include <netinet/in.h>
 #include <sys/epoll.h>
@@ -130,6 +131,9 @@ bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remo
     ec = std::make_error_code(std::errc::invalid_argument);
     return false;
   }
+  if (send_hook_ && send_hook_(data, addr)) {
+    return true;
+  }
 
   const auto sent =
       ::sendto(fd_, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
@@ -140,9 +144,9 @@ bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remo
   return true;
 }
 
-bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code& ec) {
+std::size_t UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code& ec) {
   if (packets.empty()) {
-    return true;
+    return 0;
   }
 
 #if VEIL_HAS_SENDMMSG
@@ -150,10 +154,15 @@ bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code&
   std::vector<mmsghdr> messages(packets.size());
   std::vector<sockaddr_in> addrs(packets.size());
   std::vector<iovec> iovecs(packets.size());
+  // One SCM_TXTIME control message per datagram with a departure time.
+  struct alignas(cmsghdr) TxtimeControl {
+    std::array<std::uint8_t, CMSG_SPACE(sizeof(std::uint64_t))> buffer;
+  };
+  std::vector<TxtimeControl> control(txtime_ ? packets.size() : 0);
   for (std::size_t i = 0; i < packets.size(); ++i) {
     if (!resolve(packets[i].remote, addrs[i])) {
       ec = std::make_error_code(std::errc::invalid_argument);
-      return false;
+      return 0;
     }
     iovecs[i].iov_base = const_cast<std::uint8_t*>(packets[i].data.data());
     iovecs[i].iov_len = packets[i].data.size();
@@ -165,33 +174,109 @@ bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code&
     messages[i].msg_hdr.msg_controllen = 0;
     messages[i].msg_hdr.msg_flags = 0;
     messages[i].msg_len = 0;
+#ifdef SO_TXTIME
+    if (txtime_ && packets[i].departure != std::chrono::steady_clock::time_point{}) {
+      // steady_clock is CLOCK_MONOTONIC, the clock enable_txtime() selects.
+      const auto txtime = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(packets[i].departure.time_since_epoch()).count());
+      messages[i].msg_hdr.msg_control = control[i].buffer.data();
+      messages[i].msg_hdr.msg_controllen = control[i].buffer.size();
+      auto* cmsg = CMSG_FIRSTHDR(&messages[i].msg_hdr);
+      cmsg->cmsg_level = SOL_SOCKET;
+      cmsg->cmsg_type = SCM_TXTIME;
+      cmsg->cmsg_len = CMSG_LEN(sizeof(txtime));
+      std::memcpy(CMSG_DATA(cmsg), &txtime, sizeof(txtime));
+    }
+#endif
   }
-  const auto sent =
-      ::sendmmsg(fd_, messages.data(), static_cast<unsigned int>(messages.size()), 0);
-  if (sent < 0) {
-    // If sendmmsg fails with EPERM (sandbox/container), fall back to sendto.
-    if (errno == EPERM || errno == ENOSYS) {
-      LOG_DEBUG("sendmmsg failed with {}, falling back to sendto", errno);
-      goto fallback;
+  // sendmmsg() stops at the first datagram that fails and reports what it
+  // sent; sending the rest again surfaces that datagram's error.
+  std::size_t sent = 0;
+  while (sent < packets.size()) {
+    const int result =
+        ::sendmmsg(fd_, messages.data() + sent, static_cast<unsigned int>(packets.size() - sent), 0);
+    if (result < 0) {
+      // If sendmmsg fails with EPERM (sandbox/container), fall back to sendto.
+      if (sent == 0 && (errno == EPERM || errno == ENOSYS)) {
+        LOG_DEBUG("sendmmsg failed with {}, falling back to sendto", errno);
+        goto fallback;
+      }
+      ec = last_error();
+      return sent;
+    }
+    sent += static_cast<std::size_t>(result);
+  }
+  return sent;
+
+fallback:
+#endif
+  // Fallback: send each packet individually with sendto (Windows and non-sendmmsg systems).
+  for (std::size_t i = 0; i < packets.size(); ++i) {
+    if (!send(packets[i].data, packets[i].remote, ec)) {
+      return i;
     }
+  }
+  return packets.size();
+}
+
+bool UdpSocket::enable_txtime(std::error_code& ec) {
+#ifdef SO_TXTIME
+  sock_txtime config{};
+  config.clockid = CLOCK_MONOTONIC;
+  config.flags = 0;
+  if (setsockopt(fd_, SOL_SOCKET, SO_TXTIME, &config, sizeof(config)) != 0) {
     ec = last_error();
     return false;
   }
-  if (static_cast<std::size_t>(sent) != packets.size()) {
+  txtime_ = true;
+  return true;
+#else
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return false;
+#endif
+}
+
+bool UdpSocket::send_probe(std::span<const std::uint8_t> data, const UdpEndpoint& remote,
+                           std::error_code& ec) {
+  sockaddr_in addr{};
+  if (!resolve(remote, addr)) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+
+  // IP_PMTUDISC_PROBE sets DF but ignores the cached path MTU, so a probe
+  // larger than an earlier ICMP report still goes out. Other datagrams keep
+  // the socket's mode, which fragments rather than drops what does not fit.
+  int previous = IP_PMTUDISC_WANT;
+  socklen_t length = sizeof(previous);
+  if (getsockopt(fd_, IPPROTO_IP, IP_MTU_DISCOVER, &previous, &length) != 0) {
     ec = last_error();
     return false;
   }
+  const int probe = IP_PMTUDISC_PROBE;
+  if (setsockopt(fd_, IPPROTO_IP, IP_MTU_DISCOVER, &probe, sizeof(probe)) != 0) {
+    ec = last_error();
+    return false;
+  }
+  const auto sent =
+      ::sendto(fd_, data.data(), data.size(), 0, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+  const auto send_error = last_error();
+  setsockopt(fd_, IPPROTO_IP, IP_MTU_DISCOVER, &previous, sizeof(previous));
+  if (sent < 0 || static_cast<std::size_t>(sent) != data.size()) {
+    ec = send_error;
+    return false;
+  }
   return true;
+}
 
-fallback:
-#endif
-  // Fallback: send each packet individually with sendto (Windows and non-sendmmsg systems).
-  for (const auto& pkt : packets) {
-    if (!send(pkt.data, pkt.remote, ec)) {
-      return false;
-    }
+std::optional<int> UdpSocket::path_mtu(std::error_code& ec) const {
+  int mtu = 0;
+  socklen_t length = sizeof(mtu);
+  if (getsockopt(fd_, IPPROTO_IP, IP_MTU, &mtu, &length) != 0) {
+    ec = last_error();
+    return std::nullopt;
   }
-  return true;
+  return mtu;
 }
 
 bool UdpSocket::ensure_epoll(std::error_code& ec) {
@@ -225,6 +310,44 @@ void UdpSocket::close_epoll() {
   }
 }
 
+std::size_t UdpSocket::drain(const ReceiveHandler& handler, std::size_t max_packets,
+                             std::error_code& ec) {
+  if (fd_ < 0) {
+    ec = std::make_error_code(std::errc::bad_file_descriptor);
+    return 0;
+  }
+  if (recv_buffer_.empty()) {
+    recv_buffer_.resize(65535);
+  }
+
+  std::size_t delivered = 0;
+  while (delivered < max_packets) {
+    sockaddr_in src{};
+    socklen_t src_len = sizeof(src);
+    const auto read = ::recvfrom(fd_, recv_buffer_.data(), recv_buffer_.size(), MSG_DONTWAIT,
+                                 reinterpret_cast<sockaddr*>(&src), &src_len);
+    if (read < 0) {
+      // ECONNREFUSED reports an earlier ICMP error on a connected socket; the
+      // queue behind it is still readable.
+      if (errno == EINTR || errno == ECONNREFUSED) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        ec = last_error();
+      }
+      break;
+    }
+    if (read == 0) {
+      continue;
+    }
+    UdpEndpoint remote{};
+    fill_endpoint(src, remote);
+    handler(UdpPacket{std::vector<std::uint8_t>(recv_buffer_.begin(), recv_buffer_.begin() + read), remote});
+    ++delivered;
+  }
+  return delivered;
+}
+
 bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_code& ec) {
   // Use epoll for Linux (more efficient than poll for multiple sockets).
   // Ensure epoll FD is initialized (lazy initialization).
@@ -275,6 +398,7 @@ void UdpSocket::close() {
     ::close(fd_);
     fd_ = -1;
   }
+  txtime_ = false;
 }
 
 std::uint16_t UdpSocket::local_port() const {
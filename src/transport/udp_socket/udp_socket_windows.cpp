@@ -389,18 +389,49 @@ bool UdpSocket::send(std::span<const std::uint8_t> data, const UdpEndpoint& remo
   return true;
 }
 
-bool UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code& ec) {
-  if (packets.empty()) {
-    return true;
+bool UdpSocket::send_probe(std::span<const std::uint8_t> data, const UdpEndpoint& remote,
+                           std::error_code& ec) {
+  SOCKET s = static_cast<SOCKET>(fd_);
+  if (s == INVALID_SOCKET) {
+    ec = std::make_error_code(std::errc::bad_file_descriptor);
+    return false;
+  }
+
+  // Windows sends without DF by default; set it for the probe only.
+  DWORD enable = TRUE;
+  if (setsockopt(s, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&enable), sizeof(enable)) != 0) {
+    ec = last_error();
+    return false;
   }
+  const bool sent = send(data, remote, ec);
+  DWORD disable = FALSE;
+  setsockopt(s, IPPROTO_IP, IP_DONTFRAGMENT, reinterpret_cast<const char*>(&disable), sizeof(disable));
+  return sent;
+}
 
+std::optional<int> UdpSocket::path_mtu(std::error_code& ec) const {
+#ifdef IP_MTU
+  DWORD mtu = 0;
+  int length = sizeof(mtu);
+  if (getsockopt(static_cast<SOCKET>(fd_), IPPROTO_IP, IP_MTU, reinterpret_cast<char*>(&mtu), &length) != 0) {
+    ec = last_error();
+    return std::nullopt;
+  }
+  return static_cast<int>(mtu);
+#else
+  ec = std::make_error_code(std::errc::not_supported);
+  return std::nullopt;
+#endif
+}
+
+std::size_t UdpSocket::send_batch(std::span<const UdpPacket> packets, std::error_code& ec) {
   // Windows doesn't have sendmmsg, so send each packet individually.
-  for (const auto& pkt : packets) {
-    if (!send(pkt.data, pkt.remote, ec)) {
-      return false;
+  for (std::size_t i = 0; i < packets.size(); ++i) {
+    if (!send(packets[i].data, packets[i].remote, ec)) {
+      return i;
     }
   }
-  return true;
+  return packets.size();
 }
 
 bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_code& ec) {
@@ -476,6 +507,53 @@ bool UdpSocket::poll(const ReceiveHandler& handler, int timeout_ms, std::error_c
   return true;
 }
 
+std::size_t UdpSocket::drain(const ReceiveHandler& handler, std::size_t max_packets,
+                             std::error_code& ec) {
+  SOCKET s = static_cast<SOCKET>(fd_);
+  if (s == INVALID_SOCKET) {
+    ec = std::make_error_code(std::errc::bad_file_descriptor);
+    return 0;
+  }
+  if (recv_buffer_.empty()) {
+    recv_buffer_.resize(65535);
+  }
+
+  std::size_t delivered = 0;
+  while (delivered < max_packets) {
+    sockaddr_in src{};
+    int src_len = sizeof(src);
+    const int read = ::recvfrom(s, reinterpret_cast<char*>(recv_buffer_.data()),
+                                static_cast<int>(recv_buffer_.size()), 0,
+                                reinterpret_cast<sockaddr*>(&src), &src_len);
+    if (read == SOCKET_ERROR) {
+      const int err = WSAGetLastError();
+      // WSAECONNRESET reports an earlier ICMP port unreachable; keep reading.
+      if (err == WSAEINTR || err == WSAECONNRESET) {
+        continue;
+      }
+      if (err != WSAEWOULDBLOCK) {
+        ec = std::error_code(err, std::system_category());
+      }
+      break;
+    }
+    if (read == 0) {
+      continue;
+    }
+    UdpEndpoint remote{};
+    fill_endpoint(src, remote);
+    handler(UdpPacket{std::vector<std::uint8_t>(recv_buffer_.begin(), recv_buffer_.begin() + read), remote});
+    ++delivered;
+  }
+  return delivered;
+}
+
+bool UdpSocket::enable_txtime(std::error_code& ec) {
+  // Windows has no per-datagram departure times; the departure field of
+  // UdpPacket is ignored.
+  ec = std::make_error_code(std::errc::operation_not_supported);
+  return false;
+}
+
 void UdpSocket::close() {
   if (fd_ != static_cast<std::uintptr_t>(~0ULL)) {  // Check if not INVALID_SOCKET
     ::closesocket(static_cast<SOCKET>(fd_));
@@ -15,6 +15,7 @@ PmtuDiscovery::PeerState& PmtuDiscovery::get_or_create_state(const std::string&
     PeerState state;
     state.current_mtu = config_.initial_mtu;
     state.last_probe = now_fn_();
+    state.probe_limit = config_.max_mtu;
     it = peers_.emplace(peer, state).first;
   }
   return it->second;
@@ -43,6 +44,7 @@ void PmtuDiscovery::set_mtu(const std::string& peer, int mtu) {
   if (mtu != old_mtu) {
     state.current_mtu = mtu;
     state.probing = false;
+    state.confirming = false;
     state.probe_count = 0;
     notify_mtu_change(peer, old_mtu, mtu);
   }
@@ -69,6 +71,7 @@ void PmtuDiscovery::handle_fragmentation_needed(const std::string& peer, int nex
     state.current_mtu = new_mtu;
     state.last_decrease = now_fn_();
     state.probing = false;
+    state.confirming = false;
     state.probe_count = 0;
     LOG_INFO("PMTU decreased for {}: {} -> {} (ICMP reported: {})", peer, old_mtu, new_mtu,
              next_hop_mtu);
@@ -82,12 +85,20 @@ void PmtuDiscovery::handle_probe_success(const std::string& peer, int size) {
   if (state.probing && size >= state.probe_mtu) {
     // Probe succeeded, update MTU.
     const int old_mtu = state.current_mtu;
-    state.current_mtu = size;
     state.probing = false;
+    state.confirming = false;
+    state.probing_floor = false;
+    state.verified = true;
     state.probe_count = 0;
     state.last_probe = now_fn_();
-    LOG_INFO("PMTU increased for {}: {} -> {}", peer, old_mtu, size);
-    notify_mtu_change(peer, old_mtu, size);
+    if (size != old_mtu) {
+      state.current_mtu = size;
+      if (size < old_mtu) {
+        state.last_decrease = state.last_probe;
+      }
+      LOG_INFO("PMTU {} for {}: {} -> {}", size > old_mtu ? "increased" : "decreased", peer, old_mtu, size);
+      notify_mtu_change(peer, old_mtu, size);
+    }
   }
 }
 
@@ -99,6 +110,7 @@ void PmtuDiscovery::handle_probe_failure(const std::string& peer, int size) {
     if (state.probe_count >= config_.max_probes) {
       // Give up probing at this size.
       state.probing = false;
+      state.confirming = false;
       state.probe_count = 0;
       state.probe_mtu = 0;
       LOG_DEBUG("PMTU probe failed for {} at size {} after {} attempts", peer, size,
@@ -146,6 +158,113 @@ int PmtuDiscovery::get_next_probe_size(const std::string& peer) const {
   return probe_size;
 }
 
+std::optional<int> PmtuDiscovery::next_probe(const std::string& peer) {
+  auto& state = get_or_create_state(peer);
+  const auto now = now_fn_();
+
+  if (state.probing) {
+    if (now - state.last_probe < config_.probe_timeout) {
+      return std::nullopt;
+    }
+    const int size = state.probe_mtu;
+    const bool confirming = state.confirming;
+    handle_probe_failure(peer, size);
+    if (state.probing) {
+      // Lost, or not acknowledged yet: try the same size again.
+      state.last_probe = now;
+      return size;
+    }
+    if (state.probing_floor) {
+      // Nothing gets through, not even min_mtu: most likely the peer does
+      // not answer probes. Keep the MTU and try again next interval.
+      state.probing_floor = false;
+      state.searching = false;
+      state.last_probe = now;
+      LOG_DEBUG("PMTU probes for {} unanswered down to {}, keeping {}", peer, size, state.current_mtu);
+      return std::nullopt;
+    }
+    state.failed_mtu = size;
+    if (confirming) {
+      // The MTU in use no longer gets through: fall back to the base size and
+      // search again from there.
+      const int old_mtu = state.current_mtu;
+      state.current_mtu = config_.initial_mtu;
+      state.verified = false;
+      state.last_decrease = now;
+      LOG_INFO("PMTU for {} no longer confirmed at {}, falling back to {}", peer, old_mtu, state.current_mtu);
+      notify_mtu_change(peer, old_mtu, state.current_mtu);
+    } else if (size == state.current_mtu) {
+      // Not even the size in use gets through: the path is below it. Probe
+      // the floor; the search resumes upward from there.
+      state.probing_floor = true;
+      return start_probe(state, config_.min_mtu);
+    }
+  } else if (!state.searching) {
+    if (now - state.last_probe < config_.probe_interval) {
+      return std::nullopt;
+    }
+    // Periodic search: the path may have changed in either direction.
+    state.searching = true;
+    state.failed_mtu = 0;
+    state.verified = false;
+    if (state.current_mtu > config_.initial_mtu) {
+      state.confirming = true;
+      return start_probe(state, state.current_mtu);
+    }
+  }
+
+  // Largest size first: on most paths the first probe settles it. After a
+  // failure, halve the range between what works and what did not.
+  const int ceiling = probe_ceiling(state);
+  int high = ceiling + 1;
+  if (state.failed_mtu > 0) {
+    high = std::min(high, state.failed_mtu);
+  }
+  const bool ceiling_untried = state.failed_mtu == 0 || state.failed_mtu > ceiling;
+  if (high - 1 <= state.current_mtu || (!ceiling_untried && high - state.current_mtu <= config_.search_granularity)) {
+    if (!state.verified && state.current_mtu > config_.min_mtu) {
+      // Settle only on a size a probe got through at.
+      return start_probe(state, state.current_mtu);
+    }
+    state.searching = false;
+    state.last_probe = now;
+    LOG_DEBUG("PMTU search for {} done at {}", peer, state.current_mtu);
+    return std::nullopt;
+  }
+  return start_probe(state, ceiling_untried ? high - 1 : state.current_mtu + (high - state.current_mtu) / 2);
+}
+
+std::optional<std::chrono::milliseconds> PmtuDiscovery::time_until_probe(const std::string& peer) const {
+  const auto* state = get_state(peer);
+  if (state == nullptr) {
+    return std::nullopt;
+  }
+  const auto now = now_fn_();
+  auto due = now;
+  if (state->probing) {
+    due = state->last_probe + config_.probe_timeout;
+  } else if (!state->searching) {
+    due = state->last_probe + config_.probe_interval;
+  }
+  return std::max(std::chrono::ceil<std::chrono::milliseconds>(due - now), std::chrono::milliseconds(0));
+}
+
+void PmtuDiscovery::set_probe_limit(const std::string& peer, int limit) {
+  get_or_create_state(peer).probe_limit = std::max(limit, config_.min_mtu);
+}
+
+int PmtuDiscovery::probe_ceiling(const PeerState& state) const {
+  return std::min(config_.max_mtu, state.probe_limit);
+}
+
+int PmtuDiscovery::start_probe(PeerState& state, int size) {
+  state.probing = true;
+  state.probe_mtu = size;
+  state.probe_count = 0;
+  state.last_probe = now_fn_();
+  return size;
+}
+
 void PmtuDiscovery::set_mtu_change_callback(MtuChangeCallback callback) {
   mtu_change_callback_ = std::move(callback);
 }
@@ -161,6 +280,11 @@ void PmtuDiscovery::reset(const std::string& peer) {
   state.probe_mtu = 0;
   state.probe_count = 0;
   state.probing = false;
+  state.searching = true;
+  state.confirming = false;
+  state.failed_mtu = 0;
+  state.verified = false;
+  state.probing_floor = false;
   state.last_probe = now_fn_();
   state.last_decrease = TimePoint{};
 
@@ -40,6 +40,9 @@ struct PmtuConfig {
   std::chrono::milliseconds probe_timeout{1000};
   // Enable DF (Don't Fragment) bit on probes.
   bool set_df_bit{true};
+  // A search ends once the largest size that got through and the smallest
+  // that did not are closer than this.
+  int search_granularity{8};
 };
 
 // Path MTU discovery manager.
@@ -74,6 +77,27 @@ class PmtuDiscovery {
   // Get the next probe size to try.
   int get_next_probe_size(const std::string& peer) const;
 
+  // Packetization-layer search (RFC 8899 style). Returns the size of the
+  // probe to send now, or nullopt if none is due. A search starts when the
+  // peer is first seen and again every probe_interval: the largest allowed
+  // size first, then a binary search between the current MTU and the
+  // smallest size given up on. An unanswered probe is repeated after
+  // probe_timeout, up to max_probes times. A periodic search first confirms
+  // the current MTU; if that probe is lost too, the path shrank and the MTU
+  // falls back to initial_mtu. A search that ends on a size no probe has
+  // confirmed probes it; if that is lost, min_mtu is probed, and once that
+  // gets through the search continues upward from there. If min_mtu is lost
+  // as well, the peer is taken not to answer probes and the MTU stays put.
+  // Report acknowledged probes to handle_probe_success().
+  std::optional<int> next_probe(const std::string& peer);
+
+  // Time until next_probe() has something to do for a known peer.
+  std::optional<std::chrono::milliseconds> time_until_probe(const std::string& peer) const;
+
+  // Cap probe sizes for a peer below max_mtu, e.g. at what the local
+  // interface can send.
+  void set_probe_limit(const std::string& peer, int limit);
+
   // Register callback for MTU changes.
   void set_mtu_change_callback(MtuChangeCallback callback);
 
@@ -97,8 +121,23 @@ class PmtuDiscovery {
     TimePoint last_probe;
     TimePoint last_decrease;
     bool probing{false};
+    // Search state (see next_probe()).
+    bool searching{true};
+    bool confirming{false};
+    int probe_limit{0};
+    // Smallest size given up on in this search; 0 if none.
+    int failed_mtu{0};
+    // current_mtu was acknowledged by a probe.
+    bool verified{false};
+    // Probing min_mtu after current_mtu was lost.
+    bool probing_floor{false};
   };
 
+  // Largest size worth probing for a peer.
+  int probe_ceiling(const PeerState& state) const;
+  // Start probing `size` now.
+  int start_probe(PeerState& state, int size);
+
   PeerState& get_or_create_state(const std::string& peer);
   const PeerState* get_state(const std::string& peer) const;
   void notify_mtu_change(const std::string& peer, int old_mtu, int new_mtu);
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "tun/routing.h"
+
+namespace veil::tun {
+
+// Default route of the main routing table.
+struct DefaultRoute {
+  std::string interface;
+  // Empty for a route without a gateway.
+  std::string gateway;
+};
+
+/**
+ * Network configuration over netlink (Linux), used by RouteManager and
+ * TunDevice instead of running ip(8) and iptables(8) or opening an ioctl
+ * socket per call.
+ *
+ * - rtnetlink: link state, MTU, IPv4 addresses and routes.
+ * - nf_tables: the NAT ruleset, installed and removed as one transaction in
+ *   an "ip veil" table of its own.
+ *
+ * One socket serves any number of requests, and batches (many routes, the
+ * whole NAT ruleset) reach the kernel in a few sends instead of one process
+ * per rule. Callers keep the command-based path for when open() fails or the
+ * kernel has no nf_tables.
+ *
+ * Thread Safety:
+ *   Not thread-safe.
+ */
+class Netlink {
+ public:
+  Netlink() = default;
+  ~Netlink();
+
+  // Non-copyable, non-movable.
+  Netlink(const Netlink&) = delete;
+  Netlink& operator=(const Netlink&) = delete;
+  Netlink(Netlink&&) = delete;
+  Netlink& operator=(Netlink&&) = delete;
+
+  // Open the rtnetlink socket. The nf_tables socket is opened on first use.
+  bool open(std::error_code& ec);
+  bool is_open() const { return route_fd_ >= 0; }
+  void close();
+
+  // Set an interface up or down.
+  bool set_link_up(const std::string& interface, bool up, std::error_code& ec);
+
+  // Set an interface's MTU.
+  bool set_mtu(const std::string& interface, int mtu, std::error_code& ec);
+
+  // Add an IPv4 address; the kernel adds the route for its subnet.
+  bool add_address(const std::string& interface, const std::string& address, std::uint8_t prefix_length,
+                   std::error_code& ec);
+
+  // Add or remove routes in the main table. results[i] is the outcome for
+  // routes[i]; returns true if all succeeded.
+  bool add_routes(std::span<const Route> routes, std::vector<std::error_code>& results);
+  bool remove_routes(std::span<const Route> routes, std::vector<std::error_code>& results);
+
+  // Whether the main table has a route for exactly this destination (and
+  // interface, if set).
+  bool route_exists(const Route& route, std::error_code& ec);
+
+  // Default route with the lowest metric; nullopt if there is none.
+  std::optional<DefaultRoute> default_route(std::error_code& ec);
+
+  // Replace the "ip veil" nf_tables table with the NAT ruleset for config:
+  // MASQUERADE or SNAT of the VPN subnet out of the external interface, and
+  // forwarding to and from the internal interface.
+  bool add_nat(const NatConfig& config, std::error_code& ec);
+
+  // Delete the "ip veil" table. Succeeds if it does not exist.
+  bool remove_nat(std::error_code& ec);
+
+ private:
+  // Send messages (each with NLM_F_ACK, sequence numbers first_seq onwards)
+  // and collect one result per message.
+  bool transact(int fd, const std::vector<std::uint8_t>& request, std::uint32_t first_seq, std::size_t count,
+                std::vector<std::error_code>& results);
+
+  // Send a dump request and pass every reply message of `type` to on_message
+  // (message payload after the netlink header).
+  bool dump(const std::vector<std::uint8_t>& request, std::uint16_t type,
+            const std::function<void(std::span<const std::uint8_t>)>& on_message, std::error_code& ec);
+
+  bool open_netfilter(std::error_code& ec);
+
+  // Apply routes in batches; `add` selects RTM_NEWROUTE or RTM_DELROUTE.
+  bool change_routes(std::span<const Route> routes, bool add, std::vector<std::error_code>& results);
+
+  int route_fd_{-1};
+  int netfilter_fd_{-1};
+  std::uint32_t sequence_{0};
+};
+
+}  // namespace veil::tun
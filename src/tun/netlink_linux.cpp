@@ -0,0 +1,791 @@
+#include "tun/netlink.h"
+
+#include <arpa/inet.h>
+#include <linux/netfilter.h>
+#include <linux/netfilter/nf_tables.h>
+#include <linux/netfilter/nfnetlink.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <net/if.h>
+#include <netinet/ip.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+#include "common/logging/logger.h"
+
+namespace {
+
+std::error_code last_error() { return std::error_code(errno, std::generic_category()); }
+
+// Requests per send. Every request is acknowledged, and the ACKs wait in the
+// socket's receive buffer until the batch is sent.
+constexpr std::size_t kBatchSize = 64;
+constexpr std::size_t kReceiveBufferSize = 32 * 1024;
+// How long to wait for the kernel's answer.
+constexpr int kReceiveTimeoutSec = 2;
+constexpr std::size_t kAlign = 4;
+constexpr const char* kNatTable = "veil";
+
+std::size_t align(std::size_t size) { return (size + kAlign - 1) / kAlign * kAlign; }
+
+// Builds netlink messages, with their attributes, into a byte buffer.
+class MessageWriter {
+ public:
+  explicit MessageWriter(std::vector<std::uint8_t>& buffer) : buffer_(buffer) {}
+
+  // Start a message; end() fills in its length.
+  void begin(int type, int flags, std::uint32_t seq) {
+    start_ = buffer_.size();
+    nlmsghdr header{};
+    header.nlmsg_type = static_cast<std::uint16_t>(type);
+    header.nlmsg_flags = static_cast<std::uint16_t>(flags);
+    header.nlmsg_seq = seq;
+    append(&header, sizeof(header));
+  }
+
+  void end() {
+    const auto length = static_cast<std::uint32_t>(buffer_.size() - start_);
+    std::memcpy(buffer_.data() + start_ + offsetof(nlmsghdr, nlmsg_len), &length, sizeof(length));
+  }
+
+  // Family header after the netlink header (rtmsg, ifinfomsg, nfgenmsg...).
+  template <typename T>
+  void header(const T& value) {
+    append(&value, sizeof(value));
+  }
+
+  void attr(int type, const void* data, std::size_t size) {
+    nlattr attribute{};
+    attribute.nla_len = static_cast<std::uint16_t>(sizeof(nlattr) + size);
+    attribute.nla_type = static_cast<std::uint16_t>(type);
+    append(&attribute, sizeof(attribute));
+    append(data, size);
+  }
+
+  void attr_u32(int type, std::uint32_t value) { attr(type, &value, sizeof(value)); }
+
+  // nf_tables takes its integers in network byte order.
+  void attr_be32(int type, std::uint32_t value) { attr_u32(type, htonl(value)); }
+
+  void attr_string(int type, const std::string& value) { attr(type, value.c_str(), value.size() + 1); }
+
+  std::size_t begin_nested(int type) {
+    const auto offset = buffer_.size();
+    nlattr attribute{};
+    attribute.nla_type = static_cast<std::uint16_t>(type | NLA_F_NESTED);
+    append(&attribute, sizeof(attribute));
+    return offset;
+  }
+
+  void end_nested(std::size_t offset) {
+    const auto length = static_cast<std::uint16_t>(buffer_.size() - offset);
+    std::memcpy(buffer_.data() + offset + offsetof(nlattr, nla_len), &length, sizeof(length));
+  }
+
+ private:
+  void append(const void* data, std::size_t size) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + size);
+    buffer_.resize(align(buffer_.size()), 0);
+  }
+
+  std::vector<std::uint8_t>& buffer_;
+  std::size_t start_{0};
+};
+
+// Call fn(header, payload) for each netlink message in a received buffer.
+template <typename Fn>
+void for_each_message(std::span<const std::uint8_t> data, Fn&& fn) {
+  while (data.size() >= sizeof(nlmsghdr)) {
+    nlmsghdr header{};
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (header.nlmsg_len < sizeof(header) || header.nlmsg_len > data.size()) {
+      return;
+    }
+    fn(header, data.subspan(sizeof(header), header.nlmsg_len - sizeof(header)));
+    data = data.subspan(std::min(data.size(), align(header.nlmsg_len)));
+  }
+}
+
+// Call fn(type, payload) for each attribute.
+template <typename Fn>
+void for_each_attr(std::span<const std::uint8_t> data, Fn&& fn) {
+  while (data.size() >= sizeof(nlattr)) {
+    nlattr attribute{};
+    std::memcpy(&attribute, data.data(), sizeof(attribute));
+    if (attribute.nla_len < sizeof(attribute) || attribute.nla_len > data.size()) {
+      return;
+    }
+    fn(attribute.nla_type & ~static_cast<unsigned>(NLA_F_NESTED | NLA_F_NET_BYTEORDER), data.subspan(sizeof(attribute), attribute.nla_len - sizeof(attribute)));
+    data = data.subspan(std::min(data.size(), align(attribute.nla_len)));
+  }
+}
+
+std::uint32_t read_u32(std::span<const std::uint8_t> payload) {
+  std::uint32_t value = 0;
+  std::memcpy(&value, payload.data(), std::min(payload.size(), sizeof(value)));
+  return value;
+}
+
+struct Ipv4Prefix {
+  in_addr address{};
+  std::uint8_t length{32};
+};
+
+// "a.b.c.d/len", or "a.b.c.d" with an optional netmask (a host route if
+// there is none).
+std::optional<Ipv4Prefix> parse_prefix(const std::string& destination, const std::string& netmask) {
+  Ipv4Prefix prefix;
+  std::string address = destination;
+  const auto slash = destination.find('/');
+  if (slash != std::string::npos) {
+    unsigned length = 0;
+    const char* first = destination.data() + slash + 1;
+    const char* last = destination.data() + destination.size();
+    const auto [end, error] = std::from_chars(first, last, length);
+    if (error != std::errc{} || end != last || length > 32) {
+      return std::nullopt;
+    }
+    prefix.length = static_cast<std::uint8_t>(length);
+    address = destination.substr(0, slash);
+  } else if (!netmask.empty()) {
+    in_addr mask{};
+    if (inet_pton(AF_INET, netmask.c_str(), &mask) != 1) {
+      return std::nullopt;
+    }
+    prefix.length = static_cast<std::uint8_t>(std::popcount(mask.s_addr));
+  }
+  if (inet_pton(AF_INET, address.c_str(), &prefix.address) != 1) {
+    return std::nullopt;
+  }
+  return prefix;
+}
+
+// Generic nf_tables message header.
+nfgenmsg nfgen(int family, std::uint16_t res_id) {
+  nfgenmsg header{};
+  header.nfgen_family = static_cast<std::uint8_t>(family);
+  header.version = NFNETLINK_V0;
+  header.res_id = res_id;
+  return header;
+}
+
+// One expression of an nf_tables rule; attrs() writes its attributes.
+template <typename Fn>
+void expression(MessageWriter& msg, const char* name, Fn&& attrs) {
+  const auto element = msg.begin_nested(NFTA_LIST_ELEM);
+  msg.attr_string(NFTA_EXPR_NAME, name);
+  const auto data = msg.begin_nested(NFTA_EXPR_DATA);
+  attrs();
+  msg.end_nested(data);
+  msg.end_nested(element);
+}
+
+// Register 1 == value.
+void compare(MessageWriter& msg, const void* value, std::size_t size) {
+  expression(msg, "cmp", [&] {
+    msg.attr_be32(NFTA_CMP_SREG, NFT_REG_1);
+    msg.attr_be32(NFTA_CMP_OP, NFT_CMP_EQ);
+    const auto data = msg.begin_nested(NFTA_CMP_DATA);
+    msg.attr(NFTA_DATA_VALUE, value, size);
+    msg.end_nested(data);
+  });
+}
+
+// meta iifname/oifname == name.
+void match_interface(MessageWriter& msg, std::uint32_t key, const std::string& name) {
+  expression(msg, "meta", [&] {
+    msg.attr_be32(NFTA_META_KEY, key);
+    msg.attr_be32(NFTA_META_DREG, NFT_REG_1);
+  });
+  std::array<char, IFNAMSIZ> padded{};
+  std::copy_n(name.begin(), std::min(name.size(), padded.size() - 1), padded.begin());
+  compare(msg, padded.data(), padded.size());
+}
+
+// ip saddr within prefix.
+void match_source(MessageWriter& msg, const Ipv4Prefix& prefix) {
+  expression(msg, "payload", [&] {
+    msg.attr_be32(NFTA_PAYLOAD_DREG, NFT_REG_1);
+    msg.attr_be32(NFTA_PAYLOAD_BASE, NFT_PAYLOAD_NETWORK_HEADER);
+    msg.attr_be32(NFTA_PAYLOAD_OFFSET, offsetof(iphdr, saddr));
+    msg.attr_be32(NFTA_PAYLOAD_LEN, sizeof(in_addr));
+  });
+  const std::uint32_t mask = prefix.length == 0 ? 0 : htonl(~std::uint32_t{0} << (32 - prefix.length));
+  if (prefix.length < 32) {
+    expression(msg, "bitwise", [&] {
+      const std::uint32_t zero = 0;
+      msg.attr_be32(NFTA_BITWISE_SREG, NFT_REG_1);
+      msg.attr_be32(NFTA_BITWISE_DREG, NFT_REG_1);
+      msg.attr_be32(NFTA_BITWISE_LEN, sizeof(in_addr));
+      auto nested = msg.begin_nested(NFTA_BITWISE_MASK);
+      msg.attr(NFTA_DATA_VALUE, &mask, sizeof(mask));
+      msg.end_nested(nested);
+      nested = msg.begin_nested(NFTA_BITWISE_XOR);
+      msg.attr(NFTA_DATA_VALUE, &zero, sizeof(zero));
+      msg.end_nested(nested);
+    });
+  }
+  const std::uint32_t network = prefix.address.s_addr & mask;
+  compare(msg, &network, sizeof(network));
+}
+
+void accept(MessageWriter& msg) {
+  expression(msg, "immediate", [&] {
+    msg.attr_be32(NFTA_IMMEDIATE_DREG, NFT_REG_VERDICT);
+    const auto data = msg.begin_nested(NFTA_IMMEDIATE_DATA);
+    const auto verdict = msg.begin_nested(NFTA_DATA_VERDICT);
+    msg.attr_be32(NFTA_VERDICT_CODE, NF_ACCEPT);
+    msg.end_nested(verdict);
+    msg.end_nested(data);
+  });
+}
+
+void snat(MessageWriter& msg, const in_addr& source) {
+  expression(msg, "immediate", [&] {
+    msg.attr_be32(NFTA_IMMEDIATE_DREG, NFT_REG_1);
+    const auto data = msg.begin_nested(NFTA_IMMEDIATE_DATA);
+    msg.attr(NFTA_DATA_VALUE, &source, sizeof(source));
+    msg.end_nested(data);
+  });
+  expression(msg, "nat", [&] {
+    msg.attr_be32(NFTA_NAT_TYPE, NFT_NAT_SNAT);
+    msg.attr_be32(NFTA_NAT_FAMILY, NFPROTO_IPV4);
+    msg.attr_be32(NFTA_NAT_REG_ADDR_MIN, NFT_REG_1);
+  });
+}
+
+void configure_socket(int fd) {
+  // Error ACKs without a copy of the failed request.
+  const int one = 1;
+  setsockopt(fd, SOL_NETLINK, NETLINK_CAP_ACK, &one, sizeof(one));
+  timeval timeout{};
+  timeout.tv_sec = kReceiveTimeoutSec;
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+}
+
+}  // namespace
+
+namespace veil::tun {
+
+Netlink::~Netlink() { close(); }
+
+bool Netlink::open(std::error_code& ec) {
+  if (is_open()) {
+    return true;
+  }
+  route_fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE);
+  if (route_fd_ < 0) {
+    ec = last_error();
+    LOG_DEBUG("Failed to open rtnetlink socket: {}", ec.message());
+    return false;
+  }
+  configure_socket(route_fd_);
+  return true;
+}
+
+bool Netlink::open_netfilter(std::error_code& ec) {
+  if (netfilter_fd_ >= 0) {
+    return true;
+  }
+  netfilter_fd_ = socket(AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_NETFILTER);
+  if (netfilter_fd_ < 0) {
+    ec = last_error();
+    LOG_DEBUG("Failed to open nf_tables netlink socket: {}", ec.message());
+    return false;
+  }
+  configure_socket(netfilter_fd_);
+  return true;
+}
+
+void Netlink::close() {
+  if (route_fd_ >= 0) {
+    ::close(route_fd_);
+    route_fd_ = -1;
+  }
+  if (netfilter_fd_ >= 0) {
+    ::close(netfilter_fd_);
+    netfilter_fd_ = -1;
+  }
+}
+
+bool Netlink::transact(int fd, const std::vector<std::uint8_t>& request, std::uint32_t first_seq,
+                       std::size_t count, std::vector<std::error_code>& results) {
+  // Requests the kernel never answers report a timeout.
+  results.assign(count, std::make_error_code(std::errc::timed_out));
+  sockaddr_nl kernel{};
+  kernel.nl_family = AF_NETLINK;
+  if (sendto(fd, request.data(), request.size(), 0, reinterpret_cast<const sockaddr*>(&kernel), sizeof(kernel)) <
+      0) {
+    std::fill(results.begin(), results.end(), last_error());
+    return false;
+  }
+
+  std::vector<std::uint8_t> buffer(kReceiveBufferSize);
+  std::size_t answered = 0;
+  while (answered < count) {
+    const auto received = recv(fd, buffer.data(), buffer.size(), 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_WARN("No netlink answer for {} of {} requests: {}", count - answered, count, last_error().message());
+      break;
+    }
+    for_each_message(std::span<const std::uint8_t>(buffer.data(), static_cast<std::size_t>(received)),
+                     [&](const nlmsghdr& header, std::span<const std::uint8_t> payload) {
+                       const std::uint32_t index = header.nlmsg_seq - first_seq;
+                       if (header.nlmsg_type != NLMSG_ERROR || payload.size() < sizeof(int) || index >= count) {
+                         return;
+                       }
+                       int error = 0;
+                       std::memcpy(&error, payload.data(), sizeof(error));
+                       results[index] = error == 0 ? std::error_code() : std::error_code(-error, std::generic_category());
+                       ++answered;
+                     });
+  }
+  return std::none_of(results.begin(), results.end(), [](const std::error_code& result) { return bool(result); });
+}
+
+bool Netlink::dump(const std::vector<std::uint8_t>& request, std::uint16_t type,
+                   const std::function<void(std::span<const std::uint8_t>)>& on_message, std::error_code& ec) {
+  sockaddr_nl kernel{};
+  kernel.nl_family = AF_NETLINK;
+  if (sendto(route_fd_, request.data(), request.size(), 0, reinterpret_cast<const sockaddr*>(&kernel),
+             sizeof(kernel)) < 0) {
+    ec = last_error();
+    return false;
+  }
+
+  std::vector<std::uint8_t> buffer(kReceiveBufferSize);
+  bool done = false;
+  while (!done) {
+    const auto received = recv(route_fd_, buffer.data(), buffer.size(), 0);
+    if (received < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      ec = last_error();
+      return false;
+    }
+    for_each_message(std::span<const std::uint8_t>(buffer.data(), static_cast<std::size_t>(received)),
+                     [&](const nlmsghdr& header, std::span<const std::uint8_t> payload) {
+                       if (header.nlmsg_type == NLMSG_DONE) {
+                         done = true;
+                       } else if (header.nlmsg_type == NLMSG_ERROR) {
+                         int error = 0;
+                         std::memcpy(&error, payload.data(), std::min(payload.size(), sizeof(error)));
+                         if (error != 0) {
+                           ec = std::error_code(-error, std::generic_category());
+                         }
+                         done = true;
+                       } else if (header.nlmsg_type == type) {
+                         on_message(payload);
+                       }
+                     });
+  }
+  return !ec;
+}
+
+bool Netlink::set_link_up(const std::string& interface, bool up, std::error_code& ec) {
+  const auto index = if_nametoindex(interface.c_str());
+  if (index == 0) {
+    ec = last_error();
+    return false;
+  }
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  const auto seq = ++sequence_;
+  msg.begin(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK, seq);
+  ifinfomsg info{};
+  info.ifi_family = AF_UNSPEC;
+  info.ifi_index = static_cast<int>(index);
+  info.ifi_flags = up ? static_cast<unsigned>(IFF_UP) : 0U;
+  info.ifi_change = static_cast<unsigned>(IFF_UP);
+  msg.header(info);
+  msg.end();
+
+  std::vector<std::error_code> results;
+  if (!transact(route_fd_, request, seq, 1, results)) {
+    ec = results.front();
+    return false;
+  }
+  return true;
+}
+
+bool Netlink::set_mtu(const std::string& interface, int mtu, std::error_code& ec) {
+  const auto index = if_nametoindex(interface.c_str());
+  if (index == 0) {
+    ec = last_error();
+    return false;
+  }
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  const auto seq = ++sequence_;
+  msg.begin(RTM_NEWLINK, NLM_F_REQUEST | NLM_F_ACK, seq);
+  ifinfomsg info{};
+  info.ifi_family = AF_UNSPEC;
+  info.ifi_index = static_cast<int>(index);
+  msg.header(info);
+  msg.attr_u32(IFLA_MTU, static_cast<std::uint32_t>(mtu));
+  msg.end();
+
+  std::vector<std::error_code> results;
+  if (!transact(route_fd_, request, seq, 1, results)) {
+    ec = results.front();
+    return false;
+  }
+  return true;
+}
+
+bool Netlink::add_address(const std::string& interface, const std::string& address, std::uint8_t prefix_length,
+                          std::error_code& ec) {
+  in_addr local{};
+  if (inet_pton(AF_INET, address.c_str(), &local) != 1 || prefix_length > 32) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+  const auto index = if_nametoindex(interface.c_str());
+  if (index == 0) {
+    ec = last_error();
+    return false;
+  }
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  const auto seq = ++sequence_;
+  msg.begin(RTM_NEWADDR, NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_REPLACE, seq);
+  ifaddrmsg info{};
+  info.ifa_family = AF_INET;
+  info.ifa_prefixlen = prefix_length;
+  info.ifa_scope = RT_SCOPE_UNIVERSE;
+  info.ifa_index = index;
+  msg.header(info);
+  // The same local and peer address: not point-to-point, so the kernel adds
+  // the subnet route as for a broadcast interface.
+  msg.attr(IFA_LOCAL, &local, sizeof(local));
+  msg.attr(IFA_ADDRESS, &local, sizeof(local));
+  msg.end();
+
+  std::vector<std::error_code> results;
+  if (!transact(route_fd_, request, seq, 1, results)) {
+    ec = results.front();
+    return false;
+  }
+  return true;
+}
+
+bool Netlink::add_routes(std::span<const Route> routes, std::vector<std::error_code>& results) {
+  return change_routes(routes, true, results);
+}
+
+bool Netlink::remove_routes(std::span<const Route> routes, std::vector<std::error_code>& results) {
+  return change_routes(routes, false, results);
+}
+
+bool Netlink::change_routes(std::span<const Route> routes, bool add, std::vector<std::error_code>& results) {
+  results.assign(routes.size(), std::error_code());
+  bool all_ok = true;
+  for (std::size_t start = 0; start < routes.size(); start += kBatchSize) {
+    const auto batch = routes.subspan(start, std::min(kBatchSize, routes.size() - start));
+    std::vector<std::uint8_t> request;
+    MessageWriter msg(request);
+    const auto first_seq = sequence_ + 1;
+    // Index into routes of each request sent; invalid routes are not sent.
+    std::vector<std::size_t> sent;
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      const auto& route = batch[i];
+      const auto destination = parse_prefix(route.destination, route.netmask);
+      in_addr gateway{};
+      if (!destination || (!route.gateway.empty() && inet_pton(AF_INET, route.gateway.c_str(), &gateway) != 1)) {
+        results[start + i] = std::make_error_code(std::errc::invalid_argument);
+        continue;
+      }
+      unsigned interface_index = 0;
+      if (!route.interface.empty()) {
+        interface_index = if_nametoindex(route.interface.c_str());
+        if (interface_index == 0) {
+          results[start + i] = std::make_error_code(std::errc::no_such_device);
+          continue;
+        }
+      }
+
+      rtmsg info{};
+      info.rtm_family = AF_INET;
+      info.rtm_dst_len = destination->length;
+      info.rtm_table = RT_TABLE_MAIN;
+      if (add) {
+        // As ip(8): routes without a gateway are link-scoped.
+        info.rtm_protocol = RTPROT_BOOT;
+        info.rtm_scope = route.gateway.empty() ? RT_SCOPE_LINK : RT_SCOPE_UNIVERSE;
+        info.rtm_type = RTN_UNICAST;
+        msg.begin(RTM_NEWROUTE, NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_EXCL, ++sequence_);
+      } else {
+        info.rtm_scope = RT_SCOPE_NOWHERE;
+        msg.begin(RTM_DELROUTE, NLM_F_REQUEST | NLM_F_ACK, ++sequence_);
+      }
+      msg.header(info);
+      if (destination->length > 0) {
+        msg.attr(RTA_DST, &destination->address, sizeof(destination->address));
+      }
+      if (!route.gateway.empty()) {
+        msg.attr(RTA_GATEWAY, &gateway, sizeof(gateway));
+      }
+      if (interface_index != 0) {
+        msg.attr_u32(RTA_OIF, interface_index);
+      }
+      if (add && route.metric > 0) {
+        msg.attr_u32(RTA_PRIORITY, static_cast<std::uint32_t>(route.metric));
+      }
+      msg.end();
+      sent.push_back(start + i);
+    }
+
+    if (sent.empty()) {
+      all_ok = false;
+      continue;
+    }
+    std::vector<std::error_code> batch_results;
+    transact(route_fd_, request, first_seq, sent.size(), batch_results);
+    for (std::size_t i = 0; i < sent.size(); ++i) {
+      results[sent[i]] = batch_results[i];
+    }
+    all_ok = all_ok && sent.size() == batch.size();
+  }
+  return all_ok && std::none_of(results.begin(), results.end(), [](const std::error_code& r) { return bool(r); });
+}
+
+bool Netlink::route_exists(const Route& route, std::error_code& ec) {
+  const auto destination = parse_prefix(route.destination, route.netmask);
+  if (!destination) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+  unsigned interface_index = 0;
+  if (!route.interface.empty()) {
+    interface_index = if_nametoindex(route.interface.c_str());
+    if (interface_index == 0) {
+      return false;
+    }
+  }
+
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  msg.begin(RTM_GETROUTE, NLM_F_REQUEST | NLM_F_DUMP, ++sequence_);
+  rtmsg query{};
+  query.rtm_family = AF_INET;
+  msg.header(query);
+  msg.end();
+
+  bool found = false;
+  const bool ok = dump(request, RTM_NEWROUTE, [&](std::span<const std::uint8_t> payload) {
+    if (payload.size() < sizeof(rtmsg)) {
+      return;
+    }
+    rtmsg info{};
+    std::memcpy(&info, payload.data(), sizeof(info));
+    std::uint32_t table = info.rtm_table;
+    std::uint32_t address = 0;
+    std::uint32_t oif = 0;
+    for_each_attr(payload.subspan(align(sizeof(rtmsg))), [&](unsigned type, std::span<const std::uint8_t> value) {
+      if (type == RTA_TABLE) {
+        table = read_u32(value);
+      } else if (type == RTA_DST) {
+        address = read_u32(value);
+      } else if (type == RTA_OIF) {
+        oif = read_u32(value);
+      }
+    });
+    const std::uint32_t wanted = destination->length == 0 ? 0 : destination->address.s_addr;
+    if (table == RT_TABLE_MAIN && info.rtm_dst_len == destination->length && address == wanted &&
+        (interface_index == 0 || oif == interface_index)) {
+      found = true;
+    }
+  }, ec);
+  return ok && found;
+}
+
+std::optional<DefaultRoute> Netlink::default_route(std::error_code& ec) {
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  msg.begin(RTM_GETROUTE, NLM_F_REQUEST | NLM_F_DUMP, ++sequence_);
+  rtmsg query{};
+  query.rtm_family = AF_INET;
+  msg.header(query);
+  msg.end();
+
+  std::optional<DefaultRoute> best;
+  std::uint32_t best_metric = 0;
+  const bool ok = dump(request, RTM_NEWROUTE, [&](std::span<const std::uint8_t> payload) {
+    if (payload.size() < sizeof(rtmsg)) {
+      return;
+    }
+    rtmsg info{};
+    std::memcpy(&info, payload.data(), sizeof(info));
+    std::uint32_t table = info.rtm_table;
+    std::uint32_t metric = 0;
+    std::uint32_t oif = 0;
+    std::string gateway;
+    for_each_attr(payload.subspan(align(sizeof(rtmsg))), [&](unsigned type, std::span<const std::uint8_t> value) {
+      if (type == RTA_TABLE) {
+        table = read_u32(value);
+      } else if (type == RTA_PRIORITY) {
+        metric = read_u32(value);
+      } else if (type == RTA_OIF) {
+        oif = read_u32(value);
+      } else if (type == RTA_GATEWAY && value.size() == sizeof(in_addr)) {
+        std::array<char, INET_ADDRSTRLEN> text{};
+        inet_ntop(AF_INET, value.data(), text.data(), text.size());
+        gateway = text.data();
+      }
+    });
+    std::array<char, IF_NAMESIZE> name{};
+    if (table != RT_TABLE_MAIN || info.rtm_dst_len != 0 || info.rtm_type != RTN_UNICAST || oif == 0 ||
+        if_indextoname(oif, name.data()) == nullptr || (best && metric >= best_metric)) {
+      return;
+    }
+    best = DefaultRoute{name.data(), gateway};
+    best_metric = metric;
+  }, ec);
+  if (!ok) {
+    return std::nullopt;
+  }
+  return best;
+}
+
+bool Netlink::add_nat(const NatConfig& config, std::error_code& ec) {
+  std::optional<Ipv4Prefix> subnet;
+  if (!config.internal_interface.empty() && !config.vpn_subnet.empty()) {
+    subnet = parse_prefix(config.vpn_subnet, "");
+    if (!subnet) {
+      ec = std::make_error_code(std::errc::invalid_argument);
+      return false;
+    }
+  }
+  in_addr snat_source{};
+  if (!config.use_masquerade && inet_pton(AF_INET, config.snat_source.c_str(), &snat_source) != 1) {
+    ec = std::make_error_code(std::errc::invalid_argument);
+    return false;
+  }
+  if (!open_netfilter(ec)) {
+    return false;
+  }
+
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  msg.begin(NFNL_MSG_BATCH_BEGIN, NLM_F_REQUEST, ++sequence_);
+  msg.header(nfgen(AF_UNSPEC, htons(NFNL_SUBSYS_NFTABLES)));
+  msg.end();
+
+  const auto first_seq = sequence_ + 1;
+  std::size_t count = 0;
+  const auto begin = [&](int type, int flags) {
+    msg.begin((NFNL_SUBSYS_NFTABLES << 8) | type, NLM_F_REQUEST | NLM_F_ACK | flags, ++sequence_);
+    msg.header(nfgen(NFPROTO_IPV4, 0));
+    ++count;
+  };
+  const auto table = [&](int type, int flags) {
+    begin(type, flags);
+    msg.attr_string(NFTA_TABLE_NAME, kNatTable);
+    msg.end();
+  };
+  const auto chain = [&](const char* name, std::uint32_t hook, std::int32_t priority, const char* type) {
+    begin(NFT_MSG_NEWCHAIN, NLM_F_CREATE);
+    msg.attr_string(NFTA_CHAIN_TABLE, kNatTable);
+    msg.attr_string(NFTA_CHAIN_NAME, name);
+    const auto nested = msg.begin_nested(NFTA_CHAIN_HOOK);
+    msg.attr_be32(NFTA_HOOK_HOOKNUM, hook);
+    msg.attr_be32(NFTA_HOOK_PRIORITY, static_cast<std::uint32_t>(priority));
+    msg.end_nested(nested);
+    msg.attr_string(NFTA_CHAIN_TYPE, type);
+    msg.end();
+  };
+  const auto rule = [&](const char* chain_name, const auto& expressions) {
+    begin(NFT_MSG_NEWRULE, NLM_F_CREATE | NLM_F_APPEND);
+    msg.attr_string(NFTA_RULE_TABLE, kNatTable);
+    msg.attr_string(NFTA_RULE_CHAIN, chain_name);
+    const auto nested = msg.begin_nested(NFTA_RULE_EXPRESSIONS);
+    expressions();
+    msg.end_nested(nested);
+    msg.end();
+  };
+
+  // Start from an empty table: create it if missing, delete it with
+  // everything in it, and create it again, all in one transaction.
+  table(NFT_MSG_NEWTABLE, NLM_F_CREATE);
+  table(NFT_MSG_DELTABLE, 0);
+  table(NFT_MSG_NEWTABLE, NLM_F_CREATE);
+  // Priorities of the iptables nat (srcnat) and filter tables.
+  chain("postrouting", NF_INET_POST_ROUTING, 100, "nat");
+  chain("forward", NF_INET_FORWARD, 0, "filter");
+
+  // oifname <external> [ip saddr <subnet>] masquerade | snat to <source>
+  rule("postrouting", [&] {
+    match_interface(msg, NFT_META_OIFNAME, config.external_interface);
+    if (subnet) {
+      match_source(msg, *subnet);
+    }
+    if (config.use_masquerade) {
+      expression(msg, "masq", [] {});
+    } else {
+      snat(msg, snat_source);
+    }
+  });
+  // iifname <internal> accept; oifname <internal> accept
+  rule("forward", [&] {
+    match_interface(msg, NFT_META_IIFNAME, config.internal_interface);
+    accept(msg);
+  });
+  rule("forward", [&] {
+    match_interface(msg, NFT_META_OIFNAME, config.internal_interface);
+    accept(msg);
+  });
+
+  msg.begin(NFNL_MSG_BATCH_END, NLM_F_REQUEST, ++sequence_);
+  msg.header(nfgen(AF_UNSPEC, htons(NFNL_SUBSYS_NFTABLES)));
+  msg.end();
+
+  std::vector<std::error_code> results;
+  if (!transact(netfilter_fd_, request, first_seq, count, results)) {
+    ec = *std::find_if(results.begin(), results.end(), [](const std::error_code& r) { return bool(r); });
+    return false;
+  }
+  return true;
+}
+
+bool Netlink::remove_nat(std::error_code& ec) {
+  if (!open_netfilter(ec)) {
+    return false;
+  }
+  std::vector<std::uint8_t> request;
+  MessageWriter msg(request);
+  msg.begin(NFNL_MSG_BATCH_BEGIN, NLM_F_REQUEST, ++sequence_);
+  msg.header(nfgen(AF_UNSPEC, htons(NFNL_SUBSYS_NFTABLES)));
+  msg.end();
+  const auto seq = ++sequence_;
+  msg.begin((NFNL_SUBSYS_NFTABLES << 8) | NFT_MSG_DELTABLE, NLM_F_REQUEST | NLM_F_ACK, seq);
+  msg.header(nfgen(NFPROTO_IPV4, 0));
+  msg.attr_string(NFTA_TABLE_NAME, kNatTable);
+  msg.end();
+  msg.begin(NFNL_MSG_BATCH_END, NLM_F_REQUEST, ++sequence_);
+  msg.header(nfgen(AF_UNSPEC, htons(NFNL_SUBSYS_NFTABLES)));
+  msg.end();
+
+  std::vector<std::error_code> results;
+  if (!transact(netfilter_fd_, request, seq, 1, results) && results.front() != std::errc::no_such_file_or_directory) {
+    ec = results.front();
+    return false;
+  }
+  return true;
+}
+
+}  // namespace veil::tun
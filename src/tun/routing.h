@@ -1,7 +1,9 @@
 #pragma once
 
 #include <cstdint>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <system_error>
 #include <vector>
@@ -22,6 +24,30 @@ struct Route {
   int metric{0};
 };
 
+// How RouteManager installs NAT rules on Linux.
+enum class NatBackend {
+  // nf_tables over netlink, falling back to iptables(8).
+  kAuto,
+  // nf_tables over netlink only.
+  kNftables,
+  // iptables(8) commands only.
+  kIptables,
+};
+
+// Parse "auto", "nftables" or "iptables".
+inline std::optional<NatBackend> parse_nat_backend(const std::string& name) {
+  if (name == "auto") {
+    return NatBackend::kAuto;
+  }
+  if (name == "nftables") {
+    return NatBackend::kNftables;
+  }
+  if (name == "iptables") {
+    return NatBackend::kIptables;
+  }
+  return std::nullopt;
+}
+
 // NAT configuration for server mode.
 struct NatConfig {
   // Interface to masquerade traffic from (e.g., "veil0").
@@ -36,6 +62,8 @@ struct NatConfig {
   bool use_masquerade{true};
   // SNAT source IP (only used if use_masquerade is false).
   std::string snat_source;
+  // Rule backend (Linux).
+  NatBackend backend{NatBackend::kAuto};
 };
 
 // Result of checking system state.
@@ -50,8 +78,14 @@ struct SystemState {
 // This is useful for NAT configuration when the user doesn't specify an external interface.
 std::optional<std::string> detect_external_interface(std::error_code& ec);
 
+#ifndef _WIN32
+class Netlink;
+#endif
+
 // Manages routing table entries and NAT configuration.
-// Uses system commands (ip route, iptables) for configuration.
+// On Linux, talks netlink (rtnetlink for routes, nf_tables for NAT) and falls
+// back to system commands (ip route, iptables) where netlink is unavailable.
+// On Windows, uses the IP Helper API.
 class RouteManager {
  public:
   RouteManager();
@@ -66,6 +100,11 @@ class RouteManager {
   // Add a route to the routing table.
   bool add_route(const Route& route, std::error_code& ec);
 
+  // Add several routes; on Linux they reach the kernel in a few netlink
+  // batches. results[i] is the outcome for routes[i]; returns true if all
+  // were added.
+  bool add_routes(std::span<const Route> routes, std::vector<std::error_code>& results);
+
   // Remove a route from the routing table.
   bool remove_route(const Route& route, std::error_code& ec);
 
@@ -122,6 +161,16 @@ class RouteManager {
   // Build iptables command for NAT.
   std::string build_nat_command(const NatConfig& config, bool add);
 
+#ifndef _WIN32
+  // Install NAT rules with iptables commands.
+  bool configure_iptables_nat(const NatConfig& config, std::error_code& ec);
+
+  // Null when netlink is unavailable; commands are used instead.
+  std::unique_ptr<Netlink> netlink_;
+  // Whether the NAT rules live in the nf_tables "ip veil" table.
+  bool nat_via_nftables_{false};
+#endif
+
   // Track added routes for cleanup.
   std::vector<Route> added_routes_;
 
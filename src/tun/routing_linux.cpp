@@ -10,6 +10,7 @@
 #include <system_error>
 
 #include "common/logging/logger.h"
+#include "tun/netlink.h"
 
 namespace {
 constexpr const char* kIpForwardPath = "/proc/sys/net/ipv4/ip_forward";
@@ -20,7 +21,13 @@ std::error_code last_error() { return std::error_code(errno, std::generic_catego
 
 namespace veil::tun {
 
-RouteManager::RouteManager() = default;
+RouteManager::RouteManager() : netlink_(std::make_unique<Netlink>()) {
+  std::error_code ec;
+  if (!netlink_->open(ec)) {
+    LOG_WARN("Netlink unavailable ({}), using ip/iptables commands", ec.message());
+    netlink_.reset();
+  }
+}
 
 RouteManager::~RouteManager() { cleanup(); }
 
@@ -65,6 +72,15 @@ bool RouteManager::execute_command_check(const std::string& command, std::error_
 }
 
 bool RouteManager::add_route(const Route& route, std::error_code& ec) {
+  if (netlink_) {
+    std::vector<std::error_code> results;
+    if (!add_routes(std::span<const Route>(&route, 1), results)) {
+      ec = results.front();
+      return false;
+    }
+    return true;
+  }
+
   // Check if ip command is available.
   if (!is_tool_available("ip", ec)) {
     ec = std::make_error_code(std::errc::no_such_file_or_directory);
@@ -127,7 +143,42 @@ bool RouteManager::add_route(const Route& route, std::error_code& ec) {
   return true;
 }
 
+bool RouteManager::add_routes(std::span<const Route> routes, std::vector<std::error_code>& results) {
+  if (!netlink_) {
+    results.assign(routes.size(), std::error_code());
+    bool all_added = true;
+    for (std::size_t i = 0; i < routes.size(); ++i) {
+      all_added = add_route(routes[i], results[i]) && all_added;
+    }
+    return all_added;
+  }
+
+  const bool all_added = netlink_->add_routes(routes, results);
+  for (std::size_t i = 0; i < routes.size(); ++i) {
+    const auto& route = routes[i];
+    if (results[i]) {
+      LOG_ERROR("Failed to add route {}: {}", route.destination, results[i].message());
+      continue;
+    }
+    added_routes_.push_back(route);
+    LOG_INFO("Added route: {} via {} dev {}", route.destination, route.gateway.empty() ? "(direct)" : route.gateway,
+             route.interface);
+  }
+  return all_added;
+}
+
 bool RouteManager::remove_route(const Route& route, std::error_code& ec) {
+  if (netlink_) {
+    std::vector<std::error_code> results;
+    if (!netlink_->remove_routes(std::span<const Route>(&route, 1), results)) {
+      ec = results.front();
+      LOG_ERROR("Failed to remove route {}: {}", route.destination, ec.message());
+      return false;
+    }
+    LOG_INFO("Removed route: {}", route.destination);
+    return true;
+  }
+
   std::ostringstream cmd;
   cmd << "ip route del " << route.destination;
 
@@ -267,6 +318,49 @@ std::string RouteManager::build_nat_command(const NatConfig& config, bool add) {
 }
 
 bool RouteManager::configure_nat(const NatConfig& config, std::error_code& ec) {
+  if (config.backend == NatBackend::kIptables || !netlink_) {
+    if (config.backend == NatBackend::kNftables) {
+      ec = std::make_error_code(std::errc::not_supported);
+      LOG_ERROR("Cannot configure NAT: nftables backend requested but netlink is unavailable");
+      return false;
+    }
+    return configure_iptables_nat(config, ec);
+  }
+
+  bool forwarding_enabled = false;
+  if (config.enable_forwarding) {
+    if (!set_ip_forwarding(true, ec)) {
+      LOG_ERROR("Failed to enable IP forwarding: {}", ec.message());
+      return false;
+    }
+    forwarding_enabled = true;
+  }
+
+  // The whole ruleset is one nf_tables transaction: nothing to roll back
+  // but forwarding if it fails.
+  if (!netlink_->add_nat(config, ec)) {
+    if (forwarding_enabled && forwarding_state_saved_) {
+      std::error_code rollback_ec;
+      set_ip_forwarding(original_forwarding_state_, rollback_ec);
+    }
+    if (config.backend == NatBackend::kNftables) {
+      LOG_ERROR("Failed to add nftables NAT rules: {}", ec.message());
+      return false;
+    }
+    LOG_WARN("Failed to add nftables NAT rules ({}), falling back to iptables", ec.message());
+    ec.clear();
+    return configure_iptables_nat(config, ec);
+  }
+
+  nat_configured_ = true;
+  nat_via_nftables_ = true;
+  current_nat_config_ = config;
+  LOG_INFO("NAT configured via nftables: {} -> {} (subnet: {}, mode: {})", config.internal_interface,
+           config.external_interface, config.vpn_subnet, config.use_masquerade ? "MASQUERADE" : "SNAT");
+  return true;
+}
+
+bool RouteManager::configure_iptables_nat(const NatConfig& config, std::error_code& ec) {
   // Check if iptables is available before proceeding.
   if (!check_firewall_availability(ec)) {
     ec = std::make_error_code(std::errc::no_such_file_or_directory);
@@ -336,6 +430,7 @@ bool RouteManager::configure_nat(const NatConfig& config, std::error_code& ec) {
 
   // All rules added successfully.
   nat_configured_ = true;
+  nat_via_nftables_ = false;
   current_nat_config_ = config;
 
   // Log state after modifications.
@@ -348,6 +443,17 @@ bool RouteManager::configure_nat(const NatConfig& config, std::error_code& ec) {
 }
 
 bool RouteManager::remove_nat(const NatConfig& config, std::error_code& ec) {
+  if (nat_via_nftables_ && netlink_) {
+    if (!netlink_->remove_nat(ec)) {
+      LOG_ERROR("Failed to remove nftables NAT rules: {}", ec.message());
+      return false;
+    }
+    nat_configured_ = false;
+    nat_via_nftables_ = false;
+    LOG_INFO("NAT removed");
+    return true;
+  }
+
   // Remove MASQUERADE rule.
   const std::string cmd = build_nat_command(config, false);
   execute_command_check(cmd, ec);  // Ignore errors.
@@ -370,6 +476,15 @@ std::optional<SystemState> RouteManager::get_system_state(std::error_code& ec) {
   SystemState state;
   state.ip_forwarding_enabled = is_ip_forwarding_enabled(ec);
 
+  if (netlink_) {
+    std::error_code route_ec;
+    if (auto route = netlink_->default_route(route_ec)) {
+      state.default_interface = route->interface;
+      state.default_gateway = route->gateway;
+    }
+    return state;
+  }
+
   // Get default route info.
   auto result = execute_command("ip route show default", ec);
   if (result && !result->empty()) {
@@ -399,6 +514,18 @@ bool RouteManager::save_routes(std::error_code& ec) {
 }
 
 bool RouteManager::restore_routes(std::error_code& ec) {
+  if (netlink_ && !added_routes_.empty()) {
+    const std::vector<Route> routes(added_routes_.rbegin(), added_routes_.rend());
+    std::vector<std::error_code> results;
+    netlink_->remove_routes(routes, results);
+    for (std::size_t i = 0; i < routes.size(); ++i) {
+      if (results[i]) {
+        LOG_WARN("Failed to remove route {}: {}", routes[i].destination, results[i].message());
+      }
+    }
+    added_routes_.clear();
+  }
+
   // Remove added routes in reverse order.
   // NOLINTNEXTLINE(modernize-loop-convert) - std::ranges::reverse_view has compatibility issues with clang
   for (auto it = added_routes_.rbegin(); it != added_routes_.rend(); ++it) {
@@ -417,6 +544,10 @@ bool RouteManager::restore_routes(std::error_code& ec) {
 }
 
 bool RouteManager::route_exists(const Route& route, std::error_code& ec) {
+  if (netlink_) {
+    return netlink_->route_exists(route, ec);
+  }
+
   std::ostringstream cmd;
   cmd << "ip route show " << route.destination;
   if (!route.interface.empty()) {
@@ -440,6 +571,22 @@ void RouteManager::cleanup() {
 }
 
 std::optional<std::string> detect_external_interface(std::error_code& ec) {
+  Netlink netlink;
+  std::error_code netlink_ec;
+  if (netlink.open(netlink_ec)) {
+    auto route = netlink.default_route(netlink_ec);
+    if (route) {
+      LOG_INFO("Auto-detected external interface: {}", route->interface);
+      return route->interface;
+    }
+    if (!netlink_ec) {
+      ec = std::make_error_code(std::errc::no_such_device);
+      LOG_ERROR("No default route found. Is the network configured?");
+      return std::nullopt;
+    }
+    LOG_DEBUG("Netlink route dump failed ({}), falling back to ip route", netlink_ec.message());
+  }
+
   // Use ip route to find the default route interface.
   // Command: ip route show default
   // Output example: "default via 192.168.1.1 dev eth0 proto dhcp metric 100"
@@ -216,6 +216,15 @@ bool RouteManager::add_route(const Route& route, std::error_code& ec) {
   return true;
 }
 
+bool RouteManager::add_routes(std::span<const Route> routes, std::vector<std::error_code>& results) {
+  results.assign(routes.size(), std::error_code());
+  bool all_added = true;
+  for (std::size_t i = 0; i < routes.size(); ++i) {
+    all_added = add_route(routes[i], results[i]) && all_added;
+  }
+  return all_added;
+}
+
 bool RouteManager::remove_route(const Route& route, std::error_code& ec) {
   MIB_IPFORWARD_ROW2 row;
   InitializeIpForwardEntry(&row);
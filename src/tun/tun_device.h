@@ -8,6 +8,7 @@
 #include <span>
 #include <string>
 #include <system_error>
+#include <utility>
 #include <vector>
 
 namespace veil::tun {
@@ -86,6 +87,22 @@ class TunDevice {
   // Returns true on success.
   bool write(std::span<const std::uint8_t> packet, std::error_code& ec);
 
+#ifndef _WIN32
+  // Asynchronous write path installed by an io_uring event loop. write()
+  // frames the packet (adding the packet info header if enabled) and hands it
+  // to the hook, which copies it; if the hook returns false the packet is
+  // written synchronously. Not transferred on move.
+  using WriteHook = std::function<bool(std::span<const std::uint8_t>)>;
+  void set_write_hook(WriteHook hook) { write_hook_ = std::move(hook); }
+#endif
+
+#ifdef _WIN32
+  // Event signalled while packets are waiting (WintunGetReadWaitEvent()), to
+  // wait on together with other handles; drain with read_into() until it
+  // returns 0 before waiting again. nullptr if the device is closed.
+  void* read_wait_event() const;
+#endif
+
   // Poll for incoming packets with timeout.
   bool poll(const ReadHandler& handler, int timeout_ms, std::error_code& ec);
 
@@ -112,6 +129,9 @@ class TunDevice {
   std::string device_name_;
   TunStats stats_;
   bool packet_info_{false};
+#ifndef _WIN32
+  WriteHook write_hook_;
+#endif
 
 #ifdef _WIN32
   // Windows-specific implementation details (Wintun)
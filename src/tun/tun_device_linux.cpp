@@ -12,9 +12,12 @@
 #include <unistd.h>
 
 #include <array>
+#include <bit>
+#include <optional>
 #include <system_error>
 
 #include "common/logging/logger.h"
+#include "tun/netlink.h"
 
 namespace {
 std::error_code last_error() { return std::error_code(errno, std::generic_category()); }
@@ -24,6 +27,20 @@ constexpr std::size_t kMaxPacketSize = 65535;
 
 // TUN packet info header size (4 bytes: flags + proto).
 constexpr std::size_t kTunPiSize = 4;
+
+// Prefix length of a dotted netmask, or nullopt if it is not one.
+std::optional<std::uint8_t> prefix_length(const std::string& netmask) {
+  in_addr mask{};
+  if (inet_pton(AF_INET, netmask.c_str(), &mask) != 1) {
+    return std::nullopt;
+  }
+  const std::uint32_t bits = ntohl(mask.s_addr);
+  // Contiguous ones from the top.
+  if ((~bits & (~bits + 1)) != 0) {
+    return std::nullopt;
+  }
+  return static_cast<std::uint8_t>(std::popcount(bits));
+}
 }  // namespace
 
 namespace veil::tun {
@@ -87,9 +104,20 @@ bool TunDevice::open(const TunConfig& config, std::error_code& ec) {
   device_name_ = ifr.ifr_name;
   LOG_INFO("Created TUN device: {}", device_name_);
 
+  // One netlink socket configures the interface; each step falls back to the
+  // ioctl path if netlink is unavailable or fails.
+  Netlink netlink;
+  std::error_code netlink_ec;
+  if (!netlink.open(netlink_ec)) {
+    LOG_DEBUG("Netlink unavailable ({}), configuring {} with ioctls", netlink_ec.message(), device_name_);
+  }
+
   // Configure IP address if provided.
   if (!config.ip_address.empty()) {
-    if (!configure_address(config, ec)) {
+    const auto length = prefix_length(config.netmask);
+    if (netlink.is_open() && length && netlink.add_address(device_name_, config.ip_address, *length, netlink_ec)) {
+      LOG_INFO("Set IP address {}/{} on {}", config.ip_address, *length, device_name_);
+    } else if (!configure_address(config, ec)) {
       close();
       return false;
     }
@@ -97,7 +125,9 @@ bool TunDevice::open(const TunConfig& config, std::error_code& ec) {
 
   // Set MTU.
   if (config.mtu > 0) {
-    if (!configure_mtu(config.mtu, ec)) {
+    if (netlink.is_open() && netlink.set_mtu(device_name_, config.mtu, netlink_ec)) {
+      LOG_INFO("Set MTU {} on {}", config.mtu, device_name_);
+    } else if (!configure_mtu(config.mtu, ec)) {
       close();
       return false;
     }
@@ -105,7 +135,9 @@ bool TunDevice::open(const TunConfig& config, std::error_code& ec) {
 
   // Bring interface up.
   if (config.bring_up) {
-    if (!bring_interface_up(ec)) {
+    if (netlink.is_open() && netlink.set_link_up(device_name_, true, netlink_ec)) {
+      LOG_INFO("Brought interface {} up", device_name_);
+    } else if (!bring_interface_up(ec)) {
       close();
       return false;
     }
@@ -362,7 +394,11 @@ bool TunDevice::write(std::span<const std::uint8_t> packet, std::error_code& ec)
     buffer[2] = static_cast<std::uint8_t>((proto >> 8) & 0xFF);
     buffer[3] = static_cast<std::uint8_t>(proto & 0xFF);
     std::memcpy(buffer.data() + kTunPiSize, packet.data(), packet.size());
-    n = ::write(fd_, buffer.data(), buffer.size());
+    if (write_hook_ && write_hook_(buffer)) {
+      n = static_cast<std::ptrdiff_t>(buffer.size());
+    } else {
+      n = ::write(fd_, buffer.data(), buffer.size());
+    }
     if (n < 0 || static_cast<std::size_t>(n) != buffer.size()) {
       ec = last_error();
       stats_.write_errors++;
@@ -371,7 +407,11 @@ bool TunDevice::write(std::span<const std::uint8_t> packet, std::error_code& ec)
       return false;
     }
   } else {
-    n = ::write(fd_, packet.data(), packet.size());
+    if (write_hook_ && write_hook_(packet)) {
+      n = static_cast<std::ptrdiff_t>(packet.size());
+    } else {
+      n = ::write(fd_, packet.data(), packet.size());
+    }
     if (n < 0 || static_cast<std::size_t>(n) != packet.size()) {
       ec = last_error();
       stats_.write_errors++;
@@ -535,6 +535,10 @@ bool TunDevice::write(std::span<const std::uint8_t> packet, std::error_code& ec)
   return true;
 }
 
+void* TunDevice::read_wait_event() const {
+  return impl_ && impl_->session ? impl_->read_event : nullptr;
+}
+
 bool TunDevice::poll(const ReadHandler& handler, int timeout_ms, std::error_code& ec) {
   if (!impl_ || !impl_->session || !impl_->read_event) {
     ec = std::make_error_code(std::errc::not_connected);
@@ -1,7 +1,18 @@
 #include "tunnel/tunnel.h"
 
+#include <sodium.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <poll.h>
+#endif
+
+#include <algorithm>
 #include <array>
+#include <cerrno>
 #include <fstream>
+#include <mutex>
 
 #include "common/handshake/handshake_processor.h"
 #include "transport/mux/mux_codec.h"
@@ -18,14 +29,27 @@ namespace veil::tunnel {
 namespace {
 constexpr std::size_t kMaxPacketSize = 65535;
 
+// Maintenance cadence: while data is unacknowledged or a connection step is
+// pending, and when the tunnel is otherwise idle.
+constexpr std::chrono::milliseconds kActiveMaintenanceInterval{10};
+constexpr std::chrono::milliseconds kIdleMaintenanceInterval{100};
+// IPv4 and UDP headers in front of each datagram.
+constexpr int kIpv4UdpHeaderSize = 20 + 8;
+// Smallest link MTU IPv6 allows; the TUN MTU does not follow the path below it.
+constexpr int kMinTunMtu = 1280;
+// Most TUN packets read per wakeup; the upstream worker reads its burst into
+// a buffer with room for several maximum-size packets.
+constexpr std::size_t kTunBurst = 64;
+constexpr std::size_t kUpstreamBufferSize = 4 * kMaxPacketSize;
+
 // Helper functions for ACK sending logging (Issue #72 fix)
 // These avoid the bugprone-lambda-function-name clang-tidy warning when LOG_* is used in lambdas
 void log_ack_send_error(const std::error_code& ec) {
   LOG_WARN("Failed to send ACK to server: {}", ec.message());
 }
 
-void log_ack_sent([[maybe_unused]] std::uint64_t ack, [[maybe_unused]] std::uint32_t bitmap) {
-  LOG_DEBUG("Sent ACK to server: ack={}, bitmap={:#010x}", ack, bitmap);
+void log_ack_sent([[maybe_unused]] std::size_t size) {
+  LOG_DEBUG("Sent ACK to server: {} bytes", size);
 }
 
 // Helper to provide actionable error message for key file issues.
@@ -114,15 +138,50 @@ bool load_key_from_file(const std::string& path, std::vector<std::uint8_t>& key,
 
   return true;
 }
+
+transport::PacketCoalescerConfig coalescer_config(const TunnelConfig& config) {
+  auto coalescing = config.coalescing;
+  coalescing.max_datagram_size = config.transport.mtu;
+  return coalescing;
+}
+
+transport::PrioritySchedulerConfig scheduler_config(const TunnelConfig& config) {
+  auto scheduling = config.priority_scheduler;
+  scheduling.max_datagram_size = config.transport.mtu;
+  return scheduling;
+}
+
+// PMTU discovery works in datagram sizes. The search starts at transport.mtu
+// and may go down to what every IPv6 path carries.
+tun::PmtuConfig pmtu_config(const TunnelConfig& config) {
+  auto pmtu = config.pmtu;
+  pmtu.initial_mtu = static_cast<int>(config.transport.mtu);
+  pmtu.min_mtu = std::min(std::max(pmtu.min_mtu, static_cast<int>(transport::kMinPathMtu)), pmtu.initial_mtu);
+  pmtu.max_mtu = std::max(pmtu.max_mtu, pmtu.initial_mtu);
+  return pmtu;
+}
 }  // namespace
 
 Tunnel::Tunnel(TunnelConfig config, std::function<TimePoint()> now_fn)
     : config_(std::move(config)),
       now_fn_(std::move(now_fn)),
-      pmtu_discovery_(config_.pmtu, now_fn_),
-      ack_scheduler_(mux::AckSchedulerConfig{}, now_fn_) {}
-
-Tunnel::~Tunnel() { stop(); }
+      pmtu_discovery_(pmtu_config(config_), now_fn_),
+      coalescer_(coalescer_config(config_), now_fn_),
+      classifier_(config_.traffic_classifier, now_fn_),
+      scheduler_(scheduler_config(config_)),
+      transmit_queue_(
+          config_.transmit,
+          [this](std::span<const transport::UdpPacket> packets, std::error_code& ec) {
+            return udp_socket_.send_batch(packets, ec);
+          },
+          now_fn_) {}
+
+Tunnel::~Tunnel() {
+  stop();
+  // SECURITY: Clear cached session keys
+  sodium_memzero(resumption_keys_.send_key.data(), resumption_keys_.send_key.size());
+  sodium_memzero(resumption_keys_.recv_key.data(), resumption_keys_.recv_key.size());
+}
 
 bool Tunnel::initialize(std::error_code& ec) {
   LOG_INFO("Initializing tunnel...");
@@ -173,6 +232,7 @@ bool Tunnel::initialize(std::error_code& ec) {
     LOG_ERROR("Failed to open UDP socket: {}", ec.message());
     return false;
   }
+  setup_kernel_pacing();
   // Log both requested and actual bound port (they differ if requested port was 0)
   std::uint16_t actual_port = udp_socket_.local_port();
   if (config_.local_port == 0) {
@@ -257,118 +317,100 @@ void Tunnel::run() {
 
       set_state(ConnectionState::kConnected);
       stats_.connected_since = now_fn_();
+      start_pmtu_discovery();
     }
   }
 
-  // Main event loop.
-  std::array<std::uint8_t, kMaxPacketSize> tun_buffer{};
-
-  // Diagnostic counters for periodic logging
-  std::uint64_t loop_iterations = 0;
-  std::uint64_t last_logged_tx = 0;
-  std::uint64_t last_logged_rx = 0;
-  auto last_diagnostic_log = now_fn_();
+  last_diagnostic_log_ = now_fn_();
 
-  while (running_.load()
 #ifdef _WIN32
-         && !console_handler.should_terminate()
-#else
-         && !sig_handler.should_terminate()
-#endif
-  ) {
-    std::error_code ec;
-    loop_iterations++;
-
-    // Check TUN device for incoming packets (only if device is open).
-    if (tun_device_.is_open()) {
-      auto tun_read = tun_device_.read_into(tun_buffer, ec);
-      if (tun_read > 0) {
-        on_tun_packet(std::span<const std::uint8_t>(tun_buffer.data(), static_cast<std::size_t>(tun_read)));
-      } else if (tun_read < 0) {
-        LOG_ERROR("TUN read error: {}", ec.message());
-        stats_.tun_read_errors++;
-      }
-    }
+  // Main loop: one WaitForMultipleObjects covers the UDP socket, the Wintun
+  // read event and the next deadline, so the loop sleeps until there is work
+  // to do and then drains both sources completely.
+  if (config_.enable_worker_threads) {
+    LOG_WARN("Worker threads are not supported on Windows, running single-threaded");
+  }
+  udp_event_ = WSACreateEvent();
+  if (udp_event_ == WSA_INVALID_EVENT) {
+    LOG_ERROR("WSACreateEvent failed: WSA error {}", WSAGetLastError());
+    udp_event_ = nullptr;
+  } else {
+    select_udp_event();
+  }
 
-    // Poll UDP socket for incoming packets.
-    if (!udp_socket_.poll(
-        [this](const transport::UdpPacket& pkt) {
-          on_udp_packet(pkt.data, pkt.remote);
-        },
-        10, ec)) {
-      LOG_ERROR("UDP poll failed: {}", ec.message());
+  std::chrono::milliseconds wait{0};
+  while (running_.load() && !console_handler.should_terminate()) {
+    std::array<HANDLE, 2> handles{};
+    DWORD handle_count = 0;
+    if (udp_event_ != nullptr) {
+      handles[handle_count++] = udp_event_;
     }
-
-    // Periodic diagnostic logging (every 5 seconds when connected)
-    auto now = now_fn_();
-    auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_diagnostic_log);
-    if (elapsed.count() >= 5 && state_.load() == ConnectionState::kConnected) {
-      last_diagnostic_log = now;
-
-      // Log traffic stats if they changed
-      if (stats_.udp_packets_sent != last_logged_tx || stats_.udp_packets_received != last_logged_rx) {
-        LOG_INFO("Tunnel stats: packets_sent={}, packets_received={}, loops={}, decrypt_errors={}, encrypt_errors={}",
-                 stats_.udp_packets_sent, stats_.udp_packets_received, loop_iterations,
-                 stats_.decrypt_errors, stats_.encrypt_errors);
-        last_logged_tx = stats_.udp_packets_sent;
-        last_logged_rx = stats_.udp_packets_received;
-      }
-
-      // Warn if we're sending but not receiving
-      if (stats_.udp_packets_sent > 10 && stats_.udp_packets_received == 0) {
-        LOG_WARN("WARNING: Sending packets but receiving none! Check firewall and server connectivity.");
-        LOG_WARN("  - Packets sent: {}, Packets received: {}", stats_.udp_packets_sent, stats_.udp_packets_received);
-        LOG_WARN("  - Server: {}:{}", config_.server_address, config_.server_port);
-      }
+    if (auto* tun_event = tun_device_.read_wait_event()) {
+      handles[handle_count++] = tun_event;
     }
-
-    // Process session timers if we have an active session.
-    if (session_) {
-      // Check for retransmits.
-      auto retransmits = session_->get_retransmit_packets();
-      for (const auto& pkt : retransmits) {
-        std::error_code send_ec;
-        transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-        if (!udp_socket_.send(pkt, remote, send_ec)) {
-          LOG_WARN("Failed to send retransmit: {}", send_ec.message());
-        }
-      }
-
-      // Issue #95: Check for delayed ACKs (ACK coalescing).
-      // The scheduler uses a timer to batch ACKs, reducing overhead.
-      auto stream_id_opt = ack_scheduler_.check_ack_timer();
-      if (stream_id_opt) {
-        auto ack_frame_opt = ack_scheduler_.get_pending_ack(*stream_id_opt);
-        if (ack_frame_opt) {
-          auto ack_mux_frame = mux::make_ack_frame(
-              ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-          auto ack_packet = session_->encrypt_frame(ack_mux_frame);
-          transport::UdpEndpoint server_endpoint{config_.server_address, config_.server_port};
-          std::error_code send_ec;
-          if (!udp_socket_.send(ack_packet, server_endpoint, send_ec)) {
-            log_ack_send_error(send_ec);
-          } else {
-            log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-          }
-          ack_scheduler_.ack_sent(*stream_id_opt);
-        }
-      }
-
-      // Check for session rotation.
-      if (session_->should_rotate_session()) {
-        session_->rotate_session();
-        LOG_DEBUG("Session rotated");
-      }
+    // Without a socket event the socket is polled at least every 10 ms.
+    if (udp_event_ == nullptr) {
+      wait = std::min(wait, kActiveMaintenanceInterval);
+    }
+    const auto timeout = static_cast<DWORD>(wait.count());
+    if (handle_count == 0) {
+      Sleep(timeout);
+    } else if (WaitForMultipleObjects(handle_count, handles.data(), FALSE, timeout) == WAIT_FAILED) {
+      LOG_ERROR("WaitForMultipleObjects failed: {}",
+                std::error_code(static_cast<int>(GetLastError()), std::system_category()).message());
     }
 
-    // Handle reconnection if needed.
-    if (state_.load() == ConnectionState::kReconnecting) {
-      handle_reconnect();
+    // Drain whatever is ready, whichever handle fired: an empty source costs
+    // one non-blocking call. The socket event is reset first, so data that
+    // arrives while draining signals it again.
+    std::error_code ec;
+    if (udp_event_ != nullptr) {
+      WSAResetEvent(udp_event_);
+    }
+    if (!udp_socket_.poll(
+            [this](const transport::UdpPacket& pkt) {
+              on_udp_packet(pkt.data, pkt.remote);
+            },
+            0, ec)) {
+      LOG_ERROR("UDP poll failed: {}", ec.message());
     }
+    send_pending_ack(true);
+    const bool tun_pending = drain_tun();
+    service_transmit_queue();
 
-    stats_.last_activity = now_fn_();
+    // Come straight back for packets still in the Wintun ring.
+    const auto next = std::min(run_maintenance(), poll_wait());
+    wait = tun_pending ? std::chrono::milliseconds{0} : next;
   }
 
+  if (udp_event_ != nullptr) {
+    WSAEventSelect(static_cast<SOCKET>(udp_socket_.native_handle()), nullptr, 0);
+    WSACloseEvent(udp_event_);
+    udp_event_ = nullptr;
+  }
+#else
+  // Main event loop: one epoll wait covers the UDP socket, the TUN device and
+  // the next timer, so the loop sleeps until there is work to do. With worker
+  // threads the upstream worker waits on the TUN device instead.
+  worker_threads_ = config_.enable_worker_threads && !config_.server_address.empty();
+  if (worker_threads_ && event_loop_->backend() != transport::EventLoopBackend::kEpoll) {
+    LOG_WARN("Worker threads need the epoll event loop backend, running single-threaded");
+    worker_threads_ = false;
+  }
+  register_event_sources();
+  // ACKs not carried by outgoing data go out once per receive burst.
+  event_loop_->set_iteration_handler([this]() {
+    const auto lock = lock_data_plane();
+    send_pending_ack(true);
+  });
+  schedule_maintenance(std::chrono::milliseconds(0));
+  event_loop_->run();
+  event_loop_->set_iteration_handler({});
+  stop_upstream_worker();
+  unregister_event_sources();
+  worker_threads_ = false;
+#endif
+
   LOG_INFO("Tunnel stopping...");
   set_state(ConnectionState::kDisconnected);
   running_.store(false);
@@ -387,6 +429,294 @@ void Tunnel::stop() {
   LOG_INFO("Tunnel stopped");
 }
 
+std::unique_lock<std::mutex> Tunnel::lock_data_plane() {
+  std::unique_lock<std::mutex> lock(data_mutex_);
+  if (session_) {
+    session_->bind_to_current_thread();
+  }
+  return lock;
+}
+
+#ifdef _WIN32
+void Tunnel::select_udp_event() {
+  if (udp_event_ == nullptr || udp_socket_.native_handle() == static_cast<std::uintptr_t>(INVALID_SOCKET)) {
+    return;
+  }
+  // Also makes the socket non-blocking, as poll() expects.
+  if (WSAEventSelect(static_cast<SOCKET>(udp_socket_.native_handle()), udp_event_, FD_READ) == SOCKET_ERROR) {
+    LOG_ERROR("WSAEventSelect failed: WSA error {}", WSAGetLastError());
+  }
+}
+#endif
+
+std::chrono::milliseconds Tunnel::run_maintenance() {
+  // Periodic diagnostic logging (every 5 seconds when connected)
+  auto now = now_fn_();
+  auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - last_diagnostic_log_);
+  if (elapsed.count() >= 5 && state_.load() == ConnectionState::kConnected) {
+    last_diagnostic_log_ = now;
+
+    // Log traffic stats if they changed
+    if (stats_.udp_packets_sent != last_logged_tx_ || stats_.udp_packets_received != last_logged_rx_) {
+      LOG_INFO("Tunnel stats: packets_sent={}, packets_received={}, decrypt_errors={}, encrypt_errors={}",
+               stats_.udp_packets_sent, stats_.udp_packets_received,
+               stats_.decrypt_errors, stats_.encrypt_errors);
+      last_logged_tx_ = stats_.udp_packets_sent;
+      last_logged_rx_ = stats_.udp_packets_received;
+    }
+
+    // Warn if we're sending but not receiving
+    if (stats_.udp_packets_sent > 10 && stats_.udp_packets_received == 0) {
+      LOG_WARN("WARNING: Sending packets but receiving none! Check firewall and server connectivity.");
+      LOG_WARN("  - Packets sent: {}, Packets received: {}", stats_.udp_packets_sent, stats_.udp_packets_received);
+      LOG_WARN("  - Server: {}:{}", config_.server_address, config_.server_port);
+    }
+  }
+
+  flush_coalesced_if_due();
+
+  // Process session timers if we have an active session.
+  if (session_) {
+    // Check for retransmits.
+    auto retransmits = session_->get_retransmit_packets();
+    for (auto& pkt : retransmits) {
+      queue_datagram(std::move(pkt), false);
+    }
+    if (!retransmits.empty()) {
+      service_transmit_queue();
+    }
+
+    // Issue #95: Delayed ACKs (ACK coalescing). Outgoing data usually
+    // carries them; a standalone ACK goes out when the timer expires.
+    send_pending_ack(false);
+
+    // Check for session rotation.
+    if (session_->should_rotate_session()) {
+      session_->rotate_session();
+      LOG_DEBUG("Session rotated");
+    }
+
+    if (pmtu_discovery_active()) {
+      send_mtu_probe();
+    }
+  }
+
+  // Issue #86: Fall back to a full handshake if a 0-RTT INIT goes unanswered.
+  if (zero_rtt_initiator_ && now_fn_() - zero_rtt_sent_at_ >= config_.zero_rtt_timeout) {
+    LOG_WARN("0-RTT resumption not answered within {}ms, falling back to full handshake",
+             config_.zero_rtt_timeout.count());
+    abandon_zero_rtt();
+  }
+
+  // Handle reconnection if needed.
+  if (state_.load() == ConnectionState::kReconnecting) {
+    handle_reconnect();
+  }
+
+  stats_.last_activity = now_fn_();
+
+  // Sleep until the next thing that needs this function: a delayed ACK, a
+  // coalescing deadline, queued priority traffic, an RTO check while data is unacknowledged, or a pending (re)connection step.
+  auto next = kIdleMaintenanceInterval;
+  if (auto ack_due = session_ ? session_->time_until_ack() : std::nullopt) {
+    next = std::min(next, std::max(*ack_due, std::chrono::milliseconds(0)));
+  }
+  if (auto flush_due = coalescer_.time_until_flush()) {
+    next = std::min(next, std::chrono::ceil<std::chrono::milliseconds>(*flush_due));
+  }
+  if (pmtu_discovery_active()) {
+    if (auto probe_due = pmtu_discovery_.time_until_probe(config_.server_address)) {
+      next = std::min(next, *probe_due);
+    }
+  }
+  if (!scheduler_.empty() && session_) {
+    // Queued behind the congestion window: ACKs reopen it, pacing needs a timer.
+    const auto pacing = session_->time_until_next_send();
+    next = std::min(next, pacing ? std::chrono::ceil<std::chrono::milliseconds>(*pacing)
+                                 : kActiveMaintenanceInterval);
+  }
+  if (worker_threads_) {
+    // Retransmissions queued here behind pacing: the upstream worker only
+    // wakes up for its own deadlines.
+    if (auto transmit_due = transmit_queue_.time_until_next()) {
+      next = std::min(next, std::chrono::ceil<std::chrono::milliseconds>(*transmit_due));
+    }
+  }
+  if ((session_ && session_->bytes_in_flight() > 0) || zero_rtt_initiator_ ||
+      state_.load() == ConnectionState::kReconnecting) {
+    next = std::min(next, kActiveMaintenanceInterval);
+  }
+  return next;
+}
+
+#ifndef _WIN32
+void Tunnel::schedule_maintenance(std::chrono::milliseconds delay) {
+  event_loop_->schedule_timer(delay, [this](utils::TimerId) {
+    if (!running_.load() || signal::SignalHandler::instance().should_terminate()) {
+      event_loop_->stop();
+      return;
+    }
+    std::chrono::milliseconds next{};
+    {
+      const auto lock = lock_data_plane();
+      next = run_maintenance();
+    }
+    schedule_maintenance(next);
+  });
+}
+
+void Tunnel::register_event_sources() {
+  if (!event_loop_) {
+    return;
+  }
+
+  const int udp_fd = udp_socket_.fd();
+  if (udp_fd != registered_udp_fd_ && udp_fd >= 0) {
+    if (event_loop_->add_socket(&udp_socket_, 0, {},
+                                [this](transport::SessionId, std::span<const std::uint8_t> data,
+                                       const transport::UdpEndpoint& remote) {
+                                  on_udp_packet(data, remote);
+                                })) {
+      registered_udp_fd_ = udp_fd;
+    }
+  }
+
+  if (worker_threads_) {
+    // The upstream worker waits on the TUN device itself.
+    start_upstream_worker();
+    return;
+  }
+  const int tun_fd = tun_device_.is_open() ? tun_device_.fd() : -1;
+  if (tun_fd != registered_tun_fd_ && tun_fd >= 0) {
+    if (event_loop_->add_fd(tun_fd, [this]() { drain_tun(); })) {
+      registered_tun_fd_ = tun_fd;
+      if (event_loop_->backend() == transport::EventLoopBackend::kIoUring) {
+        // Decrypted packets are written through the ring with the UDP sends.
+        tun_device_.set_write_hook([this, tun_fd](std::span<const std::uint8_t> packet) {
+          return event_loop_->write_fd(tun_fd, packet);
+        });
+      }
+    }
+  }
+}
+
+void Tunnel::unregister_event_sources() {
+  if (!event_loop_) {
+    return;
+  }
+  // Must run before the descriptors are closed: the kernel may hand the same
+  // numbers to the replacements.
+  if (registered_udp_fd_ >= 0) {
+    event_loop_->remove_socket(registered_udp_fd_);
+    registered_udp_fd_ = -1;
+  }
+  if (registered_tun_fd_ >= 0) {
+    tun_device_.set_write_hook({});
+    event_loop_->remove_fd(registered_tun_fd_);
+    registered_tun_fd_ = -1;
+  }
+}
+
+void Tunnel::start_upstream_worker() {
+  if (!worker_threads_ || !tun_device_.is_open() || upstream_worker_.is_running()) {
+    return;
+  }
+  upstream_worker_.join();
+  if (upstream_buffer_.empty()) {
+    upstream_buffer_.resize(kUpstreamBufferSize);
+  }
+  upstream_worker_.start([this]() { run_upstream(); });
+  LOG_INFO("Data plane split: upstream on a worker thread, downstream on the event loop thread");
+}
+
+void Tunnel::stop_upstream_worker() {
+  upstream_worker_.stop();
+  upstream_worker_.join();
+}
+
+void Tunnel::run_upstream() {
+  const int tun_fd = tun_device_.fd();
+  std::vector<std::span<const std::uint8_t>> burst;
+  burst.reserve(kTunBurst);
+  auto wait = kIdleMaintenanceInterval;
+  while (upstream_worker_.is_running() && running_.load()) {
+    pollfd tun_poll{.fd = tun_fd, .events = POLLIN, .revents = 0};
+    if (::poll(&tun_poll, 1, static_cast<int>(wait.count())) < 0 && errno != EINTR) {
+      LOG_ERROR("TUN poll failed: {}", std::error_code(errno, std::generic_category()).message());
+      break;
+    }
+
+    // Read without the lock, so the downstream thread keeps going.
+    burst.clear();
+    std::size_t used = 0;
+    while (burst.size() < kTunBurst && upstream_buffer_.size() - used >= kMaxPacketSize) {
+      std::error_code ec;
+      const auto tun_read =
+          tun_device_.read_into(std::span<std::uint8_t>(upstream_buffer_).subspan(used, kMaxPacketSize), ec);
+      if (tun_read <= 0) {
+        if (tun_read < 0) {
+          LOG_ERROR("TUN read error: {}", ec.message());
+          stats_.tun_read_errors++;
+        }
+        break;
+      }
+      burst.emplace_back(upstream_buffer_.data() + used, static_cast<std::size_t>(tun_read));
+      used += static_cast<std::size_t>(tun_read);
+    }
+
+    const auto lock = lock_data_plane();
+    for (const auto packet : burst) {
+      on_tun_packet(packet);
+    }
+    flush_coalesced_if_due();
+    service_transmit_queue();
+    wait = poll_wait();
+  }
+}
+#endif
+
+bool Tunnel::drain_tun() {
+  const auto lock = lock_data_plane();
+  if (tun_buffer_.empty()) {
+    tun_buffer_.resize(kMaxPacketSize);
+  }
+  // Read a burst per call, so received datagrams and timers are not starved
+  // while the TUN device keeps filling up.
+  bool more = tun_device_.is_open();
+  for (std::size_t burst = 0; more && burst < kTunBurst; ++burst) {
+    std::error_code ec;
+    const auto tun_read = tun_device_.read_into(tun_buffer_, ec);
+    if (tun_read > 0) {
+      on_tun_packet(std::span<const std::uint8_t>(tun_buffer_.data(), static_cast<std::size_t>(tun_read)));
+    } else {
+      if (tun_read < 0) {
+        LOG_ERROR("TUN read error: {}", ec.message());
+        stats_.tun_read_errors++;
+      }
+      more = false;
+    }
+  }
+  // End of the burst: send what was read unless it may wait for more.
+  flush_coalesced_if_due();
+  return more;
+}
+
+std::chrono::milliseconds Tunnel::poll_wait() const {
+  auto next = kIdleMaintenanceInterval;
+  if (auto flush_due = coalescer_.time_until_flush()) {
+    next = std::min(next, std::chrono::ceil<std::chrono::milliseconds>(*flush_due));
+  }
+  if (auto transmit_due = transmit_queue_.time_until_next()) {
+    next = std::min(next, std::chrono::ceil<std::chrono::milliseconds>(*transmit_due));
+  }
+  if (!scheduler_.empty() && session_) {
+    const auto pacing = session_->time_until_next_send();
+    next = std::min(next, pacing ? std::chrono::ceil<std::chrono::milliseconds>(*pacing)
+                                 : kActiveMaintenanceInterval);
+  }
+  return next;
+}
+
 void Tunnel::on_tun_packet(std::span<const std::uint8_t> packet) {
   stats_.tun_packets_received++;
   stats_.tun_bytes_received += packet.size();
@@ -395,23 +725,137 @@ void Tunnel::on_tun_packet(std::span<const std::uint8_t> packet) {
     return;
   }
 
-  // Encrypt and send through UDP.
-  auto encrypted_packets = session_->encrypt_data(packet);
-  for (const auto& enc_pkt : encrypted_packets) {
-    std::error_code ec;
-    transport::UdpEndpoint remote{config_.server_address, config_.server_port};
-    if (!udp_socket_.send(enc_pkt, remote, ec)) {
-      LOG_WARN("Failed to send encrypted packet: {}", ec.message());
-      stats_.encrypt_errors++;
-      continue;
+  // Queue by priority; sent at the end of the burst as far as the congestion
+  // window allows.
+  if (config_.enable_priority_scheduling) {
+    if (!scheduler_.enqueue(packet, classifier_.classify(packet))) {
+      stats_.tun_packets_dropped++;
     }
-    stats_.udp_packets_sent++;
-    stats_.udp_bytes_sent += enc_pkt.size();
+    return;
+  }
+
+  // With the congestion window full, drop the packet as a full interface
+  // queue would. Sealing it anyway would only park it in transmit_queue_,
+  // where its wait counts against the retransmit timeout.
+  if (!session_->can_send(session_->bytes_in_flight())) {
+    stats_.tun_packets_dropped++;
+    return;
+  }
+
+  // Queue for coalescing; a full datagram's worth is sent at once, the rest
+  // when the burst ends or the coalescing delay expires.
+  if (coalescer_.add(packet)) {
+    flush_coalesced();
   }
 }
 
+void Tunnel::flush_coalesced() {
+  if (!session_) {
+    coalescer_.clear();
+    scheduler_.clear();
+    return;
+  }
+
+  auto encrypted_packets = config_.enable_priority_scheduling ? scheduler_.drain(*session_)
+                                                              : coalescer_.flush(*session_);
+  transmit_queue_.set_pacing_rate(session_->pacing_rate());
+  for (auto& enc_pkt : encrypted_packets) {
+    queue_datagram(std::move(enc_pkt), config_.enable_timing_jitter);
+  }
+  service_transmit_queue();
+}
+
+void Tunnel::queue_datagram(std::vector<std::uint8_t> datagram, bool jitter) {
+  const auto size = datagram.size();
+  const auto departure = jitter ? obfuscation::calculate_next_send_ts(obfuscation_profile_, jitter_sequence_++, now_fn_())
+                                : TimePoint{};
+  if (!transmit_queue_.enqueue(std::move(datagram), {config_.server_address, config_.server_port}, departure)) {
+    LOG_WARN("Transmit queue full, dropping datagram");
+    stats_.encrypt_errors++;
+    return;
+  }
+  stats_.udp_packets_sent++;
+  stats_.udp_bytes_sent += size;
+}
+
+void Tunnel::service_transmit_queue() {
+  transmit_queue_.flush();
+  const auto wait = transmit_queue_.time_until_next();
+  if (!wait) {
+    return;
+  }
+#ifndef _WIN32
+  // The Windows loop and the upstream worker wait for this themselves (see
+  // poll_wait()).
+  if (!worker_threads_ && !transmit_timer_armed_ && event_loop_) {
+    transmit_timer_armed_ = true;
+    event_loop_->schedule_timer(*wait, [this](utils::TimerId) {
+      const auto lock = lock_data_plane();
+      transmit_timer_armed_ = false;
+      service_transmit_queue();
+    });
+  }
+#endif
+}
+
+void Tunnel::setup_kernel_pacing() {
+  if (!config_.transmit.kernel_pacing) {
+    return;
+  }
+  std::error_code ec;
+  const bool enabled = udp_socket_.enable_txtime(ec);
+  if (!enabled) {
+    LOG_WARN("Kernel pacing (SO_TXTIME) unavailable, pacing in user space: {}", ec.message());
+  }
+  transmit_queue_.set_kernel_pacing(enabled);
+}
+
+void Tunnel::send_pending_ack(bool end_of_burst) {
+  if (!session_) {
+    return;
+  }
+  auto ack_packet = session_->take_ack_packet(end_of_burst);
+  if (!ack_packet) {
+    return;
+  }
+  transport::UdpEndpoint server_endpoint{config_.server_address, config_.server_port};
+  std::error_code send_ec;
+  if (!udp_socket_.send(*ack_packet, server_endpoint, send_ec)) {
+    log_ack_send_error(send_ec);
+  } else {
+    log_ack_sent(ack_packet->size());
+  }
+}
+
+void Tunnel::flush_coalesced_if_due() {
+  if (!scheduler_.empty()) {
+    flush_coalesced();
+    return;
+  }
+  const auto wait = coalescer_.time_until_flush();
+  if (!wait) {
+    return;
+  }
+  if (wait->count() == 0) {
+    flush_coalesced();
+    return;
+  }
+#ifndef _WIN32
+  // The Windows loop and the upstream worker wait for this themselves (see
+  // poll_wait()).
+  if (!worker_threads_ && !coalesce_timer_armed_ && event_loop_) {
+    coalesce_timer_armed_ = true;
+    event_loop_->schedule_timer(*wait, [this](utils::TimerId) {
+      const auto lock = lock_data_plane();
+      coalesce_timer_armed_ = false;
+      flush_coalesced_if_due();
+    });
+  }
+#endif
+}
+
 void Tunnel::on_udp_packet(std::span<const std::uint8_t> packet,
-                            const transport::UdpEndpoint& remote) {
+                            [[maybe_unused]] const transport::UdpEndpoint& remote) {
   stats_.udp_packets_received++;
   stats_.udp_bytes_received += packet.size();
 
@@ -419,77 +863,102 @@ void Tunnel::on_udp_packet(std::span<const std::uint8_t> packet,
     return;
   }
 
-  // Decrypt the packet.
-  auto frames = session_->decrypt_packet(packet);
-  if (!frames) {
-    LOG_DEBUG("Failed to decrypt packet from {}:{}", remote.host, remote.port);
-    stats_.decrypt_errors++;
-    return;
+  // With worker threads, authenticate and decrypt before taking the lock so
+  // the upstream worker keeps encrypting meanwhile. The reply to a pending
+  // 0-RTT INIT is a handshake packet and takes the locked path.
+  std::optional<transport::OpenedPacket> opened;
+  if (worker_threads_ && !zero_rtt_initiator_) {
+    opened = session_->open_packet(packet);
+    if (!opened) {
+      LOG_DEBUG("Failed to decrypt packet from {}:{}", remote.host, remote.port);
+      stats_.decrypt_errors++;
+      return;
+    }
   }
 
-  // Process each frame.
-  for (const auto& frame : *frames) {
-    if (frame.kind == mux::FrameKind::kData) {
-      // Write decrypted data to TUN device.
-      std::error_code ec;
-      if (!tun_device_.write(frame.data.payload, ec)) {
-        LOG_ERROR("Failed to write to TUN: {}", ec.message());
-        stats_.tun_write_errors++;
-        continue;
-      }
-      stats_.tun_packets_sent++;
-      stats_.tun_bytes_sent += frame.data.payload.size();
-
-      // Log successful TUN write for diagnostics (helps debug Issue #74)
-      // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
-      if (frame.data.payload.size() >= 20) {
-        // Extract destination IP from IPv4 header for logging
-        [[maybe_unused]] std::uint32_t dst_ip = 0;
-        dst_ip |= static_cast<std::uint32_t>(frame.data.payload[16]) << 24;
-        dst_ip |= static_cast<std::uint32_t>(frame.data.payload[17]) << 16;
-        dst_ip |= static_cast<std::uint32_t>(frame.data.payload[18]) << 8;
-        dst_ip |= static_cast<std::uint32_t>(frame.data.payload[19]);
-        LOG_DEBUG("TUN write: {} bytes -> {}.{}.{}.{}",
-                  frame.data.payload.size(),
-                  (dst_ip >> 24) & 0xFF, (dst_ip >> 16) & 0xFF,
-                  (dst_ip >> 8) & 0xFF, dst_ip & 0xFF);
-      } else {
-        LOG_DEBUG("TUN write: {} bytes (packet too small for IPv4)", frame.data.payload.size());
-      }
+  std::optional<std::vector<mux::MuxFrame>> frames;
+  {
+    const auto lock = lock_data_plane();
+
+    // Issue #86: The reply to a pending 0-RTT INIT is a handshake packet.
+    if (zero_rtt_initiator_ && handle_zero_rtt_response(packet)) {
+      return;
+    }
+
+    // Decrypt the packet.
+    frames = opened ? session_->accept_packet(std::move(*opened)) : session_->decrypt_packet(packet);
+    if (!frames) {
+      LOG_DEBUG("Failed to decrypt packet from {}:{}", remote.host, remote.port);
+      stats_.decrypt_errors++;
+      return;
+    }
+
+    if (zero_rtt_initiator_) {
+      // Traffic under the resumed keys means the server accepted the ticket,
+      // even if its accept message was lost.
+      LOG_INFO("0-RTT resumption confirmed by server traffic");
+      stats_.zero_rtt_accepted++;
+      zero_rtt_initiator_.reset();
+    }
 
-      // Issue #95: ACK coalescing - use AckScheduler to batch ACKs
-      // Instead of sending ACK immediately on every data packet, the scheduler
-      // delays ACKs (up to 20ms) or batches them (every 2 packets), reducing overhead.
-      bool should_send_ack = ack_scheduler_.on_packet_received(
-          frame.data.stream_id, frame.data.sequence, frame.data.fin);
-
-      if (should_send_ack) {
-        // Scheduler determined immediate ACK is needed (e.g., out-of-order or every N packets)
-        auto ack_frame_opt = ack_scheduler_.get_pending_ack(frame.data.stream_id);
-        if (ack_frame_opt) {
-          // IMPORTANT: Use encrypt_frame() instead of encrypt_data() to preserve the ACK frame kind.
-          // encrypt_data() wraps data in a DATA frame, which would cause the receiver to
-          // incorrectly interpret the ACK as data and try to write it to TUN.
-          auto ack_mux_frame = mux::make_ack_frame(
-              ack_frame_opt->stream_id, ack_frame_opt->ack, ack_frame_opt->bitmap);
-          auto ack_packet = session_->encrypt_frame(ack_mux_frame);
-          transport::UdpEndpoint server_endpoint{config_.server_address, config_.server_port};
-          std::error_code send_ec;
-          if (!udp_socket_.send(ack_packet, server_endpoint, send_ec)) {
-            log_ack_send_error(send_ec);
-          } else {
-            log_ack_sent(ack_frame_opt->ack, ack_frame_opt->bitmap);
-          }
-          ack_scheduler_.ack_sent(frame.data.stream_id);
+    // Process ACK and control frames; data is written to the TUN device
+    // once the lock is released.
+    bool acked = false;
+    for (const auto& frame : *frames) {
+      if (frame.kind == mux::FrameKind::kAck) {
+        session_->process_ack(frame.ack);
+        acked = true;
+        for (const auto size : session_->take_acked_probes()) {
+          pmtu_discovery_.handle_probe_success(config_.server_address, static_cast<int>(size));
         }
+      } else if (frame.kind == mux::FrameKind::kControl &&
+                 frame.control.type == static_cast<std::uint8_t>(mux::ControlType::kSessionTicket)) {
+        handle_session_ticket(frame.control.payload);
       }
-    } else if (frame.kind == mux::FrameKind::kAck) {
-      session_->process_ack(frame.ack);
     }
+
+    // The ACK opened the congestion window for queued priority traffic.
+    if (acked && !scheduler_.empty()) {
+      flush_coalesced();
+    }
+
+    // Issue #95: ACK coalescing. Received data is acknowledged by the next
+    // outgoing data packet, or once per receive burst (see send_pending_ack());
+    // only a long burst forces an ACK here.
+    send_pending_ack(false);
   }
 
-  // Update PMTU discovery.
-  pmtu_discovery_.handle_probe_success(remote.host, static_cast<int>(packet.size()));
+  for (const auto& frame : *frames) {
+    if (frame.kind != mux::FrameKind::kData) {
+      continue;
+    }
+    // Write decrypted data to TUN device.
+    std::error_code ec;
+    if (!tun_device_.write(frame.data.payload, ec)) {
+      LOG_ERROR("Failed to write to TUN: {}", ec.message());
+      stats_.tun_write_errors++;
+      continue;
+    }
+    stats_.tun_packets_sent++;
+    stats_.tun_bytes_sent += frame.data.payload.size();
+
+    // Log successful TUN write for diagnostics (helps debug Issue #74)
+    // Changed to DEBUG level to avoid performance impact in hot path (Issue #92)
+    if (frame.data.payload.size() >= 20) {
+      // Extract destination IP from IPv4 header for logging
+      [[maybe_unused]] std::uint32_t dst_ip = 0;
+      dst_ip |= static_cast<std::uint32_t>(frame.data.payload[16]) << 24;
+      dst_ip |= static_cast<std::uint32_t>(frame.data.payload[17]) << 16;
+      dst_ip |= static_cast<std::uint32_t>(frame.data.payload[18]) << 8;
+      dst_ip |= static_cast<std::uint32_t>(frame.data.payload[19]);
+      LOG_DEBUG("TUN write: {} bytes -> {}.{}.{}.{}",
+                frame.data.payload.size(),
+                (dst_ip >> 24) & 0xFF, (dst_ip >> 16) & 0xFF,
+                (dst_ip >> 8) & 0xFF, dst_ip & 0xFF);
+    } else {
+      LOG_DEBUG("TUN write: {} bytes (packet too small for IPv4)", frame.data.payload.size());
+    }
+  }
 }
 
 bool Tunnel::perform_handshake(std::error_code& ec) {
@@ -508,8 +977,14 @@ bool Tunnel::perform_handshake(std::error_code& ec) {
   }
   LOG_DEBUG("HANDSHAKE: PSK validated (32 bytes)");
 
+  // Issue #86: Resume without a round trip if we hold a ticket for this server.
+  if (config_.enable_zero_rtt && !config_.enable_fec && try_zero_rtt_resume(ec)) {
+    return true;
+  }
+
   // Create handshake initiator.
   handshake::HandshakeInitiator initiator(config_.psk, config_.handshake_skew_tolerance);
+  initiator.set_fec(config_.enable_fec);
 
   // Generate INIT message.
   auto init_msg = initiator.create_init();
@@ -602,11 +1077,100 @@ bool Tunnel::perform_handshake(std::error_code& ec) {
 
   // Create transport session from handshake result.
   session_ = std::make_unique<transport::TransportSession>(*hs_session, config_.transport, now_fn_);
+  resumption_keys_ = hs_session->keys;
 
   LOG_INFO("Handshake completed successfully, session ID: {}", session_->session_id());
   return true;
 }
 
+bool Tunnel::try_zero_rtt_resume(std::error_code& ec) {
+  auto ticket = ticket_store_.get_ticket(server_id());
+  if (!ticket) {
+    return false;
+  }
+
+  auto initiator = std::make_unique<handshake::ZeroRttInitiator>(config_.psk, std::move(*ticket));
+  auto init_msg = initiator->create_zero_rtt_init();
+
+  transport::UdpEndpoint remote{config_.server_address, config_.server_port};
+  if (!udp_socket_.send(init_msg, remote, ec)) {
+    LOG_WARN("HANDSHAKE: Failed to send 0-RTT INIT: {}", ec.message());
+    ec.clear();
+    return false;
+  }
+  stats_.zero_rtt_attempts++;
+
+  // The session is usable immediately: data sent before the server's reply
+  // travels in the same flight as the INIT (early data).
+  handshake::HandshakeSession early_session{
+      .session_id = 0,
+      .keys = initiator->early_keys(),
+      .initiator_ephemeral = {},
+      .responder_ephemeral = {},
+      .client_id = {},
+  };
+  session_ = std::make_unique<transport::TransportSession>(early_session, config_.transport, now_fn_);
+  resumption_keys_ = early_session.keys;
+  sodium_memzero(early_session.keys.send_key.data(), early_session.keys.send_key.size());
+  sodium_memzero(early_session.keys.recv_key.data(), early_session.keys.recv_key.size());
+
+  zero_rtt_initiator_ = std::move(initiator);
+  zero_rtt_sent_at_ = now_fn_();
+  LOG_INFO("HANDSHAKE: 0-RTT INIT sent ({} bytes), early data enabled", init_msg.size());
+  return true;
+}
+
+bool Tunnel::handle_zero_rtt_response(std::span<const std::uint8_t> packet) {
+  auto hs_session = zero_rtt_initiator_->consume_zero_rtt_response(packet);
+  if (hs_session) {
+    LOG_INFO("0-RTT resumption accepted, session ID: {}", hs_session->session_id);
+    stats_.zero_rtt_accepted++;
+    zero_rtt_initiator_.reset();
+    return true;
+  }
+  if (zero_rtt_initiator_->was_rejected()) {
+    LOG_INFO("0-RTT resumption rejected by server, falling back to full handshake");
+    stats_.zero_rtt_rejected++;
+    abandon_zero_rtt();
+    return true;
+  }
+  return false;
+}
+
+void Tunnel::abandon_zero_rtt() {
+  ticket_store_.remove_ticket(server_id());
+  zero_rtt_initiator_.reset();
+  session_.reset();
+  coalescer_.clear();
+  scheduler_.clear();
+  transmit_queue_.clear();
+  // Retry right away: the full handshake is not subject to the reconnect delay.
+  last_reconnect_attempt_ = TimePoint{};
+  set_state(ConnectionState::kReconnecting);
+}
+
+void Tunnel::handle_session_ticket(std::span<const std::uint8_t> message) {
+  if (!config_.enable_zero_rtt) {
+    return;
+  }
+  const auto received_at_ms = static_cast<std::uint64_t>(
+      std::chrono::duration_cast<std::chrono::milliseconds>(
+          std::chrono::system_clock::now().time_since_epoch())
+          .count());
+  auto ticket = handshake::decode_ticket_message(message, received_at_ms);
+  if (!ticket) {
+    LOG_DEBUG("Ignoring malformed session ticket ({} bytes)", message.size());
+    return;
+  }
+  ticket->cached_keys = resumption_keys_;
+  LOG_DEBUG("Stored session ticket for {} (lifetime {}ms)", server_id(), ticket->lifetime_ms);
+  ticket_store_.store_ticket(server_id(), std::move(*ticket));
+}
+
+std::string Tunnel::server_id() const {
+  return config_.server_address + ":" + std::to_string(config_.server_port);
+}
+
 void Tunnel::set_state(ConnectionState new_state) {
   ConnectionState old_state = state_.exchange(new_state);
   if (old_state != new_state) {
@@ -672,6 +1236,12 @@ void Tunnel::handle_reconnect() {
   set_state(ConnectionState::kConnecting);
 
   // Re-initialize socket.
+#ifndef _WIN32
+  if (registered_udp_fd_ >= 0 && event_loop_) {
+    event_loop_->remove_socket(registered_udp_fd_);
+    registered_udp_fd_ = -1;
+  }
+#endif
   udp_socket_.close();
   std::error_code ec;
   if (!udp_socket_.open(config_.local_port, true, ec)) {
@@ -679,6 +1249,12 @@ void Tunnel::handle_reconnect() {
     set_state(ConnectionState::kReconnecting);
     return;
   }
+#ifdef _WIN32
+  select_udp_event();
+#endif
+  // Whatever was queued belongs to the old session.
+  transmit_queue_.clear();
+  setup_kernel_pacing();
 
   // Reconnect.
   transport::UdpEndpoint remote{config_.server_address, config_.server_port};
@@ -707,11 +1283,16 @@ void Tunnel::handle_reconnect() {
     LOG_INFO("TUN device {} opened with IP {}", tun_device_.device_name(), config_.tun.ip_address);
   }
 
+#ifndef _WIN32
+  register_event_sources();
+#endif
+
   // Success!
   reconnect_attempts_ = 0;
   stats_.reconnect_count++;
   stats_.connected_since = now_fn_();
   set_state(ConnectionState::kConnected);
+  start_pmtu_discovery();
   LOG_INFO("Reconnected successfully");
 }
 
@@ -722,12 +1303,76 @@ void Tunnel::on_state_change(StateChangeCallback callback) {
 void Tunnel::on_error(ErrorCallback callback) { error_callback_ = std::move(callback); }
 
 void Tunnel::handle_mtu_change(const std::string& peer, int old_mtu, int new_mtu) {
-  LOG_INFO("MTU changed for {}: {} -> {}", peer, old_mtu, new_mtu);
-  // Update TUN device MTU.
-  std::error_code mtu_ec;
-  if (!tun_device_.set_mtu(new_mtu, mtu_ec)) {
-    LOG_WARN("Failed to update TUN MTU: {}", mtu_ec.message());
+  LOG_INFO("Path MTU for {} changed: {} -> {} byte datagrams", peer, old_mtu, new_mtu);
+  const auto datagram_size = static_cast<std::size_t>(new_mtu);
+  coalescer_.set_max_datagram_size(datagram_size);
+  scheduler_.set_max_datagram_size(datagram_size);
+  if (!session_) {
+    return;
+  }
+  session_->set_mtu(datagram_size);
+
+  // Update TUN device MTU: packets up to what fits in one datagram, and at
+  // least the configured MTU (larger packets are fragmented). A path below
+  // transport.mtu shrinks the interface by as much, so TCP sizes its
+  // segments to fit again, but not below the IPv6 minimum.
+  if (tun_device_.is_open()) {
+    int tun_mtu = std::max(config_.tun.mtu, static_cast<int>(session_->max_unfragmented_payload()));
+    if (session_->mtu() < config_.transport.mtu) {
+      const auto shrink = static_cast<int>(config_.transport.mtu - session_->mtu());
+      tun_mtu = std::max(config_.tun.mtu - shrink, std::min(config_.tun.mtu, kMinTunMtu));
+    }
+    std::error_code mtu_ec;
+    if (!tun_device_.set_mtu(tun_mtu, mtu_ec)) {
+      LOG_WARN("Failed to update TUN MTU: {}", mtu_ec.message());
+    }
+  }
+}
+
+void Tunnel::start_pmtu_discovery() {
+  if (config_.enable_pmtu_discovery && !config_.server_address.empty()) {
+    pmtu_discovery_.reset(config_.server_address);
+  }
+}
+
+bool Tunnel::pmtu_discovery_active() const {
+  return config_.enable_pmtu_discovery && session_ && !config_.server_address.empty() && !zero_rtt_initiator_ &&
+         state_.load() == ConnectionState::kConnected;
+}
+
+void Tunnel::send_mtu_probe() {
+  const auto& peer = config_.server_address;
+  const auto due = pmtu_discovery_.time_until_probe(peer);
+  if (!due || due->count() > 0) {
+    return;
+  }
+
+  // Never probe beyond what the kernel can send towards the server: the
+  // interface MTU, or a smaller path MTU it learned from ICMP.
+  std::error_code ec;
+  if (const auto path_mtu = udp_socket_.path_mtu(ec)) {
+    pmtu_discovery_.set_probe_limit(peer, *path_mtu - kIpv4UdpHeaderSize);
+  }
+
+  const auto size = pmtu_discovery_.next_probe(peer);
+  if (!size) {
+    return;
+  }
+  auto probe = session_->encrypt_probe(static_cast<std::size_t>(*size));
+  if (!probe) {
+    return;
+  }
+  transport::UdpEndpoint remote{config_.server_address, config_.server_port};
+  const bool sent = config_.pmtu.set_df_bit ? udp_socket_.send_probe(*probe, remote, ec)
+                                            : udp_socket_.send(*probe, remote, ec);
+  if (!sent) {
+    // Counted as lost: the search moves on once the probe times out.
+    LOG_DEBUG("PMTU probe of {} bytes not sent: {}", *size, ec.message());
+    return;
   }
+  LOG_DEBUG("PMTU probe of {} bytes sent", *size);
+  stats_.udp_packets_sent++;
+  stats_.udp_bytes_sent += probe->size();
 }
 
 }  // namespace veil::tunnel
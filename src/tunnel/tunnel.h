@@ -5,22 +5,31 @@
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <span>
 #include <string>
 #include <system_error>
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
+#include "common/handshake/session_ticket.h"
 #include "common/obfuscation/obfuscation_profile.h"
+#include "common/utils/thread_pool.h"
 #include "transport/event_loop/event_loop.h"
-#include "transport/mux/ack_scheduler.h"
 #include "transport/mux/frame.h"
+#include "transport/session/packet_coalescer.h"
+#include "transport/session/priority_scheduler.h"
+#include "transport/session/transmit_queue.h"
 #include "transport/session/transport_session.h"
 #include "transport/udp_socket/udp_socket.h"
 #include "tun/mtu_discovery.h"
 #include "tun/routing.h"
 #include "tun/tun_device.h"
 
+namespace veil::handshake {
+class ZeroRttInitiator;
+}  // namespace veil::handshake
+
 namespace veil::tunnel {
 
 // Connection state.
@@ -51,9 +60,15 @@ struct TunnelStats {
   std::uint64_t encrypt_errors{0};
   std::uint64_t tun_read_errors{0};
   std::uint64_t tun_write_errors{0};
+  // TUN packets dropped because their priority queue was full, or, without
+  // priority scheduling, because the congestion window was.
+  std::uint64_t tun_packets_dropped{0};
 
   // Connection.
   std::uint64_t reconnect_count{0};
+  std::uint64_t zero_rtt_attempts{0};
+  std::uint64_t zero_rtt_accepted{0};
+  std::uint64_t zero_rtt_rejected{0};
   std::chrono::steady_clock::time_point connected_since;
   std::chrono::steady_clock::time_point last_activity;
 };
@@ -82,7 +97,48 @@ struct TunnelConfig {
   // Event loop configuration.
   transport::EventLoopConfig event_loop;
 
-  // PMTU discovery configuration.
+  // Client, Linux: split the data plane over two threads. A worker thread
+  // reads the TUN device, encrypts and sends (upstream); the event loop
+  // thread receives, decrypts, writes to the TUN device and runs the timers
+  // (downstream). The threads share the session under a lock, but decryption
+  // and TUN I/O happen outside it (TransportSession::open_packet()), so a
+  // download does not starve an upload of CPU. Needs the epoll backend;
+  // ignored with io_uring, whose ring belongs to the loop thread, and on
+  // Windows.
+  bool enable_worker_threads{false};
+
+  // Coalescing of small TUN packets into shared datagrams. The datagram
+  // budget is taken from transport.mtu.
+  transport::PacketCoalescerConfig coalescing;
+
+  // Classify TUN packets into interactive and bulk traffic and send them
+  // through per-class queues gated by the congestion window, so interactive
+  // packets do not wait behind a bulk transfer. The scheduler packs datagrams
+  // itself and replaces coalescing; the datagram budget is taken from
+  // transport.mtu.
+  bool enable_priority_scheduling{false};
+  transport::TrafficClassifierConfig traffic_classifier;
+  transport::PrioritySchedulerConfig priority_scheduler;
+
+  // Data datagrams (and retransmissions) leave through a transmit queue that
+  // spaces them at the session's pacing rate and sends each due batch with
+  // one system call. transmit.kernel_pacing is tried on the UDP socket and
+  // dropped with a warning if SO_TXTIME is unavailable.
+  transport::TransmitQueueConfig transmit;
+
+  // Delay data datagrams by the obfuscation profile's timing jitter
+  // (obfuscation::calculate_next_send_ts()). Needs an obfuscation seed. Adds
+  // up to the profile's maximum jitter of latency; datagrams keep their order.
+  bool enable_timing_jitter{false};
+
+  // Client: packetization-layer path MTU discovery. Padded heartbeat probes
+  // (DF set) find the largest datagram the path carries; the session, the
+  // coalescer and the TUN MTU follow it. Sizes here are datagram sizes (UDP
+  // payload). The search starts at transport.mtu and may go down to
+  // transport::kMinPathMtu, shrinking fragments, once a probe that small gets
+  // through; pmtu.max_mtu and the local interface cap it. The server
+  // acknowledges probes but does not send any.
+  bool enable_pmtu_discovery{true};
   tun::PmtuConfig pmtu;
 
   // Reconnection settings.
@@ -98,6 +154,20 @@ struct TunnelConfig {
 
   // Timestamp skew tolerance for handshake.
   std::chrono::milliseconds handshake_skew_tolerance{30000};
+
+  // 0-RTT session resumption (Issue #86).
+  // Client: reconnect with a cached session ticket and send data in the first flight.
+  // Server: issue tickets after each handshake and accept 0-RTT INITs.
+  bool enable_zero_rtt{true};
+
+  // Client: how long to wait for the server to accept a 0-RTT INIT before
+  // dropping the ticket and falling back to a full handshake.
+  std::chrono::milliseconds zero_rtt_timeout{3000};
+
+  // Client: offer forward error correction in the handshake, for links with
+  // random loss (tuned by transport.fec). Resumed 0-RTT sessions cannot carry
+  // it, so the client always performs a full handshake when this is set.
+  bool enable_fec{false};
 };
 
 // Callback types.
@@ -172,9 +242,100 @@ class Tunnel {
   // Handle reconnection logic.
   void handle_reconnect();
 
+  // Lock the data plane (session, send queues, statistics) and hand the
+  // session to the calling thread. Taken by every event loop callback and by
+  // the upstream worker; a no-contention formality without worker threads.
+  std::unique_lock<std::mutex> lock_data_plane();
+
+  // Periodic work shared by the run loops: retransmits, delayed ACKs, session
+  // rotation, 0-RTT fallback, reconnects and diagnostics. Returns how long the
+  // loop may wait before this needs to run again.
+  std::chrono::milliseconds run_maintenance();
+
+  // Read up to a burst of packets queued on the TUN device. Returns true if
+  // more may be waiting.
+  bool drain_tun();
+
+  // How long a loop that waits on the TUN device itself (the Windows loop,
+  // the upstream worker) may sleep before a coalescing, pacing or priority
+  // queue deadline.
+  std::chrono::milliseconds poll_wait() const;
+
+#ifdef _WIN32
+  // Associate the (re)opened UDP socket with udp_event_.
+  void select_udp_event();
+#else
+  // Arm a one-shot event loop timer that runs maintenance and re-arms itself.
+  void schedule_maintenance(std::chrono::milliseconds delay);
+
+  // Register the UDP socket and (once open) the TUN device with the event
+  // loop. Safe to call again after either is reopened.
+  void register_event_sources();
+  void unregister_event_sources();
+
+  // Start the upstream worker once the TUN device is open (worker threads
+  // only); stop it and wait for it to exit.
+  void start_upstream_worker();
+  void stop_upstream_worker();
+
+  // Upstream worker: wait for the TUN device, read a burst without the lock,
+  // then queue, encrypt and send it with the lock held.
+  void run_upstream();
+#endif
+
+  // Send the TUN packets queued in coalescer_ (or, with priority
+  // scheduling, what the congestion window allows from scheduler_); the
+  // session puts a pending ACK in front of the data.
+  void flush_coalesced();
+
+  // Send a standalone ACK if the session has one due (see
+  // TransportSession::take_ack_packet()).
+  void send_pending_ack(bool end_of_burst);
+
+  // Flush if the oldest queued packet has waited long enough; otherwise make
+  // sure a flush is scheduled.
+  void flush_coalesced_if_due();
+
+  // Queue a sealed datagram for the server on transmit_queue_.
+  void queue_datagram(std::vector<std::uint8_t> datagram, bool jitter);
+
+  // Send what transmit_queue_ has due and make sure the rest is scheduled.
+  void service_transmit_queue();
+
+  // Stamp datagrams with departure times if transmit.kernel_pacing is set
+  // and the (re)opened UDP socket supports it.
+  void setup_kernel_pacing();
+
   // Handle MTU change callback (moved out of lambda for clang-tidy).
   void handle_mtu_change(const std::string& peer, int old_mtu, int new_mtu);
 
+  // Restart path MTU discovery for a new connection.
+  void start_pmtu_discovery();
+
+  // Send the path MTU probe that is due, if any.
+  void send_mtu_probe();
+
+  // True while path MTU probes should be sent.
+  bool pmtu_discovery_active() const;
+
+  // Resume with a cached session ticket (Issue #86). On success the 0-RTT INIT
+  // has been sent and session_ is ready for early data; the server's reply is
+  // handled asynchronously by handle_zero_rtt_response().
+  bool try_zero_rtt_resume(std::error_code& ec);
+
+  // Process the server's reply to a pending 0-RTT INIT.
+  // Returns true if the packet was the reply (accept or reject).
+  bool handle_zero_rtt_response(std::span<const std::uint8_t> packet);
+
+  // Drop a pending 0-RTT attempt and its ticket, and reconnect with a full handshake.
+  void abandon_zero_rtt();
+
+  // Store a session ticket received from the server.
+  void handle_session_ticket(std::span<const std::uint8_t> message);
+
+  // Key for this server in the ticket store.
+  std::string server_id() const;
+
   TunnelConfig config_;
   std::function<TimePoint()> now_fn_;
 
@@ -185,7 +346,31 @@ class Tunnel {
   transport::UdpSocket udp_socket_;
   std::unique_ptr<transport::TransportSession> session_;
   std::unique_ptr<transport::EventLoop> event_loop_;
-  mux::AckScheduler ack_scheduler_;
+  // Descriptors currently registered with event_loop_ (-1 if none).
+  int registered_udp_fd_{-1};
+  int registered_tun_fd_{-1};
+  std::vector<std::uint8_t> tun_buffer_;
+#ifdef _WIN32
+  // Signalled when the UDP socket is readable (WSAEventSelect()); the
+  // Windows loop waits on it together with the Wintun read event.
+  void* udp_event_{nullptr};
+#endif
+  transport::PacketCoalescer coalescer_;
+  bool coalesce_timer_armed_{false};
+  transport::TrafficClassifier classifier_;
+  transport::PriorityScheduler scheduler_;
+  transport::TransmitQueue transmit_queue_;
+  bool transmit_timer_armed_{false};
+  // Datagrams given timing jitter so far; selects each one's jitter.
+  std::uint64_t jitter_sequence_{0};
+
+  // Worker threads (see TunnelConfig::enable_worker_threads): whether this
+  // run uses them, the lock both threads take, and the upstream thread with
+  // the buffer it reads TUN bursts into. Only the event loop thread replaces
+  // session_, so it reads the pointer without the lock.
+  bool worker_threads_{false};
+  std::mutex data_mutex_;
+  std::vector<std::uint8_t> upstream_buffer_;
 
   // Crypto.
   crypto::KeyPair key_pair_;
@@ -202,9 +387,24 @@ class Tunnel {
   StateChangeCallback state_change_callback_;
   ErrorCallback error_callback_;
 
+  // Periodic diagnostics.
+  TimePoint last_diagnostic_log_;
+  std::uint64_t last_logged_tx_{0};
+  std::uint64_t last_logged_rx_{0};
+
   // Reconnection.
   int reconnect_attempts_{0};
   TimePoint last_reconnect_attempt_;
+
+  // 0-RTT resumption (Issue #86).
+  handshake::SessionTicketStore ticket_store_;
+  std::unique_ptr<handshake::ZeroRttInitiator> zero_rtt_initiator_;
+  TimePoint zero_rtt_sent_at_;
+  // Client-side keys of the current session, cached alongside tickets it receives.
+  crypto::SessionKeys resumption_keys_{};
+
+  // Last member: destroyed (joined) before anything it uses.
+  utils::DedicatedWorker upstream_worker_{"Tunnel-Upstream"};
 };
 
 }  // namespace veil::tunnel
@@ -155,13 +155,14 @@ TEST_F(DpiResistanceTest, NoMagicBytesInPayload) {
     }
   }
 
-  // Check for common patterns in ciphertext portion (after 8-byte sequence prefix)
-  // Note: First 8 bytes are plaintext sequence number, not encrypted
+  // Check for common patterns in ciphertext portion (after the connection ID and
+  // 8-byte sequence prefix). The connection ID is constant per session by design.
+  constexpr std::size_t kHeader = transport::kConnectionIdSize + 8;
   std::array<std::map<std::uint8_t, int>, 8> byte_freq;
   for (const auto& packet : all_packets) {
-    // Skip the 8-byte sequence prefix, analyze ciphertext bytes
-    for (std::size_t i = 8; i < 16 && i < packet.size(); ++i) {
-      byte_freq[i - 8][packet[i]]++;
+    // Skip the packet header, analyze ciphertext bytes
+    for (std::size_t i = kHeader; i < kHeader + 8 && i < packet.size(); ++i) {
+      byte_freq[i - kHeader][packet[i]]++;
     }
   }
 
@@ -187,9 +188,10 @@ TEST_F(DpiResistanceTest, RandomizedCiphertextAppearance) {
     std::vector<std::uint8_t> plaintext(100);
     auto packets = session_->encrypt_data(plaintext);
     for (const auto& packet : packets) {
-      // Skip 8-byte sequence prefix, collect ciphertext bytes
-      if (packet.size() > 8) {
-        for (std::size_t j = 8; j < packet.size(); ++j) {
+      // Skip connection ID and sequence prefix, collect ciphertext bytes
+      constexpr std::size_t kHeader = transport::kConnectionIdSize + 8;
+      if (packet.size() > kHeader) {
+        for (std::size_t j = kHeader; j < packet.size(); ++j) {
           ciphertext_bytes.push_back(packet[j]);
         }
       }
@@ -109,8 +109,10 @@ TEST_F(TransportIntegrationTest, LoopbackDataTransfer) {
   for (const auto& pkt : response_packets) {
     auto decrypted = client_session.decrypt_packet(pkt);
     ASSERT_TRUE(decrypted.has_value());
-    ASSERT_EQ(decrypted->size(), 1U);
+    // The server's ACK for the request rides on the response.
+    ASSERT_EQ(decrypted->size(), 2U);
     EXPECT_EQ((*decrypted)[0].data.payload, response);
+    EXPECT_EQ((*decrypted)[1].kind, mux::FrameKind::kAck);
   }
 }
 
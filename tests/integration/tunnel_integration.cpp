@@ -14,17 +14,36 @@
 
 #include <gtest/gtest.h>
 
+#ifdef __linux__
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <cstdint>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
 #include <thread>
 #include <vector>
 
 #include "common/handshake/handshake_processor.h"
+#include "common/handshake/session_ticket.h"
 #include "common/logging/logger.h"
 #include "common/utils/rate_limiter.h"
+#include "transport/mux/mux_codec.h"
 #include "transport/session/transport_session.h"
+#include "transport/sim/network_simulator.h"
 #include "transport/udp_socket/udp_socket.h"
+#include "tunnel/tunnel.h"
 
 namespace veil::integration_tests {
 
@@ -405,4 +424,408 @@ TEST_F(TunnelIntegrationTest, SessionRotationDuringTraffic) {
   EXPECT_EQ(client_session.stats().session_rotations, 1U);
 }
 
+/**
+ * Reconnect latency with and without 0-RTT resumption (Issue #86).
+ *
+ * Client and server talk over simulated links with a fixed one-way delay, on
+ * a virtual clock that is also advanced by the real CPU time spent in the
+ * handshake code (X25519 + HKDF). Latency is measured from the start of the
+ * reconnect until the server has decrypted the client's first IP packet.
+ */
+class ZeroRttReconnectTest : public ::testing::Test {
+ protected:
+  static constexpr auto kOneWayDelay = 40ms;
+
+  void SetUp() override {
+    transport::sim::LinkConfig link;
+    link.bandwidth_bps = 0;
+    link.delay = kOneWayDelay;
+    up_ = std::make_unique<transport::sim::SimulatedLink>(link, 1);
+    down_ = std::make_unique<transport::sim::SimulatedLink>(link, 2);
+    wall_start_ = std::chrono::system_clock::now();
+    virtual_start_ = clock_.now();
+    psk_ = std::vector<std::uint8_t>(32, 0xAB);
+    ticket_manager_ = std::make_shared<handshake::SessionTicketManager>(
+        std::chrono::milliseconds(600000), wall_fn());
+  }
+
+  std::function<std::chrono::system_clock::time_point()> wall_fn() {
+    return [this]() { return wall_start_ + (clock_.now() - virtual_start_); };
+  }
+
+  utils::TokenBucket make_bucket() {
+    return utils::TokenBucket(100.0, 1000ms, clock_.now_fn());
+  }
+
+  // Run `work` and charge its real CPU time to the virtual clock.
+  template <typename Fn>
+  auto timed(Fn&& work) {
+    const auto start = std::chrono::steady_clock::now();
+    auto result = work();
+    clock_.advance(std::chrono::steady_clock::now() - start);
+    return result;
+  }
+
+  // Deliver the next datagram on `link`, advancing virtual time to its arrival.
+  // Datagrams sent back to back arrive together; extras are queued in order.
+  std::vector<std::uint8_t> deliver(transport::sim::SimulatedLink& link) {
+    auto& queue = arrived_[&link];
+    if (queue.empty()) {
+      auto arrival = link.next_arrival();
+      EXPECT_TRUE(arrival.has_value());
+      if (!arrival) {
+        return {};
+      }
+      clock_.advance_to(*arrival);
+      for (auto& datagram : link.receive(clock_.now())) {
+        queue.push_back(std::move(datagram));
+      }
+    }
+    auto datagram = std::move(queue.front());
+    queue.pop_front();
+    return datagram;
+  }
+
+  // Full 1-RTT handshake; the server issues a ticket in a control frame.
+  // Returns the client's session ticket (with its own keys cached).
+  std::optional<handshake::SessionTicket> initial_connect() {
+    handshake::HandshakeInitiator initiator(psk_, 1000ms, wall_fn());
+    handshake::HandshakeResponder responder(psk_, 1000ms, make_bucket(), wall_fn());
+    up_->send(initiator.create_init(), clock_.now());
+    auto resp = responder.handle_init(deliver(*up_));
+    EXPECT_TRUE(resp.has_value());
+    if (!resp) {
+      return std::nullopt;
+    }
+    down_->send(resp->response, clock_.now());
+
+    transport::TransportSession server(resp->session, {}, clock_.now_fn());
+    const auto ticket = ticket_manager_->issue_ticket(resp->session.keys);
+    down_->send(server.encrypt_frame(mux::make_control_frame(
+                    static_cast<std::uint8_t>(mux::ControlType::kSessionTicket),
+                    handshake::encode_ticket_message(ticket))),
+                clock_.now());
+
+    auto client_hs = initiator.consume_response(deliver(*down_));
+    EXPECT_TRUE(client_hs.has_value());
+    if (!client_hs) {
+      return std::nullopt;
+    }
+    transport::TransportSession client(*client_hs, {}, clock_.now_fn());
+    auto frames = client.decrypt_packet(deliver(*down_));
+    EXPECT_TRUE(frames.has_value());
+    if (!frames || frames->size() != 1 || (*frames)[0].kind != mux::FrameKind::kControl) {
+      return std::nullopt;
+    }
+    auto client_ticket = handshake::decode_ticket_message((*frames)[0].control.payload, 0);
+    if (client_ticket) {
+      client_ticket->cached_keys = client_hs->keys;
+    }
+    return client_ticket;
+  }
+
+  transport::sim::VirtualClock clock_;
+  std::unique_ptr<transport::sim::SimulatedLink> up_;
+  std::unique_ptr<transport::sim::SimulatedLink> down_;
+  std::chrono::system_clock::time_point wall_start_;
+  transport::sim::VirtualClock::TimePoint virtual_start_;
+  std::vector<std::uint8_t> psk_;
+  std::shared_ptr<handshake::SessionTicketManager> ticket_manager_;
+  std::map<transport::sim::SimulatedLink*, std::deque<std::vector<std::uint8_t>>> arrived_;
+  const std::vector<std::uint8_t> ip_packet_ = std::vector<std::uint8_t>(84, 0x45);
+};
+
+TEST_F(ZeroRttReconnectTest, ResumptionRemovesHandshakeRoundTrip) {
+  auto ticket = initial_connect();
+  ASSERT_TRUE(ticket.has_value());
+
+  // --- Reconnect with a full handshake: INIT -> RESPONSE -> first packet.
+  const auto full_start = clock_.now();
+  {
+    handshake::HandshakeInitiator initiator(psk_, 1000ms, wall_fn());
+    handshake::HandshakeResponder responder(psk_, 1000ms, make_bucket(), wall_fn());
+    up_->send(timed([&] { return initiator.create_init(); }), clock_.now());
+    auto init = deliver(*up_);
+    auto resp = timed([&] { return responder.handle_init(init); });
+    ASSERT_TRUE(resp.has_value());
+    down_->send(resp->response, clock_.now());
+    auto response = deliver(*down_);
+    auto client_hs = timed([&] { return initiator.consume_response(response); });
+    ASSERT_TRUE(client_hs.has_value());
+
+    transport::TransportSession client(*client_hs, {}, clock_.now_fn());
+    transport::TransportSession server(resp->session, {}, clock_.now_fn());
+    for (auto& pkt : client.encrypt_data(ip_packet_)) {
+      up_->send(std::move(pkt), clock_.now());
+    }
+    auto frames = server.decrypt_packet(deliver(*up_));
+    ASSERT_TRUE(frames.has_value());
+    ASSERT_EQ((*frames)[0].data.payload, ip_packet_);
+  }
+  const auto full_latency = clock_.now() - full_start;
+
+  // --- Reconnect with 0-RTT: INIT and early data in the same flight.
+  const auto resume_start = clock_.now();
+  {
+    handshake::ZeroRttInitiator initiator(psk_, *ticket, wall_fn());
+    handshake::ZeroRttResponder responder(psk_, ticket_manager_, 1000ms, make_bucket(), wall_fn());
+    up_->send(timed([&] { return initiator.create_zero_rtt_init(); }), clock_.now());
+
+    handshake::HandshakeSession early{.session_id = 0,
+                                      .keys = initiator.early_keys(),
+                                      .initiator_ephemeral = {},
+                                      .responder_ephemeral = {},
+                                      .client_id = {}};
+    transport::TransportSession client(early, {}, clock_.now_fn());
+    for (auto& pkt : client.encrypt_data(ip_packet_)) {
+      up_->send(std::move(pkt), clock_.now());
+    }
+
+    auto init = deliver(*up_);
+    auto result = timed([&] { return responder.handle_zero_rtt_init(init); });
+    ASSERT_TRUE(result.has_value());
+    ASSERT_TRUE(result->accepted);
+    down_->send(result->response, clock_.now());
+
+    transport::TransportSession server(result->session, {}, clock_.now_fn());
+    auto frames = server.decrypt_packet(deliver(*up_));
+    ASSERT_TRUE(frames.has_value()) << "early data must decrypt under the resumed keys";
+    ASSERT_EQ((*frames)[0].data.payload, ip_packet_);
+
+    // The accept still reaches the client and confirms the same session.
+    auto client_hs = initiator.consume_zero_rtt_response(deliver(*down_));
+    ASSERT_TRUE(client_hs.has_value());
+    EXPECT_EQ(client_hs->session_id, result->session.session_id);
+  }
+  const auto resume_latency = clock_.now() - resume_start - kOneWayDelay;  // exclude the accept's trip
+
+  const auto to_ms = [](auto d) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(d).count()) / 1000.0;
+  };
+  RecordProperty("full_reconnect_ms", std::to_string(to_ms(full_latency)));
+  RecordProperty("zero_rtt_reconnect_ms", std::to_string(to_ms(resume_latency)));
+
+  // Full: three one-way trips plus DH. 0-RTT: a single one-way trip.
+  EXPECT_GE(full_latency, 3 * kOneWayDelay);
+  EXPECT_GE(resume_latency, kOneWayDelay);
+  EXPECT_LT(resume_latency, kOneWayDelay + 10ms);
+  EXPECT_LE(resume_latency + 2 * kOneWayDelay, full_latency);
+}
+
+TEST_F(ZeroRttReconnectTest, RejectedTicketFallsBackToFullHandshake) {
+  auto ticket = initial_connect();
+  ASSERT_TRUE(ticket.has_value());
+
+  // A restarted server with a fresh ticket key cannot read the ticket.
+  auto restarted = std::make_shared<handshake::SessionTicketManager>(
+      std::chrono::milliseconds(600000), wall_fn());
+  handshake::ZeroRttInitiator initiator(psk_, *ticket, wall_fn());
+  handshake::ZeroRttResponder responder(psk_, restarted, 1000ms, make_bucket(), wall_fn());
+
+  up_->send(initiator.create_zero_rtt_init(), clock_.now());
+  auto result = responder.handle_zero_rtt_init(deliver(*up_));
+  ASSERT_TRUE(result.has_value());
+  EXPECT_FALSE(result->accepted);
+  down_->send(result->response, clock_.now());
+
+  EXPECT_FALSE(initiator.consume_zero_rtt_response(deliver(*down_)).has_value());
+  EXPECT_TRUE(initiator.was_rejected());
+
+  // The full handshake still works against the restarted server.
+  handshake::HandshakeInitiator full(psk_, 1000ms, wall_fn());
+  handshake::HandshakeResponder full_responder(psk_, 1000ms, make_bucket(), wall_fn());
+  up_->send(full.create_init(), clock_.now());
+  auto resp = full_responder.handle_init(deliver(*up_));
+  ASSERT_TRUE(resp.has_value());
+  down_->send(resp->response, clock_.now());
+  EXPECT_TRUE(full.consume_response(deliver(*down_)).has_value());
+}
+
+#ifdef __linux__
+/**
+ * Threaded client data plane (TunnelConfig::enable_worker_threads).
+ *
+ * Runs a real Tunnel against an in-process echo server: the server sends
+ * every IPv4 packet it receives back with source and destination swapped, so
+ * each datagram an application sends into the TUN device crosses the
+ * upstream worker on the way out and the event loop thread on the way back.
+ * Needs root for the TUN device.
+ */
+class TunnelWorkerThreadsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (::geteuid() != 0 || ::access("/dev/net/tun", R_OK | W_OK) != 0) {
+      GTEST_SKIP() << "needs root and /dev/net/tun";
+    }
+    std::error_code ec;
+    ASSERT_TRUE(server_socket_.open(0, false, ec)) << ec.message();
+    server_ = std::thread([this] { serve(); });
+  }
+
+  void TearDown() override {
+    stop_server_ = true;
+    if (server_.joinable()) {
+      server_.join();
+    }
+  }
+
+  // Swap the IPv4 addresses and the UDP/TCP ports; both checksums stay valid.
+  static void swap_endpoints(std::vector<std::uint8_t>& packet) {
+    if (packet.size() < 24 || (packet[0] >> 4) != 4) {
+      return;
+    }
+    std::swap_ranges(packet.begin() + 12, packet.begin() + 16, packet.begin() + 16);
+    const std::size_t ihl = static_cast<std::size_t>(packet[0] & 0x0F) * 4;
+    if (packet.size() >= ihl + 4) {
+      const auto ports = packet.begin() + static_cast<std::ptrdiff_t>(ihl);
+      std::swap_ranges(ports, ports + 2, ports + 2);
+    }
+  }
+
+  void serve() {
+    handshake::HandshakeResponder responder(psk_, 30000ms, utils::TokenBucket(100.0, 1000ms));
+    std::unique_ptr<transport::TransportSession> session;
+    transport::UdpEndpoint client;
+    std::error_code ec;
+    while (!stop_server_) {
+      server_socket_.poll(
+          [&](const transport::UdpPacket& pkt) {
+            if (!session) {
+              if (auto resp = responder.handle_init(pkt.data)) {
+                std::error_code send_ec;
+                server_socket_.send(resp->response, pkt.remote, send_ec);
+                session = std::make_unique<transport::TransportSession>(resp->session);
+                client = pkt.remote;
+              }
+              return;
+            }
+            auto frames = session->decrypt_packet(pkt.data);
+            if (!frames) {
+              return;
+            }
+            for (auto& frame : *frames) {
+              if (frame.kind == mux::FrameKind::kAck) {
+                session->process_ack(frame.ack);
+              } else if (frame.kind == mux::FrameKind::kData && !frame.data.payload.empty()) {
+                auto packet = frame.data.payload;
+                swap_endpoints(packet);
+                for (auto& datagram : session->encrypt_data(packet)) {
+                  std::error_code send_ec;
+                  server_socket_.send(datagram, client, send_ec);
+                }
+              }
+            }
+          },
+          1, ec);
+      if (!session) {
+        continue;
+      }
+      std::error_code send_ec;
+      if (auto ack = session->take_ack_packet(true)) {
+        server_socket_.send(*ack, client, send_ec);
+      }
+      for (auto& retransmit : session->get_retransmit_packets()) {
+        server_socket_.send(retransmit, client, send_ec);
+      }
+    }
+  }
+
+  std::vector<std::uint8_t> psk_ = std::vector<std::uint8_t>(32, 0x42);
+  transport::UdpSocket server_socket_;
+  std::atomic<bool> stop_server_{false};
+  std::thread server_;
+};
+
+TEST_F(TunnelWorkerThreadsTest, EchoesTrafficBothWaysAndStopsCleanly) {
+  tunnel::TunnelConfig config;
+  config.tun.device_name = "veilwt0";
+  config.tun.ip_address = "10.231.0.1";
+  config.tun.mtu = 1400;
+  config.server_address = "127.0.0.1";
+  config.server_port = server_socket_.local_port();
+  config.psk = psk_;
+  config.enable_zero_rtt = false;
+  config.enable_pmtu_discovery = false;
+  config.auto_reconnect = false;
+  config.enable_worker_threads = true;
+
+  // initialize() and run() must share a thread: the event loop belongs to it.
+  tunnel::Tunnel tunnel(config);
+  std::atomic<bool> init_failed{false};
+  std::atomic<bool> finished{false};
+  std::thread runner([&] {
+    std::error_code ec;
+    if (tunnel.initialize(ec)) {
+      tunnel.run();
+    } else {
+      init_failed = true;
+    }
+    finished = true;
+  });
+
+  const auto deadline = std::chrono::steady_clock::now() + 5s;
+  while (tunnel.state() != tunnel::ConnectionState::kConnected && !init_failed &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  if (tunnel.state() != tunnel::ConnectionState::kConnected) {
+    tunnel.stop();
+    runner.join();
+    FAIL() << "tunnel did not connect (initialize failed: " << init_failed.load() << ")";
+  }
+
+  // An application socket on the tunnel address, talking to the far side.
+  const int app = ::socket(AF_INET, SOCK_DGRAM, 0);
+  ASSERT_GE(app, 0);
+  sockaddr_in local{};
+  local.sin_family = AF_INET;
+  ::inet_pton(AF_INET, "10.231.0.1", &local.sin_addr);
+  ASSERT_EQ(::bind(app, reinterpret_cast<sockaddr*>(&local), sizeof(local)), 0);
+  timeval timeout{0, 100000};
+  ::setsockopt(app, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  constexpr std::uint32_t kDatagrams = 300;
+  std::set<std::uint32_t> echoed;
+  std::thread receiver([&] {
+    std::array<std::uint8_t, 2048> buffer{};
+    const auto until = std::chrono::steady_clock::now() + 10s;
+    while (echoed.size() < kDatagrams && std::chrono::steady_clock::now() < until) {
+      const auto n = ::recv(app, buffer.data(), buffer.size(), 0);
+      if (n >= 4) {
+        std::uint32_t index = 0;
+        std::memcpy(&index, buffer.data(), sizeof(index));
+        echoed.insert(index);
+      }
+    }
+  });
+
+  sockaddr_in remote{};
+  remote.sin_family = AF_INET;
+  remote.sin_port = htons(9000);
+  ::inet_pton(AF_INET, "10.231.0.2", &remote.sin_addr);
+  std::vector<std::uint8_t> payload(1000, 0x5A);
+  for (std::uint32_t i = 0; i < kDatagrams; ++i) {
+    std::memcpy(payload.data(), &i, sizeof(i));
+    ::sendto(app, payload.data(), payload.size(), 0, reinterpret_cast<sockaddr*>(&remote), sizeof(remote));
+    std::this_thread::sleep_for(1ms);
+  }
+  receiver.join();
+  ::close(app);
+
+  EXPECT_EQ(echoed.size(), kDatagrams);
+
+  // stop() ends both the event loop and the upstream worker.
+  tunnel.stop();
+  const auto stop_deadline = std::chrono::steady_clock::now() + 2s;
+  while (!finished && std::chrono::steady_clock::now() < stop_deadline) {
+    std::this_thread::sleep_for(10ms);
+  }
+  EXPECT_TRUE(finished.load()) << "run() did not return after stop()";
+  runner.join();
+  EXPECT_FALSE(tunnel.is_running());
+  EXPECT_GE(tunnel.stats().tun_packets_received, kDatagrams);
+  EXPECT_GE(tunnel.stats().tun_packets_sent, kDatagrams);
+}
+#endif  // __linux__
+
 }  // namespace veil::integration_tests
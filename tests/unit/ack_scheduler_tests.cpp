@@ -2,6 +2,7 @@
 
 #include <chrono>
 #include <cstdint>
+#include <vector>
 
 #include "transport/mux/ack_scheduler.h"
 
@@ -184,4 +185,86 @@ TEST_F(AckSchedulerTest, DelayedAckStats) {
   EXPECT_EQ(scheduler.stats().acks_immediate, 1U);
 }
 
+TEST_F(AckSchedulerTest, AckFrequencyRaisesThresholdAndDelay) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+  scheduler.set_ack_frequency(AckFrequency{.packet_threshold = 10, .max_ack_delay = 5ms});
+  EXPECT_EQ(scheduler.config().ack_every_n_packets, 10U);
+  EXPECT_EQ(scheduler.config().max_pending_acks, 10U);
+  EXPECT_EQ(scheduler.config().max_ack_delay, 5ms);
+
+  for (std::uint64_t seq = 1; seq < 10; ++seq) {
+    EXPECT_FALSE(scheduler.on_packet_received(0, seq, false)) << seq;
+  }
+  EXPECT_TRUE(scheduler.on_packet_received(0, 10, false));
+  EXPECT_EQ(scheduler.time_until_next_ack(), 5ms);
+}
+
+TEST_F(AckSchedulerTest, AckFrequencyKeepsImmediateAckOnGap) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+  scheduler.set_ack_frequency(AckFrequency{.packet_threshold = 16, .max_ack_delay = 25ms});
+
+  EXPECT_FALSE(scheduler.on_packet_received(0, 1, false));
+  EXPECT_TRUE(scheduler.on_packet_received(0, 3, false));
+}
+
+TEST_F(AckSchedulerTest, AckFrequencyAcksRetransmissionAtOnce) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+  scheduler.set_ack_frequency(AckFrequency{.packet_threshold = 16, .max_ack_delay = 25ms});
+
+  EXPECT_FALSE(scheduler.on_packet_received(0, 1, false));
+  EXPECT_TRUE(scheduler.on_packet_received(0, 3, false));
+  scheduler.ack_sent(0);
+
+  // The retransmission filling the gap is reported without waiting.
+  EXPECT_TRUE(scheduler.on_packet_received(0, 2, false));
+}
+
+TEST_F(AckSchedulerTest, AckFrequencyIsClamped) {
+  AckScheduler scheduler(config_, [this]() { return now_; });
+  scheduler.set_ack_frequency(AckFrequency{.packet_threshold = 0, .max_ack_delay = 100us});
+  EXPECT_EQ(scheduler.config().ack_every_n_packets, 1U);
+  EXPECT_EQ(scheduler.config().max_pending_acks, config_.max_pending_acks);
+  EXPECT_EQ(scheduler.config().max_ack_delay, 1ms);
+
+  scheduler.set_ack_frequency(AckFrequency{.packet_threshold = 1000, .max_ack_delay = 20ms});
+  EXPECT_EQ(scheduler.config().ack_every_n_packets, 32U);
+}
+
+TEST(AckFrequencyTest, EncodeDecodeRoundTrip) {
+  const AckFrequency frequency{.packet_threshold = 300, .max_ack_delay = 12'345us};
+  const auto payload = encode_ack_frequency(frequency);
+  ASSERT_EQ(payload.size(), kAckFrequencySize);
+  EXPECT_EQ(decode_ack_frequency(payload), frequency);
+
+  EXPECT_FALSE(decode_ack_frequency(std::vector<std::uint8_t>(kAckFrequencySize - 1, 0)).has_value());
+}
+
+TEST(AckFrequencyTest, ThresholdFollowsWindowInCongestionAvoidance) {
+  const AckFrequencyConfig config;
+  const std::size_t mss = 1400;
+
+  // 64 packets in flight, 8 ACKs per window.
+  auto frequency = choose_ack_frequency(config, 64 * mss, mss, 40ms, CongestionState::kCongestionAvoidance);
+  EXPECT_EQ(frequency.packet_threshold, 8U);
+  EXPECT_EQ(frequency.max_ack_delay, 10ms);
+
+  frequency = choose_ack_frequency(config, 1000 * mss, mss, 400ms, CongestionState::kCongestionAvoidance);
+  EXPECT_EQ(frequency.packet_threshold, config.max_packet_threshold);
+  EXPECT_EQ(frequency.max_ack_delay, config.max_ack_delay);
+
+  frequency = choose_ack_frequency(config, 4 * mss, mss, 1ms, CongestionState::kCongestionAvoidance);
+  EXPECT_EQ(frequency.packet_threshold, config.min_packet_threshold);
+  EXPECT_EQ(frequency.max_ack_delay, config.min_ack_delay);
+}
+
+TEST(AckFrequencyTest, SlowStartAndRecoveryUseMinimumThreshold) {
+  const AckFrequencyConfig config;
+  const std::size_t mss = 1400;
+  for (auto state : {CongestionState::kSlowStart, CongestionState::kFastRecovery}) {
+    const auto frequency = choose_ack_frequency(config, 1000 * mss, mss, 40ms, state);
+    EXPECT_EQ(frequency.packet_threshold, config.min_packet_threshold);
+    EXPECT_EQ(frequency.max_ack_delay, 10ms);
+  }
+}
+
 }  // namespace veil::mux::tests
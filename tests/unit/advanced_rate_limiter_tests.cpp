@@ -109,6 +109,25 @@ TEST_F(AdvancedRateLimiterTest, ClientRateLimiter_TracksStats) {
   EXPECT_EQ(limiter.stats().packets_allowed, 2u);
 }
 
+TEST_F(AdvancedRateLimiterTest, ClientRateLimiter_WouldAllowDoesNotConsume) {
+  RateLimiterConfig config;
+  config.bandwidth_bytes_per_sec = 1000;
+  config.packets_per_sec = 100;
+  config.burst_allowance_factor = 1.0;
+
+  ClientRateLimiter limiter(config, [this]() { return now(); });
+
+  EXPECT_TRUE(limiter.would_allow(800));
+  EXPECT_TRUE(limiter.would_allow(800));
+  EXPECT_TRUE(limiter.allow_packet(800, TrafficPriority::kNormal));
+
+  // Over budget: held back, but no violation or penalty.
+  EXPECT_FALSE(limiter.would_allow(800));
+  EXPECT_EQ(limiter.stats().violations, 0u);
+  advance_time(std::chrono::milliseconds(700));
+  EXPECT_TRUE(limiter.would_allow(800));
+}
+
 TEST_F(AdvancedRateLimiterTest, ClientRateLimiter_ReconnectLimit) {
   RateLimiterConfig config;
   config.max_reconnects_per_minute = 3;
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "server/allowed_ips.h"
+
+namespace veil::server::test {
+
+namespace {
+
+IpPrefix prefix(const std::string& text) {
+  auto parsed = IpPrefix::parse(text);
+  EXPECT_TRUE(parsed.has_value()) << text;
+  return parsed.value_or(IpPrefix{});
+}
+
+// Session routing an address given as text, or 0 if none.
+std::uint64_t lookup(const AllowedIps& table, const std::string& address) {
+  const auto host = prefix(address);
+  const std::size_t size = host.family == IpFamily::kV4 ? 4 : 16;
+  return table.lookup(host.family, std::span<const std::uint8_t>(host.address.data(), size)).value_or(0);
+}
+
+}  // namespace
+
+TEST(AllowedIpsTest, ParseClearsHostBits) {
+  EXPECT_EQ(prefix("10.1.2.3/16").to_string(), "10.1.0.0/16");
+  EXPECT_EQ(prefix("10.1.2.3").to_string(), "10.1.2.3/32");
+  EXPECT_EQ(prefix("10.1.2.3/0").to_string(), "0.0.0.0/0");
+  EXPECT_EQ(prefix("fd00:10::5/64").to_string(), "fd00:10::/64");
+  EXPECT_EQ(prefix("fd00:10:ab:cd::1/57").to_string(), "fd00:10:ab:80::/57");
+  EXPECT_EQ(prefix("::1").length, 128);
+
+  EXPECT_FALSE(IpPrefix::parse("10.1.2.3/33").has_value());
+  EXPECT_FALSE(IpPrefix::parse("fd00::/129").has_value());
+  EXPECT_FALSE(IpPrefix::parse("10.1.2.3/").has_value());
+  EXPECT_FALSE(IpPrefix::parse("10.1.2.3/8x").has_value());
+  EXPECT_FALSE(IpPrefix::parse("10.1.2").has_value());
+  EXPECT_FALSE(IpPrefix::parse("").has_value());
+}
+
+TEST(AllowedIpsTest, LongestPrefixWins) {
+  AllowedIps table;
+  table.insert(prefix("10.1.2.0/24"), 3);
+  table.insert(prefix("10.0.0.0/8"), 1);
+  table.insert(prefix("10.1.2.3/32"), 4);
+  table.insert(prefix("10.1.0.0/16"), 2);
+  EXPECT_EQ(table.size(), 4U);
+
+  EXPECT_EQ(lookup(table, "10.1.2.3"), 4U);
+  EXPECT_EQ(lookup(table, "10.1.2.4"), 3U);
+  EXPECT_EQ(lookup(table, "10.1.3.4"), 2U);
+  EXPECT_EQ(lookup(table, "10.200.0.1"), 1U);
+  EXPECT_EQ(lookup(table, "11.0.0.1"), 0U);
+
+  // A default route catches everything else.
+  table.insert(prefix("0.0.0.0/0"), 5);
+  EXPECT_EQ(lookup(table, "11.0.0.1"), 5U);
+  EXPECT_EQ(lookup(table, "10.1.2.3"), 4U);
+
+  // Inserting an existing prefix moves it to the new session.
+  table.insert(prefix("10.1.0.0/16"), 6);
+  EXPECT_EQ(table.size(), 5U);
+  EXPECT_EQ(lookup(table, "10.1.3.4"), 6U);
+  EXPECT_TRUE(table.prefixes_of(2).empty());
+  EXPECT_EQ(table.prefixes_of(6), std::vector<IpPrefix>{prefix("10.1.0.0/16")});
+
+  EXPECT_THROW(table.insert(prefix("10.2.0.0/16"), 0), std::invalid_argument);
+}
+
+TEST(AllowedIpsTest, Ipv6RoutesAreSeparateFromIpv4) {
+  AllowedIps table;
+  table.insert(prefix("fd00::/8"), 1);
+  table.insert(prefix("fd00:10::/64"), 2);
+  table.insert(prefix("fd00:10::5/128"), 3);
+  table.insert(prefix("fd00:10:0:0:8000::/65"), 4);
+  table.insert(prefix("10.0.0.0/8"), 5);
+
+  EXPECT_EQ(lookup(table, "fd00:10::5"), 3U);
+  EXPECT_EQ(lookup(table, "fd00:10::6"), 2U);
+  EXPECT_EQ(lookup(table, "fd00:10::8000:0:0:1"), 4U);
+  EXPECT_EQ(lookup(table, "fd00:20::1"), 1U);
+  EXPECT_EQ(lookup(table, "fe80::1"), 0U);
+  // ::a00:1 shares its bits with 10.0.0.1 but is an IPv6 address.
+  EXPECT_EQ(lookup(table, "::a00:1"), 0U);
+  EXPECT_EQ(lookup(table, "10.0.0.1"), 5U);
+
+  // Lookups with the wrong address size find nothing.
+  const std::array<std::uint8_t, 4> v4{10, 0, 0, 1};
+  EXPECT_FALSE(table.lookup(IpFamily::kV6, v4).has_value());
+}
+
+TEST(AllowedIpsTest, RemoveFallsBackToShorterPrefix) {
+  AllowedIps table;
+  table.insert(prefix("10.0.0.0/8"), 1);
+  table.insert(prefix("10.1.0.0/16"), 2);
+  table.insert(prefix("10.1.2.0/24"), 2);
+  table.insert(prefix("10.2.0.0/16"), 3);
+
+  EXPECT_FALSE(table.remove(prefix("10.3.0.0/16")));
+  EXPECT_TRUE(table.remove(prefix("10.1.0.0/16")));
+  EXPECT_FALSE(table.remove(prefix("10.1.0.0/16")));
+  EXPECT_EQ(lookup(table, "10.1.3.1"), 1U);
+  EXPECT_EQ(lookup(table, "10.1.2.1"), 2U);
+
+  table.remove_session(2);
+  EXPECT_EQ(lookup(table, "10.1.2.1"), 1U);
+  EXPECT_TRUE(table.prefixes_of(2).empty());
+  EXPECT_EQ(table.size(), 2U);
+
+  EXPECT_TRUE(table.remove(prefix("10.0.0.0/8")));
+  EXPECT_EQ(lookup(table, "10.1.2.1"), 0U);
+  EXPECT_EQ(lookup(table, "10.2.0.1"), 3U);
+  table.remove_session(3);
+  EXPECT_TRUE(table.empty());
+
+  // The emptied table is fully usable again.
+  table.insert(prefix("10.1.0.0/16"), 4);
+  EXPECT_EQ(lookup(table, "10.1.2.1"), 4U);
+}
+
+TEST(AllowedIpsTest, RoutesPacketsByDestination) {
+  AllowedIps table;
+  table.insert(prefix("10.8.0.2"), 1);
+  table.insert(prefix("192.168.50.0/24"), 1);
+  table.insert(prefix("fd00:8::2"), 2);
+
+  std::vector<std::uint8_t> v4(20, 0);
+  v4[0] = 0x45;
+  v4[12] = 10, v4[13] = 8, v4[14] = 0, v4[15] = 1;
+  v4[16] = 192, v4[17] = 168, v4[18] = 50, v4[19] = 9;
+  const auto v4_addresses = packet_addresses(v4);
+  ASSERT_TRUE(v4_addresses.has_value());
+  EXPECT_EQ(v4_addresses->family, IpFamily::kV4);
+  EXPECT_EQ(table.lookup(IpFamily::kV4, v4_addresses->source), std::nullopt);
+  EXPECT_EQ(table.route(v4), 1U);
+
+  std::vector<std::uint8_t> v6(40, 0);
+  v6[0] = 0x60;
+  const auto destination = prefix("fd00:8::2");
+  std::copy(destination.address.begin(), destination.address.end(), v6.begin() + 24);
+  EXPECT_EQ(table.route(v6), 2U);
+
+  // Truncated or non-IP packets have no route.
+  v4.resize(19);
+  EXPECT_FALSE(table.route(v4).has_value());
+  v6.resize(39);
+  EXPECT_FALSE(table.route(v6).has_value());
+  EXPECT_FALSE(packet_addresses(std::vector<std::uint8_t>(40, 0x10)).has_value());
+}
+
+// 100k random routes against a reference longest-prefix match.
+TEST(AllowedIpsTest, LargeTableFindsLongestMatch) {
+  constexpr std::size_t kRoutes = 100000;
+  std::mt19937_64 rng(44);
+  AllowedIps table;
+  // Expected owner of each prefix; a later insert of the same prefix wins.
+  std::map<std::tuple<IpFamily, std::array<std::uint8_t, 16>, std::uint8_t>, std::uint64_t> expected;
+
+  const auto random_prefix = [&rng]() {
+    const bool v6 = rng() % 4 == 0;
+    std::array<std::uint8_t, 16> address{};
+    // Share the top bits so the tries have deep common paths.
+    address[0] = v6 ? 0xFD : 10;
+    for (std::size_t i = 1; i < (v6 ? 16U : 4U); ++i) {
+      address[i] = static_cast<std::uint8_t>(rng());
+    }
+    const auto min_length = v6 ? 16U : 8U;
+    const auto max_length = v6 ? 128U : 32U;
+    const auto length = min_length + static_cast<unsigned>(rng() % (max_length - min_length + 1));
+    const auto text = IpPrefix::host(std::span<const std::uint8_t>(address.data(), v6 ? 16 : 4))->to_string();
+    return *IpPrefix::parse(text.substr(0, text.find('/')) + "/" + std::to_string(length));
+  };
+
+  std::vector<IpPrefix> inserted;
+  for (std::size_t i = 0; i < kRoutes; ++i) {
+    const auto route = random_prefix();
+    const std::uint64_t session_id = 1 + rng() % 5000;
+    table.insert(route, session_id);
+    expected[{route.family, route.address, route.length}] = session_id;
+    inserted.push_back(route);
+  }
+  EXPECT_EQ(table.size(), expected.size());
+
+  // Reference: try every prefix length of the address, longest first.
+  const auto reference_lookup = [&expected](IpFamily family, std::array<std::uint8_t, 16> address) {
+    for (int length = family == IpFamily::kV4 ? 32 : 128; length >= 0; --length) {
+      if (length % 8 != 0) {
+        address[static_cast<std::size_t>(length / 8)] &= static_cast<std::uint8_t>(0xFF00U >> (length % 8));
+      } else if (length < 128) {
+        address[static_cast<std::size_t>(length / 8)] = 0;
+      }
+      auto it = expected.find({family, address, static_cast<std::uint8_t>(length)});
+      if (it != expected.end()) {
+        return it->second;
+      }
+    }
+    return std::uint64_t{0};
+  };
+
+  const auto check = [&](std::size_t samples) {
+    for (std::size_t i = 0; i < samples; ++i) {
+      auto probe = random_prefix();
+      if (i % 2 == 0) {
+        // Random host bits under an inserted route.
+        probe = inserted[rng() % inserted.size()];
+        const std::size_t size = probe.family == IpFamily::kV4 ? 4 : 16;
+        for (std::size_t byte = probe.length / 8U; byte < size; ++byte) {
+          const unsigned host_bits = byte == probe.length / 8U ? 0xFFU >> (probe.length % 8U) : 0xFFU;
+          probe.address[byte] = static_cast<std::uint8_t>(probe.address[byte] | (rng() & host_bits));
+        }
+      }
+      const std::size_t size = probe.family == IpFamily::kV4 ? 4 : 16;
+      const auto found = table.lookup(probe.family, std::span<const std::uint8_t>(probe.address.data(), size));
+      ASSERT_EQ(found.value_or(0), reference_lookup(probe.family, probe.address)) << probe.to_string();
+    }
+  };
+  check(2000);
+
+  // Remove half the routes and check again.
+  for (std::size_t i = 0; i < inserted.size(); i += 2) {
+    if (expected.erase({inserted[i].family, inserted[i].address, inserted[i].length}) > 0) {
+      EXPECT_TRUE(table.remove(inserted[i]));
+    }
+  }
+  EXPECT_EQ(table.size(), expected.size());
+  check(2000);
+}
+
+}  // namespace veil::server::test
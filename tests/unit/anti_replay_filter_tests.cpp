@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "common/handshake/anti_replay_filter.h"
+
+namespace veil::tests {
+
+using handshake::AntiReplayFilter;
+
+namespace {
+
+std::array<std::uint8_t, 16> make_item(std::uint64_t value) {
+  std::array<std::uint8_t, 16> item{};
+  for (std::size_t i = 0; i < 8; ++i) {
+    item[i] = static_cast<std::uint8_t>((value >> (8 * i)) & 0xFF);
+  }
+  item[15] = 0x5A;
+  return item;
+}
+
+constexpr std::uint64_t kStartMs = 1'700'000'000'000ULL;
+
+}  // namespace
+
+TEST(AntiReplayFilterTests, RejectsNonPositiveWindow) {
+  EXPECT_THROW(AntiReplayFilter(std::chrono::milliseconds(0)), std::invalid_argument);
+}
+
+TEST(AntiReplayFilterTests, DetectsReplay) {
+  AntiReplayFilter filter(std::chrono::seconds(10));
+  const auto item = make_item(1);
+
+  EXPECT_FALSE(filter.check_and_insert(item, kStartMs));
+  EXPECT_TRUE(filter.check_and_insert(item, kStartMs));
+  EXPECT_TRUE(filter.check_and_insert(item, kStartMs + 100));
+}
+
+TEST(AntiReplayFilterTests, DifferentItemsAreNotReplays) {
+  AntiReplayFilter filter(std::chrono::seconds(10));
+
+  EXPECT_FALSE(filter.check_and_insert(make_item(1), kStartMs));
+  EXPECT_FALSE(filter.check_and_insert(make_item(2), kStartMs));
+  EXPECT_FALSE(filter.check_and_insert(make_item(3), kStartMs));
+}
+
+TEST(AntiReplayFilterTests, RememberedForAtLeastOneWindow) {
+  AntiReplayFilter filter(std::chrono::seconds(10));
+  const auto item = make_item(7);
+
+  // Insert at the very end of a bucket so the next bucket starts immediately.
+  const std::uint64_t bucket_end = (kStartMs / 10'000 + 1) * 10'000 - 1;
+  EXPECT_FALSE(filter.check_and_insert(item, bucket_end));
+  EXPECT_TRUE(filter.check_and_insert(item, bucket_end + 10'000));
+}
+
+TEST(AntiReplayFilterTests, ForgottenAfterTwoWindows) {
+  AntiReplayFilter filter(std::chrono::seconds(10));
+  const auto item = make_item(9);
+
+  EXPECT_FALSE(filter.check_and_insert(item, kStartMs));
+  filter.rotate(kStartMs + 20'001);
+  EXPECT_FALSE(filter.check_and_insert(item, kStartMs + 20'001));
+}
+
+TEST(AntiReplayFilterTests, ClockSteppingBackKeepsState) {
+  AntiReplayFilter filter(std::chrono::seconds(10));
+  const auto item = make_item(11);
+
+  EXPECT_FALSE(filter.check_and_insert(item, kStartMs + 30'000));
+  EXPECT_TRUE(filter.check_and_insert(item, kStartMs));
+}
+
+TEST(AntiReplayFilterTests, FalsePositiveRateIsLowAtExpectedLoad) {
+  constexpr std::size_t kExpected = 10'000;
+  AntiReplayFilter filter(std::chrono::seconds(60), kExpected);
+
+  // Fresh items can collide too while the filter fills up; count those as
+  // false positives instead of requiring none.
+  std::size_t false_positives = 0;
+  for (std::uint64_t i = 0; i < kExpected; ++i) {
+    if (filter.check_and_insert(make_item(i), kStartMs)) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LE(false_positives, kExpected / 1000);
+
+  false_positives = 0;
+  constexpr std::uint64_t kProbes = 1'000;
+  for (std::uint64_t i = 0; i < kProbes; ++i) {
+    if (filter.check_and_insert(make_item(kExpected + i), kStartMs)) {
+      ++false_positives;
+    }
+  }
+  // Designed for ~1e-4 at this load; allow generous slack.
+  EXPECT_LE(false_positives, kProbes / 100);
+}
+
+TEST(AntiReplayFilterTests, ConcurrentInsertsDetectEveryDuplicate) {
+  AntiReplayFilter filter(std::chrono::seconds(60));
+  constexpr int kThreads = 4;
+  constexpr std::uint64_t kItems = 2000;
+  std::atomic<std::uint64_t> fresh{0};
+
+  // Every thread inserts the same item set; each item must be reported new at most once.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&]() {
+      for (std::uint64_t i = 0; i < kItems; ++i) {
+        if (!filter.check_and_insert(make_item(i), kStartMs)) {
+          fresh.fetch_add(1);
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_LE(fresh.load(), kItems);
+  EXPECT_GT(fresh.load(), kItems * 99 / 100);
+}
+
+TEST(AntiReplayFilterTests, MemoryIsFixedBySizingHint) {
+  AntiReplayFilter small(std::chrono::seconds(10), 1024);
+  AntiReplayFilter large(std::chrono::seconds(10), 1 << 20);
+
+  EXPECT_GT(large.memory_bytes(), small.memory_bytes());
+  const auto before = small.memory_bytes();
+  for (std::uint64_t i = 0; i < 5000; ++i) {
+    small.check_and_insert(make_item(i), kStartMs);
+  }
+  EXPECT_EQ(small.memory_bytes(), before);
+}
+
+}  // namespace veil::tests
@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "server/egress_scheduler.h"
+#include "server/session_table.h"
+#include "transport/sim/network_simulator.h"
+
+namespace veil::server::test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+const transport::PacketClass kBulk{transport::TrafficClass::kBulk, transport::kBulkStreamId};
+
+}  // namespace
+
+class EgressSchedulerTest : public ::testing::Test {
+ protected:
+  using Clock = std::chrono::steady_clock;
+  using TimePoint = Clock::time_point;
+
+  void SetUp() override { current_time_ = Clock::now(); }
+
+  std::function<TimePoint()> clock() {
+    return [this]() { return current_time_; };
+  }
+
+  // Session whose sends are limited only by the scheduler. The port seeds its
+  // keys, so each session gets its own connection ID.
+  std::uint64_t add_session(SessionTable& table, std::uint16_t port) {
+    transport::TransportSessionConfig config;
+    config.enable_congestion_control = false;
+    auto transport =
+        std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(port).second, config, clock());
+    auto session_id = table.create_session(transport::UdpEndpoint{"192.168.1.100", port}, std::move(transport));
+    EXPECT_TRUE(session_id.has_value());
+    if (auto* session = table.find_by_id(session_id.value_or(0))) {
+      session->egress.emplace();
+    }
+    return session_id.value_or(0);
+  }
+
+  // Keep a bulk download's queue topped up to about 64 KB.
+  static void top_up(ClientSession& session, EgressScheduler& scheduler) {
+    const std::vector<std::uint8_t> payload(1300, 0xD0);
+    while (session.egress->queued_bytes(transport::TrafficClass::kBulk) < 64 * 1024) {
+      session.egress->enqueue(payload, kBulk);
+    }
+    scheduler.activate(session.session_id);
+  }
+
+  TimePoint current_time_;
+};
+
+TEST_F(EgressSchedulerTest, LightClientsAreServedPromptlyNextToHeavyDownload) {
+  SessionTable table(64, 300s, "10.8.0.2", "10.8.0.100", clock());
+  const auto heavy_id = add_session(table, 20000);
+  std::vector<std::uint64_t> light_ids;
+  for (std::uint16_t i = 0; i < 50; ++i) {
+    light_ids.push_back(add_session(table, static_cast<std::uint16_t>(20001 + i)));
+  }
+
+  // A 100 Mbps uplink serviced every millisecond.
+  EgressSchedulerConfig config;
+  config.max_bytes_per_service = 12500;
+  EgressScheduler scheduler(config, clock());
+
+  int tick = 0;
+  std::uint64_t heavy_bytes = 0;
+  std::uint64_t light_bytes = 0;
+  std::uint64_t light_sent = 0;
+  int max_light_delay = 0;
+  std::unordered_map<std::uint64_t, std::deque<int>> light_enqueued;
+  const auto send = [&](ClientSession& session, const std::vector<std::uint8_t>& datagram) {
+    if (session.session_id == heavy_id) {
+      heavy_bytes += datagram.size();
+      return;
+    }
+    // Light packets do not share datagrams (two do not fit in one).
+    auto& pending = light_enqueued[session.session_id];
+    ASSERT_FALSE(pending.empty());
+    max_light_delay = std::max(max_light_delay, tick - pending.front());
+    pending.pop_front();
+    light_bytes += datagram.size();
+    ++light_sent;
+  };
+
+  // Each light client sends a 1200-byte packet every 10 ms (about 1 Mbps),
+  // staggered across the ticks.
+  const std::vector<std::uint8_t> light_payload(1200, 0x11);
+  constexpr int kTicks = 1000;
+  std::uint64_t light_offered = 0;
+  for (tick = 0; tick < kTicks; ++tick) {
+    top_up(*table.find_by_id(heavy_id), scheduler);
+    for (std::size_t i = 0; i < light_ids.size(); ++i) {
+      if (static_cast<std::size_t>(tick % 10) == i % 10) {
+        auto* session = table.find_by_id(light_ids[i]);
+        ASSERT_TRUE(session->egress->enqueue(light_payload, kBulk));
+        light_enqueued[light_ids[i]].push_back(tick);
+        scheduler.activate(light_ids[i]);
+        ++light_offered;
+      }
+    }
+    scheduler.service(table, send);
+    EXPECT_TRUE(scheduler.budget_exhausted());
+    current_time_ += 1ms;
+  }
+
+  // Every light packet went out, within a tick of arriving...
+  EXPECT_EQ(light_sent, light_offered);
+  EXPECT_LE(max_light_delay, 1);
+  // ...and the heavy client got practically all the remaining capacity.
+  const auto capacity = static_cast<std::uint64_t>(kTicks) * config.max_bytes_per_service;
+  EXPECT_GE(static_cast<double>(heavy_bytes), 0.9 * static_cast<double>(capacity - light_bytes));
+  EXPECT_TRUE(scheduler.has_backlog());
+
+  // Sessions that go away drop out of the rotation.
+  table.remove_session(heavy_id);
+  scheduler.service(table, send);
+  EXPECT_FALSE(scheduler.has_backlog());
+}
+
+TEST_F(EgressSchedulerTest, PriorityScalesShare) {
+  SessionTable table(8, 300s, "10.8.0.2", "10.8.0.10", clock());
+  const auto high_id = add_session(table, 20000);
+  const auto normal_id = add_session(table, 20001);
+  table.find_by_id(high_id)->priority = utils::TrafficPriority::kHigh;
+
+  EgressSchedulerConfig config;
+  config.max_bytes_per_service = 12500;
+  EgressScheduler scheduler(config, clock());
+
+  std::unordered_map<std::uint64_t, std::uint64_t> bytes;
+  const auto send = [&](ClientSession& session, const std::vector<std::uint8_t>& datagram) {
+    bytes[session.session_id] += datagram.size();
+  };
+  for (int tick = 0; tick < 500; ++tick) {
+    top_up(*table.find_by_id(high_id), scheduler);
+    top_up(*table.find_by_id(normal_id), scheduler);
+    scheduler.service(table, send);
+    current_time_ += 1ms;
+  }
+
+  ASSERT_GT(bytes[normal_id], 0U);
+  const auto ratio = static_cast<double>(bytes[high_id]) / static_cast<double>(bytes[normal_id]);
+  EXPECT_NEAR(ratio, 2.0, 0.2);
+
+  config.quantum = 0;
+  EXPECT_THROW(EgressScheduler{config}, std::invalid_argument);
+}
+
+TEST_F(EgressSchedulerTest, RateLimitedClientWaitsWithoutDrops) {
+  SessionTable table(8, 300s, "10.8.0.2", "10.8.0.10", clock());
+  const auto limited_id = add_session(table, 20000);
+  const auto other_id = add_session(table, 20001);
+
+  EgressSchedulerConfig config;
+  config.max_bytes_per_service = 12500;
+  utils::RateLimiterConfig limits;
+  limits.packets_per_sec = 100000;
+  config.client_limits = limits;
+  EgressScheduler scheduler(config, clock());
+  ASSERT_NE(scheduler.rate_limiter(), nullptr);
+
+  // The limited client gets 1 MB/s with a small burst.
+  utils::RateLimiterConfig slow = limits;
+  slow.bandwidth_bytes_per_sec = 1000 * 1000;
+  slow.burst_allowance_factor = 0.05;
+  scheduler.rate_limiter()->set_client_config(std::to_string(limited_id), slow);
+
+  std::unordered_map<std::uint64_t, std::uint64_t> bytes;
+  const auto send = [&](ClientSession& session, const std::vector<std::uint8_t>& datagram) {
+    bytes[session.session_id] += datagram.size();
+  };
+  constexpr int kTicks = 2000;
+  for (int tick = 0; tick < kTicks; ++tick) {
+    top_up(*table.find_by_id(limited_id), scheduler);
+    top_up(*table.find_by_id(other_id), scheduler);
+    scheduler.service(table, send);
+    current_time_ += 1ms;
+  }
+
+  // Two seconds at 1 MB/s plus the burst; the other client takes the rest.
+  EXPECT_GE(bytes[limited_id], 1900U * 1000);
+  EXPECT_LE(bytes[limited_id], 2100U * 1000);
+  EXPECT_GE(bytes[other_id], static_cast<std::uint64_t>(kTicks) * 12500 - bytes[limited_id] - 100U * 1000);
+  EXPECT_GT(scheduler.stats().rate_limited, 0U);
+  // Shaping never turned into policing.
+  const auto limited_stats = scheduler.rate_limiter()->get_client_stats(std::to_string(limited_id));
+  ASSERT_TRUE(limited_stats.has_value());
+  EXPECT_EQ(limited_stats->violations, 0U);
+  EXPECT_EQ(limited_stats->bytes_denied, 0U);
+  EXPECT_EQ(table.find_by_id(limited_id)->egress->stats().dropped[1], 0U);
+}
+
+}  // namespace veil::server::test
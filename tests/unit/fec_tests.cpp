@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "transport/mux/fec.h"
+
+namespace veil::mux::tests {
+
+namespace {
+
+std::vector<std::uint8_t> make_payload(std::size_t size, std::uint8_t seed) {
+  std::vector<std::uint8_t> payload(size);
+  for (std::size_t i = 0; i < size; ++i) {
+    payload[i] = static_cast<std::uint8_t>(seed * 31 + i * 7);
+  }
+  return payload;
+}
+
+// Encode one group of packets starting at first_sequence and return the
+// payloads and repair frames.
+struct Group {
+  std::vector<std::vector<std::uint8_t>> payloads;
+  std::vector<MuxFrame> repairs;
+};
+
+Group encode_group(FecShape shape, std::uint64_t first_sequence) {
+  FecEncoder encoder;
+  encoder.set_shape(shape);
+  Group group;
+  for (std::size_t i = 0; i < shape.source_count; ++i) {
+    // Different lengths exercise the padding and the length prefix.
+    group.payloads.push_back(make_payload(40 + i * 13, static_cast<std::uint8_t>(i)));
+    const bool full = encoder.add(first_sequence + i, group.payloads.back());
+    EXPECT_EQ(full, i + 1 == shape.source_count);
+  }
+  group.repairs = encoder.finish();
+  EXPECT_TRUE(encoder.empty());
+  return group;
+}
+
+}  // namespace
+
+TEST(FecTests, FieldArithmetic) {
+  EXPECT_EQ(gf256_mul(0, 0x53), 0U);
+  EXPECT_EQ(gf256_mul(1, 0x53), 0x53U);
+  EXPECT_EQ(gf256_mul(2, 0x80), 0x1DU);  // Reduced by the field polynomial.
+  for (unsigned a = 1; a < 256; ++a) {
+    const auto value = static_cast<std::uint8_t>(a);
+    EXPECT_EQ(gf256_mul(value, gf256_inv(value)), 1U) << a;
+  }
+}
+
+TEST(FecTests, KernelMatchesPortable) {
+  std::mt19937 rng(7);
+  std::uniform_int_distribution<int> byte(0, 255);
+  for (std::size_t size : {0U, 1U, 15U, 16U, 31U, 32U, 33U, 100U, 1400U}) {
+    std::vector<std::uint8_t> src(size);
+    std::vector<std::uint8_t> dst(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      src[i] = static_cast<std::uint8_t>(byte(rng));
+      dst[i] = static_cast<std::uint8_t>(byte(rng));
+    }
+    for (unsigned c : {0U, 1U, 2U, 0x53U, 0xFFU}) {
+      auto expected = dst;
+      auto actual = dst;
+      gf256_mul_add_portable(expected, src, static_cast<std::uint8_t>(c));
+      gf256_mul_add(actual, src, static_cast<std::uint8_t>(c));
+      EXPECT_EQ(actual, expected) << gf256_kernel_name() << " size " << size << " c " << c;
+    }
+  }
+}
+
+TEST(FecTests, SingleRepairIsXorParity) {
+  auto group = encode_group({4, 1}, 100);
+  ASSERT_EQ(group.repairs.size(), 1U);
+  const auto& repair = group.repairs[0].repair;
+  EXPECT_EQ(repair.first_sequence, 100U);
+  EXPECT_EQ(repair.source_mask, 0b1111U);
+
+  std::vector<std::uint8_t> parity(repair.symbol.size(), 0);
+  for (const auto& payload : group.payloads) {
+    parity[0] ^= static_cast<std::uint8_t>(payload.size() >> 8);
+    parity[1] ^= static_cast<std::uint8_t>(payload.size() & 0xFF);
+    for (std::size_t i = 0; i < payload.size(); ++i) {
+      parity[2 + i] ^= payload[i];
+    }
+  }
+  EXPECT_EQ(repair.symbol, parity);
+}
+
+TEST(FecTests, RecoversAnyLossesUpToRepairCount) {
+  const FecShape shape{6, 2};
+  auto group = encode_group(shape, 500);
+  ASSERT_EQ(group.repairs.size(), 2U);
+
+  for (std::size_t lost_a = 0; lost_a < shape.source_count; ++lost_a) {
+    for (std::size_t lost_b = lost_a; lost_b < shape.source_count; ++lost_b) {
+      FecDecoder decoder;
+      for (std::size_t i = 0; i < shape.source_count; ++i) {
+        if (i != lost_a && i != lost_b) {
+          decoder.on_packet(500 + i, group.payloads[i]);
+        }
+      }
+      std::vector<RecoveredPacket> recovered;
+      for (const auto& repair : group.repairs) {
+        for (auto& packet : decoder.on_repair(repair.repair)) {
+          recovered.push_back(std::move(packet));
+        }
+      }
+      const std::size_t lost = lost_a == lost_b ? 1 : 2;
+      ASSERT_EQ(recovered.size(), lost) << lost_a << "," << lost_b;
+      for (const auto& packet : recovered) {
+        const auto index = static_cast<std::size_t>(packet.sequence - 500);
+        EXPECT_TRUE(index == lost_a || index == lost_b);
+        EXPECT_EQ(packet.plaintext, group.payloads[index]);
+      }
+    }
+  }
+}
+
+TEST(FecTests, TooManyLossesRecoverNothing) {
+  auto group = encode_group({4, 1}, 0);
+  FecDecoder decoder;
+  decoder.on_packet(0, group.payloads[0]);
+  decoder.on_packet(1, group.payloads[1]);
+  EXPECT_TRUE(decoder.on_repair(group.repairs[0].repair).empty());
+}
+
+TEST(FecTests, RepairsWaitForLateSources) {
+  // A repair that cannot rebuild the group yet is kept; a source that arrives
+  // late plus the next repair then suffice.
+  auto group = encode_group({4, 2}, 10);
+  FecDecoder decoder;
+  decoder.on_packet(10, group.payloads[0]);
+  EXPECT_TRUE(decoder.on_repair(group.repairs[0].repair).empty());
+  decoder.on_packet(11, group.payloads[1]);
+  auto recovered = decoder.on_repair(group.repairs[1].repair);
+  ASSERT_EQ(recovered.size(), 2U);
+  EXPECT_EQ(recovered[0].sequence, 12U);
+  EXPECT_EQ(recovered[0].plaintext, group.payloads[2]);
+  EXPECT_EQ(recovered[1].sequence, 13U);
+  EXPECT_EQ(recovered[1].plaintext, group.payloads[3]);
+
+  // Duplicates of a finished group are ignored.
+  EXPECT_TRUE(decoder.on_repair(group.repairs[1].repair).empty());
+}
+
+TEST(FecTests, RejectsMalformedRepairs) {
+  FecDecoder decoder;
+  auto repair = make_repair_frame(0, 0b10, 1, 0, {0, 1, 2}).repair;  // Bit 0 must be set.
+  EXPECT_TRUE(decoder.on_repair(repair).empty());
+  repair = make_repair_frame(0, 0b11, 1, 1, {0, 1, 2}).repair;  // Index out of range.
+  EXPECT_TRUE(decoder.on_repair(repair).empty());
+  repair = make_repair_frame(0, 0b11, 1, 0, {0}).repair;  // No room for the length.
+  EXPECT_TRUE(decoder.on_repair(repair).empty());
+  EXPECT_THROW(FecDecoder(kFecMaxSources - 1), std::invalid_argument);
+}
+
+TEST(FecTests, EncoderLimitsGroupSpan) {
+  FecEncoder encoder;
+  encoder.set_shape({8, 1});
+  EXPECT_TRUE(encoder.accepts(1000));
+  encoder.add(1000, make_payload(10, 1));
+  EXPECT_TRUE(encoder.accepts(1000 + kFecMaxSources - 1));
+  EXPECT_FALSE(encoder.accepts(1000 + kFecMaxSources));
+  EXPECT_FALSE(encoder.accepts(999));
+  EXPECT_THROW(encoder.set_shape({0, 1}), std::invalid_argument);
+  EXPECT_THROW(encoder.set_shape({8, kFecMaxRepairs + 1}), std::invalid_argument);
+}
+
+TEST(FecTests, AdapterStepsWithResidualLoss) {
+  FecConfig config;
+  config.adapt_interval = 100;
+  config.target_loss = 0.01;
+  FecAdapter adapter(config);
+  const auto start = adapter.level();
+
+  // 5% of packets still retransmitted: strengthen.
+  auto shape = adapter.update(100, 5);
+  EXPECT_EQ(adapter.level(), start + 1);
+  EXPECT_EQ(shape.repair_count, FecAdapter::kLadder[start + 1].repair_count);
+
+  // Nothing changes before the next interval.
+  adapter.update(150, 50);
+  EXPECT_EQ(adapter.level(), start + 1);
+
+  // Clean intervals: step back down, but only after a sustained quiet period.
+  std::uint64_t sent = 100;
+  std::size_t intervals = 0;
+  while (adapter.level() > start && intervals < 10) {
+    sent += 100;
+    adapter.update(sent, 5);
+    ++intervals;
+  }
+  EXPECT_EQ(adapter.level(), start);
+  EXPECT_GT(intervals, 1U);
+
+  FecConfig fixed;
+  fixed.adaptive = false;
+  fixed.source_count = 4;
+  fixed.repair_count = 2;
+  FecAdapter fixed_adapter(fixed);
+  shape = fixed_adapter.update(1000, 500);
+  EXPECT_EQ(shape.source_count, 4U);
+  EXPECT_EQ(shape.repair_count, 2U);
+}
+
+}  // namespace veil::mux::tests
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <chrono>
 #include <vector>
 
 #include "transport/mux/fragment_reassembly.h"
@@ -29,4 +30,15 @@ TEST(FragmentReassemblyTests, RespectsLimit) {
   EXPECT_FALSE(r.push(1, mux::Fragment{1, {2, 3}, true}));
 }
 
+TEST(FragmentReassemblyTests, PlacesByIndex) {
+  mux::FragmentReassembly r(1 << 20, std::chrono::milliseconds(5000), mux::FragmentPlacement::kIndex);
+  EXPECT_TRUE(r.push(1, mux::Fragment{2, {6}, true}));
+  EXPECT_TRUE(r.push(1, mux::Fragment{0, {1, 2, 3}, false}));
+  EXPECT_FALSE(r.try_reassemble(1).has_value());
+  EXPECT_TRUE(r.push(1, mux::Fragment{1, {4, 5}, false}));
+  auto out = r.try_reassemble(1);
+  ASSERT_TRUE(out.has_value());
+  EXPECT_EQ(*out, (std::vector<std::uint8_t>{1, 2, 3, 4, 5, 6}));
+}
+
 }  // namespace veil::tests
@@ -3,8 +3,10 @@
 #include <gtest/gtest.h>
 
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <thread>
+#include <vector>
 
 namespace veil::handshake::test {
 
@@ -66,8 +68,8 @@ TEST_F(HandshakeReplayCacheTest, AllowsDifferentTimestamps) {
   EXPECT_TRUE(cache.mark_and_check(3000, key));
 }
 
-TEST_F(HandshakeReplayCacheTest, EvictsLRUWhenAtCapacity) {
-  // Use longer time window to prevent auto-cleanup during test
+TEST_F(HandshakeReplayCacheTest, EvictsOldestWhenAtCapacity) {
+  // Use longer time window to prevent expiry during test
   HandshakeReplayCache cache(3, std::chrono::milliseconds(100000));  // Small capacity
   const auto key1 = make_key(0x01);
   const auto key2 = make_key(0x02);
@@ -80,7 +82,7 @@ TEST_F(HandshakeReplayCacheTest, EvictsLRUWhenAtCapacity) {
   EXPECT_FALSE(cache.mark_and_check(3000, key3));
   EXPECT_EQ(cache.size(), 3);
 
-  // Add fourth entry - should evict key1 (least recently used)
+  // Add fourth entry - should evict key1 (oldest timestamp)
   EXPECT_FALSE(cache.mark_and_check(4000, key4));
   EXPECT_EQ(cache.size(), 3);
 
@@ -93,31 +95,42 @@ TEST_F(HandshakeReplayCacheTest, EvictsLRUWhenAtCapacity) {
   EXPECT_FALSE(cache.mark_and_check(1000, key1));
 }
 
-TEST_F(HandshakeReplayCacheTest, LRUOrderingUpdatedOnAccess) {
-  HandshakeReplayCache cache(3);
+TEST_F(HandshakeReplayCacheTest, EvictionIgnoresAccessOrder) {
+  // Eviction is by timestamp bucket, not by recency of access: seeing a replay
+  // does not extend the life of an entry.
+  HandshakeReplayCache cache(3, std::chrono::milliseconds(100000));
   const auto key1 = make_key(0x01);
   const auto key2 = make_key(0x02);
   const auto key3 = make_key(0x03);
   const auto key4 = make_key(0x04);
 
-  // Fill cache: key1, key2, key3 (key1 is LRU)
   EXPECT_FALSE(cache.mark_and_check(1000, key1));
-  EXPECT_FALSE(cache.mark_and_check(2000, key2));
-  EXPECT_FALSE(cache.mark_and_check(3000, key3));
+  EXPECT_FALSE(cache.mark_and_check(5000, key2));
+  EXPECT_FALSE(cache.mark_and_check(6000, key3));
 
-  // Access key1 (moves it to MRU)
   EXPECT_TRUE(cache.mark_and_check(1000, key1));
 
-  // Add key4 - should evict key2 (now LRU), not key1
-  EXPECT_FALSE(cache.mark_and_check(4000, key4));
+  // key1 still has the oldest timestamp and is evicted.
+  EXPECT_FALSE(cache.mark_and_check(7000, key4));
+  EXPECT_TRUE(cache.mark_and_check(5000, key2));
+  EXPECT_TRUE(cache.mark_and_check(6000, key3));
+  EXPECT_TRUE(cache.mark_and_check(7000, key4));
+}
 
-  // key1, key3, key4 should still be in cache
-  EXPECT_TRUE(cache.mark_and_check(1000, key1));
-  EXPECT_TRUE(cache.mark_and_check(3000, key3));
-  EXPECT_TRUE(cache.mark_and_check(4000, key4));
+TEST_F(HandshakeReplayCacheTest, ExpiredEntriesAreReusedWithoutCleanup) {
+  HandshakeReplayCache cache(3, std::chrono::milliseconds(1000));
 
-  // key2 should have been evicted
-  EXPECT_FALSE(cache.mark_and_check(2000, key2));
+  EXPECT_FALSE(cache.mark_and_check(1000, make_key(0x01)));
+  EXPECT_FALSE(cache.mark_and_check(1100, make_key(0x02)));
+  EXPECT_FALSE(cache.mark_and_check(1200, make_key(0x03)));
+
+  // Far in the future all previous entries are outside the window and get
+  // overwritten in place without growing the cache.
+  EXPECT_FALSE(cache.mark_and_check(10000, make_key(0x04)));
+  EXPECT_FALSE(cache.mark_and_check(10000, make_key(0x05)));
+  EXPECT_FALSE(cache.mark_and_check(10000, make_key(0x06)));
+  EXPECT_EQ(cache.size(), 3);
+  EXPECT_TRUE(cache.mark_and_check(10000, make_key(0x05)));
 }
 
 TEST_F(HandshakeReplayCacheTest, CleansUpExpiredEntries) {
@@ -203,6 +216,51 @@ TEST_F(HandshakeReplayCacheTest, ThreadSafety) {
   EXPECT_EQ(cache.size(), num_threads * iterations);
 }
 
+TEST_F(HandshakeReplayCacheTest, ConcurrentDuplicateIsNeverAcceptedTwice) {
+  HandshakeReplayCache cache(4096);
+  constexpr int num_threads = 4;
+  constexpr int rounds = 200;
+
+  for (int round = 0; round < rounds; ++round) {
+    const auto key = make_key(static_cast<std::uint8_t>(round));
+    const std::uint64_t ts = 1000 + static_cast<std::uint64_t>(round);
+    std::atomic<int> accepted{0};
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<std::size_t>(num_threads));
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&]() {
+        if (!cache.mark_and_check(ts, key)) {
+          accepted.fetch_add(1, std::memory_order_relaxed);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    EXPECT_LE(accepted.load(), 1) << "round " << round;
+  }
+}
+
+TEST_F(HandshakeReplayCacheTest, ShardedCacheHoldsCapacity) {
+  HandshakeReplayCache cache(4096, std::chrono::milliseconds(1000000));
+  std::size_t rejected = 0;
+  for (std::uint64_t i = 0; i < 4096; ++i) {
+    auto key = make_key(0);
+    for (std::size_t b = 0; b < 8; ++b) {
+      key[b] = static_cast<std::uint8_t>(i >> (8 * b));
+    }
+    if (cache.mark_and_check(1000, key)) {
+      ++rejected;
+    }
+  }
+  EXPECT_EQ(rejected, 0U);
+  // Shards fill unevenly, so a little headroom is lost to per-shard limits.
+  EXPECT_GE(cache.size(), 3700U);
+  EXPECT_LE(cache.size(), 4096U);
+}
+
 TEST_F(HandshakeReplayCacheTest, ZeroCapacityThrows) {
   EXPECT_THROW(HandshakeReplayCache(0), std::invalid_argument);
 }
@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <string_view>
 #include <vector>
 
+#include "common/crypto/crypto_engine.h"
 #include "common/handshake/handshake_processor.h"
 #include "common/utils/rate_limiter.h"
 
@@ -13,7 +17,26 @@ namespace veil::tests {
 
 namespace {
 std::vector<std::uint8_t> make_psk() { return std::vector<std::uint8_t>(32, 0xAA); }
+
+// Key that obfuscates handshake packets, derived from the PSK as the
+// handshake processor does.
+std::array<std::uint8_t, crypto::kAeadKeyLen> handshake_key(std::span<const std::uint8_t> psk) {
+  constexpr std::string_view kLabel = "VEIL-HANDSHAKE-OBFUSCATE";
+  const auto prk = crypto::hkdf_extract({}, psk);
+  const auto material = crypto::hkdf_expand(
+      prk, std::span<const std::uint8_t>(reinterpret_cast<const std::uint8_t*>(kLabel.data()), kLabel.size()),
+      crypto::kAeadKeyLen);
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  std::copy_n(material.begin(), key.size(), key.begin());
+  return key;
+}
+
+void append_u64(std::vector<std::uint8_t>& out, std::uint64_t value) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    out.push_back(static_cast<std::uint8_t>(value >> shift));
+  }
 }
+}  // namespace
 
 TEST(HandshakeTests, SuccessfulHandshakeProducesMatchingKeys) {
   auto now = std::chrono::system_clock::now();
@@ -110,12 +133,12 @@ TEST(HandshakeTests, InitPacketDoesNotContainPlaintextMagicBytes) {
   EXPECT_FALSE(magic_at_start) << "Plaintext magic bytes 'HS' found at start of packet - should start with random nonce";
 
   // The encrypted packet should be larger due to nonce (12 bytes), AEAD tag (16 bytes), and padding
-  // Original INIT size: 2 + 1 + 1 + 8 + 32 + 32 = 76 bytes
-  // With padding: 76 + 2 (padding length) + 32-400 (padding) = 110-478 bytes
-  // Encrypted size: 12 (nonce) + plaintext + 16 (tag) = 138-506 bytes
+  // Original INIT size: 2 + 1 + 1 + 8 + 32 + 1 (AEAD suites) + 32 = 77 bytes
+  // With padding: 77 + 2 (padding length) + 32-400 (padding) = 111-479 bytes
+  // Encrypted size: 12 (nonce) + plaintext + 16 (tag) = 139-507 bytes
   // Verify size is within expected range
-  EXPECT_GE(init_bytes.size(), 138u) << "Encrypted INIT packet should be at least 138 bytes";
-  EXPECT_LE(init_bytes.size(), 506u) << "Encrypted INIT packet should be at most 506 bytes";
+  EXPECT_GE(init_bytes.size(), 139u) << "Encrypted INIT packet should be at least 139 bytes";
+  EXPECT_LE(init_bytes.size(), 507u) << "Encrypted INIT packet should be at most 507 bytes";
 }
 
 TEST(HandshakeTests, ResponsePacketDoesNotContainPlaintextMagicBytes) {
@@ -143,12 +166,12 @@ TEST(HandshakeTests, ResponsePacketDoesNotContainPlaintextMagicBytes) {
   bool magic_at_start = (response_bytes[0] == 0x48 && response_bytes[1] == 0x53);
   EXPECT_FALSE(magic_at_start) << "Plaintext magic bytes 'HS' found at start of response packet - should start with random nonce";
 
-  // Original RESPONSE size: 2 + 1 + 1 + 8 + 8 + 8 + 32 + 32 = 92 bytes
-  // With padding: 92 + 2 (padding length) + 32-400 (padding) = 126-494 bytes
-  // Encrypted size: 12 (nonce) + plaintext + 16 (tag) = 154-522 bytes
+  // Original RESPONSE size: 2 + 1 + 1 + 8 + 8 + 8 + 32 + 1 (AEAD suite) + 32 = 93 bytes
+  // With padding: 93 + 2 (padding length) + 32-400 (padding) = 127-495 bytes
+  // Encrypted size: 12 (nonce) + plaintext + 16 (tag) = 155-523 bytes
   // Verify size is within expected range
-  EXPECT_GE(response_bytes.size(), 154u) << "Encrypted RESPONSE packet should be at least 154 bytes";
-  EXPECT_LE(response_bytes.size(), 522u) << "Encrypted RESPONSE packet should be at most 522 bytes";
+  EXPECT_GE(response_bytes.size(), 155u) << "Encrypted RESPONSE packet should be at least 155 bytes";
+  EXPECT_LE(response_bytes.size(), 523u) << "Encrypted RESPONSE packet should be at most 523 bytes";
 }
 
 TEST(HandshakeTests, EncryptedPacketsAppearRandom) {
@@ -197,4 +220,186 @@ TEST(HandshakeTests, WrongPskCannotDecrypt) {
   EXPECT_FALSE(resp.has_value()) << "Decryption should fail with wrong PSK";
 }
 
+TEST(HandshakeTests, NegotiatesAeadFromBothPeersSuites) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+    return std::chrono::steady_clock::now();
+  });
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          std::move(bucket), now_fn);
+  initiator.set_aead_suites(crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm));
+  responder.set_aead_suites(crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm));
+
+  auto resp = responder.handle_init(initiator.create_init());
+  ASSERT_TRUE(resp.has_value());
+  auto session = initiator.consume_response(resp->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_EQ(session->aead, crypto::AeadAlgorithm::kAesGcm);
+  EXPECT_EQ(resp->session.aead, crypto::AeadAlgorithm::kAesGcm);
+}
+
+TEST(HandshakeTests, VersionOneInitSilentlyDropped) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  const auto psk = make_psk();
+
+  utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+    return std::chrono::steady_clock::now();
+  });
+  handshake::HandshakeResponder responder(psk, std::chrono::milliseconds(1000), std::move(bucket), now_fn);
+
+  // A correctly signed version 1 INIT, which has no suite byte:
+  // magic | version | type | timestamp | ephemeral_pub | hmac | padding_len | padding
+  const auto ephemeral = crypto::generate_x25519_keypair();
+  std::vector<std::uint8_t> init{'H', 'S', 1, static_cast<std::uint8_t>(handshake::MessageType::kInit)};
+  append_u64(init, static_cast<std::uint64_t>(
+                       std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count()));
+  init.insert(init.end(), ephemeral.public_key.begin(), ephemeral.public_key.end());
+  const auto init_mac = crypto::hmac_sha256(psk, init);
+  init.insert(init.end(), init_mac.begin(), init_mac.end());
+  init.insert(init.end(), {0, 32});
+  init.resize(init.size() + 32, 0);
+  const std::array<std::uint8_t, crypto::kNonceLen> nonce{};
+  auto init_bytes = crypto::aead_encrypt(handshake_key(psk), nonce, {}, init);
+  init_bytes.insert(init_bytes.begin(), nonce.begin(), nonce.end());
+
+  EXPECT_FALSE(responder.handle_init(init_bytes).has_value());
+}
+
+TEST(HandshakeTests, FallsBackToChaChaWhenOnePeerLacksAes) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+    return std::chrono::steady_clock::now();
+  });
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          std::move(bucket), now_fn);
+  initiator.set_aead_suites(0);  // ChaCha20-Poly1305 only
+  responder.set_aead_suites(crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm));
+
+  auto resp = responder.handle_init(initiator.create_init());
+  ASSERT_TRUE(resp.has_value());
+  auto session = initiator.consume_response(resp->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_EQ(session->aead, crypto::AeadAlgorithm::kChaCha20Poly1305);
+  EXPECT_EQ(resp->session.aead, crypto::AeadAlgorithm::kChaCha20Poly1305);
+}
+
+TEST(HandshakeTests, NegotiatesCompactFramesWhenBothPeersSupportIt) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+    return std::chrono::steady_clock::now();
+  });
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                          std::move(bucket), now_fn);
+  initiator.set_aead_suites(crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm));
+  responder.set_aead_suites(crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm));
+
+  auto resp = responder.handle_init(initiator.create_init());
+  ASSERT_TRUE(resp.has_value());
+  auto session = initiator.consume_response(resp->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_TRUE(session->compact_frames);
+  EXPECT_TRUE(resp->session.compact_frames);
+  // The feature bit does not disturb suite negotiation.
+  EXPECT_EQ(session->aead, crypto::AeadAlgorithm::kAesGcm);
+}
+
+TEST(HandshakeTests, KeepsLegacyFramesWhenEitherPeerOptsOut) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  for (const bool initiator_compact : {false, true}) {
+    handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+    utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+      return std::chrono::steady_clock::now();
+    });
+    handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                            std::move(bucket), now_fn);
+    initiator.set_compact_frames(initiator_compact);
+    responder.set_compact_frames(!initiator_compact);
+
+    auto resp = responder.handle_init(initiator.create_init());
+    ASSERT_TRUE(resp.has_value());
+    auto session = initiator.consume_response(resp->response);
+    ASSERT_TRUE(session.has_value());
+    EXPECT_FALSE(session->compact_frames);
+    EXPECT_FALSE(resp->session.compact_frames);
+  }
+}
+
+TEST(HandshakeTests, NegotiatesFecOnlyWhenTheInitiatorOffersIt) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  for (const bool offer : {false, true}) {
+    handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+    utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+      return std::chrono::steady_clock::now();
+    });
+    handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                            std::move(bucket), now_fn);
+    initiator.set_fec(offer);
+
+    auto resp = responder.handle_init(initiator.create_init());
+    ASSERT_TRUE(resp.has_value());
+    auto session = initiator.consume_response(resp->response);
+    ASSERT_TRUE(session.has_value());
+    EXPECT_EQ(session->fec, offer);
+    EXPECT_EQ(resp->session.fec, offer);
+    // Independent of the other feature bits.
+    EXPECT_TRUE(session->compact_frames);
+  }
+
+  // A responder that opts out turns the offer down.
+  handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+  utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+    return std::chrono::steady_clock::now();
+  });
+  handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000), std::move(bucket),
+                                          now_fn);
+  initiator.set_fec(true);
+  responder.set_fec(false);
+  auto resp = responder.handle_init(initiator.create_init());
+  ASSERT_TRUE(resp.has_value());
+  auto session = initiator.consume_response(resp->response);
+  ASSERT_TRUE(session.has_value());
+  EXPECT_FALSE(session->fec);
+  EXPECT_FALSE(resp->session.fec);
+}
+
+TEST(HandshakeTests, NegotiatesAckDelayOnlyWhenBothPeersOfferIt) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  for (const bool initiator_offers : {false, true}) {
+    for (const bool responder_offers : {false, true}) {
+      handshake::HandshakeInitiator initiator(make_psk(), std::chrono::milliseconds(1000), now_fn);
+      utils::TokenBucket bucket(10.0, std::chrono::milliseconds(1000), [] {
+        return std::chrono::steady_clock::now();
+      });
+      handshake::HandshakeResponder responder(make_psk(), std::chrono::milliseconds(1000),
+                                              std::move(bucket), now_fn);
+      initiator.set_ack_delay(initiator_offers);
+      responder.set_ack_delay(responder_offers);
+
+      auto resp = responder.handle_init(initiator.create_init());
+      ASSERT_TRUE(resp.has_value());
+      auto session = initiator.consume_response(resp->response);
+      ASSERT_TRUE(session.has_value());
+      EXPECT_EQ(session->ack_delay, initiator_offers && responder_offers);
+      EXPECT_EQ(resp->session.ack_delay, initiator_offers && responder_offers);
+      EXPECT_TRUE(session->compact_frames);
+    }
+  }
+}
+
 }  // namespace veil::tests
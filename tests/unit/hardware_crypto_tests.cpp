@@ -6,6 +6,7 @@
 #include <cstring>
 #include <limits>
 #include <span>
+#include <stdexcept>
 #include <vector>
 
 #include "common/crypto/crypto_engine.h"
@@ -426,4 +427,149 @@ TEST(HardwareCryptoTests, EmptyPlaintextEncryption) {
   EXPECT_TRUE(decrypted.value().empty());
 }
 
+// ============================================================================
+// Suite Negotiation and Keyed Cipher Tests
+// ============================================================================
+
+TEST(HardwareCryptoTests, NegotiateAeadRequiresBothPeersForAesGcm) {
+  const auto chacha = crypto::aead_suite_bit(crypto::AeadAlgorithm::kChaCha20Poly1305);
+  const auto gcm = crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm);
+
+  EXPECT_EQ(crypto::negotiate_aead(chacha | gcm, chacha | gcm), crypto::AeadAlgorithm::kAesGcm);
+  EXPECT_EQ(crypto::negotiate_aead(chacha, chacha | gcm), crypto::AeadAlgorithm::kChaCha20Poly1305);
+  EXPECT_EQ(crypto::negotiate_aead(chacha | gcm, chacha), crypto::AeadAlgorithm::kChaCha20Poly1305);
+  EXPECT_EQ(crypto::negotiate_aead(0, 0), crypto::AeadAlgorithm::kChaCha20Poly1305);
+}
+
+TEST(HardwareCryptoTests, LocalSuitesReflectHardware) {
+  const auto suites = crypto::local_aead_suites();
+  EXPECT_NE(suites & crypto::aead_suite_bit(crypto::AeadAlgorithm::kChaCha20Poly1305), 0);
+  EXPECT_EQ((suites & crypto::aead_suite_bit(crypto::AeadAlgorithm::kAesGcm)) != 0,
+            crypto::get_recommended_aead_algorithm() == crypto::AeadAlgorithm::kAesGcm);
+}
+
+TEST(HardwareCryptoTests, AeadCipherMatchesOneShotFunctions) {
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  std::array<std::uint8_t, crypto::kNonceLen> nonce{};
+  key.fill(0x42);
+  nonce.fill(0x07);
+  const std::vector<std::uint8_t> aad = {'c', 'i', 'd'};
+  const std::vector<std::uint8_t> plaintext(300, 0x5C);
+
+  std::vector<crypto::AeadAlgorithm> algorithms{crypto::AeadAlgorithm::kChaCha20Poly1305};
+  if (crypto::get_recommended_aead_algorithm() == crypto::AeadAlgorithm::kAesGcm) {
+    algorithms.push_back(crypto::AeadAlgorithm::kAesGcm);
+  }
+  for (const auto algo : algorithms) {
+    const crypto::AeadCipher cipher(algo, key);
+    EXPECT_EQ(cipher.algorithm(), algo);
+
+    const auto ciphertext = cipher.encrypt(nonce, aad, plaintext);
+    EXPECT_EQ(ciphertext, crypto::aead_encrypt_with_algorithm(key, nonce, aad, plaintext, algo));
+
+    std::vector<std::uint8_t> out(plaintext.size());
+    EXPECT_EQ(cipher.decrypt_to(nonce, aad, ciphertext, out), plaintext.size());
+    EXPECT_EQ(out, plaintext);
+
+    auto tampered = ciphertext;
+    tampered[10] ^= 0x01;
+    EXPECT_FALSE(cipher.decrypt(nonce, aad, tampered).has_value());
+  }
+}
+
+TEST(HardwareCryptoTests, AeadCipherRejectsUnavailableAesGcm) {
+  if (crypto::get_recommended_aead_algorithm() == crypto::AeadAlgorithm::kAesGcm) {
+    GTEST_SKIP() << "AES-GCM is available on this CPU";
+  }
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  EXPECT_THROW(crypto::AeadCipher(crypto::AeadAlgorithm::kAesGcm, key), std::invalid_argument);
+}
+
+TEST(HardwareCryptoTests, AeadCipherSurvivesMove) {
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  std::array<std::uint8_t, crypto::kNonceLen> nonce{};
+  key.fill(0x11);
+  const std::vector<std::uint8_t> plaintext = {1, 2, 3, 4};
+
+  crypto::AeadCipher original(crypto::AeadAlgorithm::kAuto, key);
+  const auto ciphertext = original.encrypt(nonce, {}, plaintext);
+  crypto::AeadCipher moved(std::move(original));
+  const auto decrypted = moved.decrypt(nonce, {}, ciphertext);
+  ASSERT_TRUE(decrypted.has_value());
+  EXPECT_EQ(*decrypted, plaintext);
+}
+
+// ============================================================================
+// SequenceObfuscator Tests
+// ============================================================================
+
+TEST(HardwareCryptoTests, SequenceObfuscatorRoundTrip) {
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  key.fill(0x3C);
+
+  for (const bool use_hardware : {true, false}) {
+    const crypto::SequenceObfuscator obfuscator(key, use_hardware);
+    for (const std::uint64_t seq : {std::uint64_t{0}, std::uint64_t{1}, std::uint64_t{0xFFFFFFFF},
+                                    std::uint64_t{0x100000000}, std::numeric_limits<std::uint64_t>::max()}) {
+      EXPECT_EQ(obfuscator.deobfuscate(obfuscator.obfuscate(seq)), seq) << "seq " << seq;
+    }
+    for (std::uint64_t seq = 0; seq < 10000; ++seq) {
+      ASSERT_EQ(obfuscator.deobfuscate(obfuscator.obfuscate(seq)), seq) << "seq " << seq;
+    }
+  }
+}
+
+TEST(HardwareCryptoTests, SequenceObfuscatorHardwareMatchesPortable) {
+  const auto key_vec = crypto::random_bytes(crypto::kAeadKeyLen);
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  std::copy(key_vec.begin(), key_vec.end(), key.begin());
+
+  const crypto::SequenceObfuscator hardware(key, true);
+  const crypto::SequenceObfuscator portable(key, false);
+  EXPECT_FALSE(portable.uses_hardware());
+  if (!hardware.uses_hardware()) {
+    GTEST_SKIP() << "AES-NI not available";
+  }
+
+  // Peers may take different paths; the wire values must agree.
+  for (std::uint64_t i = 0; i < 5000; ++i) {
+    const std::uint64_t seq = i * 0x9E3779B97F4A7C15ULL;
+    ASSERT_EQ(hardware.obfuscate(seq), portable.obfuscate(seq)) << "seq " << seq;
+    ASSERT_EQ(hardware.deobfuscate(seq), portable.deobfuscate(seq)) << "seq " << seq;
+  }
+}
+
+TEST(HardwareCryptoTests, SequenceObfuscatorHidesEveryByteOfSmallSequences) {
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key{};
+  key.fill(0x5A);
+  const crypto::SequenceObfuscator obfuscator(key);
+
+  // Consecutive small counters must not leave constant bytes on the wire.
+  for (std::size_t byte = 0; byte < 8; ++byte) {
+    std::array<bool, 256> seen{};
+    std::size_t distinct = 0;
+    for (std::uint64_t seq = 0; seq < 256; ++seq) {
+      const auto value = static_cast<std::uint8_t>((obfuscator.obfuscate(seq) >> (8 * byte)) & 0xFF);
+      if (!seen[value]) {
+        seen[value] = true;
+        ++distinct;
+      }
+    }
+    EXPECT_GT(distinct, 128U) << "byte " << byte;
+  }
+}
+
+TEST(HardwareCryptoTests, SequenceObfuscatorDependsOnKey) {
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key1{};
+  std::array<std::uint8_t, crypto::kAeadKeyLen> key2{};
+  key1.fill(0x01);
+  key2.fill(0x02);
+  const crypto::SequenceObfuscator first(key1);
+  const crypto::SequenceObfuscator second(key2);
+  const crypto::SequenceObfuscator copy(first);
+
+  EXPECT_NE(first.obfuscate(42), second.obfuscate(42));
+  EXPECT_EQ(first.obfuscate(42), copy.obfuscate(42));
+}
+
 }  // namespace veil::tests
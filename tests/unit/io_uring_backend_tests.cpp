@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdint>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "transport/event_loop/event_loop.h"
+#include "transport/event_loop/io_uring_backend.h"
+#include "transport/udp_socket/udp_socket.h"
+
+namespace veil::tests {
+
+namespace {
+
+transport::EventLoopConfig io_uring_config() {
+  transport::EventLoopConfig config;
+  config.backend = transport::EventLoopBackend::kIoUring;
+  config.epoll_timeout_ms = 5000;
+  config.io_uring_recv_buffers = 64;
+  return config;
+}
+
+bool io_uring_available() {
+  std::error_code ec;
+  return transport::IoUringBackend::create(transport::IoUringConfig{}, ec) != nullptr;
+}
+
+bool open_socket(transport::UdpSocket& socket) {
+  std::error_code ec;
+  return socket.open(0, false, ec);
+}
+
+}  // namespace
+
+TEST(EventLoopBackendTests, ParsesBackendNames) {
+  EXPECT_EQ(transport::parse_event_loop_backend("epoll"), transport::EventLoopBackend::kEpoll);
+  EXPECT_EQ(transport::parse_event_loop_backend("io_uring"), transport::EventLoopBackend::kIoUring);
+  EXPECT_EQ(transport::parse_event_loop_backend("auto"), transport::EventLoopBackend::kAuto);
+  EXPECT_FALSE(transport::parse_event_loop_backend("kqueue").has_value());
+}
+
+TEST(EventLoopBackendTests, DefaultsToEpoll) {
+  transport::EventLoop loop;
+  EXPECT_EQ(loop.backend(), transport::EventLoopBackend::kEpoll);
+}
+
+TEST(EventLoopBackendTests, AutoReportsTheBackendInUse) {
+  transport::EventLoopConfig config;
+  config.backend = transport::EventLoopBackend::kAuto;
+  transport::EventLoop loop(config);
+  EXPECT_EQ(loop.backend(), io_uring_available() ? transport::EventLoopBackend::kIoUring
+                                                 : transport::EventLoopBackend::kEpoll);
+}
+
+class IoUringEventLoopTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    if (!io_uring_available()) {
+      GTEST_SKIP() << "io_uring not available in this environment";
+    }
+  }
+};
+
+TEST_F(IoUringEventLoopTest, ReceivesBurstOfDatagrams) {
+  transport::UdpSocket server;
+  transport::UdpSocket client;
+  if (!open_socket(server) || !open_socket(client)) {
+    GTEST_SKIP() << "UDP sockets not permitted in this environment";
+  }
+
+  transport::EventLoop loop(io_uring_config());
+  ASSERT_EQ(loop.backend(), transport::EventLoopBackend::kIoUring);
+
+  constexpr int kPackets = 200;
+  int received = 0;
+  std::uint16_t from_port = 0;
+  ASSERT_TRUE(loop.add_socket(&server, 1, {"127.0.0.1", client.local_port()},
+                              [&](transport::SessionId, std::span<const std::uint8_t> data,
+                                  const transport::UdpEndpoint& remote) {
+                                EXPECT_EQ(data.size(), 100U);
+                                EXPECT_EQ(data[0], static_cast<std::uint8_t>(received));
+                                EXPECT_EQ(remote.host, "127.0.0.1");
+                                from_port = remote.port;
+                                if (++received == kPackets) {
+                                  loop.stop();
+                                }
+                              }));
+
+  // Bound the test if datagrams go missing.
+  loop.schedule_timer(std::chrono::seconds(2), [&](utils::TimerId) { loop.stop(); });
+
+  std::thread sender([&]() {
+    while (!loop.is_running()) {
+      std::this_thread::yield();
+    }
+    std::error_code ec;
+    std::vector<std::uint8_t> payload(100, 0);
+    for (int i = 0; i < kPackets; ++i) {
+      payload[0] = static_cast<std::uint8_t>(i);
+      EXPECT_TRUE(client.send(payload, {"127.0.0.1", server.local_port()}, ec)) << ec.message();
+    }
+  });
+  loop.run();
+  sender.join();
+
+  EXPECT_EQ(received, kPackets);
+  EXPECT_EQ(from_port, client.local_port());
+  EXPECT_TRUE(loop.remove_socket(server.fd()));
+}
+
+TEST_F(IoUringEventLoopTest, SendsAreQueuedThroughTheRing) {
+  transport::UdpSocket server;
+  transport::UdpSocket peer;
+  if (!open_socket(server) || !open_socket(peer)) {
+    GTEST_SKIP() << "UDP sockets not permitted in this environment";
+  }
+
+  transport::EventLoop loop(io_uring_config());
+  const transport::UdpEndpoint peer_ep{"127.0.0.1", peer.local_port()};
+  ASSERT_TRUE(loop.add_socket(&server, 1, peer_ep, [](auto, auto, const auto&) {}));
+
+  // Queued from a timer; submitted with the loop's next wait.
+  const std::vector<std::uint8_t> payload{9, 8, 7, 6};
+  loop.schedule_timer(std::chrono::milliseconds(1), [&](utils::TimerId) {
+    std::error_code ec;
+    EXPECT_TRUE(server.send(payload, peer_ep, ec));
+    EXPECT_TRUE(loop.send_packet(server.fd(), payload, peer_ep));
+    loop.schedule_timer(std::chrono::milliseconds(20), [&](utils::TimerId) { loop.stop(); });
+  });
+  loop.run();
+
+  int received = 0;
+  std::error_code ec;
+  peer.drain([&](const transport::UdpPacket& packet) {
+    EXPECT_EQ(packet.data, payload);
+    EXPECT_EQ(packet.remote.port, server.local_port());
+    ++received;
+  }, 16, ec);
+  EXPECT_EQ(received, 2);
+
+  // Once removed, the socket sends synchronously again.
+  EXPECT_TRUE(loop.remove_socket(server.fd()));
+  EXPECT_TRUE(server.send(payload, peer_ep, ec));
+}
+
+TEST_F(IoUringEventLoopTest, ReadableDescriptorsAndWritesUseTheRing) {
+  int in_fds[2];
+  int out_fds[2];
+  ASSERT_EQ(::pipe(in_fds), 0);
+  ASSERT_EQ(::pipe(out_fds), 0);
+
+  transport::EventLoop loop(io_uring_config());
+  const std::vector<std::uint8_t> frame{1, 2, 3, 4, 5};
+  ASSERT_TRUE(loop.add_fd(in_fds[0], [&]() {
+    char byte = 0;
+    EXPECT_EQ(::read(in_fds[0], &byte, 1), 1);
+    EXPECT_TRUE(loop.write_fd(out_fds[1], frame));
+    loop.schedule_timer(std::chrono::milliseconds(10), [&](utils::TimerId) { loop.stop(); });
+  }));
+
+  std::thread writer([&]() {
+    while (!loop.is_running()) {
+      std::this_thread::yield();
+    }
+    const char byte = 1;
+    EXPECT_EQ(::write(in_fds[1], &byte, 1), 1);
+  });
+  loop.run();
+  writer.join();
+
+  std::vector<std::uint8_t> out(16);
+  EXPECT_EQ(::read(out_fds[0], out.data(), out.size()), static_cast<ssize_t>(frame.size()));
+  out.resize(frame.size());
+  EXPECT_EQ(out, frame);
+
+  EXPECT_TRUE(loop.remove_fd(in_fds[0]));
+  for (int fd : {in_fds[0], in_fds[1], out_fds[0], out_fds[1]}) {
+    ::close(fd);
+  }
+}
+
+TEST_F(IoUringEventLoopTest, StopWakesBlockedWait) {
+  transport::EventLoop loop(io_uring_config());
+  std::thread runner([&]() { loop.run(); });
+  while (!loop.is_running()) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  const auto start = std::chrono::steady_clock::now();
+  loop.stop();
+  runner.join();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+}
+
+}  // namespace veil::tests
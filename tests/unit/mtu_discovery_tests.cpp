@@ -1,6 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <chrono>
+#include <string>
+#include <vector>
 
 #include "tun/mtu_discovery.h"
 
@@ -192,4 +195,111 @@ TEST_F(PmtuDiscoveryTest, MultiplePeers) {
   EXPECT_EQ(pmtu.get_mtu("peer3"), 1400);
 }
 
+TEST_F(PmtuDiscoveryTest, SearchProbesLargestSizeFirst) {
+  PmtuDiscovery pmtu(config_, [this]() { return now(); });
+  pmtu.set_probe_limit("peer1", 1472);
+
+  EXPECT_EQ(pmtu.time_until_probe("peer1"), std::chrono::milliseconds(0));
+  EXPECT_EQ(pmtu.next_probe("peer1"), 1472);
+  // Nothing more until the probe is answered or times out.
+  EXPECT_FALSE(pmtu.next_probe("peer1").has_value());
+  EXPECT_EQ(pmtu.time_until_probe("peer1"), config_.probe_timeout);
+
+  pmtu.handle_probe_success("peer1", 1472);
+  EXPECT_EQ(pmtu.get_mtu("peer1"), 1472);
+  EXPECT_FALSE(pmtu.next_probe("peer1").has_value());
+  EXPECT_EQ(pmtu.time_until_probe("peer1"), config_.probe_interval);
+}
+
+TEST_F(PmtuDiscoveryTest, SearchConvergesOnPathMtu) {
+  PmtuDiscovery pmtu(config_, [this]() { return now(); });
+  std::vector<int> changes;
+  pmtu.set_mtu_change_callback([&changes](const std::string&, int, int new_mtu) { changes.push_back(new_mtu); });
+
+  // The path carries up to 1437 bytes; larger probes are dropped.
+  constexpr int kPathMtu = 1437;
+  int probes = 0;
+  while (auto size = pmtu.next_probe("peer1")) {
+    ++probes;
+    ASSERT_LT(probes, 40);
+    if (*size <= kPathMtu) {
+      pmtu.handle_probe_success("peer1", *size);
+    } else {
+      current_time_ += config_.probe_timeout;
+    }
+  }
+
+  EXPECT_LE(pmtu.get_mtu("peer1"), kPathMtu);
+  EXPECT_GT(pmtu.get_mtu("peer1"), kPathMtu - config_.search_granularity);
+  EXPECT_EQ(changes.back(), pmtu.get_mtu("peer1"));
+}
+
+TEST_F(PmtuDiscoveryTest, LostConfirmationFallsBackToInitialMtu) {
+  PmtuDiscovery pmtu(config_, [this]() { return now(); });
+  ASSERT_EQ(pmtu.next_probe("peer1"), config_.max_mtu);
+  pmtu.handle_probe_success("peer1", config_.max_mtu);
+  ASSERT_FALSE(pmtu.next_probe("peer1").has_value());
+
+  // The periodic search first confirms the current size.
+  advance_time(config_.probe_interval);
+  ASSERT_EQ(pmtu.next_probe("peer1"), config_.max_mtu);
+  for (int i = 1; i < config_.max_probes; ++i) {
+    current_time_ += config_.probe_timeout;
+    EXPECT_EQ(pmtu.next_probe("peer1"), config_.max_mtu);
+  }
+
+  // Every attempt is lost: back to the initial MTU, then search below.
+  current_time_ += config_.probe_timeout;
+  const auto next = pmtu.next_probe("peer1");
+  EXPECT_EQ(pmtu.get_mtu("peer1"), config_.initial_mtu);
+  ASSERT_TRUE(next.has_value());
+  EXPECT_GT(*next, config_.initial_mtu);
+  EXPECT_LT(*next, config_.max_mtu);
+}
+
+TEST_F(PmtuDiscoveryTest, SearchFindsPathBelowInitialMtu) {
+  config_.min_mtu = 1232;
+  PmtuDiscovery pmtu(config_, [this]() { return now(); });
+
+  // The path carries only 1300 bytes: the initial MTU itself is lost.
+  constexpr int kPathMtu = 1300;
+  int probes = 0;
+  bool probed_floor = false;
+  while (auto size = pmtu.next_probe("peer1")) {
+    ++probes;
+    ASSERT_LT(probes, 60);
+    probed_floor = probed_floor || *size == config_.min_mtu;
+    if (*size <= kPathMtu) {
+      pmtu.handle_probe_success("peer1", *size);
+    } else {
+      current_time_ += config_.probe_timeout;
+    }
+  }
+
+  EXPECT_TRUE(probed_floor);
+  EXPECT_LE(pmtu.get_mtu("peer1"), kPathMtu);
+  EXPECT_GT(pmtu.get_mtu("peer1"), kPathMtu - config_.search_granularity);
+}
+
+TEST_F(PmtuDiscoveryTest, UnansweredProbesKeepInitialMtu) {
+  config_.min_mtu = 1232;
+  PmtuDiscovery pmtu(config_, [this]() { return now(); });
+  std::vector<int> changes;
+  pmtu.set_mtu_change_callback([&changes](const std::string&, int, int new_mtu) { changes.push_back(new_mtu); });
+
+  // A peer that ignores probes: every one is lost, down to min_mtu.
+  int probes = 0;
+  int smallest = config_.max_mtu;
+  while (auto size = pmtu.next_probe("peer1")) {
+    ASSERT_LT(++probes, 60);
+    smallest = std::min(smallest, *size);
+    current_time_ += config_.probe_timeout;
+  }
+
+  EXPECT_EQ(smallest, config_.min_mtu);
+  EXPECT_EQ(pmtu.get_mtu("peer1"), config_.initial_mtu);
+  EXPECT_TRUE(changes.empty());
+  EXPECT_EQ(pmtu.time_until_probe("peer1"), config_.probe_interval);
+}
+
 }  // namespace veil::tun::test
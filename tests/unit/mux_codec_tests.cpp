@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <cstdint>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "transport/mux/mux_codec.h"
@@ -294,4 +296,185 @@ TEST(MuxCodecTests, EncodeViewToRoundTrip) {
   EXPECT_EQ(buffer, encoded);
 }
 
+// Compact frame format.
+
+TEST(MuxCodecTests, CompactDataFrameRoundTrip) {
+  std::vector<std::uint8_t> payload{9, 8, 7, 6};
+  auto frame = mux::make_data_frame(3, 1000, true, payload);
+  auto encoded = mux::MuxCodec::encode_compact(frame, 1003, true);
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::compact_encoded_size(frame, 1003, true));
+
+  std::size_t consumed = 0;
+  auto decoded = mux::MuxCodec::decode_compact(encoded, 1003, consumed);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(consumed, encoded.size());
+  EXPECT_EQ(decoded->kind, mux::FrameKind::kData);
+  EXPECT_EQ(decoded->data.stream_id, 3U);
+  EXPECT_EQ(decoded->data.sequence, 1000U);
+  EXPECT_TRUE(decoded->data.fin);
+  EXPECT_EQ(decoded->data.payload, payload);
+}
+
+TEST(MuxCodecTests, CompactDataHeaderIsSmall) {
+  // Stream 0, message number close to the packet sequence, last in packet:
+  // a type byte and one byte of message number.
+  auto frame = mux::make_data_frame(0, 500, true, std::vector<std::uint8_t>(60, 0x55));
+  EXPECT_EQ(mux::MuxCodec::compact_encoded_size(frame, 510, true), 2U + 60U);
+  EXPECT_EQ(mux::MuxCodec::encoded_size(frame), mux::MuxCodec::kDataHeaderSize + 60U);
+
+  // Not last in the packet: the payload length is added.
+  EXPECT_EQ(mux::MuxCodec::compact_encoded_size(frame, 510, false), 3U + 60U);
+}
+
+TEST(MuxCodecTests, CompactSequenceReconstructedFromPacketSequence) {
+  const std::vector<std::pair<std::uint64_t, std::uint64_t>> cases{
+      {0, 0},           {255, 256},          {256, 255},        {1000, 70000},
+      {70000, 1000},    {0xFFFFFFFF, 0},     {5, 0xFFFFFFFF},   {0x12345678, 0x12345678 + 200},
+  };
+  for (const auto& [sequence, packet_sequence] : cases) {
+    auto frame = mux::make_data_frame(0, sequence, false, {1});
+    auto encoded = mux::MuxCodec::encode_compact(frame, packet_sequence, true);
+    std::size_t consumed = 0;
+    auto decoded = mux::MuxCodec::decode_compact(encoded, packet_sequence, consumed);
+    ASSERT_TRUE(decoded.has_value()) << sequence << " in packet " << packet_sequence;
+    EXPECT_EQ(decoded->data.sequence, sequence) << "packet " << packet_sequence;
+  }
+}
+
+TEST(MuxCodecTests, CompactFragmentRoundTrip) {
+  const std::uint64_t sequence = (std::uint64_t{77} << 32) | 3;
+  auto frame = mux::make_data_frame(0, sequence, false, {1, 2, 3});
+  auto encoded = mux::MuxCodec::encode_compact(frame, 80, true);
+  EXPECT_EQ(encoded.size(), 1U + 1U + 1U + 3U);
+
+  std::size_t consumed = 0;
+  auto decoded = mux::MuxCodec::decode_compact(encoded, 80, consumed);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->data.sequence, sequence);
+  EXPECT_FALSE(decoded->data.fin);
+}
+
+TEST(MuxCodecTests, CompactAckFrameRoundTrip) {
+  auto frame = mux::make_ack_frame(0, 300, 0);
+  auto encoded = mux::MuxCodec::encode_compact(frame, 10, true);
+  EXPECT_EQ(encoded.size(), 3U);
+
+  std::size_t consumed = 0;
+  auto decoded = mux::MuxCodec::decode_compact(encoded, 10, consumed);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->kind, mux::FrameKind::kAck);
+  EXPECT_EQ(decoded->ack.ack, 300U);
+  EXPECT_EQ(decoded->ack.bitmap, 0U);
+
+  auto with_bitmap = mux::make_ack_frame(1ULL << 40, 5, 0xDEADBEEF);
+  encoded = mux::MuxCodec::encode_compact(with_bitmap, 10, true);
+  decoded = mux::MuxCodec::decode_compact(encoded, 10, consumed);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->ack.stream_id, 1ULL << 40);
+  EXPECT_EQ(decoded->ack.ack, 5U);
+  EXPECT_EQ(decoded->ack.bitmap, 0xDEADBEEFU);
+  EXPECT_EQ(decoded->ack.ack_delay.count(), 0);
+}
+
+TEST(MuxCodecTests, CompactAckFrameCarriesAckDelay) {
+  auto frame = mux::make_ack_frame(0, 300, 0x5, std::chrono::microseconds(1500));
+  auto encoded = mux::MuxCodec::encode_compact(frame, 10, true);
+  // Type, ack varint, bitmap and a two-byte delay varint.
+  EXPECT_EQ(encoded.size(), 9U);
+
+  std::size_t consumed = 0;
+  auto decoded = mux::MuxCodec::decode_compact(encoded, 10, consumed);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->ack.ack, 300U);
+  EXPECT_EQ(decoded->ack.bitmap, 0x5U);
+  EXPECT_EQ(decoded->ack.ack_delay, std::chrono::microseconds(1500));
+
+  // A truncated delay is rejected.
+  encoded.pop_back();
+  EXPECT_FALSE(mux::MuxCodec::decode_compact(encoded, 10, consumed).has_value());
+}
+
+TEST(MuxCodecTests, CompactKeepsLegacyEncodingForControlFrames) {
+  auto frame = mux::make_control_frame(1, {4, 5, 6});
+  EXPECT_EQ(mux::MuxCodec::encode_compact(frame, 0, true), mux::MuxCodec::encode(frame));
+}
+
+TEST(MuxCodecTests, CompactDecodesFramesInSequence) {
+  // Frames that are not last carry their length, so several can share a packet.
+  auto data = mux::make_data_frame(2, 40, false, {1, 2});
+  auto heartbeat = mux::make_heartbeat_frame(123, 4);
+  auto ack = mux::make_ack_frame(0, 39, 1);
+  auto tail = mux::make_data_frame(0, 41, true, {3, 4, 5});
+
+  std::vector<std::uint8_t> packet;
+  for (const auto* frame : {&data, &heartbeat, &ack}) {
+    auto encoded = mux::MuxCodec::encode_compact(*frame, 42, false);
+    packet.insert(packet.end(), encoded.begin(), encoded.end());
+  }
+  auto encoded = mux::MuxCodec::encode_compact(tail, 42, true);
+  packet.insert(packet.end(), encoded.begin(), encoded.end());
+
+  std::vector<mux::MuxFrame> frames;
+  std::span<const std::uint8_t> rest(packet);
+  while (!rest.empty()) {
+    std::size_t consumed = 0;
+    auto frame = mux::MuxCodec::decode_compact(rest, 42, consumed);
+    ASSERT_TRUE(frame.has_value());
+    frames.push_back(std::move(*frame));
+    rest = rest.subspan(consumed);
+  }
+  ASSERT_EQ(frames.size(), 4U);
+  EXPECT_EQ(frames[0].data.sequence, 40U);
+  EXPECT_EQ(frames[0].data.payload, (std::vector<std::uint8_t>{1, 2}));
+  EXPECT_EQ(frames[1].kind, mux::FrameKind::kHeartbeat);
+  EXPECT_EQ(frames[1].heartbeat.timestamp, 123U);
+  EXPECT_EQ(frames[2].ack.ack, 39U);
+  EXPECT_EQ(frames[3].data.sequence, 41U);
+  EXPECT_EQ(frames[3].data.payload, (std::vector<std::uint8_t>{3, 4, 5}));
+}
+
+TEST(MuxCodecTests, RepairFrameRoundTrip) {
+  auto frame = mux::make_repair_frame(1000, 0b1011, 2, 1, {9, 8, 7, 6});
+  auto encoded = mux::MuxCodec::encode(frame);
+  EXPECT_EQ(encoded.size(), mux::MuxCodec::kRepairHeaderSize + 4);
+  auto decoded = mux::MuxCodec::decode(encoded);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->kind, mux::FrameKind::kRepair);
+  EXPECT_EQ(decoded->repair.first_sequence, 1000U);
+  EXPECT_EQ(decoded->repair.source_mask, 0b1011U);
+  EXPECT_EQ(decoded->repair.repair_count, 2U);
+  EXPECT_EQ(decoded->repair.index, 1U);
+  EXPECT_EQ(decoded->repair.symbol, (std::vector<std::uint8_t>{9, 8, 7, 6}));
+
+  // Repair frames keep the legacy layout in compact packets and can share one.
+  auto tail = mux::make_ack_frame(0, 5, 0);
+  auto packet = mux::MuxCodec::encode_compact(frame, 7, false);
+  auto encoded_tail = mux::MuxCodec::encode_compact(tail, 7, true);
+  packet.insert(packet.end(), encoded_tail.begin(), encoded_tail.end());
+  std::size_t consumed = 0;
+  auto first = mux::MuxCodec::decode_compact(packet, 7, consumed);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(consumed, encoded.size());
+  EXPECT_EQ(first->repair.symbol, decoded->repair.symbol);
+  auto second = mux::MuxCodec::decode_compact(std::span(packet).subspan(consumed), 7, consumed);
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->ack.ack, 5U);
+}
+
+TEST(MuxCodecTests, CompactRejectsTruncatedFrames) {
+  auto frame = mux::make_data_frame(1ULL << 20, 1ULL << 40, false, {1, 2, 3});
+  auto encoded = mux::MuxCodec::encode_compact(frame, 0, false);
+  for (std::size_t size = 0; size < encoded.size(); ++size) {
+    std::size_t consumed = 0;
+    EXPECT_FALSE(mux::MuxCodec::decode_compact(std::span(encoded).first(size), 0, consumed).has_value())
+        << "size " << size;
+  }
+}
+
+TEST(MuxCodecTests, CompactEncodeToBufferTooSmall) {
+  auto frame = mux::make_data_frame(0, 1, true, {1, 2, 3});
+  std::vector<std::uint8_t> buffer(mux::MuxCodec::compact_encoded_size(frame, 1, true) - 1);
+  EXPECT_EQ(mux::MuxCodec::encode_compact_to(frame, 1, true, buffer), 0U);
+}
+
 }  // namespace veil::tests
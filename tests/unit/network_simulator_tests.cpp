@@ -0,0 +1,354 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "transport/sim/network_simulator.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+using transport::sim::LinkConfig;
+using transport::sim::NetworkSimulation;
+using transport::sim::SimulatedLink;
+using transport::sim::SimulationConfig;
+using transport::sim::VirtualClock;
+
+namespace {
+
+std::vector<std::uint8_t> make_datagram(std::size_t size, std::uint8_t tag) {
+  return std::vector<std::uint8_t>(size, tag);
+}
+
+SimulationConfig make_config(LinkConfig link) {
+  SimulationConfig config;
+  config.client_to_server_link = link;
+  config.server_to_client_link = link;
+  config.duration = 2s;
+  config.drain = 2s;
+  return config;
+}
+
+}  // namespace
+
+// ========== SimulatedLink ==========
+
+TEST(SimulatedLinkTests, DeliversAfterPropagationAndSerialization) {
+  VirtualClock clock;
+  LinkConfig config;
+  config.bandwidth_bps = 8'000'000;  // 1 byte per microsecond
+  config.delay = 10ms;
+  SimulatedLink link(config, 1);
+
+  ASSERT_TRUE(link.send(make_datagram(1000, 1), clock.now()));
+  ASSERT_TRUE(link.next_arrival().has_value());
+  EXPECT_EQ(*link.next_arrival() - clock.now(), 10ms + 1000us);
+
+  clock.advance(10ms);
+  EXPECT_TRUE(link.receive(clock.now()).empty());
+  clock.advance(1000us);
+  auto delivered = link.receive(clock.now());
+  ASSERT_EQ(delivered.size(), 1U);
+  EXPECT_EQ(delivered[0].size(), 1000U);
+  EXPECT_TRUE(link.empty());
+  EXPECT_EQ(link.stats().packets_delivered, 1U);
+}
+
+TEST(SimulatedLinkTests, BandwidthSpacesBackToBackPackets) {
+  VirtualClock clock;
+  LinkConfig config;
+  config.bandwidth_bps = 8'000'000;
+  config.delay = 0us;
+  SimulatedLink link(config, 1);
+
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(link.send(make_datagram(500, i), clock.now()));
+  }
+  EXPECT_EQ(link.queued_bytes(clock.now()), 2000U);
+
+  // The bottleneck drains one 500-byte packet every 500us, in FIFO order.
+  clock.advance(1000us);
+  auto first = link.receive(clock.now());
+  ASSERT_EQ(first.size(), 2U);
+  EXPECT_EQ(first[0][0], 0);
+  EXPECT_EQ(first[1][0], 1);
+  EXPECT_EQ(link.queued_bytes(clock.now()), 1000U);
+}
+
+TEST(SimulatedLinkTests, TailDropsWhenQueueIsFull) {
+  VirtualClock clock;
+  LinkConfig config;
+  config.bandwidth_bps = 8'000'000;
+  config.queue_limit_bytes = 3000;
+  SimulatedLink link(config, 1);
+
+  int accepted = 0;
+  for (int i = 0; i < 10; ++i) {
+    if (link.send(make_datagram(1000, 0), clock.now())) {
+      ++accepted;
+    }
+  }
+  EXPECT_EQ(accepted, 3);
+  EXPECT_EQ(link.stats().dropped_queue, 7U);
+}
+
+TEST(SimulatedLinkTests, LossRateIsApproximatelyHonoured) {
+  VirtualClock clock;
+  LinkConfig config;
+  config.bandwidth_bps = 0;
+  config.queue_limit_bytes = 0;
+  config.loss_rate = 0.1;
+  SimulatedLink link(config, 42);
+
+  for (int i = 0; i < 10000; ++i) {
+    link.send(make_datagram(100, 0), clock.now());
+  }
+  EXPECT_GT(link.stats().dropped_loss, 800U);
+  EXPECT_LT(link.stats().dropped_loss, 1200U);
+}
+
+TEST(SimulatedLinkTests, ReorderDelaysSomePackets) {
+  VirtualClock clock;
+  LinkConfig config;
+  config.bandwidth_bps = 0;
+  config.delay = 1ms;
+  config.reorder_rate = 0.5;
+  config.reorder_delay = 5ms;
+  SimulatedLink link(config, 7);
+
+  for (std::uint8_t i = 0; i < 20; ++i) {
+    link.send(make_datagram(10, i), clock.now());
+    clock.advance(100us);
+  }
+  clock.advance(10ms);
+  auto delivered = link.receive(clock.now());
+  ASSERT_EQ(delivered.size(), 20U);
+  EXPECT_GT(link.stats().reordered, 0U);
+
+  bool out_of_order = false;
+  for (std::size_t i = 1; i < delivered.size(); ++i) {
+    if (delivered[i][0] < delivered[i - 1][0]) {
+      out_of_order = true;
+    }
+  }
+  EXPECT_TRUE(out_of_order);
+}
+
+TEST(SimulatedLinkTests, SameSeedSameOutcome) {
+  LinkConfig config;
+  config.loss_rate = 0.2;
+  config.jitter = 3ms;
+  config.reorder_rate = 0.1;
+
+  auto run = [&](std::uint64_t seed) {
+    VirtualClock clock;
+    SimulatedLink link(config, seed);
+    std::vector<std::uint8_t> order;
+    for (std::uint8_t i = 0; i < 200; ++i) {
+      link.send(make_datagram(200, i), clock.now());
+      clock.advance(50us);
+    }
+    clock.advance(1s);
+    for (const auto& datagram : link.receive(clock.now())) {
+      order.push_back(datagram[0]);
+    }
+    return order;
+  };
+
+  EXPECT_EQ(run(5), run(5));
+  EXPECT_NE(run(5), run(6));
+}
+
+// ========== NetworkSimulation ==========
+
+TEST(NetworkSimulationTests, SessionPairInteroperates) {
+  auto [client_handshake, server_handshake] = transport::sim::make_session_pair(3);
+  transport::TransportSession client(client_handshake);
+  transport::TransportSession server(server_handshake);
+
+  const std::vector<std::uint8_t> payload{1, 2, 3, 4};
+  auto packets = client.encrypt_data(payload);
+  ASSERT_EQ(packets.size(), 1U);
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, payload);
+}
+
+TEST(NetworkSimulationTests, CleanLinkDeliversEverything) {
+  LinkConfig link;
+  link.bandwidth_bps = 20'000'000;
+  link.delay = 10ms;
+  auto config = make_config(link);
+  config.client_traffic.offered_rate_bps = 2'000'000;
+
+  NetworkSimulation simulation(config);
+  const auto report = simulation.run();
+  const auto& up = report.client_to_server;
+
+  EXPECT_GT(up.messages_sent, 0U);
+  EXPECT_EQ(up.messages_delivered, up.messages_sent);
+  EXPECT_EQ(up.retransmits, 0U);
+  EXPECT_EQ(up.link.dropped_loss + up.link.dropped_queue, 0U);
+  // Uncongested: latency is the one-way delay plus serialization.
+  EXPECT_GE(up.latency_p50, 10ms);
+  EXPECT_LT(up.latency_p99, 15ms);
+  EXPECT_GT(report.server_to_client.acks_sent + up.acks_sent, 0U);
+}
+
+TEST(NetworkSimulationTests, GoodputIsBoundedByBottleneck) {
+  LinkConfig link;
+  link.bandwidth_bps = 5'000'000;
+  link.delay = 5ms;
+  auto config = make_config(link);
+
+  NetworkSimulation simulation(config);
+  const auto report = simulation.run();
+
+  EXPECT_GT(report.client_to_server.goodput_bps, 0.0);
+  EXPECT_LE(report.client_to_server.goodput_bps, 5'000'000.0);
+}
+
+TEST(NetworkSimulationTests, LossCausesRetransmitsOrUndelivered) {
+  LinkConfig link;
+  link.bandwidth_bps = 20'000'000;
+  link.delay = 20ms;
+  link.loss_rate = 0.05;
+  auto config = make_config(link);
+  config.client_traffic.offered_rate_bps = 2'000'000;
+
+  NetworkSimulation simulation(config);
+  const auto report = simulation.run();
+  const auto& up = report.client_to_server;
+
+  EXPECT_GT(up.link.dropped_loss, 0U);
+  EXPECT_TRUE(up.retransmits > 0 || up.messages_delivered < up.messages_sent);
+  EXPECT_LE(up.messages_delivered, up.messages_sent);
+}
+
+TEST(NetworkSimulationTests, DeterministicForSameSeed) {
+  LinkConfig link;
+  link.bandwidth_bps = 10'000'000;
+  link.delay = 15ms;
+  link.jitter = 2ms;
+  link.loss_rate = 0.02;
+  link.reorder_rate = 0.02;
+  auto config = make_config(link);
+  config.client_traffic.offered_rate_bps = 4'000'000;
+  config.server_traffic.message_size = 200;
+  config.server_traffic.offered_rate_bps = 500'000;
+
+  auto run = [&]() {
+    NetworkSimulation simulation(config);
+    return simulation.run();
+  };
+  const auto a = run();
+  const auto b = run();
+
+  EXPECT_EQ(a.client_to_server.messages_delivered, b.client_to_server.messages_delivered);
+  EXPECT_EQ(a.client_to_server.retransmits, b.client_to_server.retransmits);
+  EXPECT_EQ(a.client_to_server.latency_p99, b.client_to_server.latency_p99);
+  EXPECT_EQ(a.server_to_client.messages_delivered, b.server_to_client.messages_delivered);
+  EXPECT_EQ(a.simulated_time, b.simulated_time);
+  EXPECT_EQ(a.steps, b.steps);
+}
+
+TEST(NetworkSimulationTests, LongScenarioRunsOnVirtualTime) {
+  LinkConfig link;
+  link.bandwidth_bps = 10'000'000;
+  link.delay = 40ms;
+  auto config = make_config(link);
+  config.duration = 120s;
+  config.client_traffic.offered_rate_bps = 100'000;
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  NetworkSimulation simulation(config);
+  const auto report = simulation.run();
+  const auto wall_elapsed = std::chrono::steady_clock::now() - wall_start;
+
+  EXPECT_GE(report.simulated_time, 120s);
+  EXPECT_LT(wall_elapsed, 30s);
+  EXPECT_EQ(report.client_to_server.messages_delivered, report.client_to_server.messages_sent);
+}
+
+TEST(NetworkSimulationTests, FecCutsTailLatencyUnderRandomLoss) {
+  LinkConfig link;
+  link.bandwidth_bps = 20'000'000;
+  link.delay = 20ms;
+  link.loss_rate = 0.05;
+  auto config = make_config(link);
+  config.client_traffic.offered_rate_bps = 500'000;
+  config.session_config.fec.adaptive = false;
+  config.session_config.fec.source_count = 4;
+  config.session_config.fec.repair_count = 2;
+
+  NetworkSimulation without_fec(config);
+  const auto baseline = without_fec.run().client_to_server;
+  config.fec = true;
+  NetworkSimulation with_fec(config);
+  const auto protected_run = with_fec.run().client_to_server;
+
+  // Lost packets are rebuilt within a group instead of waiting for a
+  // retransmission timeout, which dominates p99 without FEC.
+  EXPECT_GT(protected_run.fec_repairs_sent, 0U);
+  EXPECT_GT(protected_run.fec_recovered, 0U);
+  EXPECT_GT(baseline.latency_p99, 50ms);
+  EXPECT_LT(protected_run.latency_p99, baseline.latency_p99 / 2);
+  EXPECT_EQ(protected_run.messages_delivered, protected_run.messages_sent);
+}
+
+TEST(NetworkSimulationTests, PrioritySchedulingProtectsInteractiveTraffic) {
+  LinkConfig link;
+  link.bandwidth_bps = 10'000'000;
+  link.delay = 20ms;
+  auto config = make_config(link);
+  config.duration = 5s;
+  // A saturating transfer next to 200-byte messages at 25 per second.
+  config.client_interactive_traffic.message_size = 200;
+  config.client_interactive_traffic.offered_rate_bps = 40'000;
+
+  NetworkSimulation shared_queue(config);
+  const auto baseline = shared_queue.run().client_to_server;
+  config.priority_scheduling = true;
+  NetworkSimulation prioritized(config);
+  const auto scheduled = prioritized.run().client_to_server;
+
+  // In one FIFO the interactive messages wait behind the transfer's backlog;
+  // with priority they only wait for the next opening in the window.
+  EXPECT_GT(baseline.interactive_latency_p99, 200ms);
+  EXPECT_LT(scheduled.interactive_latency_p99, 100ms);
+  EXPECT_EQ(scheduled.interactive_messages_delivered, scheduled.interactive_messages_sent);
+  // The transfer is not starved.
+  EXPECT_GT(scheduled.goodput_bps, baseline.goodput_bps * 0.7);
+}
+
+TEST(NetworkSimulationTests, AckFrequencyThinsAcksInBulkTransfer) {
+  LinkConfig link;
+  link.bandwidth_bps = 50'000'000;
+  link.delay = 10ms;
+  link.loss_rate = 0.01;
+  auto config = make_config(link);
+  config.duration = 5s;
+  config.compact_frames = true;
+  config.session_config.ack_frequency.enabled = false;
+
+  NetworkSimulation fixed(config);
+  const auto baseline = fixed.run().client_to_server;
+  config.session_config.ack_frequency.enabled = true;
+  NetworkSimulation adaptive(config);
+  const auto tuned = adaptive.run().client_to_server;
+
+  // Once in congestion avoidance the receiver ACKs a few times per window
+  // instead of every other packet; losses are still recovered as quickly,
+  // so goodput matches the baseline.
+  EXPECT_GT(adaptive.server_session().stats().ack_frequency_applied, 0U);
+  const auto ack_ratio = [](const transport::sim::DirectionReport& report) {
+    return static_cast<double>(report.acks_sent) / static_cast<double>(report.data_packets_sent);
+  };
+  EXPECT_LT(ack_ratio(tuned), ack_ratio(baseline) / 2);
+  EXPECT_GT(tuned.retransmits, 0U);
+  EXPECT_GE(tuned.goodput_bps, baseline.goodput_bps * 0.97);
+}
+
+}  // namespace veil::tests
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "transport/session/packet_coalescer.h"
+#include "transport/session/transport_session.h"
+#include "transport/sim/network_simulator.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+
+class PacketCoalescerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    steady_now_ = std::chrono::steady_clock::now();
+    // Matching keys, with the frame features a default handshake negotiates.
+    std::tie(client_handshake_, server_handshake_) = transport::sim::make_session_pair(
+        1, handshake::kFeatureCompactFrames | handshake::kFeatureAckDelay);
+  }
+
+  std::function<std::chrono::steady_clock::time_point()> clock() {
+    return [this]() { return steady_now_; };
+  }
+
+  std::chrono::steady_clock::time_point steady_now_;
+  handshake::HandshakeSession client_handshake_;
+  handshake::HandshakeSession server_handshake_;
+};
+
+TEST_F(PacketCoalescerTest, RejectsInvalidConfig) {
+  transport::PacketCoalescerConfig config;
+  config.max_payloads = 0;
+  EXPECT_THROW(transport::PacketCoalescer{config}, std::invalid_argument);
+  config.max_payloads = 8;
+  config.max_delay = std::chrono::microseconds(-1);
+  EXPECT_THROW(transport::PacketCoalescer{config}, std::invalid_argument);
+}
+
+TEST_F(PacketCoalescerTest, FlushSealsQueuedPayloadsIntoOneDatagram) {
+  transport::TransportSession client(client_handshake_, {}, clock());
+  transport::TransportSession server(server_handshake_, {}, clock());
+  transport::PacketCoalescer coalescer({}, clock());
+
+  // Data from the server leaves an ACK pending at the client.
+  auto inbound = server.encrypt_data(std::vector<std::uint8_t>{7});
+  ASSERT_TRUE(client.decrypt_packet(inbound[0]).has_value());
+
+  std::vector<std::vector<std::uint8_t>> payloads;
+  for (std::uint8_t i = 0; i < 5; ++i) {
+    payloads.emplace_back(40 + i, i);
+    EXPECT_FALSE(coalescer.add(payloads.back()));
+  }
+  EXPECT_EQ(coalescer.queued(), 5U);
+  // No delay configured: due at once.
+  ASSERT_TRUE(coalescer.time_until_flush().has_value());
+  EXPECT_EQ(coalescer.time_until_flush()->count(), 0);
+
+  auto datagrams = coalescer.flush(client);
+  ASSERT_EQ(datagrams.size(), 1U);
+  EXPECT_TRUE(coalescer.empty());
+  EXPECT_FALSE(coalescer.time_until_flush().has_value());
+
+  auto frames = server.decrypt_packet(datagrams[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 6U);
+  for (std::size_t i = 0; i < payloads.size(); ++i) {
+    EXPECT_EQ((*frames)[i].data.payload, payloads[i]);
+  }
+  EXPECT_EQ((*frames)[5].kind, mux::FrameKind::kAck);
+  EXPECT_EQ((*frames)[5].ack.ack, 0U);
+
+  EXPECT_EQ(coalescer.stats().payloads, 5U);
+  EXPECT_EQ(coalescer.stats().datagrams, 1U);
+  EXPECT_EQ(client.stats().acks_piggybacked, 1U);
+}
+
+TEST_F(PacketCoalescerTest, AddSignalsWhenADatagramIsFull) {
+  transport::PacketCoalescerConfig config;
+  config.max_datagram_size = 300;
+  config.max_payloads = 100;
+  transport::PacketCoalescer coalescer(config, clock());
+
+  const std::vector<std::uint8_t> payload(100, 0x5A);
+  EXPECT_FALSE(coalescer.add(payload));
+  EXPECT_FALSE(coalescer.add(payload));
+  EXPECT_TRUE(coalescer.add(payload));
+
+  config.max_payloads = 2;
+  transport::PacketCoalescer counted(config, clock());
+  const std::vector<std::uint8_t> tiny{1};
+  EXPECT_FALSE(counted.add(tiny));
+  EXPECT_TRUE(counted.add(tiny));
+}
+
+TEST_F(PacketCoalescerTest, DelayCountsFromOldestPayload) {
+  transport::PacketCoalescerConfig config;
+  config.max_delay = 2ms;
+  transport::PacketCoalescer coalescer(config, clock());
+
+  const std::vector<std::uint8_t> payload{1, 2, 3};
+  coalescer.add(payload);
+  steady_now_ += 500us;
+  coalescer.add(payload);
+  EXPECT_EQ(*coalescer.time_until_flush(), 1500us);
+  steady_now_ += 3ms;
+  EXPECT_EQ(coalescer.time_until_flush()->count(), 0);
+
+  coalescer.clear();
+  EXPECT_FALSE(coalescer.time_until_flush().has_value());
+  coalescer.add(payload);
+  EXPECT_EQ(*coalescer.time_until_flush(), 2ms);
+}
+
+}  // namespace veil::tests
@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+
+#include "transport/session/priority_scheduler.h"
+#include "transport/session/transport_session.h"
+#include "transport/sim/network_simulator.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+// Minimal IPv4 packet of the given total size with a UDP header.
+std::vector<std::uint8_t> make_ipv4(std::size_t size, std::uint8_t dscp, std::uint16_t src_port,
+                                    std::uint8_t protocol = 17) {
+  std::vector<std::uint8_t> packet(size, 0);
+  packet[0] = 0x45;
+  packet[1] = static_cast<std::uint8_t>(dscp << 2);
+  packet[9] = protocol;
+  packet[12] = 10;
+  packet[15] = 2;
+  packet[16] = 93;
+  packet[19] = 7;
+  packet[20] = static_cast<std::uint8_t>(src_port >> 8);
+  packet[21] = static_cast<std::uint8_t>(src_port & 0xFF);
+  packet[23] = 53;
+  return packet;
+}
+
+std::vector<std::uint8_t> make_ipv6(std::size_t size, std::uint8_t dscp) {
+  std::vector<std::uint8_t> packet(size, 0);
+  packet[0] = static_cast<std::uint8_t>(0x60 | (dscp >> 2));
+  packet[1] = static_cast<std::uint8_t>((dscp & 0x03) << 6);
+  packet[6] = 6;
+  return packet;
+}
+
+}  // namespace
+
+class PrioritySchedulerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    steady_now_ = std::chrono::steady_clock::now();
+    // Matching keys, with the frame features a default handshake negotiates.
+    std::tie(client_handshake_, server_handshake_) = transport::sim::make_session_pair(
+        1, handshake::kFeatureCompactFrames | handshake::kFeatureAckDelay);
+  }
+
+  std::function<std::chrono::steady_clock::time_point()> clock() {
+    return [this]() { return steady_now_; };
+  }
+
+  // Stream IDs of the data frames in each datagram, as the server sees them.
+  static std::vector<std::uint64_t> streams_of(transport::TransportSession& server,
+                                               const std::vector<std::vector<std::uint8_t>>& datagrams) {
+    std::vector<std::uint64_t> streams;
+    for (const auto& datagram : datagrams) {
+      auto frames = server.decrypt_packet(datagram);
+      EXPECT_TRUE(frames.has_value());
+      for (const auto& frame : frames.value_or(std::vector<mux::MuxFrame>{})) {
+        if (frame.kind == mux::FrameKind::kData) {
+          streams.push_back(frame.data.stream_id);
+        }
+      }
+    }
+    return streams;
+  }
+
+  std::chrono::steady_clock::time_point steady_now_;
+  handshake::HandshakeSession client_handshake_;
+  handshake::HandshakeSession server_handshake_;
+};
+
+TEST_F(PrioritySchedulerTest, ClassifiesByDscpSizeAndFlowVolume) {
+  transport::TrafficClassifier classifier({}, clock());
+  using transport::TrafficClass;
+
+  EXPECT_EQ(classifier.classify(make_ipv4(1200, 46, 1000)).traffic_class, TrafficClass::kInteractive);  // EF
+  EXPECT_EQ(classifier.classify(make_ipv4(80, 8, 1001)).traffic_class, TrafficClass::kBulk);           // CS1
+  EXPECT_EQ(classifier.classify(make_ipv6(1200, 46)).traffic_class, TrafficClass::kInteractive);
+  EXPECT_EQ(classifier.classify(std::vector<std::uint8_t>{0x00, 0x01}).traffic_class, TrafficClass::kBulk);
+
+  const auto small = classifier.classify(make_ipv4(100, 0, 2000));
+  EXPECT_EQ(small.traffic_class, TrafficClass::kInteractive);
+  EXPECT_EQ(small.stream_id, transport::kInteractiveStreamId);
+
+  // A flow starts out interactive and is demoted once its volume adds up.
+  const auto transfer = make_ipv4(1400, 0, 3000);
+  EXPECT_EQ(classifier.classify(transfer).traffic_class, TrafficClass::kInteractive);
+  for (int i = 0; i < 60; ++i) {
+    classifier.classify(transfer);
+    steady_now_ += 1ms;
+  }
+  const auto demoted = classifier.classify(transfer);
+  EXPECT_EQ(demoted.traffic_class, TrafficClass::kBulk);
+  EXPECT_EQ(demoted.stream_id, transport::kBulkStreamId);
+  // Other flows are unaffected; small packets of the transfer stay interactive.
+  EXPECT_EQ(classifier.classify(make_ipv4(1400, 0, 3001)).traffic_class, TrafficClass::kInteractive);
+  EXPECT_EQ(classifier.classify(make_ipv4(100, 0, 3000)).traffic_class, TrafficClass::kInteractive);
+
+  // The volume decays while the flow is quiet.
+  steady_now_ += 2s;
+  EXPECT_EQ(classifier.classify(transfer).traffic_class, TrafficClass::kInteractive);
+
+  transport::TrafficClassifierConfig config;
+  config.flow_window = 0ms;
+  EXPECT_THROW(transport::TrafficClassifier{config}, std::invalid_argument);
+}
+
+TEST_F(PrioritySchedulerTest, InteractivePayloadJumpsTheCongestionQueue) {
+  transport::TransportSessionConfig session_config;
+  session_config.congestion_config.initial_cwnd = 4 * 1400;
+  session_config.congestion_config.enable_pacing = false;
+  transport::TransportSession client(client_handshake_, session_config, clock());
+  transport::TransportSession server(server_handshake_, {}, clock());
+  transport::PriorityScheduler scheduler;
+
+  const std::vector<std::uint8_t> bulk(1000, 0xB0);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(scheduler.enqueue(bulk, {transport::TrafficClass::kBulk, transport::kBulkStreamId}));
+  }
+  auto first = scheduler.drain(client);
+  ASSERT_FALSE(first.empty());
+  EXPECT_LT(first.size(), 10U);
+  EXPECT_EQ(scheduler.stats().blocked, 1U);
+  const auto waiting = scheduler.queued(transport::TrafficClass::kBulk);
+  EXPECT_EQ(waiting, 10U - first.size());
+
+  // An interactive packet arrives while the window is full.
+  const std::vector<std::uint8_t> ping(60, 0x11);
+  ASSERT_TRUE(scheduler.enqueue(ping, {transport::TrafficClass::kInteractive, transport::kInteractiveStreamId}));
+  EXPECT_TRUE(scheduler.drain(client).empty());
+
+  // The ACK opens the window; the interactive payload goes first.
+  streams_of(server, first);
+  auto ack = server.take_ack_packet(true);
+  ASSERT_TRUE(ack.has_value());
+  auto ack_frames = client.decrypt_packet(*ack);
+  ASSERT_TRUE(ack_frames.has_value());
+  for (const auto& frame : *ack_frames) {
+    if (frame.kind == mux::FrameKind::kAck) {
+      client.process_ack(frame.ack);
+    }
+  }
+  auto second = scheduler.drain(client);
+  ASSERT_FALSE(second.empty());
+  const auto streams = streams_of(server, second);
+  ASSERT_FALSE(streams.empty());
+  EXPECT_EQ(streams.front(), transport::kInteractiveStreamId);
+  EXPECT_EQ(scheduler.queued(transport::TrafficClass::kInteractive), 0U);
+}
+
+TEST_F(PrioritySchedulerTest, WeightKeepsBulkFromStarving) {
+  transport::TransportSessionConfig session_config;
+  session_config.enable_congestion_control = false;
+  transport::TransportSession client(client_handshake_, session_config, clock());
+  transport::TransportSession server(server_handshake_, {}, clock());
+  transport::PrioritySchedulerConfig config;
+  config.interactive_weight = 2;
+  transport::PriorityScheduler scheduler(config);
+
+  // One payload per datagram.
+  const std::vector<std::uint8_t> payload(1000, 0x42);
+  for (int i = 0; i < 3; ++i) {
+    scheduler.enqueue(payload, {transport::TrafficClass::kBulk, transport::kBulkStreamId});
+  }
+  for (int i = 0; i < 5; ++i) {
+    scheduler.enqueue(payload, {transport::TrafficClass::kInteractive, transport::kInteractiveStreamId});
+  }
+  const auto datagrams = scheduler.drain(client);
+  EXPECT_EQ(datagrams.size(), 8U);
+  EXPECT_TRUE(scheduler.empty());
+
+  constexpr auto kI = transport::kInteractiveStreamId;
+  constexpr auto kB = transport::kBulkStreamId;
+  EXPECT_EQ(streams_of(server, datagrams), (std::vector<std::uint64_t>{kI, kI, kB, kI, kI, kB, kI, kB}));
+}
+
+TEST_F(PrioritySchedulerTest, FullQueueDropsOnlyItsClass) {
+  transport::PrioritySchedulerConfig config;
+  config.max_queue_bytes = 2000;
+  transport::PriorityScheduler scheduler(config);
+
+  const std::vector<std::uint8_t> payload(1000, 0x42);
+  const transport::PacketClass bulk{transport::TrafficClass::kBulk, transport::kBulkStreamId};
+  EXPECT_TRUE(scheduler.enqueue(payload, bulk));
+  EXPECT_TRUE(scheduler.enqueue(payload, bulk));
+  EXPECT_FALSE(scheduler.enqueue(payload, bulk));
+  EXPECT_TRUE(scheduler.enqueue(payload, {transport::TrafficClass::kInteractive, transport::kInteractiveStreamId}));
+  EXPECT_EQ(scheduler.queued_bytes(transport::TrafficClass::kBulk), 2000U);
+  EXPECT_EQ(scheduler.stats().dropped[1], 1U);
+  EXPECT_EQ(scheduler.stats().dropped[0], 0U);
+
+  scheduler.clear();
+  EXPECT_TRUE(scheduler.empty());
+  EXPECT_EQ(scheduler.queued_bytes(transport::TrafficClass::kBulk), 0U);
+
+  config.interactive_weight = 0;
+  EXPECT_THROW(transport::PriorityScheduler{config}, std::invalid_argument);
+}
+
+}  // namespace veil::tests
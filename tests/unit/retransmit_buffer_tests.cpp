@@ -162,8 +162,8 @@ TEST(RetransmitBufferTests, RttEstimation) {
   now += 120ms;
   buffer.acknowledge(2);
   // SRTT = (1-0.125)*80 + 0.125*120 = 70 + 15 = 85
-  EXPECT_GE(buffer.estimated_rtt().count(), 80);
-  EXPECT_LE(buffer.estimated_rtt().count(), 90);
+  EXPECT_GE(buffer.estimated_rtt(), 80ms);
+  EXPECT_LE(buffer.estimated_rtt(), 90ms);
 }
 
 TEST(RetransmitBufferTests, KarnsAlgorithm) {
@@ -231,13 +231,127 @@ TEST(RetransmitBufferTests, MinMaxRtoClamping) {
   buffer.insert(1, {1});
   now += 10ms;
   buffer.acknowledge(1);
-  EXPECT_GE(buffer.current_rto().count(), 50);
+  EXPECT_GE(buffer.current_rto(), 50ms);
 
   // With very high RTT simulation, RTO should be capped at max_rto
   buffer.insert(2, {2});
   now += 10000ms;  // Very long delay
   buffer.acknowledge(2);
-  EXPECT_LE(buffer.current_rto().count(), 500);
+  EXPECT_LE(buffer.current_rto(), 500ms);
+}
+
+TEST(RetransmitBufferTests, SubMillisecondRtt) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+
+  buffer.insert(1, {1});
+  now += 300us;
+  buffer.acknowledge(1);
+  EXPECT_EQ(buffer.estimated_rtt(), 300us);
+  EXPECT_EQ(buffer.min_rtt(), 300us);
+
+  buffer.insert(2, {2});
+  now += 500us;
+  buffer.acknowledge(2);
+  // SRTT = 0.875 * 300 + 0.125 * 500 = 325
+  EXPECT_EQ(buffer.estimated_rtt(), 325us);
+  EXPECT_EQ(buffer.latest_rtt(), 500us);
+}
+
+TEST(RetransmitBufferTests, AckDelayCompensation) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+
+  buffer.insert(1, {1});
+  now += 20ms;
+  buffer.acknowledge(1);
+  EXPECT_EQ(buffer.estimated_rtt(), 20ms);
+
+  // The peer held the ACK for 10ms: the path RTT is still 20ms.
+  buffer.insert(2, {2});
+  now += 30ms;
+  buffer.acknowledge(2, 10ms);
+  EXPECT_EQ(buffer.estimated_rtt(), 20ms);
+  EXPECT_EQ(buffer.latest_rtt(), 30ms);
+
+  // A delay that would take the sample below min_rtt is ignored.
+  buffer.insert(3, {3});
+  now += 22ms;
+  buffer.acknowledge(3, 10ms);
+  EXPECT_EQ(buffer.estimated_rtt(), 20250us);
+
+  // The reported delay is trusted only up to the peer's maximum.
+  buffer.set_peer_max_ack_delay(5ms);
+  buffer.insert(4, {4});
+  now += 30ms;
+  buffer.acknowledge(4, 10ms);
+  // SRTT = 0.875 * 20250 + 0.125 * 25000
+  EXPECT_EQ(buffer.estimated_rtt(), 20843us);
+}
+
+TEST(RetransmitBufferTests, MinRttWindow) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.min_rtt_window = 10s;
+  mux::RetransmitBuffer buffer(config, now_fn);
+
+  buffer.insert(1, {1});
+  now += 20ms;
+  buffer.acknowledge(1);
+  buffer.insert(2, {2});
+  now += 40ms;
+  buffer.acknowledge(2);
+  EXPECT_EQ(buffer.min_rtt(), 20ms);
+
+  // The path got longer; once the old minimum ages out it is replaced.
+  now += 10s;
+  buffer.insert(3, {3});
+  now += 40ms;
+  buffer.acknowledge(3);
+  EXPECT_EQ(buffer.min_rtt(), 40ms);
+}
+
+TEST(RetransmitBufferTests, RtoCoversPeerAckDelay) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitConfig config;
+  config.min_rto = 1ms;
+  mux::RetransmitBuffer buffer(config, now_fn);
+
+  buffer.insert(1, {1});
+  now += 2ms;
+  buffer.acknowledge(1);
+  // SRTT + 4 * RTTVAR = 2ms + 4ms
+  EXPECT_EQ(buffer.current_rto(), 6ms);
+
+  buffer.set_peer_max_ack_delay(20ms);
+  EXPECT_EQ(buffer.current_rto(), 26ms);
+}
+
+TEST(RetransmitBufferTests, OnlySampledAcksUpdateRtt) {
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  mux::RetransmitBuffer buffer({}, now_fn);
+
+  buffer.insert(1, {1});
+  buffer.insert(2, {2});
+  buffer.insert(3, {3});
+  now += 50ms;
+  EXPECT_TRUE(buffer.acknowledge_without_sample(1));
+  buffer.acknowledge_cumulative(2);
+  EXPECT_FALSE(buffer.has_rtt_sample());
+  EXPECT_EQ(buffer.stats().packets_acked, 2U);
+
+  buffer.acknowledge(3);
+  EXPECT_EQ(buffer.estimated_rtt(), 50ms);
 }
 
 }  // namespace veil::tests
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
+#include <string>
 #include <system_error>
+#include <vector>
 
 #ifndef _WIN32
 #include <unistd.h>
@@ -22,6 +24,15 @@ TEST_F(RoutingUnitTest, NatConfigDefaults) {
   EXPECT_TRUE(config.enable_forwarding);
   EXPECT_TRUE(config.use_masquerade);
   EXPECT_TRUE(config.snat_source.empty());
+  EXPECT_EQ(config.backend, NatBackend::kAuto);
+}
+
+TEST_F(RoutingUnitTest, ParseNatBackend) {
+  EXPECT_EQ(parse_nat_backend("auto"), NatBackend::kAuto);
+  EXPECT_EQ(parse_nat_backend("nftables"), NatBackend::kNftables);
+  EXPECT_EQ(parse_nat_backend("iptables"), NatBackend::kIptables);
+  EXPECT_FALSE(parse_nat_backend("nft").has_value());
+  EXPECT_FALSE(parse_nat_backend("").has_value());
 }
 
 TEST_F(RoutingUnitTest, NatConfigCustomSubnet) {
@@ -121,6 +132,76 @@ TEST_F(RoutingIntegrationTest, AddAndRemoveRoute) {
   EXPECT_TRUE(removed) << "Failed to remove route: " << ec.message();
 }
 
+TEST_F(RoutingIntegrationTest, AddRoutesInBatches) {
+  RouteManager manager;
+
+  // 1000 /32 routes in 198.18.0.0/15 (RFC 2544 benchmarking range) on lo.
+  std::vector<Route> routes(1000);
+  for (std::size_t i = 0; i < routes.size(); ++i) {
+    routes[i].destination = "198.18." + std::to_string(i / 256) + "." + std::to_string(i % 256);
+    routes[i].netmask = "255.255.255.255";
+    routes[i].interface = "lo";
+  }
+  std::vector<std::error_code> results;
+  if (!manager.add_routes(routes, results)) {
+    GTEST_SKIP() << "Failed to add routes: " << results.front().message();
+  }
+  ASSERT_EQ(results.size(), routes.size());
+
+  std::error_code ec;
+  EXPECT_TRUE(manager.route_exists(routes.front(), ec));
+  EXPECT_TRUE(manager.route_exists(routes.back(), ec));
+
+  // Adding one again fails for that route only.
+  std::vector<Route> again{routes[7], Route{"198.19.0.0", "255.255.255.0", "", "lo", 0}};
+  EXPECT_FALSE(manager.add_routes(again, results));
+  ASSERT_EQ(results.size(), 2U);
+  EXPECT_EQ(results[0], std::errc::file_exists);
+  EXPECT_FALSE(results[1]) << results[1].message();
+
+  // Invalid routes are reported without affecting the rest.
+  std::vector<Route> invalid{Route{"198.18.300.1", "", "", "lo", 0}, Route{"198.19.1.0/24", "", "", "lo", 0}};
+  EXPECT_FALSE(manager.add_routes(invalid, results));
+  EXPECT_EQ(results[0], std::errc::invalid_argument);
+  EXPECT_FALSE(results[1]) << results[1].message();
+
+  manager.cleanup();
+  EXPECT_FALSE(manager.route_exists(routes.front(), ec));
+  EXPECT_FALSE(manager.route_exists(routes.back(), ec));
+  EXPECT_FALSE(manager.route_exists(Route{"198.19.1.0/24", "", "", "lo", 0}, ec));
+}
+
+#ifndef _WIN32
+TEST_F(RoutingIntegrationTest, NftablesNatRuleset) {
+  RouteManager manager;
+  std::error_code ec;
+
+  NatConfig config;
+  config.internal_interface = "veil-test0";
+  config.external_interface = "lo";
+  config.vpn_subnet = "10.99.0.0/24";
+  config.enable_forwarding = false;
+  config.backend = NatBackend::kNftables;
+
+  if (!manager.configure_nat(config, ec)) {
+    GTEST_SKIP() << "nf_tables unavailable: " << ec.message();
+  }
+  // Configuring again replaces the table instead of duplicating rules.
+  EXPECT_TRUE(manager.configure_nat(config, ec)) << ec.message();
+
+  config.use_masquerade = false;
+  config.snat_source = "192.0.2.1";
+  EXPECT_TRUE(manager.configure_nat(config, ec)) << ec.message();
+
+  // An SNAT source that is not an address is rejected before anything is sent.
+  config.snat_source = "not-an-address";
+  EXPECT_FALSE(manager.configure_nat(config, ec));
+  EXPECT_EQ(ec, std::errc::invalid_argument);
+
+  EXPECT_TRUE(manager.remove_nat(config, ec)) << ec.message();
+}
+#endif
+
 TEST_F(RoutingIntegrationTest, NatConfigWithMissingTools) {
   // This test verifies that configure_nat fails gracefully when iptables is not available.
   // We can't easily test this without mocking, so we'll just ensure the function
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "server/session_deadlines.h"
+
+namespace veil::server::test {
+
+using namespace std::chrono_literals;
+
+class SessionDeadlinesTest : public ::testing::Test {
+ protected:
+  void SetUp() override { now_ = SessionDeadlines::Clock::now(); }
+
+  SessionDeadlines::TimePoint now_;
+  SessionDeadlines deadlines_;
+};
+
+TEST_F(SessionDeadlinesTest, TakeDueReturnsExpiredSessionsInOrder) {
+  EXPECT_TRUE(deadlines_.empty());
+  EXPECT_FALSE(deadlines_.next_deadline().has_value());
+
+  deadlines_.schedule(3, now_ + 30ms);
+  deadlines_.schedule(1, now_ + 10ms);
+  deadlines_.schedule(2, now_ + 20ms);
+  EXPECT_EQ(deadlines_.size(), 3U);
+  EXPECT_EQ(deadlines_.next_deadline(), now_ + 10ms);
+
+  EXPECT_TRUE(deadlines_.take_due(now_).empty());
+  EXPECT_EQ(deadlines_.take_due(now_ + 20ms), (std::vector<std::uint64_t>{1, 2}));
+  // Taken sessions are unregistered until scheduled again.
+  EXPECT_EQ(deadlines_.size(), 1U);
+  EXPECT_FALSE(deadlines_.deadline_of(1).has_value());
+  EXPECT_EQ(deadlines_.next_deadline(), now_ + 30ms);
+}
+
+TEST_F(SessionDeadlinesTest, MovedAndCancelledDeadlinesAreSkipped) {
+  deadlines_.schedule(1, now_ + 10ms);
+  deadlines_.schedule(2, now_ + 20ms);
+  deadlines_.schedule(1, now_ + 50ms);  // Moved later.
+  deadlines_.schedule(3, now_ + 40ms);
+  deadlines_.schedule(3, now_ + 5ms);  // Moved earlier.
+  deadlines_.cancel(2);
+
+  EXPECT_EQ(deadlines_.size(), 2U);
+  EXPECT_EQ(deadlines_.deadline_of(1), now_ + 50ms);
+  EXPECT_EQ(deadlines_.next_deadline(), now_ + 5ms);
+  EXPECT_EQ(deadlines_.take_due(now_ + 45ms), (std::vector<std::uint64_t>{3}));
+  EXPECT_EQ(deadlines_.next_deadline(), now_ + 50ms);
+  EXPECT_EQ(deadlines_.take_due(now_ + 50ms), (std::vector<std::uint64_t>{1}));
+  EXPECT_TRUE(deadlines_.empty());
+  EXPECT_FALSE(deadlines_.next_deadline().has_value());
+
+  // A session cancelled and scheduled again at the same time is taken once.
+  deadlines_.schedule(4, now_ + 10ms);
+  deadlines_.cancel(4);
+  deadlines_.schedule(4, now_ + 10ms);
+  EXPECT_EQ(deadlines_.take_due(now_ + 10ms), (std::vector<std::uint64_t>{4}));
+}
+
+TEST_F(SessionDeadlinesTest, IdleSessionsAreNotVisited) {
+  // 10k idle sessions due in five minutes, 10 active ones due every 10ms.
+  constexpr std::uint64_t kIdle = 10000;
+  for (std::uint64_t id = 100; id < 100 + kIdle; ++id) {
+    deadlines_.schedule(id, now_ + 300s);
+  }
+  for (std::uint64_t id = 0; id < 10; ++id) {
+    deadlines_.schedule(id, now_ + 10ms);
+  }
+
+  auto now = now_;
+  for (std::uint64_t tick = 0; tick < 1000; ++tick) {
+    now += 10ms;
+    const auto due = deadlines_.take_due(now);
+    ASSERT_EQ(due.size(), 10U);
+    for (const auto id : due) {
+      EXPECT_LT(id, 10U);
+      deadlines_.schedule(id, now + 10ms);
+    }
+    // Active sessions also move their deadlines between expiries.
+    deadlines_.schedule(tick % 10, now + 5ms);
+    deadlines_.schedule(tick % 10, now + 10ms);
+  }
+  EXPECT_EQ(deadlines_.size(), kIdle + 10);
+  EXPECT_EQ(deadlines_.next_deadline(), now + 10ms);
+  EXPECT_EQ(deadlines_.take_due(now_ + 300s).size(), kIdle + 10);
+}
+
+}  // namespace veil::server::test
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "server/session_table.h"
+#include "transport/sim/network_simulator.h"
+
+namespace veil::server::test {
+
+using namespace std::chrono_literals;
+
+namespace {
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+constexpr bool kHeapStatsAvailable = true;
+std::size_t heap_in_use() { return mallinfo2().uordblks; }
+#else
+constexpr bool kHeapStatsAvailable = false;
+std::size_t heap_in_use() { return 0; }
+#endif
+
+// Heap budget per session in the session table, well inside 50 MB per 1000
+// sessions. Buffers are allocated on first use, so an idle session holds
+// only its fixed state.
+constexpr std::size_t kIdleBudget = 6 * 1024;
+// Active sessions also keep received-packet state for ACKs and reordering.
+constexpr std::size_t kActiveBudget = 8 * 1024;
+// Hibernated sessions keep a HibernatedSession and their index entries.
+constexpr std::size_t kHibernatedBudget = 512;
+
+// Deliver every datagram to the receiving session, acting on its ACKs.
+void deliver(const std::vector<std::vector<std::uint8_t>>& datagrams, transport::TransportSession& to) {
+  for (const auto& datagram : datagrams) {
+    auto frames = to.decrypt_packet(datagram);
+    ASSERT_TRUE(frames.has_value());
+    for (const auto& frame : *frames) {
+      if (frame.kind == mux::FrameKind::kAck) {
+        to.process_ack(frame.ack);
+      }
+    }
+  }
+}
+
+}  // namespace
+
+class SessionMemoryTest : public ::testing::TestWithParam<std::size_t> {
+ protected:
+  void SetUp() override {
+    if (!kHeapStatsAvailable) {
+      GTEST_SKIP() << "Heap statistics need glibc 2.33 or newer";
+    }
+    current_time_ = std::chrono::steady_clock::now();
+  }
+
+  // Heap bytes per session after adding `count` sessions. With `active`,
+  // each session first exchanges data both ways with a client until
+  // everything is acknowledged; the client is discarded afterwards. With
+  // `hibernate`, the sessions are then left idle until they hibernate.
+  std::size_t bytes_per_session(std::size_t count, bool active, bool hibernate = false) {
+    // The tunnel IP pool is allocated up front; it does not grow per session.
+    const auto clock = [this]() { return current_time_; };
+    SessionTable table(count, 300s, "10.8.0.2", "10.8.255.254", clock);
+    table.set_hibernate_after(60s);
+    const std::vector<std::uint8_t> payload(1200, 0x5A);
+
+    std::vector<std::pair<handshake::HandshakeSession, handshake::HandshakeSession>> handshakes;
+    handshakes.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+      handshakes.push_back(transport::sim::make_session_pair(i));
+    }
+
+    const auto before = heap_in_use();
+    for (std::size_t i = 0; i < count; ++i) {
+      auto server = std::make_unique<transport::TransportSession>(handshakes[i].second,
+                                                                   transport::TransportSessionConfig{}, clock);
+      if (active) {
+        transport::TransportSession client(handshakes[i].first, transport::TransportSessionConfig{}, clock);
+        deliver(server->encrypt_data(payload), client);
+        deliver(client.encrypt_data(payload), *server);
+        // Let the delayed ACKs come due.
+        current_time_ += 1s;
+        for (auto* from : {server.get(), &client}) {
+          if (auto ack = from->take_ack_packet()) {
+            deliver({*ack}, from == &client ? *server : client);
+          }
+        }
+        EXPECT_EQ(server->bytes_in_flight(), 0U);
+        EXPECT_EQ(client.bytes_in_flight(), 0U);
+      }
+      const auto port = static_cast<std::uint16_t>(10000 + i % 50000);
+      const transport::UdpEndpoint endpoint{"192.168.1.100", port};
+      EXPECT_TRUE(table.create_session(endpoint, std::move(server)).has_value());
+    }
+    if (hibernate) {
+      current_time_ += 60s;
+      for (std::uint64_t session_id = 1; session_id <= count; ++session_id) {
+        EXPECT_TRUE(table.hibernate_if_idle(session_id));
+      }
+    }
+    const auto after = heap_in_use();
+    EXPECT_EQ(table.session_count() + table.hibernated_count(), count);
+    return after > before ? (after - before) / count : 0;
+  }
+
+  std::chrono::steady_clock::time_point current_time_;
+};
+
+TEST_P(SessionMemoryTest, IdleSessionsStayWithinBudget) {
+  const auto per_session = bytes_per_session(GetParam(), false);
+  RecordProperty("bytes_per_idle_session", static_cast<int>(per_session));
+  EXPECT_GT(per_session, 0U);
+  EXPECT_LE(per_session, kIdleBudget);
+}
+
+TEST_P(SessionMemoryTest, ActiveSessionsStayWithinBudget) {
+  const auto per_session = bytes_per_session(GetParam(), true);
+  RecordProperty("bytes_per_active_session", static_cast<int>(per_session));
+  EXPECT_GT(per_session, 0U);
+  EXPECT_LE(per_session, kActiveBudget);
+}
+
+TEST_P(SessionMemoryTest, HibernatedSessionsStayWithinBudget) {
+  const auto per_session = bytes_per_session(GetParam(), true, true);
+  RecordProperty("bytes_per_hibernated_session", static_cast<int>(per_session));
+  EXPECT_GT(per_session, 0U);
+  EXPECT_LE(per_session, kHibernatedBudget);
+}
+
+INSTANTIATE_TEST_SUITE_P(SessionCounts, SessionMemoryTest, ::testing::Values(1000, 10000));
+
+}  // namespace veil::server::test
@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <vector>
 
 #include "server/session_table.h"
+#include "transport/sim/network_simulator.h"
 
 namespace veil::server::test {
 
@@ -20,6 +24,19 @@ class SessionTableTest : public ::testing::Test {
   TimePoint current_time_;
 };
 
+namespace {
+
+// IPv4 header with the given addresses.
+std::vector<std::uint8_t> ipv4_packet(std::array<std::uint8_t, 4> source, std::array<std::uint8_t, 4> destination) {
+  std::vector<std::uint8_t> packet(20, 0);
+  packet[0] = 0x45;
+  std::copy(source.begin(), source.end(), packet.begin() + 12);
+  std::copy(destination.begin(), destination.end(), packet.begin() + 16);
+  return packet;
+}
+
+}  // namespace
+
 TEST_F(SessionTableTest, CreateSession) {
   SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
                      [this]() { return now(); });
@@ -141,6 +158,36 @@ TEST_F(SessionTableTest, CleanupExpired) {
   EXPECT_EQ(table.stats().sessions_timed_out, 1u);
 }
 
+TEST_F(SessionTableTest, ExpireIfIdleChecksOneSession) {
+  SessionTable table(10, std::chrono::seconds(60), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+
+  auto idle_id = table.create_session(transport::UdpEndpoint{"192.168.1.100", 12345},
+                                      std::make_unique<transport::TransportSession>(
+                                          transport::sim::make_session_pair(1).second,
+                                          transport::TransportSessionConfig{}));
+  auto active_id = table.create_session(transport::UdpEndpoint{"192.168.1.100", 12346},
+                                        std::make_unique<transport::TransportSession>(
+                                            transport::sim::make_session_pair(2).second,
+                                            transport::TransportSessionConfig{}));
+  ASSERT_TRUE(idle_id.has_value());
+  ASSERT_TRUE(active_id.has_value());
+
+  advance_time(std::chrono::seconds(30));
+  EXPECT_FALSE(table.expire_if_idle(*idle_id));
+  table.update_activity(*active_id);
+
+  advance_time(std::chrono::seconds(31));
+  EXPECT_FALSE(table.expire_if_idle(*active_id));
+  EXPECT_TRUE(table.expire_if_idle(*idle_id));
+  EXPECT_FALSE(table.expire_if_idle(*idle_id));
+  EXPECT_EQ(table.find_by_id(*idle_id), nullptr);
+  EXPECT_NE(table.find_by_id(*active_id), nullptr);
+  EXPECT_EQ(table.stats().sessions_timed_out, 1u);
+  EXPECT_EQ(table.stats().active_sessions, 1u);
+  EXPECT_EQ(table.session_timeout(), std::chrono::seconds(60));
+}
+
 TEST_F(SessionTableTest, UpdateActivity) {
   SessionTable table(10, std::chrono::seconds(60), "10.8.0.2", "10.8.0.10",
                      [this]() { return now(); });
@@ -263,4 +310,257 @@ TEST_F(SessionTableTest, Statistics) {
   EXPECT_EQ(table.stats().sessions_timed_out, 1u);
 }
 
+TEST_F(SessionTableTest, FindByConnectionId) {
+  SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+
+  auto first = std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(1).second);
+  auto second = std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(2).second);
+  const auto first_cid = first->connection_id();
+  const auto second_cid = second->connection_id();
+  ASSERT_NE(first_cid, second_cid);
+
+  auto first_id = table.create_session({"192.168.1.100", 12345}, std::move(first));
+  auto second_id = table.create_session({"192.168.1.101", 12345}, std::move(second));
+  ASSERT_TRUE(first_id.has_value());
+  ASSERT_TRUE(second_id.has_value());
+
+  auto* session = table.find_by_connection_id(first_cid);
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(session->session_id, *first_id);
+  EXPECT_EQ(session->connection_id, first_cid);
+  ASSERT_NE(table.find_by_connection_id(second_cid), nullptr);
+  EXPECT_EQ(table.find_by_connection_id(second_cid)->session_id, *second_id);
+  EXPECT_EQ(table.find_by_connection_id(first_cid ^ second_cid ^ 1), nullptr);
+
+  table.remove_session(*first_id);
+  EXPECT_EQ(table.find_by_connection_id(first_cid), nullptr);
+}
+
+TEST_F(SessionTableTest, UpdateEndpointMovesSessionInPlace) {
+  SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+
+  transport::UdpEndpoint old_endpoint{"192.168.1.100", 12345};
+  transport::UdpEndpoint new_endpoint{"203.0.113.7", 40000};
+  auto transport = std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(1).second);
+  const auto cid = transport->connection_id();
+  auto session_id = table.create_session(old_endpoint, std::move(transport));
+  ASSERT_TRUE(session_id.has_value());
+  const auto tunnel_ip = table.find_by_id(*session_id)->tunnel_ip;
+
+  EXPECT_TRUE(table.update_endpoint(*session_id, new_endpoint));
+
+  EXPECT_EQ(table.find_by_endpoint(old_endpoint), nullptr);
+  auto* session = table.find_by_endpoint(new_endpoint);
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(session->session_id, *session_id);
+  EXPECT_EQ(session->endpoint.host, new_endpoint.host);
+  EXPECT_EQ(session->endpoint.port, new_endpoint.port);
+  EXPECT_EQ(session->tunnel_ip, tunnel_ip);
+  EXPECT_EQ(table.find_by_connection_id(cid), session);
+  EXPECT_EQ(table.stats().sessions_migrated, 1u);
+
+  // Same endpoint again is a no-op; unknown sessions are rejected.
+  EXPECT_TRUE(table.update_endpoint(*session_id, new_endpoint));
+  EXPECT_EQ(table.stats().sessions_migrated, 1u);
+  EXPECT_FALSE(table.update_endpoint(*session_id + 100, old_endpoint));
+}
+
+TEST_F(SessionTableTest, RebindingClientFoundByConnectionId) {
+  SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+
+  // Server and client sides of the same session (mirrored keys).
+  const auto [client_hs, server_hs] = transport::sim::make_session_pair(1);
+  transport::TransportSession client(client_hs);
+
+  auto session_id = table.create_session({"192.168.1.100", 12345},
+                                         std::make_unique<transport::TransportSession>(server_hs));
+  ASSERT_TRUE(session_id.has_value());
+
+  // After NAT rebinding the packet arrives from a new port; no handshake is needed.
+  std::vector<std::uint8_t> payload{0x45, 0x00, 0x00, 0x14};
+  auto packets = client.encrypt_data(payload);
+  ASSERT_EQ(packets.size(), 1u);
+  auto cid = transport::TransportSession::peek_connection_id(packets[0]);
+  ASSERT_TRUE(cid.has_value());
+  auto* session = table.find_by_connection_id(*cid);
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(session->session_id, *session_id);
+
+  auto frames = session->transport->decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  EXPECT_TRUE(session->transport->last_packet_advanced());
+  EXPECT_TRUE(table.update_endpoint(session->session_id, {"192.168.1.100", 23456}));
+  EXPECT_EQ(table.find_by_endpoint({"192.168.1.100", 23456}), session);
+}
+
+TEST_F(SessionTableTest, IdleSessionHibernatesAndResumes) {
+  EXPECT_LT(sizeof(HibernatedSession), 200U);
+
+  SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+  table.set_hibernate_after(std::chrono::seconds(60));
+
+  const auto [client_hs, server_hs] = transport::sim::make_session_pair(1);
+  transport::TransportSession client(client_hs, {}, [this]() { return now(); });
+
+  auto session_id = table.create_session({"192.168.1.100", 12345},
+                                         std::make_unique<transport::TransportSession>(
+                                             server_hs, transport::TransportSessionConfig{}, [this]() { return now(); }));
+  ASSERT_TRUE(session_id.has_value());
+  const auto tunnel_ip = table.find_by_id(*session_id)->tunnel_ip;
+
+  // Not idle long enough yet.
+  advance_time(std::chrono::seconds(59));
+  EXPECT_FALSE(table.hibernate_if_idle(*session_id));
+  advance_time(std::chrono::seconds(1));
+  ASSERT_TRUE(table.hibernate_if_idle(*session_id));
+  EXPECT_EQ(table.find_by_id(*session_id), nullptr);
+  EXPECT_EQ(table.session_count(), 0U);
+  EXPECT_EQ(table.hibernated_count(), 1U);
+  EXPECT_EQ(table.hibernated_expiry(*session_id), now() + std::chrono::seconds(240));
+
+  // The client's next packet finds it by connection ID, with no handshake.
+  std::vector<std::uint8_t> payload{0x45, 0x00, 0x00, 0x14};
+  auto packets = client.encrypt_data(payload);
+  auto cid = transport::TransportSession::peek_connection_id(packets[0]);
+  ASSERT_TRUE(cid.has_value());
+  EXPECT_EQ(table.find_by_connection_id(*cid), nullptr);
+
+  // A forged packet with the right connection ID neither wakes the session
+  // nor extends its life.
+  auto forged = packets[0];
+  forged.back() ^= 0x01;
+  advance_time(std::chrono::seconds(10));
+  EXPECT_EQ(table.resume_by_packet(forged, {}), nullptr);
+  EXPECT_EQ(table.hibernated_count(), 1U);
+  EXPECT_EQ(table.hibernated_expiry(*session_id), now() + std::chrono::seconds(230));
+
+  auto* session = table.resume_by_packet(packets[0], {});
+  ASSERT_NE(session, nullptr);
+  EXPECT_EQ(session->session_id, *session_id);
+  EXPECT_EQ(session->tunnel_ip, tunnel_ip);
+  EXPECT_EQ(table.find_by_endpoint({"192.168.1.100", 12345}), session);
+  ASSERT_TRUE(session->transport->decrypt_packet(packets[0]).has_value());
+  EXPECT_EQ(table.stats().sessions_resumed, 1U);
+
+  // Traffic from the TUN device wakes it as well.
+  ASSERT_TRUE(table.hibernate(*session_id));
+  EXPECT_EQ(table.find_by_tunnel_ip(tunnel_ip), nullptr);
+  session = table.resume_by_tunnel_ip(tunnel_ip, {});
+  ASSERT_NE(session, nullptr);
+  auto reply = client.decrypt_packet(session->transport->encrypt_data(payload)[0]);
+  ASSERT_TRUE(reply.has_value());
+
+  // A replayed packet authenticates but was already received.
+  ASSERT_TRUE(table.hibernate(*session_id));
+  EXPECT_EQ(table.resume_by_packet(packets[0], {}), nullptr);
+  session = table.resume_by_tunnel_ip(tunnel_ip, {});
+  ASSERT_NE(session, nullptr);
+
+  // A hibernated session still times out, releasing its IP and indices.
+  ASSERT_TRUE(table.hibernate(*session_id));
+  advance_time(std::chrono::seconds(300));
+  EXPECT_TRUE(table.expire_if_idle(*session_id));
+  EXPECT_EQ(table.hibernated_count(), 0U);
+  EXPECT_EQ(table.resume_by_packet(client.encrypt_data(payload)[0], {}), nullptr);
+  EXPECT_EQ(table.resume_by_tunnel_ip(tunnel_ip, {}), nullptr);
+  EXPECT_FALSE(table.hibernated_expiry(*session_id).has_value());
+}
+
+TEST_F(SessionTableTest, BusySessionDoesNotHibernate) {
+  SessionTable table(2, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+  EXPECT_FALSE(table.hibernate_if_idle(1));
+
+  auto id = table.create_session({"192.168.1.100", 12345},
+                                 std::make_unique<transport::TransportSession>(
+                                     transport::sim::make_session_pair(1).second, transport::TransportSessionConfig{},
+                                     [this]() { return now(); }));
+  ASSERT_TRUE(id.has_value());
+  advance_time(std::chrono::seconds(120));
+  // Hibernation is off by default.
+  EXPECT_FALSE(table.hibernate_if_idle(*id));
+
+  // Unacknowledged data keeps a session awake.
+  table.set_hibernate_after(std::chrono::seconds(60));
+  auto* session = table.find_by_id(*id);
+  ASSERT_FALSE(session->transport->encrypt_data(std::vector<std::uint8_t>{1, 2, 3}).empty());
+  EXPECT_FALSE(table.hibernate_if_idle(*id));
+  EXPECT_EQ(table.find_by_id(*id), session);
+}
+
+TEST_F(SessionTableTest, FullTableDropsLongestHibernatedSession) {
+  SessionTable table(2, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+  table.set_hibernate_after(std::chrono::seconds(60));
+  const auto add = [&](std::uint16_t port) {
+    return table.create_session({"192.168.1.100", port},
+                                std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(port).second));
+  };
+
+  auto first = add(1000);
+  advance_time(std::chrono::seconds(10));
+  auto second = add(1001);
+  ASSERT_TRUE(first && second);
+  advance_time(std::chrono::seconds(60));
+  ASSERT_TRUE(table.hibernate_if_idle(*first));
+  ASSERT_TRUE(table.hibernate_if_idle(*second));
+  EXPECT_TRUE(table.is_full());
+
+  auto third = add(1002);
+  ASSERT_TRUE(third.has_value());
+  EXPECT_FALSE(table.hibernated_expiry(*first).has_value());
+  EXPECT_TRUE(table.hibernated_expiry(*second).has_value());
+
+  // Active sessions are never dropped to make room.
+  EXPECT_TRUE(add(1003).has_value());
+  EXPECT_EQ(table.hibernated_count(), 0U);
+  EXPECT_FALSE(add(1004).has_value());
+}
+
+TEST_F(SessionTableTest, ClientRoutesAndSourceValidation) {
+  SessionTable table(10, std::chrono::seconds(300), "10.8.0.2", "10.8.0.10",
+                     [this]() { return now(); });
+  table.set_client_routes({{"10.8.0.10", {*IpPrefix::parse("192.168.50.0/24")}}});
+  const auto add = [&](std::uint16_t port) {
+    return table.create_session({"192.168.1.100", port},
+                                std::make_unique<transport::TransportSession>(transport::sim::make_session_pair(port).second));
+  };
+
+  // The first client gets 10.8.0.10 and the subnet behind it.
+  auto site = add(1000);
+  auto roaming = add(1001);
+  ASSERT_TRUE(site && roaming);
+  ASSERT_EQ(table.find_by_id(*site)->tunnel_ip, "10.8.0.10");
+  EXPECT_EQ(table.find_by_route(ipv4_packet({10, 8, 0, 1}, {192, 168, 50, 7}))->session_id, *site);
+  EXPECT_EQ(table.find_by_tunnel_ip("192.168.50.200")->session_id, *site);
+  EXPECT_EQ(table.find_by_route(ipv4_packet({10, 8, 0, 1}, {192, 168, 51, 7})), nullptr);
+
+  // Sources must route back to the sending session.
+  EXPECT_TRUE(table.accept_source(*site, ipv4_packet({192, 168, 50, 7}, {1, 1, 1, 1})));
+  EXPECT_TRUE(table.accept_source(*site, ipv4_packet({10, 8, 0, 10}, {1, 1, 1, 1})));
+  EXPECT_FALSE(table.accept_source(*roaming, ipv4_packet({192, 168, 50, 7}, {1, 1, 1, 1})));
+  EXPECT_FALSE(table.accept_source(*roaming, ipv4_packet({10, 8, 0, 10}, {1, 1, 1, 1})));
+  EXPECT_FALSE(table.accept_source(*roaming, ipv4_packet({172, 16, 0, 1}, {1, 1, 1, 1})));
+  EXPECT_FALSE(table.accept_source(*roaming, std::vector<std::uint8_t>{0x45, 0x00}));
+
+  // A client sending from a free pool address takes it over (Issue #74),
+  // and its assigned address goes back to the pool.
+  EXPECT_TRUE(table.accept_source(*roaming, ipv4_packet({10, 8, 0, 2}, {1, 1, 1, 1})));
+  EXPECT_EQ(table.find_by_id(*roaming)->tunnel_ip, "10.8.0.2");
+  EXPECT_EQ(table.find_by_tunnel_ip("10.8.0.9"), nullptr);
+  EXPECT_EQ(table.find_by_tunnel_ip("10.8.0.2")->session_id, *roaming);
+  EXPECT_FALSE(table.accept_source(*site, ipv4_packet({10, 8, 0, 2}, {1, 1, 1, 1})));
+
+  // Removing a session removes its routes.
+  ASSERT_TRUE(table.remove_session(*site));
+  EXPECT_EQ(table.find_by_tunnel_ip("192.168.50.7"), nullptr);
+  auto next = add(1002);
+  ASSERT_TRUE(next.has_value());
+  EXPECT_NE(table.find_by_id(*next)->tunnel_ip, "10.8.0.2");
+}
+
 }  // namespace veil::server::test
@@ -3,7 +3,10 @@
 #include <array>
 #include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <string>
+#include <system_error>
 #include <vector>
 
 #include "common/handshake/session_ticket.h"
@@ -29,6 +32,15 @@ crypto::SessionKeys make_test_keys() {
   return keys;
 }
 
+std::filesystem::path write_key_file(const std::string& name, std::size_t size) {
+  auto path = std::filesystem::temp_directory_path() / name;
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  for (std::size_t i = 0; i < size; ++i) {
+    file.put(static_cast<char>(0xA0 + i));
+  }
+  return path;
+}
+
 }  // namespace
 
 // =============================================================================
@@ -191,6 +203,129 @@ TEST(SessionTicketManagerTests, DifferentNoncesNotDetectedAsReplay) {
   EXPECT_FALSE(manager.check_and_mark_nonce(nonce2));
 }
 
+// =============================================================================
+// Ticket Key Rotation Tests
+// =============================================================================
+
+TEST(SessionTicketManagerTests, SharedKeyFileValidatesAcrossManagers) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+  const auto path = write_key_file("veil_ticket_key_shared.bin", handshake::kTicketKeySize);
+
+  handshake::SessionTicketManager worker1(std::chrono::milliseconds(60000), now_fn);
+  handshake::SessionTicketManager worker2(std::chrono::milliseconds(60000), now_fn);
+  std::error_code ec;
+  ASSERT_TRUE(worker1.load_key_file(path.string(), ec)) << ec.message();
+  ASSERT_TRUE(worker2.load_key_file(path.string(), ec)) << ec.message();
+  std::filesystem::remove(path);
+
+  auto keys = make_test_keys();
+  auto ticket = worker1.issue_ticket(keys);
+  auto payload = worker2.validate_ticket(ticket.ticket_data);
+  ASSERT_TRUE(payload.has_value());
+  EXPECT_EQ(payload->send_key, keys.send_key);
+}
+
+TEST(SessionTicketManagerTests, LoadKeyFileRejectsMissingOrWrongSize) {
+  handshake::SessionTicketManager manager;
+  std::error_code ec;
+
+  EXPECT_FALSE(manager.load_key_file("/nonexistent/veil_ticket.key", ec));
+  EXPECT_TRUE(ec);
+
+  for (const std::size_t size : {std::size_t{16}, handshake::kTicketKeySize + 1}) {
+    ec.clear();
+    const auto path = write_key_file("veil_ticket_key_bad.bin", size);
+    EXPECT_FALSE(manager.load_key_file(path.string(), ec)) << "size " << size;
+    EXPECT_TRUE(ec);
+    std::filesystem::remove(path);
+  }
+}
+
+TEST(SessionTicketManagerTests, PreviousEpochTicketAccepted) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketConfig config;
+  config.ticket_lifetime = std::chrono::hours(1);
+  config.key_rotation_interval = std::chrono::minutes(10);
+  handshake::SessionTicketManager manager(config, now_fn);
+
+  auto ticket = manager.issue_ticket(make_test_keys());
+  const auto issued_epoch = manager.current_epoch();
+
+  // One rotation later the old key is still accepted.
+  now += std::chrono::minutes(10);
+  EXPECT_EQ(manager.current_epoch(), issued_epoch + 1);
+  EXPECT_TRUE(manager.validate_ticket(ticket.ticket_data).has_value());
+
+  // Two rotations later it is gone, even though the ticket itself has not expired.
+  now += std::chrono::minutes(10);
+  EXPECT_FALSE(manager.validate_ticket(ticket.ticket_data).has_value());
+}
+
+TEST(SessionTicketManagerTests, NewMasterKeyInvalidatesOldTickets) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketManager manager(std::chrono::milliseconds(60000), now_fn);
+  auto ticket = manager.issue_ticket(make_test_keys());
+
+  std::array<std::uint8_t, handshake::kTicketKeySize> master{};
+  master.fill(0x42);
+  manager.set_master_key(master);
+
+  EXPECT_FALSE(manager.validate_ticket(ticket.ticket_data).has_value());
+  auto fresh = manager.issue_ticket(make_test_keys());
+  EXPECT_TRUE(manager.validate_ticket(fresh.ticket_data).has_value());
+}
+
+TEST(SessionTicketManagerTests, TamperedEpochRejected) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  handshake::SessionTicketConfig config;
+  config.key_rotation_interval = std::chrono::minutes(10);
+  handshake::SessionTicketManager manager(config, now_fn);
+
+  auto ticket = manager.issue_ticket(make_test_keys());
+  now += std::chrono::minutes(10);
+
+  // Relabel the ticket with the (still accepted) current epoch.
+  auto relabeled = ticket.ticket_data;
+  relabeled[3] = static_cast<std::uint8_t>(relabeled[3] + 1);
+  EXPECT_FALSE(manager.validate_ticket(relabeled).has_value());
+  EXPECT_TRUE(manager.validate_ticket(ticket.ticket_data).has_value());
+}
+
+// =============================================================================
+// Ticket Message Tests
+// =============================================================================
+
+TEST(SessionTicketMessageTests, RoundTrip) {
+  handshake::SessionTicketManager manager;
+  auto ticket = manager.issue_ticket(make_test_keys());
+
+  const auto message = handshake::encode_ticket_message(ticket);
+  auto decoded = handshake::decode_ticket_message(message, 1234);
+  ASSERT_TRUE(decoded.has_value());
+  EXPECT_EQ(decoded->ticket_data, ticket.ticket_data);
+  EXPECT_EQ(decoded->lifetime_ms, ticket.lifetime_ms);
+  EXPECT_EQ(decoded->issued_at_ms, 1234u);
+
+  // Cached keys are never put on the wire
+  EXPECT_EQ(decoded->cached_keys.send_key, crypto::SessionKeys{}.send_key);
+  EXPECT_TRUE(manager.validate_ticket(decoded->ticket_data).has_value());
+}
+
+TEST(SessionTicketMessageTests, RejectsMalformed) {
+  EXPECT_FALSE(handshake::decode_ticket_message({}, 0).has_value());
+  std::vector<std::uint8_t> lifetime_only(8, 0);
+  EXPECT_FALSE(handshake::decode_ticket_message(lifetime_only, 0).has_value());
+  std::vector<std::uint8_t> oversized(8 + handshake::kMaxTicketDataSize + 1, 0);
+  EXPECT_FALSE(handshake::decode_ticket_message(oversized, 0).has_value());
+}
+
 // =============================================================================
 // SessionTicketStore Tests
 // =============================================================================
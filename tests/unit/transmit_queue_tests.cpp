@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+
+#include "transport/session/transmit_queue.h"
+
+namespace veil::tests {
+
+using namespace std::chrono_literals;
+
+class TransmitQueueTest : public ::testing::Test {
+ protected:
+  using TimePoint = transport::TransmitQueue::TimePoint;
+
+  transport::TransmitQueue make_queue(transport::TransmitQueueConfig config = {}) {
+    return transport::TransmitQueue(
+        config,
+        [this](std::span<const transport::UdpPacket> packets, std::error_code& ec) {
+          // The socket takes up to socket_room_ datagrams, stopping at a full
+          // buffer or at the datagram tagged rejected_tag_, which it rejects.
+          std::size_t sent = 0;
+          while (sent < packets.size() && sent < socket_room_ && packets[sent].data[0] != rejected_tag_) {
+            ++sent;
+          }
+          if (sent < packets.size()) {
+            ec = std::make_error_code(sent < socket_room_ ? std::errc::message_size
+                                                          : std::errc::operation_would_block);
+          }
+          socket_room_ -= sent;
+          if (sent > 0) {
+            batches_.emplace_back(packets.begin(), packets.begin() + static_cast<std::ptrdiff_t>(sent));
+          }
+          return sent;
+        },
+        [this]() { return now_; });
+  }
+
+  static std::vector<std::uint8_t> datagram(std::uint8_t tag, std::size_t size = 100) {
+    std::vector<std::uint8_t> data(size, 0);
+    data[0] = tag;
+    return data;
+  }
+
+  TimePoint now_{std::chrono::steady_clock::now()};
+  transport::UdpEndpoint remote_{"127.0.0.1", 4433};
+  std::vector<std::vector<transport::UdpPacket>> batches_;
+  std::size_t socket_room_{SIZE_MAX};
+  int rejected_tag_{-1};
+};
+
+TEST_F(TransmitQueueTest, RejectsInvalidConfig) {
+  transport::TransmitQueueConfig config;
+  config.max_batch = 0;
+  EXPECT_THROW(make_queue(config), std::invalid_argument);
+  EXPECT_THROW(transport::TransmitQueue({}, {}), std::invalid_argument);
+}
+
+TEST_F(TransmitQueueTest, SendsDueDatagramsInBatches) {
+  transport::TransmitQueueConfig config;
+  config.max_batch = 4;
+  auto queue = make_queue(config);
+
+  for (std::uint8_t i = 0; i < 6; ++i) {
+    ASSERT_TRUE(queue.enqueue(datagram(i), remote_));
+  }
+  EXPECT_EQ(queue.time_until_next(), 0us);
+  EXPECT_EQ(queue.flush(), 6U);
+  ASSERT_EQ(batches_.size(), 2U);
+  EXPECT_EQ(batches_[0].size(), 4U);
+  EXPECT_EQ(batches_[1].size(), 2U);
+  EXPECT_EQ(batches_[1][1].data[0], 5);
+  // Without kernel pacing the socket is asked to send at once.
+  EXPECT_EQ(batches_[0][0].departure, TimePoint{});
+  EXPECT_TRUE(queue.empty());
+  EXPECT_FALSE(queue.time_until_next().has_value());
+  EXPECT_EQ(queue.stats().batches, 2U);
+}
+
+TEST_F(TransmitQueueTest, SpacesDeparturesAtPacingRate) {
+  transport::TransmitQueueConfig config;
+  config.batch_window = 1ms;
+  auto queue = make_queue(config);
+  // 1000-byte datagrams at 1 MB/s: one per millisecond.
+  queue.set_pacing_rate(1'000'000);
+  for (std::uint8_t i = 0; i < 5; ++i) {
+    ASSERT_TRUE(queue.enqueue(datagram(i, 1000), remote_));
+  }
+
+  // Due now and within the batch window.
+  EXPECT_EQ(queue.flush(), 2U);
+  EXPECT_EQ(queue.time_until_next(), 1ms);
+  now_ += 1ms;
+  EXPECT_EQ(queue.flush(), 1U);
+  now_ += 1ms;
+  EXPECT_EQ(queue.flush(), 1U);
+  now_ += 10ms;
+  EXPECT_EQ(queue.flush(), 1U);
+  EXPECT_EQ(queue.stats().sent, 5U);
+
+  // An idle queue does not bank departures: the next datagram leaves at once.
+  ASSERT_TRUE(queue.enqueue(datagram(5, 1000), remote_));
+  EXPECT_EQ(queue.time_until_next(), 0us);
+}
+
+TEST_F(TransmitQueueTest, JitterDelaysWithoutReordering) {
+  transport::TransmitQueueConfig config;
+  config.batch_window = 0us;
+  auto queue = make_queue(config);
+
+  ASSERT_TRUE(queue.enqueue(datagram(0), remote_, now_ + 5ms));
+  // Asked to leave earlier, but stays behind the first datagram.
+  ASSERT_TRUE(queue.enqueue(datagram(1), remote_, now_ + 1ms));
+  EXPECT_EQ(queue.flush(), 0U);
+  EXPECT_EQ(queue.time_until_next(), 5ms);
+
+  now_ += 5ms;
+  EXPECT_EQ(queue.flush(), 2U);
+  ASSERT_EQ(batches_.size(), 1U);
+  EXPECT_EQ(batches_[0][0].data[0], 0);
+  EXPECT_EQ(batches_[0][1].data[0], 1);
+}
+
+TEST_F(TransmitQueueTest, KernelPacingHandsOverAheadWithDepartures) {
+  transport::TransmitQueueConfig config;
+  config.batch_window = 0us;
+  config.kernel_pacing = true;
+  config.kernel_horizon = 2ms;
+  auto queue = make_queue(config);
+  queue.set_pacing_rate(1'000'000);
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.enqueue(datagram(i, 1000), remote_));
+  }
+
+  // Departures within the horizon go to the kernel now, each stamped.
+  EXPECT_EQ(queue.flush(), 3U);
+  ASSERT_EQ(batches_.size(), 1U);
+  EXPECT_EQ(batches_[0][0].departure, now_);
+  EXPECT_EQ(batches_[0][1].departure, now_ + 1ms);
+  EXPECT_EQ(batches_[0][2].departure, now_ + 2ms);
+  EXPECT_EQ(queue.time_until_next(), 1ms);
+}
+
+TEST_F(TransmitQueueTest, DropsWhenFull) {
+  transport::TransmitQueueConfig config;
+  config.max_queued_bytes = 250;
+  auto queue = make_queue(config);
+
+  EXPECT_TRUE(queue.enqueue(datagram(0), remote_));
+  EXPECT_TRUE(queue.enqueue(datagram(1), remote_));
+  EXPECT_FALSE(queue.enqueue(datagram(2), remote_));
+  EXPECT_EQ(queue.stats().dropped, 1U);
+  EXPECT_EQ(queue.queued_bytes(), 200U);
+}
+
+TEST_F(TransmitQueueTest, KeepsUnsentDatagramsWhenSocketBufferIsFull) {
+  auto queue = make_queue();
+  for (std::uint8_t i = 0; i < 5; ++i) {
+    ASSERT_TRUE(queue.enqueue(datagram(i), remote_));
+  }
+
+  // The socket takes two of the batch, then would block.
+  socket_room_ = 2;
+  EXPECT_EQ(queue.flush(), 2U);
+  EXPECT_EQ(queue.stats().sent, 2U);
+  EXPECT_EQ(queue.stats().send_errors, 0U);
+  EXPECT_EQ(queue.stats().blocked, 1U);
+  EXPECT_EQ(queue.size(), 3U);
+  EXPECT_EQ(queue.queued_bytes(), 300U);
+
+  // No retry until the next batch window.
+  socket_room_ = SIZE_MAX;
+  EXPECT_EQ(queue.time_until_next(), 1000us);
+  EXPECT_EQ(queue.flush(), 0U);
+  now_ += 1ms;
+  EXPECT_EQ(queue.time_until_next(), 0us);
+  EXPECT_EQ(queue.flush(), 3U);
+  EXPECT_TRUE(queue.empty());
+
+  std::vector<std::uint8_t> tags;
+  for (const auto& batch : batches_) {
+    for (const auto& packet : batch) {
+      tags.push_back(packet.data[0]);
+    }
+  }
+  EXPECT_EQ(tags, (std::vector<std::uint8_t>{0, 1, 2, 3, 4}));
+  EXPECT_EQ(queue.stats().sent, 5U);
+}
+
+TEST_F(TransmitQueueTest, DropsOnlyTheRejectedDatagram) {
+  auto queue = make_queue();
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.enqueue(datagram(i), remote_));
+  }
+
+  // The second datagram is rejected; the others still go out.
+  rejected_tag_ = 1;
+  EXPECT_EQ(queue.flush(), 3U);
+  EXPECT_EQ(queue.stats().sent, 3U);
+  EXPECT_EQ(queue.stats().send_errors, 1U);
+  EXPECT_EQ(queue.stats().blocked, 0U);
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.queued_bytes(), 0U);
+}
+
+}  // namespace veil::tests
@@ -2,6 +2,8 @@
 
 #include <chrono>
 #include <cstdint>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "common/handshake/handshake_processor.h"
@@ -437,13 +439,13 @@ TEST_F(TransportSessionTest, SequenceNumbersAreObfuscatedInWireFormat) {
     packets.push_back(encrypted[0]);
   }
 
-  // Extract the first 8 bytes from each packet (the obfuscated sequence)
+  // Extract the 8 bytes after the connection ID (the obfuscated sequence)
   std::vector<std::uint64_t> wire_sequences;
   for (const auto& pkt : packets) {
-    ASSERT_GE(pkt.size(), 8U);
+    ASSERT_GE(pkt.size(), transport::kConnectionIdSize + 8U);
     std::uint64_t wire_seq = 0;
-    for (int i = 0; i < 8; ++i) {
-      wire_seq = (wire_seq << 8) | pkt[static_cast<std::size_t>(i)];
+    for (std::size_t i = 0; i < 8; ++i) {
+      wire_seq = (wire_seq << 8) | pkt[transport::kConnectionIdSize + i];
     }
     wire_sequences.push_back(wire_seq);
   }
@@ -553,13 +555,13 @@ TEST_F(TransportSessionTest, DifferentSessionsProduceDifferentObfuscation) {
   ASSERT_EQ(pkt1.size(), 1U);
   ASSERT_EQ(pkt2.size(), 1U);
 
-  // Extract first 8 bytes (obfuscated sequence) from each
+  // Extract the obfuscated sequence (after the connection ID) from each
   std::uint64_t obf_seq1 = 0;
   std::uint64_t obf_seq2 = 0;
 
-  for (int i = 0; i < 8; ++i) {
-    obf_seq1 = (obf_seq1 << 8) | pkt1[0][static_cast<std::size_t>(i)];
-    obf_seq2 = (obf_seq2 << 8) | pkt2[0][static_cast<std::size_t>(i)];
+  for (std::size_t i = 0; i < 8; ++i) {
+    obf_seq1 = (obf_seq1 << 8) | pkt1[0][transport::kConnectionIdSize + i];
+    obf_seq2 = (obf_seq2 << 8) | pkt2[0][transport::kConnectionIdSize + i];
   }
 
   // Even though both sessions sent sequence 0, the obfuscated values should differ
@@ -567,6 +569,138 @@ TEST_F(TransportSessionTest, DifferentSessionsProduceDifferentObfuscation) {
       << "Different sessions should produce different obfuscated sequences";
 }
 
+TEST_F(TransportSessionTest, ConnectionIdSharedByBothPeers) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  EXPECT_NE(client.connection_id(), 0U);
+  EXPECT_EQ(client.connection_id(), server.connection_id());
+
+  std::vector<std::uint8_t> data{1, 2, 3};
+  auto from_client = client.encrypt_data(data);
+  auto from_server = server.encrypt_data(data);
+  ASSERT_EQ(from_client.size(), 1U);
+  ASSERT_EQ(from_server.size(), 1U);
+  EXPECT_EQ(transport::TransportSession::peek_connection_id(from_client[0]), client.connection_id());
+  EXPECT_EQ(transport::TransportSession::peek_connection_id(from_server[0]), client.connection_id());
+  EXPECT_FALSE(transport::TransportSession::peek_connection_id(std::vector<std::uint8_t>(4)).has_value());
+}
+
+TEST_F(TransportSessionTest, ConnectionIdIsAuthenticated) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  std::vector<std::uint8_t> data{1, 2, 3};
+  auto packets = client.encrypt_data(data);
+  ASSERT_EQ(packets.size(), 1U);
+
+  // A packet carrying another connection's ID is dropped without decrypting.
+  auto wrong_id = packets[0];
+  wrong_id[0] ^= 0x01;
+  EXPECT_FALSE(server.decrypt_packet(wrong_id).has_value());
+  EXPECT_EQ(server.stats().packets_dropped_decrypt, 1U);
+
+  // The untouched packet still decrypts (the rejected copy did not burn its sequence).
+  EXPECT_TRUE(server.decrypt_packet(packets[0]).has_value());
+}
+
+TEST_F(TransportSessionTest, OnlyNewestPacketAdvances) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  std::vector<std::uint8_t> data{1, 2, 3};
+  auto p0 = client.encrypt_data(data);
+  auto p1 = client.encrypt_data(data);
+  auto p2 = client.encrypt_data(data);
+
+  ASSERT_TRUE(server.decrypt_packet(p0[0]).has_value());
+  EXPECT_TRUE(server.last_packet_advanced());
+  ASSERT_TRUE(server.decrypt_packet(p2[0]).has_value());
+  EXPECT_TRUE(server.last_packet_advanced());
+  ASSERT_TRUE(server.decrypt_packet(p1[0]).has_value());
+  EXPECT_FALSE(server.last_packet_advanced());  // Reordered packet.
+}
+
+TEST_F(TransportSessionTest, OpenThenAcceptMatchesDecryptPacket) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  std::vector<std::uint8_t> data{1, 2, 3};
+  auto packets = client.encrypt_data(data);
+  ASSERT_EQ(packets.size(), 1U);
+
+  auto tampered = packets[0];
+  tampered.back() ^= 0x01;
+  EXPECT_FALSE(server.open_packet(tampered).has_value());
+
+  auto opened = server.open_packet(packets[0]);
+  ASSERT_TRUE(opened.has_value());
+  auto replayed = server.open_packet(packets[0]);
+  ASSERT_TRUE(replayed.has_value());  // Opening checks authenticity only.
+
+  auto frames = server.accept_packet(std::move(*opened));
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, data);
+  EXPECT_TRUE(server.last_packet_advanced());
+  EXPECT_EQ(server.stats().packets_received, 1U);
+  EXPECT_EQ(server.stats().bytes_received, packets[0].size());
+
+  EXPECT_FALSE(server.accept_packet(std::move(*replayed)).has_value());
+  EXPECT_EQ(server.stats().packets_dropped_replay, 1U);
+  EXPECT_FALSE(server.decrypt_packet(packets[0]).has_value());
+}
+
+TEST_F(TransportSessionTest, OpenPacketRunsOutsideTheSessionLock) {
+  // One session shared by a sending and a receiving thread, as with the
+  // tunnel's worker threads: only open_packet() runs without the lock.
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  constexpr int kPackets = 500;
+  const std::vector<std::uint8_t> data(1000, 0x5A);
+
+  std::vector<std::vector<std::uint8_t>> downstream;
+  for (int i = 0; i < kPackets; ++i) {
+    downstream.push_back(server.encrypt_data(data)[0]);
+  }
+
+  std::mutex lock;
+  std::vector<std::vector<std::uint8_t>> upstream;
+  std::thread sender([&]() {
+    for (int i = 0; i < kPackets; ++i) {
+      const std::lock_guard<std::mutex> guard(lock);
+      client.bind_to_current_thread();
+      upstream.push_back(client.encrypt_data(data)[0]);
+    }
+  });
+  int received = 0;
+  for (const auto& packet : downstream) {
+    auto opened = client.open_packet(packet);
+    if (!opened) {
+      continue;
+    }
+    const std::lock_guard<std::mutex> guard(lock);
+    client.bind_to_current_thread();
+    if (auto frames = client.accept_packet(std::move(*opened))) {
+      received += static_cast<int>(frames->size());
+    }
+  }
+  sender.join();
+  client.bind_to_current_thread();
+
+  EXPECT_EQ(received, kPackets);
+  EXPECT_EQ(client.stats().packets_received, static_cast<std::uint64_t>(kPackets));
+  ASSERT_EQ(upstream.size(), static_cast<std::size_t>(kPackets));
+  for (const auto& packet : upstream) {
+    ASSERT_TRUE(server.decrypt_packet(packet).has_value());
+  }
+}
+
 // =============================================================================
 // ZERO-COPY PROCESSING TESTS (Issue #97)
 // These tests verify the zero-copy packet processing methods for performance
@@ -873,4 +1007,593 @@ TEST_F(TransportSessionTest, ZeroCopyMultiplePackets) {
   EXPECT_EQ(server.stats().packets_dropped_decrypt, 0U);
 }
 
+TEST_F(TransportSessionTest, AesGcmSessionRoundTrip) {
+  if (crypto::get_recommended_aead_algorithm() != crypto::AeadAlgorithm::kAesGcm) {
+    GTEST_SKIP() << "AES-GCM hardware acceleration not available";
+  }
+  auto now_fn = [this]() { return steady_now_; };
+  client_handshake_.aead = crypto::AeadAlgorithm::kAesGcm;
+  server_handshake_.aead = crypto::AeadAlgorithm::kAesGcm;
+
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  EXPECT_EQ(client.aead_algorithm(), crypto::AeadAlgorithm::kAesGcm);
+
+  std::vector<std::uint8_t> buffer(2048);
+  std::vector<std::uint8_t> plain(2048);
+  for (std::uint8_t i = 0; i < 5; ++i) {
+    const std::vector<std::uint8_t> payload(64, i);
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    auto frames = server.decrypt_packet(packets[0]);
+    ASSERT_TRUE(frames.has_value());
+    EXPECT_EQ((*frames)[0].data.payload, payload);
+
+    const auto frame = mux::make_data_frame(0, i, false, payload);
+    const auto size = server.encrypt_frame_zero_copy(frame, buffer);
+    ASSERT_GT(size, 0U);
+    EXPECT_TRUE(client.decrypt_packet_zero_copy(std::span<const std::uint8_t>(buffer.data(), size), plain));
+  }
+
+  // A peer that settled on the other algorithm cannot read the traffic.
+  server_handshake_.aead = crypto::AeadAlgorithm::kChaCha20Poly1305;
+  transport::TransportSession mismatched(server_handshake_, {}, now_fn);
+  auto packets = client.encrypt_data(std::vector<std::uint8_t>{1, 2, 3}, 0, false);
+  EXPECT_FALSE(mismatched.decrypt_packet(packets[0]).has_value());
+}
+
+TEST_F(TransportSessionTest, CompactFramesRoundTripAndShrinkPackets) {
+  auto now_fn = [this]() { return steady_now_; };
+  // The fixture's handshake negotiates compact frames; force a legacy sender
+  // to compare packet sizes.
+  EXPECT_TRUE(client_handshake_.compact_frames);
+  auto legacy_handshake = client_handshake_;
+  legacy_handshake.compact_frames = false;
+  transport::TransportSession legacy(legacy_handshake, {}, now_fn);
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  EXPECT_EQ(client.frame_format(), mux::FrameFormat::kCompact);
+  EXPECT_EQ(legacy.frame_format(), mux::FrameFormat::kLegacy);
+
+  // Small payloads, a fragmented message, and an ACK.
+  const std::vector<std::uint8_t> small(60, 0x42);
+  for (int i = 0; i < 300; ++i) {
+    auto packets = client.encrypt_data(small, 0, false);
+    ASSERT_EQ(packets.size(), 1U);
+    EXPECT_EQ(packets[0].size() + mux::MuxCodec::kDataHeaderSize - 2,
+              legacy.encrypt_data(small, 0, false)[0].size())
+        << "packet " << i;
+    auto frames = server.decrypt_packet(packets[0]);
+    ASSERT_TRUE(frames.has_value());
+    ASSERT_EQ(frames->size(), 1U);
+    EXPECT_EQ((*frames)[0].data.sequence, static_cast<std::uint64_t>(i));
+    EXPECT_EQ((*frames)[0].data.payload, small);
+  }
+
+  std::vector<std::uint8_t> large(3000);
+  for (std::size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<std::uint8_t>(i);
+  }
+  auto packets = client.encrypt_data(large, 7, false);
+  ASSERT_GT(packets.size(), 1U);
+  std::vector<mux::MuxFrame> delivered;
+  for (const auto& packet : packets) {
+    auto frames = server.decrypt_packet(packet);
+    ASSERT_TRUE(frames.has_value());
+    delivered.insert(delivered.end(), frames->begin(), frames->end());
+  }
+  ASSERT_EQ(delivered.size(), 1U);
+  EXPECT_EQ(delivered[0].data.stream_id, 7U);
+  EXPECT_EQ(delivered[0].data.payload, large);
+
+  auto ack = server.encrypt_frame(mux::make_ack_frame(0, 299, 0xFF));
+  auto frames = client.decrypt_packet(ack);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].kind, mux::FrameKind::kAck);
+  EXPECT_EQ((*frames)[0].ack.ack, 299U);
+
+  // Zero-copy paths.
+  std::vector<std::uint8_t> buffer(2048);
+  std::vector<std::uint8_t> plain(2048);
+  const auto size = server.encrypt_frame_zero_copy(mux::make_data_frame(0, 5, true, small), buffer);
+  ASSERT_GT(size, 0U);
+  auto view = client.decrypt_packet_zero_copy(std::span<const std::uint8_t>(buffer.data(), size), plain);
+  ASSERT_TRUE(view.has_value());
+  EXPECT_EQ(view->first.data.sequence, 5U);
+  EXPECT_EQ(view->first.data.payload.size(), small.size());
+
+  // A legacy peer cannot parse compact frames.
+  server_handshake_.compact_frames = false;
+  transport::TransportSession mismatched(server_handshake_, {}, now_fn);
+  auto compact_packet = client.encrypt_data(small, 0, false);
+  auto mismatched_frames = mismatched.decrypt_packet(compact_packet[0]);
+  ASSERT_TRUE(mismatched_frames.has_value());
+  EXPECT_TRUE(mismatched_frames->empty());
+}
+
+TEST_F(TransportSessionTest, EncryptCoalescedPacksFramesWithinMtu) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.mtu = 400;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+
+  // Three packets from the server leave an ACK pending at the client.
+  for (std::uint8_t i = 0; i < 3; ++i) {
+    auto inbound = server.encrypt_data(std::vector<std::uint8_t>{i});
+    ASSERT_TRUE(client.decrypt_packet(inbound[0]).has_value());
+  }
+
+  // Ten 64-byte payloads and the ACK: more than one 400-byte datagram holds.
+  std::vector<std::vector<std::uint8_t>> data;
+  std::vector<transport::CoalescedPayload> payloads;
+  for (std::uint8_t i = 0; i < 10; ++i) {
+    data.emplace_back(64, i);
+  }
+  for (const auto& d : data) {
+    payloads.push_back(transport::CoalescedPayload{.stream_id = 0, .data = d});
+  }
+  auto packets = client.encrypt_coalesced(payloads);
+  ASSERT_EQ(packets.size(), 2U);
+
+  std::vector<mux::MuxFrame> delivered;
+  for (const auto& packet : packets) {
+    EXPECT_LE(packet.size(), config.mtu);
+    auto frames = server.decrypt_packet(packet);
+    ASSERT_TRUE(frames.has_value());
+    delivered.insert(delivered.end(), frames->begin(), frames->end());
+  }
+  ASSERT_EQ(delivered.size(), 11U);
+  EXPECT_EQ(delivered[10].kind, mux::FrameKind::kAck);
+  EXPECT_EQ(delivered[10].ack.ack, 2U);
+  EXPECT_EQ(delivered[10].ack.bitmap, 0x3U);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    const auto& frame = delivered[i];
+    ASSERT_EQ(frame.kind, mux::FrameKind::kData);
+    EXPECT_EQ(frame.data.sequence, i);
+    EXPECT_EQ(frame.data.payload, data[i]);
+  }
+
+  EXPECT_EQ(client.stats().packets_sent, 2U);
+  EXPECT_EQ(client.stats().fragments_sent, 10U);
+  EXPECT_EQ(client.stats().frames_coalesced, 9U);
+  EXPECT_EQ(client.stats().acks_piggybacked, 1U);
+  EXPECT_FALSE(client.time_until_ack().has_value());
+  // Both datagrams carry data and are tracked for retransmission.
+  EXPECT_EQ(client.retransmit_stats().packets_sent, 2U);
+}
+
+TEST_F(TransportSessionTest, EncryptCoalescedSendsOneFramePerPacketToLegacyPeers) {
+  auto now_fn = [this]() { return steady_now_; };
+  client_handshake_.compact_frames = false;
+  server_handshake_.compact_frames = false;
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  ASSERT_EQ(client.frame_format(), mux::FrameFormat::kLegacy);
+
+  for (std::uint8_t i = 0; i < 2; ++i) {
+    auto inbound = server.encrypt_data(std::vector<std::uint8_t>{i});
+    ASSERT_TRUE(client.decrypt_packet(inbound[0]).has_value());
+  }
+
+  const std::vector<std::uint8_t> a{1, 2, 3};
+  const std::vector<std::uint8_t> b{4, 5};
+  const std::vector<transport::CoalescedPayload> payloads{{.stream_id = 0, .data = a},
+                                                          {.stream_id = 3, .data = b}};
+  auto packets = client.encrypt_coalesced(payloads);
+  ASSERT_EQ(packets.size(), 2U);
+
+  auto first = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(first.has_value());
+  ASSERT_EQ(first->size(), 1U);
+  EXPECT_EQ((*first)[0].data.payload, a);
+  auto second = server.decrypt_packet(packets[1]);
+  ASSERT_TRUE(second.has_value());
+  ASSERT_EQ(second->size(), 1U);
+  EXPECT_EQ((*second)[0].data.stream_id, 3U);
+  EXPECT_EQ((*second)[0].data.payload, b);
+  EXPECT_EQ(client.stats().frames_coalesced, 0U);
+
+  // Legacy data cannot carry the ACK; it goes out on its own.
+  EXPECT_EQ(client.stats().acks_piggybacked, 0U);
+  auto ack_packet = client.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  auto ack = server.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack.has_value());
+  ASSERT_EQ(ack->size(), 1U);
+  EXPECT_EQ((*ack)[0].kind, mux::FrameKind::kAck);
+  EXPECT_EQ((*ack)[0].ack.ack, 1U);
+}
+
+TEST_F(TransportSessionTest, PendingAckRidesOnOutgoingData) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // Two data packets ask for an immediate ACK, but only at the end of the
+  // receive burst.
+  for (std::uint8_t i = 0; i < 2; ++i) {
+    auto packets = client.encrypt_data(std::vector<std::uint8_t>{i});
+    ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+    EXPECT_FALSE(server.take_ack_packet().has_value());
+  }
+  ASSERT_TRUE(server.time_until_ack().has_value());
+
+  // Reply data carries it instead of a separate ACK datagram.
+  const std::vector<std::uint8_t> reply(100, 0x11);
+  auto replies = server.encrypt_data(reply);
+  ASSERT_EQ(replies.size(), 1U);
+  EXPECT_FALSE(server.take_ack_packet(true).has_value());
+  EXPECT_EQ(server.stats().acks_piggybacked, 1U);
+  EXPECT_EQ(server.stats().acks_sent, 0U);
+
+  EXPECT_GT(client.bytes_in_flight(), 0U);
+  auto frames = client.decrypt_packet(replies[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 2U);
+  EXPECT_EQ((*frames)[0].data.payload, reply);
+  ASSERT_EQ((*frames)[1].kind, mux::FrameKind::kAck);
+  client.process_ack((*frames)[1].ack);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+}
+
+TEST_F(TransportSessionTest, StandaloneAckWhenNoDataIsSent) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  auto packets = client.encrypt_data(std::vector<std::uint8_t>{1, 2, 3}, 0, false);
+  ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+
+  // One packet is not worth an immediate ACK; the delayed-ACK timer sends it.
+  EXPECT_FALSE(server.take_ack_packet(true).has_value());
+  steady_now_ += transport::TransportSessionConfig{}.ack_config.max_ack_delay;
+  auto ack_packet = server.take_ack_packet();
+  ASSERT_TRUE(ack_packet.has_value());
+  EXPECT_EQ(server.stats().acks_sent, 1U);
+  EXPECT_FALSE(server.time_until_ack().has_value());
+
+  auto frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  client.process_ack((*frames)[0].ack);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+}
+
+TEST_F(TransportSessionTest, NextTimerDeadlineCoversRetransmitAndDelayedAck) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  EXPECT_FALSE(client.next_timer_deadline().has_value());
+
+  const auto sent_at = steady_now_;
+  auto packets = client.encrypt_data(std::vector<std::uint8_t>{1, 2, 3}, 0, false);
+  auto retransmit_due = client.next_timer_deadline();
+  ASSERT_TRUE(retransmit_due.has_value());
+  EXPECT_GT(*retransmit_due, sent_at);
+
+  steady_now_ += std::chrono::milliseconds(5);
+  ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  EXPECT_EQ(server.next_timer_deadline(),
+            steady_now_ + transport::TransportSessionConfig{}.ack_config.max_ack_delay);
+
+  // Once the ACK is sent and processed, neither side has a timer pending.
+  steady_now_ += transport::TransportSessionConfig{}.ack_config.max_ack_delay;
+  auto ack_packet = server.take_ack_packet();
+  ASSERT_TRUE(ack_packet.has_value());
+  EXPECT_FALSE(server.next_timer_deadline().has_value());
+  auto frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(frames.has_value());
+  client.process_ack((*frames)[0].ack);
+  EXPECT_FALSE(client.next_timer_deadline().has_value());
+}
+
+TEST_F(TransportSessionTest, AckLeavesUnreceivedPacketsPending) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  // Packet 1 of 0..3 is lost.
+  std::vector<std::vector<std::uint8_t>> packets;
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    packets.push_back(client.encrypt_data(std::vector<std::uint8_t>{i})[0]);
+  }
+  const auto lost_size = packets[1].size();
+  for (std::size_t i : {0U, 2U, 3U}) {
+    ASSERT_TRUE(server.decrypt_packet(packets[i]).has_value());
+  }
+  auto ack_packet = server.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  auto frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].ack.ack, 3U);
+
+  client.process_ack((*frames)[0].ack);
+  EXPECT_EQ(client.bytes_in_flight(), lost_size);
+}
+
+TEST_F(TransportSessionTest, MtuProbesAreAcknowledgedBySize) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+
+  EXPECT_FALSE(client.encrypt_probe(40).has_value());
+  auto large = client.encrypt_probe(1472);
+  auto small = client.encrypt_probe(1300);
+  ASSERT_TRUE(large.has_value());
+  ASSERT_TRUE(small.has_value());
+  EXPECT_EQ(large->size(), 1472U);
+  EXPECT_EQ(small->size(), 1300U);
+  // Probes are not data: nothing waits for retransmission.
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+
+  // The large probe is lost; the small one arrives and is acknowledged.
+  auto frames = server.decrypt_packet(*small);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].kind, mux::FrameKind::kHeartbeat);
+  steady_now_ += transport::TransportSessionConfig{}.ack_config.max_ack_delay;
+  auto ack_packet = server.take_ack_packet();
+  ASSERT_TRUE(ack_packet.has_value());
+
+  auto ack_frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack_frames.has_value());
+  client.process_ack((*ack_frames)[0].ack);
+  EXPECT_EQ(client.take_acked_probes(), std::vector<std::size_t>{1300});
+  EXPECT_TRUE(client.take_acked_probes().empty());
+  EXPECT_EQ(client.stats().mtu_probes_sent, 2U);
+  EXPECT_EQ(client.stats().mtu_probes_acked, 1U);
+
+  steady_now_ += 10s;
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+}
+
+TEST_F(TransportSessionTest, PathMtuResizesMessagesAndFragments) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  const std::vector<std::uint8_t> message(1400, 0x5A);
+
+  EXPECT_EQ(client.encrypt_data(message).size(), 2U);
+
+  client.set_mtu(1472);
+  EXPECT_EQ(client.mtu(), 1472U);
+  EXPECT_EQ(client.max_unfragmented_payload(), 1342U + 72U);
+  auto packets = client.encrypt_data(message);
+  ASSERT_EQ(packets.size(), 1U);
+  EXPECT_LE(packets[0].size(), 1472U);
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, message);
+
+  // Below the configured MTU, fragments shrink with it; the receiver places
+  // them by index, in any order.
+  client.set_mtu(1300);
+  EXPECT_EQ(client.mtu(), 1300U);
+  EXPECT_EQ(client.max_unfragmented_payload(), 1342U - 100U);
+  packets = client.encrypt_data(message);
+  ASSERT_EQ(packets.size(), 2U);
+  for (const auto& packet : packets) {
+    EXPECT_LE(packet.size(), 1300U);
+  }
+  ASSERT_TRUE(server.decrypt_packet(packets[1]).has_value());
+  frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, message);
+
+  // Never below what every IPv6 path carries.
+  client.set_mtu(1000);
+  EXPECT_EQ(client.mtu(), transport::kMinPathMtu);
+  for (const auto& packet : client.encrypt_data(message)) {
+    EXPECT_LE(packet.size(), transport::kMinPathMtu);
+  }
+}
+
+TEST_F(TransportSessionTest, AckFrequencyRequestTunesPeerAckDelay) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  transport::TransportSession server(server_handshake_, {}, now_fn);
+  const std::vector<std::uint8_t> payload{1, 2, 3};
+
+  // No RTT sample yet: nothing to base a request on.
+  for (int i = 0; i < 2; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  }
+  EXPECT_EQ(client.stats().ack_frequency_sent, 0U);
+  auto ack_packet = server.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  steady_now_ += std::chrono::milliseconds(8);
+  auto ack_frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack_frames.has_value());
+  client.process_ack((*ack_frames)[0].ack);
+
+  // An 8 ms RTT in slow start: ACK every other packet, within SRTT / 4.
+  auto packets = client.encrypt_data(payload, 0, false);
+  ASSERT_EQ(packets.size(), 1U);
+  EXPECT_EQ(client.stats().ack_frequency_sent, 1U);
+  auto frames = server.decrypt_packet(packets[0]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].kind, mux::FrameKind::kData);
+  EXPECT_EQ(server.stats().ack_frequency_applied, 1U);
+  EXPECT_EQ(server.time_until_ack(), std::chrono::milliseconds(2));
+
+  // Unchanged, so not repeated.
+  packets = client.encrypt_data(payload, 0, false);
+  EXPECT_EQ(client.stats().ack_frequency_sent, 1U);
+}
+
+TEST_F(TransportSessionTest, AckFrequencyRequestKeepsRtoAckDelay) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSessionConfig config;
+  config.retransmit_config.min_rto = std::chrono::milliseconds(1);
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  const std::vector<std::uint8_t> payload{1, 2, 3};
+
+  for (int i = 0; i < 2; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  }
+  auto ack_packet = server.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  steady_now_ += std::chrono::milliseconds(8);
+  auto ack_frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack_frames.has_value());
+  client.process_ack((*ack_frames)[0].ack);
+
+  // The request asks for a 2 ms delay, but the RTO keeps the configured
+  // 20 ms: SRTT 8 ms + 4 * RTTVAR 4 ms + 20 ms.
+  auto packets = client.encrypt_data(payload, 0, false);
+  ASSERT_EQ(client.stats().ack_frequency_sent, 1U);
+  steady_now_ += std::chrono::milliseconds(40);
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+  steady_now_ += std::chrono::milliseconds(5);
+  EXPECT_EQ(client.get_retransmit_packets().size(), 1U);
+}
+
+TEST_F(TransportSessionTest, AckDelayIsTakenOutOfRttSamples) {
+  auto now_fn = [this]() { return steady_now_; };
+  ASSERT_TRUE(client_handshake_.ack_delay);
+  transport::TransportSessionConfig config;
+  config.ack_frequency.enabled = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  const std::vector<std::uint8_t> payload{1, 2, 3};
+
+  // First round trip, acknowledged at once: 4 ms.
+  for (int i = 0; i < 2; ++i) {
+    auto packets = client.encrypt_data(payload, 0, false);
+    ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  }
+  auto ack_packet = server.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  steady_now_ += std::chrono::milliseconds(4);
+  auto ack_frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack_frames.has_value());
+  client.process_ack((*ack_frames)[0].ack);
+  EXPECT_EQ(client.smoothed_rtt(), std::chrono::milliseconds(4));
+
+  // A lone packet waits the full ACK delay at the server, which reports it.
+  auto packets = client.encrypt_data(payload, 0, false);
+  steady_now_ += std::chrono::milliseconds(2);
+  ASSERT_TRUE(server.decrypt_packet(packets[0]).has_value());
+  EXPECT_FALSE(server.take_ack_packet(true).has_value());
+  steady_now_ += std::chrono::milliseconds(20);
+  ack_packet = server.take_ack_packet(false);
+  ASSERT_TRUE(ack_packet.has_value());
+  steady_now_ += std::chrono::milliseconds(2);
+  ack_frames = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack_frames.has_value());
+  EXPECT_EQ((*ack_frames)[0].ack.ack_delay, std::chrono::milliseconds(20));
+  client.process_ack((*ack_frames)[0].ack);
+  EXPECT_EQ(client.smoothed_rtt(), std::chrono::milliseconds(4));
+  EXPECT_EQ(client.min_rtt(), std::chrono::milliseconds(4));
+}
+
+TEST_F(TransportSessionTest, FecRebuildsLostPacket) {
+  auto now_fn = [this]() { return steady_now_; };
+  client_handshake_.fec = true;
+  server_handshake_.fec = true;
+  transport::TransportSessionConfig config;
+  config.fec.adaptive = false;
+  config.fec.source_count = 4;
+  config.fec.repair_count = 1;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+  transport::TransportSession server(server_handshake_, config, now_fn);
+  ASSERT_TRUE(client.fec_enabled());
+
+  // The fourth message fills the group, so its repair packet follows it.
+  std::vector<std::vector<std::uint8_t>> packets;
+  for (std::uint8_t i = 0; i < 4; ++i) {
+    for (auto& packet : client.encrypt_data(std::vector<std::uint8_t>(50 + i, i))) {
+      packets.push_back(std::move(packet));
+    }
+  }
+  ASSERT_EQ(packets.size(), 5U);
+  EXPECT_EQ(client.stats().fec_repairs_sent, 1U);
+
+  // Packet 1 is lost; the repair rebuilds it without a retransmission.
+  for (std::size_t i : {0U, 2U, 3U}) {
+    ASSERT_TRUE(server.decrypt_packet(packets[i]).has_value());
+  }
+  auto frames = server.decrypt_packet(packets[4]);
+  ASSERT_TRUE(frames.has_value());
+  ASSERT_EQ(frames->size(), 1U);
+  EXPECT_EQ((*frames)[0].data.payload, std::vector<std::uint8_t>(51, 1));
+  EXPECT_EQ(server.stats().fec_repairs_received, 1U);
+  EXPECT_EQ(server.stats().fec_packets_recovered, 1U);
+
+  // The rebuilt packet is acknowledged like one that arrived, and the original
+  // is a replay if it turns up late.
+  auto ack_packet = server.take_ack_packet(true);
+  ASSERT_TRUE(ack_packet.has_value());
+  auto ack = client.decrypt_packet(*ack_packet);
+  ASSERT_TRUE(ack.has_value());
+  client.process_ack((*ack)[0].ack);
+  EXPECT_EQ(client.bytes_in_flight(), 0U);
+  EXPECT_FALSE(server.decrypt_packet(packets[1]).has_value());
+}
+
+TEST_F(TransportSessionTest, FecClosesPartialGroupAfterDelay) {
+  auto now_fn = [this]() { return steady_now_; };
+  client_handshake_.fec = true;
+  transport::TransportSessionConfig config;
+  config.fec.adaptive = false;
+  transport::TransportSession client(client_handshake_, config, now_fn);
+
+  // Data fragments leave room for the repair frame header.
+  const std::vector<std::uint8_t> message(config.max_fragment_size, 0x5A);
+  EXPECT_EQ(client.encrypt_data(message).size(), 2U);
+  EXPECT_TRUE(client.get_retransmit_packets().empty());
+
+  steady_now_ += config.fec.max_group_delay;
+  auto repairs = client.get_retransmit_packets();
+  ASSERT_EQ(repairs.size(), 1U);
+  EXPECT_LE(repairs[0].size(), config.mtu);
+  EXPECT_EQ(client.stats().fec_repairs_sent, 1U);
+  EXPECT_EQ(client.stats().retransmits, 0U);
+}
+
+TEST_F(TransportSessionTest, HibernatedSessionResumesWithoutHandshake) {
+  auto now_fn = [this]() { return steady_now_; };
+  transport::TransportSession client(client_handshake_, {}, now_fn);
+  auto server = std::make_unique<transport::TransportSession>(server_handshake_,
+                                                              transport::TransportSessionConfig{}, now_fn);
+
+  std::vector<std::vector<std::uint8_t>> old_packets;
+  for (std::uint8_t i = 0; i < 3; ++i) {
+    old_packets.push_back(client.encrypt_data(std::vector<std::uint8_t>{i})[0]);
+    ASSERT_TRUE(server->decrypt_packet(old_packets.back()).has_value());
+  }
+  auto replies = server->encrypt_data(std::vector<std::uint8_t>{0x10});
+  ASSERT_TRUE(client.decrypt_packet(replies[0]).has_value());
+
+  const auto state = server->hibernate();
+  EXPECT_EQ(state.send_sequence, server->send_sequence());
+  const auto connection_id = server->connection_id();
+  server.reset();
+
+  transport::TransportSession resumed(state, {}, now_fn);
+  EXPECT_EQ(resumed.connection_id(), connection_id);
+  EXPECT_EQ(resumed.send_sequence(), state.send_sequence);
+
+  // Old packets are still rejected as replays; new ones flow both ways.
+  for (const auto& packet : old_packets) {
+    EXPECT_FALSE(resumed.decrypt_packet(packet).has_value());
+  }
+  const std::vector<std::uint8_t> payload{0x45, 0x00};
+  auto frames = resumed.decrypt_packet(client.encrypt_data(payload)[0]);
+  ASSERT_TRUE(frames.has_value());
+  EXPECT_EQ(frames->front().data.payload, payload);
+  auto reply = client.decrypt_packet(resumed.encrypt_data(payload)[0]);
+  ASSERT_TRUE(reply.has_value());
+  EXPECT_EQ(reply->front().data.payload, payload);
+}
+
 }  // namespace veil::tests
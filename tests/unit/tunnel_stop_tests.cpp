@@ -1,9 +1,14 @@
 #include <gtest/gtest.h>
 
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <vector>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 #include "transport/event_loop/event_loop.h"
 
 namespace veil::tests {
@@ -77,6 +82,96 @@ TEST(EventLoopStopTests, ConcurrentStopCalls) {
   EXPECT_FALSE(loop.is_running());
 }
 
+TEST(EventLoopStopTests, StopWakesBlockedWait) {
+  transport::EventLoopConfig config;
+  config.epoll_timeout_ms = 5000;
+  transport::EventLoop loop(config);
+
+  std::thread runner([&loop]() { loop.run(); });
+  while (!loop.is_running()) {
+    std::this_thread::yield();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+  const auto start = std::chrono::steady_clock::now();
+  loop.stop();
+  runner.join();
+  // Windows has no wakeup descriptor; there the wait runs to its timeout.
+#ifndef _WIN32
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+#endif
+}
+
+#ifndef _WIN32
+// ============================================================================
+// EventLoop Descriptor Tests
+// ============================================================================
+
+TEST(EventLoopFdTests, ReadableDescriptorWakesLoop) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+
+  transport::EventLoopConfig config;
+  config.epoll_timeout_ms = 5000;
+  transport::EventLoop loop(config);
+
+  std::chrono::steady_clock::time_point written_at;
+  std::chrono::steady_clock::time_point handled_at;
+  ASSERT_TRUE(loop.add_fd(fds[0], [&]() {
+    handled_at = std::chrono::steady_clock::now();
+    char byte = 0;
+    EXPECT_EQ(::read(fds[0], &byte, 1), 1);
+    loop.stop();
+  }));
+  EXPECT_FALSE(loop.add_fd(fds[0], []() {}));
+
+  std::thread writer([&]() {
+    while (!loop.is_running()) {
+      std::this_thread::yield();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    written_at = std::chrono::steady_clock::now();
+    const char byte = 1;
+    EXPECT_EQ(::write(fds[1], &byte, 1), 1);
+  });
+  loop.run();
+  writer.join();
+
+  // Handled on readiness, not at the end of the wait timeout.
+  EXPECT_LT(handled_at - written_at, std::chrono::milliseconds(500));
+  EXPECT_TRUE(loop.remove_fd(fds[0]));
+  EXPECT_FALSE(loop.remove_fd(fds[0]));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(EventLoopFdTests, TimersRunWhileDescriptorsIdle) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+
+  transport::EventLoopConfig config;
+  config.epoll_timeout_ms = 5000;
+  transport::EventLoop loop(config);
+  ASSERT_TRUE(loop.add_fd(fds[0], []() { FAIL() << "descriptor was never written"; }));
+
+  int fired = 0;
+  const auto start = std::chrono::steady_clock::now();
+  loop.schedule_timer(std::chrono::milliseconds(5), [&](utils::TimerId) {
+    ++fired;
+    loop.schedule_timer(std::chrono::milliseconds(5), [&](utils::TimerId) {
+      ++fired;
+      loop.stop();
+    });
+  });
+  loop.run();
+
+  EXPECT_EQ(fired, 2);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+#endif
+
 // ============================================================================
 // Atomic Exchange Pattern Tests (Tunnel::stop() logic)
 // ============================================================================
@@ -134,4 +134,81 @@ TEST(UdpSocketTests, MultiplePackets) {
   EXPECT_EQ(received_count, num_packets);
 }
 
+TEST(UdpSocketTests, DrainReadsQueuedPacketsWithoutBlocking) {
+  transport::UdpSocket server;
+  std::error_code ec;
+  if (!server.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+  const auto port = server.local_port();
+
+  transport::UdpSocket client;
+  if (!client.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+
+  // Nothing queued: returns immediately with no error.
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(server.drain([](const transport::UdpPacket&) {}, 64, ec), 0U);
+  EXPECT_FALSE(ec) << ec.message();
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+
+  transport::UdpEndpoint server_ep{"127.0.0.1", port};
+  const int num_packets = 5;
+  for (int i = 0; i < num_packets; ++i) {
+    std::vector<std::uint8_t> payload{static_cast<std::uint8_t>(i)};
+    ASSERT_TRUE(client.send(payload, server_ep, ec)) << ec.message();
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  // The budget is honoured, and the next call picks up the rest in order.
+  std::vector<std::uint8_t> seen;
+  const auto collect = [&](const transport::UdpPacket& pkt) { seen.push_back(pkt.data.at(0)); };
+  EXPECT_EQ(server.drain(collect, 3, ec), 3U);
+  EXPECT_EQ(server.drain(collect, 64, ec), 2U);
+  EXPECT_FALSE(ec) << ec.message();
+  EXPECT_EQ(seen, (std::vector<std::uint8_t>{0, 1, 2, 3, 4}));
+}
+
+TEST(UdpSocketTests, SendBatchWithDepartureTimes) {
+  transport::UdpSocket server;
+  std::error_code ec;
+  if (!server.open(0, false, ec)) {
+    if (ec == std::errc::operation_not_permitted) {
+      GTEST_SKIP() << "UDP sockets not permitted in this environment";
+    }
+    FAIL() << ec.message();
+  }
+  const auto port = server.local_port();
+
+  transport::UdpSocket client;
+  ASSERT_TRUE(client.open(0, false, ec)) << ec.message();
+  if (!client.enable_txtime(ec)) {
+    GTEST_SKIP() << "SO_TXTIME not available: " << ec.message();
+  }
+  EXPECT_TRUE(client.txtime_enabled());
+
+  // Stamped and unstamped datagrams in one batch. Without a pacing qdisc on
+  // loopback the stamps are ignored and everything arrives at once.
+  transport::UdpEndpoint server_ep{"127.0.0.1", port};
+  std::vector<transport::UdpPacket> batch;
+  const auto now = std::chrono::steady_clock::now();
+  for (std::uint8_t i = 0; i < 3; ++i) {
+    batch.push_back(transport::UdpPacket{
+        .data = {i}, .remote = server_ep, .departure = i == 0 ? std::chrono::steady_clock::time_point{} : now});
+  }
+  ASSERT_EQ(client.send_batch(batch, ec), batch.size()) << ec.message();
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+  std::vector<std::uint8_t> seen;
+  server.drain([&](const transport::UdpPacket& pkt) { seen.push_back(pkt.data.at(0)); }, 64, ec);
+  EXPECT_EQ(seen, (std::vector<std::uint8_t>{0, 1, 2}));
+}
+
 }  // namespace veil::tests
@@ -41,10 +41,12 @@ TEST(ZeroRttHandshakeTests, FullZeroRttFlowAccepted) {
   auto session = initiator.consume_response(resp->response);
   ASSERT_TRUE(session.has_value());
 
-  // Step 2: Server issues a session ticket
+  // Step 2: Server issues a session ticket for its side of the session; the
+  // client caches the ticket together with its own keys
   auto ticket_manager = std::make_shared<handshake::SessionTicketManager>(
       std::chrono::milliseconds(60000), now_fn);
-  auto ticket = ticket_manager->issue_ticket(session->keys);
+  auto ticket = ticket_manager->issue_ticket(resp->session.keys);
+  ticket.cached_keys = session->keys;
 
   // Step 3: Client stores the ticket and later reconnects with 0-RTT
   handshake::ZeroRttInitiator zero_rtt_initiator(make_psk(), ticket, now_fn);
@@ -63,9 +65,38 @@ TEST(ZeroRttHandshakeTests, FullZeroRttFlowAccepted) {
   ASSERT_TRUE(zero_rtt_session.has_value());
   EXPECT_EQ(zero_rtt_session->session_id, zero_rtt_result->session.session_id);
 
-  // The session keys should match the original session keys (cached in ticket)
-  EXPECT_EQ(zero_rtt_session->keys.send_key, session->keys.send_key);
-  EXPECT_EQ(zero_rtt_session->keys.recv_key, session->keys.recv_key);
+  // Both sides derive the same fresh keys; the original session keys are not reused
+  const auto& server_keys = zero_rtt_result->session.keys;
+  EXPECT_EQ(zero_rtt_session->keys.send_key, server_keys.recv_key);
+  EXPECT_EQ(zero_rtt_session->keys.recv_key, server_keys.send_key);
+  EXPECT_EQ(zero_rtt_session->keys.send_nonce, server_keys.recv_nonce);
+  EXPECT_EQ(zero_rtt_session->keys.recv_nonce, server_keys.send_nonce);
+  EXPECT_NE(zero_rtt_session->keys.send_key, session->keys.send_key);
+  EXPECT_NE(zero_rtt_session->keys.recv_key, session->keys.recv_key);
+
+  // Early data keys are available before the server's reply
+  EXPECT_EQ(zero_rtt_initiator.early_keys().send_key, zero_rtt_session->keys.send_key);
+}
+
+TEST(ZeroRttHandshakeTests, EachResumptionDerivesDistinctKeys) {
+  auto now = std::chrono::system_clock::now();
+  auto now_fn = [&]() { return now; };
+
+  crypto::SessionKeys keys{};
+  keys.send_key.fill(0x11);
+  keys.recv_key.fill(0x22);
+  auto ticket_manager = std::make_shared<handshake::SessionTicketManager>(
+      std::chrono::milliseconds(60000), now_fn);
+  auto ticket = ticket_manager->issue_ticket(keys);
+
+  handshake::ZeroRttInitiator first(make_psk(), ticket, now_fn);
+  handshake::ZeroRttInitiator second(make_psk(), ticket, now_fn);
+  first.create_zero_rtt_init();
+  second.create_zero_rtt_init();
+
+  // Same ticket, fresh INIT values: resumed sessions never share (key, nonce) space
+  EXPECT_NE(first.early_keys().send_key, second.early_keys().send_key);
+  EXPECT_NE(first.early_keys().send_key, keys.send_key);
 }
 
 TEST(ZeroRttHandshakeTests, ExpiredTicketRejected) {